@@ -0,0 +1,132 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace OSRE {
+
+// Forward declarations
+namespace Threading {
+    class ThreadPool;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Cooks the assets of a source tree into their runtime formats, without a window or a 
+/// render context. Models are cooked by the AssimpWrapper and textures into cooked textures, both 
+/// into the DerivedDataCache registered at the AssetRegistry or next to their sources.
+///
+/// Every cooked asset is recorded in a manifest with the files it was built from. An asset is 
+/// only cooked again when one of those files, its settings or its output changed, so a model 
+/// is cooked again when its material library changes as well.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT AssetCooker {
+public:
+    /// The cookable asset types.
+    enum class AssetType {
+        Unknown = 0,
+        Model,
+        Texture
+    };
+
+    /// The result of a cook run.
+    struct Statistics {
+        ui32 m_numCooked;
+        ui32 m_numUpToDate;
+        ui32 m_numFailed;
+
+        Statistics();
+    };
+
+    AssetCooker();
+    ~AssetCooker();
+
+    /// @brief  Sets the pool used to cook the assets in parallel, without one they are cooked serially.
+    void setThreadPool( Threading::ThreadPool *threadPool );
+
+    /// @brief  Cooks all assets, even the ones being up to date.
+    void setForceRebuild( bool force );
+
+    /// @brief  Loads the manifest of a former run, a missing manifest is no error.
+    bool loadManifest( const String &filename );
+
+    /// @brief  Writes the manifest.
+    bool saveManifest( const String &filename ) const;
+
+    /// @brief  Cooks all assets in a directory and its sub directories.
+    /// @return false, when the directory cannot be read or an asset failed.
+    bool cookDirectory( const String &dir );
+
+    /// @brief  Cooks a list of files, files which are no assets are ignored.
+    /// @return false, when an asset failed.
+    bool cookFiles( const std::vector<String> &files );
+
+    /// @brief  Returns the statistics of the last run.
+    const Statistics &getStatistics() const;
+
+    /// @brief  Returns the asset type of a file, based on its extension.
+    static AssetType getAssetType( const String &filename );
+
+    OSRE_NON_COPYABLE( AssetCooker )
+
+private:
+    struct FileStamp {
+        ui64 m_size;
+        ui64 m_time;
+    };
+
+    struct Entry {
+        String m_output;
+        String m_settings;
+        std::map<String, FileStamp> m_dependencies;
+    };
+
+    bool cookAsset( const String &filename, AssetType type );
+    bool cookModel( const String &filename, Entry &entry );
+    bool cookTexture( const String &filename, Entry &entry );
+    bool isUpToDate( const String &filename, const Entry &entry ) const;
+    static bool getStamp( const String &filename, FileStamp &stamp );
+
+private:
+    Threading::ThreadPool *m_threadPool;
+    bool m_forceRebuild;
+    std::map<String, Entry> m_manifest;
+    Statistics m_stats;
+    mutable std::mutex m_mutex;
+};
+
+inline
+const AssetCooker::Statistics &AssetCooker::getStatistics() const {
+    return m_stats;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
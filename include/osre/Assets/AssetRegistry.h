@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/osre_common.h>
 #include <cppcore/Container/THashMap.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace OSRE {
     
 // Forward declarations
@@ -43,6 +46,9 @@ namespace Scene {
 
 namespace Assets {
 
+class DedupCache;
+class DerivedDataCache;
+
 //-------------------------------------------------------------------------------------------------
 ///	@ingroup    Engine
 ///
@@ -55,8 +61,15 @@ public:
     static bool registerAssetPath( const String &mount, const String &path );
     static bool hasPath( const String &mount );
     static String getPath( const String &mount );
-    static String resolvePathFromUri( const IO::Uri &location );
+    /// Resolves the mount point of the location. The results are memoized, the returned reference 
+    /// stays valid until the mount points change by registerAssetPath, clear or destroy. Without 
+    /// a registry it refers to the path of the location.
+    static const String &resolvePathFromUri( const IO::Uri &location );
     static bool clear();
+    static void setDerivedDataCache( DerivedDataCache *cache );
+    static DerivedDataCache *getDerivedDataCache();
+    static void setDedupCache( DedupCache *cache );
+    static DedupCache *getDedupCache();
 
 private:
     AssetRegistry();
@@ -67,6 +80,10 @@ private:
 
     typedef CPPCore::THashMap<ui32, String> Name2PathMap;
     Name2PathMap m_name2pathMap;
+    std::unordered_map<String, String> m_resolvedPaths;
+    std::mutex m_resolveMutex;
+    DerivedDataCache *m_derivedDataCache;
+    DedupCache *m_dedupCache;
 };
 
 } // Namespace Assets
@@ -0,0 +1,218 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/AbstractService.h>
+#include <osre/IO/Uri.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace OSRE {
+
+// Forward declarations
+namespace IO {
+    class Stream;
+}
+
+namespace Threading {
+    class ThreadPool;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The base class for decoded assets of the streaming service.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT StreamPayload {
+public:
+    virtual ~StreamPayload();
+
+    /// @brief  Returns the number of bytes the upload will transfer, used for the upload budget.
+    virtual ui64 getUploadSize() const = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The payload of requests without a handler, contains the data of the file.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT RawStreamPayload : public StreamPayload {
+public:
+    std::vector<uc8> m_data;
+
+    RawStreamPayload();
+    ~RawStreamPayload();
+    ui64 getUploadSize() const override;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Decodes and uploads one type of asset for the streaming service.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT StreamHandler {
+public:
+    virtual ~StreamHandler();
+
+    /// @brief  Returns false when the handler reads the asset itself in decode, the read stage 
+    ///         will be skipped and the data is empty.
+    virtual bool readsFileData() const;
+
+    /// @brief  Decodes the file data, will be called on a worker thread.
+    /// @param  uri         [in] The location of the asset.
+    /// @param  data        [in] The file data.
+    /// @return The decoded asset or nullptr in case of an error.
+    virtual StreamPayload *decode( const IO::Uri &uri, std::vector<uc8> &data ) = 0;
+
+    /// @brief  Uploads the decoded asset, will be called in the update of the service.
+    /// @param  payload     [in] The decoded asset.
+    /// @return false in case of an error.
+    virtual bool upload( StreamPayload *payload ) = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This class implements the asynchronous streaming of assets. A request runs through the 
+/// stages read, decode and upload. Reading and decoding are done by worker threads, the upload is 
+/// done in the update of the service. Each update starts the stages for the requests with the 
+/// highest priority within the per frame budgets. The callback of a request is delivered on the 
+/// thread which has made the request, the update delivers the callbacks of its own thread and 
+/// all other threads have to call dispatchCallbacks().
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT AssetStreamingService : public Common::AbstractService {
+public:
+    /// The request handle type.
+    using Handle = ui32;
+    /// The invalid handle.
+    static const Handle InvalidHandle = 0;
+
+    /// @brief  The state of a request.
+    enum class State {
+        Queued,         ///< Waiting for the read stage.
+        Reading,        ///< The file will be read.
+        Decoding,       ///< The data will be decoded.
+        Uploading,      ///< Waiting for the upload.
+        Done,           ///< Uploaded, the callback was or will be delivered.
+        Failed,         ///< Reading, decoding or uploading has failed.
+        Cancelled,      ///< The request was cancelled.
+        Invalid         ///< Unknown handle or the callback was already delivered.
+    };
+
+    /// @brief  The per frame budgets, at least one request passes each stage per frame.
+    struct Budget {
+        ui64 m_readBytes;       ///< The number of bytes to start reading per frame.
+        ui32 m_decodeJobs;      ///< The number of decode jobs to start per frame.
+        ui64 m_uploadBytes;     ///< The number of bytes to upload per frame.
+
+        Budget();
+    };
+
+    /// @brief  The callback, the payload is nullptr for failed requests. The payload will be 
+    /// released after the callback, move its data to keep it.
+    using Callback = std::function<void( Handle handle, State state, StreamPayload *payload )>;
+
+    /// @brief  Computes the new priority of a waiting request once per frame, higher priorities 
+    /// will be served first.
+    using Prioritizer = std::function<f32( Handle handle, const IO::Uri &uri, f32 priority )>;
+
+    /// @brief  The class constructor.
+    /// @param  threadPool  [in] The worker pool, nullptr to create an own pool on open.
+    explicit AssetStreamingService( Threading::ThreadPool *threadPool = nullptr );
+
+    /// @brief  The class destructor.
+    ~AssetStreamingService();
+
+    /// @brief  Requests a new asset.
+    /// @param  uri         [in] The location of the asset.
+    /// @param  priority    [in] The priority, higher priorities will be served first.
+    /// @param  callback    [in] The callback.
+    /// @param  handler     [in] The handler to decode and upload the asset, nullptr for raw data.
+    /// @return The request handle, InvalidHandle in case of an error.
+    Handle request( const IO::Uri &uri, f32 priority, const Callback &callback, StreamHandler *handler = nullptr );
+
+    /// @brief  Changes the priority of a request, which was not uploaded.
+    bool setPriority( Handle handle, f32 priority );
+
+    /// @brief  Sets the prioritizer which will be called each frame.
+    void setPrioritizer( const Prioritizer &prioritizer );
+
+    /// @brief  Cancels a request, its callback will not be delivered.
+    bool cancel( Handle handle );
+
+    /// @brief  Returns the state of a request.
+    State getState( Handle handle ) const;
+
+    /// @brief  Returns the number of requests which are not finished yet.
+    ui32 getNumPending() const;
+
+    /// @brief  Sets the per frame budgets.
+    void setBudget( const Budget &budget );
+    const Budget &getBudget() const;
+
+    /// @brief  Delivers the finished callbacks of the calling thread.
+    /// @return The number of delivered callbacks.
+    ui32 dispatchCallbacks();
+
+protected:
+    bool onOpen() override;
+    bool onClose() override;
+    bool onUpdate() override;
+
+private:
+    struct Request;
+    void prioritize();
+    void startReads();
+    void startDecodes();
+    void upload();
+    void finish( Request *request, State state );
+    void runJob( const std::function<void()> &job );
+    void releaseRequest( Request *request );
+
+private:
+    Threading::ThreadPool *m_threadPool;
+    bool m_ownsThreadPool;
+    std::map<Handle, Request*> m_requests;
+    std::vector<Request*> m_finished;
+    Handle m_nextHandle;
+    Prioritizer m_prioritizer;
+    Budget m_budget;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobsDone;
+    ui32 m_numJobs;
+};
+
+inline
+const AssetStreamingService::Budget &AssetStreamingService::getBudget() const {
+    return m_budget;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -25,11 +25,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/osre_common.h>
 #include <osre/Common/Ids.h>
 #include <osre/Collision/TAABB.h>
+#include <osre/Assets/CookedModel.h>
+#include <osre/Assets/DedupCache.h>
+#include <osre/Assets/MeshOptimizer.h>
+#include <osre/RenderBackend/RenderCommon.h>
 
 #include <cppcore/Container/TArray.h>
 
 #include <assimp/vector3.h>
 
+#include <set>
+
 // Forward declarations
 struct aiScene;
 struct aiMesh;
@@ -56,6 +62,10 @@ namespace Scene {
     class Node;
 }
 
+namespace Threading {
+    class ThreadPool;
+}
+
 namespace Assets {
 
 class Model;
@@ -65,13 +75,54 @@ public:
     AssimpWrapper( Common::Ids &ids );
     ~AssimpWrapper();
     bool importAsset( const IO::Uri &file, ui32 flags );
+    /// @brief  Returns the name of the cooked model of a source file, in the derived data cache if one is registered.
+    String getCookedFilename( const String &filename ) const;
+    /// @brief  Returns the files read by the last Assimp import, an import of a cooked model reads no sources.
+    const std::set<String> &getDependencies() const;
     Model *getModel() const;
+    /// @brief  Releases an imported model with its nodes, geometries and materials.
+    static void releaseModel( Model *model );
+    void setNumLodLevels( ui32 numLodLevels );
+    ui32 getNumLodLevels() const;
+    /// @brief  Enables the cooked model cache. Imports will write a cooked model next to the 
+    /// source asset, following imports will map it instead of running the Assimp import as long 
+    /// as the source asset was not changed.
+    void setCookingEnabled( bool enabled );
+    bool isCookingEnabled() const;
+    /// @brief  Enables mapping existing cooked models. When disabled, the source is always imported 
+    /// and the cooked model is written again.
+    void setCookedReuseEnabled( bool enabled );
+    bool isCookedReuseEnabled() const;
+    bool loadCookedModel( const String &filename, ui64 sourceSize, ui64 sourceTime, ui64 settingsHash = 0 );
+    bool saveCookedModel( const String &filename, ui64 sourceSize, ui64 sourceTime, ui64 settingsHash = 0 ) const;
+    /// @brief  Sets the pool used to convert the meshes in parallel. Without a pool a temporary 
+    /// one will be used for large scenes.
+    void setThreadPool( Threading::ThreadPool *threadPool );
+    Threading::ThreadPool *getThreadPool() const;
+    /// @brief  Sets the vertex layout of the imported meshes. VertexType::CompactRenderVertex and 
+    /// VertexType::QuantizedRenderVertex will quantize the vertices at import time.
+    void setVertexType( RenderBackend::VertexType type );
+    RenderBackend::VertexType getVertexType() const;
+    /// @brief  Enables the vertex cache, overdraw and vertex fetch optimization of imported meshes.
+    void setMeshOptimizationEnabled( bool enabled );
+    bool isMeshOptimizationEnabled() const;
+    /// @brief  Returns the optimization statistics of the last import, cooked models keep no statistics.
+    const MeshOptimizer::Statistics &getMeshStatistics() const;
+    /// @brief  Enables the deduplication of equal meshes and materials. The cache registered at the 
+    /// AssetRegistry shares them across models, without one they are shared within the model.
+    void setDeduplicationEnabled( bool enabled );
+    bool isDeduplicationEnabled() const;
 
 protected:
     Model *convertSceneToModel( const aiScene *scene );
-    void handleMesh( aiMesh *mesh );
+    void convertMeshes( const aiScene *scene );
+    static void handleMesh( const aiMesh *mesh, RenderBackend::Geometry *geo, Collision::TAABB<f32> &aabb );
     void handleNode( aiNode *node, Scene::Node *parent );
     void handleMaterial( aiMaterial *material );
+    void addGeometry( RenderBackend::Geometry *geo, Scene::Node *node );
+    DedupCache *getDedupCache();
+    String getCookedSettings() const;
+    ui64 getCookedSettingsHash() const;
 
 private:
     typedef CPPCore::TArray<RenderBackend::Geometry*> GeoArray;
@@ -84,6 +135,19 @@ private:
     RenderBackend::UniformVar *m_mvpParam;
     String m_root;
     String m_absPathWithFile;
+    ui32 m_numLodLevels;
+    bool m_cookingEnabled;
+    bool m_cookedReuseEnabled;
+    CookedModel::NodeDescArray m_nodeDescs;
+    i32 m_parentDescIdx;
+    Threading::ThreadPool *m_threadPool;
+    RenderBackend::VertexType m_vertexType;
+    bool m_optimizeMeshes;
+    MeshOptimizer::Statistics m_meshStats;
+    bool m_dedupEnabled;
+    DedupCache m_localDedupCache;
+    CPPCore::TArray<ui32> m_meshMap;
+    std::set<String> m_dependencies;
 };
 
 } // Namespace Assets
@@ -0,0 +1,209 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/TAABB.h>
+#include <osre/IO/MemoryMappedFile.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <cppcore/Container/TArray.h>
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+namespace OSRE {
+
+// Forward declarations
+namespace IO {
+    class Stream;
+}
+
+namespace RenderBackend {
+    struct Geometry;
+    struct Material;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The header of a cooked model file. All offsets are counted from the start of the 
+/// file, the vertex and index blobs are aligned to CookedModel::BlobAlignment.
+//-------------------------------------------------------------------------------------------------
+struct CookedModelHeader {
+    ui32 m_magic;           ///< CookedModel::Magic
+    ui32 m_version;         ///< CookedModel::Version
+    ui32 m_headerSize;      ///< sizeof( CookedModelHeader )
+    ui32 m_numMeshes;
+    ui32 m_numMaterials;
+    ui32 m_numNodes;
+    ui32 m_numMeshRefs;
+    ui32 m_stringsSize;
+    ui64 m_sourceSize;      ///< Size of the source asset, used to detect outdated files.
+    ui64 m_sourceTime;      ///< Modification time of the source asset.
+    ui64 m_settingsHash;    ///< Hash of the import settings the model was cooked with.
+    ui64 m_meshOffset;
+    ui64 m_materialOffset;
+    ui64 m_nodeOffset;
+    ui64 m_meshRefOffset;
+    ui64 m_stringOffset;
+    ui64 m_blobOffset;
+    ui64 m_blobSize;
+    f32  m_aabb[ 6 ];       ///< min and max of the model bounds
+};
+
+/// @brief  A mesh record, the vertex and index data are stored in the GPU layout.
+struct CookedMesh {
+    ui64 m_vbOffset;
+    ui64 m_ibOffset;
+    ui32 m_vbSize;
+    ui32 m_ibSize;
+    ui32 m_vertexType;
+    ui32 m_indexType;
+    ui32 m_primitive;
+    ui32 m_numIndices;
+    ui32 m_material;
+    ui32 m_localMatrix;
+    f32  m_model[ 16 ];
+};
+
+/// @brief  A material record, strings are stored as offset and length into the string table.
+struct CookedMaterial {
+    f32  m_colors[ 4 ][ 4 ];
+    ui32 m_nameOffset;
+    ui32 m_nameLength;
+    ui32 m_textureOffset;
+    ui32 m_textureLength;
+};
+
+/// @brief  A node record, parents are always stored before their children.
+struct CookedNode {
+    f32  m_transform[ 16 ];
+    i32  m_parent;
+    ui32 m_nameOffset;
+    ui32 m_nameLength;
+    ui32 m_firstMeshRef;
+    ui32 m_numMeshRefs;
+    ui32 m_padding;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Reads and writes cooked models. A cooked model contains the meshes in GPU layout, 
+/// the materials, the node hierarchy and the bounds of an imported model. Opening maps the file 
+/// into memory, the geometry buffers view the mapped data without parsing or copying it. The 
+/// geometries share the mapping, so they stay valid when the CookedModel is closed before them.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT CookedModel {
+public:
+    using AABB = Collision::TAABB<f32>;
+    using GeoArray = CPPCore::TArray<RenderBackend::Geometry*>;
+
+    static const ui32 Magic = 0x4d43534f; // "OSCM"
+    static const ui32 Version = 2;
+    static const ui32 BlobAlignment = 16;
+    static const ui32 InvalidIndex = 0xFFFFFFFF;
+
+    /// @brief  Describes a node for writing.
+    struct NodeDesc {
+        String m_name;
+        i32 m_parent;
+        glm::mat4 m_transform;
+        CPPCore::TArray<ui32> m_meshes;
+
+        NodeDesc();
+    };
+    using NodeDescArray = CPPCore::TArray<NodeDesc>;
+
+    CookedModel();
+    ~CookedModel();
+    static bool save( IO::Stream &stream, const GeoArray &meshes, const NodeDescArray &nodes, const AABB &aabb, 
+            ui64 sourceSize = 0, ui64 sourceTime = 0, ui64 settingsHash = 0 );
+    static bool getSourceInfo( const String &filename, ui64 &size, ui64 &time );
+    static String getCookedName( const String &filename );
+    bool open( const String &filename );
+    void close();
+    bool isOpen() const;
+    bool isUpToDate( ui64 sourceSize, ui64 sourceTime, ui64 settingsHash = 0 ) const;
+    const CookedModelHeader &getHeader() const;
+    AABB getAABB() const;
+    ui32 getNumMeshes() const;
+    RenderBackend::Geometry *createGeometry( ui32 idx ) const;
+    ui32 getMeshMaterial( ui32 idx ) const;
+    RenderBackend::VertexType getMeshVertexType( ui32 idx ) const;
+    ui32 getNumMaterials() const;
+    RenderBackend::Material *createMaterial( ui32 idx, 
+            RenderBackend::VertexType type = RenderBackend::VertexType::RenderVertex ) const;
+    ui32 getNumNodes() const;
+    String getNodeName( ui32 idx ) const;
+    i32 getNodeParent( ui32 idx ) const;
+    glm::mat4 getNodeTransform( ui32 idx ) const;
+    ui32 getNumNodeMeshes( ui32 idx ) const;
+    ui32 getNodeMeshAt( ui32 idx, ui32 meshIdx ) const;
+
+    OSRE_NON_COPYABLE( CookedModel )
+
+private:
+    bool validate() const;
+    String getString( ui32 offset, ui32 length ) const;
+
+private:
+    std::shared_ptr<IO::MemoryMappedFile> m_file;
+    const CookedModelHeader *m_header;
+    const CookedMesh *m_meshes;
+    const CookedMaterial *m_materials;
+    const CookedNode *m_nodes;
+    const ui32 *m_meshRefs;
+    const c8 *m_strings;
+};
+
+inline
+bool CookedModel::isOpen() const {
+    return nullptr != m_header;
+}
+
+inline
+const CookedModelHeader &CookedModel::getHeader() const {
+    return *m_header;
+}
+
+inline
+ui32 CookedModel::getNumMeshes() const {
+    return nullptr != m_header ? m_header->m_numMeshes : 0;
+}
+
+inline
+ui32 CookedModel::getNumMaterials() const {
+    return nullptr != m_header ? m_header->m_numMaterials : 0;
+}
+
+inline
+ui32 CookedModel::getNumNodes() const {
+    return nullptr != m_header ? m_header->m_numNodes : 0;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,180 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/IO/MemoryMappedFile.h>
+
+#include <vector>
+
+namespace OSRE {
+
+// Forward declarations
+namespace IO {
+    class Stream;
+}
+
+namespace Assets {
+
+/// @brief  The pixel formats of cooked textures. The block compressed formats store 4x4 blocks, 
+/// BC5 stores the red and green channel only and is meant for normal maps.
+enum class CookedTextureFormat : ui32 {
+    RGBA8 = 0,      ///< Uncompressed, 4 bytes per pixel.
+    BC1,            ///< DXT1, 8 bytes per block, no alpha.
+    BC3,            ///< DXT5, 16 bytes per block, interpolated alpha.
+    BC5,            ///< RGTC2, 16 bytes per block, two channels.
+    NumFormats,     ///< Number of enums.
+
+    InvalidFormat   ///< Enum for invalid enum.
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The header of a cooked texture file. The level table follows the header, the levels 
+/// are stored from the largest to the smallest one and aligned to CookedTexture::BlobAlignment.
+//-------------------------------------------------------------------------------------------------
+struct CookedTextureHeader {
+    ui32 m_magic;           ///< CookedTexture::Magic
+    ui32 m_version;         ///< CookedTexture::Version
+    ui32 m_headerSize;      ///< sizeof( CookedTextureHeader )
+    ui32 m_format;          ///< The CookedTextureFormat
+    ui32 m_width;
+    ui32 m_height;
+    ui32 m_numLevels;
+    ui32 m_srgb;            ///< 1 when the mip chain was filtered in linear space.
+    ui64 m_sourceSize;      ///< Size of the source image, used to detect outdated files.
+    ui64 m_sourceTime;      ///< Modification time of the source image.
+    ui64 m_levelOffset;     ///< Offset of the level table.
+};
+
+/// @brief  A level record of a cooked texture.
+struct CookedTextureLevel {
+    ui64 m_offset;
+    ui32 m_size;
+    ui32 m_width;
+    ui32 m_height;
+    ui32 m_padding;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Cooks and reads textures with a precomputed mip chain. Cooking loads the source image,
+/// filters the mip levels on the CPU and block compresses them, so the render backend can upload 
+/// the levels without decoding them. Opening maps the file into memory.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT CookedTexture {
+public:
+    static const ui32 Magic = 0x5443534f; // "OSCT"
+    static const ui32 Version = 1;
+    static const ui32 BlobAlignment = 16;
+    static const ui32 MaxLevels = 32;
+
+    /// @brief  An uncompressed RGBA8 image, the first row is the bottom row like in OpenGL.
+    struct Image {
+        ui32 m_width;
+        ui32 m_height;
+        std::vector<uc8> m_data;
+
+        Image();
+        void resize( ui32 width, ui32 height );
+    };
+
+    /// @brief  The cooking options.
+    struct Options {
+        CookedTextureFormat m_format;   ///< InvalidFormat selects BC1 or BC3 by the alpha channel.
+        bool m_srgb;                    ///< Filter the mip chain in linear space, for color textures.
+        bool m_normalMap;               ///< Renormalize the filtered normals.
+        bool m_generateMips;            ///< Store the full mip chain.
+
+        Options();
+    };
+
+    CookedTexture();
+    ~CookedTexture();
+    static bool loadImage( const String &filename, Image &image );
+    static void generateMipChain( const Image &image, bool srgb, bool normalMap, std::vector<Image> &levels );
+    static CookedTextureFormat selectFormat( const Image &image );
+    static ui32 getBlockSize( CookedTextureFormat format );
+    static ui32 getLevelSize( CookedTextureFormat format, ui32 width, ui32 height );
+    static void encode( const Image &image, CookedTextureFormat format, std::vector<uc8> &data );
+    static bool decode( const uc8 *data, CookedTextureFormat format, ui32 width, ui32 height, Image &image );
+    static bool save( IO::Stream &stream, const Image &image, const Options &options, ui64 sourceSize = 0, 
+            ui64 sourceTime = 0 );
+    static bool cook( const String &source, const String &target, const Options &options );
+    static String getCookedName( const String &filename );
+    static String getSettings( const Options &options );
+    bool open( const String &filename );
+    void close();
+    bool isOpen() const;
+    bool isUpToDate( ui64 sourceSize, ui64 sourceTime ) const;
+    const CookedTextureHeader &getHeader() const;
+    CookedTextureFormat getFormat() const;
+    ui32 getNumLevels() const;
+    const CookedTextureLevel &getLevel( ui32 idx ) const;
+    const uc8 *getLevelData( ui32 idx ) const;
+
+    OSRE_NON_COPYABLE( CookedTexture )
+
+private:
+    bool validate() const;
+
+private:
+    IO::MemoryMappedFile m_file;
+    const CookedTextureHeader *m_header;
+    const CookedTextureLevel *m_levels;
+};
+
+inline
+bool CookedTexture::isOpen() const {
+    return nullptr != m_header;
+}
+
+inline
+const CookedTextureHeader &CookedTexture::getHeader() const {
+    return *m_header;
+}
+
+inline
+CookedTextureFormat CookedTexture::getFormat() const {
+    return nullptr != m_header ? static_cast<CookedTextureFormat>( m_header->m_format ) : CookedTextureFormat::InvalidFormat;
+}
+
+inline
+ui32 CookedTexture::getNumLevels() const {
+    return nullptr != m_header ? m_header->m_numLevels : 0;
+}
+
+inline
+const CookedTextureLevel &CookedTexture::getLevel( ui32 idx ) const {
+    return m_levels[ idx ];
+}
+
+inline
+const uc8 *CookedTexture::getLevelData( ui32 idx ) const {
+    return m_file.getData() + m_levels[ idx ].m_offset;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,117 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <map>
+#include <mutex>
+
+namespace OSRE {
+
+// Forward declarations
+namespace RenderBackend {
+    struct Geometry;
+    struct Material;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Finds equal geometries and materials by a hash of their content. The first added 
+/// object of a content is kept, for equal objects added later the kept one is returned instead. 
+/// So models sharing meshes and materials share the objects and the GPU buffers, duplicates 
+/// turn into instances. Geometries are compared after their materials were deduplicated, because 
+/// the material pointer is a part of the geometry content. The cache does not own any object, 
+/// it counts the references to the kept ones. Each add must be paired with a release when the 
+/// owning model is destroyed, the object must only be destroyed when it is not referenced anymore. 
+/// Geometries viewing a cooked model must not be added.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT DedupCache {
+public:
+    DedupCache();
+    ~DedupCache();
+
+    /// @brief  Adds a reference to a geometry.
+    /// @param  geo     [in] The geometry.
+    /// @return The kept geometry. When it differs from geo the caller has to destroy its duplicate.
+    RenderBackend::Geometry *addGeometry( RenderBackend::Geometry *geo );
+
+    /// @brief  Releases a reference to a geometry, the entry will be removed with the last one.
+    /// @param  geo     [in] The geometry.
+    /// @return true when the geometry is not referenced anymore and can be destroyed.
+    bool releaseGeometry( RenderBackend::Geometry *geo );
+
+    /// @brief  Adds a reference to a material.
+    /// @param  mat     [in] The material.
+    /// @return The kept material. When it differs from mat the caller has to delete its duplicate.
+    RenderBackend::Material *addMaterial( RenderBackend::Material *mat );
+
+    /// @brief  Releases a reference to a material, the entry will be removed with the last one.
+    /// @param  mat     [in] The material.
+    /// @return true when the material is not referenced anymore and can be deleted.
+    bool releaseMaterial( RenderBackend::Material *mat );
+
+    /// @brief  Forgets all entries, the objects will not be released.
+    void clear();
+
+    /// @brief  Returns the number of kept geometries.
+    ui32 getNumGeometries() const;
+
+    /// @brief  Returns the number of kept materials.
+    ui32 getNumMaterials() const;
+
+    /// @brief  Returns the number of released duplicates.
+    ui32 getNumDuplicates() const;
+
+    static ui64 hashGeometry( const RenderBackend::Geometry *geo );
+    static ui64 hashMaterial( const RenderBackend::Material *mat );
+    static bool isEqual( const RenderBackend::Geometry *a, const RenderBackend::Geometry *b );
+    static bool isEqual( const RenderBackend::Material *a, const RenderBackend::Material *b );
+
+    OSRE_NON_COPYABLE( DedupCache )
+
+private:
+    struct Reference {
+        ui64 m_hash;
+        ui32 m_numRefs;
+    };
+
+    template<class T>
+    T *addEntry( T *obj, ui64 hash, std::multimap<ui64, T*> &entries, std::map<T*, Reference> &refs );
+    template<class T>
+    static bool releaseEntry( T *obj, std::multimap<ui64, T*> &entries, std::map<T*, Reference> &refs );
+
+private:
+    std::multimap<ui64, RenderBackend::Geometry*> m_geometries;
+    std::map<RenderBackend::Geometry*, Reference> m_geoRefs;
+    std::multimap<ui64, RenderBackend::Material*> m_materials;
+    std::map<RenderBackend::Material*, Reference> m_matRefs;
+    ui32 m_numDuplicates;
+    mutable std::mutex m_mutex;
+};
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,145 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace OSRE {
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A content addressed cache for derived data like cooked models and textures. The key 
+/// of a derived file is a hash of the source bytes, the settings of the producer, the format 
+/// version of the derived data and DerivedDataCache::Version. So changed inputs lead to a new key 
+/// and outdated files are never found. The hash of the source bytes is remembered together with 
+/// the size and modification time of the source, the bytes are only hashed again when those 
+/// change. Further files read by the producer, like material libraries, are only known after 
+/// producing the data. Their hashes are recorded per derived file and checked before it is used. 
+/// The remembered hashes are stored in an index file in the cache directory.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT DerivedDataCache {
+public:
+    /// The cache key type.
+    using Key = ui64;
+
+    /// The version of the key computation, increase it to invalidate all cached files.
+    static const ui32 Version = 1;
+
+    DerivedDataCache();
+    ~DerivedDataCache();
+
+    /// @brief  Opens the cache, the directory will be created when it does not exist.
+    /// @param  directory   [in] The cache directory.
+    /// @return false in case of an error.
+    bool open( const String &directory );
+
+    /// @brief  Writes the index and closes the cache.
+    void close();
+
+    /// @brief  Returns true, when the cache is open.
+    bool isOpen() const;
+
+    /// @brief  Returns the cache directory.
+    const String &getDirectory() const;
+
+    /// @brief  Computes the key of derived data.
+    /// @param  source          [in] The source file.
+    /// @param  settings        [in] The settings of the producer, e.g. import flags.
+    /// @param  formatVersion   [in] The version of the derived format.
+    /// @param  key             [out] The key.
+    /// @return false, when the source cannot be read.
+    bool computeKey( const String &source, const String &settings, ui32 formatVersion, Key &key );
+
+    /// @brief  Returns the file name of derived data in the cache directory.
+    String getFilename( Key key, const String &extension ) const;
+
+    /// @brief  Returns true, when the derived data exists in the cache.
+    bool contains( Key key, const String &extension ) const;
+
+    /// @brief  Computes the key and returns the file name of the derived data.
+    /// @return The file name or an empty string when the cache is closed or the source cannot be read.
+    String getDerivedFilename( const String &source, const String &settings, ui32 formatVersion, 
+            const String &extension );
+
+    /// @brief  Records the files a derived file was produced from besides its source.
+    /// @param  derivedFile     [in] The derived file in the cache directory.
+    /// @param  dependencies    [in] The files read by the producer, e.g. material libraries.
+    /// @return false, when a dependency cannot be read. Nothing will be recorded then.
+    bool setDependencies( const String &derivedFile, const std::set<String> &dependencies );
+
+    /// @brief  Checks the recorded dependencies of a derived file.
+    /// @param  derivedFile     [in] The derived file in the cache directory.
+    /// @return false, when a dependency was changed or cannot be read anymore.
+    bool checkDependencies( const String &derivedFile );
+
+    /// @brief  Returns the number of source files which were hashed, used to check the index.
+    ui32 getNumHashedFiles() const;
+
+    /// @brief  Computes the 64 bit hash of a memory block.
+    static ui64 hash( const void *data, size_t size, ui64 seed = 0 );
+
+    OSRE_NON_COPYABLE( DerivedDataCache )
+
+private:
+    struct SourceInfo {
+        ui64 m_size;
+        ui64 m_time;
+        ui64 m_hash;
+    };
+
+    bool hashSource( const String &source, ui64 &hashValue );
+    void loadIndex();
+    void saveIndex();
+
+private:
+    String m_directory;
+    std::map<String, SourceInfo> m_sources;
+    std::map<String, std::map<String, ui64>> m_dependencies;
+    bool m_dirty;
+    ui32 m_numHashedFiles;
+    mutable std::mutex m_mutex;
+};
+
+inline
+bool DerivedDataCache::isOpen() const {
+    return !m_directory.empty();
+}
+
+inline
+const String &DerivedDataCache::getDirectory() const {
+    return m_directory;
+}
+
+inline
+ui32 DerivedDataCache::getNumHashedFiles() const {
+    return m_numHashedFiles;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
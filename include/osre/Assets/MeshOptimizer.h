@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <cppcore/Container/TArray.h>
+
+namespace OSRE {
+
+// Forward declarations
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This utility class optimizes triangle meshes for the GPU. The triangles are reordered 
+/// for the post-transform vertex cache with Tipsify, the resulting clusters are sorted to reduce 
+/// overdraw and the vertices are reordered in the order of their first use. The quality is 
+/// measured as ACMR, the average number of cache misses per triangle of a simulated FIFO cache.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT MeshOptimizer {
+public:
+    /// The simulated cache size, a conservative value for current GPUs.
+    static const ui32 DefaultCacheSize = 16;
+
+    /// @brief  The result of an optimization.
+    struct Statistics {
+        f32  m_acmrBefore;      ///< The ACMR of the authored triangle order.
+        f32  m_acmrAfter;       ///< The ACMR of the optimized triangle order.
+        ui32 m_numTriangles;    ///< The number of triangles.
+        ui32 m_numClusters;     ///< The number of clusters sorted for overdraw.
+
+        Statistics();
+    };
+
+    /// @brief  Will optimize a triangle list geometry in place. The index buffer will use 16-bit 
+    /// indices for less than 65536 vertices, unused vertices will be removed.
+    /// @param  geo         [inout] The geometry, one triangle list primitive group only.
+    /// @param  stats       [out] The optional statistics.
+    /// @param  cacheSize   [in] The simulated cache size.
+    /// @return true if the geometry was optimized, false in case of an error.
+    static bool optimize( RenderBackend::Geometry *geo, Statistics *stats = nullptr, ui32 cacheSize = DefaultCacheSize );
+
+    /// @brief  Returns the average cache miss ratio of a triangle list for a FIFO cache.
+    static f32 computeACMR( const ui32 *indices, ui32 numIndices, ui32 numVertices, ui32 cacheSize = DefaultCacheSize );
+
+    /// @brief  Reorders the triangles for the vertex cache with Tipsify.
+    /// @param  clusters    [out] The optional first triangle of each cluster, a cluster ends at a 
+    /// dead end of the traversal.
+    static void optimizeVertexCache( ui32 *indices, ui32 numIndices, ui32 numVertices, ui32 cacheSize, 
+            CPPCore::TArray<ui32> *clusters );
+
+    /// @brief  Sorts the clusters of a cache optimized triangle list, clusters facing outwards 
+    /// are drawn first. Long clusters are split where their ACMR stays below the threshold times 
+    /// the ACMR of the whole list.
+    /// @param  positions   [in] The vertex data, starting with a float position.
+    /// @param  stride      [in] The size of a vertex.
+    /// @return The number of sorted clusters.
+    static ui32 optimizeOverdraw( ui32 *indices, ui32 numIndices, const uc8 *positions, ui32 stride, 
+            ui32 numVertices, const CPPCore::TArray<ui32> &clusters, ui32 cacheSize = DefaultCacheSize, 
+            f32 threshold = 1.0f );
+
+    /// @brief  Reorders the vertices in the order of their first use and remaps the indices.
+    /// @return The number of used vertices, unused vertices are moved behind them.
+    static ui32 optimizeVertexFetch( uc8 *vertices, ui32 numVertices, ui32 vertexSize, ui32 *indices, 
+            ui32 numIndices );
+
+private:
+    MeshOptimizer();
+    ~MeshOptimizer();
+};
+
+} // Namespace Assets
+} // Namespace OSRE
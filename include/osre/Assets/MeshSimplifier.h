@@ -0,0 +1,62 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+namespace OSRE {
+
+// Forward declarations
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This utility class is used to generate coarser detail levels for meshes without 
+/// authored LODs. The simplification uses quadric error metrics with greedy edge collapses, 
+/// each edge collapses into one of its end points, so the vertex attributes stay untouched.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT MeshSimplifier {
+public:
+    /// @brief  Will create a simplified copy of a triangle mesh.
+    /// @param  geo         [in] The source geometry, triangle lists only.
+    /// @param  ratio       [in] The target ratio of triangles to keep, between 0 and 1.
+    /// @return The simplified geometry sharing the material of the source, nullptr in case of an error.
+    static RenderBackend::Geometry *simplify( const RenderBackend::Geometry *geo, f32 ratio );
+
+    /// @brief  Returns the number of triangles of a triangle mesh.
+    /// @param  geo         [in] The geometry.
+    /// @return The number of triangles.
+    static ui32 getNumTriangles( const RenderBackend::Geometry *geo );
+
+private:
+    MeshSimplifier();
+    ~MeshSimplifier();
+};
+
+} // Namespace Assets
+} // Namespace OSRE
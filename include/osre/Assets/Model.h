@@ -39,6 +39,8 @@ namespace RenderBackend {
 
 namespace Assets {
 
+class CookedModel;
+
 class OSRE_EXPORT Model {
 public: 
     typedef Collision::TAABB<f32> ModelAABB;
@@ -53,9 +55,13 @@ public:
     Scene::Node *getRootNode() const;
     void setAABB( const Collision::TAABB<f32> &aabb );
     const ModelAABB &getAABB() const;
+    /// @brief  Takes the ownership of the cooked model backing the geometry buffers.
+    void setCookedModel( CookedModel *cookedModel );
+    CookedModel *getCookedModel() const;
 
 private:
     GeoArray m_geoArray;
+    CookedModel *m_cookedModel;
 
     Scene::Node *m_root;
     Collision::TAABB<f32> m_aabb;
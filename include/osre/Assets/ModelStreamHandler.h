@@ -0,0 +1,80 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Assets/AssetStreamingService.h>
+#include <osre/Common/Ids.h>
+
+#include <functional>
+#include <mutex>
+
+namespace OSRE {
+namespace Assets {
+
+class Model;
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The payload of the ModelStreamHandler, contains the imported model.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT ModelStreamPayload : public StreamPayload {
+public:
+    /// The imported model, set it to nullptr to keep it after the callback.
+    Model *m_model;
+
+    ModelStreamPayload();
+    ~ModelStreamPayload();
+    ui64 getUploadSize() const override;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Streams models through the AssimpWrapper. The import reads the model and the files it 
+/// references itself, so the read stage of the service is skipped. Cooked models of unchanged 
+/// sources are mapped instead of being imported. The nodes of the models get their ids from the 
+/// id container of the handler, so the handler has to outlive the models. Imports of one handler 
+/// are serialized because they share this container, the meshes of an import are still converted 
+/// in parallel. The upload function runs in the update of the streaming service and takes over 
+/// the model when it succeeds. Without an upload function the model will be delivered to the 
+/// callback in the ModelStreamPayload.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT ModelStreamHandler : public StreamHandler {
+public:
+    using UploadFunc = std::function<bool( Model *model )>;
+
+    explicit ModelStreamHandler( const UploadFunc &uploadFunc = UploadFunc() );
+    ~ModelStreamHandler();
+    bool readsFileData() const override;
+    StreamPayload *decode( const IO::Uri &uri, std::vector<uc8> &data ) override;
+    bool upload( StreamPayload *payload ) override;
+
+private:
+    UploadFunc m_uploadFunc;
+    Common::Ids m_ids;
+    std::mutex m_importMutex;
+};
+
+} // Namespace Assets
+} // Namespace OSRE
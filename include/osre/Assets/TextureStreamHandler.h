@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Assets/AssetStreamingService.h>
+
+#include <functional>
+
+namespace OSRE {
+
+// Forward declarations
+namespace RenderBackend {
+    struct Texture;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The payload of the TextureStreamHandler, contains the decoded texture.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT TextureStreamPayload : public StreamPayload {
+public:
+    /// The decoded texture, set it to nullptr to keep it after the callback.
+    RenderBackend::Texture *m_texture;
+
+    TextureStreamPayload();
+    ~TextureStreamPayload();
+    ui64 getUploadSize() const override;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Streams PNG, JPEG, TGA and BMP images as textures. The images are decoded to RGBA on 
+/// the worker threads, the bottom row first as expected by OpenGL. The upload function runs in 
+/// the update of the streaming service and takes over the texture when it succeeds. Without an 
+/// upload function the texture will be delivered to the callback in the TextureStreamPayload.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT TextureStreamHandler : public StreamHandler {
+public:
+    using UploadFunc = std::function<bool( RenderBackend::Texture *texture )>;
+
+    explicit TextureStreamHandler( const UploadFunc &uploadFunc = UploadFunc() );
+    ~TextureStreamHandler();
+    StreamPayload *decode( const IO::Uri &uri, std::vector<uc8> &data ) override;
+    bool upload( StreamPayload *payload ) override;
+
+private:
+    UploadFunc m_uploadFunc;
+};
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,78 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/Collision/TAABB.h>
+
+namespace OSRE {
+
+// Forward declarations
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Assets {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This utility class converts render vertices into the compact vertex layouts. Normals 
+/// are octahedral encoded into two snorm16 values, colors are stored as RGBA8 and texture 
+/// coordinates as half floats. For the quantized layout the positions are stored as unorm16 
+/// relative to the bounds of the mesh, the decoding is folded into the local matrix of the geometry.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT VertexQuantizer {
+public:
+    /// @brief  Will convert the vertex buffer of a geometry into a compact layout.
+    /// @param  geo         [in] The geometry, must use VertexType::RenderVertex.
+    /// @param  type        [in] VertexType::CompactRenderVertex or VertexType::QuantizedRenderVertex.
+    /// @return true if the geometry was converted, false in case of an error.
+    static bool quantize( RenderBackend::Geometry *geo, RenderBackend::VertexType type );
+
+    /// @brief  Returns the matrix which maps unorm16 positions back into the bounds.
+    /// @param  aabb        [in] The bounds used for the quantization.
+    /// @return The dequantization matrix.
+    static glm::mat4 getDequantizationMatrix( const Collision::TAABB<f32> &aabb );
+
+    /// @brief  Octahedral encoding of a normal, a zero normal is encoded as +z.
+    static void encodeNormal( const glm::vec3 &normal, i16 encoded[ 2 ] );
+    /// @brief  Decodes an octahedral encoded normal.
+    static glm::vec3 decodeNormal( const i16 encoded[ 2 ] );
+    /// @brief  Converts a float into a half float, rounds to nearest even.
+    static ui16 encodeHalf( f32 value );
+    /// @brief  Converts a half float back into a float.
+    static f32 decodeHalf( ui16 value );
+    /// @brief  Maps a value between 0 and 1 to unorm8, values outside will be clamped.
+    static uc8 encodeUnorm8( f32 value );
+    /// @brief  Maps a value between 0 and 1 to unorm16, values outside will be clamped.
+    static ui16 encodeUnorm16( f32 value );
+
+private:
+    VertexQuantizer();
+    ~VertexQuantizer();
+};
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,290 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/TAABB.h>
+#include <osre/Collision/TRay.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace OSRE {
+namespace Collision {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A bounding volume hierarchy with four children per node. The child bounds of a node 
+/// are stored as structure of arrays, so one ray can be tested against all four of them with 
+/// a single SIMD slab test. Packets of up to four rays are traversed together, each child box 
+/// is tested against all rays of the packet at once.
+///
+/// The hierarchy only stores primitive indices, the primitive tests are done by the leaf 
+/// functor passed to the traversal.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT Bvh4 {
+public:
+    using AABB = TAABB<f32>;
+
+    /// The number of children per node.
+    static const ui32 Width = 4;
+    /// The maximal number of rays in a packet.
+    static const ui32 PacketSize = 4;
+
+    /// @brief  A ray prepared for the traversal.
+    struct Ray {
+        glm::vec3 m_origin;
+        glm::vec3 m_direction;
+        glm::vec3 m_invDirection;
+
+        Ray( const glm::vec3 &origin, const glm::vec3 &direction );
+        explicit Ray( const TRay<f32> &ray );
+    };
+
+    /// @brief  Up to four rays, stored as structure of arrays.
+    struct RayPacket {
+        f32 m_origin[ 3 ][ PacketSize ];
+        f32 m_direction[ 3 ][ PacketSize ];
+        f32 m_invDirection[ 3 ][ PacketSize ];
+        ui32 m_numRays;
+
+        RayPacket();
+        bool add( const Ray &ray );
+        Ray getRay( ui32 idx ) const;
+    };
+
+    Bvh4();
+    ~Bvh4();
+    void build( const AABB *boxes, ui32 numBoxes, ui32 maxLeafSize = 4 );
+    void clear();
+    bool isEmpty() const;
+    ui32 getNumNodes() const;
+    ui32 getNumPrimitives() const;
+    const AABB &getBounds() const;
+
+    /// @brief  Calls leafFunc( primIdx, maxDist ) for all primitives whose leaf is hit by the 
+    /// ray, nearest leaves first. The functor returns true when it has shortened maxDist.
+    template<class TLeafFunc>
+    void traverse( const Ray &ray, f32 &maxDist, TLeafFunc leafFunc ) const;
+
+    /// @brief  Calls leafFunc( primIdx, rayMask, maxDist ) for all primitives whose leaf is 
+    /// hit by at least one ray of the packet, bit i of rayMask is set for the hitting rays.
+    template<class TLeafFunc>
+    void traversePacket( const RayPacket &packet, f32 maxDist[ PacketSize ], TLeafFunc leafFunc ) const;
+
+    /// @brief  Tests the ray against all children of a node, returns the mask of hit children.
+    ui32 intersectChildren( ui32 nodeIdx, const Ray &ray, f32 maxDist, f32 tNear[ Width ] ) const;
+
+    /// @brief  Tests all rays of the packet against one child box, returns the mask of hit rays.
+    ui32 intersectChildPacket( ui32 nodeIdx, ui32 child, const RayPacket &packet, ui32 rayMask, 
+            const f32 maxDist[ PacketSize ] ) const;
+
+    OSRE_NON_COPYABLE( Bvh4 )
+
+private:
+    struct Node {
+        f32 m_min[ 3 ][ Width ];
+        f32 m_max[ 3 ][ Width ];
+        /// Index of the child node, the first primitive for leaves or -1 for empty slots
+        i32 m_child[ Width ];
+        /// Number of primitives for leaves, 0 for inner nodes and empty slots
+        ui32 m_count[ Width ];
+    };
+
+    struct StackEntry {
+        i32 m_child;
+        ui32 m_count;
+        f32 m_tNear;
+        ui32 m_rayMask;
+    };
+
+    static const ui32 MaxStackSize = 256;
+
+    /// The traversal stack lives on the stack, deeper trees spill into the heap instead of 
+    /// dropping nodes.
+    class TraversalStack {
+    public:
+        TraversalStack();
+        void push( const StackEntry &entry );
+        StackEntry pop();
+        bool isEmpty() const;
+
+    private:
+        StackEntry m_entries[ MaxStackSize ];
+        ui32 m_size;
+        std::vector<StackEntry> m_overflow;
+    };
+
+    ui32 buildNode( const AABB *boxes, const std::vector<glm::vec3> &centroids, ui32 begin, ui32 end );
+    void splitRange( const std::vector<glm::vec3> &centroids, ui32 begin, ui32 end, ui32 &mid );
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<ui32> m_primIndices;
+    ui32 m_maxLeafSize;
+    AABB m_bounds;
+};
+
+inline
+bool Bvh4::isEmpty() const {
+    return m_nodes.empty();
+}
+
+inline
+ui32 Bvh4::getNumNodes() const {
+    return static_cast<ui32>( m_nodes.size() );
+}
+
+inline
+ui32 Bvh4::getNumPrimitives() const {
+    return static_cast<ui32>( m_primIndices.size() );
+}
+
+inline
+const Bvh4::AABB &Bvh4::getBounds() const {
+    return m_bounds;
+}
+
+inline
+Bvh4::TraversalStack::TraversalStack()
+: m_size( 0 )
+, m_overflow() {
+    // empty
+}
+
+inline
+void Bvh4::TraversalStack::push( const StackEntry &entry ) {
+    if ( m_size < MaxStackSize ) {
+        m_entries[ m_size ] = entry;
+    } else {
+        m_overflow.push_back( entry );
+    }
+    ++m_size;
+}
+
+inline
+Bvh4::StackEntry Bvh4::TraversalStack::pop() {
+    --m_size;
+    if ( m_size < MaxStackSize ) {
+        return m_entries[ m_size ];
+    }
+
+    const StackEntry entry( m_overflow.back() );
+    m_overflow.pop_back();
+
+    return entry;
+}
+
+inline
+bool Bvh4::TraversalStack::isEmpty() const {
+    return 0 == m_size;
+}
+
+template<class TLeafFunc>
+inline
+void Bvh4::traverse( const Ray &ray, f32 &maxDist, TLeafFunc leafFunc ) const {
+    if ( m_nodes.empty() ) {
+        return;
+    }
+
+    TraversalStack stack;
+    stack.push( { 0, 0, 0.0f, 1 } );
+    while ( !stack.isEmpty() ) {
+        const StackEntry entry( stack.pop() );
+        if ( entry.m_tNear > maxDist ) {
+            continue;
+        }
+
+        if ( 0 != entry.m_count ) {
+            for ( ui32 i = 0; i < entry.m_count; ++i ) {
+                leafFunc( m_primIndices[ entry.m_child + i ], maxDist );
+            }
+            continue;
+        }
+
+        f32 tNear[ Width ];
+        const ui32 mask( intersectChildren( static_cast<ui32>( entry.m_child ), ray, maxDist, tNear ) );
+        if ( 0 == mask ) {
+            continue;
+        }
+
+        // Sort the hit children by distance, the nearest one will be popped first
+        ui32 order[ Width ];
+        ui32 numHits( 0 );
+        for ( ui32 i = 0; i < Width; ++i ) {
+            if ( 0 == ( mask & ( 1 << i ) ) ) {
+                continue;
+            }
+            ui32 j( numHits++ );
+            while ( j > 0 && tNear[ order[ j - 1 ] ] < tNear[ i ] ) {
+                order[ j ] = order[ j - 1 ];
+                --j;
+            }
+            order[ j ] = i;
+        }
+
+        const Node &node( m_nodes[ entry.m_child ] );
+        for ( ui32 i = 0; i < numHits; ++i ) {
+            const ui32 child( order[ i ] );
+            stack.push( { node.m_child[ child ], node.m_count[ child ], tNear[ child ], 1 } );
+        }
+    }
+}
+
+template<class TLeafFunc>
+inline
+void Bvh4::traversePacket( const RayPacket &packet, f32 maxDist[ PacketSize ], TLeafFunc leafFunc ) const {
+    if ( m_nodes.empty() || 0 == packet.m_numRays ) {
+        return;
+    }
+
+    TraversalStack stack;
+    stack.push( { 0, 0, 0.0f, ( 1u << packet.m_numRays ) - 1 } );
+    while ( !stack.isEmpty() ) {
+        const StackEntry entry( stack.pop() );
+        if ( 0 != entry.m_count ) {
+            for ( ui32 i = 0; i < entry.m_count; ++i ) {
+                leafFunc( m_primIndices[ entry.m_child + i ], entry.m_rayMask, maxDist );
+            }
+            continue;
+        }
+
+        const ui32 nodeIdx( static_cast<ui32>( entry.m_child ) );
+        const Node &node( m_nodes[ nodeIdx ] );
+        for ( ui32 i = Width; i > 0; --i ) {
+            const ui32 child( i - 1 );
+            if ( node.m_child[ child ] < 0 ) {
+                continue;
+            }
+            const ui32 rayMask( intersectChildPacket( nodeIdx, child, packet, entry.m_rayMask, maxDist ) );
+            if ( 0 != rayMask ) {
+                stack.push( { node.m_child[ child ], node.m_count[ child ], 0.0f, rayMask } );
+            }
+        }
+    }
+}
+
+} // Namespace Collision
+} // Namespace OSRE
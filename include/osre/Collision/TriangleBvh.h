@@ -0,0 +1,103 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Collision/Bvh4.h>
+#include <cppcore/Container/TArray.h>
+
+namespace OSRE {
+
+namespace RenderBackend {
+    struct Geometry;
+    enum class IndexType;
+}
+
+namespace Collision {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The triangles of a mesh stored in a Bvh4 for fast ray queries. Rays are tested 
+/// against the triangles with the Möller-Trumbore algorithm, both faces of a triangle count as 
+/// hit. The distances are returned in units of the ray direction.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT TriangleBvh {
+public:
+    /// The triangle index of a miss.
+    static const ui32 InvalidTriangle = 0xFFFFFFFF;
+
+    /// @brief  Describes a ray hit, the triangle is counted from the start of the index data, 
+    /// skipped invalid triangles keep their number.
+    struct Hit {
+        f32 m_distance;
+        ui32 m_triangle;
+        f32 m_u;
+        f32 m_v;
+
+        Hit();
+    };
+
+    TriangleBvh();
+    ~TriangleBvh();
+    bool build( const RenderBackend::Geometry *geo );
+    bool build( const RenderBackend::Geometry *geo, RenderBackend::IndexType indexType, ui32 startIndex, ui32 numIndices );
+    void build( const glm::vec3 *positions, ui32 numVertices, const ui32 *indices, ui32 numIndices );
+    void clear();
+    ui32 getNumTriangles() const;
+    const Bvh4 &getBvh() const;
+    bool intersect( const Bvh4::Ray &ray, f32 maxDist, Hit &hit ) const;
+    ui32 intersectAll( const Bvh4::Ray &ray, f32 maxDist, CPPCore::TArray<Hit> &hits ) const;
+    void intersectPacket( const Bvh4::RayPacket &packet, f32 maxDist[ Bvh4::PacketSize ], Hit hits[ Bvh4::PacketSize ] ) const;
+    static bool intersectTriangle( const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &v0, 
+            const glm::vec3 &e1, const glm::vec3 &e2, f32 &t, f32 &u, f32 &v );
+
+    OSRE_NON_COPYABLE( TriangleBvh )
+
+private:
+    struct Triangle {
+        glm::vec3 m_v0;
+        glm::vec3 m_e1;
+        glm::vec3 m_e2;
+        ui32 m_index;
+    };
+
+    bool addTriangles( const RenderBackend::Geometry *geo, RenderBackend::IndexType indexType, ui32 startIndex, ui32 numIndices );
+    void buildBvh();
+
+private:
+    std::vector<Triangle> m_triangles;
+    Bvh4 m_bvh;
+};
+
+inline
+ui32 TriangleBvh::getNumTriangles() const {
+    return static_cast<ui32>( m_triangles.size() );
+}
+
+inline
+const Bvh4 &TriangleBvh::getBvh() const {
+    return m_bvh;
+}
+
+} // Namespace Collision
+} // Namespace OSRE
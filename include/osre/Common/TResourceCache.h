@@ -25,30 +25,152 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/osre_common.h>
 #include <osre/Common/Logger.h>
 
+#include <cassert>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
 namespace OSRE {
 namespace Common {
 
 static const c8 Tag[] = "TResourceCache";
 
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Returns the memory size of a cached resource. Specialize it for resources owning 
+/// more memory than their instance size, for instance textures or meshes.
+//-------------------------------------------------------------------------------------------------
+template<class TResource>
+struct TResourceSize {
+    static ui64 get( const TResource & ) {
+        return sizeof( TResource );
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A cache for resources of one type, looked up by their id. 
+///
+/// The cache owns its resources and accounts their memory size. When a memory budget is set, the 
+/// least recently used resources are evicted to keep the cache inside the budget. Resources 
+/// referenced by addRef will not be evicted until they get released.
+//-------------------------------------------------------------------------------------------------
 template<class TResId, class TResource>
 class TResourceCache {
 public:
-    TResourceCache();
+    /// @brief  The usage statistics of the cache.
+    struct Statistics {
+        ui64 mHits;         ///< Number of lookups finding the resource.
+        ui64 mMisses;       ///< Number of lookups not finding the resource.
+        ui64 mEvictions;    ///< Number of evicted resources.
+
+        Statistics();
+    };
+
+    /// @brief  The class constructor.
+    /// @param  budget  [in] The memory budget in bytes, 0 for no limit.
+    explicit TResourceCache( ui64 budget = 0 );
+
+    /// @brief  The class destructor, releases all resources.
     ~TResourceCache();
-    void load( TResId id, const String &filename );
+
+    /// @brief  Loads a resource from a file and adds it.
+    /// @param  id          [in] The resource id.
+    /// @param  filename    [in] The file to load from.
+    /// @return true if the resource was loaded, false if not.
+    bool load( TResId id, const String &filename );
+
+    /// @brief  Adds a resource, the cache takes the ownership.
+    /// @param  id          [in] The resource id.
+    /// @param  resource    [in] The resource.
+    /// @param  size        [in] The memory size of the resource in bytes.
+    /// @return true if the resource was added, false if the id is already in use.
+    bool insert( TResId id, std::unique_ptr<TResource> resource, ui64 size );
+
+    /// @brief  Will return true, when the resource is cached.
+    bool has( TResId id ) const;
+
+    /// @brief  Looks up a resource and marks it as recently used.
+    /// @param  id          [in] The resource id.
+    /// @return The resource or nullptr, if it is not cached.
+    TResource *find( TResId id ) const;
+
+    /// @brief  Returns a cached resource, the resource must be cached.
     TResource &get( TResId id );
     TResource &get( TResId id ) const;
+
+    /// @brief  Increments the reference counter, a referenced resource will not be evicted.
+    /// @return false if the resource is not cached.
+    bool addRef( TResId id );
+
+    /// @brief  Decrements the reference counter, the resource can be evicted when unreferenced.
+    /// @return false if the resource is not cached or not referenced.
+    bool release( TResId id );
+
+    /// @brief  Removes a resource, even when it is referenced.
+    bool remove( TResId id );
+
+    /// @brief  Removes all resources.
     void clear();
 
+    /// @brief  Sets the memory budget in bytes, 0 for no limit. Evicts resources when needed.
+    void setBudget( ui64 budget );
+
+    /// @brief  Returns the memory budget in bytes.
+    ui64 getBudget() const;
+
+    /// @brief  Returns the memory size of all cached resources in bytes.
+    ui64 getMemoryUsage() const;
+
+    /// @brief  Returns the number of cached resources.
+    size_t getNumResources() const;
+
+    /// @brief  Returns the usage statistics.
+    const Statistics &getStatistics() const;
+
+    /// @brief  Resets the usage statistics.
+    void resetStatistics();
+
+private:
+    bool evict( ui64 size );
+
+    OSRE_NON_COPYABLE( TResourceCache )
+
 private:
-    using ResourceMap = std::map<TResId, std::unique_ptr<TResource>>;
+    using LruList = std::list<TResId>;
+    struct Entry {
+        std::unique_ptr<TResource> mResource;
+        ui64 mSize;
+        ui32 mRefs;
+        typename LruList::iterator mLruIt;
+    };
+    using ResourceMap = std::unordered_map<TResId, Entry>;
     ResourceMap mResourceMap;
+    mutable LruList mLruList; // Unreferenced resources, the most recently used first
+    ui64 mBudget;
+    ui64 mMemoryUsage;
+    mutable Statistics mStatistics;
 };
 
 template<class TResId, class TResource>
 inline
-TResourceCache<TResId, TResource>::TResourceCache()
-    : mResourceMap() {
+TResourceCache<TResId, TResource>::Statistics::Statistics()
+: mHits( 0 )
+, mMisses( 0 )
+, mEvictions( 0 ) {
+    // empty
+}
+
+template<class TResId, class TResource>
+inline
+TResourceCache<TResId, TResource>::TResourceCache( ui64 budget )
+: mResourceMap()
+, mLruList()
+, mBudget( budget )
+, mMemoryUsage( 0 )
+, mStatistics() {
     // empty
 }
 
@@ -60,40 +182,197 @@ TResourceCache<TResId, TResource>::~TResourceCache() {
 
 template<class TResId, class TResource>
 inline
-void TResourceCache<TResId, TResource >::load( TResId id, const String &filename ) {
+bool TResourceCache<TResId, TResource >::load( TResId id, const String &filename ) {
     if ( filename.empty() ) {
         osre_warn( Tag, "Filename is empty." );
-        return;
+        return false;
     }
 
     std::unique_ptr<TResource> texPtr( new TResource );
     bool res = texPtr->loadFromFile( filename );
-    if ( res ) {
-        auto inserted = mResourceMap.insert( std::make_pair( id, std::move( texPtr ) ) );
-        assert( inserted.second );
-    } else {
-        osre_warn( Tag, "Cannot load texture " + filename );
+    if ( !res ) {
+        osre_warn( Tag, "Cannot load resource " + filename );
+        return false;
     }
+
+    const ui64 size( TResourceSize<TResource>::get( *texPtr ) );
+
+    return insert( id, std::move( texPtr ), size );
 }
 
 template<class TResId, class TResource>
 inline
-TResource &TResourceCache<TResId, TResource>::get( TResId id ) {
+bool TResourceCache<TResId, TResource>::insert( TResId id, std::unique_ptr<TResource> resource, ui64 size ) {
+    if ( nullptr == resource || mResourceMap.end() != mResourceMap.find( id ) ) {
+        return false;
+    }
+
+    // Make room before adding, so a resource larger than the budget is kept until the next insert
+    evict( size );
+
+    Entry &entry( mResourceMap[ id ] );
+    entry.mResource = std::move( resource );
+    entry.mSize = size;
+    entry.mRefs = 0;
+    entry.mLruIt = mLruList.insert( mLruList.begin(), id );
+    mMemoryUsage += size;
+
+    return true;
+}
+
+template<class TResId, class TResource>
+inline
+bool TResourceCache<TResId, TResource>::has( TResId id ) const {
+    return mResourceMap.end() != mResourceMap.find( id );
+}
+
+template<class TResId, class TResource>
+inline
+TResource *TResourceCache<TResId, TResource>::find( TResId id ) const {
     auto found = mResourceMap.find( id );
-    return *found->second;
+    if ( mResourceMap.end() == found ) {
+        ++mStatistics.mMisses;
+        return nullptr;
+    }
+
+    ++mStatistics.mHits;
+    const Entry &entry( found->second );
+    if ( 0 == entry.mRefs ) {
+        mLruList.splice( mLruList.begin(), mLruList, entry.mLruIt );
+    }
+
+    return entry.mResource.get();
+}
+
+template<class TResId, class TResource>
+inline
+TResource &TResourceCache<TResId, TResource>::get( TResId id ) {
+    TResource *resource( find( id ) );
+    assert( nullptr != resource );
+    return *resource;
 }
 
 template<class TResId, class TResource>
 inline
 TResource &TResourceCache<TResId, TResource>::get( TResId id ) const {
+    TResource *resource( find( id ) );
+    assert( nullptr != resource );
+    return *resource;
+}
+
+template<class TResId, class TResource>
+inline
+bool TResourceCache<TResId, TResource>::addRef( TResId id ) {
+    auto found = mResourceMap.find( id );
+    if ( mResourceMap.end() == found ) {
+        return false;
+    }
+
+    Entry &entry( found->second );
+    if ( 0 == entry.mRefs ) {
+        mLruList.erase( entry.mLruIt );
+    }
+    ++entry.mRefs;
+
+    return true;
+}
+
+template<class TResId, class TResource>
+inline
+bool TResourceCache<TResId, TResource>::release( TResId id ) {
+    auto found = mResourceMap.find( id );
+    if ( mResourceMap.end() == found || 0 == found->second.mRefs ) {
+        return false;
+    }
+
+    Entry &entry( found->second );
+    --entry.mRefs;
+    if ( 0 == entry.mRefs ) {
+        entry.mLruIt = mLruList.insert( mLruList.begin(), id );
+        evict( 0 );
+    }
+
+    return true;
+}
+
+template<class TResId, class TResource>
+inline
+bool TResourceCache<TResId, TResource>::remove( TResId id ) {
     auto found = mResourceMap.find( id );
-    return *found->second;
+    if ( mResourceMap.end() == found ) {
+        return false;
+    }
+
+    if ( 0 == found->second.mRefs ) {
+        mLruList.erase( found->second.mLruIt );
+    }
+    mMemoryUsage -= found->second.mSize;
+    mResourceMap.erase( found );
+
+    return true;
 }
 
 template<class TResId, class TResource>
 inline
 void TResourceCache<TResId, TResource>::clear() {
     mResourceMap.clear();
+    mLruList.clear();
+    mMemoryUsage = 0;
+}
+
+template<class TResId, class TResource>
+inline
+void TResourceCache<TResId, TResource>::setBudget( ui64 budget ) {
+    mBudget = budget;
+    evict( 0 );
+}
+
+template<class TResId, class TResource>
+inline
+ui64 TResourceCache<TResId, TResource>::getBudget() const {
+    return mBudget;
+}
+
+template<class TResId, class TResource>
+inline
+ui64 TResourceCache<TResId, TResource>::getMemoryUsage() const {
+    return mMemoryUsage;
+}
+
+template<class TResId, class TResource>
+inline
+size_t TResourceCache<TResId, TResource>::getNumResources() const {
+    return mResourceMap.size();
+}
+
+template<class TResId, class TResource>
+inline
+const typename TResourceCache<TResId, TResource>::Statistics &TResourceCache<TResId, TResource>::getStatistics() const {
+    return mStatistics;
+}
+
+template<class TResId, class TResource>
+inline
+void TResourceCache<TResId, TResource>::resetStatistics() {
+    mStatistics = Statistics();
+}
+
+template<class TResId, class TResource>
+inline
+bool TResourceCache<TResId, TResource>::evict( ui64 size ) {
+    if ( 0 == mBudget ) {
+        return true;
+    }
+
+    while ( mMemoryUsage + size > mBudget && !mLruList.empty() ) {
+        auto found = mResourceMap.find( mLruList.back() );
+        mLruList.pop_back();
+        mMemoryUsage -= found->second.mSize;
+        mResourceMap.erase( found );
+        ++mStatistics.mEvictions;
+    }
+
+    return mMemoryUsage + size <= mBudget;
 }
 
 }
@@ -79,6 +79,11 @@ public:
     /// @return The working directory.
     virtual String getWorkingDirectory() = 0;
 
+    /// @brief  Returns true, when open and close can be called from several threads at once. Only 
+    ///         those file systems are read by the IO threads of the IOService.
+    /// @return false by default.
+    virtual bool isThreadSafe() const;
+
 public:
     ///	@brief	Adds an ownership.
     void get();
@@ -109,6 +114,11 @@ AbstractFileSystem::~AbstractFileSystem() {
     // empty
 }
 
+inline
+bool AbstractFileSystem::isThreadSafe() const {
+    return false;
+}
+
 inline
 void AbstractFileSystem::get() {
     ++m_numberOfRefs;
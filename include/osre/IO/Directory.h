@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <osre/Common/osre_common.h>
 
+#include <vector>
+
 namespace OSRE {
 namespace IO {
 
@@ -39,6 +41,18 @@ public:
     /// @return true, when the directory exists.
     static bool exists( const String &dir );
 
+    /// @brief  Will create the directory, the parent directory must exist.
+    /// @param  dir     [in] The name of the directory.
+    /// @return true, when the directory exists or was created.
+    static bool create( const String &dir );
+
+    /// @brief  Collects the files of a directory.
+    /// @param  dir         [in] The name of the directory.
+    /// @param  recursive   [in] true to collect the files of the sub directories as well.
+    /// @param  files       [out] The file names, including the directory.
+    /// @return false, when the directory cannot be read.
+    static bool getFiles( const String &dir, bool recursive, std::vector<String> &files );
+
     ///	@brief	Returns the directory separator for the current platform.
     ///	@return	The directory separator 
     /// @remark For instance using a Unix platform / will be returned.
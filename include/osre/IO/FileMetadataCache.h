@@ -0,0 +1,183 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace OSRE {
+
+// Forward declarations
+namespace Threading {
+    class ThreadPool;
+}
+
+namespace IO {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Caches the metadata of all files and directories below a set of root directories. 
+///
+/// A root is scanned once when it gets added, the subdirectories are scanned in parallel by a 
+/// pool owned by the cache. addRootDeferred scans on the pool, so registering a root does not 
+/// block. Afterwards stat queries for existing paths below a root are answered by a hash lookup 
+/// without a system call. On Linux the directories are watched by inotify, changes update the 
+/// cache and are reported to the listeners by dispatchChanges, which can be used for hot 
+/// reloading. The watcher thread is started with the first root. On other platforms refresh 
+/// rescans the roots. The watcher reports changes with a delay, so paths which are not cached 
+/// are checked by a system call before they are reported as missing.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT FileMetadataCache {
+public:
+    /// @brief  The metadata of a file or a directory.
+    struct FileInfo {
+        ui64 m_size;            ///< The size in bytes.
+        i64 m_modified;         ///< The last modification time in seconds since the epoch.
+        bool m_isDirectory;     ///< true for directories.
+    };
+
+    /// @brief  The result of a lookup.
+    enum class Lookup {
+        Found,          ///< The path exists.
+        Missing,        ///< The path is below a root, but does not exist.
+        NotCovered      ///< The path is not below a root, the cache cannot tell.
+    };
+
+    /// @brief  The kind of a change.
+    enum class Change {
+        Created,        ///< A file or directory was created or moved in.
+        Modified,       ///< A file was written.
+        Removed         ///< A file or directory was removed or moved away.
+    };
+
+    /// @brief  The listener callback for changes.
+    using ChangeCallback = std::function<void( const String &path, Change change )>;
+
+    /// @brief  The class constructor.
+    FileMetadataCache();
+
+    /// @brief  The class destructor, stops watching.
+    ~FileMetadataCache();
+
+    /// @brief  Scans a directory tree and adds it to the cache.
+    /// @param  root        [in] The root directory.
+    /// @return true, if the root is a directory and was added.
+    bool addRoot( const String &root );
+
+    /// @brief  Scans a directory tree on the pool of the cache and adds it when the scan is done. 
+    /// Until then paths below the root are not covered.
+    /// @param  root        [in] The root directory.
+    void addRootDeferred( const String &root );
+
+    /// @brief  Waits until all deferred scans are done.
+    void waitForScans();
+
+    /// @brief  Removes a root and all its entries.
+    /// @param  root        [in] The root directory.
+    void removeRoot( const String &root );
+
+    /// @brief  Scans all roots again.
+    void refresh();
+
+    /// @brief  Reads the metadata of a path below a root again, e.g. after the engine wrote it.
+    /// @param  path        [in] The path of a file or a directory.
+    void update( const String &path );
+
+    /// @brief  Looks up a path. A path below a root which is not cached is checked by a system call, 
+    /// it may have been created after the last change the watcher has seen.
+    /// @param  path        [in] The path of a file or a directory.
+    /// @param  info        [out] The metadata, if found. May be nullptr.
+    /// @return The result of the lookup.
+    Lookup stat( const String &path, FileInfo *info = nullptr ) const;
+
+    /// @brief  Adds a listener for changes.
+    /// @param  callback    [in] The callback.
+    /// @return The listener id.
+    ui32 addListener( const ChangeCallback &callback );
+
+    /// @brief  Removes a listener.
+    /// @param  id          [in] The listener id.
+    void removeListener( ui32 id );
+
+    /// @brief  Calls the listeners for all changes since the last call, from the calling thread.
+    void dispatchChanges();
+
+    /// @brief  Returns the number of cached files and directories.
+    /// @return The number of entries.
+    size_t getNumEntries() const;
+
+    /// @brief  Returns true, if changes of the file system are tracked.
+    /// @return true, if the directories are watched. Always false before the first root was added.
+    bool isWatching() const;
+
+    /// @brief  Normalizes a path, separators are slashes and there are no empty or "." parts.
+    /// @param  path        [in] The path.
+    /// @return The normalized path.
+    static String normalizePath( const String &path );
+
+    OSRE_NON_COPYABLE( FileMetadataCache )
+
+private:
+    using EntryList = std::vector<std::pair<String, FileInfo>>;
+
+    Threading::ThreadPool &getScanPool();
+    bool isCovered( const String &path ) const;
+    void scanTree( const String &root, EntryList &entries );
+    void walkTree( const String &dir, EntryList &entries );
+    void scanDirectory( const String &dir, EntryList &entries, std::vector<String> &subDirs );
+    void removeTree( const String &path );
+    void removeEntries( const String &path );
+    void removeWatches( const String &path );
+    void addChange( const String &path, Change change );
+    void startWatching();
+    void watchDirectory( const String &dir );
+    void watcherMain();
+    void handleEvent( i32 wd, ui32 mask, const String &name );
+
+private:
+    std::unordered_map<String, FileInfo> m_entries;
+    std::vector<String> m_roots;
+    std::vector<String> m_pendingRoots;
+    std::vector<std::pair<String, Change>> m_changes;
+    std::vector<std::pair<ui32, ChangeCallback>> m_listeners;
+    ui32 m_nextListenerId;
+    mutable std::mutex m_mutex;
+    std::unordered_map<i32, String> m_watches;
+    i32 m_inotifyFd;
+    i32 m_wakeFd;
+    std::once_flag m_watcherStarted;
+    std::thread m_watcher;
+    std::once_flag m_scanPoolCreated;
+    std::unique_ptr<Threading::ThreadPool> m_scanPool;
+};
+
+} // Namespace IO
+} // Namespace OSRE
@@ -25,12 +25,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/AbstractService.h>
 #include <osre/IO/Stream.h>
 
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace OSRE {
 namespace IO {
 
 class AbstractFileSystem;
+class AccessTrace;
+class AsyncReadQueue;
+class FileMetadataCache;
 class Uri;
 
 //-------------------------------------------------------------------------------------------------
@@ -42,6 +49,13 @@ class OSRE_EXPORT IOService : public Common::AbstractService {
 public:
     DECLARE_SINGLETON( IOService )
 
+public:
+    /// The callback of an asynchronous read, called by an IO thread.
+    using ReadCallback = std::function<void( bool ok, ui32 bytesRead )>;
+
+    /// The default number of bytes to prefetch at startup.
+    static const ui64 DefaultPrefetchBudget;
+
 public:
     ///	@brief	The default class constructor.
     IOService();
@@ -97,13 +111,76 @@ public:
     /// @return true, if the file exists.
     bool fileExists( const Uri &file ) const;
     
+    /// @brief  Reads a range of a file asynchronously. Files of file systems which are not thread-safe 
+    ///         ( see AbstractFileSystem::isThreadSafe ) are read on the calling thread instead.
+    /// @param  file        [in] The file name as an Uri.
+    /// @param  offset      [in] The offset of the range in the file.
+    /// @param  size        [in] The size of the range in bytes.
+    /// @param  buffer      [in] The buffer to read into, must be valid until the callback was called.
+    /// @param  callback    [in] Will be called by an IO thread when the read is done, or before 
+    ///                     readAsync returns for file systems which are not thread-safe.
+    void readAsync( const Uri &file, ui64 offset, ui32 size, void *buffer, const ReadCallback &callback );
+
+    /// @brief  Reads a range of a file asynchronously.
+    /// @return The future with the number of bytes read, 0 in case of an error.
+    std::future<ui32> readAsync( const Uri &file, ui64 offset, ui32 size, void *buffer );
+
+    /// @brief  Holds back all reads until endReadBatch, so reads of neighbouring ranges can be coalesced.
+    void beginReadBatch();
+
+    /// @brief  Dispatches all reads since beginReadBatch.
+    void endReadBatch();
+
+    /// @brief  Waits until all dispatched reads are done.
+    void waitForReads();
+
+    /// @brief  Sets the number of IO threads, must be called before the first asynchronous read.
+    /// @param  numThreads  [in] The number of threads, 0 reads on the calling thread.
+    void setNumIOThreads( ui32 numThreads );
+
+    /// @brief  Returns the number of asynchronous read requests and of the reads done for them.
+    /// @param  numRequests [out] The number of requests.
+    /// @param  numReads    [out] The number of reads.
+    void getReadStatistics( ui64 &numRequests, ui64 &numReads ) const;
+
+    /// @brief  Returns the metadata cache of the locale file system. Add the asset directories as 
+    ///         roots to answer existence checks without system calls, the changes are dispatched 
+    ///         by onUpdate.
+    /// @return The metadata cache.
+    FileMetadataCache &getMetadataCache();
+
+    /// @brief  Records the file accesses of the startup into a trace file. The accesses of the trace 
+    ///         of the last run are prefetched in disk order on a background thread.
+    /// @param  traceFile   [in] The trace file of the application.
+    /// @param  budget      [in] The maximal number of bytes to prefetch.
+    /// @return true, if a trace of the last run was found.
+    bool enableAccessTrace( const String &traceFile, ui64 budget = DefaultPrefetchBudget );
+
+    /// @brief  Writes the recorded accesses to the trace file, also done by onClose.
+    /// @return true, if the trace was written.
+    bool saveAccessTrace();
+
+    /// @brief  Returns the number of bytes prefetched from the trace so far.
+    /// @return The number of bytes.
+    ui64 getNumPrefetchedBytes() const;
+
     /// @brief  Will create a new instance.
     /// @return The new created instance.
     static IOService *create();
 
+private:
+    AsyncReadQueue *getReadQueue();
+    void releaseReadQueue();
+
 private:
     using MountedMap = std::map<String, AbstractFileSystem*> ;
     MountedMap m_mountedMap;
+    ui32 m_numIOThreads;
+    mutable std::mutex m_readQueueMutex;
+    AsyncReadQueue *m_readQueue;
+    std::unique_ptr<FileMetadataCache> m_metadataCache;
+    std::unique_ptr<AccessTrace> m_accessTrace;
+    String m_traceFile;
 };
 
 } // Namespace IO
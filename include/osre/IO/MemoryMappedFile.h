@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+namespace OSRE {
+namespace IO {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Maps a whole file into memory. The mapping is private and copy-on-write, so the 
+/// mapped data may be modified without changing the file.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT MemoryMappedFile {
+public:
+    /// @brief  The expected access pattern, lets the system read ahead or drop pages early.
+    enum class AccessHint {
+        Normal,         ///< No special treatment.
+        Sequential,     ///< The pages will be read in order, read ahead aggressively.
+        Random,         ///< The pages will be read in random order, do not read ahead.
+        WillNeed        ///< The pages will be needed soon, start reading them now.
+    };
+
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+    bool open( const String &filename );
+    void close();
+    bool isOpen() const;
+    uc8 *getData() const;
+    ui64 getSize() const;
+    /// @brief  Gives a hint how a range of the file will be accessed, a size of 0 means up to the end.
+    void advise( AccessHint hint, ui64 offset = 0, ui64 size = 0 );
+
+    OSRE_NON_COPYABLE( MemoryMappedFile )
+
+private:
+    uc8 *m_data;
+    ui64 m_size;
+#ifdef OSRE_WINDOWS
+    void *m_file;
+    void *m_mapping;
+#endif
+};
+
+inline
+bool MemoryMappedFile::isOpen() const {
+    return nullptr != m_data;
+}
+
+inline
+uc8 *MemoryMappedFile::getData() const {
+    return m_data;
+}
+
+inline
+ui64 MemoryMappedFile::getSize() const {
+    return m_size;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,103 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/IO/Stream.h>
+
+#include <vector>
+
+namespace OSRE {
+namespace IO {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This class implements a stream onto a memory block. 
+///
+/// The stream either views memory owned by the caller, which will be read-only, or owns a buffer 
+/// which grows while writing. map returns the memory block itself, so data in memory can be 
+/// parsed in place by loaders accepting a stream.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT MemoryStream : public Stream {
+public:
+    /// @brief  Creates an empty stream owning its buffer, for reading and writing.
+    MemoryStream();
+
+    /// @brief  Creates a read-only stream viewing memory owned by the caller.
+    /// @param  data    [in] The memory, must stay valid while the stream is used.
+    /// @param  size    [in] The size of the memory in bytes.
+    MemoryStream( const void *data, ui64 size );
+
+    /// @brief  Creates a stream taking the ownership of a buffer, for reading and writing.
+    /// @param  buffer  [in] The buffer.
+    explicit MemoryStream( std::vector<uc8> &&buffer );
+
+    /// @brief  The class destructor.
+    ~MemoryStream();
+
+    bool canRead() const override;
+    bool canWrite() const override;
+    bool canSeek() const override;
+    bool canBeMapped() const override;
+    bool open() override;
+    bool close() override;
+    ui64 getSize() const override;
+    ui32 read( void *buffer, ui32 size ) override;
+    ui32 readAt( Position offset, void *buffer, ui32 size ) override;
+    ui32 write( const void *buffer, ui32 size ) override;
+    ui32 readI32( i32 &value ) override;
+    ui32 writeI32( i32 value ) override;
+    ui32 readUI32( ui32 &value ) override;
+    ui32 writeUI32( ui32 value ) override;
+    ui32 readF32( f32 &value ) override;
+    ui32 writeF32( f32 value ) override;
+    ui32 readD32( d32 &value ) override;
+    ui32 writeD32( d32 value ) override;
+    Position seek( Offset offset, Origin origin ) override;
+    Position tell() override;
+    bool isOpen() const override;
+    const uc8 *map( ui64 &size ) override;
+
+    /// @brief  Returns true, when the stream owns its buffer.
+    bool isOwner() const;
+
+    OSRE_NON_COPYABLE( MemoryStream )
+
+private:
+    const uc8 *getData() const;
+
+private:
+    std::vector<uc8> m_buffer;
+    const uc8 *m_view;
+    ui64 m_viewSize;
+    Position m_pos;
+    bool m_isOpen;
+};
+
+inline
+bool MemoryStream::isOwner() const {
+    return nullptr == m_view;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <vector>
+
+namespace OSRE {
+
+// Forward declarations
+namespace Threading {
+    class ThreadPool;
+}
+
+namespace IO {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Describes the pak archive format. 
+///
+/// A pak archive starts with the header, followed by the entry data, the index and the names. The 
+/// index is sorted by the hash of the entry names, so a lookup is a binary search. Compressed 
+/// entries are split into chunks, which are compressed independently, so any range of an entry 
+/// can be read without decompressing the data in front of it and chunks can be decompressed in 
+/// parallel. A compressed entry starts with the table of the compressed chunk sizes, a chunk 
+/// with the same size as the uncompressed chunk is stored uncompressed. Stored entries are 
+/// aligned, so their data can be used directly from a mapping of the archive.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT PakArchive {
+public:
+    /// @brief  The compression of an entry.
+    enum class Codec : uc8 {
+        Stored = 0,     ///< Not compressed.
+        LZ4,            ///< LZ4, fast to decompress.
+        Deflate         ///< Deflate, better ratio but slower.
+    };
+
+    /// @brief  The archive header.
+    struct Header {
+        c8 m_magic[ 4 ];
+        ui32 m_version;
+        ui32 m_numEntries;
+        ui32 m_chunkSize;
+        ui64 m_indexOffset;
+        ui64 m_namesOffset;
+        ui64 m_namesSize;
+    };
+
+    /// @brief  An entry of the index.
+    struct Entry {
+        ui64 m_hash;
+        ui64 m_offset;
+        ui64 m_size;
+        ui64 m_packedSize;
+        ui32 m_nameOffset;
+        ui32 m_nameLength;
+        uc8 m_codec;
+        uc8 m_padding[ 7 ];
+    };
+
+    static const c8 Magic[ 4 ];
+    static const ui32 Version;
+    static const ui32 DefaultChunkSize;
+    static const ui32 Alignment;
+
+    /// @brief  Normalizes an entry name, separators are slashes and there is no leading slash.
+    /// @param  name        [in] The name.
+    /// @return The normalized name.
+    static String normalizeName( const String &name );
+
+    /// @brief  Returns the hash of a normalized entry name.
+    /// @param  name        [in] The normalized name.
+    /// @return The hash.
+    static ui64 hashName( const String &name );
+
+    /// @brief  Returns the number of chunks of an entry.
+    /// @param  size        [in] The uncompressed size of the entry.
+    /// @param  chunkSize   [in] The chunk size of the archive.
+    /// @return The number of chunks.
+    static ui64 getNumChunks( ui64 size, ui32 chunkSize );
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Writes a pak archive. The entries are compressed when they get added, the chunks of 
+/// an entry are compressed in parallel.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT PakWriter {
+public:
+    /// @brief  The class constructor.
+    /// @param  chunkSize   [in] The size of the compressed chunks.
+    explicit PakWriter( ui32 chunkSize = PakArchive::DefaultChunkSize );
+
+    /// @brief  The class destructor.
+    ~PakWriter();
+
+    /// @brief  Adds data as a new entry.
+    /// @param  name        [in] The entry name.
+    /// @param  data        [in] The data.
+    /// @param  size        [in] The size of the data.
+    /// @param  codec       [in] The compression, data which does not compress will be stored.
+    /// @return true, if the entry was added, false if the name is used already.
+    bool addData( const String &name, const void *data, ui64 size, PakArchive::Codec codec );
+
+    /// @brief  Adds a file as a new entry.
+    /// @param  name        [in] The entry name.
+    /// @param  filename    [in] The file to add.
+    /// @param  codec       [in] The compression, data which does not compress will be stored.
+    /// @return true, if the entry was added.
+    bool addFile( const String &name, const String &filename, PakArchive::Codec codec );
+
+    /// @brief  Writes the archive.
+    /// @param  filename    [in] The archive file.
+    /// @return true, if successful.
+    bool write( const String &filename ) const;
+
+    /// @brief  Returns the number of added entries.
+    /// @return The number of entries.
+    ui32 getNumEntries() const;
+
+    OSRE_NON_COPYABLE( PakWriter )
+
+private:
+    struct Item {
+        String m_name;
+        ui64 m_size;
+        PakArchive::Codec m_codec;
+        std::vector<uc8> m_data;
+    };
+
+    ui32 m_chunkSize;
+    std::vector<Item> m_items;
+    Threading::ThreadPool *m_pool;
+};
+
+inline
+ui32 PakWriter::getNumEntries() const {
+    return static_cast<ui32>( m_items.size() );
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/osre_common.h>
 #include <osre/IO/Uri.h>
 
+#include <algorithm>
+#include <type_traits>
+
 namespace OSRE {
 namespace IO {
 
@@ -41,8 +44,8 @@ class Uri;
 //-------------------------------------------------------------------------------------------------
 class OSRE_EXPORT Stream {
 public:
-    typedef ui32 Position;      ///< The current position.
-    typedef ui32 Offset;        ///< The offset from the current position.
+    typedef ui64 Position;      ///< The current position.
+    typedef i64 Offset;         ///< The offset from the origin.
     
     /// @brief  Enumerates the type of access.
     enum class AccessMode	{
@@ -115,7 +118,7 @@ public:
     
     /// @brief  Returns the file size.
     /// @return The file size.
-    virtual ui32 getSize() const;
+    virtual ui64 getSize() const;
     
     /// @brief  Reads a given number of bytes from the stream.
     /// @param  buffer          [in] The buffer to read in.
@@ -123,6 +126,15 @@ public:
     /// @return The number of read bytes.
     virtual ui32 read( void *buffer, ui32 size );
     
+    /// @brief  Reads a given number of bytes at a position, the current position stays unchanged.
+    /// @param  offset          [in] The position to read from.
+    /// @param  buffer          [in] The buffer to read in.
+    /// @param  size            [in] The number of bytes to read.
+    /// @return The number of read bytes.
+    /// @remark Streams reading without a cursor can be used by several readers at once, the default 
+    /// implementation seeks and is not thread-safe.
+    virtual ui32 readAt( Position offset, void *buffer, ui32 size );
+
     /// @brief  Writes a given number of bytes into the stream.
     /// @param  buffer          [out] The buffer to write.
     /// @param  size            [in] The number of bytes to write.
@@ -169,6 +181,14 @@ public:
     /// @return The number of written bytes.
     virtual ui32 writeD32( d32 value );
 
+    /// @brief  Reads an array of values with one read.
+    /// @param  data            [out] The array to read into.
+    /// @param  count           [in] The number of values.
+    /// @param  swapEndian      [in] true to swap the byte order of every value, for scalar types.
+    /// @return The number of read values.
+    template<class T>
+    ui32 readArray( T *data, ui32 count, bool swapEndian = false );
+
     /// @brief  Moves to the current position.
     /// @param  offset          [in] The offset.
     /// @param  origin          [in] The origin.
@@ -183,10 +203,34 @@ public:
     ///	@return true, if file is open.
     virtual bool isOpen() const;
 
+    /// @brief  Maps the whole content of the stream into memory without copying it.
+    /// @param  size            [out] The size of the content in bytes.
+    /// @return The content, valid until the stream gets closed, nullptr if mapping is not supported.
+    virtual const uc8 *map( ui64 &size );
+
 public:
     Uri m_Uri;
     AccessMode m_AccessMode;
 };
 
+template<class T>
+inline
+ui32 Stream::readArray( T *data, ui32 count, bool swapEndian ) {
+    static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be read." );
+    if ( nullptr == data || 0 == count || count > 0xFFFFFFFFu / sizeof( T ) ) {
+        return 0;
+    }
+
+    const ui32 numRead( read( data, count * static_cast<ui32>( sizeof( T ) ) ) / static_cast<ui32>( sizeof( T ) ) );
+    if ( swapEndian && sizeof( T ) > 1 ) {
+        uc8 *bytes( reinterpret_cast<uc8*>( data ) );
+        for ( ui32 i = 0; i < numRead; ++i ) {
+            std::reverse( bytes + i * sizeof( T ), bytes + ( i + 1 ) * sizeof( T ) );
+        }
+    }
+
+    return numRead;
+}
+
 } // Namespace IO
 } // Namespace OSRE
@@ -71,6 +71,7 @@ public:
         PollingMode,            ///< Polling mode, true for polling requested.
         DefaultFont,            ///< The default font for rendering.
         RenderMode,             ///> The requested render mode ( 2D or 3D, default 3D ).
+        AccessTraceFile,        ///< The trace file for the startup prefetch, empty to disable it.
         MaxKonfigKey			///< The upper limit.
     };
 
@@ -40,6 +40,7 @@ struct OSRE_EXPORT Geometry {
     ui32            m_numPrimGroups;
     PrimitiveGroup *m_pPrimGroups;
     ui32            m_id;
+    ui64            m_serial;   ///< Never reused, unlike the id, so caches can detect a new geometry at the same address
 
     static Geometry *create( ui32 numGeo );
     static void destroy( Geometry **geo );
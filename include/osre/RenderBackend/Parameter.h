@@ -167,6 +167,12 @@ struct Frame {
     GeometryPackage **m_geoPackages;
     ui32              m_numGeoUpdates;
     Geometry        **m_geoUpdates;
+    ui32              m_numPrimGroupUpdates;
+    Geometry        **m_primGroupUpdates;
+    ui32              m_numGeoDetaches;
+    ui32             *m_geoDetaches;
+    ui32              m_numHiddenGeos;
+    ui32             *m_hiddenGeos;
     ui32              m_numLights;
     Light           **m_lights;
     GeoInstanceData   *m_geoInstanceData;
@@ -181,6 +187,12 @@ struct Frame {
     , m_geoPackages( nullptr )
     , m_numGeoUpdates( 0 )
     , m_geoUpdates( nullptr )
+    , m_numPrimGroupUpdates( 0 )
+    , m_primGroupUpdates( nullptr )
+    , m_numGeoDetaches( 0 )
+    , m_geoDetaches( nullptr )
+    , m_numHiddenGeos( 0 )
+    , m_hiddenGeos( nullptr )
     , m_numLights( 0 )
     , m_lights( nullptr )
     , m_geoInstanceData( nullptr )
@@ -192,6 +192,19 @@ public:
 
     void attachGeoUpdate( const CPPCore::TArray<Geometry*> &geoArray );
 
+    /// @brief  Will update the primitive groups of an attached geometry with the next frame, e.g. after 
+    /// a LOD switch. The buffers will not be uploaded again.
+    /// @param  geo     [in] The geometry with the changed primitive groups.
+    void attachPrimGroupUpdate( Geometry *geo );
+
+    /// @brief  Will detach a geometry, its render data will be released with the next frame.
+    /// @param  geo     [in] The geometry to detach, must be detached before it gets destroyed.
+    void detachGeo( Geometry *geo );
+
+    /// @brief  Will skip the draw calls of an attached geometry in the next frame, e.g. when it is occluded.
+    /// @param  geo     [in] The hidden geometry, must be reported again for each frame.
+    void hideGeo( Geometry *geo );
+
     void attachView( TransformMatrixBlock &transform );
 
     void resize( ui32 x, ui32 y, ui32 w, ui32 h);
@@ -233,6 +246,9 @@ private:
     UI::Widget *m_screen;
     CPPCore::TArray<NewGeoEntry*> m_newGeo;
     CPPCore::TArray<Geometry*> m_geoUpdates;
+    CPPCore::TArray<Geometry*> m_primGroupUpdates;
+    CPPCore::TArray<ui32> m_geoDetaches;
+    CPPCore::TArray<ui32> m_hiddenGeos;
     CPPCore::TArray<GeoInstanceData*> m_newInstances;
     CPPCore::THashMap<ui32, UniformVar*> m_variables;
     CPPCore::TArray<UniformVar*> m_uniformUpdates;
@@ -34,6 +34,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <memory>
+
 namespace OSRE {
 namespace RenderBackend {
 
@@ -72,6 +74,8 @@ enum class BufferAccessType {
 enum class VertexType {
     ColorVertex = 0,            ///< A simple vertex consisting of position and color.
     RenderVertex,               ///< A render vertex with position, color, normals and texture coordinates.
+    CompactRenderVertex,        ///< A render vertex with float position and packed normal, color and texture coordinates.
+    QuantizedRenderVertex,      ///< A compact render vertex with the position quantized to the mesh bounds.
     NumVertexTypes,             ///< Number of enums.
     
     InvalidVertexType           ///< Enum for invalid enum.
@@ -185,6 +189,45 @@ struct OSRE_EXPORT RenderVert {
     static const String *getAttributes();
 };
 
+struct VertexLayout;
+
+///	@brief  This struct declares a compact render vertex. The normal is octahedral encoded, the 
+/// color is stored as RGBA8 and the texture coordinates as half floats.
+struct OSRE_EXPORT CompactRenderVert {
+    glm::vec3 position;     ///< The position ( x|y|z )
+    i16       normal[ 2 ];  ///< The octahedral encoded normal, snorm16
+    uc8       color0[ 4 ];  ///< The diffuse color ( r|g|b|a ), unorm8
+    ui16      tex0[ 2 ];    ///< The texture coordinates ( u|v ), half float
+
+    CompactRenderVert();
+
+    /// @brief  Returns the number of attributes.
+    static ui32 getNumAttributes();
+    /// @brief  Returns the attribute array.
+    static const String *getAttributes();
+    /// @brief  Adds the components of the vertex to the layout.
+    static void getLayout( VertexLayout &layout );
+};
+
+///	@brief  This struct declares a quantized render vertex. The position is stored as unorm16 
+/// relative to the bounds of the mesh, the decoding is part of the local matrix of the geometry.
+/// The other attributes are packed like in the CompactRenderVert.
+struct OSRE_EXPORT QuantizedRenderVert {
+    ui16 position[ 4 ];     ///< The quantized position ( x|y|z ), unorm16, w is unused
+    i16  normal[ 2 ];       ///< The octahedral encoded normal, snorm16
+    uc8  color0[ 4 ];       ///< The diffuse color ( r|g|b|a ), unorm8
+    ui16 tex0[ 2 ];         ///< The texture coordinates ( u|v ), half float
+
+    QuantizedRenderVert();
+
+    /// @brief  Returns the number of attributes.
+    static ui32 getNumAttributes();
+    /// @brief  Returns the attribute array.
+    static const String *getAttributes();
+    /// @brief  Adds the components of the vertex to the layout.
+    static void getLayout( VertexLayout &layout );
+};
+
 ///	@brief  This enum to describes the type of the vertex attribute.
 enum class VertexAttribute : int {
     Position = 0,       ///< "position"
@@ -220,6 +263,10 @@ enum class VertexFormat : int {
     UByte4,                 ///< 4-component float (0.0f..255.0f) mapped to byte (0..255)
     Short2,                 ///< 2-component float (-32768.0f..+32767.0f) mapped to short (-32768..+32768)
     Short4,                 ///< 4-component float (-32768.0f..+32767.0f) mapped to short (-32768..+32768)
+    Short2N,                ///< 2-component float (-1.0f..+1.0f) mapped to normalized short
+    UShort4N,               ///< 4-component float (0.0f..1.0f) mapped to normalized unsigned short
+    UByte4N,                ///< 4-component float (0.0f..1.0f) mapped to normalized unsigned byte
+    Half2,                  ///< 2-component half float, expanded to (x, y, 0, 1)
     NumVertexFormats,       ///< Number of enums.
 
     InvalidVertexFormat,    ///< Enum for invalid enum.
@@ -254,6 +301,16 @@ ui32 getVertexFormatSize( VertexFormat format ) {
         case VertexFormat::Short4:
             size = sizeof( ui16 ) * 4;
             break;
+        case VertexFormat::Short2N:
+        case VertexFormat::Half2:
+            size = sizeof( ui16 ) * 2;
+            break;
+        case VertexFormat::UShort4N:
+            size = sizeof( ui16 ) * 4;
+            break;
+        case VertexFormat::UByte4N:
+            size = sizeof( uc8 ) * 4;
+            break;
         case VertexFormat::NumVertexFormats:
         case VertexFormat::InvalidVertexFormat:
             break;
@@ -265,6 +322,12 @@ ui32 getVertexFormatSize( VertexFormat format ) {
     return size;
 }
 
+///	@brief  Utility function to check if the format is mapped to a normalized range.
+inline
+bool isVertexFormatNormalized( VertexFormat format ) {
+    return VertexFormat::Short2N == format || VertexFormat::UShort4N == format || VertexFormat::UByte4N == format;
+}
+
 /// @brief  This struct declares an extension description.
 struct ExtensionProperty {
     c8   m_extensionName[ MaxEntNameLen ];
@@ -316,10 +379,17 @@ struct OSRE_EXPORT BufferData {
     ui32             m_size;    ///< The size of the buffer
     ui32             m_cap;
     BufferAccessType m_access;  ///< Access token ( @see BufferAccessType )
+    bool             m_owned;   ///< false for buffers viewing external memory
+    std::shared_ptr<void> m_storage; ///< Keeps the external memory of a view alive, may be empty
 
     BufferData();
     ~BufferData();
     static BufferData *alloc( BufferType type, ui32 sizeInBytes, BufferAccessType access );
+    /// @brief  Creates a buffer viewing the data without copying it. The memory must outlive 
+    /// the buffer unless the buffer holds its storage. Growing the buffer will switch it to an 
+    /// own copy.
+    static BufferData *wrap( BufferType type, void *data, ui32 sizeInBytes, BufferAccessType access,
+            const std::shared_ptr<void> &storage = std::shared_ptr<void>() );
 	static void free( BufferData *data );
     void copyFrom( void *data, ui32 size );
     void attach( void *data, ui32 size );
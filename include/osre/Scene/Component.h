@@ -40,6 +40,7 @@ namespace RenderBackend {
 namespace Scene {
 
 class Node;
+class LodSet;
 
 //-------------------------------------------------------------------------------------------------
 ///	@ingroup	Engine
@@ -49,6 +50,13 @@ class Node;
 class OSRE_EXPORT Component {
 public:
     virtual ~Component();
+
+    /// @brief  Updates the component. The stage may update independent subtrees in parallel, so 
+    /// implementations must follow these rules: only write the state of the own node and its 
+    /// components, reading the state of the parent nodes is fine, because a parent is always 
+    /// updated before its children. Nodes must not be added or removed and no render backend 
+    /// calls are allowed, this belongs into draw.
+    /// @param  dt      [in] The time step.
     virtual void update( Time dt ) = 0;
     virtual void draw( RenderBackend::RenderBackendService *renderBackendSrv ) = 0;
     void setId( ui32 id );
@@ -91,10 +99,24 @@ public:
     void draw( RenderBackend::RenderBackendService *renderBackendSrv ) override;
     ui32 getNumGeometry() const;
     RenderBackend::Geometry *getGeoAt(ui32 idx) const;
+    ui32 getNumAttachedGeometry() const;
+    RenderBackend::Geometry *getAttachedGeoAt( ui32 idx ) const;
     void addStaticGeometry( RenderBackend::Geometry *geo );
+    /// @brief  Removes a geometry, an attached one will be detached from the render backend.
+    bool removeGeometry( RenderBackend::Geometry *geo );
+    void addLodSet( LodSet *lodSet );
+    ui32 getNumLodSets() const;
+    LodSet *getLodSetAt( ui32 idx ) const;
+    void updateLod( const glm::mat4 &view, const glm::mat4 &projection );
+    /// @brief  Reports the attached geometries as hidden for the next frame, e.g. when the node is occluded.
+    void hide( RenderBackend::RenderBackendService *renderBackendSrv );
 
 private:
     CPPCore::TArray<RenderBackend::Geometry*> m_newGeo;
+    CPPCore::TArray<RenderBackend::Geometry*> m_attachedGeo;
+    CPPCore::TArray<LodSet*> m_lodSets;
+    ui32 m_numAttachedLodSets;
+    RenderBackend::RenderBackendService *m_renderBackendSrv;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -0,0 +1,143 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/TAABB.h>
+#include <cppcore/Container/TArray.h>
+
+#include <glm/glm.hpp>
+
+namespace OSRE {
+
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Scene {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Describes one detail level inside of a LOD set. The level will be used as long as 
+/// the projected size of the set is greater than or equal to m_minScreenSize.
+//-------------------------------------------------------------------------------------------------
+struct LodLevel {
+    ui32 m_startIndex;
+    ui32 m_numIndices;
+    f32  m_minScreenSize;
+
+    LodLevel();
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A LOD set stores several detail levels of a mesh in one shared vertex- and index 
+/// buffer. Only one proxy geometry will be attached to the renderer, a level switch just changes 
+/// the index range of its primitive group. To avoid popping the levels will be switched with 
+/// a hysteresis around the screen-size thresholds.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT LodSet {
+public:
+    using AABB = Collision::TAABB<f32>;
+
+    LodSet();
+    ~LodSet();
+    bool addLevel( const RenderBackend::Geometry *geo, f32 minScreenSize );
+    ui32 getNumLevels() const;
+    const LodLevel &getLevelAt( ui32 idx ) const;
+    RenderBackend::Geometry *getGeometry() const;
+    const AABB &getAABB() const;
+    void setHysteresis( f32 hysteresis );
+    f32 getHysteresis() const;
+    ui32 select( f32 screenSize );
+    ui32 getActiveLevel() const;
+    bool isChanged() const;
+    void resetChanged();
+
+    /// @brief  Computes the projected size of a box as a fraction of the viewport height.
+    static f32 computeScreenSize( const AABB &box, const glm::mat4 &world, const glm::mat4 &view, 
+            const glm::mat4 &projection );
+
+    OSRE_NON_COPYABLE( LodSet )
+
+private:
+    void setActiveLevel( ui32 level );
+
+private:
+    CPPCore::TArray<LodLevel> m_levels;
+    RenderBackend::Geometry *m_geo;
+    AABB m_aabb;
+    f32 m_hysteresis;
+    ui32 m_activeLevel;
+    bool m_changed;
+};
+
+inline
+ui32 LodSet::getNumLevels() const {
+    return m_levels.size();
+}
+
+inline
+const LodLevel &LodSet::getLevelAt( ui32 idx ) const {
+    return m_levels[ idx ];
+}
+
+inline
+RenderBackend::Geometry *LodSet::getGeometry() const {
+    return m_geo;
+}
+
+inline
+const LodSet::AABB &LodSet::getAABB() const {
+    return m_aabb;
+}
+
+inline
+void LodSet::setHysteresis( f32 hysteresis ) {
+    m_hysteresis = hysteresis;
+}
+
+inline
+f32 LodSet::getHysteresis() const {
+    return m_hysteresis;
+}
+
+inline
+ui32 LodSet::getActiveLevel() const {
+    return m_activeLevel;
+}
+
+inline
+bool LodSet::isChanged() const {
+    return m_changed;
+}
+
+inline
+void LodSet::resetChanged() {
+    m_changed = false;
+}
+
+} // Namespace Scene
+} // Namespace OSRE
@@ -116,8 +116,14 @@ public:
     virtual Component *getComponent( ComponentType type ) const;
     virtual void setActive( bool isActive );
     virtual bool isActive() const;
+    virtual void setStatic( bool isStatic );
+    virtual bool isStatic() const;
     virtual void setProperty( Properties::Property *prop );
     virtual Properties::Property *getProperty(const String name) const;
+    /// @brief  Returns a counter which changes with every transform, geometry or hierarchy change 
+    /// of any node, data built from the nodes compares it to detect that it is outdated.
+    static ui32 getChangeCount();
+    static void notifyChanged();
 
 protected:
     virtual void onUpdate(Time dt);
@@ -130,6 +136,7 @@ private:
     ChildrenArray m_children;
     Node *m_parent;
     bool m_isActive;
+    bool m_isStatic;
     RenderComponent *m_renderComp;
     TransformComponent *m_transformComp;
     CPPCore::TArray<Component*> m_components;
@@ -140,7 +147,10 @@ private:
 
 inline
 void Node::setActive(bool isActive) {
-    m_isActive = isActive;
+    if ( isActive != m_isActive ) {
+        m_isActive = isActive;
+        notifyChanged();
+    }
 }
 
 inline
@@ -148,6 +158,16 @@ bool Node::isActive() const {
     return m_isActive;
 }
 
+inline
+void Node::setStatic( bool isStatic ) {
+    m_isStatic = isStatic;
+}
+
+inline
+bool Node::isStatic() const {
+    return m_isStatic;
+}
+
 inline
 void Node::setAABB(const AABB &aabb) {
     m_aabb = aabb;
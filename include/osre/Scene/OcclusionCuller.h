@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/TAABB.h>
+#include <cppcore/Container/TArray.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace OSRE {
+
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Threading {
+    class ThreadPool;
+}
+
+namespace Scene {
+
+class Node;
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A CPU occlusion culler. Registered occluder meshes will be rasterized into a low 
+/// resolution depth buffer, the buffer is split into tiles which can be rasterized in parallel. 
+/// Bounding boxes will be tested against a hierarchical max-depth pyramid built from it. The 
+/// depth convention is 0 for the near and 1 for the far plane.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT OcclusionCuller {
+public:
+    using AABB = Collision::TAABB<f32>;
+
+    OcclusionCuller( ui32 width = 256, ui32 height = 128 );
+    ~OcclusionCuller();
+    void setThreadPool( Threading::ThreadPool *threadPool );
+    Threading::ThreadPool *getThreadPool() const;
+    void addOccluder( const RenderBackend::Geometry *geo, Node *node );
+    bool removeOccluder( const RenderBackend::Geometry *geo );
+    ui32 getNumOccluders() const;
+    void beginFrame( const glm::mat4 &viewProjection );
+    void submitOccluder( const RenderBackend::Geometry *geo, const glm::mat4 &world );
+    void endFrame();
+    void update( const glm::mat4 &viewProjection );
+    bool isVisible( const AABB &box, const glm::mat4 &world ) const;
+    ui32 getWidth() const;
+    ui32 getHeight() const;
+    f32 getDepth( ui32 x, ui32 y ) const;
+    ui32 getNumHiZLevels() const;
+
+    OSRE_NON_COPYABLE( OcclusionCuller )
+
+private:
+    struct ScreenTriangle {
+        f32 m_x[ 3 ];
+        f32 m_y[ 3 ];
+        f32 m_z[ 3 ];
+    };
+
+    struct Occluder {
+        const RenderBackend::Geometry *m_geo;
+        Node *m_node;
+    };
+
+    struct HiZLevel {
+        ui32 m_width;
+        ui32 m_height;
+        std::vector<f32> m_depth;
+    };
+
+    void rasterizeTile( ui32 tileIdx );
+    void buildHiZ();
+
+private:
+    ui32 m_width;
+    ui32 m_height;
+    ui32 m_numTilesX;
+    ui32 m_numTilesY;
+    glm::mat4 m_viewProjection;
+    std::vector<f32> m_depth;
+    std::vector<HiZLevel> m_hiZ;
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<std::vector<ui32>> m_tileBins;
+    CPPCore::TArray<Occluder> m_occluders;
+    Threading::ThreadPool *m_threadPool;
+};
+
+inline
+void OcclusionCuller::setThreadPool( Threading::ThreadPool *threadPool ) {
+    m_threadPool = threadPool;
+}
+
+inline
+Threading::ThreadPool *OcclusionCuller::getThreadPool() const {
+    return m_threadPool;
+}
+
+inline
+ui32 OcclusionCuller::getNumOccluders() const {
+    return m_occluders.size();
+}
+
+inline
+ui32 OcclusionCuller::getWidth() const {
+    return m_width;
+}
+
+inline
+ui32 OcclusionCuller::getHeight() const {
+    return m_height;
+}
+
+inline
+ui32 OcclusionCuller::getNumHiZLevels() const {
+    return static_cast<ui32>( m_hiZ.size() );
+}
+
+} // Namespace Scene
+} // Namespace OSRE
@@ -0,0 +1,126 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/Bvh4.h>
+#include <cppcore/Container/TArray.h>
+
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
+
+namespace OSRE {
+
+namespace RenderBackend {
+    struct Geometry;
+}
+
+namespace Collision {
+    class TriangleBvh;
+}
+
+namespace Scene {
+
+class Node;
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Describes the hit of a ray cast into the stage.
+//-------------------------------------------------------------------------------------------------
+struct RaycastHit {
+    Node *m_node;
+    RenderBackend::Geometry *m_geo;
+    ui32 m_triangle;
+    f32 m_distance;
+    glm::vec3 m_position;
+
+    RaycastHit();
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  The spatial index for ray queries against the geometry of a node tree. Each 
+/// geometry gets a triangle BVH in object space, which is shared by all nodes using it and 
+/// kept between rebuilds. The instances are stored with their world bounds in a top level BVH, 
+/// rays are transformed into object space for the triangle tests. The distances are returned 
+/// in units of the ray direction.
+///
+/// The world transforms are captured by build, so it must be called again after moving nodes.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT RaycastIndex {
+public:
+    using Ray = Collision::TRay<f32>;
+
+    RaycastIndex();
+    ~RaycastIndex();
+    ui32 build( Node *root );
+    void clear();
+    bool raycast( const Ray &ray, RaycastHit &hit, f32 maxDist ) const;
+    ui32 raycastAll( const Ray &ray, CPPCore::TArray<RaycastHit> &hits, f32 maxDist ) const;
+    ui32 raycastPacket( const Ray *rays, ui32 numRays, RaycastHit *hits, f32 maxDist ) const;
+    ui32 getNumInstances() const;
+    ui32 getNumMeshes() const;
+
+    OSRE_NON_COPYABLE( RaycastIndex )
+
+private:
+    struct Instance {
+        Node *m_node;
+        RenderBackend::Geometry *m_geo;
+        const Collision::TriangleBvh *m_mesh;
+        glm::mat4 m_world;
+        glm::mat4 m_invWorld;
+    };
+
+    struct MeshEntry {
+        Collision::TriangleBvh *m_bvh;
+        ui64 m_serial;
+        bool m_used;
+    };
+
+    void collectInstances( Node *node );
+    void addInstance( Node *node, RenderBackend::Geometry *geo, const glm::mat4 &world, ui32 startIndex, ui32 numIndices );
+    Collision::Bvh4::Ray toObjectSpace( const Instance &instance, const Collision::Bvh4::Ray &ray ) const;
+
+private:
+    std::vector<Instance> m_instances;
+    std::map<const RenderBackend::Geometry*, MeshEntry> m_meshes;
+    Collision::Bvh4 m_bvh;
+};
+
+inline
+ui32 RaycastIndex::getNumInstances() const {
+    return static_cast<ui32>( m_instances.size() );
+}
+
+inline
+ui32 RaycastIndex::getNumMeshes() const {
+    return static_cast<ui32>( m_meshes.size() );
+}
+
+} // Namespace Scene
+} // Namespace OSRE
@@ -23,8 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <osre/Common/Object.h>
+#include <osre/Collision/TRay.h>
 #include <cppcore/Container/THashMap.h>
 
+#include <vector>
+
 namespace OSRE {
 
 // Forward declarations
@@ -41,10 +44,19 @@ namespace RenderBackend {
     class RenderBackendService;
 }
 
+namespace Threading {
+    class ThreadPool;
+}
+
 namespace Scene {
 
 class Node;
 class View;
+class StaticBatcher;
+class OcclusionCuller;
+class RaycastIndex;
+
+struct RaycastHit;
 
 //-------------------------------------------------------------------------------------------------
 ///	@ingroup	Engine
@@ -105,15 +117,44 @@ public:
     virtual Node *findNode( const String &name ) const;
     virtual View *addView( const String &name, Node *parent );
     virtual void clear();
+    /// @brief  Updates the stage. With enabled node updates all active nodes will be updated, 
+    /// parents before their children. With a thread pool and more active nodes than the threshold 
+    /// sibling subtrees will be updated in parallel, see Component::update for the contract.
     virtual void update(Time dt );
     virtual void draw( RenderBackend::RenderBackendService *renderBackendSrv );
     virtual void setIdContainer( Common::Ids &ids );
     virtual Common::Ids *getIdContainer() const;
+    /// @brief  Merges the static nodes into batches, a former batch node will be replaced.
+    virtual ui32 buildStaticBatches();
+    virtual StaticBatcher *getStaticBatcher() const;
+    virtual void setOcclusionCuller( OcclusionCuller *culler );
+    virtual OcclusionCuller *getOcclusionCuller() const;
+    /// @brief  Enables the update of the nodes by Stage::update, disabled by default.
+    virtual void setNodeUpdateEnabled( bool enabled );
+    virtual bool isNodeUpdateEnabled() const;
+    virtual void setThreadPool( Threading::ThreadPool *threadPool );
+    virtual Threading::ThreadPool *getThreadPool() const;
+    virtual void setParallelUpdateThreshold( ui32 numNodes );
+    virtual ui32 getParallelUpdateThreshold() const;
+    /// @brief  Returns the nearest hit of the ray with the geometry of the stage. The raycast 
+    /// index will be rebuilt when transforms, geometries or nodes changed since the last query, 
+    /// see Node::getChangeCount.
+    virtual bool raycast( const Collision::TRay<f32> &ray, RaycastHit &hit, f32 maxDist = 1e30f );
+    /// @brief  Appends all hits of the ray sorted by distance, returns the number of hits.
+    virtual ui32 raycastAll( const Collision::TRay<f32> &ray, CPPCore::TArray<RaycastHit> &hits, f32 maxDist = 1e30f );
+    /// @brief  Casts a batch of rays in packets, hits[ i ].m_node is nullptr for missing rays.
+    virtual ui32 raycastPacket( const Collision::TRay<f32> *rays, ui32 numRays, RaycastHit *hits, f32 maxDist = 1e30f );
+    virtual void invalidateRaycastIndex();
+    virtual RaycastIndex *getRaycastIndex();
 
 protected:
     virtual void onUpdate( Time dt );
+    void updateSubtree( ui32 idx, Time dt );
     virtual void onDraw( RenderBackend::RenderBackendService *renderBackendSrv );
 
+private:
+    void releaseStaticBatchNode();
+
 private:
     using ViewArray = CPPCore::TArray<View*>;
     using NodeFactoryMap = CPPCore::THashMap<ui32, AbstractNodeFactory*>;
@@ -124,6 +165,17 @@ private:
     TransformBlockCache m_transformBlocks;
     RenderBackend::RenderBackendService *m_rbService;
     Common::Ids *m_ids;
+    StaticBatcher *m_staticBatcher;
+    Node *m_staticBatchNode;
+    OcclusionCuller *m_occlusionCuller;
+    bool m_nodeUpdateEnabled;
+    Threading::ThreadPool *m_threadPool;
+    ui32 m_parallelUpdateThreshold;
+    std::vector<Node*> m_updateOrder;
+    std::vector<ui32> m_subtreeSizes;
+    RaycastIndex *m_raycastIndex;
+    bool m_raycastIndexDirty;
+    ui32 m_raycastChangeCount;
 };
 
 } // Namespace Scene
@@ -0,0 +1,180 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+#include <osre/Collision/TAABB.h>
+#include <cppcore/Container/TArray.h>
+
+namespace OSRE {
+
+// Forward declarations
+namespace Common {
+    class Ids;
+}
+
+namespace IO {
+    class Stream;
+}
+
+namespace RenderBackend {
+    class RenderBackendService;
+    struct Geometry;
+    struct Material;
+
+    enum class VertexType;
+}
+
+namespace Scene {
+
+class Node;
+class OcclusionCuller;
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  Describes one source mesh inside of a merged static batch. The index range is used to 
+/// cull the sub-mesh on its own, the bounding box is stored in world space.
+//-------------------------------------------------------------------------------------------------
+struct OSRE_EXPORT StaticBatchRange {
+    ui32 m_startIndex;              ///< First index of the sub-mesh in the batch index buffer.
+    ui32 m_numIndices;              ///< Number of indices of the sub-mesh.
+    ui32 m_baseVertex;              ///< First vertex of the sub-mesh in the batch vertex buffer.
+    ui32 m_numVertices;             ///< Number of vertices of the sub-mesh.
+    Collision::TAABB<f32> m_aabb;   ///< The world space bounds of the sub-mesh.
+    Node *m_sourceNode;             ///< The node of the source mesh, referenced by the batcher, nullptr for loaded batches.
+    RenderBackend::Geometry *m_sourceGeo; ///< The source mesh, nullptr for loaded batches.
+
+    StaticBatchRange();
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A static batch, all meshes sharing one material and one vertex layout merged into 
+/// one vertex and one index buffer.
+//-------------------------------------------------------------------------------------------------
+struct OSRE_EXPORT StaticBatch {
+    RenderBackend::Material *m_material;            ///< The shared material, not owned.
+    RenderBackend::VertexType m_vertexType;         ///< The shared vertex layout.
+    RenderBackend::Geometry *m_geo;                 ///< The merged geometry, owned by the batcher.
+    CPPCore::TArray<StaticBatchRange> m_ranges;     ///< The sub-mesh ranges.
+    Collision::TAABB<f32> m_aabb;                   ///< The world space bounds of the whole batch.
+
+    StaticBatch();
+    ~StaticBatch();
+
+    OSRE_NON_COPYABLE( StaticBatch )
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This class implements the static batching of immobile geometry.
+///
+/// All nodes flagged as static ( @see Node::setStatic ) will be collected. Their triangle 
+/// geometry will be pre-transformed into world space and merged by material and vertex type. 
+/// The merged geometry replaces the source geometry in the render components of the static 
+/// nodes. The batcher holds a reference to the source nodes until the batches are released, so 
+/// nodes removed from the stage in the meantime stay valid. The batches can be stored into a 
+/// stream, so the pass can run as an offline cook step as well.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT StaticBatcher {
+public:
+    using MaterialArray = CPPCore::TArray<RenderBackend::Material*>;
+
+    /// @brief  The class constructor.
+    StaticBatcher();
+
+    /// @brief  The class destructor, will release all batches.
+    ~StaticBatcher();
+
+    /// @brief  Will collect all static nodes of the given sub-tree and merge their geometry.
+    ///
+    /// The meshes of a former build will be given back to their nodes and merged again. A node 
+    /// created by createBatchNode draws the former batches, it must be released before.
+    /// @param  root        [in] The root node of the sub-tree.
+    /// @return The number of created batches.
+    ui32 build( Node *root );
+
+    /// @brief  Will create a new node, which renders all batches.
+    /// @param  name        [in] The name for the new node.
+    /// @param  ids         [in] The id container.
+    /// @param  parent      [in] The parent node.
+    /// @return The new node or nullptr, if no batch was built.
+    Node *createBatchNode( const String &name, Common::Ids &ids, Node *parent );
+
+    /// @brief  Returns the number of batches.
+    /// @return The number of batches.
+    ui32 getNumBatches() const;
+
+    /// @brief  Returns a batch by its index.
+    /// @param  idx         [in] The batch index.
+    /// @return The batch or nullptr in case of an invalid index.
+    const StaticBatch *getBatchAt( ui32 idx ) const;
+
+    /// @brief  Returns the number of source meshes, which were merged.
+    /// @return The number of merged meshes.
+    ui32 getNumMergedMeshes() const;
+
+    /// @brief  Writes all batches into a stream, used by the offline cook step.
+    /// @param  stream      [in] The stream to write in.
+    /// @return true, if successful.
+    bool save( IO::Stream &stream ) const;
+
+    /// @brief  Reads cooked batches from a stream.
+    /// @param  stream      [in] The stream to read from.
+    /// @param  materials   [in] The material table, batches store their material by index.
+    /// @return true, if successful.
+    bool load( IO::Stream &stream, const MaterialArray &materials );
+
+    /// @brief  Returns the material table, the order is used by save.
+    /// @return The material table.
+    const MaterialArray &getMaterials() const;
+
+    /// @brief  Will draw only the sub-meshes which pass the culler. Neighboured visible sub-meshes 
+    /// are drawn by one primitive group, changed groups will be updated with the next frame.
+    /// @param  culler      [in] The culler, updated for the active view.
+    /// @param  rbService   [in] The render backend service for the updates.
+    /// @return The number of culled sub-meshes.
+    ui32 cull( const OcclusionCuller &culler, RenderBackend::RenderBackendService *rbService );
+
+    /// @brief  Will draw all sub-meshes again, e.g. before the batches are read on the CPU.
+    /// @param  rbService   [in] The render backend service for the updates, nullptr for none.
+    void resetCulling( RenderBackend::RenderBackendService *rbService );
+
+    /// @brief  Will release all batches.
+    void clear();
+
+private:
+    StaticBatch *getBatch( RenderBackend::Material *material, RenderBackend::VertexType vertexType );
+    void restoreSources();
+
+private:
+    CPPCore::TArray<StaticBatch*> m_batches;
+    MaterialArray m_materials;
+    ui32 m_numMergedMeshes;
+};
+
+} // Namespace Scene
+} // namespace OSRE
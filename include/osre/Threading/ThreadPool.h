@@ -0,0 +1,105 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace OSRE {
+namespace Threading {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  A simple pool of worker threads for short, independent jobs. Jobs must not block on 
+/// each other. A thread waiting for its jobs in parallelFor or waitForAll helps to execute pending 
+/// jobs and sleeps otherwise, so the pool can be used recursively. Jobs waiting inside of the pool 
+/// do not count as pending, so waitForAll can be called from a job as well. A pool with zero 
+/// worker threads runs all jobs serial in the calling thread.
+///
+/// The workers are std::threads and not Platform threads: the IO services and the tools use 
+/// pools before a thread factory is installed, and the pool must join its workers.
+//-------------------------------------------------------------------------------------------------
+class OSRE_EXPORT ThreadPool {
+public:
+    /// @brief  The job type.
+    using Job = std::function<void()>;
+    /// @brief  The range job type, gets the begin and the end index of the range.
+    using RangeJob = std::function<void( ui32, ui32 )>;
+
+    /// @brief  The class constructor.
+    /// @param  numThreads  [in] The number of workers, -1 for one less than the number of cores.
+    explicit ThreadPool( i32 numThreads = -1 );
+
+    /// @brief  The class destructor, will wait for all pending jobs.
+    ~ThreadPool();
+
+    /// @brief  Returns the number of worker threads.
+    /// @return The number of worker threads.
+    ui32 getNumThreads() const;
+
+    /// @brief  Enqueues a new job.
+    /// @param  job         [in] The job to run.
+    void enqueue( const Job &job );
+
+    /// @brief  Waits until all enqueued jobs are done, except the ones waiting themselves.
+    void waitForAll();
+
+    /// @brief  Splits the range [0, count) into chunks and runs them in parallel. Returns when all 
+    /// chunks are done.
+    /// @param  count       [in] The number of items.
+    /// @param  grainSize   [in] The minimal number of items per chunk.
+    /// @param  job         [in] The job to run per chunk.
+    void parallelFor( ui32 count, ui32 grainSize, const RangeJob &job );
+
+    OSRE_NON_COPYABLE( ThreadPool )
+
+private:
+    void waitUntil( const std::function<bool()> &isDone );
+    void runJob( const Job &job );
+    void workerMain();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobCondition;
+    std::condition_variable m_doneCondition;
+    ui32 m_numActiveJobs;
+    ui32 m_numBlockedJobs;
+    bool m_shutdown;
+};
+
+inline
+ui32 ThreadPool::getNumThreads() const {
+    return static_cast<ui32>( m_workers.size() );
+}
+
+} // Namespace Threading
+} // Namespace OSRE
@@ -357,7 +357,11 @@ bool AppBase::onCreate( Properties::Settings *config ) {
         evHandler->registerEventListener( eventArray, m_mouseEvListener );
     }
 
-    IO::IOService::create();
+    IO::IOService *ioService( IO::IOService::create() );
+    const String traceFile( m_settings->get( Properties::Settings::AccessTraceFile ).getString() );
+    if ( !traceFile.empty() ) {
+        ioService->enableAccessTrace( traceFile );
+    }
 
     m_uiRenderer = new UI::UiRenderer;
 
@@ -374,6 +378,11 @@ bool AppBase::onDestroy() {
         return false;
     }
 
+    IO::IOService *ioService( IO::IOService::getInstance() );
+    if ( nullptr != ioService ) {
+        ioService->saveAccessTrace();
+    }
+
     Assets::AssetRegistry::destroy();
     ServiceProvider::destroy();
 
@@ -0,0 +1,361 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/AssetCooker.h>
+#include <osre/Assets/AssetRegistry.h>
+#include <osre/Assets/AssimpWrapper.h>
+#include <osre/Assets/CookedModel.h>
+#include <osre/Assets/CookedTexture.h>
+#include <osre/Assets/DerivedDataCache.h>
+#include <osre/Common/Ids.h>
+#include <osre/Common/Logger.h>
+#include <osre/IO/Directory.h>
+#include <osre/IO/Uri.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <assimp/Importer.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "AssetCooker";
+
+// The first line of a manifest, manifests of another version will be ignored
+static const String ManifestHeader = "manifest 2";
+
+static const c8 *TextureExtensions[] = {
+    ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".hdr"
+};
+
+static String getExtension( const String &filename ) {
+    const String::size_type pos( filename.rfind( '.' ) );
+    if ( String::npos == pos ) {
+        return String();
+    }
+
+    String ext( filename.substr( pos ) );
+    std::transform( ext.begin(), ext.end(), ext.begin(), ::tolower );
+
+    return ext;
+}
+
+AssetCooker::Statistics::Statistics()
+: m_numCooked( 0 )
+, m_numUpToDate( 0 )
+, m_numFailed( 0 ) {
+    // empty
+}
+
+AssetCooker::AssetCooker()
+: m_threadPool( nullptr )
+, m_forceRebuild( false )
+, m_manifest()
+, m_stats()
+, m_mutex() {
+    // empty
+}
+
+AssetCooker::~AssetCooker() {
+    // empty
+}
+
+void AssetCooker::setThreadPool( Threading::ThreadPool *threadPool ) {
+    m_threadPool = threadPool;
+}
+
+void AssetCooker::setForceRebuild( bool force ) {
+    m_forceRebuild = force;
+}
+
+bool AssetCooker::loadManifest( const String &filename ) {
+    std::ifstream file( filename.c_str() );
+    if ( !file.is_open() ) {
+        return true;
+    }
+
+    // asset <source>, followed by settings <settings>, output <file> and one dep <size> <time> <file>
+    // per dependency. Names and settings take the rest of their line, so they may contain spaces.
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_manifest.clear();
+    String line;
+    if ( !std::getline( file, line ) || ManifestHeader != line ) {
+        osre_info( Tag, "Ignoring outdated manifest " + filename + ", all assets will be cooked." );
+        return true;
+    }
+
+    Entry *entry( nullptr );
+    while ( std::getline( file, line ) ) {
+        std::istringstream stream( line );
+        String token;
+        stream >> token;
+        if ( "asset" == token ) {
+            String source;
+            std::getline( stream >> std::ws, source );
+            entry = &m_manifest[ source ];
+        } else if ( nullptr != entry && "settings" == token ) {
+            std::getline( stream >> std::ws, entry->m_settings );
+        } else if ( nullptr != entry && "output" == token ) {
+            std::getline( stream >> std::ws, entry->m_output );
+        } else if ( nullptr != entry && "dep" == token ) {
+            FileStamp stamp;
+            String dependency;
+            stream >> stamp.m_size >> stamp.m_time;
+            std::getline( stream >> std::ws, dependency );
+            entry->m_dependencies[ dependency ] = stamp;
+        } else if ( !token.empty() ) {
+            osre_error( Tag, "Invalid manifest " + filename );
+            m_manifest.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetCooker::saveManifest( const String &filename ) const {
+    // Written to a temporary file first, so an interrupted run keeps the former manifest
+    const String tmpName( filename + ".tmp" );
+    {
+        std::ofstream file( tmpName.c_str() );
+        if ( !file.is_open() ) {
+            osre_error( Tag, "Cannot write manifest " + filename );
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        file << ManifestHeader << "\n";
+        for ( const auto &asset : m_manifest ) {
+            const Entry &entry( asset.second );
+            file << "asset " << asset.first << "\n";
+            file << "settings " << entry.m_settings << "\n";
+            file << "output " << entry.m_output << "\n";
+            for ( const auto &dep : entry.m_dependencies ) {
+                file << "dep " << dep.second.m_size << " " << dep.second.m_time << " " << dep.first << "\n";
+            }
+        }
+        if ( !file.good() ) {
+            return false;
+        }
+    }
+    ::remove( filename.c_str() );
+
+    return 0 == ::rename( tmpName.c_str(), filename.c_str() );
+}
+
+bool AssetCooker::cookDirectory( const String &dir ) {
+    std::vector<String> files;
+    if ( !IO::Directory::getFiles( dir, true, files ) ) {
+        osre_error( Tag, "Cannot read directory " + dir );
+        return false;
+    }
+    std::sort( files.begin(), files.end() );
+
+    return cookFiles( files );
+}
+
+bool AssetCooker::cookFiles( const std::vector<String> &files ) {
+    m_stats = Statistics();
+    std::vector<std::pair<String, AssetType>> assets;
+    for ( const String &file : files ) {
+        const AssetType type( getAssetType( file ) );
+        if ( AssetType::Unknown != type ) {
+            assets.push_back( std::make_pair( file, type ) );
+        }
+    }
+
+    const ui32 numAssets( static_cast<ui32>( assets.size() ) );
+    Threading::ThreadPool::RangeJob job = [ this, &assets ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            cookAsset( assets[ i ].first, assets[ i ].second );
+        }
+    };
+    if ( nullptr != m_threadPool ) {
+        m_threadPool->parallelFor( numAssets, 1, job );
+    } else {
+        job( 0, numAssets );
+    }
+
+    osre_info( Tag, "Cooked " + std::to_string( m_stats.m_numCooked ) + ", up to date " 
+            + std::to_string( m_stats.m_numUpToDate ) + ", failed " + std::to_string( m_stats.m_numFailed ) );
+
+    return 0 == m_stats.m_numFailed;
+}
+
+AssetCooker::AssetType AssetCooker::getAssetType( const String &filename ) {
+    const String ext( getExtension( filename ) );
+    if ( ext.empty() ) {
+        return AssetType::Unknown;
+    }
+
+    for ( const c8 *textureExt : TextureExtensions ) {
+        if ( ext == textureExt ) {
+            return AssetType::Texture;
+        }
+    }
+
+    // Cooked files are no sources
+    if ( ext == CookedModel::getCookedName( "" ) || ext == CookedTexture::getCookedName( "" ) ) {
+        return AssetType::Unknown;
+    }
+
+    // Creating an importer sets up all loaders, so one is kept for all queries
+    static const Assimp::Importer importer;
+    if ( importer.IsExtensionSupported( ext.c_str() ) ) {
+        return AssetType::Model;
+    }
+
+    return AssetType::Unknown;
+}
+
+bool AssetCooker::cookAsset( const String &filename, AssetType type ) {
+    // The output name and the settings tell whether an asset has to be cooked again
+    Entry entry;
+    if ( AssetType::Model == type ) {
+        Common::Ids ids;
+        AssimpWrapper wrapper( ids );
+        entry.m_output = wrapper.getCookedFilename( filename );
+        entry.m_settings = "model:" + std::to_string( CookedModel::Version );
+    } else {
+        const CookedTexture::Options options;
+        entry.m_output = CookedTexture::getCookedName( filename );
+        DerivedDataCache *cache( AssetRegistry::getDerivedDataCache() );
+        if ( nullptr != cache ) {
+            const String derivedName( cache->getDerivedFilename( filename, CookedTexture::getSettings( options ), 
+                    CookedTexture::Version, CookedTexture::getCookedName( "" ) ) );
+            if ( !derivedName.empty() ) {
+                entry.m_output = derivedName;
+            }
+        }
+        entry.m_settings = "texture:" + std::to_string( CookedTexture::Version ) + ":" + CookedTexture::getSettings( options );
+    }
+
+    if ( !m_forceRebuild ) {
+        Entry recorded;
+        bool found( false );
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            std::map<String, Entry>::const_iterator it( m_manifest.find( filename ) );
+            if ( m_manifest.end() != it ) {
+                recorded = it->second;
+                found = true;
+            }
+        }
+        if ( found && recorded.m_output == entry.m_output && recorded.m_settings == entry.m_settings 
+                && isUpToDate( filename, recorded ) ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            ++m_stats.m_numUpToDate;
+            return true;
+        }
+    }
+
+    const bool ok( AssetType::Model == type ? cookModel( filename, entry ) : cookTexture( filename, entry ) );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( !ok ) {
+        osre_error( Tag, "Cannot cook " + filename );
+        m_manifest.erase( filename );
+        ++m_stats.m_numFailed;
+        return false;
+    }
+
+    osre_debug( Tag, "Cooked " + filename );
+    m_manifest[ filename ] = entry;
+    ++m_stats.m_numCooked;
+
+    return true;
+}
+
+bool AssetCooker::cookModel( const String &filename, Entry &entry ) {
+    Common::Ids ids;
+    AssimpWrapper wrapper( ids );
+    wrapper.setCookingEnabled( true );
+    // Only the derived data cache tracks the dependencies of a cooked model
+    wrapper.setCookedReuseEnabled( !m_forceRebuild && nullptr != AssetRegistry::getDerivedDataCache() );
+    wrapper.setThreadPool( m_threadPool );
+    if ( !wrapper.importAsset( IO::Uri( "file://" + filename ), 0 ) ) {
+        return false;
+    }
+    // The cooker keeps no model
+    AssimpWrapper::releaseModel( wrapper.getModel() );
+
+    FileStamp stamp;
+    if ( !getStamp( entry.m_output, stamp ) ) {
+        return false;
+    }
+
+    // The source and all files read while importing it, e.g. material libraries
+    std::set<String> dependencies( wrapper.getDependencies() );
+    dependencies.insert( filename );
+    for ( const String &dependency : dependencies ) {
+        if ( getStamp( dependency, stamp ) ) {
+            entry.m_dependencies[ dependency ] = stamp;
+        }
+    }
+
+    return true;
+}
+
+bool AssetCooker::cookTexture( const String &filename, Entry &entry ) {
+    if ( !CookedTexture::cook( filename, entry.m_output, CookedTexture::Options() ) ) {
+        return false;
+    }
+
+    FileStamp stamp;
+    if ( !getStamp( filename, stamp ) ) {
+        return false;
+    }
+    entry.m_dependencies[ filename ] = stamp;
+
+    return true;
+}
+
+bool AssetCooker::isUpToDate( const String &filename, const Entry &entry ) const {
+    FileStamp stamp;
+    if ( !getStamp( entry.m_output, stamp ) || entry.m_dependencies.end() == entry.m_dependencies.find( filename ) ) {
+        return false;
+    }
+
+    for ( const auto &dep : entry.m_dependencies ) {
+        if ( !getStamp( dep.first, stamp ) || stamp.m_size != dep.second.m_size || stamp.m_time != dep.second.m_time ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetCooker::getStamp( const String &filename, FileStamp &stamp ) {
+    return CookedModel::getSourceInfo( filename, stamp.m_size, stamp.m_time );
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -62,7 +62,11 @@ Scene::World *AssetDataArchive::load( const IO::Uri & fileLocation ) {
         return nullptr;
     }
     
-    const ui32 size(file->getSize());
+    if (file->getSize() > 0xFFFFFFFFull) {
+        IO::IOService::getInstance()->closeStream(&file);
+        return nullptr;
+    }
+    const ui32 size(static_cast<ui32>(file->getSize()));
     std::string doc;
     doc.resize(size);
     file->read(&doc[0], size);
@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Assets/AssetRegistry.h>
 #include <osre/Common/Logger.h>
 #include <osre/Common/StringUtils.h>
+#include <osre/IO/FileMetadataCache.h>
+#include <osre/IO/IOService.h>
 #include <osre/IO/Uri.h>
 #include <osre/IO/Stream.h>
 
@@ -57,7 +59,18 @@ bool AssetRegistry::registerAssetPath( const String &mount, const String &path )
         return false;
     }
     const ui32 hashId( StringUtils::hashName( mount ) );
-    s_instance->m_name2pathMap.insert( hashId, path );
+    {
+        std::lock_guard<std::mutex> lock( s_instance->m_resolveMutex );
+        s_instance->m_name2pathMap.insert( hashId, path );
+        s_instance->m_resolvedPaths.clear();
+    }
+
+    // Existence checks for assets below the mount point will be answered by the metadata cache, 
+    // the mount point is scanned in the background
+    IO::IOService *ioSrv( IO::IOService::getInstance() );
+    if ( nullptr != ioSrv ) {
+        ioSrv->getMetadataCache().addRootDeferred( path );
+    }
 
     return true;
 }
@@ -95,26 +108,37 @@ String AssetRegistry::getPath( const String &mount ) {
     return Dummy;
 }
 
-String AssetRegistry::resolvePathFromUri( const IO::Uri &location ) {
+const String &AssetRegistry::resolvePathFromUri( const IO::Uri &location ) {
     if ( location.isEmpty() ) {
         return Dummy;
     }
 
-    const String pathToCheck( location.getAbsPath() );
-    String absPath( pathToCheck );
-    const String::size_type pos = pathToCheck.find( "/" );
-    String mountPoint = pathToCheck.substr( 0, pos );
-    String::size_type offset = pos + mountPoint.size() + 1;
-    if ( hasPath( mountPoint ) ) {
-        absPath = getPath( mountPoint );
-        if ( absPath[ absPath.size()-1 ]!='/' ) {
+    const String &pathToCheck( location.getAbsPath() );
+    if ( nullptr == s_instance ) {
+        return pathToCheck;
+    }
+
+    // Materials reference the same few paths over and over again. Each path is stored once, the 
+    // nodes of the map do not move, so the returned reference stays valid until the mounts change.
+    std::lock_guard<std::mutex> lock( s_instance->m_resolveMutex );
+    std::unordered_map<String, String>::const_iterator it( s_instance->m_resolvedPaths.find( pathToCheck ) );
+    if ( s_instance->m_resolvedPaths.end() != it ) {
+        return it->second;
+    }
+
+    String &absPath( s_instance->m_resolvedPaths[ pathToCheck ] );
+    absPath = pathToCheck;
+    const String::size_type pos = pathToCheck.find( '/' );
+    String mountPath;
+    if ( String::npos != pos 
+            && s_instance->m_name2pathMap.getValue( StringUtils::hashName( pathToCheck.substr( 0, pos ) ), mountPath ) ) {
+        absPath = mountPath;
+        if ( absPath.empty() || absPath[ absPath.size()-1 ]!='/' ) {
             absPath += '/';
-            offset++;
         }
-        const String rest = pathToCheck.substr( pos+1, pathToCheck.size() - pos-1 );
-        absPath += rest;
+        absPath.append( pathToCheck, pos + 1, String::npos );
     }
-    
+
     return absPath;
 }
 
@@ -123,13 +147,51 @@ bool AssetRegistry::clear() {
         return false;
     }
 
+    std::lock_guard<std::mutex> lock( s_instance->m_resolveMutex );
     s_instance->m_name2pathMap.clear();
+    s_instance->m_resolvedPaths.clear();
 
     return true;
 }
 
+void AssetRegistry::setDerivedDataCache( DerivedDataCache *cache ) {
+    if ( nullptr == s_instance ) {
+        return;
+    }
+
+    s_instance->m_derivedDataCache = cache;
+}
+
+DerivedDataCache *AssetRegistry::getDerivedDataCache() {
+    if ( nullptr == s_instance ) {
+        return nullptr;
+    }
+
+    return s_instance->m_derivedDataCache;
+}
+
+void AssetRegistry::setDedupCache( DedupCache *cache ) {
+    if ( nullptr == s_instance ) {
+        return;
+    }
+
+    s_instance->m_dedupCache = cache;
+}
+
+DedupCache *AssetRegistry::getDedupCache() {
+    if ( nullptr == s_instance ) {
+        return nullptr;
+    }
+
+    return s_instance->m_dedupCache;
+}
+
 AssetRegistry::AssetRegistry() 
-: m_name2pathMap() {
+: m_name2pathMap()
+, m_resolvedPaths()
+, m_resolveMutex()
+, m_derivedDataCache( nullptr )
+, m_dedupCache( nullptr ) {
     // empty
 }
 
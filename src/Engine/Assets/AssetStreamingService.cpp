@@ -0,0 +1,499 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/AssetStreamingService.h>
+#include <osre/IO/IOService.h>
+#include <osre/IO/Stream.h>
+#include <osre/Threading/ThreadPool.h>
+#include <osre/Common/Logger.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::IO;
+
+static const String Tag = "AssetStreamingService";
+
+const AssetStreamingService::Handle AssetStreamingService::InvalidHandle;
+
+StreamPayload::~StreamPayload() {
+    // empty
+}
+
+RawStreamPayload::RawStreamPayload()
+: StreamPayload()
+, m_data() {
+    // empty
+}
+
+RawStreamPayload::~RawStreamPayload() {
+    // empty
+}
+
+ui64 RawStreamPayload::getUploadSize() const {
+    return m_data.size();
+}
+
+StreamHandler::~StreamHandler() {
+    // empty
+}
+
+bool StreamHandler::readsFileData() const {
+    return true;
+}
+
+AssetStreamingService::Budget::Budget()
+: m_readBytes( 4 * 1024 * 1024 )
+, m_decodeJobs( 4 )
+, m_uploadBytes( 8 * 1024 * 1024 ) {
+    // empty
+}
+
+// A request waits for the next stage when no worker job is running for it
+struct AssetStreamingService::Request {
+    Handle m_handle;
+    Uri m_uri;
+    f32 m_priority;
+    Callback m_callback;
+    StreamHandler *m_handler;
+    std::thread::id m_requester;
+    State m_state;
+    bool m_busy;
+    bool m_failed;
+    bool m_cancelled;
+    Stream *m_stream;
+    std::vector<uc8> m_data;
+    StreamPayload *m_payload;
+
+    Request()
+    : m_handle( InvalidHandle )
+    , m_uri()
+    , m_priority( 0.0f )
+    , m_callback()
+    , m_handler( nullptr )
+    , m_requester()
+    , m_state( State::Queued )
+    , m_busy( false )
+    , m_failed( false )
+    , m_cancelled( false )
+    , m_stream( nullptr )
+    , m_data()
+    , m_payload( nullptr ) {
+        // empty
+    }
+};
+
+// Returns the waiting requests of a state, the highest priority first
+template<class T>
+static std::vector<T*> getWaiting( const std::map<ui32, T*> &requests, AssetStreamingService::State state ) {
+    std::vector<T*> waiting;
+    for ( typename std::map<ui32, T*>::const_iterator it = requests.begin(); it != requests.end(); ++it ) {
+        T *request( it->second );
+        if ( state == request->m_state && !request->m_busy && !request->m_cancelled && !request->m_failed ) {
+            waiting.push_back( request );
+        }
+    }
+    std::stable_sort( waiting.begin(), waiting.end(), []( const T *a, const T *b ) {
+        return a->m_priority > b->m_priority;
+    } );
+
+    return waiting;
+}
+
+AssetStreamingService::AssetStreamingService( Threading::ThreadPool *threadPool )
+: AbstractService( "assets/streamingservice" )
+, m_threadPool( threadPool )
+, m_ownsThreadPool( false )
+, m_requests()
+, m_finished()
+, m_nextHandle( 1 )
+, m_prioritizer()
+, m_budget()
+, m_mutex()
+, m_jobsDone()
+, m_numJobs( 0 ) {
+    // empty
+}
+
+AssetStreamingService::~AssetStreamingService() {
+    if ( isOpen() ) {
+        close();
+    }
+}
+
+AssetStreamingService::Handle AssetStreamingService::request( const Uri &uri, f32 priority, const Callback &callback, 
+        StreamHandler *handler ) {
+    if ( uri.isEmpty() ) {
+        osre_debug( Tag, "Uri is empty." );
+        return InvalidHandle;
+    }
+
+    Request *request( new Request );
+    request->m_uri = uri;
+    request->m_priority = priority;
+    request->m_callback = callback;
+    request->m_handler = handler;
+    request->m_requester = std::this_thread::get_id();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    request->m_handle = m_nextHandle++;
+    if ( InvalidHandle == m_nextHandle ) {
+        ++m_nextHandle;
+    }
+    m_requests[ request->m_handle ] = request;
+
+    return request->m_handle;
+}
+
+bool AssetStreamingService::setPriority( Handle handle, f32 priority ) {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::map<Handle, Request*>::iterator it( m_requests.find( handle ) );
+    if ( m_requests.end() == it ) {
+        return false;
+    }
+    it->second->m_priority = priority;
+
+    return true;
+}
+
+void AssetStreamingService::setPrioritizer( const Prioritizer &prioritizer ) {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_prioritizer = prioritizer;
+}
+
+bool AssetStreamingService::cancel( Handle handle ) {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::map<Handle, Request*>::iterator it( m_requests.find( handle ) );
+    if ( m_requests.end() != it ) {
+        it->second->m_cancelled = true;
+        return true;
+    }
+
+    for ( Request *request : m_finished ) {
+        if ( handle == request->m_handle ) {
+            request->m_cancelled = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+AssetStreamingService::State AssetStreamingService::getState( Handle handle ) const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    const Request *request( nullptr );
+    std::map<Handle, Request*>::const_iterator it( m_requests.find( handle ) );
+    if ( m_requests.end() != it ) {
+        request = it->second;
+    } else {
+        for ( const Request *finished : m_finished ) {
+            if ( handle == finished->m_handle ) {
+                request = finished;
+                break;
+            }
+        }
+    }
+
+    if ( nullptr == request ) {
+        return State::Invalid;
+    }
+
+    return request->m_cancelled ? State::Cancelled : request->m_state;
+}
+
+ui32 AssetStreamingService::getNumPending() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return static_cast<ui32>( m_requests.size() );
+}
+
+void AssetStreamingService::setBudget( const Budget &budget ) {
+    m_budget = budget;
+}
+
+ui32 AssetStreamingService::dispatchCallbacks() {
+    const std::thread::id self( std::this_thread::get_id() );
+    std::vector<Request*> delivered;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        std::vector<Request*>::iterator it( m_finished.begin() );
+        while ( m_finished.end() != it ) {
+            if ( self == ( *it )->m_requester ) {
+                delivered.push_back( *it );
+                it = m_finished.erase( it );
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    ui32 numCallbacks( 0 );
+    for ( Request *request : delivered ) {
+        if ( !request->m_cancelled && request->m_callback ) {
+            // Failed uploads keep their payload until the release, the callback gets none
+            request->m_callback( request->m_handle, request->m_state, 
+                    State::Done == request->m_state ? request->m_payload : nullptr );
+            ++numCallbacks;
+        }
+        releaseRequest( request );
+    }
+
+    return numCallbacks;
+}
+
+bool AssetStreamingService::onOpen() {
+    if ( nullptr == m_threadPool ) {
+        m_threadPool = new Threading::ThreadPool;
+        m_ownsThreadPool = true;
+    }
+
+    return true;
+}
+
+bool AssetStreamingService::onClose() {
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_jobsDone.wait( lock, [ this ] { return 0 == m_numJobs; } );
+        for ( std::map<Handle, Request*>::iterator it = m_requests.begin(); it != m_requests.end(); ++it ) {
+            m_finished.push_back( it->second );
+            it->second->m_cancelled = true;
+        }
+        m_requests.clear();
+        for ( Request *request : m_finished ) {
+            releaseRequest( request );
+        }
+        m_finished.clear();
+    }
+
+    if ( m_ownsThreadPool ) {
+        delete m_threadPool;
+        m_threadPool = nullptr;
+        m_ownsThreadPool = false;
+    }
+
+    return true;
+}
+
+bool AssetStreamingService::onUpdate() {
+    prioritize();
+    startReads();
+    startDecodes();
+    upload();
+    dispatchCallbacks();
+
+    return true;
+}
+
+void AssetStreamingService::prioritize() {
+    // The prioritizer is called without the lock, so it may use the service
+    Prioritizer prioritizer;
+    std::vector<std::pair<Handle, Uri>> waiting;
+    std::vector<f32> priorities;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        prioritizer = m_prioritizer;
+        if ( !prioritizer ) {
+            return;
+        }
+        for ( std::map<Handle, Request*>::iterator it = m_requests.begin(); it != m_requests.end(); ++it ) {
+            waiting.push_back( std::make_pair( it->first, it->second->m_uri ) );
+            priorities.push_back( it->second->m_priority );
+        }
+    }
+
+    for ( size_t i = 0; i < waiting.size(); ++i ) {
+        priorities[ i ] = prioritizer( waiting[ i ].first, waiting[ i ].second, priorities[ i ] );
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for ( size_t i = 0; i < waiting.size(); ++i ) {
+        std::map<Handle, Request*>::iterator it( m_requests.find( waiting[ i ].first ) );
+        if ( m_requests.end() != it ) {
+            it->second->m_priority = priorities[ i ];
+        }
+    }
+}
+
+void AssetStreamingService::startReads() {
+    // Streams are opened and closed in the update only, the file systems are not thread-safe
+    IOService *ioSrv( IOService::getInstance() );
+    std::vector<Request*> reads;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        std::map<Handle, Request*>::iterator it( m_requests.begin() );
+        while ( m_requests.end() != it ) {
+            Request *request( it->second );
+            if ( request->m_busy ) {
+                ++it;
+                continue;
+            }
+            if ( nullptr != request->m_stream ) {
+                ioSrv->closeStream( &request->m_stream );
+            }
+            if ( request->m_cancelled || request->m_failed ) {
+                it = m_requests.erase( it );
+                request->m_state = request->m_cancelled ? State::Cancelled : State::Failed;
+                m_finished.push_back( request );
+                continue;
+            }
+            ++it;
+        }
+
+        ui64 bytes( 0 );
+        std::vector<Request*> waiting( getWaiting( m_requests, State::Queued ) );
+        for ( Request *request : waiting ) {
+            if ( nullptr != request->m_handler && !request->m_handler->readsFileData() ) {
+                request->m_state = State::Decoding;
+                continue;
+            }
+            if ( !reads.empty() && bytes >= m_budget.m_readBytes ) {
+                break;
+            }
+            request->m_stream = ioSrv->openStream( request->m_uri, Stream::AccessMode::ReadAccessBinary );
+            if ( nullptr == request->m_stream ) {
+                osre_debug( Tag, "Cannot open " + request->m_uri.getResource() );
+                request->m_failed = true;
+                continue;
+            }
+            bytes += request->m_stream->getSize();
+            request->m_state = State::Reading;
+            request->m_busy = true;
+            reads.push_back( request );
+        }
+    }
+
+    for ( Request *request : reads ) {
+        runJob( [ this, request ]() {
+            // Streams read at most 4 GB per call
+            const ui64 size( request->m_stream->getSize() );
+            bool ok( size <= static_cast<ui64>( std::numeric_limits<size_t>::max() ) );
+            if ( ok ) {
+                request->m_data.resize( static_cast<size_t>( size ) );
+            }
+            for ( ui64 offset = 0; ok && offset < size; ) {
+                const ui32 chunk( static_cast<ui32>( std::min<ui64>( size - offset, 0x80000000ull ) ) );
+                ok = chunk == request->m_stream->read( &request->m_data[ static_cast<size_t>( offset ) ], chunk );
+                offset += chunk;
+            }
+
+            std::unique_lock<std::mutex> lock( m_mutex );
+            request->m_failed = !ok;
+            request->m_state = State::Decoding;
+            request->m_busy = false;
+        } );
+    }
+}
+
+void AssetStreamingService::startDecodes() {
+    std::vector<Request*> decodes;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        std::vector<Request*> waiting( getWaiting( m_requests, State::Decoding ) );
+        for ( Request *request : waiting ) {
+            if ( decodes.size() >= std::max<ui32>( m_budget.m_decodeJobs, 1 ) ) {
+                break;
+            }
+            request->m_busy = true;
+            decodes.push_back( request );
+        }
+    }
+
+    for ( Request *request : decodes ) {
+        runJob( [ this, request ]() {
+            StreamPayload *payload( nullptr );
+            if ( nullptr != request->m_handler ) {
+                payload = request->m_handler->decode( request->m_uri, request->m_data );
+            } else {
+                RawStreamPayload *raw( new RawStreamPayload );
+                raw->m_data.swap( request->m_data );
+                payload = raw;
+            }
+            std::vector<uc8>().swap( request->m_data );
+
+            std::unique_lock<std::mutex> lock( m_mutex );
+            request->m_payload = payload;
+            request->m_failed = nullptr == payload;
+            request->m_state = State::Uploading;
+            request->m_busy = false;
+        } );
+    }
+}
+
+void AssetStreamingService::upload() {
+    std::vector<Request*> uploads;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        ui64 bytes( 0 );
+        std::vector<Request*> waiting( getWaiting( m_requests, State::Uploading ) );
+        for ( Request *request : waiting ) {
+            if ( !uploads.empty() && bytes >= m_budget.m_uploadBytes ) {
+                break;
+            }
+            bytes += request->m_payload->getUploadSize();
+            request->m_busy = true;
+            uploads.push_back( request );
+        }
+    }
+
+    for ( Request *request : uploads ) {
+        bool ok( true );
+        if ( nullptr != request->m_handler ) {
+            ok = request->m_handler->upload( request->m_payload );
+        }
+        finish( request, ok ? State::Done : State::Failed );
+    }
+}
+
+void AssetStreamingService::finish( Request *request, State state ) {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_requests.erase( request->m_handle );
+    request->m_state = state;
+    request->m_busy = false;
+    m_finished.push_back( request );
+}
+
+void AssetStreamingService::runJob( const std::function<void()> &job ) {
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        ++m_numJobs;
+    }
+
+    m_threadPool->enqueue( [ this, job ]() {
+        job();
+        std::unique_lock<std::mutex> lock( m_mutex );
+        --m_numJobs;
+        m_jobsDone.notify_all();
+    } );
+}
+
+void AssetStreamingService::releaseRequest( Request *request ) {
+    if ( nullptr != request->m_stream ) {
+        IOService::getInstance()->closeStream( &request->m_stream );
+    }
+    delete request->m_payload;
+    delete request;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
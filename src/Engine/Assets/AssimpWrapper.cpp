@@ -28,19 +28,33 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/RenderBackend/RenderCommon.h>
 #include <osre/RenderBackend/Geometry.h>
 #include <osre/Assets/AssetRegistry.h>
+#include <osre/Assets/DerivedDataCache.h>
+#include <osre/Assets/MeshOptimizer.h>
+#include <osre/Assets/MeshSimplifier.h>
+#include <osre/Assets/VertexQuantizer.h>
 #include <osre/Scene/GeometryBuilder.h>
 #include <osre/Scene/MaterialBuilder.h>
 #include <osre/Scene/Component.h>
 #include <osre/Scene/Node.h>
+#include <osre/Scene/LodSet.h>
 #include <osre/Collision/TAABB.h>
 #include <osre/IO/IOService.h>
 #include <osre/IO/AbstractFileSystem.h>
+#include <osre/Threading/ThreadPool.h>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/DefaultIOSystem.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
 #include <iostream>
+#include <map>
+#include <new>
+#include <set>
+#include <vector>
 
 namespace OSRE {
 namespace Assets {
@@ -52,6 +66,39 @@ using namespace ::OSRE::Collision;
 
 static const String Tag = "AssimpWrapper";
 
+static const ui32 ImportFlags = aiProcess_CalcTangentSpace
+    | aiProcess_GenSmoothNormals
+    | aiProcess_JoinIdenticalVertices
+    | aiProcess_ImproveCacheLocality
+    | aiProcess_LimitBoneWeights
+    | aiProcess_RemoveRedundantMaterials
+    | aiProcess_SplitLargeMeshes
+    | aiProcess_Triangulate
+    | aiProcess_GenUVCoords
+    | aiProcess_SortByPType;
+
+// Records the files opened by an import, for instance the material libraries of a model
+class DependencyIOSystem : public DefaultIOSystem {
+public:
+    DependencyIOSystem( std::set<String> &dependencies )
+    : DefaultIOSystem()
+    , m_dependencies( dependencies ) {
+        // empty
+    }
+
+    IOStream *Open( const char *file, const char *mode ) override {
+        IOStream *stream( DefaultIOSystem::Open( file, mode ) );
+        if ( nullptr != stream ) {
+            m_dependencies.insert( file );
+        }
+
+        return stream;
+    }
+
+private:
+    std::set<String> &m_dependencies;
+};
+
 AssimpWrapper::AssimpWrapper( Common::Ids &ids )
 : m_geoArray()
 , m_matArray()
@@ -60,7 +107,20 @@ AssimpWrapper::AssimpWrapper( Common::Ids &ids )
 , m_ids( ids )
 , m_mvpParam( nullptr )
 , m_root()
-, m_absPathWithFile() {
+, m_absPathWithFile()
+, m_numLodLevels( 1 )
+, m_cookingEnabled( true )
+, m_cookedReuseEnabled( true )
+, m_nodeDescs()
+, m_parentDescIdx( -1 )
+, m_threadPool( nullptr )
+, m_vertexType( VertexType::RenderVertex )
+, m_optimizeMeshes( true )
+, m_meshStats()
+, m_dedupEnabled( true )
+, m_localDedupCache()
+, m_meshMap()
+, m_dependencies() {
     // empty
 }
 
@@ -90,17 +150,7 @@ bool AssimpWrapper::importAsset( const IO::Uri &file, ui32 flags ) {
         return false;
     }
 
-    unsigned int importFlags = aiProcess_CalcTangentSpace
-        | aiProcess_GenSmoothNormals
-        | aiProcess_JoinIdenticalVertices
-        | aiProcess_ImproveCacheLocality
-        | aiProcess_LimitBoneWeights
-        | aiProcess_RemoveRedundantMaterials
-        | aiProcess_SplitLargeMeshes
-        | aiProcess_Triangulate
-        | aiProcess_GenUVCoords
-        | aiProcess_SortByPType;
-    flags = importFlags;
+    flags = ImportFlags;
 
     m_root = AssetRegistry::getPath( "media" );
     m_absPathWithFile = AssetRegistry::resolvePathFromUri( file );
@@ -108,7 +158,37 @@ bool AssimpWrapper::importAsset( const IO::Uri &file, ui32 flags ) {
     String filename;
     separatePathAndFilename(m_absPathWithFile, m_root, filename);
     filename = m_root + filename;
+    m_dependencies.clear();
+
+    // Nothing of a former import may leak into this one
+    m_geoArray.resize( 0 );
+    m_matArray.resize( 0 );
+    m_parent = nullptr;
+    m_nodeDescs.resize( 0 );
+    m_parentDescIdx = -1;
+    m_meshMap.resize( 0 );
+
+    // A cooked model of the unchanged source can be mapped without importing it again
+    ui64 sourceSize( 0 ), sourceTime( 0 );
+    DerivedDataCache *cache( AssetRegistry::getDerivedDataCache() );
+    const bool cookable( m_cookingEnabled && CookedModel::getSourceInfo( filename, sourceSize, sourceTime ) );
+    const String cookedName( cookable ? getCookedFilename( filename ) : CookedModel::getCookedName( filename ) );
+    const bool derived( nullptr != cache && cookedName != CookedModel::getCookedName( filename ) );
+    if ( derived ) {
+        // The content addressed file stays valid when only the time stamp of the source changes
+        sourceSize = 0;
+        sourceTime = 0;
+    }
+    const ui64 settingsHash( getCookedSettingsHash() );
+
+    // The key covers only the source, the files read by the import are checked separately
+    const bool reusable( cookable && m_cookedReuseEnabled && ( !derived || cache->checkDependencies( cookedName ) ) );
+    if ( reusable && loadCookedModel( cookedName, sourceSize, sourceTime, settingsHash ) ) {
+        return true;
+    }
+
     Importer myImporter;
+    myImporter.SetIOHandler( new DependencyIOSystem( m_dependencies ) );
     const aiScene *scene = myImporter.ReadFile( filename, flags );
     if ( nullptr == scene ) {
         m_root = "";
@@ -118,19 +198,269 @@ bool AssimpWrapper::importAsset( const IO::Uri &file, ui32 flags ) {
     convertSceneToModel( scene );
     m_model->setGeoArray( m_geoArray );
 
+    if ( cookable ) {
+        // Recorded before the file is written, so a cooked model never exists without its dependencies
+        std::set<String> dependencies( m_dependencies );
+        dependencies.erase( filename );
+        if ( !derived || cache->setDependencies( cookedName, dependencies ) ) {
+            saveCookedModel( cookedName, sourceSize, sourceTime, settingsHash );
+        }
+    }
+
     return true;
 }
 
+String AssimpWrapper::getCookedFilename( const String &filename ) const {
+    DerivedDataCache *cache( AssetRegistry::getDerivedDataCache() );
+    if ( nullptr != cache ) {
+        // The cache key covers everything which changes the cooked model
+        const String derivedName( cache->getDerivedFilename( filename, getCookedSettings(), CookedModel::Version, 
+                CookedModel::getCookedName( "" ) ) );
+        if ( !derivedName.empty() ) {
+            return derivedName;
+        }
+    }
+
+    return CookedModel::getCookedName( filename );
+}
+
+String AssimpWrapper::getCookedSettings() const {
+    return std::to_string( ImportFlags ) + ";" + std::to_string( static_cast<ui32>( m_vertexType ) ) + ";" 
+            + ( m_optimizeMeshes ? "1" : "0" );
+}
+
+ui64 AssimpWrapper::getCookedSettingsHash() const {
+    // Stored in the cooked file, so a file next to the source is cooked again when the settings change
+    const String settings( getCookedSettings() );
+    return DerivedDataCache::hash( settings.c_str(), settings.size() );
+}
+
+const std::set<String> &AssimpWrapper::getDependencies() const {
+    return m_dependencies;
+}
+
 Model *AssimpWrapper::getModel() const {
     return m_model;
 }
 
+void AssimpWrapper::releaseModel( Model *model ) {
+    if ( nullptr == model ) {
+        return;
+    }
+
+    Scene::Node *root( model->getRootNode() );
+    if ( nullptr != root ) {
+        root->release();
+    }
+
+    // Geometries of a cooked model view its mapped file, materials may be shared by meshes. 
+    // Objects shared by the deduplication cache are kept until their last model is released.
+    if ( nullptr == model->getCookedModel() ) {
+        DedupCache *cache( AssetRegistry::getDedupCache() );
+        std::set<Material*> materials;
+        const Model::GeoArray &geoArray( model->getGeoArray() );
+        for ( ui32 i = 0; i < geoArray.size(); ++i ) {
+            Geometry *geo( geoArray[ i ] );
+            if ( nullptr == geo ) {
+                continue;
+            }
+            if ( nullptr != geo->m_material ) {
+                materials.insert( geo->m_material );
+            }
+            if ( nullptr != cache && !cache->releaseGeometry( geo ) ) {
+                continue;
+            }
+            geo->m_material = nullptr;
+            Geometry::destroy( &geo );
+        }
+        for ( Material *mat : materials ) {
+            if ( nullptr != cache && !cache->releaseMaterial( mat ) ) {
+                continue;
+            }
+            for ( ui32 i = 0; i < mat->m_numTextures; ++i ) {
+                delete mat->m_textures[ i ];
+            }
+            delete mat;
+        }
+    }
+    delete model;
+}
+
+void AssimpWrapper::setNumLodLevels( ui32 numLodLevels ) {
+    m_numLodLevels = numLodLevels > 0 ? numLodLevels : 1;
+}
+
+ui32 AssimpWrapper::getNumLodLevels() const {
+    return m_numLodLevels;
+}
+
+void AssimpWrapper::setCookingEnabled( bool enabled ) {
+    m_cookingEnabled = enabled;
+}
+
+bool AssimpWrapper::isCookingEnabled() const {
+    return m_cookingEnabled;
+}
+
+void AssimpWrapper::setCookedReuseEnabled( bool enabled ) {
+    m_cookedReuseEnabled = enabled;
+}
+
+bool AssimpWrapper::isCookedReuseEnabled() const {
+    return m_cookedReuseEnabled;
+}
+
+void AssimpWrapper::setThreadPool( Threading::ThreadPool *threadPool ) {
+    m_threadPool = threadPool;
+}
+
+Threading::ThreadPool *AssimpWrapper::getThreadPool() const {
+    return m_threadPool;
+}
+
+void AssimpWrapper::setVertexType( VertexType type ) {
+    m_vertexType = type;
+}
+
+VertexType AssimpWrapper::getVertexType() const {
+    return m_vertexType;
+}
+
+void AssimpWrapper::setMeshOptimizationEnabled( bool enabled ) {
+    m_optimizeMeshes = enabled;
+}
+
+bool AssimpWrapper::isMeshOptimizationEnabled() const {
+    return m_optimizeMeshes;
+}
+
+const MeshOptimizer::Statistics &AssimpWrapper::getMeshStatistics() const {
+    return m_meshStats;
+}
+
+void AssimpWrapper::setDeduplicationEnabled( bool enabled ) {
+    m_dedupEnabled = enabled;
+}
+
+bool AssimpWrapper::isDeduplicationEnabled() const {
+    return m_dedupEnabled;
+}
+
+DedupCache *AssimpWrapper::getDedupCache() {
+    if ( !m_dedupEnabled ) {
+        return nullptr;
+    }
+
+    DedupCache *cache( AssetRegistry::getDedupCache() );
+    return nullptr != cache ? cache : &m_localDedupCache;
+}
+
+bool AssimpWrapper::loadCookedModel( const String &filename, ui64 sourceSize, ui64 sourceTime, ui64 settingsHash ) {
+    CookedModel *cooked( new CookedModel );
+    if ( !cooked->open( filename ) || !cooked->isUpToDate( sourceSize, sourceTime, settingsHash ) ) {
+        delete cooked;
+        return false;
+    }
+
+    // A file cooked with another vertex layout will be cooked again
+    for ( ui32 i = 0; i < cooked->getNumMeshes(); ++i ) {
+        if ( m_vertexType != cooked->getMeshVertexType( i ) ) {
+            delete cooked;
+            return false;
+        }
+    }
+
+    m_model = new Model;
+    m_meshStats = MeshOptimizer::Statistics();
+    for ( ui32 i = 0; i < cooked->getNumMaterials(); ++i ) {
+        m_matArray.add( cooked->createMaterial( i, m_vertexType ) );
+    }
+    for ( ui32 i = 0; i < cooked->getNumMeshes(); ++i ) {
+        Geometry *geo( cooked->createGeometry( i ) );
+        const ui32 matIdx( cooked->getMeshMaterial( i ) );
+        if ( matIdx < m_matArray.size() ) {
+            geo->m_material = m_matArray[ matIdx ];
+        }
+        m_geoArray.add( geo );
+    }
+
+    // Parents are stored before their children
+    CPPCore::TArray<Node*> nodes;
+    for ( ui32 i = 0; i < cooked->getNumNodes(); ++i ) {
+        const i32 parentIdx( cooked->getNodeParent( i ) );
+        Node *parent( parentIdx >= 0 && static_cast<ui32>( parentIdx ) < nodes.size() ? nodes[ parentIdx ] : nullptr );
+        Node *newNode = new Node( cooked->getNodeName( i ), m_ids,
+                Node::RenderCompRequest::RenderCompRequested,
+                Node::TransformCompRequest::TransformCompRequested,
+                parent );
+        if ( 0 == i ) {
+            m_parent = newNode;
+            m_model->setRootNode( m_parent );
+        }
+        nodes.add( newNode );
+
+        for ( ui32 j = 0; j < cooked->getNumNodeMeshes( i ); ++j ) {
+            const ui32 meshIdx( cooked->getNodeMeshAt( i, j ) );
+            if ( meshIdx < m_geoArray.size() ) {
+                addGeometry( m_geoArray[ meshIdx ], newNode );
+            }
+        }
+    }
+
+    m_model->setGeoArray( m_geoArray );
+    m_model->setAABB( cooked->getAABB() );
+    m_model->setCookedModel( cooked );
+    osre_debug( Tag, "Mapped cooked model " + filename );
+
+    return true;
+}
+
+bool AssimpWrapper::saveCookedModel( const String &filename, ui64 sourceSize, ui64 sourceTime, ui64 settingsHash ) const {
+    IO::IOService *ioSrv( IO::IOService::getInstance() );
+    if ( nullptr == ioSrv || nullptr == m_model ) {
+        return false;
+    }
+
+    IO::AbstractFileSystem *fs( ioSrv->getFileSystem( "file" ) );
+    if ( nullptr == fs ) {
+        return false;
+    }
+
+    // Models may still map the old file, so it is replaced by a rename instead of being truncated
+    const String tempName( filename + ".tmp" );
+    IO::Stream *stream( fs->open( IO::Uri( "file://" + tempName ), IO::Stream::AccessMode::WriteAccessBinary ) );
+    if ( nullptr == stream ) {
+        osre_debug( Tag, "Cannot write cooked model " + filename );
+        return false;
+    }
+
+    const bool ok( CookedModel::save( *stream, m_geoArray, m_nodeDescs, m_model->getAABB(), sourceSize, sourceTime, settingsHash ) );
+    fs->close( &stream );
+    if ( !ok ) {
+        ::remove( tempName.c_str() );
+        return false;
+    }
+
+#ifdef OSRE_WINDOWS
+    // rename does not replace an existing file on Windows.
+    ::remove( filename.c_str() );
+#endif
+    if ( 0 != ::rename( tempName.c_str(), filename.c_str() ) ) {
+        osre_debug( Tag, "Cannot replace cooked model " + filename );
+        ::remove( tempName.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
 Model *AssimpWrapper::convertSceneToModel( const aiScene *scene ) {
     if ( nullptr == scene ) {
         return nullptr;
     }
 
     m_model = new Model;
+    m_localDedupCache.clear();
     if ( scene->HasMaterials() ) {
         for ( ui32 i = 0; i < scene->mNumMaterials; i++ ) {
             aiMaterial *currentMat( scene->mMaterials[ i ] );
@@ -141,13 +471,7 @@ Model *AssimpWrapper::convertSceneToModel( const aiScene *scene ) {
     }
     
     if ( scene->HasMeshes() ) {
-        for ( ui32 i = 0; i < scene->mNumMeshes; i++ ) {
-            aiMesh *currentMesh( scene->mMeshes[ i ] );
-            if ( nullptr == currentMesh ) {
-                continue;
-            }
-            handleMesh( currentMesh );
-        }
+        convertMeshes( scene );
     }
 
     if ( nullptr != scene->mRootNode ) {
@@ -157,85 +481,193 @@ Model *AssimpWrapper::convertSceneToModel( const aiScene *scene ) {
     return m_model;
 }
 
-void AssimpWrapper::handleMesh( aiMesh *mesh ) {
-    if ( nullptr == mesh ) {
-        return;
+// Scenes with less meshes will be converted without a temporary thread pool
+static const ui32 ParallelMeshThreshold = 8;
+
+void AssimpWrapper::convertMeshes( const aiScene *scene ) {
+    // The geometries are created up front, the id generation is not thread-safe
+    std::vector<const aiMesh*> meshes;
+    std::vector<ui32> meshIndices;
+    const ui32 firstGeo( m_geoArray.size() );
+    m_meshMap.resize( 0 );
+    for ( ui32 i = 0; i < scene->mNumMeshes; i++ ) {
+        m_meshMap.add( CookedModel::InvalidIndex );
+        const aiMesh *currentMesh( scene->mMeshes[ i ] );
+        if ( nullptr == currentMesh ) {
+            continue;
+        }
+
+        m_meshMap[ i ] = m_geoArray.size();
+        meshIndices.push_back( i );
+        Geometry *geo( Geometry::create( 1 ) );
+        const ui32 matIdx( currentMesh->mMaterialIndex );
+        geo->m_material = matIdx < m_matArray.size() ? m_matArray[ matIdx ] : nullptr;
+        m_geoArray.add( geo );
+        meshes.push_back( currentMesh );
+    }
+
+    // Each mesh writes into its own geometry and bounds only
+    const ui32 numMeshes( static_cast<ui32>( meshes.size() ) );
+    std::vector<TAABB<f32>> bounds( numMeshes );
+    std::vector<MeshOptimizer::Statistics> stats( numMeshes );
+    Threading::ThreadPool::RangeJob job( [ this, &meshes, &bounds, &stats, firstGeo ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            Geometry *geo( m_geoArray[ firstGeo + i ] );
+            handleMesh( meshes[ i ], geo, bounds[ i ] );
+            if ( m_optimizeMeshes ) {
+                MeshOptimizer::optimize( geo, &stats[ i ] );
+            }
+            if ( VertexType::RenderVertex != m_vertexType ) {
+                VertexQuantizer::quantize( geo, m_vertexType );
+            }
+        }
+    } );
+    if ( nullptr != m_threadPool ) {
+        m_threadPool->parallelFor( numMeshes, 1, job );
+    } else if ( numMeshes >= ParallelMeshThreshold ) {
+        Threading::ThreadPool threadPool;
+        threadPool.parallelFor( numMeshes, 1, job );
+    } else {
+        job( 0, numMeshes );
+    }
+
+    // Equal meshes share one geometry, the model holds one cache reference per kept geometry
+    DedupCache *cache( getDedupCache() );
+    if ( nullptr != cache ) {
+        std::map<Geometry*, ui32> geoIndices;
+        GeoArray geoArray;
+        for ( ui32 i = 0; i < firstGeo; ++i ) {
+            geoArray.add( m_geoArray[ i ] );
+        }
+        for ( ui32 i = 0; i < numMeshes; ++i ) {
+            Geometry *newGeo( m_geoArray[ firstGeo + i ] );
+            Geometry *geo( cache->addGeometry( newGeo ) );
+            if ( geo != newGeo ) {
+                // The material is shared with the kept geometry
+                newGeo->m_material = nullptr;
+                Geometry::destroy( &newGeo );
+            }
+            std::map<Geometry*, ui32>::const_iterator it( geoIndices.find( geo ) );
+            if ( geoIndices.end() == it ) {
+                it = geoIndices.insert( std::make_pair( geo, geoArray.size() ) ).first;
+                geoArray.add( geo );
+            } else {
+                cache->releaseGeometry( geo );
+            }
+            m_meshMap[ meshIndices[ i ] ] = it->second;
+        }
+        if ( geoArray.size() != m_geoArray.size() ) {
+            osre_info( Tag, "Shared " + std::to_string( m_geoArray.size() - geoArray.size() ) + " duplicated meshes." );
+        }
+        m_geoArray = geoArray;
     }
 
     TAABB<f32> aabb = m_model->getAABB();
-    Geometry *geo( Geometry::create( 1 ) );
-	geo->m_vertextype = VertexType::RenderVertex;
-    ui32 numVertices( mesh->mNumVertices );
-    RenderVert *vertices = new RenderVert[ numVertices ];
+    for ( ui32 i = 0; i < numMeshes; ++i ) {
+        if ( meshes[ i ]->HasPositions() && 0 != meshes[ i ]->mNumVertices ) {
+            aabb.merge( bounds[ i ].getMin() );
+            aabb.merge( bounds[ i ].getMax() );
+        }
+    }
+    m_model->setAABB( aabb );
+
+    // The ACMR of the model is weighted by the number of triangles of each mesh
+    m_meshStats = MeshOptimizer::Statistics();
+    for ( ui32 i = 0; i < numMeshes; ++i ) {
+        const f32 numTriangles( static_cast<f32>( stats[ i ].m_numTriangles ) );
+        m_meshStats.m_acmrBefore += stats[ i ].m_acmrBefore * numTriangles;
+        m_meshStats.m_acmrAfter += stats[ i ].m_acmrAfter * numTriangles;
+        m_meshStats.m_numTriangles += stats[ i ].m_numTriangles;
+        m_meshStats.m_numClusters += stats[ i ].m_numClusters;
+    }
+    if ( 0 != m_meshStats.m_numTriangles ) {
+        m_meshStats.m_acmrBefore /= static_cast<f32>( m_meshStats.m_numTriangles );
+        m_meshStats.m_acmrAfter /= static_cast<f32>( m_meshStats.m_numTriangles );
+        osre_info( Tag, "Optimized " + std::to_string( m_meshStats.m_numTriangles ) + " triangles, ACMR " 
+                + std::to_string( m_meshStats.m_acmrBefore ) + " -> " + std::to_string( m_meshStats.m_acmrAfter ) );
+    }
+}
+
+void AssimpWrapper::handleMesh( const aiMesh *mesh, Geometry *geo, TAABB<f32> &aabb ) {
+    if ( nullptr == mesh || nullptr == geo ) {
+        return;
+    }
+
+    // The vertices will be written straight into the vertex buffer
+    geo->m_vertextype = VertexType::RenderVertex;
+    const ui32 numVertices( mesh->mNumVertices );
+    const ui32 vbSize( sizeof( RenderVert ) * numVertices );
+    geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, vbSize, BufferAccessType::ReadOnly );
+    RenderVert *vertices( static_cast<RenderVert*>( geo->m_vb->m_data ) );
     for ( ui32 i = 0; i < numVertices; i++ ) {
-        if ( mesh->HasPositions() ) {
-            aiVector3D &vec3 = mesh->mVertices[ i ];
-            vertices[ i ].position.x = vec3.x;
-            vertices[ i ].position.y = vec3.y;
-            vertices[ i ].position.z = vec3.z;
+        new ( &vertices[ i ] ) RenderVert;
+    }
 
-            aabb.merge( vec3.x, vec3.y, vec3.z );
+    // One loop per present channel, missing channels keep the defaults
+    if ( mesh->HasPositions() && 0 != numVertices ) {
+        glm::vec3 minPos( FLT_MAX ), maxPos( -FLT_MAX );
+        for ( ui32 i = 0; i < numVertices; i++ ) {
+            const aiVector3D &vec3 = mesh->mVertices[ i ];
+            const glm::vec3 pos( vec3.x, vec3.y, vec3.z );
+            vertices[ i ].position = pos;
+            minPos = glm::min( minPos, pos );
+            maxPos = glm::max( maxPos, pos );
         }
+        aabb.set( TAABB<f32>::VecType( minPos.x, minPos.y, minPos.z ), TAABB<f32>::VecType( maxPos.x, maxPos.y, maxPos.z ) );
+    }
 
-        if ( mesh->HasNormals() ) {
-            aiVector3D &normal = mesh->mNormals[ i ];
-            vertices[ i ].normal.x = normal.x;
-            vertices[ i ].normal.y = normal.y;
-            vertices[ i ].normal.z = normal.z;
+    if ( mesh->HasNormals() ) {
+        for ( ui32 i = 0; i < numVertices; i++ ) {
+            const aiVector3D &normal = mesh->mNormals[ i ];
+            vertices[ i ].normal = glm::vec3( normal.x, normal.y, normal.z );
         }
+    }
 
-        if ( mesh->HasVertexColors( 0 ) ) {
-            aiColor4D &diffuse = mesh->mColors[ 0 ][ i ];
-            vertices[ i ].color0.r = diffuse.r;
-            vertices[ i ].color0.g = diffuse.g;
-            vertices[ i ].color0.b = diffuse.b;
+    if ( mesh->HasVertexColors( 0 ) ) {
+        for ( ui32 i = 0; i < numVertices; i++ ) {
+            const aiColor4D &diffuse = mesh->mColors[ 0 ][ i ];
+            vertices[ i ].color0 = glm::vec3( diffuse.r, diffuse.g, diffuse.b );
         }
+    }
 
-        for ( ui32 texIdx =0; texIdx<AI_MAX_NUMBER_OF_TEXTURECOORDS; texIdx++ ) {
-            if ( mesh->HasTextureCoords( texIdx ) ) {
-                if ( 0 == texIdx ) {
-                    aiVector3D &tex0 = mesh->mTextureCoords[ texIdx ][ i ];
-                    vertices[ i ].tex0.x = tex0.x;
-                    vertices[ i ].tex0.y = tex0.y;
-                }
-            }
+    if ( mesh->HasTextureCoords( 0 ) ) {
+        for ( ui32 i = 0; i < numVertices; i++ ) {
+            const aiVector3D &tex0 = mesh->mTextureCoords[ 0 ][ i ];
+            vertices[ i ].tex0 = glm::vec2( tex0.x, tex0.y );
         }
     }
-    //GeometryDiagnosticUtils::dumVertices( vertices, numVertices );
-
-    const ui32 matIdx( mesh->mMaterialIndex );
-    Material *osreMat = m_matArray[ matIdx ];
-    geo->m_material = osreMat;
-    const ui32 vbSize( sizeof( RenderVert ) * numVertices );
-    geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, vbSize, BufferAccessType::ReadOnly );
-    geo->m_vb->copyFrom( &vertices[ 0 ], vbSize );
 
-    CPPCore::TArray<ui32> indexArray;
+    ui32 numIndices( 0 );
     for ( ui32 i = 0; i < mesh->mNumFaces; i++ ) {
-        aiFace &currentFace = mesh->mFaces[ i ];
-        for ( ui32 idx = 0; idx < currentFace.mNumIndices; idx++ ) {
-            const ui32 index = currentFace.mIndices[ idx ];
-            indexArray.add( index );
-        }
+        numIndices += mesh->mFaces[ i ].mNumIndices;
     }
-	//Scene::GeometryDiagnosticUtils::dumpIndices( indexArray );
 
-    geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( ui32 ) * indexArray.size(), BufferAccessType::ReadOnly );
-    geo->m_ib->copyFrom( &indexArray[ 0 ], geo->m_ib->m_size );
+    // 16-bit indices are enough to address less than 65536 vertices
+    if ( numVertices < 65536 ) {
+        geo->m_indextype = IndexType::UnsignedShort;
+        geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( ui16 ) * numIndices, BufferAccessType::ReadOnly );
+        ui16 *indices( static_cast<ui16*>( geo->m_ib->m_data ) );
+        for ( ui32 i = 0; i < mesh->mNumFaces; i++ ) {
+            const aiFace &currentFace = mesh->mFaces[ i ];
+            for ( ui32 idx = 0; idx < currentFace.mNumIndices; idx++ ) {
+                *indices++ = static_cast<ui16>( currentFace.mIndices[ idx ] );
+            }
+        }
+    } else {
+        geo->m_indextype = IndexType::UnsignedInt;
+        geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( ui32 ) * numIndices, BufferAccessType::ReadOnly );
+        ui32 *indices( static_cast<ui32*>( geo->m_ib->m_data ) );
+        for ( ui32 i = 0; i < mesh->mNumFaces; i++ ) {
+            const aiFace &currentFace = mesh->mFaces[ i ];
+            for ( ui32 idx = 0; idx < currentFace.mNumIndices; idx++ ) {
+                *indices++ = currentFace.mIndices[ idx ];
+            }
+        }
+    }
 
     geo->m_numPrimGroups = 1;
     geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
-    geo->m_pPrimGroups[ 0 ].m_indexType = IndexType::UnsignedInt;
-    geo->m_pPrimGroups[ 0 ].m_numIndices = indexArray.size();
-    geo->m_pPrimGroups[ 0 ].m_primitive = PrimitiveType::TriangleList;
-    geo->m_pPrimGroups[ 0 ].m_startIndex = 0;
-
-    geo->m_material = m_matArray[matIdx];
-    
-    //
-
-    m_geoArray.add( geo );
-    m_model->setAABB( aabb );
+    geo->m_pPrimGroups[ 0 ].init( geo->m_indextype, numIndices, PrimitiveType::TriangleList, 0 );
 }
 
 void AssimpWrapper::handleNode( aiNode *node, Scene::Node *parent ) {
@@ -254,19 +686,26 @@ void AssimpWrapper::handleNode( aiNode *node, Scene::Node *parent ) {
         m_model->setRootNode( m_parent );
     }
 
+    // Describe the node for the cooked model
+    CookedModel::NodeDesc desc;
+    desc.m_name = node->mName.C_Str();
+    desc.m_parent = m_parentDescIdx;
     if ( node->mNumMeshes > 0 ) {
         for ( ui32 i = 0; i < node->mNumMeshes; i++ ) {
-            const ui32 meshIdx( node->mMeshes[ i ] );
+            const ui32 meshIdx( node->mMeshes[ i ] < m_meshMap.size() ? m_meshMap[ node->mMeshes[ i ] ] : CookedModel::InvalidIndex );
             if ( meshIdx >= m_geoArray.size() ) {
                 continue;
             }
 
             Geometry *geo( m_geoArray[ meshIdx ] );
             if ( nullptr != geo ) {
-                newNode->addGeometry( geo );
+                addGeometry( geo, newNode );
+                desc.m_meshes.add( meshIdx );
             }
         }
     }
+    const i32 descIdx( static_cast<i32>( m_nodeDescs.size() ) );
+    m_nodeDescs.add( desc );
 
     for ( ui32 i = 0; i < node->mNumChildren; i++ ) {
         aiNode *currentNode = node->mChildren[ i ];
@@ -274,8 +713,47 @@ void AssimpWrapper::handleNode( aiNode *node, Scene::Node *parent ) {
             continue;
         }
 
+        m_parentDescIdx = descIdx;
         handleNode( currentNode, newNode );
     }
+    m_parentDescIdx = desc.m_parent;
+}
+
+// Screen size threshold of the first generated detail level, halved for each further level
+static const f32 LodBaseScreenSize = 0.5f;
+
+void AssimpWrapper::addGeometry( Geometry *geo, Node *node ) {
+    RenderComponent *renderComp( ( RenderComponent* ) node->getComponent( Node::ComponentType::RenderComponentType ) );
+    if ( m_numLodLevels < 2 || nullptr == renderComp ) {
+        node->addGeometry( geo );
+        return;
+    }
+
+    // Imported meshes have no authored LODs, so generate them by simplification
+    LodSet *lodSet( new LodSet );
+    lodSet->addLevel( geo, LodBaseScreenSize );
+    f32 ratio( 1.0f ), screenSize( LodBaseScreenSize );
+    for ( ui32 i = 1; i < m_numLodLevels; ++i ) {
+        ratio *= 0.5f;
+        screenSize *= 0.5f;
+        Geometry *simplified( MeshSimplifier::simplify( geo, ratio ) );
+        if ( nullptr == simplified ) {
+            break;
+        }
+        const bool last( i + 1 == m_numLodLevels );
+        lodSet->addLevel( simplified, last ? 0.0f : screenSize );
+
+        // The level data was copied into the set, the material belongs to the source
+        simplified->m_material = nullptr;
+        Geometry::destroy( &simplified );
+    }
+
+    if ( lodSet->getNumLevels() < 2 ) {
+        delete lodSet;
+        node->addGeometry( geo );
+        return;
+    }
+    renderComp->addLodSet( lodSet );
 }
 
 static void setColor4( const aiColor4D &aiCol, Color4 &col ) {
@@ -306,7 +784,7 @@ static void setTexture( const String &resolvedPath, const aiString &texPath, CPP
     if (IO::IOService::getInstance()->fileExists(tex->m_loc)) {
         IO::AbstractFileSystem *fs = IO::IOService::getInstance()->getFileSystem("file");
         IO::Stream *file = fs->open(tex->m_loc, IO::Stream::AccessMode::ReadAccess);
-        tex->m_size = file->getSize();
+        tex->m_size = static_cast<ui32>( std::min<ui64>( file->getSize(), 0xFFFFFFFFull ) );
         file->read(tex->m_data, tex->m_size);
         fs->close(&file);
     }
@@ -340,8 +818,7 @@ void AssimpWrapper::handleMaterial( aiMaterial *material ) {
         return;
     }
     
-    Material *osreMat( MaterialBuilder::createBuildinMaterial( RenderBackend::VertexType::RenderVertex ) );
-    m_matArray.add( osreMat );
+    Material *osreMat( MaterialBuilder::createBuildinMaterial( m_vertexType ) );
 
     i32 texIndex( 0 );
     aiString texPath;	// contains filename of texture
@@ -380,6 +857,27 @@ void AssimpWrapper::handleMaterial( aiMaterial *material ) {
     if ( AI_SUCCESS == aiGetMaterialFloatArray( material, AI_MATKEY_SHININESS_STRENGTH, &strength, &max ) ) {
         // todo
     }
+
+    // Equal materials are shared, so the meshes using them can be shared as well
+    DedupCache *cache( getDedupCache() );
+    if ( nullptr != cache ) {
+        Material *keptMat( cache->addMaterial( osreMat ) );
+        if ( keptMat != osreMat ) {
+            for ( ui32 i = 0; i < osreMat->m_numTextures; ++i ) {
+                delete osreMat->m_textures[ i ];
+            }
+            delete osreMat;
+            osreMat = keptMat;
+        }
+        for ( ui32 i = 0; i < m_matArray.size(); ++i ) {
+            if ( osreMat == m_matArray[ i ] ) {
+                // The model holds one reference per kept material
+                cache->releaseMaterial( osreMat );
+                break;
+            }
+        }
+    }
+    m_matArray.add( osreMat );
 }
 
 } // Namespace Assets
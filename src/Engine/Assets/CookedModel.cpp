@@ -0,0 +1,570 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/CookedModel.h>
+#include <osre/Common/Logger.h>
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Scene/MaterialBuilder.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "CookedModel";
+
+// The extension appended to the source asset name
+static const String CookedExtension = ".osm";
+
+static_assert( sizeof( CookedModelHeader ) % 8 == 0, "Cooked model header must keep 8 byte alignment." );
+static_assert( sizeof( CookedMesh ) % 8 == 0, "Cooked mesh must keep 8 byte alignment." );
+static_assert( MaxMatColorType == 4, "Cooked materials store four colors." );
+
+const ui32 CookedModel::Magic;
+const ui32 CookedModel::Version;
+const ui32 CookedModel::BlobAlignment;
+const ui32 CookedModel::InvalidIndex;
+
+CookedModel::NodeDesc::NodeDesc()
+: m_name()
+, m_parent( -1 )
+, m_transform( 1.0f )
+, m_meshes() {
+    // empty
+}
+
+CookedModel::CookedModel()
+: m_file()
+, m_header( nullptr )
+, m_meshes( nullptr )
+, m_materials( nullptr )
+, m_nodes( nullptr )
+, m_meshRefs( nullptr )
+, m_strings( nullptr ) {
+    // empty
+}
+
+CookedModel::~CookedModel() {
+    close();
+}
+
+static ui64 alignOffset( ui64 offset, ui64 alignment ) {
+    return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+// Appends a string to the table and returns its offset
+static ui32 addString( std::vector<c8> &strings, const String &str ) {
+    const ui32 offset( static_cast<ui32>( strings.size() ) );
+    strings.insert( strings.end(), str.begin(), str.end() );
+
+    return offset;
+}
+
+bool CookedModel::save( IO::Stream &stream, const GeoArray &meshes, const NodeDescArray &nodes, const AABB &aabb,
+        ui64 sourceSize, ui64 sourceTime, ui64 settingsHash ) {
+    if ( !stream.isOpen() || !stream.canWrite() ) {
+        osre_error( Tag, "Cannot write cooked model, stream is not writable." );
+        return false;
+    }
+
+    // Collect the unique materials
+    std::map<const Material*, ui32> materialIndices;
+    std::vector<const Material*> materials;
+    for ( ui32 i = 0; i < meshes.size(); ++i ) {
+        const Material *mat( meshes[ i ]->m_material );
+        if ( nullptr != mat && materialIndices.end() == materialIndices.find( mat ) ) {
+            materialIndices[ mat ] = static_cast<ui32>( materials.size() );
+            materials.push_back( mat );
+        }
+    }
+
+    std::vector<c8> strings;
+    std::vector<CookedMaterial> cookedMaterials( materials.size() );
+    for ( size_t i = 0; i < materials.size(); ++i ) {
+        const Material *mat( materials[ i ] );
+        CookedMaterial &cooked( cookedMaterials[ i ] );
+        ::memset( &cooked, 0, sizeof( CookedMaterial ) );
+        for ( ui32 j = 0; j < MaxMatColorType; ++j ) {
+            cooked.m_colors[ j ][ 0 ] = mat->m_color[ j ].m_r;
+            cooked.m_colors[ j ][ 1 ] = mat->m_color[ j ].m_g;
+            cooked.m_colors[ j ][ 2 ] = mat->m_color[ j ].m_b;
+            cooked.m_colors[ j ][ 3 ] = mat->m_color[ j ].m_a;
+        }
+        cooked.m_nameOffset = addString( strings, mat->m_name );
+        cooked.m_nameLength = static_cast<ui32>( mat->m_name.size() );
+        if ( 0 != mat->m_numTextures && nullptr != mat->m_textures[ 0 ] ) {
+            const String &texture( mat->m_textures[ 0 ]->m_loc.getUri() );
+            cooked.m_textureOffset = addString( strings, texture );
+            cooked.m_textureLength = static_cast<ui32>( texture.size() );
+        }
+    }
+
+    std::vector<CookedNode> cookedNodes( nodes.size() );
+    std::vector<ui32> meshRefs;
+    for ( ui32 i = 0; i < nodes.size(); ++i ) {
+        const NodeDesc &desc( nodes[ i ] );
+        CookedNode &cooked( cookedNodes[ i ] );
+        ::memset( &cooked, 0, sizeof( CookedNode ) );
+        ::memcpy( cooked.m_transform, glm::value_ptr( desc.m_transform ), sizeof( cooked.m_transform ) );
+        cooked.m_parent = desc.m_parent;
+        cooked.m_nameOffset = addString( strings, desc.m_name );
+        cooked.m_nameLength = static_cast<ui32>( desc.m_name.size() );
+        cooked.m_firstMeshRef = static_cast<ui32>( meshRefs.size() );
+        cooked.m_numMeshRefs = desc.m_meshes.size();
+        for ( ui32 j = 0; j < desc.m_meshes.size(); ++j ) {
+            meshRefs.push_back( desc.m_meshes[ j ] );
+        }
+    }
+
+    // Tables first, then the blob with the buffers
+    CookedModelHeader header;
+    ::memset( &header, 0, sizeof( CookedModelHeader ) );
+    header.m_magic = Magic;
+    header.m_version = Version;
+    header.m_headerSize = sizeof( CookedModelHeader );
+    header.m_numMeshes = meshes.size();
+    header.m_numMaterials = static_cast<ui32>( materials.size() );
+    header.m_numNodes = nodes.size();
+    header.m_numMeshRefs = static_cast<ui32>( meshRefs.size() );
+    header.m_stringsSize = static_cast<ui32>( strings.size() );
+    header.m_sourceSize = sourceSize;
+    header.m_sourceTime = sourceTime;
+    header.m_settingsHash = settingsHash;
+    header.m_meshOffset = sizeof( CookedModelHeader );
+    header.m_materialOffset = header.m_meshOffset + sizeof( CookedMesh ) * header.m_numMeshes;
+    header.m_nodeOffset = header.m_materialOffset + sizeof( CookedMaterial ) * header.m_numMaterials;
+    header.m_meshRefOffset = header.m_nodeOffset + sizeof( CookedNode ) * header.m_numNodes;
+    header.m_stringOffset = header.m_meshRefOffset + sizeof( ui32 ) * header.m_numMeshRefs;
+    header.m_blobOffset = alignOffset( header.m_stringOffset + header.m_stringsSize, BlobAlignment );
+    for ( ui32 i = 0; i < 3; ++i ) {
+        header.m_aabb[ i ] = aabb.getMin()[ i ];
+        header.m_aabb[ i + 3 ] = aabb.getMax()[ i ];
+    }
+
+    std::vector<CookedMesh> cookedMeshes( meshes.size() );
+    ui64 blobSize( 0 );
+    for ( ui32 i = 0; i < meshes.size(); ++i ) {
+        const Geometry *geo( meshes[ i ] );
+        CookedMesh &cooked( cookedMeshes[ i ] );
+        ::memset( &cooked, 0, sizeof( CookedMesh ) );
+        cooked.m_vertexType = static_cast<ui32>( geo->m_vertextype );
+        cooked.m_indexType = static_cast<ui32>( geo->m_indextype );
+        cooked.m_primitive = static_cast<ui32>( PrimitiveType::TriangleList );
+        if ( 0 != geo->m_numPrimGroups ) {
+            cooked.m_indexType = static_cast<ui32>( geo->m_pPrimGroups[ 0 ].m_indexType );
+            cooked.m_primitive = static_cast<ui32>( geo->m_pPrimGroups[ 0 ].m_primitive );
+            cooked.m_numIndices = geo->m_pPrimGroups[ 0 ].m_numIndices;
+        }
+        cooked.m_material = nullptr != geo->m_material ? materialIndices[ geo->m_material ] : InvalidIndex;
+        cooked.m_localMatrix = geo->m_localMatrix ? 1 : 0;
+        ::memcpy( cooked.m_model, glm::value_ptr( geo->m_model ), sizeof( cooked.m_model ) );
+        cooked.m_vbSize = nullptr != geo->m_vb ? geo->m_vb->m_size : 0;
+        cooked.m_ibSize = nullptr != geo->m_ib ? geo->m_ib->m_size : 0;
+        cooked.m_vbOffset = header.m_blobOffset + blobSize;
+        blobSize = alignOffset( blobSize + cooked.m_vbSize, BlobAlignment );
+        cooked.m_ibOffset = header.m_blobOffset + blobSize;
+        blobSize = alignOffset( blobSize + cooked.m_ibSize, BlobAlignment );
+    }
+    header.m_blobSize = blobSize;
+
+    bool ok( true );
+    ok = ok && sizeof( CookedModelHeader ) == stream.write( &header, sizeof( CookedModelHeader ) );
+    if ( !cookedMeshes.empty() ) {
+        const ui32 size( static_cast<ui32>( sizeof( CookedMesh ) * cookedMeshes.size() ) );
+        ok = ok && size == stream.write( &cookedMeshes[ 0 ], size );
+    }
+    if ( !cookedMaterials.empty() ) {
+        const ui32 size( static_cast<ui32>( sizeof( CookedMaterial ) * cookedMaterials.size() ) );
+        ok = ok && size == stream.write( &cookedMaterials[ 0 ], size );
+    }
+    if ( !cookedNodes.empty() ) {
+        const ui32 size( static_cast<ui32>( sizeof( CookedNode ) * cookedNodes.size() ) );
+        ok = ok && size == stream.write( &cookedNodes[ 0 ], size );
+    }
+    if ( !meshRefs.empty() ) {
+        const ui32 size( static_cast<ui32>( sizeof( ui32 ) * meshRefs.size() ) );
+        ok = ok && size == stream.write( &meshRefs[ 0 ], size );
+    }
+    if ( !strings.empty() ) {
+        ok = ok && strings.size() == stream.write( &strings[ 0 ], static_cast<ui32>( strings.size() ) );
+    }
+
+    // Padding up to the aligned start of each buffer
+    static const uc8 zeros[ BlobAlignment ] = { 0 };
+    ui64 pos( header.m_stringOffset + header.m_stringsSize );
+    for ( ui32 i = 0; i < meshes.size() && ok; ++i ) {
+        const Geometry *geo( meshes[ i ] );
+        const CookedMesh &cooked( cookedMeshes[ i ] );
+        const ui32 vbPadding( static_cast<ui32>( cooked.m_vbOffset - pos ) );
+        ok = ok && vbPadding == stream.write( zeros, vbPadding );
+        if ( 0 != cooked.m_vbSize ) {
+            ok = ok && cooked.m_vbSize == stream.write( geo->m_vb->m_data, cooked.m_vbSize );
+        }
+        pos = cooked.m_vbOffset + cooked.m_vbSize;
+
+        const ui32 ibPadding( static_cast<ui32>( cooked.m_ibOffset - pos ) );
+        ok = ok && ibPadding == stream.write( zeros, ibPadding );
+        if ( 0 != cooked.m_ibSize ) {
+            ok = ok && cooked.m_ibSize == stream.write( geo->m_ib->m_data, cooked.m_ibSize );
+        }
+        pos = cooked.m_ibOffset + cooked.m_ibSize;
+    }
+    const ui32 endPadding( static_cast<ui32>( header.m_blobOffset + header.m_blobSize - pos ) );
+    ok = ok && endPadding == stream.write( zeros, endPadding );
+
+    if ( !ok ) {
+        osre_error( Tag, "Error while writing cooked model." );
+    }
+
+    return ok;
+}
+
+bool CookedModel::getSourceInfo( const String &filename, ui64 &size, ui64 &time ) {
+    struct stat info;
+    if ( 0 != ::stat( filename.c_str(), &info ) ) {
+        return false;
+    }
+    size = static_cast<ui64>( info.st_size );
+    time = static_cast<ui64>( info.st_mtime );
+
+    return true;
+}
+
+String CookedModel::getCookedName( const String &filename ) {
+    return filename + CookedExtension;
+}
+
+bool CookedModel::open( const String &filename ) {
+    close();
+    m_file = std::make_shared<IO::MemoryMappedFile>();
+    if ( !m_file->open( filename ) ) {
+        m_file.reset();
+        return false;
+    }
+
+    const uc8 *data( m_file->getData() );
+    m_header = reinterpret_cast<const CookedModelHeader*>( data );
+    if ( !validate() ) {
+        osre_error( Tag, "Invalid or outdated cooked model " + filename );
+        close();
+        return false;
+    }
+
+    m_meshes = reinterpret_cast<const CookedMesh*>( data + m_header->m_meshOffset );
+    m_materials = reinterpret_cast<const CookedMaterial*>( data + m_header->m_materialOffset );
+    m_nodes = reinterpret_cast<const CookedNode*>( data + m_header->m_nodeOffset );
+    m_meshRefs = reinterpret_cast<const ui32*>( data + m_header->m_meshRefOffset );
+    m_strings = reinterpret_cast<const c8*>( data + m_header->m_stringOffset );
+
+    // All meshes are uploaded right after opening, so the pages are read ahead
+    m_file->advise( IO::MemoryMappedFile::AccessHint::WillNeed );
+
+    return true;
+}
+
+// Checks that count records of the given size starting at offset fit into the file, without overflows
+static bool isInFile( ui64 offset, ui64 count, ui64 recordSize, ui64 fileSize ) {
+    if ( offset > fileSize ) {
+        return false;
+    }
+
+    return count <= ( fileSize - offset ) / recordSize;
+}
+
+static ui32 getIndexSize( IndexType type ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return sizeof( uc8 );
+        case IndexType::UnsignedShort:
+            return sizeof( ui16 );
+        case IndexType::UnsignedInt:
+            return sizeof( ui32 );
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+// The blob is only 16 byte aligned in valid files, so the indices are copied out
+static bool hasValidIndices( const uc8 *data, IndexType type, ui32 numIndices, ui32 numVertices ) {
+    const ui32 indexSize( getIndexSize( type ) );
+    for ( ui32 i = 0; i < numIndices; ++i ) {
+        ui32 idx( 0 );
+        if ( IndexType::UnsignedByte == type ) {
+            idx = data[ i ];
+        } else if ( IndexType::UnsignedShort == type ) {
+            ui16 value( 0 );
+            ::memcpy( &value, data + i * indexSize, sizeof( ui16 ) );
+            idx = value;
+        } else {
+            ::memcpy( &idx, data + i * indexSize, sizeof( ui32 ) );
+        }
+        if ( idx >= numVertices ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CookedModel::validate() const {
+    const ui64 fileSize( m_file->getSize() );
+    if ( fileSize < sizeof( CookedModelHeader ) ) {
+        return false;
+    }
+
+    if ( Magic != m_header->m_magic || Version != m_header->m_version || sizeof( CookedModelHeader ) != m_header->m_headerSize ) {
+        return false;
+    }
+
+    if ( !isInFile( m_header->m_meshOffset, m_header->m_numMeshes, sizeof( CookedMesh ), fileSize )
+            || !isInFile( m_header->m_materialOffset, m_header->m_numMaterials, sizeof( CookedMaterial ), fileSize )
+            || !isInFile( m_header->m_nodeOffset, m_header->m_numNodes, sizeof( CookedNode ), fileSize )
+            || !isInFile( m_header->m_meshRefOffset, m_header->m_numMeshRefs, sizeof( ui32 ), fileSize )
+            || !isInFile( m_header->m_stringOffset, m_header->m_stringsSize, 1, fileSize )
+            || !isInFile( m_header->m_blobOffset, m_header->m_blobSize, 1, fileSize ) ) {
+        return false;
+    }
+
+    // The record tables are aligned in all files written by save
+    if ( 0 != m_header->m_meshOffset % sizeof( ui64 ) || 0 != m_header->m_materialOffset % sizeof( ui32 )
+            || 0 != m_header->m_nodeOffset % sizeof( ui32 ) || 0 != m_header->m_meshRefOffset % sizeof( ui32 ) ) {
+        return false;
+    }
+
+    // The meshes are handed to the renderer as they are, so the buffers, enums and index values are checked
+    const uc8 *data( m_file->getData() );
+    const CookedMesh *meshes( reinterpret_cast<const CookedMesh*>( data + m_header->m_meshOffset ) );
+    for ( ui32 i = 0; i < m_header->m_numMeshes; ++i ) {
+        const CookedMesh &mesh( meshes[ i ] );
+        if ( !isInFile( mesh.m_vbOffset, mesh.m_vbSize, 1, fileSize ) || !isInFile( mesh.m_ibOffset, mesh.m_ibSize, 1, fileSize ) ) {
+            return false;
+        }
+        if ( mesh.m_vertexType >= static_cast<ui32>( VertexType::NumVertexTypes )
+                || mesh.m_indexType >= static_cast<ui32>( IndexType::NumIndexTypes )
+                || mesh.m_primitive >= static_cast<ui32>( PrimitiveType::NumPrimitiveTypes ) ) {
+            return false;
+        }
+        if ( InvalidIndex != mesh.m_material && mesh.m_material >= m_header->m_numMaterials ) {
+            return false;
+        }
+
+        const IndexType indexType( static_cast<IndexType>( mesh.m_indexType ) );
+        const ui32 vertexSize( Geometry::getVertexSize( static_cast<VertexType>( mesh.m_vertexType ) ) );
+        if ( 0 == vertexSize || mesh.m_numIndices > mesh.m_ibSize / getIndexSize( indexType ) ) {
+            return false;
+        }
+        if ( !hasValidIndices( data + mesh.m_ibOffset, indexType, mesh.m_numIndices, mesh.m_vbSize / vertexSize ) ) {
+            return false;
+        }
+    }
+
+    // Parents must precede their children and the mesh references must stay in their table
+    const CookedNode *nodes( reinterpret_cast<const CookedNode*>( data + m_header->m_nodeOffset ) );
+    for ( ui32 i = 0; i < m_header->m_numNodes; ++i ) {
+        const CookedNode &node( nodes[ i ] );
+        if ( node.m_parent >= static_cast<i32>( i ) ) {
+            return false;
+        }
+        if ( node.m_firstMeshRef > m_header->m_numMeshRefs || node.m_numMeshRefs > m_header->m_numMeshRefs - node.m_firstMeshRef ) {
+            return false;
+        }
+    }
+
+    const ui32 *meshRefs( reinterpret_cast<const ui32*>( data + m_header->m_meshRefOffset ) );
+    for ( ui32 i = 0; i < m_header->m_numMeshRefs; ++i ) {
+        if ( meshRefs[ i ] >= m_header->m_numMeshes ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CookedModel::close() {
+    // Geometries created from the file still hold the mapping
+    m_file.reset();
+    m_header = nullptr;
+    m_meshes = nullptr;
+    m_materials = nullptr;
+    m_nodes = nullptr;
+    m_meshRefs = nullptr;
+    m_strings = nullptr;
+}
+
+bool CookedModel::isUpToDate( ui64 sourceSize, ui64 sourceTime, ui64 settingsHash ) const {
+    if ( nullptr == m_header ) {
+        return false;
+    }
+
+    return sourceSize == m_header->m_sourceSize && sourceTime == m_header->m_sourceTime 
+            && settingsHash == m_header->m_settingsHash;
+}
+
+CookedModel::AABB CookedModel::getAABB() const {
+    AABB aabb;
+    if ( nullptr != m_header ) {
+        aabb.set( AABB::VecType( m_header->m_aabb[ 0 ], m_header->m_aabb[ 1 ], m_header->m_aabb[ 2 ] ),
+                  AABB::VecType( m_header->m_aabb[ 3 ], m_header->m_aabb[ 4 ], m_header->m_aabb[ 5 ] ) );
+    }
+
+    return aabb;
+}
+
+Geometry *CookedModel::createGeometry( ui32 idx ) const {
+    if ( idx >= getNumMeshes() ) {
+        return nullptr;
+    }
+
+    const CookedMesh &cooked( m_meshes[ idx ] );
+    uc8 *data( m_file->getData() );
+    Geometry *geo( Geometry::create( 1 ) );
+    geo->m_vertextype = static_cast<VertexType>( cooked.m_vertexType );
+    geo->m_indextype = static_cast<IndexType>( cooked.m_indexType );
+    geo->m_localMatrix = 0 != cooked.m_localMatrix;
+    geo->m_model = glm::make_mat4( cooked.m_model );
+
+    // The buffers view the mapped file, nothing will be copied
+    geo->m_vb = BufferData::wrap( BufferType::VertexBuffer, data + cooked.m_vbOffset, cooked.m_vbSize, BufferAccessType::ReadOnly, m_file );
+    geo->m_ib = BufferData::wrap( BufferType::IndexBuffer, data + cooked.m_ibOffset, cooked.m_ibSize, BufferAccessType::ReadOnly, m_file );
+    geo->m_numPrimGroups = 1;
+    geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
+    geo->m_pPrimGroups[ 0 ].init( geo->m_indextype, cooked.m_numIndices, static_cast<PrimitiveType>( cooked.m_primitive ), 0 );
+
+    return geo;
+}
+
+ui32 CookedModel::getMeshMaterial( ui32 idx ) const {
+    if ( idx >= getNumMeshes() ) {
+        return InvalidIndex;
+    }
+
+    return m_meshes[ idx ].m_material;
+}
+
+VertexType CookedModel::getMeshVertexType( ui32 idx ) const {
+    if ( idx >= getNumMeshes() ) {
+        return VertexType::InvalidVertexType;
+    }
+
+    return static_cast<VertexType>( m_meshes[ idx ].m_vertexType );
+}
+
+Material *CookedModel::createMaterial( ui32 idx, VertexType type ) const {
+    if ( idx >= getNumMaterials() ) {
+        return nullptr;
+    }
+
+    const CookedMaterial &cooked( m_materials[ idx ] );
+    Material *mat( Scene::MaterialBuilder::createBuildinMaterial( type ) );
+    for ( ui32 i = 0; i < MaxMatColorType; ++i ) {
+        mat->m_color[ i ].m_r = cooked.m_colors[ i ][ 0 ];
+        mat->m_color[ i ].m_g = cooked.m_colors[ i ][ 1 ];
+        mat->m_color[ i ].m_b = cooked.m_colors[ i ][ 2 ];
+        mat->m_color[ i ].m_a = cooked.m_colors[ i ][ 3 ];
+    }
+
+    if ( 0 != cooked.m_textureLength ) {
+        Texture *tex( new Texture );
+        String texname( getString( cooked.m_textureOffset, cooked.m_textureLength ) );
+        tex->m_loc = IO::Uri( texname );
+        const String::size_type pos( texname.rfind( "/" ) );
+        if ( String::npos != pos ) {
+            texname = texname.substr( pos, texname.size() - pos );
+        }
+        tex->m_textureName = texname;
+        mat->m_numTextures = 1;
+        mat->m_textures = new Texture*[ mat->m_numTextures ];
+        mat->m_textures[ 0 ] = tex;
+    }
+
+    return mat;
+}
+
+String CookedModel::getNodeName( ui32 idx ) const {
+    if ( idx >= getNumNodes() ) {
+        return String();
+    }
+
+    return getString( m_nodes[ idx ].m_nameOffset, m_nodes[ idx ].m_nameLength );
+}
+
+i32 CookedModel::getNodeParent( ui32 idx ) const {
+    if ( idx >= getNumNodes() ) {
+        return -1;
+    }
+
+    return m_nodes[ idx ].m_parent;
+}
+
+glm::mat4 CookedModel::getNodeTransform( ui32 idx ) const {
+    if ( idx >= getNumNodes() ) {
+        return glm::mat4( 1.0f );
+    }
+
+    return glm::make_mat4( m_nodes[ idx ].m_transform );
+}
+
+ui32 CookedModel::getNumNodeMeshes( ui32 idx ) const {
+    if ( idx >= getNumNodes() ) {
+        return 0;
+    }
+
+    return m_nodes[ idx ].m_numMeshRefs;
+}
+
+ui32 CookedModel::getNodeMeshAt( ui32 idx, ui32 meshIdx ) const {
+    if ( idx >= getNumNodes() || meshIdx >= m_nodes[ idx ].m_numMeshRefs ) {
+        return InvalidIndex;
+    }
+
+    const ui32 ref( m_nodes[ idx ].m_firstMeshRef + meshIdx );
+    if ( ref >= m_header->m_numMeshRefs ) {
+        return InvalidIndex;
+    }
+
+    return m_meshRefs[ ref ];
+}
+
+String CookedModel::getString( ui32 offset, ui32 length ) const {
+    if ( nullptr == m_strings || static_cast<ui64>( offset ) + length > m_header->m_stringsSize ) {
+        return String();
+    }
+
+    return String( m_strings + offset, length );
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,740 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/CookedTexture.h>
+#include <osre/Assets/CookedModel.h>
+#include <osre/Common/Logger.h>
+#include <osre/IO/IOService.h>
+#include <osre/IO/MemoryMappedFile.h>
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+#include <src/Engine/IO/ImageCodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace OSRE {
+namespace Assets {
+
+static const String Tag = "CookedTexture";
+
+// The extension appended to the source image name
+static const String CookedExtension = ".ost";
+
+static_assert( sizeof( CookedTextureHeader ) % 8 == 0, "Cooked texture header must keep 8 byte alignment." );
+static_assert( sizeof( CookedTextureLevel ) % 8 == 0, "Cooked texture level must keep 8 byte alignment." );
+
+const ui32 CookedTexture::Magic;
+const ui32 CookedTexture::Version;
+const ui32 CookedTexture::BlobAlignment;
+const ui32 CookedTexture::MaxLevels;
+
+CookedTexture::Image::Image()
+: m_width( 0 )
+, m_height( 0 )
+, m_data() {
+    // empty
+}
+
+void CookedTexture::Image::resize( ui32 width, ui32 height ) {
+    m_width = width;
+    m_height = height;
+    m_data.resize( static_cast<size_t>( width ) * height * 4 );
+}
+
+CookedTexture::Options::Options()
+: m_format( CookedTextureFormat::InvalidFormat )
+, m_srgb( true )
+, m_normalMap( false )
+, m_generateMips( true ) {
+    // empty
+}
+
+CookedTexture::CookedTexture()
+: m_file()
+, m_header( nullptr )
+, m_levels( nullptr ) {
+    // empty
+}
+
+CookedTexture::~CookedTexture() {
+    close();
+}
+
+static ui64 alignOffset( ui64 offset, ui64 alignment ) {
+    return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+// The sRGB decoding table, built once on first use
+struct SrgbTable {
+    f32 m_linear[ 256 ];
+
+    SrgbTable() {
+        for ( ui32 i = 0; i < 256; ++i ) {
+            const f32 c( static_cast<f32>( i ) / 255.0f );
+            m_linear[ i ] = c <= 0.04045f ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f );
+        }
+    }
+};
+
+static f32 srgbToLinear( uc8 value ) {
+    static const SrgbTable table;
+
+    return table.m_linear[ value ];
+}
+
+static uc8 linearToSrgb( f32 value ) {
+    value = std::max( 0.0f, std::min( 1.0f, value ) );
+    const f32 c( value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow( value, 1.0f / 2.4f ) - 0.055f );
+
+    return static_cast<uc8>( c * 255.0f + 0.5f );
+}
+
+static uc8 toUnorm8( f32 value ) {
+    return static_cast<uc8>( std::max( 0.0f, std::min( 1.0f, value ) ) * 255.0f + 0.5f );
+}
+
+// Halves the image with a box filter, the last row or column of odd sizes is skipped
+static void downsample( const CookedTexture::Image &src, bool srgb, bool normalMap, CookedTexture::Image &dst ) {
+    dst.resize( std::max<ui32>( src.m_width / 2, 1 ), std::max<ui32>( src.m_height / 2, 1 ) );
+    for ( ui32 y = 0; y < dst.m_height; ++y ) {
+        const ui32 y0( std::min( 2 * y, src.m_height - 1 ) ), y1( std::min( 2 * y + 1, src.m_height - 1 ) );
+        for ( ui32 x = 0; x < dst.m_width; ++x ) {
+            const ui32 x0( std::min( 2 * x, src.m_width - 1 ) ), x1( std::min( 2 * x + 1, src.m_width - 1 ) );
+            const uc8 *texels[ 4 ] = {
+                &src.m_data[ ( y0 * src.m_width + x0 ) * 4 ], &src.m_data[ ( y0 * src.m_width + x1 ) * 4 ],
+                &src.m_data[ ( y1 * src.m_width + x0 ) * 4 ], &src.m_data[ ( y1 * src.m_width + x1 ) * 4 ]
+            };
+
+            f32 sum[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for ( ui32 i = 0; i < 4; ++i ) {
+                for ( ui32 c = 0; c < 3; ++c ) {
+                    sum[ c ] += srgb ? srgbToLinear( texels[ i ][ c ] ) : texels[ i ][ c ] / 255.0f;
+                }
+                sum[ 3 ] += texels[ i ][ 3 ] / 255.0f;
+            }
+            for ( ui32 c = 0; c < 4; ++c ) {
+                sum[ c ] *= 0.25f;
+            }
+
+            if ( normalMap ) {
+                f32 n[ 3 ] = { sum[ 0 ] * 2.0f - 1.0f, sum[ 1 ] * 2.0f - 1.0f, sum[ 2 ] * 2.0f - 1.0f };
+                const f32 len( std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] ) );
+                if ( len > 0.0f ) {
+                    for ( ui32 c = 0; c < 3; ++c ) {
+                        sum[ c ] = n[ c ] / len * 0.5f + 0.5f;
+                    }
+                }
+            }
+
+            uc8 *texel( &dst.m_data[ ( y * dst.m_width + x ) * 4 ] );
+            for ( ui32 c = 0; c < 3; ++c ) {
+                texel[ c ] = srgb && !normalMap ? linearToSrgb( sum[ c ] ) : toUnorm8( sum[ c ] );
+            }
+            texel[ 3 ] = toUnorm8( sum[ 3 ] );
+        }
+    }
+}
+
+static ui16 packRGB565( const f32 color[ 3 ] ) {
+    const ui32 r( static_cast<ui32>( std::max( 0.0f, std::min( 255.0f, color[ 0 ] ) ) * 31.0f / 255.0f + 0.5f ) );
+    const ui32 g( static_cast<ui32>( std::max( 0.0f, std::min( 255.0f, color[ 1 ] ) ) * 63.0f / 255.0f + 0.5f ) );
+    const ui32 b( static_cast<ui32>( std::max( 0.0f, std::min( 255.0f, color[ 2 ] ) ) * 31.0f / 255.0f + 0.5f ) );
+
+    return static_cast<ui16>( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+static void unpackRGB565( ui16 packed, i32 color[ 3 ] ) {
+    const i32 r( ( packed >> 11 ) & 31 ), g( ( packed >> 5 ) & 63 ), b( packed & 31 );
+    color[ 0 ] = ( r << 3 ) | ( r >> 2 );
+    color[ 1 ] = ( g << 2 ) | ( g >> 4 );
+    color[ 2 ] = ( b << 3 ) | ( b >> 2 );
+}
+
+// Computes the palette of a color block, the three color mode is used for c0 <= c1
+static void getColorPalette( ui16 c0, ui16 c1, bool forceFourColors, i32 palette[ 4 ][ 4 ] ) {
+    unpackRGB565( c0, palette[ 0 ] );
+    unpackRGB565( c1, palette[ 1 ] );
+    palette[ 0 ][ 3 ] = palette[ 1 ][ 3 ] = palette[ 2 ][ 3 ] = palette[ 3 ][ 3 ] = 255;
+    for ( ui32 c = 0; c < 3; ++c ) {
+        if ( c0 > c1 || forceFourColors ) {
+            palette[ 2 ][ c ] = ( 2 * palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 3;
+            palette[ 3 ][ c ] = ( palette[ 0 ][ c ] + 2 * palette[ 1 ][ c ] ) / 3;
+        } else {
+            palette[ 2 ][ c ] = ( palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 2;
+            palette[ 3 ][ c ] = 0;
+        }
+    }
+    if ( c0 <= c1 && !forceFourColors ) {
+        palette[ 3 ][ 3 ] = 0;
+    }
+}
+
+// Selects the nearest palette entries and returns the squared error
+static ui32 fitColorIndices( const uc8 *block, ui16 c0, ui16 c1, ui32 &indices ) {
+    i32 palette[ 4 ][ 4 ];
+    getColorPalette( c0, c1, true, palette );
+    indices = 0;
+    ui32 error( 0 );
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const uc8 *texel( &block[ i * 4 ] );
+        ui32 best( 0 ), bestDist( 0xFFFFFFFF );
+        for ( ui32 j = 0; j < 4; ++j ) {
+            const i32 dr( texel[ 0 ] - palette[ j ][ 0 ] ), dg( texel[ 1 ] - palette[ j ][ 1 ] ), db( texel[ 2 ] - palette[ j ][ 2 ] );
+            const ui32 dist( static_cast<ui32>( dr * dr + dg * dg + db * db ) );
+            if ( dist < bestDist ) {
+                bestDist = dist;
+                best = j;
+            }
+        }
+        indices |= best << ( 2 * i );
+        error += bestDist;
+    }
+
+    return error;
+}
+
+// Orders the end points for the four color mode and writes the block
+static void writeColorBlock( const uc8 *block, ui16 c0, ui16 c1, uc8 *out, ui32 &error ) {
+    if ( c0 < c1 ) {
+        std::swap( c0, c1 );
+    }
+
+    ui32 indices( 0 );
+    error = fitColorIndices( block, c0, c1, indices );
+    if ( c0 == c1 ) {
+        indices = 0;
+    }
+    out[ 0 ] = static_cast<uc8>( c0 & 0xFF );
+    out[ 1 ] = static_cast<uc8>( c0 >> 8 );
+    out[ 2 ] = static_cast<uc8>( c1 & 0xFF );
+    out[ 3 ] = static_cast<uc8>( c1 >> 8 );
+    for ( ui32 i = 0; i < 4; ++i ) {
+        out[ 4 + i ] = static_cast<uc8>( ( indices >> ( 8 * i ) ) & 0xFF );
+    }
+}
+
+// Encodes the colors of a 4x4 block, the end points are taken from the principal axis and 
+// refined once by a least squares fit
+static void encodeColorBlock( const uc8 *block, uc8 *out ) {
+    f32 mean[ 3 ] = { 0.0f, 0.0f, 0.0f };
+    for ( ui32 i = 0; i < 16; ++i ) {
+        for ( ui32 c = 0; c < 3; ++c ) {
+            mean[ c ] += block[ i * 4 + c ];
+        }
+    }
+    for ( ui32 c = 0; c < 3; ++c ) {
+        mean[ c ] /= 16.0f;
+    }
+
+    f32 cov[ 6 ] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const f32 r( block[ i * 4 ] - mean[ 0 ] ), g( block[ i * 4 + 1 ] - mean[ 1 ] ), b( block[ i * 4 + 2 ] - mean[ 2 ] );
+        cov[ 0 ] += r * r;
+        cov[ 1 ] += r * g;
+        cov[ 2 ] += r * b;
+        cov[ 3 ] += g * g;
+        cov[ 4 ] += g * b;
+        cov[ 5 ] += b * b;
+    }
+
+    // Power iteration, starts with the covariance column of the channel with the largest variance
+    f32 axis[ 3 ] = { cov[ 0 ], cov[ 1 ], cov[ 2 ] };
+    if ( cov[ 3 ] > cov[ 0 ] && cov[ 3 ] >= cov[ 5 ] ) {
+        axis[ 0 ] = cov[ 1 ];
+        axis[ 1 ] = cov[ 3 ];
+        axis[ 2 ] = cov[ 4 ];
+    } else if ( cov[ 5 ] > cov[ 0 ] && cov[ 5 ] > cov[ 3 ] ) {
+        axis[ 0 ] = cov[ 2 ];
+        axis[ 1 ] = cov[ 4 ];
+        axis[ 2 ] = cov[ 5 ];
+    }
+    for ( ui32 iter = 0; iter < 8; ++iter ) {
+        const f32 x( axis[ 0 ] * cov[ 0 ] + axis[ 1 ] * cov[ 1 ] + axis[ 2 ] * cov[ 2 ] );
+        const f32 y( axis[ 0 ] * cov[ 1 ] + axis[ 1 ] * cov[ 3 ] + axis[ 2 ] * cov[ 4 ] );
+        const f32 z( axis[ 0 ] * cov[ 2 ] + axis[ 1 ] * cov[ 4 ] + axis[ 2 ] * cov[ 5 ] );
+        const f32 scale( std::max( std::fabs( x ), std::max( std::fabs( y ), std::fabs( z ) ) ) );
+        if ( scale <= 0.0f ) {
+            break;
+        }
+        axis[ 0 ] = x / scale;
+        axis[ 1 ] = y / scale;
+        axis[ 2 ] = z / scale;
+    }
+
+    ui32 minIdx( 0 ), maxIdx( 0 );
+    f32 minProj( 0.0f ), maxProj( 0.0f );
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const f32 proj( block[ i * 4 ] * axis[ 0 ] + block[ i * 4 + 1 ] * axis[ 1 ] + block[ i * 4 + 2 ] * axis[ 2 ] );
+        if ( 0 == i || proj < minProj ) {
+            minProj = proj;
+            minIdx = i;
+        }
+        if ( 0 == i || proj > maxProj ) {
+            maxProj = proj;
+            maxIdx = i;
+        }
+    }
+
+    // Inset the end points, the interpolated colors cover the range better
+    f32 e0[ 3 ], e1[ 3 ];
+    for ( ui32 c = 0; c < 3; ++c ) {
+        e0[ c ] = block[ maxIdx * 4 + c ];
+        e1[ c ] = block[ minIdx * 4 + c ];
+        const f32 inset( ( e0[ c ] - e1[ c ] ) / 16.0f );
+        e0[ c ] -= inset;
+        e1[ c ] += inset;
+    }
+
+    ui32 error( 0 );
+    writeColorBlock( block, packRGB565( e0 ), packRGB565( e1 ), out, error );
+    if ( 0 == error ) {
+        return;
+    }
+
+    // Least squares fit of the end points for the selected indices
+    static const f32 weights[ 4 ] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    const ui32 indices( out[ 4 ] | ( out[ 5 ] << 8 ) | ( out[ 6 ] << 16 ) | ( static_cast<ui32>( out[ 7 ] ) << 24 ) );
+    f32 aa( 0.0f ), ab( 0.0f ), bb( 0.0f ), ax[ 3 ] = { 0.0f, 0.0f, 0.0f }, bx[ 3 ] = { 0.0f, 0.0f, 0.0f };
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const f32 a( weights[ ( indices >> ( 2 * i ) ) & 3 ] ), b( 1.0f - a );
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for ( ui32 c = 0; c < 3; ++c ) {
+            ax[ c ] += a * block[ i * 4 + c ];
+            bx[ c ] += b * block[ i * 4 + c ];
+        }
+    }
+    const f32 det( aa * bb - ab * ab );
+    if ( std::fabs( det ) < 1e-6f ) {
+        return;
+    }
+    for ( ui32 c = 0; c < 3; ++c ) {
+        e0[ c ] = ( ax[ c ] * bb - bx[ c ] * ab ) / det;
+        e1[ c ] = ( bx[ c ] * aa - ax[ c ] * ab ) / det;
+    }
+
+    uc8 refined[ 8 ];
+    ui32 refinedError( 0 );
+    writeColorBlock( block, packRGB565( e0 ), packRGB565( e1 ), refined, refinedError );
+    if ( refinedError < error ) {
+        ::memcpy( out, refined, sizeof( refined ) );
+    }
+}
+
+// Encodes one channel of a 4x4 block in the eight value mode of BC4
+static void encodeChannelBlock( const uc8 *block, ui32 channel, uc8 *out ) {
+    uc8 minValue( 255 ), maxValue( 0 );
+    for ( ui32 i = 0; i < 16; ++i ) {
+        minValue = std::min( minValue, block[ i * 4 + channel ] );
+        maxValue = std::max( maxValue, block[ i * 4 + channel ] );
+    }
+
+    out[ 0 ] = maxValue;
+    out[ 1 ] = minValue;
+    ui64 indices( 0 );
+    if ( maxValue != minValue ) {
+        i32 palette[ 8 ] = { maxValue, minValue };
+        for ( i32 i = 2; i < 8; ++i ) {
+            palette[ i ] = ( ( 8 - i ) * maxValue + ( i - 1 ) * minValue ) / 7;
+        }
+        for ( ui32 i = 0; i < 16; ++i ) {
+            const i32 value( block[ i * 4 + channel ] );
+            ui32 best( 0 );
+            i32 bestDist( 256 );
+            for ( ui32 j = 0; j < 8; ++j ) {
+                const i32 dist( std::abs( value - palette[ j ] ) );
+                if ( dist < bestDist ) {
+                    bestDist = dist;
+                    best = j;
+                }
+            }
+            indices |= static_cast<ui64>( best ) << ( 3 * i );
+        }
+    }
+    for ( ui32 i = 0; i < 6; ++i ) {
+        out[ 2 + i ] = static_cast<uc8>( ( indices >> ( 8 * i ) ) & 0xFF );
+    }
+}
+
+static void decodeColorBlock( const uc8 *in, bool forceFourColors, uc8 *block ) {
+    const ui16 c0( static_cast<ui16>( in[ 0 ] | ( in[ 1 ] << 8 ) ) ), c1( static_cast<ui16>( in[ 2 ] | ( in[ 3 ] << 8 ) ) );
+    i32 palette[ 4 ][ 4 ];
+    getColorPalette( c0, c1, forceFourColors, palette );
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const ui32 idx( ( in[ 4 + i / 4 ] >> ( 2 * ( i % 4 ) ) ) & 3 );
+        for ( ui32 c = 0; c < 4; ++c ) {
+            block[ i * 4 + c ] = static_cast<uc8>( palette[ idx ][ c ] );
+        }
+    }
+}
+
+static void decodeChannelBlock( const uc8 *in, ui32 channel, uc8 *block ) {
+    const i32 a0( in[ 0 ] ), a1( in[ 1 ] );
+    i32 palette[ 8 ] = { a0, a1 };
+    if ( a0 > a1 ) {
+        for ( i32 i = 2; i < 8; ++i ) {
+            palette[ i ] = ( ( 8 - i ) * a0 + ( i - 1 ) * a1 ) / 7;
+        }
+    } else {
+        for ( i32 i = 2; i < 6; ++i ) {
+            palette[ i ] = ( ( 6 - i ) * a0 + ( i - 1 ) * a1 ) / 5;
+        }
+        palette[ 6 ] = 0;
+        palette[ 7 ] = 255;
+    }
+
+    ui64 indices( 0 );
+    for ( ui32 i = 0; i < 6; ++i ) {
+        indices |= static_cast<ui64>( in[ 2 + i ] ) << ( 8 * i );
+    }
+    for ( ui32 i = 0; i < 16; ++i ) {
+        block[ i * 4 + channel ] = static_cast<uc8>( palette[ ( indices >> ( 3 * i ) ) & 7 ] );
+    }
+}
+
+bool CookedTexture::loadImage( const String &filename, Image &image ) {
+    IO::MemoryMappedFile file;
+    if ( !file.open( filename ) || file.getSize() > 0x7FFFFFFF ) {
+        osre_debug( Tag, "Cannot load image " + filename );
+        return false;
+    }
+
+    // Flip the rows like the render backend does for uncooked textures
+    IO::ImageCodec::ImageInfo info;
+    if ( !IO::ImageCodec::decodeImage( file.getData(), static_cast<ui32>( file.getSize() ), 
+            IO::ImageCodec::PixelFormat::RGBA, IO::ImageCodec::FlipVertical, image.m_data, info ) ) {
+        osre_debug( Tag, "Cannot load image " + filename );
+        return false;
+    }
+    image.m_width = info.m_width;
+    image.m_height = info.m_height;
+
+    return true;
+}
+
+void CookedTexture::generateMipChain( const Image &image, bool srgb, bool normalMap, std::vector<Image> &levels ) {
+    levels.clear();
+    if ( 0 == image.m_width || 0 == image.m_height ) {
+        return;
+    }
+
+    levels.reserve( MaxLevels );
+    levels.push_back( image );
+    while ( ( levels.back().m_width > 1 || levels.back().m_height > 1 ) && levels.size() < MaxLevels ) {
+        levels.push_back( Image() );
+        downsample( levels[ levels.size() - 2 ], srgb, normalMap, levels.back() );
+    }
+}
+
+CookedTextureFormat CookedTexture::selectFormat( const Image &image ) {
+    for ( size_t i = 3; i < image.m_data.size(); i += 4 ) {
+        if ( 255 != image.m_data[ i ] ) {
+            return CookedTextureFormat::BC3;
+        }
+    }
+
+    return CookedTextureFormat::BC1;
+}
+
+ui32 CookedTexture::getBlockSize( CookedTextureFormat format ) {
+    switch ( format ) {
+        case CookedTextureFormat::BC1:
+            return 8;
+        case CookedTextureFormat::BC3:
+        case CookedTextureFormat::BC5:
+            return 16;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+ui32 CookedTexture::getLevelSize( CookedTextureFormat format, ui32 width, ui32 height ) {
+    if ( CookedTextureFormat::RGBA8 == format ) {
+        return width * height * 4;
+    }
+
+    return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * getBlockSize( format );
+}
+
+void CookedTexture::encode( const Image &image, CookedTextureFormat format, std::vector<uc8> &data ) {
+    data.resize( getLevelSize( format, image.m_width, image.m_height ) );
+    if ( data.empty() ) {
+        return;
+    }
+
+    if ( CookedTextureFormat::RGBA8 == format ) {
+        ::memcpy( &data[ 0 ], &image.m_data[ 0 ], data.size() );
+        return;
+    }
+
+    const ui32 blockSize( getBlockSize( format ) );
+    uc8 *out( &data[ 0 ] );
+    uc8 block[ 64 ];
+    for ( ui32 by = 0; by < image.m_height; by += 4 ) {
+        for ( ui32 bx = 0; bx < image.m_width; bx += 4 ) {
+            // The texels outside of the image repeat the border
+            for ( ui32 i = 0; i < 16; ++i ) {
+                const ui32 x( std::min( bx + i % 4, image.m_width - 1 ) ), y( std::min( by + i / 4, image.m_height - 1 ) );
+                ::memcpy( &block[ i * 4 ], &image.m_data[ ( y * image.m_width + x ) * 4 ], 4 );
+            }
+
+            if ( CookedTextureFormat::BC1 == format ) {
+                encodeColorBlock( block, out );
+            } else if ( CookedTextureFormat::BC3 == format ) {
+                encodeChannelBlock( block, 3, out );
+                encodeColorBlock( block, out + 8 );
+            } else {
+                encodeChannelBlock( block, 0, out );
+                encodeChannelBlock( block, 1, out + 8 );
+            }
+            out += blockSize;
+        }
+    }
+}
+
+bool CookedTexture::decode( const uc8 *data, CookedTextureFormat format, ui32 width, ui32 height, Image &image ) {
+    if ( nullptr == data || format >= CookedTextureFormat::NumFormats ) {
+        return false;
+    }
+
+    image.resize( width, height );
+    if ( CookedTextureFormat::RGBA8 == format ) {
+        if ( !image.m_data.empty() ) {
+            ::memcpy( &image.m_data[ 0 ], data, image.m_data.size() );
+        }
+        return true;
+    }
+
+    const ui32 blockSize( getBlockSize( format ) );
+    uc8 block[ 64 ];
+    for ( ui32 by = 0; by < height; by += 4 ) {
+        for ( ui32 bx = 0; bx < width; bx += 4 ) {
+            if ( CookedTextureFormat::BC1 == format ) {
+                decodeColorBlock( data, false, block );
+            } else if ( CookedTextureFormat::BC3 == format ) {
+                decodeColorBlock( data + 8, true, block );
+                decodeChannelBlock( data, 3, block );
+            } else {
+                ::memset( block, 0, sizeof( block ) );
+                decodeChannelBlock( data, 0, block );
+                decodeChannelBlock( data + 8, 1, block );
+                for ( ui32 i = 0; i < 16; ++i ) {
+                    block[ i * 4 + 3 ] = 255;
+                }
+            }
+            data += blockSize;
+
+            for ( ui32 i = 0; i < 16; ++i ) {
+                const ui32 x( bx + i % 4 ), y( by + i / 4 );
+                if ( x < width && y < height ) {
+                    ::memcpy( &image.m_data[ ( y * width + x ) * 4 ], &block[ i * 4 ], 4 );
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool CookedTexture::save( IO::Stream &stream, const Image &image, const Options &options, ui64 sourceSize, ui64 sourceTime ) {
+    if ( !stream.isOpen() || !stream.canWrite() ) {
+        osre_error( Tag, "Cannot write cooked texture, stream is not writable." );
+        return false;
+    }
+
+    if ( 0 == image.m_width || 0 == image.m_height || image.m_data.size() != static_cast<size_t>( image.m_width ) * image.m_height * 4 ) {
+        osre_error( Tag, "Cannot write cooked texture, image is invalid." );
+        return false;
+    }
+
+    CookedTextureFormat format( options.m_format );
+    if ( CookedTextureFormat::InvalidFormat == format ) {
+        format = selectFormat( image );
+    }
+    if ( format >= CookedTextureFormat::NumFormats ) {
+        osre_error( Tag, "Cannot write cooked texture, format is invalid." );
+        return false;
+    }
+
+    std::vector<Image> images;
+    if ( options.m_generateMips ) {
+        generateMipChain( image, options.m_srgb, options.m_normalMap, images );
+    } else {
+        images.push_back( image );
+    }
+
+    CookedTextureHeader header;
+    ::memset( &header, 0, sizeof( CookedTextureHeader ) );
+    header.m_magic = Magic;
+    header.m_version = Version;
+    header.m_headerSize = sizeof( CookedTextureHeader );
+    header.m_format = static_cast<ui32>( format );
+    header.m_width = image.m_width;
+    header.m_height = image.m_height;
+    header.m_numLevels = static_cast<ui32>( images.size() );
+    header.m_srgb = options.m_srgb ? 1 : 0;
+    header.m_sourceSize = sourceSize;
+    header.m_sourceTime = sourceTime;
+    header.m_levelOffset = sizeof( CookedTextureHeader );
+
+    std::vector<CookedTextureLevel> levels( images.size() );
+    ui64 offset( alignOffset( header.m_levelOffset + sizeof( CookedTextureLevel ) * levels.size(), BlobAlignment ) );
+    for ( size_t i = 0; i < images.size(); ++i ) {
+        CookedTextureLevel &level( levels[ i ] );
+        ::memset( &level, 0, sizeof( CookedTextureLevel ) );
+        level.m_width = images[ i ].m_width;
+        level.m_height = images[ i ].m_height;
+        level.m_size = getLevelSize( format, level.m_width, level.m_height );
+        level.m_offset = offset;
+        offset = alignOffset( offset + level.m_size, BlobAlignment );
+    }
+
+    bool ok( true );
+    ok = ok && sizeof( CookedTextureHeader ) == stream.write( &header, sizeof( CookedTextureHeader ) );
+    const ui32 tableSize( static_cast<ui32>( sizeof( CookedTextureLevel ) * levels.size() ) );
+    ok = ok && tableSize == stream.write( &levels[ 0 ], tableSize );
+
+    // Padding up to the aligned start of each level
+    static const uc8 zeros[ BlobAlignment ] = { 0 };
+    ui64 pos( header.m_levelOffset + tableSize );
+    std::vector<uc8> data;
+    for ( size_t i = 0; i < images.size() && ok; ++i ) {
+        const ui32 padding( static_cast<ui32>( levels[ i ].m_offset - pos ) );
+        ok = ok && padding == stream.write( zeros, padding );
+        encode( images[ i ], format, data );
+        ok = ok && levels[ i ].m_size == stream.write( &data[ 0 ], levels[ i ].m_size );
+        pos = levels[ i ].m_offset + levels[ i ].m_size;
+    }
+    const ui32 endPadding( static_cast<ui32>( offset - pos ) );
+    ok = ok && endPadding == stream.write( zeros, endPadding );
+
+    if ( !ok ) {
+        osre_error( Tag, "Error while writing cooked texture." );
+    }
+
+    return ok;
+}
+
+bool CookedTexture::cook( const String &source, const String &target, const Options &options ) {
+    IO::IOService *ioSrv( IO::IOService::getInstance() );
+    if ( nullptr == ioSrv ) {
+        osre_error( Tag, "IO service is not available." );
+        return false;
+    }
+
+    Image image;
+    if ( !loadImage( source, image ) ) {
+        return false;
+    }
+
+    ui64 sourceSize( 0 ), sourceTime( 0 );
+    CookedModel::getSourceInfo( source, sourceSize, sourceTime );
+
+    IO::Stream *stream( ioSrv->openStream( IO::Uri( "file://" + target ), IO::Stream::AccessMode::WriteAccessBinary ) );
+    if ( nullptr == stream ) {
+        osre_error( Tag, "Cannot write cooked texture " + target );
+        return false;
+    }
+
+    const bool ok( save( *stream, image, options, sourceSize, sourceTime ) );
+    ioSrv->closeStream( &stream );
+
+    return ok;
+}
+
+String CookedTexture::getCookedName( const String &filename ) {
+    return filename + CookedExtension;
+}
+
+String CookedTexture::getSettings( const Options &options ) {
+    return std::to_string( static_cast<ui32>( options.m_format ) ) + ";" + ( options.m_srgb ? "1" : "0" ) 
+            + ( options.m_normalMap ? "1" : "0" ) + ( options.m_generateMips ? "1" : "0" );
+}
+
+bool CookedTexture::open( const String &filename ) {
+    close();
+    if ( !m_file.open( filename ) ) {
+        return false;
+    }
+
+    const uc8 *data( m_file.getData() );
+    m_header = reinterpret_cast<const CookedTextureHeader*>( data );
+    if ( !validate() ) {
+        osre_error( Tag, "Invalid or outdated cooked texture " + filename );
+        close();
+        return false;
+    }
+    m_levels = reinterpret_cast<const CookedTextureLevel*>( data + m_header->m_levelOffset );
+    m_file.advise( IO::MemoryMappedFile::AccessHint::WillNeed );
+
+    return true;
+}
+
+bool CookedTexture::validate() const {
+    const ui64 fileSize( m_file.getSize() );
+    if ( fileSize < sizeof( CookedTextureHeader ) ) {
+        return false;
+    }
+
+    if ( Magic != m_header->m_magic || Version != m_header->m_version || sizeof( CookedTextureHeader ) != m_header->m_headerSize ) {
+        return false;
+    }
+
+    const CookedTextureFormat format( static_cast<CookedTextureFormat>( m_header->m_format ) );
+    if ( format >= CookedTextureFormat::NumFormats || 0 == m_header->m_numLevels || m_header->m_numLevels > MaxLevels 
+            || m_header->m_levelOffset + sizeof( CookedTextureLevel ) * m_header->m_numLevels > fileSize ) {
+        return false;
+    }
+
+    // The uploads rely on the level sizes, so they must match the format
+    const CookedTextureLevel *levels( reinterpret_cast<const CookedTextureLevel*>( m_file.getData() + m_header->m_levelOffset ) );
+    for ( ui32 i = 0; i < m_header->m_numLevels; ++i ) {
+        if ( levels[ i ].m_offset + levels[ i ].m_size > fileSize 
+                || getLevelSize( format, levels[ i ].m_width, levels[ i ].m_height ) != levels[ i ].m_size ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CookedTexture::close() {
+    m_file.close();
+    m_header = nullptr;
+    m_levels = nullptr;
+}
+
+bool CookedTexture::isUpToDate( ui64 sourceSize, ui64 sourceTime ) const {
+    if ( nullptr == m_header ) {
+        return false;
+    }
+
+    return sourceSize == m_header->m_sourceSize && sourceTime == m_header->m_sourceTime;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
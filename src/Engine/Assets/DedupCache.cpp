@@ -0,0 +1,293 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/DedupCache.h>
+#include <osre/Assets/DerivedDataCache.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+DedupCache::DedupCache()
+: m_geometries()
+, m_geoRefs()
+, m_materials()
+, m_matRefs()
+, m_numDuplicates( 0 )
+, m_mutex() {
+    // empty
+}
+
+DedupCache::~DedupCache() {
+    // empty
+}
+
+template<class T>
+T *DedupCache::addEntry( T *obj, ui64 hash, std::multimap<ui64, T*> &entries, std::map<T*, Reference> &refs ) {
+    typename std::map<T*, Reference>::iterator ref( refs.find( obj ) );
+    if ( refs.end() != ref ) {
+        ++ref->second.m_numRefs;
+        return obj;
+    }
+
+    typedef typename std::multimap<ui64, T*>::const_iterator EntryIterator;
+    std::pair<EntryIterator, EntryIterator> range( entries.equal_range( hash ) );
+    for ( EntryIterator it = range.first; it != range.second; ++it ) {
+        if ( isEqual( it->second, obj ) ) {
+            ++refs[ it->second ].m_numRefs;
+            ++m_numDuplicates;
+            return it->second;
+        }
+    }
+    entries.insert( std::make_pair( hash, obj ) );
+    Reference &newRef( refs[ obj ] );
+    newRef.m_hash = hash;
+    newRef.m_numRefs = 1;
+
+    return obj;
+}
+
+template<class T>
+bool DedupCache::releaseEntry( T *obj, std::multimap<ui64, T*> &entries, std::map<T*, Reference> &refs ) {
+    typename std::map<T*, Reference>::iterator ref( refs.find( obj ) );
+    if ( refs.end() == ref ) {
+        return true;
+    }
+    if ( --ref->second.m_numRefs > 0 ) {
+        return false;
+    }
+
+    typedef typename std::multimap<ui64, T*>::iterator EntryIterator;
+    std::pair<EntryIterator, EntryIterator> range( entries.equal_range( ref->second.m_hash ) );
+    for ( EntryIterator it = range.first; it != range.second; ++it ) {
+        if ( it->second == obj ) {
+            entries.erase( it );
+            break;
+        }
+    }
+    refs.erase( ref );
+
+    return true;
+}
+
+Geometry *DedupCache::addGeometry( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        return nullptr;
+    }
+
+    const ui64 hash( hashGeometry( geo ) );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    return addEntry( geo, hash, m_geometries, m_geoRefs );
+}
+
+bool DedupCache::releaseGeometry( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    return releaseEntry( geo, m_geometries, m_geoRefs );
+}
+
+Material *DedupCache::addMaterial( Material *mat ) {
+    if ( nullptr == mat ) {
+        return nullptr;
+    }
+
+    const ui64 hash( hashMaterial( mat ) );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    return addEntry( mat, hash, m_materials, m_matRefs );
+}
+
+bool DedupCache::releaseMaterial( Material *mat ) {
+    if ( nullptr == mat ) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    return releaseEntry( mat, m_materials, m_matRefs );
+}
+
+void DedupCache::clear() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_geometries.clear();
+    m_geoRefs.clear();
+    m_materials.clear();
+    m_matRefs.clear();
+    m_numDuplicates = 0;
+}
+
+ui32 DedupCache::getNumGeometries() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return static_cast<ui32>( m_geometries.size() );
+}
+
+ui32 DedupCache::getNumMaterials() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return static_cast<ui32>( m_materials.size() );
+}
+
+ui32 DedupCache::getNumDuplicates() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_numDuplicates;
+}
+
+static ui64 hashBuffer( const BufferData *buffer, ui64 seed ) {
+    if ( nullptr == buffer || nullptr == buffer->m_data ) {
+        return DerivedDataCache::hash( nullptr, 0, seed );
+    }
+
+    return DerivedDataCache::hash( buffer->m_data, buffer->m_size, seed );
+}
+
+static bool isEqualBuffer( const BufferData *a, const BufferData *b ) {
+    if ( nullptr == a || nullptr == b ) {
+        return a == b;
+    }
+
+    return a->m_size == b->m_size && a->m_type == b->m_type && a->m_access == b->m_access
+        && ( a->m_data == b->m_data || 0 == ::memcmp( a->m_data, b->m_data, a->m_size ) );
+}
+
+ui64 DedupCache::hashGeometry( const Geometry *geo ) {
+    const ui64 header[ 4 ] = {
+        static_cast<ui64>( geo->m_vertextype ), static_cast<ui64>( geo->m_indextype ), 
+        static_cast<ui64>( geo->m_numPrimGroups ), reinterpret_cast<ui64>( geo->m_material )
+    };
+    ui64 hash( DerivedDataCache::hash( header, sizeof( header ) ) );
+    hash = hashBuffer( geo->m_vb, hash );
+
+    return hashBuffer( geo->m_ib, hash );
+}
+
+ui64 DedupCache::hashMaterial( const Material *mat ) {
+    ui64 hash( DerivedDataCache::hash( mat->m_name.c_str(), mat->m_name.size(), static_cast<ui64>( mat->m_type ) ) );
+    for ( ui32 i = 0; i < MaxMatColorType; ++i ) {
+        const f32 color[ 4 ] = { mat->m_color[ i ].m_r, mat->m_color[ i ].m_g, mat->m_color[ i ].m_b, mat->m_color[ i ].m_a };
+        hash = DerivedDataCache::hash( color, sizeof( color ), hash );
+    }
+    for ( ui32 i = 0; i < mat->m_numTextures; ++i ) {
+        if ( nullptr != mat->m_textures[ i ] ) {
+            const String &uri( mat->m_textures[ i ]->m_loc.getUri() );
+            hash = DerivedDataCache::hash( uri.c_str(), uri.size(), hash );
+        }
+    }
+    if ( nullptr != mat->m_shader ) {
+        for ( ui32 i = 0; i < MaxShaderTypes; ++i ) {
+            hash = DerivedDataCache::hash( mat->m_shader->m_src[ i ].c_str(), mat->m_shader->m_src[ i ].size(), hash );
+        }
+    }
+
+    return hash;
+}
+
+bool DedupCache::isEqual( const Geometry *a, const Geometry *b ) {
+    if ( a->m_vertextype != b->m_vertextype || a->m_indextype != b->m_indextype || a->m_material != b->m_material 
+            || a->m_localMatrix != b->m_localMatrix || a->m_numPrimGroups != b->m_numPrimGroups ) {
+        return false;
+    }
+
+    if ( a->m_localMatrix && 0 != ::memcmp( glm::value_ptr( a->m_model ), glm::value_ptr( b->m_model ), sizeof( glm::mat4 ) ) ) {
+        return false;
+    }
+
+    for ( ui32 i = 0; i < a->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &pa( a->m_pPrimGroups[ i ] ), &pb( b->m_pPrimGroups[ i ] );
+        if ( pa.m_primitive != pb.m_primitive || pa.m_startIndex != pb.m_startIndex || pa.m_numIndices != pb.m_numIndices 
+                || pa.m_indexType != pb.m_indexType ) {
+            return false;
+        }
+    }
+
+    return isEqualBuffer( a->m_vb, b->m_vb ) && isEqualBuffer( a->m_ib, b->m_ib );
+}
+
+static bool isEqualTexture( const Texture *a, const Texture *b ) {
+    if ( nullptr == a || nullptr == b ) {
+        return a == b;
+    }
+
+    return a->m_loc.getUri() == b->m_loc.getUri() && a->m_textureName == b->m_textureName && a->m_targetType == b->m_targetType;
+}
+
+static bool isEqualNames( const CPPCore::TArray<String> &a, const CPPCore::TArray<String> &b ) {
+    if ( a.size() != b.size() ) {
+        return false;
+    }
+    for ( ui32 i = 0; i < a.size(); ++i ) {
+        if ( a[ i ] != b[ i ] ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DedupCache::isEqual( const Material *a, const Material *b ) {
+    if ( a->m_name != b->m_name || a->m_type != b->m_type || a->m_numTextures != b->m_numTextures ) {
+        return false;
+    }
+
+    // Parameters are owned by the material, materials with parameters are only equal to themselves
+    if ( 0 != a->m_numParameters || 0 != b->m_numParameters ) {
+        return a == b;
+    }
+
+    for ( ui32 i = 0; i < MaxMatColorType; ++i ) {
+        const Color4 &ca( a->m_color[ i ] ), &cb( b->m_color[ i ] );
+        if ( ca.m_r != cb.m_r || ca.m_g != cb.m_g || ca.m_b != cb.m_b || ca.m_a != cb.m_a ) {
+            return false;
+        }
+    }
+
+    for ( ui32 i = 0; i < a->m_numTextures; ++i ) {
+        if ( !isEqualTexture( a->m_textures[ i ], b->m_textures[ i ] ) ) {
+            return false;
+        }
+    }
+
+    if ( nullptr == a->m_shader || nullptr == b->m_shader ) {
+        return a->m_shader == b->m_shader;
+    }
+    for ( ui32 i = 0; i < MaxShaderTypes; ++i ) {
+        if ( a->m_shader->m_src[ i ] != b->m_shader->m_src[ i ] ) {
+            return false;
+        }
+    }
+
+    return isEqualNames( a->m_shader->m_attributes, b->m_shader->m_attributes ) 
+        && isEqualNames( a->m_shader->m_parameters, b->m_shader->m_parameters );
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,332 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/DerivedDataCache.h>
+#include <osre/Common/Logger.h>
+#include <osre/IO/Directory.h>
+#include <osre/IO/MemoryMappedFile.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace OSRE {
+namespace Assets {
+
+static const String Tag = "DerivedDataCache";
+
+// The name of the index file in the cache directory
+static const String IndexName = "index.txt";
+
+static const ui64 HashOffset = 0xcbf29ce484222325ULL;
+static const ui64 HashPrime = 0x100000001b3ULL;
+
+const ui32 DerivedDataCache::Version;
+
+DerivedDataCache::DerivedDataCache()
+: m_directory()
+, m_sources()
+, m_dependencies()
+, m_dirty( false )
+, m_numHashedFiles( 0 )
+, m_mutex() {
+    // empty
+}
+
+DerivedDataCache::~DerivedDataCache() {
+    close();
+}
+
+bool DerivedDataCache::open( const String &directory ) {
+    close();
+    if ( directory.empty() ) {
+        osre_debug( Tag, "Cache directory is empty." );
+        return false;
+    }
+
+    if ( !IO::Directory::create( directory ) ) {
+        osre_error( Tag, "Cannot create cache directory " + directory );
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_directory = directory;
+    if ( '/' != m_directory[ m_directory.size() - 1 ] ) {
+        m_directory += '/';
+    }
+    loadIndex();
+
+    return true;
+}
+
+void DerivedDataCache::close() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if ( m_directory.empty() ) {
+        return;
+    }
+
+    if ( m_dirty ) {
+        saveIndex();
+    }
+    m_directory.clear();
+    m_sources.clear();
+    m_dependencies.clear();
+    m_dirty = false;
+}
+
+bool DerivedDataCache::computeKey( const String &source, const String &settings, ui32 formatVersion, Key &key ) {
+    ui64 sourceHash( 0 );
+    if ( !hashSource( source, sourceHash ) ) {
+        return false;
+    }
+
+    const ui64 versions[ 3 ] = { sourceHash, formatVersion, Version };
+    key = hash( versions, sizeof( versions ), hash( settings.c_str(), settings.size() ) );
+
+    return true;
+}
+
+String DerivedDataCache::getFilename( Key key, const String &extension ) const {
+    c8 name[ 17 ];
+    ::snprintf( name, sizeof( name ), "%016llx", static_cast<unsigned long long>( key ) );
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_directory + name + extension;
+}
+
+bool DerivedDataCache::contains( Key key, const String &extension ) const {
+    struct stat info;
+    return 0 == ::stat( getFilename( key, extension ).c_str(), &info );
+}
+
+String DerivedDataCache::getDerivedFilename( const String &source, const String &settings, ui32 formatVersion, 
+        const String &extension ) {
+    Key key( 0 );
+    if ( !isOpen() || !computeKey( source, settings, formatVersion, key ) ) {
+        return String();
+    }
+
+    return getFilename( key, extension );
+}
+
+// Derived files are recorded by their name, the cache directory may be opened by another path
+static String getDerivedName( const String &derivedFile ) {
+    const String::size_type pos( derivedFile.rfind( '/' ) );
+    return String::npos == pos ? derivedFile : derivedFile.substr( pos + 1 );
+}
+
+bool DerivedDataCache::setDependencies( const String &derivedFile, const std::set<String> &dependencies ) {
+    std::map<String, ui64> hashes;
+    for ( const String &dependency : dependencies ) {
+        ui64 dependencyHash( 0 );
+        if ( !hashSource( dependency, dependencyHash ) ) {
+            return false;
+        }
+        hashes[ dependency ] = dependencyHash;
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::map<String, ui64> &recorded( m_dependencies[ getDerivedName( derivedFile ) ] );
+    if ( recorded != hashes ) {
+        recorded.swap( hashes );
+        m_dirty = true;
+    }
+
+    return true;
+}
+
+bool DerivedDataCache::checkDependencies( const String &derivedFile ) {
+    std::map<String, ui64> recorded;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        std::map<String, std::map<String, ui64>>::const_iterator it( m_dependencies.find( getDerivedName( derivedFile ) ) );
+        if ( m_dependencies.end() == it ) {
+            return true;
+        }
+        recorded = it->second;
+    }
+
+    // Unchanged dependencies are not hashed again, like the sources
+    for ( std::map<String, ui64>::const_iterator it = recorded.begin(); it != recorded.end(); ++it ) {
+        ui64 dependencyHash( 0 );
+        if ( !hashSource( it->first, dependencyHash ) || dependencyHash != it->second ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ui64 DerivedDataCache::hash( const void *data, size_t size, ui64 seed ) {
+    // FNV-1a over 64 bit words, finished with the avalanche step of MurmurHash3
+    const uc8 *bytes( static_cast<const uc8*>( data ) );
+    ui64 h( ( HashOffset ^ seed ) * HashPrime );
+    size_t i( 0 );
+    for ( ; i + 8 <= size; i += 8 ) {
+        ui64 word;
+        ::memcpy( &word, bytes + i, sizeof( word ) );
+        h = ( h ^ word ) * HashPrime;
+        h ^= h >> 29;
+    }
+    for ( ; i < size; ++i ) {
+        h = ( h ^ bytes[ i ] ) * HashPrime;
+    }
+    h ^= static_cast<ui64>( size );
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+bool DerivedDataCache::hashSource( const String &source, ui64 &hashValue ) {
+    struct stat info;
+    if ( 0 != ::stat( source.c_str(), &info ) ) {
+        return false;
+    }
+    const ui64 size( static_cast<ui64>( info.st_size ) ), time( static_cast<ui64>( info.st_mtime ) );
+
+    // Unchanged sources are not hashed again
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        std::map<String, SourceInfo>::const_iterator it( m_sources.find( source ) );
+        if ( m_sources.end() != it && size == it->second.m_size && time == it->second.m_time ) {
+            hashValue = it->second.m_hash;
+            return true;
+        }
+    }
+
+    if ( 0 == size ) {
+        hashValue = hash( nullptr, 0 );
+    } else {
+        IO::MemoryMappedFile file;
+        if ( !file.open( source ) ) {
+            osre_debug( Tag, "Cannot read " + source );
+            return false;
+        }
+        hashValue = hash( file.getData(), static_cast<size_t>( file.getSize() ) );
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    SourceInfo &sourceInfo( m_sources[ source ] );
+    sourceInfo.m_size = size;
+    sourceInfo.m_time = time;
+    sourceInfo.m_hash = hashValue;
+    m_dirty = true;
+    ++m_numHashedFiles;
+
+    return true;
+}
+
+void DerivedDataCache::loadIndex() {
+    FILE *file( ::fopen( ( m_directory + IndexName ).c_str(), "rb" ) );
+    if ( nullptr == file ) {
+        return;
+    }
+
+    // Each line contains the hash, the size, the time and the source name. Dependency lines start with 
+    // "d " followed by the hash, the derived file and the dependency separated by a tab.
+    c8 line[ 4096 ];
+    while ( nullptr != ::fgets( line, sizeof( line ), file ) ) {
+        c8 *end( nullptr );
+        if ( 'd' == line[ 0 ] && ' ' == line[ 1 ] ) {
+            const ui64 dependencyHash( ::strtoull( line + 2, &end, 16 ) );
+            if ( ' ' != *end ) {
+                continue;
+            }
+            String names( end + 1 );
+            while ( !names.empty() && ( '\n' == names[ names.size() - 1 ] || '\r' == names[ names.size() - 1 ] ) ) {
+                names.erase( names.size() - 1 );
+            }
+            const String::size_type tab( names.find( '\t' ) );
+            if ( String::npos != tab && 0 != tab && names.size() != tab + 1 ) {
+                m_dependencies[ names.substr( 0, tab ) ][ names.substr( tab + 1 ) ] = dependencyHash;
+            }
+            continue;
+        }
+
+        SourceInfo info;
+        info.m_hash = ::strtoull( line, &end, 16 );
+        info.m_size = ::strtoull( end, &end, 10 );
+        info.m_time = ::strtoull( end, &end, 10 );
+        if ( ' ' != *end ) {
+            continue;
+        }
+        String source( end + 1 );
+        while ( !source.empty() && ( '\n' == source[ source.size() - 1 ] || '\r' == source[ source.size() - 1 ] ) ) {
+            source.erase( source.size() - 1 );
+        }
+        if ( !source.empty() ) {
+            m_sources[ source ] = info;
+        }
+    }
+    ::fclose( file );
+}
+
+void DerivedDataCache::saveIndex() {
+    // Write a temporary file first, so an interrupted write does not damage the index
+    const String indexName( m_directory + IndexName ), tempName( indexName + ".tmp" );
+    FILE *file( ::fopen( tempName.c_str(), "wb" ) );
+    if ( nullptr == file ) {
+        osre_error( Tag, "Cannot write cache index " + indexName );
+        return;
+    }
+
+    bool ok( true );
+    for ( std::map<String, SourceInfo>::const_iterator it = m_sources.begin(); it != m_sources.end(); ++it ) {
+        ok = ok && 0 < ::fprintf( file, "%016llx %llu %llu %s\n", static_cast<unsigned long long>( it->second.m_hash ),
+                static_cast<unsigned long long>( it->second.m_size ), static_cast<unsigned long long>( it->second.m_time ),
+                it->first.c_str() );
+    }
+    for ( std::map<String, std::map<String, ui64>>::const_iterator it = m_dependencies.begin(); it != m_dependencies.end(); ++it ) {
+        for ( std::map<String, ui64>::const_iterator dep = it->second.begin(); dep != it->second.end(); ++dep ) {
+            ok = ok && 0 < ::fprintf( file, "d %016llx %s\t%s\n", static_cast<unsigned long long>( dep->second ), 
+                    it->first.c_str(), dep->first.c_str() );
+        }
+    }
+    ok = 0 == ::fclose( file ) && ok;
+    if ( !ok ) {
+        osre_error( Tag, "Cannot write cache index " + indexName );
+        ::remove( tempName.c_str() );
+        return;
+    }
+
+#ifdef OSRE_WINDOWS
+    // rename does not replace an existing file on Windows.
+    ::remove( indexName.c_str() );
+#endif
+    if ( 0 != ::rename( tempName.c_str(), indexName.c_str() ) ) {
+        osre_error( Tag, "Cannot replace cache index " + indexName );
+        ::remove( tempName.c_str() );
+        return;
+    }
+    m_dirty = false;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
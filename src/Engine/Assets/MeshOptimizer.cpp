@@ -0,0 +1,433 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/MeshOptimizer.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Logger.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "MeshOptimizer";
+
+// Clusters will not be split into parts with less triangles, every split costs a cold cache
+static const ui32 MinClusterSize = 128;
+
+static const ui32 InvalidVertex = 0xFFFFFFFF;
+
+MeshOptimizer::Statistics::Statistics()
+: m_acmrBefore( 0.0f )
+, m_acmrAfter( 0.0f )
+, m_numTriangles( 0 )
+, m_numClusters( 0 ) {
+    // empty
+}
+
+MeshOptimizer::MeshOptimizer() {
+    // empty
+}
+
+MeshOptimizer::~MeshOptimizer() {
+    // empty
+}
+
+// A FIFO cache, a vertex is cached while less than cacheSize misses happened after its own miss
+class FifoCache {
+public:
+    FifoCache( ui32 numVertices, ui32 cacheSize )
+    : m_stamps( numVertices, 0 )
+    , m_time( cacheSize + 1 )
+    , m_cacheSize( cacheSize ) {
+        // empty
+    }
+
+    bool access( ui32 v ) {
+        if ( m_time - m_stamps[ v ] > m_cacheSize ) {
+            m_stamps[ v ] = m_time++;
+            return false;
+        }
+        return true;
+    }
+
+    void flush() {
+        m_time += m_cacheSize + 1;
+    }
+
+private:
+    std::vector<ui32> m_stamps;
+    ui32 m_time;
+    ui32 m_cacheSize;
+};
+
+static bool validIndices( const ui32 *indices, ui32 numIndices, ui32 numVertices ) {
+    for ( ui32 i = 0; i < numIndices; ++i ) {
+        if ( indices[ i ] >= numVertices ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+f32 MeshOptimizer::computeACMR( const ui32 *indices, ui32 numIndices, ui32 numVertices, ui32 cacheSize ) {
+    const ui32 numTriangles( numIndices / 3 );
+    if ( nullptr == indices || 0 == numTriangles || !validIndices( indices, numTriangles * 3, numVertices ) ) {
+        return 0.0f;
+    }
+
+    FifoCache cache( numVertices, cacheSize );
+    ui32 misses( 0 );
+    for ( ui32 i = 0; i < numTriangles * 3; ++i ) {
+        if ( !cache.access( indices[ i ] ) ) {
+            ++misses;
+        }
+    }
+
+    return static_cast<f32>( misses ) / static_cast<f32>( numTriangles );
+}
+
+// Returns the next vertex with live triangles from the dead-end stack or in input order
+static i32 skipDeadEnd( const std::vector<ui32> &live, std::vector<ui32> &deadEnd, ui32 &cursor, bool &hardBoundary ) {
+    while ( !deadEnd.empty() ) {
+        const ui32 v( deadEnd.back() );
+        deadEnd.pop_back();
+        if ( live[ v ] > 0 ) {
+            return static_cast<i32>( v );
+        }
+    }
+
+    hardBoundary = true;
+    while ( cursor < live.size() ) {
+        const ui32 v( cursor++ );
+        if ( live[ v ] > 0 ) {
+            return static_cast<i32>( v );
+        }
+    }
+
+    return -1;
+}
+
+void MeshOptimizer::optimizeVertexCache( ui32 *indices, ui32 numIndices, ui32 numVertices, ui32 cacheSize, 
+        CPPCore::TArray<ui32> *clusters ) {
+    if ( nullptr != clusters ) {
+        clusters->resize( 0 );
+    }
+
+    const ui32 numTriangles( numIndices / 3 );
+    if ( nullptr == indices || 0 == numTriangles || !validIndices( indices, numTriangles * 3, numVertices ) ) {
+        return;
+    }
+
+    // The vertex to triangle adjacency and the number of not emitted triangles per vertex
+    std::vector<ui32> live( numVertices, 0 ), offsets( numVertices + 1, 0 );
+    for ( ui32 i = 0; i < numTriangles * 3; ++i ) {
+        ++live[ indices[ i ] ];
+    }
+    for ( ui32 v = 0; v < numVertices; ++v ) {
+        offsets[ v + 1 ] = offsets[ v ] + live[ v ];
+    }
+    std::vector<ui32> adjacency( numTriangles * 3 ), fill( offsets.begin(), offsets.end() - 1 );
+    for ( ui32 i = 0; i < numTriangles * 3; ++i ) {
+        adjacency[ fill[ indices[ i ] ]++ ] = i / 3;
+    }
+
+    std::vector<ui32> timeStamps( numVertices, 0 ), deadEnd, candidates, output;
+    std::vector<bool> emitted( numTriangles, false );
+    output.reserve( numTriangles * 3 );
+    i32 time( static_cast<i32>( cacheSize ) + 1 );
+    ui32 cursor( 0 );
+    bool hardBoundary( false );
+    i32 fanning( skipDeadEnd( live, deadEnd, cursor, hardBoundary ) );
+    while ( fanning >= 0 ) {
+        if ( hardBoundary && nullptr != clusters ) {
+            clusters->add( static_cast<ui32>( output.size() / 3 ) );
+        }
+        hardBoundary = false;
+
+        // Emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for ( ui32 j = offsets[ fanning ]; j < offsets[ fanning + 1 ]; ++j ) {
+            const ui32 t( adjacency[ j ] );
+            if ( emitted[ t ] ) {
+                continue;
+            }
+            for ( ui32 k = 0; k < 3; ++k ) {
+                const ui32 v( indices[ t * 3 + k ] );
+                output.push_back( v );
+                deadEnd.push_back( v );
+                candidates.push_back( v );
+                --live[ v ];
+                if ( time - static_cast<i32>( timeStamps[ v ] ) > static_cast<i32>( cacheSize ) ) {
+                    timeStamps[ v ] = static_cast<ui32>( time++ );
+                }
+            }
+            emitted[ t ] = true;
+        }
+
+        // Prefer the oldest candidate which will still be in the cache after its fan was emitted
+        i32 next( -1 ), bestPriority( -1 );
+        for ( ui32 v : candidates ) {
+            if ( 0 == live[ v ] ) {
+                continue;
+            }
+            i32 priority( 0 );
+            const i32 age( time - static_cast<i32>( timeStamps[ v ] ) );
+            if ( age + 2 * static_cast<i32>( live[ v ] ) <= static_cast<i32>( cacheSize ) ) {
+                priority = age;
+            }
+            if ( priority > bestPriority ) {
+                bestPriority = priority;
+                next = static_cast<i32>( v );
+            }
+        }
+        if ( -1 == next ) {
+            next = skipDeadEnd( live, deadEnd, cursor, hardBoundary );
+        }
+        fanning = next;
+    }
+
+    ::memcpy( indices, &output[ 0 ], sizeof( ui32 ) * output.size() );
+}
+
+static glm::vec3 readPosition( const uc8 *positions, ui32 stride, ui32 v ) {
+    glm::vec3 pos;
+    ::memcpy( &pos.x, &positions[ v * stride ], sizeof( glm::vec3 ) );
+
+    return pos;
+}
+
+ui32 MeshOptimizer::optimizeOverdraw( ui32 *indices, ui32 numIndices, const uc8 *positions, ui32 stride, 
+        ui32 numVertices, const CPPCore::TArray<ui32> &clusters, ui32 cacheSize, f32 threshold ) {
+    const ui32 numTriangles( numIndices / 3 );
+    if ( nullptr == indices || nullptr == positions || 0 == numTriangles 
+            || !validIndices( indices, numTriangles * 3, numVertices ) ) {
+        return 0;
+    }
+
+    // Split long clusters where the cache behaves better than on average
+    const f32 acmr( computeACMR( indices, numTriangles * 3, numVertices, cacheSize ) );
+    std::vector<ui32> starts;
+    FifoCache cache( numVertices, cacheSize );
+    ui32 nextHard( 0 ), misses( 0 ), clusterSize( 0 );
+    for ( ui32 t = 0; t < numTriangles; ++t ) {
+        bool split( 0 == t );
+        if ( nextHard < clusters.size() && clusters[ nextHard ] == t ) {
+            split = true;
+            ++nextHard;
+        } else if ( clusterSize >= MinClusterSize 
+                && static_cast<f32>( misses ) <= threshold * acmr * static_cast<f32>( clusterSize ) ) {
+            split = true;
+        }
+        if ( split ) {
+            if ( starts.empty() || starts.back() != t ) {
+                starts.push_back( t );
+            }
+            cache.flush();
+            misses = 0;
+            clusterSize = 0;
+        }
+        for ( ui32 k = 0; k < 3; ++k ) {
+            if ( !cache.access( indices[ t * 3 + k ] ) ) {
+                ++misses;
+            }
+        }
+        ++clusterSize;
+    }
+    const ui32 numClusters( static_cast<ui32>( starts.size() ) );
+    starts.push_back( numTriangles );
+
+    // The area weighted centroids and normals of the mesh and of the clusters
+    std::vector<glm::vec3> centroids( numClusters ), normals( numClusters );
+    glm::vec3 meshCentroid( 0.0f ), meshSum( 0.0f );
+    f32 meshArea( 0.0f );
+    for ( ui32 c = 0; c < numClusters; ++c ) {
+        glm::vec3 centroid( 0.0f ), normal( 0.0f );
+        f32 area( 0.0f );
+        for ( ui32 t = starts[ c ]; t < starts[ c + 1 ]; ++t ) {
+            const glm::vec3 p0( readPosition( positions, stride, indices[ t * 3 ] ) );
+            const glm::vec3 p1( readPosition( positions, stride, indices[ t * 3 + 1 ] ) );
+            const glm::vec3 p2( readPosition( positions, stride, indices[ t * 3 + 2 ] ) );
+            const glm::vec3 n( glm::cross( p1 - p0, p2 - p0 ) );
+            const f32 triArea( glm::length( n ) );
+            const glm::vec3 triCentroid( ( p0 + p1 + p2 ) / 3.0f );
+            centroid += triCentroid * triArea;
+            normal += n;
+            area += triArea;
+            meshSum += triCentroid;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids[ c ] = area > 0.0f ? centroid / area : centroid;
+        normals[ c ] = glm::length( normal ) > 0.0f ? glm::normalize( normal ) : normal;
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshSum / static_cast<f32>( numTriangles );
+
+    // Clusters facing away from the center occlude the others, so they are drawn first
+    std::vector<f32> keys( numClusters );
+    std::vector<ui32> order( numClusters );
+    for ( ui32 c = 0; c < numClusters; ++c ) {
+        keys[ c ] = glm::dot( centroids[ c ] - meshCentroid, normals[ c ] );
+        order[ c ] = c;
+    }
+    std::stable_sort( order.begin(), order.end(), [ &keys ]( ui32 a, ui32 b ) {
+        return keys[ a ] > keys[ b ];
+    } );
+
+    std::vector<ui32> output;
+    output.reserve( numTriangles * 3 );
+    for ( ui32 c : order ) {
+        output.insert( output.end(), &indices[ starts[ c ] * 3 ], &indices[ starts[ c + 1 ] * 3 ] );
+    }
+    ::memcpy( indices, &output[ 0 ], sizeof( ui32 ) * output.size() );
+
+    return numClusters;
+}
+
+ui32 MeshOptimizer::optimizeVertexFetch( uc8 *vertices, ui32 numVertices, ui32 vertexSize, ui32 *indices, 
+        ui32 numIndices ) {
+    if ( nullptr == vertices || nullptr == indices || !validIndices( indices, numIndices, numVertices ) ) {
+        return 0;
+    }
+
+    std::vector<ui32> remap( numVertices, InvalidVertex );
+    ui32 numUsed( 0 );
+    for ( ui32 i = 0; i < numIndices; ++i ) {
+        ui32 &target( remap[ indices[ i ] ] );
+        if ( InvalidVertex == target ) {
+            target = numUsed++;
+        }
+        indices[ i ] = target;
+    }
+
+    ui32 next( numUsed );
+    const std::vector<uc8> source( vertices, vertices + numVertices * vertexSize );
+    for ( ui32 v = 0; v < numVertices; ++v ) {
+        const ui32 target( InvalidVertex == remap[ v ] ? next++ : remap[ v ] );
+        ::memcpy( &vertices[ target * vertexSize ], &source[ v * vertexSize ], vertexSize );
+    }
+
+    return numUsed;
+}
+
+static bool readIndices( const Geometry *geo, const PrimitiveGroup &grp, std::vector<ui32> &indices ) {
+    const ui32 numIndices( grp.m_numIndices - grp.m_numIndices % 3 );
+    indices.resize( numIndices );
+    for ( ui32 i = 0; i < numIndices; ++i ) {
+        const ui32 idx( grp.m_startIndex + i );
+        switch ( grp.m_indexType ) {
+            case IndexType::UnsignedByte:
+                indices[ i ] = static_cast<const uc8*>( geo->m_ib->m_data )[ idx ];
+                break;
+            case IndexType::UnsignedShort:
+                indices[ i ] = static_cast<const ui16*>( geo->m_ib->m_data )[ idx ];
+                break;
+            case IndexType::UnsignedInt:
+                indices[ i ] = static_cast<const ui32*>( geo->m_ib->m_data )[ idx ];
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool MeshOptimizer::optimize( Geometry *geo, Statistics *stats, ui32 cacheSize ) {
+    if ( nullptr == geo || nullptr == geo->m_vb || nullptr == geo->m_ib || 1 != geo->m_numPrimGroups ) {
+        osre_debug( Tag, "Invalid geometry to optimize." );
+        return false;
+    }
+
+    const PrimitiveGroup &grp( geo->m_pPrimGroups[ 0 ] );
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    if ( PrimitiveType::TriangleList != grp.m_primitive || 0 == vertexSize ) {
+        osre_debug( Tag, "Only triangle lists can be optimized." );
+        return false;
+    }
+
+    std::vector<ui32> indices;
+    const ui32 numVertices( geo->m_vb->m_size / vertexSize );
+    if ( !readIndices( geo, grp, indices ) || indices.empty() || !validIndices( &indices[ 0 ], indices.size(), numVertices ) ) {
+        osre_debug( Tag, "Invalid indices." );
+        return false;
+    }
+
+    const ui32 numIndices( static_cast<ui32>( indices.size() ) );
+    Statistics result;
+    result.m_numTriangles = numIndices / 3;
+    result.m_acmrBefore = computeACMR( &indices[ 0 ], numIndices, numVertices, cacheSize );
+
+    CPPCore::TArray<ui32> clusters;
+    optimizeVertexCache( &indices[ 0 ], numIndices, numVertices, cacheSize, &clusters );
+
+    // Only layouts with float positions at the start of the vertex can be sorted for overdraw
+    uc8 *vertices( static_cast<uc8*>( geo->m_vb->m_data ) );
+    if ( VertexType::RenderVertex == geo->m_vertextype || VertexType::ColorVertex == geo->m_vertextype 
+            || VertexType::CompactRenderVertex == geo->m_vertextype ) {
+        result.m_numClusters = optimizeOverdraw( &indices[ 0 ], numIndices, vertices, vertexSize, numVertices, 
+                clusters, cacheSize );
+    }
+
+    const ui32 numUsed( optimizeVertexFetch( vertices, numVertices, vertexSize, &indices[ 0 ], numIndices ) );
+    if ( numUsed < numVertices ) {
+        BufferData *vb( BufferData::alloc( geo->m_vb->m_type, numUsed * vertexSize, geo->m_vb->m_access ) );
+        ::memcpy( vb->m_data, vertices, numUsed * vertexSize );
+        BufferData::free( geo->m_vb );
+        geo->m_vb = vb;
+    }
+    result.m_acmrAfter = computeACMR( &indices[ 0 ], numIndices, numUsed, cacheSize );
+
+    // 16-bit indices are enough to address less than 65536 vertices
+    const IndexType indexType( numUsed < 65536 ? IndexType::UnsignedShort : IndexType::UnsignedInt );
+    const ui32 indexSize( IndexType::UnsignedShort == indexType ? sizeof( ui16 ) : sizeof( ui32 ) );
+    BufferData *ib( BufferData::alloc( geo->m_ib->m_type, numIndices * indexSize, geo->m_ib->m_access ) );
+    if ( IndexType::UnsignedShort == indexType ) {
+        ui16 *dst( static_cast<ui16*>( ib->m_data ) );
+        for ( ui32 i = 0; i < numIndices; ++i ) {
+            dst[ i ] = static_cast<ui16>( indices[ i ] );
+        }
+    } else {
+        ::memcpy( ib->m_data, &indices[ 0 ], sizeof( ui32 ) * numIndices );
+    }
+    BufferData::free( geo->m_ib );
+    geo->m_ib = ib;
+    geo->m_indextype = indexType;
+    geo->m_pPrimGroups[ 0 ].init( indexType, numIndices, PrimitiveType::TriangleList, 0 );
+
+    if ( nullptr != stats ) {
+        *stats = result;
+    }
+
+    return true;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
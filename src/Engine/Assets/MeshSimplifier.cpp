@@ -0,0 +1,352 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/MeshSimplifier.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Logger.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <string.h>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "MeshSimplifier";
+
+namespace {
+
+// Symmetric 4x4 error quadric, only the upper triangle is stored
+struct Quadric {
+    d32 m[ 10 ];
+
+    Quadric() {
+        ::memset( m, 0, sizeof( m ) );
+    }
+
+    Quadric( d32 a, d32 b, d32 c, d32 d ) {
+        m[ 0 ] = a * a; m[ 1 ] = a * b; m[ 2 ] = a * c; m[ 3 ] = a * d;
+        m[ 4 ] = b * b; m[ 5 ] = b * c; m[ 6 ] = b * d;
+        m[ 7 ] = c * c; m[ 8 ] = c * d;
+        m[ 9 ] = d * d;
+    }
+
+    Quadric &operator += ( const Quadric &rhs ) {
+        for ( ui32 i = 0; i < 10; ++i ) {
+            m[ i ] += rhs.m[ i ];
+        }
+        return *this;
+    }
+
+    d32 error( const glm::vec3 &v ) const {
+        const d32 x( v.x ), y( v.y ), z( v.z );
+        return m[ 0 ] * x * x + 2 * m[ 1 ] * x * y + 2 * m[ 2 ] * x * z + 2 * m[ 3 ] * x
+             + m[ 4 ] * y * y + 2 * m[ 5 ] * y * z + 2 * m[ 6 ] * y
+             + m[ 7 ] * z * z + 2 * m[ 8 ] * z
+             + m[ 9 ];
+    }
+};
+
+struct Collapse {
+    d32  m_cost;
+    ui32 m_keep;
+    ui32 m_remove;
+    ui32 m_stampKeep;
+    ui32 m_stampRemove;
+
+    bool operator < ( const Collapse &rhs ) const {
+        // Smallest costs first
+        return m_cost > rhs.m_cost;
+    }
+};
+
+}
+
+MeshSimplifier::MeshSimplifier() {
+    // empty
+}
+
+MeshSimplifier::~MeshSimplifier() {
+    // empty
+}
+
+static bool readTriangles( const Geometry *geo, std::vector<ui32> &indices ) {
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        if ( PrimitiveType::TriangleList != grp.m_primitive ) {
+            return false;
+        }
+        for ( ui32 j = 0; j < grp.m_numIndices; ++j ) {
+            const ui32 idx( grp.m_startIndex + j );
+            switch ( grp.m_indexType ) {
+                case IndexType::UnsignedByte:
+                    indices.push_back( static_cast<const uc8*>( geo->m_ib->m_data )[ idx ] );
+                    break;
+                case IndexType::UnsignedShort:
+                    indices.push_back( static_cast<const ui16*>( geo->m_ib->m_data )[ idx ] );
+                    break;
+                case IndexType::UnsignedInt:
+                    indices.push_back( static_cast<const ui32*>( geo->m_ib->m_data )[ idx ] );
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    return 0 == indices.size() % 3;
+}
+
+static ui32 findVertex( std::vector<ui32> &remap, ui32 v ) {
+    while ( remap[ v ] != v ) {
+        remap[ v ] = remap[ remap[ v ] ];
+        v = remap[ v ];
+    }
+
+    return v;
+}
+
+static glm::vec3 faceNormal( const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2 ) {
+    return glm::cross( p1 - p0, p2 - p0 );
+}
+
+ui32 MeshSimplifier::getNumTriangles( const Geometry *geo ) {
+    if ( nullptr == geo ) {
+        return 0;
+    }
+
+    ui32 numIndices( 0 );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        if ( PrimitiveType::TriangleList == geo->m_pPrimGroups[ i ].m_primitive ) {
+            numIndices += geo->m_pPrimGroups[ i ].m_numIndices;
+        }
+    }
+
+    return numIndices / 3;
+}
+
+Geometry *MeshSimplifier::simplify( const Geometry *geo, f32 ratio ) {
+    if ( nullptr == geo || nullptr == geo->m_vb || nullptr == geo->m_ib ) {
+        osre_debug( Tag, "Invalid geometry to simplify." );
+        return nullptr;
+    }
+
+    // Only layouts with float positions at the start of the vertex
+    if ( VertexType::RenderVertex != geo->m_vertextype && VertexType::ColorVertex != geo->m_vertextype 
+            && VertexType::CompactRenderVertex != geo->m_vertextype ) {
+        osre_debug( Tag, "Vertex type not supported." );
+        return nullptr;
+    }
+
+    std::vector<ui32> indices;
+    if ( !readTriangles( geo, indices ) || indices.empty() ) {
+        osre_debug( Tag, "Only triangle lists can be simplified." );
+        return nullptr;
+    }
+
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    const ui32 numVertices( geo->m_vb->m_size / vertexSize );
+    const uc8 *srcVertices( static_cast<const uc8*>( geo->m_vb->m_data ) );
+    std::vector<glm::vec3> positions( numVertices );
+    for ( ui32 i = 0; i < numVertices; ++i ) {
+        ::memcpy( &positions[ i ].x, &srcVertices[ i * vertexSize ], sizeof( glm::vec3 ) );
+    }
+
+    const ui32 numTriangles( static_cast<ui32>( indices.size() / 3 ) );
+    const ui32 targetTriangles( static_cast<ui32>( numTriangles * glm::clamp( ratio, 0.0f, 1.0f ) ) );
+
+    // Accumulate the plane quadrics and the triangle adjacency per vertex
+    std::vector<Quadric> quadrics( numVertices );
+    std::vector<std::vector<ui32>> vertexTris( numVertices );
+    for ( ui32 t = 0; t < numTriangles; ++t ) {
+        const ui32 *tri( &indices[ t * 3 ] );
+        if ( tri[ 0 ] >= numVertices || tri[ 1 ] >= numVertices || tri[ 2 ] >= numVertices ) {
+            osre_debug( Tag, "Index out of range." );
+            return nullptr;
+        }
+        glm::vec3 n( faceNormal( positions[ tri[ 0 ] ], positions[ tri[ 1 ] ], positions[ tri[ 2 ] ] ) );
+        const f32 len( glm::length( n ) );
+        if ( len > 0.0f ) {
+            n /= len;
+        }
+        const Quadric q( n.x, n.y, n.z, -glm::dot( n, positions[ tri[ 0 ] ] ) );
+        for ( ui32 k = 0; k < 3; ++k ) {
+            quadrics[ tri[ k ] ] += q;
+            vertexTris[ tri[ k ] ].push_back( t );
+        }
+    }
+
+    std::vector<ui32> remap( numVertices ), stamps( numVertices, 0 );
+    for ( ui32 i = 0; i < numVertices; ++i ) {
+        remap[ i ] = i;
+    }
+    std::vector<bool> removedTris( numTriangles, false );
+
+    std::priority_queue<Collapse> heap;
+    auto pushEdge = [ & ]( ui32 a, ui32 b ) {
+        Quadric q( quadrics[ a ] );
+        q += quadrics[ b ];
+        const d32 errA( q.error( positions[ a ] ) ), errB( q.error( positions[ b ] ) );
+        Collapse c;
+        c.m_cost = std::min( errA, errB );
+        c.m_keep = errA <= errB ? a : b;
+        c.m_remove = errA <= errB ? b : a;
+        c.m_stampKeep = stamps[ c.m_keep ];
+        c.m_stampRemove = stamps[ c.m_remove ];
+        heap.push( c );
+    };
+
+    for ( ui32 t = 0; t < numTriangles; ++t ) {
+        const ui32 *tri( &indices[ t * 3 ] );
+        for ( ui32 k = 0; k < 3; ++k ) {
+            // Shared edges are pushed twice, outdated entries are skipped when popped
+            pushEdge( tri[ k ], tri[ ( k + 1 ) % 3 ] );
+        }
+    }
+
+    ui32 liveTriangles( numTriangles );
+    while ( liveTriangles > targetTriangles && !heap.empty() ) {
+        const Collapse c( heap.top() );
+        heap.pop();
+        const ui32 keep( c.m_keep ), remove( c.m_remove );
+        if ( findVertex( remap, keep ) != keep || findVertex( remap, remove ) != remove ) {
+            continue;
+        }
+        if ( stamps[ keep ] != c.m_stampKeep || stamps[ remove ] != c.m_stampRemove ) {
+            continue;
+        }
+
+        // Reject collapses which would flip a remaining triangle
+        bool flips( false );
+        for ( ui32 t : vertexTris[ remove ] ) {
+            if ( removedTris[ t ] ) {
+                continue;
+            }
+            ui32 tri[ 3 ];
+            bool degenerated( false );
+            for ( ui32 k = 0; k < 3; ++k ) {
+                tri[ k ] = findVertex( remap, indices[ t * 3 + k ] );
+                degenerated |= ( keep == tri[ k ] );
+            }
+            if ( degenerated ) {
+                continue;
+            }
+            const glm::vec3 before( faceNormal( positions[ tri[ 0 ] ], positions[ tri[ 1 ] ], positions[ tri[ 2 ] ] ) );
+            for ( ui32 k = 0; k < 3; ++k ) {
+                if ( remove == tri[ k ] ) {
+                    tri[ k ] = keep;
+                }
+            }
+            const glm::vec3 after( faceNormal( positions[ tri[ 0 ] ], positions[ tri[ 1 ] ], positions[ tri[ 2 ] ] ) );
+            if ( glm::dot( before, after ) <= 0.0f ) {
+                flips = true;
+                break;
+            }
+        }
+        if ( flips ) {
+            continue;
+        }
+
+        // Collapse the edge
+        remap[ remove ] = keep;
+        quadrics[ keep ] += quadrics[ remove ];
+        ++stamps[ keep ];
+        for ( ui32 t : vertexTris[ remove ] ) {
+            if ( removedTris[ t ] ) {
+                continue;
+            }
+            const ui32 a( findVertex( remap, indices[ t * 3 ] ) );
+            const ui32 b( findVertex( remap, indices[ t * 3 + 1 ] ) );
+            const ui32 d( findVertex( remap, indices[ t * 3 + 2 ] ) );
+            if ( a == b || b == d || a == d ) {
+                removedTris[ t ] = true;
+                --liveTriangles;
+            } else {
+                vertexTris[ keep ].push_back( t );
+            }
+        }
+        vertexTris[ remove ].clear();
+
+        // Re-evaluate the edges around the kept vertex
+        for ( ui32 t : vertexTris[ keep ] ) {
+            if ( removedTris[ t ] ) {
+                continue;
+            }
+            for ( ui32 k = 0; k < 3; ++k ) {
+                const ui32 other( findVertex( remap, indices[ t * 3 + k ] ) );
+                if ( other != keep ) {
+                    pushEdge( keep, other );
+                }
+            }
+        }
+    }
+
+    // Compact the remaining vertices and triangles
+    std::vector<ui32> newIndex( numVertices, UINT32_MAX );
+    std::vector<ui32> outIndices;
+    outIndices.reserve( liveTriangles * 3 );
+    ui32 numOutVertices( 0 );
+    for ( ui32 t = 0; t < numTriangles; ++t ) {
+        if ( removedTris[ t ] ) {
+            continue;
+        }
+        for ( ui32 k = 0; k < 3; ++k ) {
+            const ui32 v( findVertex( remap, indices[ t * 3 + k ] ) );
+            if ( UINT32_MAX == newIndex[ v ] ) {
+                newIndex[ v ] = numOutVertices++;
+            }
+            outIndices.push_back( newIndex[ v ] );
+        }
+    }
+
+    Geometry *newGeo( Geometry::create( 1 ) );
+    newGeo->m_vertextype = geo->m_vertextype;
+    newGeo->m_indextype = IndexType::UnsignedInt;
+    newGeo->m_material = geo->m_material;
+    newGeo->m_localMatrix = geo->m_localMatrix;
+    newGeo->m_model = geo->m_model;
+    newGeo->m_vb = BufferData::alloc( BufferType::VertexBuffer, numOutVertices * vertexSize, geo->m_vb->m_access );
+    newGeo->m_ib = BufferData::alloc( BufferType::IndexBuffer, static_cast<ui32>( outIndices.size() * sizeof( ui32 ) ), geo->m_ib->m_access );
+    uc8 *dstVertices( static_cast<uc8*>( newGeo->m_vb->m_data ) );
+    for ( ui32 i = 0; i < numVertices; ++i ) {
+        if ( UINT32_MAX != newIndex[ i ] ) {
+            ::memcpy( &dstVertices[ newIndex[ i ] * vertexSize ], &srcVertices[ i * vertexSize ], vertexSize );
+        }
+    }
+    if ( !outIndices.empty() ) {
+        newGeo->m_ib->copyFrom( &outIndices[ 0 ], newGeo->m_ib->m_size );
+    }
+    newGeo->m_numPrimGroups = 1;
+    newGeo->m_pPrimGroups = new PrimitiveGroup[ newGeo->m_numPrimGroups ];
+    newGeo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, static_cast<ui32>( outIndices.size() ), PrimitiveType::TriangleList, 0 );
+
+    return newGeo;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
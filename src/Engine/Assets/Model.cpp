@@ -21,6 +21,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include <osre/Assets/Model.h>
+#include <osre/Assets/CookedModel.h>
 #include <osre/RenderBackend/RenderCommon.h>
 #include <osre/Scene/Node.h>
 
@@ -31,6 +32,7 @@ using namespace ::OSRE::Collision;
 
 Model::Model() 
 : m_geoArray()
+, m_cookedModel( nullptr )
 , m_root( nullptr )
 , m_aabb() {
     // empty
@@ -38,13 +40,15 @@ Model::Model()
 
 Model::Model( GeoArray *geoArray, Scene::Node *root, ModelAABB &aabb )
 : m_geoArray( *geoArray )
+, m_cookedModel( nullptr )
 , m_root( root )
 , m_aabb( aabb ) {
     // empty
 }
 
 Model::~Model() {
-    // empty
+    delete m_cookedModel;
+    m_cookedModel = nullptr;
 }
 
 void Model::setGeoArray( GeoArray &geoArray ) {
@@ -77,5 +81,18 @@ const TAABB<f32> &Model::getAABB() const {
     return m_aabb;
 }
 
+void Model::setCookedModel( CookedModel *cookedModel ) {
+    if ( cookedModel == m_cookedModel ) {
+        return;
+    }
+
+    delete m_cookedModel;
+    m_cookedModel = cookedModel;
+}
+
+CookedModel *Model::getCookedModel() const {
+    return m_cookedModel;
+}
+
 } // Namespace Assets
 } // Namespace OSRE
@@ -0,0 +1,129 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/ModelStreamHandler.h>
+#include <osre/Assets/AssimpWrapper.h>
+#include <osre/Assets/Model.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Logger.h>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+using namespace ::OSRE::IO;
+
+static const String Tag = "ModelStreamHandler";
+
+ModelStreamPayload::ModelStreamPayload()
+: StreamPayload()
+, m_model( nullptr ) {
+    // empty
+}
+
+ModelStreamPayload::~ModelStreamPayload() {
+    AssimpWrapper::releaseModel( m_model );
+    m_model = nullptr;
+}
+
+ui64 ModelStreamPayload::getUploadSize() const {
+    if ( nullptr == m_model ) {
+        return 0;
+    }
+
+    ui64 size( 0 );
+    const Model::GeoArray &geoArray( m_model->getGeoArray() );
+    for ( ui32 i = 0; i < geoArray.size(); ++i ) {
+        const Geometry *geo( geoArray[ i ] );
+        if ( nullptr == geo ) {
+            continue;
+        }
+        if ( nullptr != geo->m_vb ) {
+            size += geo->m_vb->m_size;
+        }
+        if ( nullptr != geo->m_ib ) {
+            size += geo->m_ib->m_size;
+        }
+    }
+
+    return size;
+}
+
+ModelStreamHandler::ModelStreamHandler( const UploadFunc &uploadFunc )
+: StreamHandler()
+, m_uploadFunc( uploadFunc )
+, m_ids()
+, m_importMutex() {
+    // empty
+}
+
+ModelStreamHandler::~ModelStreamHandler() {
+    // empty
+}
+
+bool ModelStreamHandler::readsFileData() const {
+    return false;
+}
+
+StreamPayload *ModelStreamHandler::decode( const Uri &uri, std::vector<uc8> & ) {
+    Model *model( nullptr );
+    {
+        std::unique_lock<std::mutex> lock( m_importMutex );
+        AssimpWrapper wrapper( m_ids );
+        if ( !wrapper.importAsset( uri, 0 ) ) {
+            osre_debug( Tag, "Cannot import " + uri.getResource() );
+            return nullptr;
+        }
+        model = wrapper.getModel();
+    }
+    if ( nullptr == model ) {
+        return nullptr;
+    }
+
+    ModelStreamPayload *payload( new ModelStreamPayload );
+    payload->m_model = model;
+
+    return payload;
+}
+
+bool ModelStreamHandler::upload( StreamPayload *payload ) {
+    ModelStreamPayload *modelPayload( static_cast<ModelStreamPayload*>( payload ) );
+    if ( nullptr == modelPayload || nullptr == modelPayload->m_model ) {
+        return false;
+    }
+
+    if ( !m_uploadFunc ) {
+        return true;
+    }
+
+    if ( !m_uploadFunc( modelPayload->m_model ) ) {
+        osre_debug( Tag, "Cannot upload a model." );
+        return false;
+    }
+    modelPayload->m_model = nullptr;
+
+    return true;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
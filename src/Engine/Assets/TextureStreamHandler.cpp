@@ -0,0 +1,124 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/TextureStreamHandler.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/Common/Logger.h>
+#include <src/Engine/IO/ImageCodec.h>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+using namespace ::OSRE::IO;
+
+static const String Tag = "TextureStreamHandler";
+
+TextureStreamPayload::TextureStreamPayload()
+: StreamPayload()
+, m_texture( nullptr ) {
+    // empty
+}
+
+TextureStreamPayload::~TextureStreamPayload() {
+    delete m_texture;
+    m_texture = nullptr;
+}
+
+ui64 TextureStreamPayload::getUploadSize() const {
+    return nullptr != m_texture ? m_texture->m_size : 0;
+}
+
+TextureStreamHandler::TextureStreamHandler( const UploadFunc &uploadFunc )
+: StreamHandler()
+, m_uploadFunc( uploadFunc ) {
+    // empty
+}
+
+TextureStreamHandler::~TextureStreamHandler() {
+    // empty
+}
+
+StreamPayload *TextureStreamHandler::decode( const Uri &uri, std::vector<uc8> &data ) {
+    if ( data.empty() || data.size() > 0xFFFFFFFFull ) {
+        osre_debug( Tag, "Invalid image size of " + uri.getResource() );
+        return nullptr;
+    }
+
+    // The pixels are decoded into the texture, so they are not copied again
+    const ui32 size( static_cast<ui32>( data.size() ) );
+    ImageCodec::ImageInfo info;
+    if ( !ImageCodec::getInfo( &data[ 0 ], size, info ) || 0 == info.m_width || 0 == info.m_height ) {
+        osre_debug( Tag, "Unknown image format of " + uri.getResource() );
+        return nullptr;
+    }
+
+    const ui32 channels( ImageCodec::getNumChannels( ImageCodec::PixelFormat::RGBA ) );
+    const ui64 capacity( static_cast<ui64>( info.m_width ) * info.m_height * channels );
+    if ( capacity > 0xFFFFFFFFull ) {
+        osre_debug( Tag, "Image " + uri.getResource() + " is too big." );
+        return nullptr;
+    }
+
+    Texture *texture( new Texture );
+    texture->m_textureName = uri.getResource();
+    texture->m_loc = uri;
+    texture->m_targetType = TextureTargetType::Texture2D;
+    texture->m_size = static_cast<ui32>( capacity );
+    texture->m_data = new uc8[ texture->m_size ];
+    if ( !ImageCodec::decodeImage( &data[ 0 ], size, ImageCodec::PixelFormat::RGBA, ImageCodec::FlipVertical, 
+            texture->m_data, texture->m_size, info ) ) {
+        osre_debug( Tag, "Cannot decode " + uri.getResource() );
+        delete texture;
+        return nullptr;
+    }
+    texture->m_width = info.m_width;
+    texture->m_height = info.m_height;
+    texture->m_channels = channels;
+
+    TextureStreamPayload *payload( new TextureStreamPayload );
+    payload->m_texture = texture;
+
+    return payload;
+}
+
+bool TextureStreamHandler::upload( StreamPayload *payload ) {
+    TextureStreamPayload *texPayload( static_cast<TextureStreamPayload*>( payload ) );
+    if ( nullptr == texPayload || nullptr == texPayload->m_texture ) {
+        return false;
+    }
+
+    if ( !m_uploadFunc ) {
+        return true;
+    }
+
+    if ( !m_uploadFunc( texPayload->m_texture ) ) {
+        osre_debug( Tag, "Cannot upload " + texPayload->m_texture->m_textureName );
+        return false;
+    }
+    texPayload->m_texture = nullptr;
+
+    return true;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,250 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/VertexQuantizer.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Logger.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <new>
+#include <string.h>
+
+namespace OSRE {
+namespace Assets {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "VertexQuantizer";
+
+VertexQuantizer::VertexQuantizer() {
+    // empty
+}
+
+VertexQuantizer::~VertexQuantizer() {
+    // empty
+}
+
+static f32 clamp( f32 value, f32 minValue, f32 maxValue ) {
+    return value < minValue ? minValue : ( value > maxValue ? maxValue : value );
+}
+
+static f32 signNotZero( f32 value ) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+void VertexQuantizer::encodeNormal( const glm::vec3 &normal, i16 encoded[ 2 ] ) {
+    const f32 l1( std::fabs( normal.x ) + std::fabs( normal.y ) + std::fabs( normal.z ) );
+    if ( 0.0f == l1 ) {
+        encoded[ 0 ] = encoded[ 1 ] = 0;
+        return;
+    }
+
+    // Project onto the octahedron, the lower hemisphere is folded over the diagonals
+    f32 u( normal.x / l1 ), v( normal.y / l1 );
+    if ( normal.z < 0.0f ) {
+        const f32 foldedU( ( 1.0f - std::fabs( v ) ) * signNotZero( u ) );
+        const f32 foldedV( ( 1.0f - std::fabs( u ) ) * signNotZero( v ) );
+        u = foldedU;
+        v = foldedV;
+    }
+    encoded[ 0 ] = static_cast<i16>( std::floor( clamp( u, -1.0f, 1.0f ) * 32767.0f + 0.5f ) );
+    encoded[ 1 ] = static_cast<i16>( std::floor( clamp( v, -1.0f, 1.0f ) * 32767.0f + 0.5f ) );
+}
+
+glm::vec3 VertexQuantizer::decodeNormal( const i16 encoded[ 2 ] ) {
+    // Same decoding as the snorm16 vertex fetch plus the shader
+    const f32 u( clamp( encoded[ 0 ] / 32767.0f, -1.0f, 1.0f ) );
+    const f32 v( clamp( encoded[ 1 ] / 32767.0f, -1.0f, 1.0f ) );
+    glm::vec3 normal( u, v, 1.0f - std::fabs( u ) - std::fabs( v ) );
+    if ( normal.z < 0.0f ) {
+        normal.x = ( 1.0f - std::fabs( v ) ) * signNotZero( u );
+        normal.y = ( 1.0f - std::fabs( u ) ) * signNotZero( v );
+    }
+
+    return glm::normalize( normal );
+}
+
+ui16 VertexQuantizer::encodeHalf( f32 value ) {
+    ui32 bits( 0 );
+    ::memcpy( &bits, &value, sizeof( ui32 ) );
+    const ui32 sign( ( bits >> 16 ) & 0x8000 );
+    const ui32 floatExp( ( bits >> 23 ) & 0xff );
+    ui32 mantissa( bits & 0x7fffff );
+
+    // Infinity and NaN
+    if ( 0xff == floatExp ) {
+        return static_cast<ui16>( sign | 0x7c00 | ( 0 != mantissa ? 0x200 : 0 ) );
+    }
+
+    const i32 exponent( static_cast<i32>( floatExp ) - 127 + 15 );
+    if ( exponent >= 31 ) {
+        return static_cast<ui16>( sign | 0x7c00 );
+    }
+
+    // Denormalized half floats
+    if ( exponent <= 0 ) {
+        if ( exponent < -10 ) {
+            return static_cast<ui16>( sign );
+        }
+        mantissa |= 0x800000;
+        const ui32 shift( static_cast<ui32>( 14 - exponent ) );
+        ui32 half( mantissa >> shift );
+        const ui32 rest( mantissa & ( ( 1u << shift ) - 1 ) );
+        const ui32 halfway( 1u << ( shift - 1 ) );
+        if ( rest > halfway || ( rest == halfway && 0 != ( half & 1 ) ) ) {
+            ++half;
+        }
+        return static_cast<ui16>( sign | half );
+    }
+
+    // A carry out of the mantissa correctly increments the exponent
+    ui32 half( sign | ( static_cast<ui32>( exponent ) << 10 ) | ( mantissa >> 13 ) );
+    const ui32 rest( mantissa & 0x1fff );
+    if ( rest > 0x1000 || ( rest == 0x1000 && 0 != ( half & 1 ) ) ) {
+        ++half;
+    }
+
+    return static_cast<ui16>( half );
+}
+
+f32 VertexQuantizer::decodeHalf( ui16 value ) {
+    const ui32 sign( static_cast<ui32>( value & 0x8000 ) << 16 );
+    const ui32 exponent( ( value >> 10 ) & 0x1f );
+    const ui32 mantissa( value & 0x3ff );
+    if ( 0 == exponent ) {
+        const f32 result( std::ldexp( static_cast<f32>( mantissa ), -24 ) );
+        return 0 != sign ? -result : result;
+    }
+
+    ui32 bits( 0 );
+    if ( 31 == exponent ) {
+        bits = sign | 0x7f800000 | ( mantissa << 13 );
+    } else {
+        bits = sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+    }
+    f32 result( 0.0f );
+    ::memcpy( &result, &bits, sizeof( f32 ) );
+
+    return result;
+}
+
+uc8 VertexQuantizer::encodeUnorm8( f32 value ) {
+    return static_cast<uc8>( std::floor( clamp( value, 0.0f, 1.0f ) * 255.0f + 0.5f ) );
+}
+
+ui16 VertexQuantizer::encodeUnorm16( f32 value ) {
+    return static_cast<ui16>( std::floor( clamp( value, 0.0f, 1.0f ) * 65535.0f + 0.5f ) );
+}
+
+static glm::vec3 getExtent( const Collision::TAABB<f32> &aabb ) {
+    // Flat axes use a unit extent, all of their positions are quantized to zero
+    glm::vec3 extent;
+    for ( ui32 i = 0; i < 3; ++i ) {
+        const f32 size( aabb.getMax()[ i ] - aabb.getMin()[ i ] );
+        extent[ i ] = size > 0.0f ? size : 1.0f;
+    }
+
+    return extent;
+}
+
+glm::mat4 VertexQuantizer::getDequantizationMatrix( const Collision::TAABB<f32> &aabb ) {
+    const glm::vec3 offset( aabb.getMin()[ 0 ], aabb.getMin()[ 1 ], aabb.getMin()[ 2 ] );
+    glm::mat4 dequant( glm::translate( glm::mat4( 1.0f ), offset ) );
+
+    return glm::scale( dequant, getExtent( aabb ) );
+}
+
+template<class T>
+static void packAttributes( const RenderVert &src, T &dst ) {
+    VertexQuantizer::encodeNormal( src.normal, dst.normal );
+    dst.color0[ 0 ] = VertexQuantizer::encodeUnorm8( src.color0.r );
+    dst.color0[ 1 ] = VertexQuantizer::encodeUnorm8( src.color0.g );
+    dst.color0[ 2 ] = VertexQuantizer::encodeUnorm8( src.color0.b );
+    dst.color0[ 3 ] = 255;
+    dst.tex0[ 0 ] = VertexQuantizer::encodeHalf( src.tex0.x );
+    dst.tex0[ 1 ] = VertexQuantizer::encodeHalf( src.tex0.y );
+}
+
+bool VertexQuantizer::quantize( Geometry *geo, VertexType type ) {
+    if ( nullptr == geo || nullptr == geo->m_vb ) {
+        osre_debug( Tag, "Invalid geometry." );
+        return false;
+    }
+
+    if ( VertexType::RenderVertex != geo->m_vertextype ) {
+        osre_debug( Tag, "Only render vertices can be quantized." );
+        return false;
+    }
+
+    if ( VertexType::CompactRenderVertex != type && VertexType::QuantizedRenderVertex != type ) {
+        osre_debug( Tag, "Unsupported vertex type for quantization." );
+        return false;
+    }
+
+    const RenderVert *src( static_cast<const RenderVert*>( geo->m_vb->m_data ) );
+    const ui32 numVertices( geo->m_vb->m_size / sizeof( RenderVert ) );
+    BufferData *vb( BufferData::alloc( BufferType::VertexBuffer, Geometry::getVertexSize( type ) * numVertices, 
+            geo->m_vb->m_access ) );
+    if ( VertexType::CompactRenderVertex == type ) {
+        CompactRenderVert *dst( static_cast<CompactRenderVert*>( vb->m_data ) );
+        for ( ui32 i = 0; i < numVertices; ++i ) {
+            new ( &dst[ i ] ) CompactRenderVert;
+            dst[ i ].position = src[ i ].position;
+            packAttributes( src[ i ], dst[ i ] );
+        }
+    } else {
+        Collision::TAABB<f32> aabb;
+        for ( ui32 i = 0; i < numVertices; ++i ) {
+            aabb.merge( src[ i ].position.x, src[ i ].position.y, src[ i ].position.z );
+        }
+        const glm::vec3 extent( getExtent( aabb ) );
+        const glm::vec3 minPos( aabb.getMin()[ 0 ], aabb.getMin()[ 1 ], aabb.getMin()[ 2 ] );
+
+        QuantizedRenderVert *dst( static_cast<QuantizedRenderVert*>( vb->m_data ) );
+        for ( ui32 i = 0; i < numVertices; ++i ) {
+            new ( &dst[ i ] ) QuantizedRenderVert;
+            const glm::vec3 pos( ( src[ i ].position - minPos ) / extent );
+            dst[ i ].position[ 0 ] = encodeUnorm16( pos.x );
+            dst[ i ].position[ 1 ] = encodeUnorm16( pos.y );
+            dst[ i ].position[ 2 ] = encodeUnorm16( pos.z );
+            packAttributes( src[ i ], dst[ i ] );
+        }
+
+        // The dequantization is applied before an already existing local transformation
+        if ( 0 != numVertices ) {
+            const glm::mat4 local( geo->m_localMatrix ? geo->m_model : glm::mat4( 1.0f ) );
+            geo->m_model = local * getDequantizationMatrix( aabb );
+            geo->m_localMatrix = true;
+        }
+    }
+
+    BufferData::free( geo->m_vb );
+    geo->m_vb = vb;
+    geo->m_vertextype = type;
+
+    return true;
+}
+
+} // Namespace Assets
+} // Namespace OSRE
@@ -0,0 +1,301 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Collision/Bvh4.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#   define OSRE_BVH_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace OSRE {
+namespace Collision {
+
+// Direction components below this will be clamped to avoid infinite slab distances
+static const f32 MinDirection = 1e-20f;
+
+const ui32 Bvh4::Width;
+const ui32 Bvh4::PacketSize;
+const ui32 Bvh4::MaxStackSize;
+
+static f32 safeInverse( f32 value ) {
+    if ( std::fabs( value ) < MinDirection ) {
+        value = value < 0.0f ? -MinDirection : MinDirection;
+    }
+
+    return 1.0f / value;
+}
+
+Bvh4::Ray::Ray( const glm::vec3 &origin, const glm::vec3 &direction )
+: m_origin( origin )
+, m_direction( direction )
+, m_invDirection( safeInverse( direction.x ), safeInverse( direction.y ), safeInverse( direction.z ) ) {
+    // empty
+}
+
+Bvh4::Ray::Ray( const TRay<f32> &ray )
+: m_origin( ray.getOrigin()[ 0 ], ray.getOrigin()[ 1 ], ray.getOrigin()[ 2 ] )
+, m_direction( ray.getDirection()[ 0 ], ray.getDirection()[ 1 ], ray.getDirection()[ 2 ] )
+, m_invDirection( safeInverse( m_direction.x ), safeInverse( m_direction.y ), safeInverse( m_direction.z ) ) {
+    // empty
+}
+
+Bvh4::RayPacket::RayPacket()
+: m_numRays( 0 ) {
+    for ( ui32 axis = 0; axis < 3; ++axis ) {
+        for ( ui32 i = 0; i < PacketSize; ++i ) {
+            m_origin[ axis ][ i ] = 0.0f;
+            m_direction[ axis ][ i ] = 0.0f;
+            m_invDirection[ axis ][ i ] = 1.0f;
+        }
+    }
+}
+
+bool Bvh4::RayPacket::add( const Ray &ray ) {
+    if ( m_numRays >= PacketSize ) {
+        return false;
+    }
+
+    for ( ui32 axis = 0; axis < 3; ++axis ) {
+        m_origin[ axis ][ m_numRays ] = ray.m_origin[ axis ];
+        m_direction[ axis ][ m_numRays ] = ray.m_direction[ axis ];
+        m_invDirection[ axis ][ m_numRays ] = ray.m_invDirection[ axis ];
+    }
+    ++m_numRays;
+
+    return true;
+}
+
+Bvh4::Ray Bvh4::RayPacket::getRay( ui32 idx ) const {
+    const glm::vec3 origin( m_origin[ 0 ][ idx ], m_origin[ 1 ][ idx ], m_origin[ 2 ][ idx ] );
+    const glm::vec3 direction( m_direction[ 0 ][ idx ], m_direction[ 1 ][ idx ], m_direction[ 2 ][ idx ] );
+
+    return Ray( origin, direction );
+}
+
+Bvh4::Bvh4()
+: m_nodes()
+, m_primIndices()
+, m_maxLeafSize( 4 )
+, m_bounds() {
+    // empty
+}
+
+Bvh4::~Bvh4() {
+    // empty
+}
+
+void Bvh4::build( const AABB *boxes, ui32 numBoxes, ui32 maxLeafSize ) {
+    clear();
+    if ( nullptr == boxes || 0 == numBoxes ) {
+        return;
+    }
+
+    m_maxLeafSize = maxLeafSize > 0 ? maxLeafSize : 1;
+    std::vector<glm::vec3> centroids( numBoxes );
+    m_primIndices.resize( numBoxes );
+    for ( ui32 i = 0; i < numBoxes; ++i ) {
+        const AABB &box( boxes[ i ] );
+        m_bounds.merge( box.getMin() );
+        m_bounds.merge( box.getMax() );
+        for ( ui32 axis = 0; axis < 3; ++axis ) {
+            centroids[ i ][ axis ] = ( box.getMin()[ axis ] + box.getMax()[ axis ] ) * 0.5f;
+        }
+        m_primIndices[ i ] = i;
+    }
+
+    m_nodes.reserve( numBoxes / 2 + 1 );
+    buildNode( boxes, centroids, 0, numBoxes );
+}
+
+void Bvh4::clear() {
+    m_nodes.resize( 0 );
+    m_primIndices.resize( 0 );
+    m_bounds.reset();
+}
+
+void Bvh4::splitRange( const std::vector<glm::vec3> &centroids, ui32 begin, ui32 end, ui32 &mid ) {
+    // Median split along the axis with the largest centroid extent
+    glm::vec3 minPos( centroids[ m_primIndices[ begin ] ] ), maxPos( minPos );
+    for ( ui32 i = begin + 1; i < end; ++i ) {
+        minPos = glm::min( minPos, centroids[ m_primIndices[ i ] ] );
+        maxPos = glm::max( maxPos, centroids[ m_primIndices[ i ] ] );
+    }
+    const glm::vec3 extent( maxPos - minPos );
+    ui32 axis( 0 );
+    if ( extent.y > extent[ axis ] ) {
+        axis = 1;
+    }
+    if ( extent.z > extent[ axis ] ) {
+        axis = 2;
+    }
+
+    mid = begin + ( end - begin ) / 2;
+    std::nth_element( m_primIndices.begin() + begin, m_primIndices.begin() + mid, m_primIndices.begin() + end, 
+        [ &centroids, axis ]( ui32 lhs, ui32 rhs ) {
+            return centroids[ lhs ][ axis ] < centroids[ rhs ][ axis ];
+        } );
+}
+
+ui32 Bvh4::buildNode( const AABB *boxes, const std::vector<glm::vec3> &centroids, ui32 begin, ui32 end ) {
+    const ui32 nodeIdx( static_cast<ui32>( m_nodes.size() ) );
+    m_nodes.push_back( Node() );
+
+    // Split the range into halves and the halves into quarters, small ranges will be leaves
+    ui32 ranges[ Width + 1 ] = { begin, end, end, end, end };
+    ui32 numRanges( 1 );
+    if ( end - begin > m_maxLeafSize ) {
+        ui32 mid( begin );
+        splitRange( centroids, begin, end, mid );
+        const ui32 halves[ 3 ] = { begin, mid, end };
+        numRanges = 0;
+        for ( ui32 i = 0; i < 2; ++i ) {
+            ranges[ numRanges++ ] = halves[ i ];
+            if ( halves[ i + 1 ] - halves[ i ] > m_maxLeafSize ) {
+                ui32 quarter( halves[ i ] );
+                splitRange( centroids, halves[ i ], halves[ i + 1 ], quarter );
+                ranges[ numRanges++ ] = quarter;
+            }
+        }
+        ranges[ numRanges ] = end;
+    }
+
+    for ( ui32 child = 0; child < Width; ++child ) {
+        AABB bounds;
+        i32 childRef( -1 );
+        ui32 count( 0 );
+        if ( child < numRanges ) {
+            const ui32 first( ranges[ child ] ), last( ranges[ child + 1 ] );
+            for ( ui32 i = first; i < last; ++i ) {
+                bounds.merge( boxes[ m_primIndices[ i ] ].getMin() );
+                bounds.merge( boxes[ m_primIndices[ i ] ].getMax() );
+            }
+            if ( last - first > m_maxLeafSize ) {
+                childRef = static_cast<i32>( buildNode( boxes, centroids, first, last ) );
+            } else {
+                childRef = static_cast<i32>( first );
+                count = last - first;
+            }
+        } else {
+            // Empty slots get inverted bounds, so the slab test will never hit them
+            bounds.set( AABB::VecType( FLT_MAX, FLT_MAX, FLT_MAX ), AABB::VecType( -FLT_MAX, -FLT_MAX, -FLT_MAX ) );
+        }
+
+        // The vector may have grown during the recursion
+        Node &node( m_nodes[ nodeIdx ] );
+        for ( ui32 axis = 0; axis < 3; ++axis ) {
+            node.m_min[ axis ][ child ] = bounds.getMin()[ axis ];
+            node.m_max[ axis ][ child ] = bounds.getMax()[ axis ];
+        }
+        node.m_child[ child ] = childRef;
+        node.m_count[ child ] = count;
+    }
+
+    return nodeIdx;
+}
+
+ui32 Bvh4::intersectChildren( ui32 nodeIdx, const Ray &ray, f32 maxDist, f32 tNear[ Width ] ) const {
+    const Node &node( m_nodes[ nodeIdx ] );
+
+    // The near plane is selected by the sign of the direction, inverted boxes will never be hit
+#ifdef OSRE_BVH_SSE2
+    __m128 tMin( _mm_setzero_ps() );
+    __m128 tMax( _mm_set1_ps( maxDist ) );
+    for ( ui32 axis = 0; axis < 3; ++axis ) {
+        const bool positive( ray.m_invDirection[ axis ] >= 0.0f );
+        const __m128 nearPlane( _mm_loadu_ps( positive ? node.m_min[ axis ] : node.m_max[ axis ] ) );
+        const __m128 farPlane( _mm_loadu_ps( positive ? node.m_max[ axis ] : node.m_min[ axis ] ) );
+        const __m128 origin( _mm_set1_ps( ray.m_origin[ axis ] ) );
+        const __m128 invDir( _mm_set1_ps( ray.m_invDirection[ axis ] ) );
+        tMin = _mm_max_ps( tMin, _mm_mul_ps( _mm_sub_ps( nearPlane, origin ), invDir ) );
+        tMax = _mm_min_ps( tMax, _mm_mul_ps( _mm_sub_ps( farPlane, origin ), invDir ) );
+    }
+    _mm_storeu_ps( tNear, tMin );
+
+    return static_cast<ui32>( _mm_movemask_ps( _mm_cmple_ps( tMin, tMax ) ) );
+#else
+    ui32 mask( 0 );
+    for ( ui32 child = 0; child < Width; ++child ) {
+        f32 tMin( 0.0f ), tMax( maxDist );
+        for ( ui32 axis = 0; axis < 3; ++axis ) {
+            const bool positive( ray.m_invDirection[ axis ] >= 0.0f );
+            const f32 nearPlane( positive ? node.m_min[ axis ][ child ] : node.m_max[ axis ][ child ] );
+            const f32 farPlane( positive ? node.m_max[ axis ][ child ] : node.m_min[ axis ][ child ] );
+            tMin = std::max( tMin, ( nearPlane - ray.m_origin[ axis ] ) * ray.m_invDirection[ axis ] );
+            tMax = std::min( tMax, ( farPlane - ray.m_origin[ axis ] ) * ray.m_invDirection[ axis ] );
+        }
+        tNear[ child ] = tMin;
+        if ( tMin <= tMax ) {
+            mask |= 1 << child;
+        }
+    }
+
+    return mask;
+#endif
+}
+
+ui32 Bvh4::intersectChildPacket( ui32 nodeIdx, ui32 child, const RayPacket &packet, ui32 rayMask, 
+        const f32 maxDist[ PacketSize ] ) const {
+    const Node &node( m_nodes[ nodeIdx ] );
+
+    // The rays may point into different directions, so the slabs will be ordered by min / max
+#ifdef OSRE_BVH_SSE2
+    __m128 tMin( _mm_setzero_ps() );
+    __m128 tMax( _mm_loadu_ps( maxDist ) );
+    for ( ui32 axis = 0; axis < 3; ++axis ) {
+        const __m128 origin( _mm_loadu_ps( packet.m_origin[ axis ] ) );
+        const __m128 invDir( _mm_loadu_ps( packet.m_invDirection[ axis ] ) );
+        const __m128 t0( _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.m_min[ axis ][ child ] ), origin ), invDir ) );
+        const __m128 t1( _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( node.m_max[ axis ][ child ] ), origin ), invDir ) );
+        tMin = _mm_max_ps( tMin, _mm_min_ps( t0, t1 ) );
+        tMax = _mm_min_ps( tMax, _mm_max_ps( t0, t1 ) );
+    }
+
+    return rayMask & static_cast<ui32>( _mm_movemask_ps( _mm_cmple_ps( tMin, tMax ) ) );
+#else
+    ui32 mask( 0 );
+    for ( ui32 i = 0; i < packet.m_numRays; ++i ) {
+        if ( 0 == ( rayMask & ( 1 << i ) ) ) {
+            continue;
+        }
+        f32 tMin( 0.0f ), tMax( maxDist[ i ] );
+        for ( ui32 axis = 0; axis < 3; ++axis ) {
+            const f32 t0( ( node.m_min[ axis ][ child ] - packet.m_origin[ axis ][ i ] ) * packet.m_invDirection[ axis ][ i ] );
+            const f32 t1( ( node.m_max[ axis ][ child ] - packet.m_origin[ axis ][ i ] ) * packet.m_invDirection[ axis ][ i ] );
+            tMin = std::max( tMin, std::min( t0, t1 ) );
+            tMax = std::min( tMax, std::max( t0, t1 ) );
+        }
+        if ( tMin <= tMax ) {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
+#endif
+}
+
+} // Namespace Collision
+} // Namespace OSRE
@@ -94,10 +94,19 @@ void GeometryProcessor::handleGeometry( RenderBackend::Geometry *geo ) {
             stride = sizeof( ColorVert );
             break;
 
+        case VertexType::CompactRenderVertex:
+            offsetPos = 0;
+            stride = sizeof( CompactRenderVert );
+            break;
+
         default:
             break;
     }
 
+    if ( 0 == stride ) {
+        return;
+    }
+
     BufferData *data = geo->m_vb;
     if ( nullptr == data || 0 == data->m_size ) {
         return;
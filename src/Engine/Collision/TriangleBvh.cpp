@@ -0,0 +1,274 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Collision/TriangleBvh.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <cmath>
+
+namespace OSRE {
+namespace Collision {
+
+using namespace ::OSRE::RenderBackend;
+
+// Determinants below this are treated as rays parallel to the triangle
+static const f32 ParallelEpsilon = 1e-12f;
+
+const ui32 TriangleBvh::InvalidTriangle;
+
+TriangleBvh::Hit::Hit()
+: m_distance( 0.0f )
+, m_triangle( InvalidTriangle )
+, m_u( 0.0f )
+, m_v( 0.0f ) {
+    // empty
+}
+
+TriangleBvh::TriangleBvh()
+: m_triangles()
+, m_bvh() {
+    // empty
+}
+
+TriangleBvh::~TriangleBvh() {
+    // empty
+}
+
+static ui32 readIndex( const Geometry *geo, IndexType type, ui32 idx ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return static_cast<const uc8*>( geo->m_ib->m_data )[ idx ];
+        case IndexType::UnsignedShort:
+            return static_cast<const ui16*>( geo->m_ib->m_data )[ idx ];
+        case IndexType::UnsignedInt:
+            return static_cast<const ui32*>( geo->m_ib->m_data )[ idx ];
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static ui32 getIndexSize( IndexType type ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return sizeof( uc8 );
+        case IndexType::UnsignedShort:
+            return sizeof( ui16 );
+        case IndexType::UnsignedInt:
+            return sizeof( ui32 );
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+bool TriangleBvh::build( const Geometry *geo ) {
+    clear();
+    if ( nullptr == geo ) {
+        return false;
+    }
+
+    bool ok( true );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        if ( PrimitiveType::TriangleList == grp.m_primitive ) {
+            ok = addTriangles( geo, grp.m_indexType, grp.m_startIndex, grp.m_numIndices ) && ok;
+        }
+    }
+    buildBvh();
+
+    return ok;
+}
+
+bool TriangleBvh::build( const Geometry *geo, IndexType indexType, ui32 startIndex, ui32 numIndices ) {
+    clear();
+    const bool ok( addTriangles( geo, indexType, startIndex, numIndices ) );
+    buildBvh();
+
+    return ok;
+}
+
+void TriangleBvh::build( const glm::vec3 *positions, ui32 numVertices, const ui32 *indices, ui32 numIndices ) {
+    clear();
+    if ( nullptr == positions || nullptr == indices ) {
+        return;
+    }
+
+    m_triangles.reserve( numIndices / 3 );
+    for ( ui32 i = 0; i + 2 < numIndices; i += 3 ) {
+        if ( indices[ i ] >= numVertices || indices[ i + 1 ] >= numVertices || indices[ i + 2 ] >= numVertices ) {
+            continue;
+        }
+        const glm::vec3 &v0( positions[ indices[ i ] ] );
+        Triangle tri = { v0, positions[ indices[ i + 1 ] ] - v0, positions[ indices[ i + 2 ] ] - v0, i / 3 };
+        m_triangles.push_back( tri );
+    }
+    buildBvh();
+}
+
+bool TriangleBvh::addTriangles( const Geometry *geo, IndexType indexType, ui32 startIndex, ui32 numIndices ) {
+    if ( nullptr == geo || nullptr == geo->m_vb || nullptr == geo->m_ib ) {
+        return false;
+    }
+
+    // Only layouts with float positions at the start of the vertex
+    if ( VertexType::RenderVertex != geo->m_vertextype && VertexType::ColorVertex != geo->m_vertextype 
+            && VertexType::CompactRenderVertex != geo->m_vertextype ) {
+        return false;
+    }
+
+    const ui32 indexSize( getIndexSize( indexType ) );
+    if ( 0 == indexSize || ( startIndex + numIndices ) * indexSize > geo->m_ib->m_size ) {
+        return false;
+    }
+
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    const ui32 numVertices( geo->m_vb->m_size / vertexSize );
+    const uc8 *vertices( static_cast<const uc8*>( geo->m_vb->m_data ) );
+    m_triangles.reserve( m_triangles.size() + numIndices / 3 );
+    for ( ui32 i = 0; i + 2 < numIndices; i += 3 ) {
+        glm::vec3 pos[ 3 ];
+        bool valid( true );
+        for ( ui32 k = 0; k < 3; ++k ) {
+            const ui32 idx( readIndex( geo, indexType, startIndex + i + k ) );
+            if ( idx >= numVertices ) {
+                valid = false;
+                break;
+            }
+            // Position is the first attribute of all supported vertex types
+            pos[ k ] = *reinterpret_cast<const glm::vec3*>( &vertices[ idx * vertexSize ] );
+        }
+        if ( valid ) {
+            Triangle tri = { pos[ 0 ], pos[ 1 ] - pos[ 0 ], pos[ 2 ] - pos[ 0 ], ( startIndex + i ) / 3 };
+            m_triangles.push_back( tri );
+        }
+    }
+
+    return true;
+}
+
+void TriangleBvh::buildBvh() {
+    std::vector<Bvh4::AABB> boxes( m_triangles.size() );
+    for ( size_t i = 0; i < m_triangles.size(); ++i ) {
+        const Triangle &tri( m_triangles[ i ] );
+        const glm::vec3 v1( tri.m_v0 + tri.m_e1 ), v2( tri.m_v0 + tri.m_e2 );
+        boxes[ i ].merge( tri.m_v0.x, tri.m_v0.y, tri.m_v0.z );
+        boxes[ i ].merge( v1.x, v1.y, v1.z );
+        boxes[ i ].merge( v2.x, v2.y, v2.z );
+    }
+    m_bvh.build( boxes.empty() ? nullptr : &boxes[ 0 ], static_cast<ui32>( boxes.size() ) );
+}
+
+void TriangleBvh::clear() {
+    m_triangles.resize( 0 );
+    m_bvh.clear();
+}
+
+bool TriangleBvh::intersectTriangle( const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &v0, 
+        const glm::vec3 &e1, const glm::vec3 &e2, f32 &t, f32 &u, f32 &v ) {
+    const glm::vec3 p( glm::cross( direction, e2 ) );
+    const f32 det( glm::dot( e1, p ) );
+    if ( std::fabs( det ) < ParallelEpsilon ) {
+        return false;
+    }
+
+    const f32 invDet( 1.0f / det );
+    const glm::vec3 s( origin - v0 );
+    u = glm::dot( s, p ) * invDet;
+    if ( u < 0.0f || u > 1.0f ) {
+        return false;
+    }
+
+    const glm::vec3 q( glm::cross( s, e1 ) );
+    v = glm::dot( direction, q ) * invDet;
+    if ( v < 0.0f || u + v > 1.0f ) {
+        return false;
+    }
+
+    t = glm::dot( e2, q ) * invDet;
+
+    return t >= 0.0f;
+}
+
+bool TriangleBvh::intersect( const Bvh4::Ray &ray, f32 maxDist, Hit &hit ) const {
+    bool found( false );
+    m_bvh.traverse( ray, maxDist, [ this, &ray, &hit, &found ]( ui32 triIdx, f32 &maxDist ) {
+        const Triangle &tri( m_triangles[ triIdx ] );
+        f32 t, u, v;
+        if ( !intersectTriangle( ray.m_origin, ray.m_direction, tri.m_v0, tri.m_e1, tri.m_e2, t, u, v ) || t > maxDist ) {
+            return false;
+        }
+        maxDist = t;
+        hit.m_distance = t;
+        hit.m_triangle = tri.m_index;
+        hit.m_u = u;
+        hit.m_v = v;
+        found = true;
+        return true;
+    } );
+
+    return found;
+}
+
+ui32 TriangleBvh::intersectAll( const Bvh4::Ray &ray, f32 maxDist, CPPCore::TArray<Hit> &hits ) const {
+    const ui32 numHits( hits.size() );
+    m_bvh.traverse( ray, maxDist, [ this, &ray, &hits ]( ui32 triIdx, f32 &maxDist ) {
+        const Triangle &tri( m_triangles[ triIdx ] );
+        Hit hit;
+        if ( !intersectTriangle( ray.m_origin, ray.m_direction, tri.m_v0, tri.m_e1, tri.m_e2, hit.m_distance, hit.m_u, hit.m_v ) 
+                || hit.m_distance > maxDist ) {
+            return false;
+        }
+        hit.m_triangle = tri.m_index;
+        hits.add( hit );
+        return false;
+    } );
+
+    return hits.size() - numHits;
+}
+
+void TriangleBvh::intersectPacket( const Bvh4::RayPacket &packet, f32 maxDist[ Bvh4::PacketSize ], Hit hits[ Bvh4::PacketSize ] ) const {
+    m_bvh.traversePacket( packet, maxDist, [ this, &packet, hits ]( ui32 triIdx, ui32 rayMask, f32 *maxDist ) {
+        const Triangle &tri( m_triangles[ triIdx ] );
+        for ( ui32 i = 0; i < packet.m_numRays; ++i ) {
+            if ( 0 == ( rayMask & ( 1 << i ) ) ) {
+                continue;
+            }
+            const glm::vec3 origin( packet.m_origin[ 0 ][ i ], packet.m_origin[ 1 ][ i ], packet.m_origin[ 2 ][ i ] );
+            const glm::vec3 direction( packet.m_direction[ 0 ][ i ], packet.m_direction[ 1 ][ i ], packet.m_direction[ 2 ][ i ] );
+            f32 t, u, v;
+            if ( intersectTriangle( origin, direction, tri.m_v0, tri.m_e1, tri.m_e2, t, u, v ) && t <= maxDist[ i ] ) {
+                maxDist[ i ] = t;
+                hits[ i ].m_distance = t;
+                hits[ i ].m_triangle = tri.m_index;
+                hits[ i ].m_u = u;
+                hits[ i ].m_v = v;
+            }
+        }
+    } );
+}
+
+} // Namespace Collision
+} // Namespace OSRE
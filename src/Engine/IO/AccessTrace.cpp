@@ -0,0 +1,349 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "AccessTrace.h"
+#include <osre/Common/Logger.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef OSRE_GNU_LINUX
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/ioctl.h>
+#   include <linux/fs.h>
+#   include <linux/fiemap.h>
+#endif
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "AccessTrace";
+static const c8 TraceHeader[] = "OSRE_ACCESS_TRACE 1";
+// Large ranges are prefetched in pieces, so a cancel does not wait long
+static const ui64 PrefetchChunkSize = 4 * 1024 * 1024;
+
+const ui32 AccessTrace::MaxRecordTime = 60 * 1000;
+const ui32 AccessTrace::MaxEntries = 64 * 1024;
+
+AccessTrace::AccessTrace()
+: m_mutex()
+, m_entries()
+, m_recording( false )
+, m_start( std::chrono::steady_clock::now() )
+, m_prefetcher()
+, m_cancel( false )
+, m_prefetchedBytes( 0 ) {
+    // empty
+}
+
+AccessTrace::~AccessTrace() {
+    m_cancel = true;
+    waitForPrefetch();
+}
+
+void AccessTrace::startRecording() {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_entries.clear();
+    m_start = std::chrono::steady_clock::now();
+    m_recording = true;
+}
+
+void AccessTrace::stopRecording() {
+    m_recording = false;
+}
+
+bool AccessTrace::isRecording() const {
+    return m_recording;
+}
+
+void AccessTrace::record( const String &path, ui64 offset, ui64 size ) {
+    if ( !m_recording || path.empty() ) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const i64 time( std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - m_start ).count() );
+    if ( time > MaxRecordTime || m_entries.size() >= MaxEntries ) {
+        m_recording = false;
+        return;
+    }
+
+    Entry entry;
+    entry.m_path = path;
+    entry.m_offset = offset;
+    entry.m_size = size;
+    entry.m_time = static_cast<ui32>( time );
+    m_entries.push_back( entry );
+}
+
+void AccessTrace::getEntries( std::vector<Entry> &entries ) const {
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        entries = m_entries;
+    }
+    merge( entries );
+}
+
+bool AccessTrace::save( const String &filename ) const {
+    std::vector<Entry> entries;
+    getEntries( entries );
+
+    FILE *file( ::fopen( filename.c_str(), "w" ) );
+    if ( nullptr == file ) {
+        osre_debug( Tag, "Cannot write trace " + filename );
+        return false;
+    }
+    ::fprintf( file, "%s\n", TraceHeader );
+    for ( const Entry &entry : entries ) {
+        ::fprintf( file, "%u %llu %llu %s\n", entry.m_time, static_cast<unsigned long long>( entry.m_offset ), 
+                static_cast<unsigned long long>( entry.m_size ), entry.m_path.c_str() );
+    }
+
+    return 0 == ::fclose( file );
+}
+
+bool AccessTrace::load( const String &filename, std::vector<Entry> &entries ) {
+    entries.clear();
+    FILE *file( ::fopen( filename.c_str(), "r" ) );
+    if ( nullptr == file ) {
+        return false;
+    }
+
+    c8 line[ 4096 ];
+    bool ok( nullptr != ::fgets( line, sizeof( line ), file ) && 0 == ::strncmp( line, TraceHeader, sizeof( TraceHeader ) - 1 ) );
+    while ( ok && nullptr != ::fgets( line, sizeof( line ), file ) ) {
+        unsigned int time( 0 );
+        unsigned long long offset( 0 ), size( 0 );
+        int pathStart( 0 );
+        if ( 3 != ::sscanf( line, "%u %llu %llu %n", &time, &offset, &size, &pathStart ) || 0 == pathStart ) {
+            ok = false;
+            break;
+        }
+
+        Entry entry;
+        entry.m_path = line + pathStart;
+        while ( !entry.m_path.empty() && ( '\n' == entry.m_path.back() || '\r' == entry.m_path.back() ) ) {
+            entry.m_path.pop_back();
+        }
+        entry.m_offset = offset;
+        entry.m_size = size;
+        entry.m_time = time;
+        if ( !entry.m_path.empty() ) {
+            entries.push_back( entry );
+        }
+    }
+    ::fclose( file );
+    if ( !ok ) {
+        osre_debug( Tag, "Invalid trace " + filename );
+        entries.clear();
+    }
+
+    return ok;
+}
+
+void AccessTrace::merge( std::vector<Entry> &entries ) {
+    std::sort( entries.begin(), entries.end(), []( const Entry &lhs, const Entry &rhs ) {
+        if ( lhs.m_path != rhs.m_path ) {
+            return lhs.m_path < rhs.m_path;
+        }
+        return lhs.m_offset < rhs.m_offset;
+    } );
+
+    std::vector<Entry> merged;
+    merged.reserve( entries.size() );
+    for ( const Entry &entry : entries ) {
+        if ( !merged.empty() && merged.back().m_path == entry.m_path ) {
+            Entry &last( merged.back() );
+            if ( 0 == last.m_size || entry.m_offset <= last.m_offset + last.m_size ) {
+                if ( 0 != last.m_size ) {
+                    last.m_size = 0 == entry.m_size ? 0 : 
+                            std::max( last.m_offset + last.m_size, entry.m_offset + entry.m_size ) - last.m_offset;
+                }
+                last.m_time = std::min( last.m_time, entry.m_time );
+                continue;
+            }
+        }
+        merged.push_back( entry );
+    }
+    entries.swap( merged );
+}
+
+void AccessTrace::startPrefetch( const std::vector<Entry> &entries, ui64 budget ) {
+    waitForPrefetch();
+    m_cancel = false;
+    m_prefetchedBytes = 0;
+    if ( entries.empty() || 0 == budget ) {
+        return;
+    }
+
+    m_prefetcher = std::thread( &AccessTrace::prefetchMain, this, entries, budget );
+}
+
+void AccessTrace::waitForPrefetch() {
+    if ( m_prefetcher.joinable() ) {
+        m_prefetcher.join();
+    }
+}
+
+ui64 AccessTrace::getNumPrefetchedBytes() const {
+    return m_prefetchedBytes;
+}
+
+void AccessTrace::prefetchMain( std::vector<Entry> entries, ui64 budget ) {
+    merge( entries );
+    std::vector<Range> ranges;
+    ranges.reserve( entries.size() );
+    for ( const Entry &entry : entries ) {
+        Range range;
+        if ( !m_cancel && locate( entry, range ) ) {
+            ranges.push_back( range );
+        }
+    }
+
+    // Disk order turns the scattered reads of the startup into a sweep
+    std::sort( ranges.begin(), ranges.end(), []( const Range &lhs, const Range &rhs ) {
+        if ( lhs.m_diskPos != rhs.m_diskPos ) {
+            return lhs.m_diskPos < rhs.m_diskPos;
+        }
+        if ( lhs.m_path != rhs.m_path ) {
+            return lhs.m_path < rhs.m_path;
+        }
+        return lhs.m_offset < rhs.m_offset;
+    } );
+
+    std::vector<uc8> scratch;
+    ui64 remaining( budget );
+    for ( Range &range : ranges ) {
+        if ( m_cancel || 0 == remaining ) {
+            break;
+        }
+        range.m_size = std::min( range.m_size, remaining );
+        const ui64 bytes( prefetchRange( range, scratch ) );
+        remaining -= std::min( bytes, remaining );
+        m_prefetchedBytes += bytes;
+    }
+}
+
+bool AccessTrace::locate( const Entry &entry, Range &range ) const {
+    ui64 fileSize( 0 );
+    range.m_diskPos = 0;
+#ifdef OSRE_GNU_LINUX
+    const int fd( ::open( entry.m_path.c_str(), O_RDONLY | O_CLOEXEC ) );
+    if ( fd < 0 ) {
+        return false;
+    }
+    struct stat fileStat;
+    if ( 0 != ::fstat( fd, &fileStat ) ) {
+        ::close( fd );
+        return false;
+    }
+    fileSize = static_cast<ui64>( fileStat.st_size );
+
+    // The physical position of the first extent, file systems without FIEMAP are sorted by inode
+    range.m_diskPos = static_cast<ui64>( fileStat.st_ino );
+    alignas( struct fiemap ) c8 buffer[ sizeof( struct fiemap ) + sizeof( struct fiemap_extent ) ];
+    ::memset( buffer, 0, sizeof( buffer ) );
+    struct fiemap *map( reinterpret_cast<struct fiemap*>( buffer ) );
+    map->fm_start = entry.m_offset;
+    map->fm_length = 0 == entry.m_size ? FIEMAP_MAX_OFFSET : entry.m_size;
+    map->fm_extent_count = 1;
+    if ( 0 == ::ioctl( fd, FS_IOC_FIEMAP, map ) && map->fm_mapped_extents > 0 ) {
+        range.m_diskPos = map->fm_extents[ 0 ].fe_physical;
+    }
+    ::close( fd );
+#elif defined( OSRE_WINDOWS )
+    struct __stat64 fileStat;
+    if ( 0 != ::_stat64( entry.m_path.c_str(), &fileStat ) ) {
+        return false;
+    }
+    fileSize = static_cast<ui64>( fileStat.st_size );
+#else
+    struct stat fileStat;
+    if ( 0 != ::stat( entry.m_path.c_str(), &fileStat ) ) {
+        return false;
+    }
+    fileSize = static_cast<ui64>( fileStat.st_size );
+#endif
+
+    if ( entry.m_offset >= fileSize ) {
+        return false;
+    }
+    range.m_path = entry.m_path;
+    range.m_offset = entry.m_offset;
+    range.m_size = fileSize - entry.m_offset;
+    if ( 0 != entry.m_size ) {
+        range.m_size = std::min( range.m_size, entry.m_size );
+    }
+
+    return true;
+}
+
+ui64 AccessTrace::prefetchRange( const Range &range, std::vector<uc8> &scratch ) const {
+    ui64 done( 0 );
+#ifdef OSRE_GNU_LINUX
+    ( void ) scratch;
+    const int fd( ::open( range.m_path.c_str(), O_RDONLY | O_CLOEXEC ) );
+    if ( fd < 0 ) {
+        return 0;
+    }
+    while ( done < range.m_size && !m_cancel ) {
+        const ui64 size( std::min( PrefetchChunkSize, range.m_size - done ) );
+        if ( 0 != ::posix_fadvise( fd, static_cast<off_t>( range.m_offset + done ), static_cast<off_t>( size ), 
+                POSIX_FADV_WILLNEED ) ) {
+            break;
+        }
+        done += size;
+    }
+    ::close( fd );
+#else
+    // Without an advice API the ranges are read, which fills the block cache as well
+    FILE *file( ::fopen( range.m_path.c_str(), "rb" ) );
+    if ( nullptr == file ) {
+        return 0;
+    }
+#   ifdef OSRE_WINDOWS
+    const bool ok( 0 == ::_fseeki64( file, static_cast<i64>( range.m_offset ), SEEK_SET ) );
+#   else
+    const bool ok( 0 == ::fseeko( file, static_cast<off_t>( range.m_offset ), SEEK_SET ) );
+#   endif
+    scratch.resize( static_cast<size_t>( std::min<ui64>( PrefetchChunkSize, 256 * 1024 ) ) );
+    while ( ok && done < range.m_size && !m_cancel ) {
+        const size_t size( static_cast<size_t>( std::min<ui64>( scratch.size(), range.m_size - done ) ) );
+        const size_t bytesRead( ::fread( &scratch[ 0 ], 1, size, file ) );
+        done += bytesRead;
+        if ( bytesRead != size ) {
+            break;
+        }
+    }
+    ::fclose( file );
+#endif
+
+    return done;
+}
+
+} // Namespace IO
+} // Namespace OSRE
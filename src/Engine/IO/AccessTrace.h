@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OSRE {
+namespace IO {
+
+//--------------------------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	This class records the file accesses at startup and prefetches them on the next start. 
+///
+/// The recording keeps the path, the range and the time since the start of every access during the first minute. 
+/// The prefetch sorts the ranges of a trace by their position on the disk and hands them to the OS in that order 
+/// on a background thread, so the files are in the block cache before the engine asks for them. On Linux the 
+/// position is read by FIEMAP and the ranges are prefetched by posix_fadvise, on other platforms the ranges are 
+/// read in path order into a scratch buffer.
+//--------------------------------------------------------------------------------------------------------------------
+class AccessTrace {
+public:
+    /// An access.
+    struct Entry {
+        String m_path;
+        ui64 m_offset;
+        ui64 m_size;        ///< 0 up to the end of the file.
+        ui32 m_time;        ///< Milliseconds since the start of the recording.
+    };
+
+    /// Accesses later than this are not part of the startup and will not be recorded.
+    static const ui32 MaxRecordTime;
+    /// The recording stops at this number of accesses.
+    static const ui32 MaxEntries;
+
+    /// The class constructor.
+    AccessTrace();
+    /// The class destructor, cancels the prefetch.
+    ~AccessTrace();
+    /// Starts a new recording.
+    void startRecording();
+    /// Stops the recording.
+    void stopRecording();
+    /// Returns true while recording.
+    bool isRecording() const;
+    /// Records an access, size 0 means up to the end of the file.
+    void record( const String &path, ui64 offset, ui64 size );
+    /// Returns the recorded accesses, merged.
+    void getEntries( std::vector<Entry> &entries ) const;
+    /// Writes the recorded accesses to a trace file.
+    bool save( const String &filename ) const;
+    /// Reads a trace file.
+    static bool load( const String &filename, std::vector<Entry> &entries );
+    /// Sorts the accesses by path and offset and merges the overlapping ranges of a file.
+    static void merge( std::vector<Entry> &entries );
+    /// Starts prefetching on a background thread, up to budget bytes.
+    void startPrefetch( const std::vector<Entry> &entries, ui64 budget );
+    /// Waits until the prefetch is done.
+    void waitForPrefetch();
+    /// Returns the number of bytes handed to the OS for prefetching.
+    ui64 getNumPrefetchedBytes() const;
+
+    OSRE_NON_COPYABLE( AccessTrace )
+
+private:
+    struct Range {
+        String m_path;
+        ui64 m_offset;
+        ui64 m_size;
+        ui64 m_diskPos;
+    };
+
+    void prefetchMain( std::vector<Entry> entries, ui64 budget );
+    bool locate( const Entry &entry, Range &range ) const;
+    ui64 prefetchRange( const Range &range, std::vector<uc8> &scratch ) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::atomic<bool> m_recording;
+    std::chrono::steady_clock::time_point m_start;
+    std::thread m_prefetcher;
+    std::atomic<bool> m_cancel;
+    std::atomic<ui64> m_prefetchedBytes;
+};
+
+} // Namespace IO
+} // Namespace OSRE
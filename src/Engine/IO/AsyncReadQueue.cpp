@@ -0,0 +1,512 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "AsyncReadQueue.h"
+
+#include <osre/Common/Logger.h>
+#include <osre/IO/AbstractFileSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#ifdef OSRE_WINDOWS
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+#ifdef OSRE_HAS_IO_URING
+#   include <linux/io_uring.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <sys/uio.h>
+#endif
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "AsyncReadQueue";
+
+#ifdef OSRE_HAS_IO_URING
+
+// Cleared when the kernel refuses io_uring, all threads use pread from then on
+static std::atomic<bool> s_uringAvailable( true );
+
+// A minimal io_uring, set up by the system calls directly to avoid a dependency to liburing. Every IO 
+// thread owns one ring, rings must not be shared between threads.
+class UringReader {
+public:
+    UringReader()
+    : m_ringFd( -1 )
+    , m_params()
+    , m_sqPtr( nullptr )
+    , m_cqPtr( nullptr )
+    , m_sqes( nullptr )
+    , m_sqSize( 0 )
+    , m_cqSize( 0 )
+    , m_poisoned( false ) {
+        // empty
+    }
+
+    ~UringReader() {
+        if ( nullptr != m_sqes ) {
+            ::munmap( m_sqes, m_params.sq_entries * sizeof( io_uring_sqe ) );
+        }
+        if ( nullptr != m_cqPtr && m_cqPtr != m_sqPtr ) {
+            ::munmap( m_cqPtr, m_cqSize );
+        }
+        if ( nullptr != m_sqPtr ) {
+            ::munmap( m_sqPtr, m_sqSize );
+        }
+        if ( -1 != m_ringFd ) {
+            ::close( m_ringFd );
+        }
+    }
+
+    bool init( ui32 entries ) {
+        ::memset( &m_params, 0, sizeof( m_params ) );
+        m_ringFd = static_cast<int>( ::syscall( __NR_io_uring_setup, entries, &m_params ) );
+        if ( m_ringFd < 0 ) {
+            return false;
+        }
+
+        m_sqSize = m_params.sq_off.array + m_params.sq_entries * sizeof( ui32 );
+        m_cqSize = m_params.cq_off.cqes + m_params.cq_entries * sizeof( io_uring_cqe );
+        const bool singleMap( 0 != ( m_params.features & IORING_FEAT_SINGLE_MMAP ) );
+        if ( singleMap ) {
+            m_sqSize = m_cqSize = std::max( m_sqSize, m_cqSize );
+        }
+        m_sqPtr = mapRing( m_sqSize, IORING_OFF_SQ_RING );
+        m_cqPtr = singleMap ? m_sqPtr : mapRing( m_cqSize, IORING_OFF_CQ_RING );
+        m_sqes = static_cast<io_uring_sqe*>( mapRing( m_params.sq_entries * sizeof( io_uring_sqe ), IORING_OFF_SQES ) );
+
+        return nullptr != m_sqPtr && nullptr != m_cqPtr && nullptr != m_sqes;
+    }
+
+    // Reads the ranges, returns false when the ring failed and the ranges have to be read another way
+    bool read( int fd, ui32 count, const ui64 *offsets, const ui32 *sizes, uc8 *const *dsts, i32 *results ) {
+        std::vector<iovec> iovs( count );
+        ui32 *sqTail( getSq<ui32>( m_params.sq_off.tail ) );
+        const ui32 sqMask( *getSq<ui32>( m_params.sq_off.ring_mask ) );
+        ui32 *sqArray( getSq<ui32>( m_params.sq_off.array ) );
+
+        ui32 submitted( 0 );
+        while ( submitted < count ) {
+            // Submit as many reads as the ring takes
+            const ui32 num( std::min( count - submitted, m_params.sq_entries ) );
+            ui32 tail( *sqTail );
+            for ( ui32 i = submitted; i < submitted + num; ++i ) {
+                iovs[ i ].iov_base = dsts[ i ];
+                iovs[ i ].iov_len = sizes[ i ];
+                const ui32 idx( tail & sqMask );
+                io_uring_sqe *sqe( &m_sqes[ idx ] );
+                ::memset( sqe, 0, sizeof( io_uring_sqe ) );
+                sqe->opcode = IORING_OP_READV;
+                sqe->fd = fd;
+                sqe->addr = reinterpret_cast<ui64>( &iovs[ i ] );
+                sqe->len = 1;
+                sqe->off = offsets[ i ];
+                sqe->user_data = i;
+                sqArray[ idx ] = idx;
+                ++tail;
+            }
+            __atomic_store_n( sqTail, tail, __ATOMIC_RELEASE );
+
+            // Wait for all completions of this round
+            ui32 numDone( 0 ), toSubmit( num );
+            while ( numDone < num ) {
+                const long res( ::syscall( __NR_io_uring_enter, m_ringFd, toSubmit, num - numDone, IORING_ENTER_GETEVENTS, nullptr, 0 ) );
+                if ( res < 0 && EINTR != errno ) {
+                    // The submitted reads still write into the buffers, so they are reaped before giving up
+                    drain( num - toSubmit - numDone );
+                    m_poisoned = true;
+                    return false;
+                }
+                if ( res > 0 ) {
+                    toSubmit -= std::min( toSubmit, static_cast<ui32>( res ) );
+                }
+                numDone += reap( results );
+            }
+            submitted += num;
+        }
+
+        return true;
+    }
+
+    // Returns true, when the ring failed and must not be used anymore
+    bool isPoisoned() const {
+        return m_poisoned;
+    }
+
+private:
+    // Takes all completions from the ring, the results are stored when results is not nullptr
+    ui32 reap( i32 *results ) {
+        ui32 *cqHead( getCq<ui32>( m_params.cq_off.head ) );
+        ui32 *cqTail( getCq<ui32>( m_params.cq_off.tail ) );
+        const ui32 cqMask( *getCq<ui32>( m_params.cq_off.ring_mask ) );
+        io_uring_cqe *cqes( getCq<io_uring_cqe>( m_params.cq_off.cqes ) );
+
+        ui32 numDone( 0 );
+        ui32 head( *cqHead );
+        const ui32 cqTailValue( __atomic_load_n( cqTail, __ATOMIC_ACQUIRE ) );
+        while ( head != cqTailValue ) {
+            if ( nullptr != results ) {
+                const io_uring_cqe &cqe( cqes[ head & cqMask ] );
+                results[ cqe.user_data ] = cqe.res;
+            }
+            ++head;
+            ++numDone;
+        }
+        __atomic_store_n( cqHead, head, __ATOMIC_RELEASE );
+
+        return numDone;
+    }
+
+    // Waits until the reads in flight are completed. When the ring cannot be entered anymore the 
+    // completions are still posted by the kernel, so the ring is polled.
+    void drain( ui32 numInFlight ) {
+        numInFlight -= std::min( numInFlight, reap( nullptr ) );
+        while ( numInFlight > 0 ) {
+            const long res( ::syscall( __NR_io_uring_enter, m_ringFd, 0, numInFlight, IORING_ENTER_GETEVENTS, nullptr, 0 ) );
+            if ( res < 0 && EINTR != errno ) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+            numInFlight -= std::min( numInFlight, reap( nullptr ) );
+        }
+    }
+
+    void *mapRing( size_t size, off_t offset ) {
+        void *ptr( ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, offset ) );
+        return MAP_FAILED == ptr ? nullptr : ptr;
+    }
+
+    template<class T>
+    T *getSq( ui32 offset ) const {
+        return reinterpret_cast<T*>( static_cast<uc8*>( m_sqPtr ) + offset );
+    }
+
+    template<class T>
+    T *getCq( ui32 offset ) const {
+        return reinterpret_cast<T*>( static_cast<uc8*>( m_cqPtr ) + offset );
+    }
+
+private:
+    int m_ringFd;
+    io_uring_params m_params;
+    void *m_sqPtr;
+    void *m_cqPtr;
+    io_uring_sqe *m_sqes;
+    size_t m_sqSize;
+    size_t m_cqSize;
+    bool m_poisoned;
+};
+
+static std::unique_ptr<UringReader> &getThreadUringReader() {
+    static thread_local std::unique_ptr<UringReader> reader;
+    return reader;
+}
+
+static UringReader *getUringReader() {
+    static const ui32 NumEntries = 64;
+    std::unique_ptr<UringReader> &reader( getThreadUringReader() );
+    if ( nullptr == reader && s_uringAvailable ) {
+        reader.reset( new UringReader );
+        if ( !reader->init( NumEntries ) ) {
+            osre_debug( Tag, "io_uring is not available, using pread." );
+            s_uringAvailable = false;
+            reader.reset();
+        }
+    }
+
+    return reader.get();
+}
+
+// A ring which failed is drained already, it is closed and io_uring is not used anymore
+static void releaseUringReader() {
+    osre_debug( Tag, "io_uring failed, using pread." );
+    s_uringAvailable = false;
+    getThreadUringReader().reset();
+}
+
+#endif // OSRE_HAS_IO_URING
+
+AsyncReadQueue::AsyncReadQueue( ui32 numThreads )
+: m_pool( static_cast<i32>( numThreads ) )
+, m_mutex()
+, m_pending()
+, m_batchDepth( 0 )
+, m_numRequests( 0 )
+, m_numReads( 0 ) {
+    // empty
+}
+
+AsyncReadQueue::~AsyncReadQueue() {
+    m_batchDepth = 0;
+    size_t numPending( 0 );
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        numPending = m_pending.size();
+    }
+    for ( size_t i = 0; i < numPending; ++i ) {
+        m_pool.enqueue( [ this ] { processFile(); } );
+    }
+    m_pool.waitForAll();
+}
+
+void AsyncReadQueue::enqueue( const Request &request ) {
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pending.push_back( request );
+        if ( m_batchDepth > 0 ) {
+            return;
+        }
+    }
+
+    m_pool.enqueue( [ this ] { processFile(); } );
+}
+
+void AsyncReadQueue::beginBatch() {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    ++m_batchDepth;
+}
+
+void AsyncReadQueue::endBatch() {
+    size_t numJobs( 0 );
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( 0 == m_batchDepth ) {
+            return;
+        }
+        --m_batchDepth;
+        if ( 0 != m_batchDepth ) {
+            return;
+        }
+
+        // One job per file, every job takes all requests of a file
+        std::vector<String> files;
+        for ( const Request &request : m_pending ) {
+            if ( files.end() == std::find( files.begin(), files.end(), request.m_file.getUri() ) ) {
+                files.push_back( request.m_file.getUri() );
+            }
+        }
+        numJobs = files.size();
+    }
+
+    for ( size_t i = 0; i < numJobs; ++i ) {
+        m_pool.enqueue( [ this ] { processFile(); } );
+    }
+}
+
+void AsyncReadQueue::waitForAll() {
+    m_pool.waitForAll();
+}
+
+void AsyncReadQueue::getStatistics( ui64 &numRequests, ui64 &numReads ) const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    numRequests = m_numRequests;
+    numReads = m_numReads;
+}
+
+void AsyncReadQueue::processFile() {
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( m_pending.empty() ) {
+            return;
+        }
+
+        const String file( m_pending.front().m_file.getUri() );
+        for ( std::deque<Request>::iterator it = m_pending.begin(); it != m_pending.end(); ) {
+            if ( it->m_file.getUri() == file ) {
+                requests.push_back( *it );
+                it = m_pending.erase( it );
+            } else {
+                ++it;
+            }
+        }
+    }
+    std::stable_sort( requests.begin(), requests.end(), []( const Request &a, const Request &b ) { 
+        return a.m_offset < b.m_offset; 
+    } );
+
+    // Neighbouring ranges are read at once into a temporary buffer
+    std::vector<Segment> segments;
+    std::vector<ui32> segmentOf( requests.size() );
+    std::vector<ui32> numRequests;
+    for ( size_t i = 0; i < requests.size(); ++i ) {
+        const Request &request( requests[ i ] );
+        const ui64 end( request.m_offset + request.m_size );
+        if ( !segments.empty() ) {
+            Segment &last( segments.back() );
+            const ui64 lastEnd( last.m_offset + last.m_size );
+            if ( request.m_offset <= lastEnd + MaxGap && std::max( end, lastEnd ) - last.m_offset <= MaxCoalescedSize ) {
+                last.m_size = static_cast<ui32>( std::max( end, lastEnd ) - last.m_offset );
+                segmentOf[ i ] = static_cast<ui32>( segments.size() - 1 );
+                ++numRequests.back();
+                continue;
+            }
+        }
+
+        Segment segment;
+        segment.m_offset = request.m_offset;
+        segment.m_size = request.m_size;
+        segment.m_dst = request.m_buffer;
+        segment.m_bytesRead = 0;
+        segment.m_ok = false;
+        segments.push_back( segment );
+        segmentOf[ i ] = static_cast<ui32>( segments.size() - 1 );
+        numRequests.push_back( 1 );
+    }
+
+    std::vector<std::vector<uc8>> buffers( segments.size() );
+    for ( size_t i = 0; i < segments.size(); ++i ) {
+        if ( numRequests[ i ] > 1 ) {
+            buffers[ i ].resize( segments[ i ].m_size );
+            segments[ i ].m_dst = buffers[ i ].empty() ? nullptr : &buffers[ i ][ 0 ];
+        }
+    }
+
+    readSegments( requests.front().m_file, requests.front().m_fileSystem, segments );
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_numRequests += requests.size();
+        m_numReads += segments.size();
+    }
+
+    for ( size_t i = 0; i < requests.size(); ++i ) {
+        const Request &request( requests[ i ] );
+        const ui32 segIdx( segmentOf[ i ] );
+        const Segment &segment( segments[ segIdx ] );
+        ui32 bytesRead( segment.m_bytesRead );
+        if ( numRequests[ segIdx ] > 1 ) {
+            const ui64 rel( request.m_offset - segment.m_offset );
+            bytesRead = segment.m_bytesRead > rel ? static_cast<ui32>( std::min<ui64>( request.m_size, segment.m_bytesRead - rel ) ) : 0;
+            if ( bytesRead > 0 ) {
+                ::memcpy( request.m_buffer, segment.m_dst + rel, bytesRead );
+            }
+        }
+        if ( request.m_callback ) {
+            request.m_callback( segment.m_ok, bytesRead );
+        }
+    }
+}
+
+bool AsyncReadQueue::readSegments( const Uri &file, AbstractFileSystem *fileSystem, std::vector<Segment> &segments ) {
+    if ( "file" != file.getScheme() ) {
+        // Other schemes are read through their streams, the IOService only queues thread-safe file systems
+        if ( nullptr == fileSystem || !fileSystem->isThreadSafe() ) {
+            return false;
+        }
+        Stream *stream( fileSystem->open( file, Stream::AccessMode::ReadAccessBinary ) );
+        if ( nullptr == stream ) {
+            return false;
+        }
+        for ( Segment &segment : segments ) {
+            segment.m_bytesRead = 0 == segment.m_size ? 0 : stream->readAt( segment.m_offset, segment.m_dst, segment.m_size );
+            segment.m_ok = true;
+        }
+        fileSystem->close( &stream );
+
+        return true;
+    }
+
+#ifdef OSRE_WINDOWS
+    HANDLE handle( ::CreateFileA( file.getAbsPath().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 
+            FILE_ATTRIBUTE_NORMAL, nullptr ) );
+    if ( INVALID_HANDLE_VALUE == handle ) {
+        return false;
+    }
+    for ( Segment &segment : segments ) {
+        OVERLAPPED overlapped;
+        ::memset( &overlapped, 0, sizeof( overlapped ) );
+        overlapped.Offset = static_cast<DWORD>( segment.m_offset & 0xFFFFFFFF );
+        overlapped.OffsetHigh = static_cast<DWORD>( segment.m_offset >> 32 );
+        DWORD bytesRead( 0 );
+        segment.m_ok = 0 == segment.m_size || FALSE != ::ReadFile( handle, segment.m_dst, segment.m_size, &bytesRead, &overlapped ) 
+                || ERROR_HANDLE_EOF == ::GetLastError();
+        segment.m_bytesRead = static_cast<ui32>( bytesRead );
+    }
+    ::CloseHandle( handle );
+#else
+    const int fd( ::open( file.getAbsPath().c_str(), O_RDONLY ) );
+    if ( -1 == fd ) {
+        return false;
+    }
+
+    bool done( false );
+#ifdef OSRE_HAS_IO_URING
+    // All ranges of the file are submitted at once, short reads are completed below
+    UringReader *reader( segments.size() > 1 ? getUringReader() : nullptr );
+    if ( nullptr != reader ) {
+        const ui32 count( static_cast<ui32>( segments.size() ) );
+        std::vector<ui64> offsets( count );
+        std::vector<ui32> sizes( count );
+        std::vector<uc8*> dsts( count );
+        std::vector<i32> results( count, 0 );
+        for ( ui32 i = 0; i < count; ++i ) {
+            offsets[ i ] = segments[ i ].m_offset;
+            sizes[ i ] = segments[ i ].m_size;
+            dsts[ i ] = segments[ i ].m_dst;
+        }
+        if ( reader->read( fd, count, &offsets[ 0 ], &sizes[ 0 ], &dsts[ 0 ], &results[ 0 ] ) ) {
+            for ( ui32 i = 0; i < count; ++i ) {
+                segments[ i ].m_ok = results[ i ] >= 0;
+                segments[ i ].m_bytesRead = results[ i ] > 0 ? static_cast<ui32>( results[ i ] ) : 0;
+            }
+            done = true;
+        } else if ( reader->isPoisoned() ) {
+            releaseUringReader();
+        }
+    }
+#endif
+    for ( Segment &segment : segments ) {
+        if ( done && !segment.m_ok ) {
+            continue;
+        }
+        segment.m_ok = true;
+        while ( segment.m_bytesRead < segment.m_size ) {
+            const ssize_t res( ::pread( fd, segment.m_dst + segment.m_bytesRead, segment.m_size - segment.m_bytesRead, 
+                    static_cast<off_t>( segment.m_offset + segment.m_bytesRead ) ) );
+            if ( res < 0 && EINTR == errno ) {
+                continue;
+            }
+            if ( res <= 0 ) {
+                segment.m_ok = 0 == res;
+                break;
+            }
+            segment.m_bytesRead += static_cast<ui32>( res );
+        }
+    }
+    ::close( fd );
+#endif
+
+    return true;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,101 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/IO/IOService.h>
+#include <osre/IO/Uri.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace OSRE {
+namespace IO {
+
+//--------------------------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	This class implements the asynchronous reads of the IOService. 
+///
+/// Requests are executed by a dedicated pool of IO threads. A thread takes all pending requests of one file and 
+/// coalesces neighbouring ranges into one read. On Linux the reads of a file are submitted together by io_uring 
+/// when the kernel supports it, else they are done one after another by pread.
+//--------------------------------------------------------------------------------------------------------------------
+class AsyncReadQueue {
+public:
+    /// A read request.
+    struct Request {
+        Uri m_file;
+        ui64 m_offset;
+        ui32 m_size;
+        uc8 *m_buffer;
+        IOService::ReadCallback m_callback;
+        AbstractFileSystem *m_fileSystem;   ///< The thread-safe file system of other schemes than "file".
+    };
+
+    /// Ranges closer than this are read together.
+    static const ui32 MaxGap = 16 * 1024;
+    /// Coalesced reads will not grow larger than this.
+    static const ui32 MaxCoalescedSize = 4 * 1024 * 1024;
+
+    /// The class constructor with the number of IO threads.
+    explicit AsyncReadQueue( ui32 numThreads );
+    /// The class destructor, waits for all requests.
+    ~AsyncReadQueue();
+    /// Adds a request.
+    void enqueue( const Request &request );
+    /// Holds back the requests until the batch ends, so they can be coalesced.
+    void beginBatch();
+    /// Dispatches the held requests.
+    void endBatch();
+    /// Waits until all dispatched requests are done.
+    void waitForAll();
+    /// Returns the number of requests and of reads done for them.
+    void getStatistics( ui64 &numRequests, ui64 &numReads ) const;
+
+    OSRE_NON_COPYABLE( AsyncReadQueue )
+
+private:
+    struct Segment {
+        ui64 m_offset;
+        ui32 m_size;
+        uc8 *m_dst;
+        ui32 m_bytesRead;
+        bool m_ok;
+    };
+
+    void processFile();
+    bool readSegments( const Uri &file, AbstractFileSystem *fileSystem, std::vector<Segment> &segments );
+
+private:
+    Threading::ThreadPool m_pool;
+    mutable std::mutex m_mutex;
+    std::deque<Request> m_pending;
+    ui32 m_batchDepth;
+    ui64 m_numRequests;
+    ui64 m_numReads;
+};
+
+} // Namespace IO
+} // Namespace OSRE
@@ -24,6 +24,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef OSRE_WINDOWS
+#   include <direct.h>
+#   include <windows.h>
+#else
+#   include <dirent.h>
+#endif
 
 namespace OSRE {
 namespace IO {
@@ -31,12 +37,77 @@ namespace IO {
 bool Directory::exists(const String &dir) {
     struct stat info;
     const int result = ::stat(dir.c_str(), &info);
-    if (info.st_mode & S_IFDIR) {
+    if (0 == result && (info.st_mode & S_IFDIR)) {
         return true;
     }
     return false;
 }
 
+bool Directory::create( const String &dir ) {
+    if ( exists( dir ) ) {
+        return true;
+    }
+
+#ifdef OSRE_WINDOWS
+    return 0 == ::_mkdir( dir.c_str() );
+#else
+    return 0 == ::mkdir( dir.c_str(), 0755 );
+#endif
+}
+
+bool Directory::getFiles( const String &dir, bool recursive, std::vector<String> &files ) {
+    String path( dir );
+    if ( !path.empty() && '/' != path[ path.size() - 1 ] && '\\' != path[ path.size() - 1 ] ) {
+        path += getDirSeparator();
+    }
+
+    std::vector<String> subDirs;
+#ifdef OSRE_WINDOWS
+    WIN32_FIND_DATAA data;
+    HANDLE handle( ::FindFirstFileA( ( path + "*" ).c_str(), &data ) );
+    if ( INVALID_HANDLE_VALUE == handle ) {
+        return false;
+    }
+    do {
+        const String name( data.cFileName );
+        if ( "." == name || ".." == name ) {
+            continue;
+        }
+        if ( 0 != ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) ) {
+            subDirs.push_back( path + name );
+        } else {
+            files.push_back( path + name );
+        }
+    } while ( ::FindNextFileA( handle, &data ) );
+    ::FindClose( handle );
+#else
+    DIR *handle( ::opendir( dir.c_str() ) );
+    if ( nullptr == handle ) {
+        return false;
+    }
+    for ( struct dirent *entry = ::readdir( handle ); nullptr != entry; entry = ::readdir( handle ) ) {
+        const String name( entry->d_name );
+        if ( "." == name || ".." == name ) {
+            continue;
+        }
+        if ( exists( path + name ) ) {
+            subDirs.push_back( path + name );
+        } else {
+            files.push_back( path + name );
+        }
+    }
+    ::closedir( handle );
+#endif
+
+    if ( recursive ) {
+        for ( const String &subDir : subDirs ) {
+            getFiles( subDir, recursive, files );
+        }
+    }
+
+    return true;
+}
+
 String Directory::getDirSeparator() {
 #ifdef OSRE_WINDOWS
     static String sep = "\\";
@@ -0,0 +1,601 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/IO/FileMetadataCache.h>
+#include <osre/Common/Logger.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef OSRE_WINDOWS
+#   include <windows.h>
+#else
+#   include <dirent.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+#ifdef OSRE_GNU_LINUX
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <sys/inotify.h>
+#endif
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "FileMetadataCache";
+
+// The empty path is the current directory
+static String toSystemPath( const String &path ) {
+    return path.empty() ? String( "." ) : path;
+}
+
+static String joinPath( const String &dir, const String &name ) {
+    if ( dir.empty() ) {
+        return name;
+    }
+
+    return '/' == dir[ dir.size() - 1 ] ? dir + name : dir + "/" + name;
+}
+
+static bool statPath( const String &path, FileMetadataCache::FileInfo &info ) {
+#ifdef OSRE_WINDOWS
+    struct __stat64 fileStat;
+    if ( 0 != ::_stat64( toSystemPath( path ).c_str(), &fileStat ) ) {
+        return false;
+    }
+    info.m_isDirectory = 0 != ( fileStat.st_mode & _S_IFDIR );
+#else
+    struct stat fileStat;
+    if ( 0 != ::stat( toSystemPath( path ).c_str(), &fileStat ) ) {
+        return false;
+    }
+    info.m_isDirectory = S_ISDIR( fileStat.st_mode );
+#endif
+    info.m_size = info.m_isDirectory ? 0 : static_cast<ui64>( fileStat.st_size );
+    info.m_modified = static_cast<i64>( fileStat.st_mtime );
+
+    return true;
+}
+
+FileMetadataCache::FileMetadataCache()
+: m_entries()
+, m_roots()
+, m_pendingRoots()
+, m_changes()
+, m_listeners()
+, m_nextListenerId( 1 )
+, m_mutex()
+, m_watches()
+, m_inotifyFd( -1 )
+, m_wakeFd( -1 )
+, m_watcherStarted()
+, m_watcher()
+, m_scanPoolCreated()
+, m_scanPool() {
+    // empty
+}
+
+FileMetadataCache::~FileMetadataCache() {
+    // Deferred scans may start the watcher, so they are finished before it is stopped
+    if ( nullptr != m_scanPool ) {
+        m_scanPool->waitForAll();
+    }
+#ifdef OSRE_GNU_LINUX
+    if ( m_watcher.joinable() ) {
+        const uint64_t value( 1 );
+        if ( sizeof( value ) == ::write( m_wakeFd, &value, sizeof( value ) ) ) {
+            m_watcher.join();
+        } else {
+            m_watcher.detach();
+        }
+    }
+    if ( m_inotifyFd >= 0 ) {
+        ::close( m_inotifyFd );
+    }
+    if ( m_wakeFd >= 0 ) {
+        ::close( m_wakeFd );
+    }
+#endif
+}
+
+bool FileMetadataCache::addRoot( const String &root ) {
+    const String normalized( normalizePath( root ) );
+    FileInfo info;
+    if ( !statPath( normalized, info ) || !info.m_isDirectory ) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( m_roots.end() != std::find( m_roots.begin(), m_roots.end(), normalized ) ) {
+            return true;
+        }
+    }
+
+    std::call_once( m_watcherStarted, &FileMetadataCache::startWatching, this );
+    EntryList entries;
+    entries.push_back( std::make_pair( normalized, info ) );
+    scanTree( normalized, entries );
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_pendingRoots.erase( std::remove( m_pendingRoots.begin(), m_pendingRoots.end(), normalized ), m_pendingRoots.end() );
+    if ( m_roots.end() == std::find( m_roots.begin(), m_roots.end(), normalized ) ) {
+        m_roots.push_back( normalized );
+    }
+    for ( const std::pair<String, FileInfo> &entry : entries ) {
+        m_entries[ entry.first ] = entry.second;
+    }
+
+    return true;
+}
+
+void FileMetadataCache::addRootDeferred( const String &root ) {
+    const String normalized( normalizePath( root ) );
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( m_roots.end() != std::find( m_roots.begin(), m_roots.end(), normalized ) 
+                || m_pendingRoots.end() != std::find( m_pendingRoots.begin(), m_pendingRoots.end(), normalized ) ) {
+            return;
+        }
+        m_pendingRoots.push_back( normalized );
+    }
+
+    getScanPool().enqueue( [ this, normalized ]() {
+        if ( !addRoot( normalized ) ) {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_pendingRoots.erase( std::remove( m_pendingRoots.begin(), m_pendingRoots.end(), normalized ), m_pendingRoots.end() );
+        }
+    } );
+}
+
+void FileMetadataCache::waitForScans() {
+    getScanPool().waitForAll();
+}
+
+void FileMetadataCache::removeRoot( const String &root ) {
+    const String normalized( normalizePath( root ) );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    std::vector<String>::iterator it( std::find( m_roots.begin(), m_roots.end(), normalized ) );
+    if ( m_roots.end() == it ) {
+        return;
+    }
+    m_roots.erase( it );
+    removeTree( normalized );
+}
+
+void FileMetadataCache::refresh() {
+    std::vector<String> roots;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        roots = m_roots;
+    }
+
+    for ( const String &root : roots ) {
+        EntryList entries;
+        FileInfo info;
+        if ( statPath( root, info ) ) {
+            entries.push_back( std::make_pair( root, info ) );
+            scanTree( root, entries );
+        }
+
+        // The scan has added the watches again and got the same descriptors back, so only the 
+        // entries are replaced. Watches of removed directories are dropped by IN_IGNORED.
+        std::lock_guard<std::mutex> lock( m_mutex );
+        removeEntries( root );
+        for ( const std::pair<String, FileInfo> &entry : entries ) {
+            m_entries[ entry.first ] = entry.second;
+        }
+    }
+}
+
+void FileMetadataCache::update( const String &path ) {
+    const String normalized( normalizePath( path ) );
+    FileInfo info;
+    const bool exists( statPath( normalized, info ) );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( !isCovered( normalized ) ) {
+        return;
+    }
+    if ( exists ) {
+        m_entries[ normalized ] = info;
+    } else {
+        removeTree( normalized );
+    }
+}
+
+FileMetadataCache::Lookup FileMetadataCache::stat( const String &path, FileInfo *info ) const {
+    const String normalized( normalizePath( path ) );
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if ( !isCovered( normalized ) ) {
+        return Lookup::NotCovered;
+    }
+
+    std::unordered_map<String, FileInfo>::const_iterator it( m_entries.find( normalized ) );
+    if ( m_entries.end() != it ) {
+        if ( nullptr != info ) {
+            *info = it->second;
+        }
+        return Lookup::Found;
+    }
+    lock.unlock();
+
+    // Files written by others are cached only when the watcher has seen them, so a miss is checked. 
+    // The result is not stored, a later event of the watcher would be overwritten by it.
+    FileInfo current;
+    if ( !statPath( normalized, current ) ) {
+        return Lookup::Missing;
+    }
+    if ( nullptr != info ) {
+        *info = current;
+    }
+
+    return Lookup::Found;
+}
+
+ui32 FileMetadataCache::addListener( const ChangeCallback &callback ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const ui32 id( m_nextListenerId++ );
+    m_listeners.push_back( std::make_pair( id, callback ) );
+
+    return id;
+}
+
+void FileMetadataCache::removeListener( ui32 id ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    for ( size_t i = 0; i < m_listeners.size(); ++i ) {
+        if ( id == m_listeners[ i ].first ) {
+            m_listeners.erase( m_listeners.begin() + i );
+            return;
+        }
+    }
+}
+
+void FileMetadataCache::dispatchChanges() {
+    std::vector<std::pair<String, Change>> changes;
+    std::vector<std::pair<ui32, ChangeCallback>> listeners;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        changes.swap( m_changes );
+        listeners = m_listeners;
+    }
+
+    for ( const std::pair<String, Change> &change : changes ) {
+        for ( const std::pair<ui32, ChangeCallback> &listener : listeners ) {
+            listener.second( change.first, change.second );
+        }
+    }
+}
+
+size_t FileMetadataCache::getNumEntries() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_entries.size();
+}
+
+bool FileMetadataCache::isWatching() const {
+    return m_watcher.joinable();
+}
+
+String FileMetadataCache::normalizePath( const String &path ) {
+    const bool absolute( !path.empty() && ( '/' == path[ 0 ] || '\\' == path[ 0 ] ) );
+    String normalized;
+    normalized.reserve( path.size() );
+    String::size_type begin( 0 );
+    while ( begin < path.size() ) {
+        String::size_type end( path.find_first_of( "/\\", begin ) );
+        if ( String::npos == end ) {
+            end = path.size();
+        }
+        if ( end > begin && !( 1 == end - begin && '.' == path[ begin ] ) ) {
+            if ( !normalized.empty() || absolute ) {
+                normalized += '/';
+            }
+            normalized.append( path, begin, end - begin );
+        }
+        begin = end + 1;
+    }
+    if ( normalized.empty() && absolute ) {
+        normalized = "/";
+    }
+
+    return normalized;
+}
+
+Threading::ThreadPool &FileMetadataCache::getScanPool() {
+    // One pool for all scans, it is created with the first one
+    std::call_once( m_scanPoolCreated, [ this ]() {
+        m_scanPool.reset( new Threading::ThreadPool );
+    } );
+
+    return *m_scanPool;
+}
+
+bool FileMetadataCache::isCovered( const String &path ) const {
+    for ( const String &root : m_roots ) {
+        if ( root.empty() ) {
+            // The current directory covers all relative paths
+            if ( path.empty() || '/' != path[ 0 ] ) {
+                return true;
+            }
+        } else if ( 0 == path.compare( 0, root.size(), root ) 
+                && ( path.size() == root.size() || '/' == path[ root.size() ] || '/' == root[ root.size() - 1 ] ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FileMetadataCache::scanTree( const String &root, EntryList &entries ) {
+    std::vector<String> subDirs;
+    scanDirectory( root, entries, subDirs );
+    if ( subDirs.size() < 2 ) {
+        for ( const String &subDir : subDirs ) {
+            walkTree( subDir, entries );
+        }
+        return;
+    }
+
+    // The subdirectories are scanned in parallel
+    std::vector<EntryList> results( subDirs.size() );
+    getScanPool().parallelFor( static_cast<ui32>( subDirs.size() ), 1, [ & ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            walkTree( subDirs[ i ], results[ i ] );
+        }
+    } );
+    for ( const EntryList &result : results ) {
+        entries.insert( entries.end(), result.begin(), result.end() );
+    }
+}
+
+void FileMetadataCache::walkTree( const String &dir, EntryList &entries ) {
+    std::vector<String> dirs( 1, dir );
+    while ( !dirs.empty() ) {
+        const String current( dirs.back() );
+        dirs.pop_back();
+        scanDirectory( current, entries, dirs );
+    }
+}
+
+void FileMetadataCache::scanDirectory( const String &dir, EntryList &entries, std::vector<String> &subDirs ) {
+    // Watch first, so no change gets lost between listing and watching
+    watchDirectory( dir );
+
+    FileInfo info;
+#ifdef OSRE_WINDOWS
+    WIN32_FIND_DATAA data;
+    HANDLE handle( ::FindFirstFileA( joinPath( toSystemPath( dir ), "*" ).c_str(), &data ) );
+    if ( INVALID_HANDLE_VALUE == handle ) {
+        return;
+    }
+    do {
+        const String name( data.cFileName );
+        if ( "." == name || ".." == name ) {
+            continue;
+        }
+        ULARGE_INTEGER time;
+        time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+        time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+        info.m_isDirectory = 0 != ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
+        info.m_size = info.m_isDirectory ? 0 : ( static_cast<ui64>( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+        info.m_modified = static_cast<i64>( time.QuadPart / 10000000ull ) - 11644473600ll;
+        const String path( joinPath( dir, name ) );
+        entries.push_back( std::make_pair( path, info ) );
+        if ( info.m_isDirectory ) {
+            subDirs.push_back( path );
+        }
+    } while ( ::FindNextFileA( handle, &data ) );
+    ::FindClose( handle );
+#else
+    DIR *handle( ::opendir( toSystemPath( dir ).c_str() ) );
+    if ( nullptr == handle ) {
+        return;
+    }
+    const int fd( ::dirfd( handle ) );
+    for ( struct dirent *entry = ::readdir( handle ); nullptr != entry; entry = ::readdir( handle ) ) {
+        const String name( entry->d_name );
+        struct stat fileStat;
+        if ( "." == name || ".." == name || 0 != ::fstatat( fd, entry->d_name, &fileStat, 0 ) ) {
+            continue;
+        }
+        info.m_isDirectory = S_ISDIR( fileStat.st_mode );
+        info.m_size = info.m_isDirectory ? 0 : static_cast<ui64>( fileStat.st_size );
+        info.m_modified = static_cast<i64>( fileStat.st_mtime );
+        const String path( joinPath( dir, name ) );
+        entries.push_back( std::make_pair( path, info ) );
+        if ( info.m_isDirectory ) {
+            subDirs.push_back( path );
+        }
+    }
+    ::closedir( handle );
+#endif
+}
+
+void FileMetadataCache::removeTree( const String &path ) {
+    removeEntries( path );
+    removeWatches( path );
+}
+
+void FileMetadataCache::removeEntries( const String &path ) {
+    const String prefix( joinPath( path, "" ) );
+    m_entries.erase( path );
+    for ( std::unordered_map<String, FileInfo>::iterator it = m_entries.begin(); it != m_entries.end(); ) {
+        if ( 0 == it->first.compare( 0, prefix.size(), prefix ) ) {
+            it = m_entries.erase( it );
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileMetadataCache::removeWatches( const String &path ) {
+#ifdef OSRE_GNU_LINUX
+    // Directories moved away keep their watches, they would report the old paths
+    const String prefix( joinPath( path, "" ) );
+    for ( std::unordered_map<i32, String>::iterator it = m_watches.begin(); it != m_watches.end(); ) {
+        if ( path == it->second || 0 == it->second.compare( 0, prefix.size(), prefix ) ) {
+            ::inotify_rm_watch( m_inotifyFd, it->first );
+            it = m_watches.erase( it );
+        } else {
+            ++it;
+        }
+    }
+#endif
+}
+
+void FileMetadataCache::addChange( const String &path, Change change ) {
+    if ( !m_listeners.empty() ) {
+        m_changes.push_back( std::make_pair( path, change ) );
+    }
+}
+
+void FileMetadataCache::startWatching() {
+#ifdef OSRE_GNU_LINUX
+    m_inotifyFd = ::inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    m_wakeFd = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    if ( m_inotifyFd >= 0 && m_wakeFd >= 0 ) {
+        m_watcher = std::thread( &FileMetadataCache::watcherMain, this );
+    } else {
+        osre_debug( Tag, "inotify is not available, changes will not be tracked." );
+        if ( m_inotifyFd >= 0 ) {
+            ::close( m_inotifyFd );
+            m_inotifyFd = -1;
+        }
+    }
+#endif
+}
+
+void FileMetadataCache::watchDirectory( const String &dir ) {
+#ifdef OSRE_GNU_LINUX
+    if ( m_inotifyFd < 0 ) {
+        return;
+    }
+
+    const i32 wd( ::inotify_add_watch( m_inotifyFd, toSystemPath( dir ).c_str(), IN_CREATE | IN_DELETE | IN_MODIFY 
+            | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR ) );
+    if ( wd >= 0 ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_watches[ wd ] = dir;
+    }
+#endif
+}
+
+void FileMetadataCache::watcherMain() {
+#ifdef OSRE_GNU_LINUX
+    alignas( struct inotify_event ) c8 buffer[ 4096 ];
+    struct pollfd fds[ 2 ];
+    fds[ 0 ].fd = m_inotifyFd;
+    fds[ 0 ].events = POLLIN;
+    fds[ 1 ].fd = m_wakeFd;
+    fds[ 1 ].events = POLLIN;
+    for ( ;; ) {
+        fds[ 0 ].revents = fds[ 1 ].revents = 0;
+        if ( ::poll( fds, 2, -1 ) < 0 ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            break;
+        }
+        if ( 0 != ( fds[ 1 ].revents & POLLIN ) ) {
+            break;
+        }
+
+        for ( ;; ) {
+            const ssize_t len( ::read( m_inotifyFd, buffer, sizeof( buffer ) ) );
+            if ( len <= 0 ) {
+                break;
+            }
+            for ( ssize_t i = 0; i < len; ) {
+                const struct inotify_event *event( reinterpret_cast<const struct inotify_event*>( buffer + i ) );
+                if ( 0 != ( event->mask & IN_Q_OVERFLOW ) ) {
+                    // Events were lost, only a new scan brings the cache up to date
+                    refresh();
+                } else {
+                    handleEvent( event->wd, event->mask, event->len > 0 ? String( event->name ) : String() );
+                }
+                i += sizeof( struct inotify_event ) + event->len;
+            }
+        }
+    }
+#endif
+}
+
+void FileMetadataCache::handleEvent( i32 wd, ui32 mask, const String &name ) {
+#ifdef OSRE_GNU_LINUX
+    String dir;
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        std::unordered_map<i32, String>::iterator it( m_watches.find( wd ) );
+        if ( m_watches.end() == it ) {
+            return;
+        }
+        if ( 0 != ( mask & IN_IGNORED ) ) {
+            m_watches.erase( it );
+            return;
+        }
+        dir = it->second;
+    }
+
+    const String path( name.empty() ? dir : joinPath( dir, name ) );
+    if ( 0 != ( mask & ( IN_DELETE | IN_MOVED_FROM ) ) ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        removeTree( path );
+        addChange( path, Change::Removed );
+    } else if ( 0 != ( mask & ( IN_CREATE | IN_MOVED_TO ) ) ) {
+        FileInfo info;
+        if ( !statPath( path, info ) ) {
+            return;
+        }
+
+        // A directory may be moved in with its content
+        EntryList entries;
+        entries.push_back( std::make_pair( path, info ) );
+        if ( info.m_isDirectory ) {
+            scanTree( path, entries );
+        }
+        std::lock_guard<std::mutex> lock( m_mutex );
+        for ( const std::pair<String, FileInfo> &entry : entries ) {
+            m_entries[ entry.first ] = entry.second;
+            addChange( entry.first, Change::Created );
+        }
+    } else if ( 0 != ( mask & ( IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB ) ) ) {
+        FileInfo info;
+        if ( !statPath( path, info ) ) {
+            return;
+        }
+
+        // Writes are reported once, when the file gets closed
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_entries[ path ] = info;
+        if ( 0 != ( mask & IN_CLOSE_WRITE ) ) {
+            addChange( path, Change::Modified );
+        }
+    }
+#endif
+}
+
+} // Namespace IO
+} // Namespace OSRE
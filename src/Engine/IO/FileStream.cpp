@@ -23,21 +23,48 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FileStream.h"
 
 #include <osre/Debugging/osre_debugging.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <sys/types.h> 
 #include <sys/stat.h> 
 
+#ifdef OSRE_WINDOWS
+#   include <io.h>
+#   include <windows.h>
+#else
+#   include <unistd.h>
+#endif
+
 namespace OSRE {
 namespace IO {
 
+static bool isReadOnly( Stream::AccessMode mode ) {
+    return Stream::AccessMode::ReadAccess == mode || Stream::AccessMode::ReadAccessBinary == mode;
+}
+
 FileStream::FileStream() noexcept
 : Stream()
-, m_file( nullptr ) {
+, m_file( nullptr )
+, m_bufferSize( DefaultBufferSize )
+, m_buffer()
+, m_bufferStart( 0 )
+, m_bufferPos( 0 )
+, m_bufferFill( 0 )
+, m_size( 0 ) {
     // empty
 }
 
 FileStream::FileStream( const Uri &uri, AccessMode requestedAccess ) 
 : Stream( uri, requestedAccess )
-, m_file( nullptr ) {
+, m_file( nullptr )
+, m_bufferSize( DefaultBufferSize )
+, m_buffer()
+, m_bufferStart( 0 )
+, m_bufferPos( 0 )
+, m_bufferFill( 0 )
+, m_size( 0 ) {
     // empty
 }
 
@@ -90,8 +117,33 @@ bool FileStream::open() {
 #else
     m_file = ::fopen( abspath.c_str(), modestr.c_str() );
 #endif 
+    if ( nullptr == m_file ) {
+        return false;
+    }
+
+    // A read-only file cannot change through the stream, so its size is read once
+    m_bufferStart = 0;
+    m_bufferPos = m_bufferFill = 0;
+    m_size = 0;
+    if ( isReadOnly( mode ) ) {
+#ifdef OSRE_WINDOWS
+        struct __stat64 fileStat;
+        if ( 0 == ::_fstat64( ::_fileno( m_file ), &fileStat ) ) {
+#else
+        struct stat fileStat;
+        if ( 0 == ::fstat( ::fileno( m_file ), &fileStat ) ) {
+#endif
+            m_size = static_cast<ui64>( fileStat.st_size );
+        }
+
+        // The own buffer replaces the one of the runtime
+        if ( 0 != m_bufferSize ) {
+            ::setvbuf( m_file, nullptr, _IONBF, 0 );
+            m_buffer.resize( m_bufferSize );
+        }
+    }
 
-    return ( nullptr != m_file );
+    return true;
 }
 
 bool FileStream::close() {
@@ -103,13 +155,19 @@ bool FileStream::close() {
     if ( m_file ) {
         ::fclose( m_file );
         m_file = nullptr;
+        m_buffer.clear();
+        m_bufferPos = m_bufferFill = 0;
         return true;
     } 
         
     return false;
 }
 
-ui32 FileStream::getSize() const {	
+ui64 FileStream::getSize() const {	
+    if ( isOpen() && isReadOnly( getAccessMode() ) ) {
+        return m_size;
+    }
+
     OSRE_ASSERT( !m_Uri.getAbsPath().empty() );
 
     const String &abspath( m_Uri.getAbsPath() );
@@ -121,7 +179,7 @@ ui32 FileStream::getSize() const {
         return 0;
     }
 
-    return ( static_cast<ui32>( fileStat.st_size ) ); 
+    return ( static_cast<ui64>( fileStat.st_size ) ); 
 #else
     // For unix
     struct stat fileStat; 
@@ -129,7 +187,7 @@ ui32 FileStream::getSize() const {
     if ( 0 != err ) {
         return 0;
     }
-    return  static_cast<ui32>( fileStat.st_size ); 
+    return  static_cast<ui64>( fileStat.st_size ); 
 #endif
 }
 
@@ -143,10 +201,78 @@ ui32 FileStream::read( void *buffer, ui32 size ) {
     }
     
     OSRE_ASSERT( nullptr != m_file );
-    if ( m_file ) {
+    if ( !isBuffered() ) {
         return ( static_cast<ui32>( ::fread( buffer, sizeof( uc8 ), size , m_file ) ) );
-    } 
-    return 0;
+    }
+
+    // Copy what is buffered, large rests are read directly, small ones through the buffer
+    uc8 *dst( static_cast<uc8*>( buffer ) );
+    ui32 done( std::min( size, m_bufferFill - m_bufferPos ) );
+    ::memcpy( dst, &m_buffer[ m_bufferPos ], done );
+    m_bufferPos += done;
+    if ( done < size ) {
+        m_bufferStart += m_bufferFill;
+        m_bufferPos = m_bufferFill = 0;
+        const ui32 rest( size - done );
+        if ( rest >= m_buffer.size() ) {
+            const ui32 bytesRead( static_cast<ui32>( ::fread( dst + done, sizeof( uc8 ), rest, m_file ) ) );
+            m_bufferStart += bytesRead;
+            done += bytesRead;
+        } else {
+            m_bufferFill = static_cast<ui32>( ::fread( &m_buffer[ 0 ], sizeof( uc8 ), m_buffer.size(), m_file ) );
+            m_bufferPos = std::min( rest, m_bufferFill );
+            ::memcpy( dst + done, &m_buffer[ 0 ], m_bufferPos );
+            done += m_bufferPos;
+        }
+    }
+
+    return done;
+}
+
+ui32 FileStream::readAt( Position offset, void *buffer, ui32 size ) {
+    if ( !buffer || 0 == size || !isOpen() ) {
+        return 0;
+    }
+
+    // Written data still buffered by the runtime has to reach the file first
+    const AccessMode mode( getAccessMode() );
+    if ( AccessMode::ReadAccess != mode && AccessMode::ReadAccessBinary != mode ) {
+        ::fflush( m_file );
+    }
+
+    // The positional reads do not touch the file position, so readers can share the stream
+    ui32 bytesRead( 0 );
+#ifdef OSRE_WINDOWS
+    HANDLE handle( reinterpret_cast<HANDLE>( ::_get_osfhandle( ::_fileno( m_file ) ) ) );
+    while ( bytesRead < size ) {
+        OVERLAPPED overlapped;
+        ::memset( &overlapped, 0, sizeof( overlapped ) );
+        const ui64 pos( offset + bytesRead );
+        overlapped.Offset = static_cast<DWORD>( pos & 0xFFFFFFFF );
+        overlapped.OffsetHigh = static_cast<DWORD>( pos >> 32 );
+        DWORD numRead( 0 );
+        if ( FALSE == ::ReadFile( handle, static_cast<uc8*>( buffer ) + bytesRead, size - bytesRead, &numRead, &overlapped ) 
+                || 0 == numRead ) {
+            break;
+        }
+        bytesRead += numRead;
+    }
+#else
+    const int fd( ::fileno( m_file ) );
+    while ( bytesRead < size ) {
+        const ssize_t res( ::pread( fd, static_cast<uc8*>( buffer ) + bytesRead, size - bytesRead, 
+                static_cast<off_t>( offset + bytesRead ) ) );
+        if ( res < 0 && EINTR == errno ) {
+            continue;
+        }
+        if ( res <= 0 ) {
+            break;
+        }
+        bytesRead += static_cast<ui32>( res );
+    }
+#endif
+
+    return bytesRead;
 }
 
 ui32 FileStream::write( const void *buffer, ui32 size ) {
@@ -163,53 +289,95 @@ ui32 FileStream::write( const void *buffer, ui32 size ) {
     return 0;
 }
 
-ui32 FileStream::readI32( i32 &value ) {
+template<class T>
+ui32 FileStream::readValue( T &value ) {
     OSRE_ASSERT( nullptr != m_file );
-    if ( m_file ) {
-        return ( static_cast< ui32 >( ::fread( &value, sizeof( i32 ), 1, m_file ) ) );
+    if ( isBuffered() && m_bufferFill - m_bufferPos >= sizeof( T ) ) {
+        ::memcpy( &value, &m_buffer[ m_bufferPos ], sizeof( T ) );
+        m_bufferPos += sizeof( T );
+        return sizeof( T );
     }
 
-    return 0;
+    return read( &value, sizeof( T ) );
+}
+
+template<class T>
+ui32 FileStream::writeValue( T value ) {
+    return write( &value, sizeof( T ) );
+}
+
+ui32 FileStream::readI32( i32 &value ) {
+    return readValue( value );
 }
 
 ui32 FileStream::writeI32( i32 value ) {
-    OSRE_ASSERT( nullptr != m_file );
-    if ( m_file ) {
-        return ( static_cast< ui32 >( ::fwrite( &value, sizeof( i32 ), 1, m_file ) ) );
-    }
-    
-    return 0;
+    return writeValue( value );
 }
 
 ui32 FileStream::readUI32( ui32 &value ) {
-    OSRE_ASSERT( nullptr != m_file );
-    if ( m_file ) {
-        return ( static_cast< ui32 >( ::fread( &value, sizeof( ui32 ), 1, m_file ) ) );
-    }
-
-    return 0;
+    return readValue( value );
 }
 
 ui32 FileStream::writeUI32( ui32 value ) {
-    OSRE_ASSERT( nullptr != m_file );
-    if ( m_file ) {
-        return ( static_cast< ui32 >( ::fwrite( &value, sizeof( ui32 ), 1, m_file ) ) );
-    }
+    return writeValue( value );
+}
 
-    return 0;
+ui32 FileStream::readF32( f32 &value ) {
+    return readValue( value );
+}
+
+ui32 FileStream::writeF32( f32 value ) {
+    return writeValue( value );
+}
+
+ui32 FileStream::readD32( d32 &value ) {
+    return readValue( value );
+}
+
+ui32 FileStream::writeD32( d32 value ) {
+    return writeValue( value );
 }
 
 FileStream::Position FileStream::seek( Offset offset, Origin origin ) {
     OSRE_ASSERT( nullptr != m_file );
 
+    if ( isBuffered() ) {
+        // Positions inside the buffer are reached without a call into the runtime
+        i64 base( 0 );
+        if ( origin == Stream::Origin::Current ) {
+            base = static_cast<i64>( tell() );
+        } else if ( origin == Stream::Origin::End ) {
+            base = static_cast<i64>( m_size );
+        }
+        const i64 target( std::max<i64>( 0, base + offset ) );
+        if ( target >= static_cast<i64>( m_bufferStart ) && target <= static_cast<i64>( m_bufferStart + m_bufferFill ) ) {
+            m_bufferPos = static_cast<ui32>( target - static_cast<i64>( m_bufferStart ) );
+            return tell();
+        }
+
+        m_bufferPos = m_bufferFill = 0;
+        offset = target;
+        origin = Stream::Origin::Begin;
+    }
+
     i32 originValue( 0 );
     if ( origin == Stream::Origin::Current ) {
         originValue = SEEK_CUR;
+    } else if ( origin == Stream::Origin::End ) {
+        originValue = SEEK_END;
     } else {
         originValue = SEEK_SET;
     }
     if ( m_file ) {
-        return ::fseek( m_file, offset, originValue );
+#ifdef OSRE_WINDOWS
+        ::_fseeki64( m_file, offset, originValue );
+#else
+        ::fseeko( m_file, static_cast<off_t>( offset ), originValue );
+#endif
+        if ( isBuffered() ) {
+            m_bufferStart = static_cast<Position>( offset );
+        }
+        return tell();
     } 
       
     return 0;
@@ -217,8 +385,16 @@ FileStream::Position FileStream::seek( Offset offset, Origin origin ) {
 
 FileStream::Position FileStream::tell() {
     OSRE_ASSERT( nullptr != m_file );
+    if ( isBuffered() ) {
+        return m_bufferStart + m_bufferPos;
+    }
     if ( m_file ) {
-        return ( ::ftell( m_file ) );
+#ifdef OSRE_WINDOWS
+        const i64 pos( ::_ftelli64( m_file ) );
+#else
+        const i64 pos( static_cast<i64>( ::ftello( m_file ) ) );
+#endif
+        return pos < 0 ? 0 : static_cast<Position>( pos );
     }
      
     return 0;
@@ -228,5 +404,9 @@ bool FileStream::isOpen() const {
     return ( m_file != nullptr );
 }
 
+bool FileStream::isBuffered() const {
+    return nullptr != m_file && !m_buffer.empty();
+}
+
 } // Namespace IO
 } // Namespace OSRE
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <osre/IO/Stream.h>
 
+#include <vector>
+
 namespace OSRE {
 namespace IO {
 
@@ -33,9 +35,16 @@ namespace IO {
 ///	@brief	This class implements the basic file operations like reading and writing data,
 ///	positioning the file pointer in an already opened file. You can also get some basic infos about
 ///	a file like its size. Renaming, checking for existence and removing it offers static methods.
+///
+/// Read-only streams read through a buffer of their own, so small reads and typed values are copied 
+/// out of the buffer without a call into the runtime. The file size is cached when such a stream 
+/// gets opened.
 //--------------------------------------------------------------------------------------------------------------------
 class FileStream : public Stream {
 public:
+    /// The default size of the read buffer.
+    static const ui32 DefaultBufferSize = 64 * 1024;
+
     /// The default class constructor.
     FileStream() noexcept;
     /// The class constructor with URI and access mode.
@@ -53,9 +62,11 @@ public:
     /// Close the file.
     bool close();
     /// Returns file size.
-    ui32 getSize() const;
+    ui64 getSize() const;
     /// Reads from file.
     ui32 read( void *pBuffer, ui32 size );
+    /// Reads at a position without moving the file position, can be used by several threads at once.
+    ui32 readAt( Position offset, void *buffer, ui32 size );
     /// Writes into file.
     ui32 write( const void *pBuffer, ui32 size );
     /// Reads a single integer value.
@@ -66,16 +77,51 @@ public:
     ui32 readUI32( ui32 &value );
     /// Writes a single unsigned integer value.
     ui32 writeUI32( ui32 value );
+    /// Reads a single float value.
+    ui32 readF32( f32 &value );
+    /// Writes a single float value.
+    ui32 writeF32( f32 value );
+    /// Reads a single double value.
+    ui32 readD32( d32 &value );
+    /// Writes a single double value.
+    ui32 writeD32( d32 value );
     /// Moves to given position.
     Position seek( Offset offset, Origin origin );
     /// Position in the file.
     Position tell();
     /// Returns true, when the stream access is open.
     bool isOpen() const;
+    /// Sets the size of the read buffer, 0 disables it. Used when the stream gets opened.
+    void setBufferSize( ui32 size );
+    /// Returns the size of the read buffer.
+    ui32 getBufferSize() const;
+
+private:
+    bool isBuffered() const;
+    template<class T>
+    ui32 readValue( T &value );
+    template<class T>
+    ui32 writeValue( T value );
 
 private:
     FILE *m_file;
+    ui32 m_bufferSize;
+    std::vector<uc8> m_buffer;
+    Position m_bufferStart;
+    ui32 m_bufferPos;
+    ui32 m_bufferFill;
+    ui64 m_size;
 };
 
+inline
+void FileStream::setBufferSize( ui32 size ) {
+    m_bufferSize = size;
+}
+
+inline
+ui32 FileStream::getBufferSize() const {
+    return m_bufferSize;
+}
+
 } // Namespace IO
 } // Namespace OSRE
@@ -23,8 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/IO/IOService.h>
 #include <osre/Common/Tokenizer.h>
 #include <osre/Common/Logger.h>
+#include <osre/IO/FileMetadataCache.h>
 #include <src/Engine/IO/ZipFileSystem.h>
 #include <src/Engine/IO/LocaleFileSystem.h>
+#include <src/Engine/IO/PakFileSystem.h>
+#include <src/Engine/IO/AsyncReadQueue.h>
+#include <src/Engine/IO/AccessTrace.h>
+
+#include <memory>
 
 IMPLEMENT_SINGLETON( ::OSRE::IO::IOService )
 
@@ -35,6 +41,11 @@ using namespace OSRE::Common;
 
 static const String Tag = "IOService";
 static const String Zip_Extension = "zip";
+static const String Pak_Extension = "pak";
+static const ui32 DefaultNumIOThreads = 2;
+static const String File_Schema = "file";
+
+const ui64 IOService::DefaultPrefetchBudget = 512ull * 1024 * 1024;
 
 static AbstractFileSystem *createFS( const Uri &file ) {
     if ( !file.isValid() ) {
@@ -44,6 +55,8 @@ static AbstractFileSystem *createFS( const Uri &file ) {
     const String &schema( file.getScheme() );
     if( Zip_Extension == schema ) {
         return new ZipFileSystem( file );
+    } else if ( Pak_Extension == schema ) {
+        return new PakFileSystem( file );
     }
 
     return nullptr;
@@ -51,30 +64,45 @@ static AbstractFileSystem *createFS( const Uri &file ) {
 
 IOService::IOService() 
 : AbstractService( "io/ioserver" )
-, m_mountedMap() {
+, m_mountedMap()
+, m_numIOThreads( DefaultNumIOThreads )
+, m_readQueueMutex()
+, m_readQueue( nullptr )
+, m_metadataCache( new FileMetadataCache )
+, m_accessTrace( new AccessTrace )
+, m_traceFile() {
     CREATE_SINGLETON( IOService );
 
-    m_mountedMap["file"] = new LocaleFileSystem();
+    LocaleFileSystem *fs( new LocaleFileSystem );
+    fs->setMetadataCache( m_metadataCache.get() );
+    m_mountedMap["file"] = fs;
 }
 
 IOService::~IOService() {
+    releaseReadQueue();
     DESTROY_SINGLETON( IOService );
 }
 
 bool IOService::onOpen() {
     // create the locale file system
-    AbstractFileSystem *pFileSystem( nullptr );    
+    LocaleFileSystem *pFileSystem( nullptr );    
     pFileSystem = new LocaleFileSystem;
+    pFileSystem->setMetadataCache( m_metadataCache.get() );
     mountFileSystem( pFileSystem->getSchema(), pFileSystem );
 
     return true;
 }
 
 bool IOService::onClose() {
+    saveAccessTrace();
+    releaseReadQueue();
+
     return true;
 }
 
 bool IOService::onUpdate() {
+    m_metadataCache->dispatchChanges();
+
     return true;
 }
 
@@ -87,6 +115,7 @@ AbstractFileSystem *IOService::addFileSystem( const String &name, const Uri &fil
     if( fileExists( file ) ) {
         fs = createFS( file );
         if( fs ) {
+            m_accessTrace->record( file.getAbsPath(), 0, 0 );
             m_mountedMap[ name ] = fs;
         } else {
             osre_debug( Tag, "Cannot create file system " + file.getResource() );
@@ -119,6 +148,9 @@ Stream *IOService::openStream( const Uri &file, Stream::AccessMode mode ) {
     if ( pFS ) {
         pStream  = pFS->open( file, mode );
     }
+    if ( nullptr != pStream && File_Schema == file.getScheme() ) {
+        m_accessTrace->record( file.getAbsPath(), 0, 0 );
+    }
 
     return pStream;
 }
@@ -158,6 +190,140 @@ bool IOService::fileExists( const Uri &file ) const {
     return exists;
 }
 
+void IOService::readAsync( const Uri &file, ui64 offset, ui32 size, void *buffer, const ReadCallback &callback ) {
+    AsyncReadQueue::Request request;
+    request.m_file = file;
+    request.m_offset = offset;
+    request.m_size = size;
+    request.m_buffer = static_cast<uc8*>( buffer );
+    request.m_callback = callback;
+    request.m_fileSystem = nullptr;
+    if ( File_Schema == file.getScheme() ) {
+        m_accessTrace->record( file.getAbsPath(), offset, size );
+        getReadQueue()->enqueue( request );
+        return;
+    }
+
+    // Local files are read without a file system, the others are resolved here, the mounts are not 
+    // guarded for the IO threads
+    request.m_fileSystem = getFileSystem( file.getScheme() );
+    if ( nullptr != request.m_fileSystem && request.m_fileSystem->isThreadSafe() ) {
+        getReadQueue()->enqueue( request );
+        return;
+    }
+
+    bool ok( false );
+    ui32 bytesRead( 0 );
+    Stream *stream( nullptr != request.m_fileSystem ? request.m_fileSystem->open( file, Stream::AccessMode::ReadAccessBinary ) : nullptr );
+    if ( nullptr != stream ) {
+        bytesRead = 0 == size ? 0 : stream->readAt( offset, buffer, size );
+        ok = true;
+        request.m_fileSystem->close( &stream );
+    }
+    if ( callback ) {
+        callback( ok, bytesRead );
+    }
+}
+
+std::future<ui32> IOService::readAsync( const Uri &file, ui64 offset, ui32 size, void *buffer ) {
+    std::shared_ptr<std::promise<ui32>> promise( std::make_shared<std::promise<ui32>>() );
+    std::future<ui32> result( promise->get_future() );
+    readAsync( file, offset, size, buffer, [ promise ]( bool ok, ui32 bytesRead ) {
+        promise->set_value( ok ? bytesRead : 0 );
+    } );
+
+    return result;
+}
+
+void IOService::beginReadBatch() {
+    getReadQueue()->beginBatch();
+}
+
+void IOService::endReadBatch() {
+    getReadQueue()->endBatch();
+}
+
+void IOService::waitForReads() {
+    // Callbacks may issue new reads while waiting, so the lock is not held
+    AsyncReadQueue *queue( nullptr );
+    {
+        std::lock_guard<std::mutex> lock( m_readQueueMutex );
+        queue = m_readQueue;
+    }
+    if ( nullptr != queue ) {
+        queue->waitForAll();
+    }
+}
+
+void IOService::setNumIOThreads( ui32 numThreads ) {
+    std::lock_guard<std::mutex> lock( m_readQueueMutex );
+    if ( nullptr != m_readQueue ) {
+        osre_debug( Tag, "IO threads are running already." );
+        return;
+    }
+    m_numIOThreads = numThreads;
+}
+
+void IOService::getReadStatistics( ui64 &numRequests, ui64 &numReads ) const {
+    numRequests = numReads = 0;
+    std::lock_guard<std::mutex> lock( m_readQueueMutex );
+    if ( nullptr != m_readQueue ) {
+        m_readQueue->getStatistics( numRequests, numReads );
+    }
+}
+
+AsyncReadQueue *IOService::getReadQueue() {
+    std::lock_guard<std::mutex> lock( m_readQueueMutex );
+    if ( nullptr == m_readQueue ) {
+        m_readQueue = new AsyncReadQueue( m_numIOThreads );
+    }
+
+    return m_readQueue;
+}
+
+void IOService::releaseReadQueue() {
+    AsyncReadQueue *queue( nullptr );
+    {
+        std::lock_guard<std::mutex> lock( m_readQueueMutex );
+        queue = m_readQueue;
+        m_readQueue = nullptr;
+    }
+    delete queue;
+}
+
+bool IOService::enableAccessTrace( const String &traceFile, ui64 budget ) {
+    if ( traceFile.empty() ) {
+        return false;
+    }
+
+    std::vector<AccessTrace::Entry> entries;
+    const bool found( AccessTrace::load( traceFile, entries ) );
+    if ( found ) {
+        m_accessTrace->startPrefetch( entries, budget );
+    }
+    m_traceFile = traceFile;
+    m_accessTrace->startRecording();
+
+    return found;
+}
+
+bool IOService::saveAccessTrace() {
+    if ( m_traceFile.empty() ) {
+        return false;
+    }
+
+    m_accessTrace->stopRecording();
+    return m_accessTrace->save( m_traceFile );
+}
+
+ui64 IOService::getNumPrefetchedBytes() const {
+    return m_accessTrace->getNumPrefetchedBytes();
+}
+
+FileMetadataCache &IOService::getMetadataCache() {
+    return *m_metadataCache;
+}
+
 IOService *IOService::create() {
     return new IOService;
 }
@@ -23,17 +23,167 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <src/Engine/IO/ImageCodec.h>
 #include <osre/IO/Stream.h>
 #include <osre/Common/Logger.h>
+#include <osre/Threading/ThreadPool.h>
 
-#include "SOIL.h"
+#include "stb_image_aug.h"
+
+#include <cstring>
+#include <mutex>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#   define OSRE_IMAGE_SSE2
+#   include <emmintrin.h>
+#endif
 
 namespace OSRE {
 namespace IO {
 
-static const String Extensions = "jpg|png";
+static const String Extensions = "jpg|png|tga|bmp";
 static const String Tag        = "ImageCodec";
 
+// stb_image builds the fixed Huffman tables of deflate lazily. Decoding this 1x1 PNG, which uses
+// them, builds the tables before several threads can race on them.
+static const uc8 FixedHuffmanPng[] = {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52, 
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1F, 0x15, 0xC4, 
+    0x89, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x63, 0xF8, 0xCF, 0xC0, 0xF0, 
+    0x1F, 0x00, 0x05, 0x00, 0x01, 0xFF, 0x7B, 0xE9, 0xBE, 0xEF, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 
+    0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82
+};
+
+static std::once_flag s_decoderInitFlag;
+
+static void initDecoder() {
+    std::call_once( s_decoderInitFlag, []() {
+        int width( 0 ), height( 0 ), channels( 0 );
+        stbi_image_free( stbi_load_from_memory( FixedHuffmanPng, sizeof( FixedHuffmanPng ), &width, &height, 
+                &channels, 0 ) );
+    } );
+}
+
+// Computes c * a / 255, rounded, without a division
+static inline uc8 premultiply( uc8 c, uc8 a ) {
+    const ui32 t( static_cast<ui32>( c ) * a + 128 );
+    return static_cast<uc8>( ( t + ( t >> 8 ) ) >> 8 );
+}
+
+static inline ui32 readBE16( const uc8 *data ) {
+    return ( static_cast<ui32>( data[ 0 ] ) << 8 ) | data[ 1 ];
+}
+
+static inline ui32 readBE32( const uc8 *data ) {
+    return ( readBE16( data ) << 16 ) | readBE16( data + 2 );
+}
+
+static inline ui32 readLE16( const uc8 *data ) {
+    return ( static_cast<ui32>( data[ 1 ] ) << 8 ) | data[ 0 ];
+}
+
+#ifdef OSRE_IMAGE_SSE2
+
+static inline __m128i swapRedBlueSSE2( __m128i v ) {
+    const __m128i greenAlpha( _mm_set1_epi32( static_cast<int>( 0xFF00FF00 ) ) );
+    const __m128i low( _mm_set1_epi32( 0x000000FF ) );
+    return _mm_or_si128( _mm_and_si128( v, greenAlpha ), 
+            _mm_or_si128( _mm_and_si128( _mm_srli_epi32( v, 16 ), low ), _mm_slli_epi32( _mm_and_si128( v, low ), 16 ) ) );
+}
+
+// Multiplies the colors of two pixels, unpacked to 16 bits, by their alpha
+static inline __m128i premultiplyLanesSSE2( __m128i v ) {
+    const __m128i colorMask( _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 ) );
+    const __m128i alphaOne( _mm_set_epi16( 255, 0, 0, 0, 255, 0, 0, 0 ) );
+    __m128i alpha( _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+    alpha = _mm_or_si128( _mm_and_si128( alpha, colorMask ), alphaOne );
+    const __m128i t( _mm_add_epi16( _mm_mullo_epi16( v, alpha ), _mm_set1_epi16( 128 ) ) );
+    return _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+}
+
+static inline __m128i premultiplySSE2( __m128i v ) {
+    const __m128i zero( _mm_setzero_si128() );
+    return _mm_packus_epi16( premultiplyLanesSSE2( _mm_unpacklo_epi8( v, zero ) ), 
+            premultiplyLanesSSE2( _mm_unpackhi_epi8( v, zero ) ) );
+}
+
+// Expands the first 12 bytes, 4 RGB pixels, to 4 RGBA pixels
+static inline __m128i expandRgbSSE2( __m128i v ) {
+    const __m128i p01( _mm_unpacklo_epi32( v, _mm_srli_si128( v, 3 ) ) );
+    const __m128i p23( _mm_unpacklo_epi32( _mm_srli_si128( v, 6 ), _mm_srli_si128( v, 9 ) ) );
+    return _mm_or_si128( _mm_unpacklo_epi64( p01, p23 ), _mm_set1_epi32( static_cast<int>( 0xFF000000 ) ) );
+}
+
+// Converts RGB or RGBA to RGBA or BGRA, returns the number of converted pixels
+static ui32 convertSSE2( const uc8 *src, ui32 srcChannels, uc8 *dst, bool swap, bool premultiply, ui32 numPixels ) {
+    ui32 i( 0 );
+    if ( 3 == srcChannels ) {
+        // 16 bytes are loaded for 12, the last pixels are left to the scalar loop
+        for ( ; i + 6 <= numPixels; i += 4 ) {
+            __m128i v( expandRgbSSE2( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i * 3 ) ) ) );
+            if ( swap ) {
+                v = swapRedBlueSSE2( v );
+            }
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i * 4 ), v );
+        }
+    } else {
+        for ( ; i + 4 <= numPixels; i += 4 ) {
+            __m128i v( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i * 4 ) ) );
+            if ( swap ) {
+                v = swapRedBlueSSE2( v );
+            }
+            if ( premultiply ) {
+                v = premultiplySSE2( v );
+            }
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i * 4 ), v );
+        }
+    }
+
+    return i;
+}
+
+#endif // OSRE_IMAGE_SSE2
+
+// Decodes into the buffer returned by getBuffer for the needed size, nullptr if there is none
+template<class GetBuffer>
+static bool decodeInto( const uc8 *data, ui32 size, ImageCodec::PixelFormat format, ui32 flags, 
+        GetBuffer getBuffer, ImageCodec::ImageInfo &info ) {
+    info.m_width = info.m_height = 0;
+    if ( nullptr == data || 0 == size ) {
+        osre_debug( Tag, "Image data is nullptr." );
+        return false;
+    }
+
+    initDecoder();
+    int width( 0 ), height( 0 ), channels( 0 );
+    stbi_uc *decoded( stbi_load_from_memory( data, static_cast<int>( size ), &width, &height, &channels, 0 ) );
+    if ( nullptr == decoded ) {
+        osre_debug( Tag, "Cannot decode image." );
+        return false;
+    }
+    info.m_width = static_cast<ui32>( width );
+    info.m_height = static_cast<ui32>( height );
+
+    const size_t rowSize( static_cast<size_t>( width ) * ImageCodec::getNumChannels( format ) );
+    uc8 *pixels( getBuffer( rowSize * height ) );
+    if ( nullptr == pixels ) {
+        osre_debug( Tag, "The pixel buffer is too small." );
+        stbi_image_free( decoded );
+        return false;
+    }
+
+    const bool flip( 0 != ( flags & ImageCodec::FlipVertical ) );
+    const bool premultiply( 0 != ( flags & ImageCodec::PremultiplyAlpha ) );
+    const size_t srcRowSize( static_cast<size_t>( width ) * channels );
+    for ( int y = 0; y < height; ++y ) {
+        const size_t row( static_cast<size_t>( flip ? height - 1 - y : y ) );
+        ImageCodec::convertPixels( decoded + y * srcRowSize, static_cast<ui32>( channels ), pixels + row * rowSize, 
+                format, info.m_width, premultiply );
+    }
+    stbi_image_free( decoded );
+
+    return true;
+}
+
 ImageCodec::ImageCodec()
-: AbstractCodec("image", Extensions ) {
+: AbstractCodec( "image", Extensions ) {
     // empty
 }
 
@@ -41,33 +191,242 @@ ImageCodec::~ImageCodec() {
     // empty
 }
 
-bool ImageCodec::encode( IO::Stream *inStream, uc8 *data, ui32 &size ) {
-    if ( nullptr == inStream ) {
-        osre_debug( Tag, "Input stream is nullptr." );
+bool ImageCodec::getInfo( const uc8 *data, ui32 size, ImageInfo &info ) {
+    info.m_width = info.m_height = 0;
+    if ( nullptr == data ) {
         return false;
     }
-    if ( 0 == size ) {
+
+    static const uc8 PngSignature[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    if ( size >= 24 && 0 == ::memcmp( data, PngSignature, sizeof( PngSignature ) ) ) {
+        info.m_width = readBE32( data + 16 );
+        info.m_height = readBE32( data + 20 );
         return true;
     }
-    unsigned char *buffer = new unsigned char[ size ];
-    i32 width( 0 ), height( 0 ), channels( 0 );
-    data = SOIL_load_image_from_memory( buffer, size, &width, &height, &channels, SOIL_LOAD_AUTO );
 
-    return true;
-}
+    if ( size >= 26 && 'B' == data[ 0 ] && 'M' == data[ 1 ] ) {
+        i32 width( 0 ), height( 0 );
+        ::memcpy( &width, data + 18, sizeof( i32 ) );
+        ::memcpy( &height, data + 22, sizeof( i32 ) );
+        info.m_width = static_cast<ui32>( width );
+        info.m_height = static_cast<ui32>( height < 0 ? -height : height );
+        return true;
+    }
+
+    if ( size >= 4 && 0xFF == data[ 0 ] && 0xD8 == data[ 1 ] ) {
+        // Walks the segments up to the start of frame
+        ui32 pos( 2 );
+        while ( pos + 9 <= size && 0xFF == data[ pos ] ) {
+            const uc8 marker( data[ pos + 1 ] );
+            if ( 0xFF == marker ) {
+                ++pos;
+                continue;
+            }
+            if ( marker >= 0xC0 && marker <= 0xCF && 0xC4 != marker && 0xC8 != marker && 0xCC != marker ) {
+                info.m_height = readBE16( data + pos + 5 );
+                info.m_width = readBE16( data + pos + 7 );
+                return true;
+            }
+            pos += 2 + readBE16( data + pos + 2 );
+        }
+        return false;
+    }
+
+    // TGA has no signature, the header fields must be plausible
+    if ( size >= 18 && data[ 1 ] <= 1 ) {
+        const uc8 type( data[ 2 ] );
+        const uc8 bpp( data[ 16 ] );
+        const bool validType( ( type >= 1 && type <= 3 ) || ( type >= 9 && type <= 11 ) );
+        const bool validBpp( 8 == bpp || 15 == bpp || 16 == bpp || 24 == bpp || 32 == bpp );
+        if ( validType && validBpp ) {
+            info.m_width = readLE16( data + 12 );
+            info.m_height = readLE16( data + 14 );
+            return true;
+        }
+    }
 
-bool ImageCodec::decode( IO::Stream * ) {
     return false;
 }
 
-void ImageCodec::releaseData( uc8 *data ) {
+bool ImageCodec::decodeImage( const uc8 *data, ui32 size, PixelFormat format, ui32 flags, uc8 *pixels, 
+        size_t capacity, ImageInfo &info ) {
+    return decodeInto( data, size, format, flags, [ pixels, capacity ]( size_t needed ) {
+        return needed <= capacity ? pixels : nullptr;
+    }, info );
+}
+
+bool ImageCodec::decodeImage( const uc8 *data, ui32 size, PixelFormat format, ui32 flags, 
+        std::vector<uc8> &pixels, ImageInfo &info ) {
+    return decodeInto( data, size, format, flags, [ &pixels ]( size_t needed ) {
+        pixels.resize( needed );
+        return pixels.data();
+    }, info );
+}
+
+bool ImageCodec::decodeImage( Stream *stream, PixelFormat format, ui32 flags, std::vector<uc8> &pixels, 
+        ImageInfo &info ) {
+    info.m_width = info.m_height = 0;
+    if ( nullptr == stream ) {
+        osre_debug( Tag, "Stream is nullptr." );
+        return false;
+    }
+
+    ui64 size( 0 );
+    const uc8 *data( stream->map( size ) );
+    std::vector<uc8> content;
     if ( nullptr == data ) {
-        osre_error( Tag, "Pointer to data buffer is nullptr." );
+        size = stream->getSize();
+        if ( size > 0x7FFFFFFF ) {
+            osre_debug( Tag, "Image is too big." );
+            return false;
+        }
+        content.resize( static_cast<size_t>( size ) );
+        if ( content.empty() || stream->read( &content[ 0 ], static_cast<ui32>( size ) ) != size ) {
+            osre_debug( Tag, "Cannot read image from " + stream->getUri().getResource() );
+            return false;
+        }
+        data = &content[ 0 ];
+    } else if ( size > 0x7FFFFFFF ) {
+        osre_debug( Tag, "Image is too big." );
+        return false;
+    }
+
+    return decodeImage( data, static_cast<ui32>( size ), format, flags, pixels, info );
+}
+
+void ImageCodec::decodeBatch( DecodeJob *jobs, ui32 numJobs, PixelFormat format, ui32 flags, 
+        Threading::ThreadPool &pool ) {
+    if ( nullptr == jobs || 0 == numJobs ) {
+        return;
+    }
+
+    pool.parallelFor( numJobs, 1, [ jobs, format, flags ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            DecodeJob &job( jobs[ i ] );
+            job.m_ok = decodeImage( job.m_data, job.m_size, format, flags, job.m_pixels, job.m_capacity, job.m_info );
+        }
+    } );
+}
+
+bool ImageCodec::encodeImage( Stream *stream, const uc8 *pixels, ui32 width, ui32 height, PixelFormat format ) {
+    if ( nullptr == stream || nullptr == pixels ) {
+        osre_debug( Tag, "Stream or pixels are nullptr." );
+        return false;
+    }
+    if ( 0 == width || 0 == height || width > 0xFFFF || height > 0xFFFF ) {
+        osre_debug( Tag, "Invalid image size for TGA." );
+        return false;
+    }
+
+    // Uncompressed true color, the rows are stored top row first
+    const ui32 channels( getNumChannels( format ) );
+    uc8 header[ 18 ] = {};
+    header[ 2 ] = 2;
+    header[ 12 ] = static_cast<uc8>( width & 0xFF );
+    header[ 13 ] = static_cast<uc8>( width >> 8 );
+    header[ 14 ] = static_cast<uc8>( height & 0xFF );
+    header[ 15 ] = static_cast<uc8>( height >> 8 );
+    header[ 16 ] = static_cast<uc8>( channels * 8 );
+    header[ 17 ] = static_cast<uc8>( 0x20 | ( 4 == channels ? 8 : 0 ) );
+    if ( sizeof( header ) != stream->write( header, sizeof( header ) ) ) {
+        return false;
+    }
+
+    // TGA stores BGR and BGRA
+    const size_t rowSize( static_cast<size_t>( width ) * channels );
+    std::vector<uc8> row( rowSize );
+    for ( ui32 y = 0; y < height; ++y ) {
+        const uc8 *src( pixels + y * rowSize );
+        if ( PixelFormat::BGRA == format ) {
+            ::memcpy( &row[ 0 ], src, rowSize );
+        } else if ( PixelFormat::RGBA == format ) {
+            convertPixels( src, 4, &row[ 0 ], PixelFormat::BGRA, width, false );
+        } else {
+            for ( ui32 x = 0; x < width; ++x ) {
+                row[ x * 3 + 0 ] = src[ x * 3 + 2 ];
+                row[ x * 3 + 1 ] = src[ x * 3 + 1 ];
+                row[ x * 3 + 2 ] = src[ x * 3 + 0 ];
+            }
+        }
+        if ( rowSize != stream->write( &row[ 0 ], static_cast<ui32>( rowSize ) ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ImageCodec::convertPixels( const uc8 *src, ui32 srcChannels, uc8 *dst, PixelFormat format, ui32 numPixels, 
+        bool premultiply ) {
+    const ui32 dstChannels( getNumChannels( format ) );
+    const bool swap( PixelFormat::BGRA == format );
+    if ( 3 == srcChannels && !swap && 3 == dstChannels ) {
+        ::memcpy( dst, src, static_cast<size_t>( numPixels ) * 3 );
         return;
     }
 
-    SOIL_free_image_data( data );
+    ui32 i( 0 );
+#ifdef OSRE_IMAGE_SSE2
+    if ( 4 == dstChannels && ( 3 == srcChannels || 4 == srcChannels ) ) {
+        i = convertSSE2( src, srcChannels, dst, swap, premultiply, numPixels );
+    }
+#endif
+
+    for ( ; i < numPixels; ++i ) {
+        const uc8 *in( src + i * srcChannels );
+        uc8 r( in[ 0 ] ), g( in[ 0 ] ), b( in[ 0 ] ), a( 255 );
+        if ( srcChannels >= 3 ) {
+            g = in[ 1 ];
+            b = in[ 2 ];
+        }
+        if ( 2 == srcChannels || 4 == srcChannels ) {
+            a = in[ srcChannels - 1 ];
+        }
+        if ( premultiply ) {
+            r = IO::premultiply( r, a );
+            g = IO::premultiply( g, a );
+            b = IO::premultiply( b, a );
+        }
+
+        uc8 *out( dst + i * dstChannels );
+        out[ 0 ] = swap ? b : r;
+        out[ 1 ] = g;
+        out[ 2 ] = swap ? r : b;
+        if ( 4 == dstChannels ) {
+            out[ 3 ] = a;
+        }
+    }
 }
 
+void ImageCodec::flipVertical( uc8 *pixels, ui32 width, ui32 height, PixelFormat format ) {
+    if ( nullptr == pixels ) {
+        return;
+    }
+
+    const size_t rowSize( static_cast<size_t>( width ) * getNumChannels( format ) );
+    for ( ui32 y = 0; y < height / 2; ++y ) {
+        uc8 *top( pixels + y * rowSize );
+        uc8 *bottom( pixels + ( height - 1 - y ) * rowSize );
+        size_t i( 0 );
+#ifdef OSRE_IMAGE_SSE2
+        for ( ; i + 16 <= rowSize; i += 16 ) {
+            const __m128i a( _mm_loadu_si128( reinterpret_cast<const __m128i*>( top + i ) ) );
+            const __m128i b( _mm_loadu_si128( reinterpret_cast<const __m128i*>( bottom + i ) ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( top + i ), b );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( bottom + i ), a );
+        }
+#endif
+        for ( ; i < rowSize; ++i ) {
+            const uc8 tmp( top[ i ] );
+            top[ i ] = bottom[ i ];
+            bottom[ i ] = tmp;
+        }
+    }
 }
+
+ui32 ImageCodec::getNumChannels( PixelFormat format ) {
+    return PixelFormat::RGB == format ? 3 : 4;
 }
+
+} // Namespace IO
+} // Namespace OSRE
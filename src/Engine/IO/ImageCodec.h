@@ -24,17 +24,118 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <osre/Common/AbstractCodec.h>
 
+#include <vector>
+
 namespace OSRE {
+
+namespace Threading {
+    class ThreadPool;
+}
+
 namespace IO {
 
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Engine
+///
+///	@brief  This class decodes images into buffers of the caller and encodes them as TGA.
+///
+/// The pixels are converted to the requested format while they are copied into the buffer of the 
+/// caller, the expansion of RGB to RGBA, the BGRA swizzle and the premultiplication use SSE2 where 
+/// available. Flipped images are written bottom row first, so the flip does not cost a pass. All 
+/// functions are thread-safe, decodeBatch decodes several images in parallel.
+//-------------------------------------------------------------------------------------------------
 class ImageCodec : public Common::AbstractCodec {
 public:
+    /// @brief  The pixel formats of decoded images, all with 8 bits per channel.
+    enum class PixelFormat {
+        RGB,        ///< Red, green, blue.
+        RGBA,       ///< Red, green, blue, alpha.
+        BGRA        ///< Blue, green, red, alpha, the native layout of most GPUs.
+    };
+
+    /// @brief  The decoding flags.
+    enum Flags {
+        FlipVertical = 1,       ///< The bottom row will be the first one.
+        PremultiplyAlpha = 2    ///< The colors will be multiplied by the alpha value.
+    };
+
+    /// @brief  The size of an image.
+    struct ImageInfo {
+        ui32 m_width;
+        ui32 m_height;
+    };
+
+    /// @brief  One image of a batch.
+    struct DecodeJob {
+        const uc8 *m_data;      ///< The encoded image.
+        ui32 m_size;            ///< The size of the encoded image.
+        uc8 *m_pixels;          ///< The buffer for the pixels.
+        size_t m_capacity;      ///< The size of the pixel buffer.
+        ImageInfo m_info;       ///< The size of the image, set by the decode.
+        bool m_ok;              ///< true, if the decode was successful.
+    };
+
+    /// @brief  The class constructor.
     ImageCodec();
+
+    /// @brief  The class destructor, virtual.
     virtual ~ImageCodec();
-    bool encode( IO::Stream *inStream, uc8 *data, ui32 &size ) override;
-    bool decode( IO::Stream *outStream ) override ;
-    void releaseData( uc8 *data ) override;
+
+    /// @brief  Reads the size of a PNG, JPEG, TGA or BMP image from its header.
+    /// @param  data        [in] The encoded image.
+    /// @param  size        [in] The size of the encoded image.
+    /// @param  info        [out] The size of the image.
+    /// @return true, if the header was recognized.
+    static bool getInfo( const uc8 *data, ui32 size, ImageInfo &info );
+
+    /// @brief  Decodes an image into a buffer of the caller.
+    /// @param  data        [in] The encoded image.
+    /// @param  size        [in] The size of the encoded image.
+    /// @param  format      [in] The requested pixel format.
+    /// @param  flags       [in] The decoding flags.
+    /// @param  pixels      [out] The buffer for the pixels.
+    /// @param  capacity    [in] The size of the buffer, must be at least width * height * channels.
+    /// @param  info        [out] The size of the image, also set if the buffer is too small.
+    /// @return true, if the image was decoded.
+    static bool decodeImage( const uc8 *data, ui32 size, PixelFormat format, ui32 flags, uc8 *pixels, 
+            size_t capacity, ImageInfo &info );
+
+    /// @brief  Decodes an image into a vector, which will be resized to the image size.
+    static bool decodeImage( const uc8 *data, ui32 size, PixelFormat format, ui32 flags, 
+            std::vector<uc8> &pixels, ImageInfo &info );
+
+    /// @brief  Decodes the content of a stream, a mappable stream is not copied.
+    static bool decodeImage( Stream *stream, PixelFormat format, ui32 flags, std::vector<uc8> &pixels, 
+            ImageInfo &info );
+
+    /// @brief  Decodes several images in parallel.
+    /// @param  jobs        [inout] The images.
+    /// @param  numJobs     [in] The number of images.
+    /// @param  format      [in] The requested pixel format.
+    /// @param  flags       [in] The decoding flags.
+    /// @param  pool        [in] The pool running the decodes.
+    static void decodeBatch( DecodeJob *jobs, ui32 numJobs, PixelFormat format, ui32 flags, 
+            Threading::ThreadPool &pool );
+
+    /// @brief  Writes an image as uncompressed TGA.
+    /// @param  stream      [in] The stream to write to.
+    /// @param  pixels      [in] The pixels, top row first.
+    /// @param  width       [in] The width of the image.
+    /// @param  height      [in] The height of the image.
+    /// @param  format      [in] The pixel format.
+    /// @return true, if the image was written.
+    static bool encodeImage( Stream *stream, const uc8 *pixels, ui32 width, ui32 height, PixelFormat format );
+
+    /// @brief  Converts pixels with 1 to 4 channels, grey, grey alpha, RGB or RGBA, to a pixel format.
+    static void convertPixels( const uc8 *src, ui32 srcChannels, uc8 *dst, PixelFormat format, ui32 numPixels, 
+            bool premultiply );
+
+    /// @brief  Flips an image in place.
+    static void flipVertical( uc8 *pixels, ui32 width, ui32 height, PixelFormat format );
+
+    /// @brief  Returns the number of channels of a pixel format.
+    static ui32 getNumChannels( PixelFormat format );
 };
 
 } // Namespace IO
-}
+} // Namespace OSRE
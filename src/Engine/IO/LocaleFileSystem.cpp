@@ -22,10 +22,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include "LocaleFileSystem.h"
 #include "FileStream.h"
+#include "MappedFileStream.h"
 
 #include <osre/Common/Logger.h>
+#include <osre/IO/FileMetadataCache.h>
 #include <cassert>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #ifdef OSRE_WINDOWS
 #  include <osre/Platform/Windows/MinWindows.h>
 #else
@@ -44,7 +49,9 @@ static const String BaseFileSchema = "file";
 static const String Tag = "IOService";
 
 LocaleFileSystem::LocaleFileSystem() 
-: m_FileMap() {
+: m_FileMap()
+, m_metadataCache( nullptr )
+, m_mutex() {
     // empty
 }
 
@@ -63,21 +70,39 @@ Stream *LocaleFileSystem::open( const Uri &file, Stream::AccessMode mode ) {
         return nullptr;
     }
 
+    const bool readOnly( Stream::AccessMode::ReadAccess == mode || Stream::AccessMode::ReadAccessBinary == mode );
+    if ( readOnly && nullptr != m_metadataCache 
+            && FileMetadataCache::Lookup::Missing == m_metadataCache->stat( file.getAbsPath() ) ) {
+        return nullptr;
+    }
+
     Stream *pFileStream( nullptr );
     String::size_type pos = file.getResource().rfind( "xml" );
     if ( String::npos == pos ) {
-        pFileStream = new FileStream( file, mode );
-    }
-
-    if ( nullptr == pFileStream ) {
-        return nullptr;
+        // Binary reads are served from a mapping, empty files cannot be mapped
+        if ( Stream::AccessMode::ReadAccessBinary == mode ) {
+            pFileStream = new MappedFileStream( file, mode );
+            if ( !pFileStream->open() ) {
+                delete pFileStream;
+                pFileStream = nullptr;
+            }
+        }
+        if ( nullptr == pFileStream ) {
+            pFileStream = new FileStream( file, mode );
+            if ( !pFileStream->open() ) {
+                delete pFileStream;
+                pFileStream = nullptr;
+            }
+        }
     }
 
-    if ( pFileStream->open() ) {
+    if ( nullptr != pFileStream ) {
+        // A new file must be visible at once, not only when the watcher saw it
+        if ( !readOnly && nullptr != m_metadataCache ) {
+            m_metadataCache->update( file.getAbsPath() );
+        }
+        std::lock_guard<std::mutex> lock( m_mutex );
         m_FileMap[ file.getResource() ] = pFileStream;
-    } else {
-        delete pFileStream;
-        pFileStream = nullptr;
     }
 
     return pFileStream;
@@ -92,8 +117,18 @@ void LocaleFileSystem::close( Stream **pFile ) {
     }
 
     const Uri &rFile = (*pFile)->getUri();
-    StreamMap::iterator it = m_FileMap.find( rFile.getResource() );
-    m_FileMap.erase( it );
+    const Stream::AccessMode mode( ( *pFile )->getAccessMode() );
+    if ( nullptr != m_metadataCache && Stream::AccessMode::ReadAccess != mode && Stream::AccessMode::ReadAccessBinary != mode ) {
+        m_metadataCache->update( rFile.getAbsPath() );
+    }
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        StreamMap::iterator it = m_FileMap.find( rFile.getResource() );
+        if ( m_FileMap.end() != it && *pFile == it->second ) {
+            m_FileMap.erase( it );
+        }
+    }
+    delete *pFile;
     (*pFile) = NULL;
 }
 
@@ -102,23 +137,28 @@ bool LocaleFileSystem::fileExist( const Uri &filename ) {
         return false;
     }
 
-    bool exists( false );
-    FILE *pFileStream( nullptr );
+    if ( nullptr != m_metadataCache ) {
+        FileMetadataCache::FileInfo info;
+        const FileMetadataCache::Lookup result( m_metadataCache->stat( filename.getAbsPath(), &info ) );
+        if ( FileMetadataCache::Lookup::NotCovered != result ) {
+            return FileMetadataCache::Lookup::Found == result && !info.m_isDirectory;
+        }
+    }
+
+    // A stat call is enough, the file does not need to be opened
 #ifdef OSRE_WINDOWS
-    errno_t err = ::fopen_s( &pFileStream, filename.getAbsPath().c_str(), "r" );
-    if ( 0 != err ) {
-        osre_debug( Tag, "Error while opening the file." );
+    struct __stat64 fileStat;
+    if ( 0 != ::_stat64( filename.getAbsPath().c_str(), &fileStat ) ) {
+        return false;
     }
+    return 0 == ( fileStat.st_mode & _S_IFDIR );
 #else
-    pFileStream = ::fopen(  filename.getAbsPath().c_str(), "r" );
-#endif
-
-    if ( pFileStream ) {
-        exists = true;
-        ::fclose( pFileStream );
+    struct stat fileStat;
+    if ( 0 != ::stat( filename.getAbsPath().c_str(), &fileStat ) ) {
+        return false;
     }
-
-    return exists;
+    return !S_ISDIR( fileStat.st_mode );
+#endif
 }
 
 Stream *LocaleFileSystem::find( const Uri &rFile, Stream::AccessMode mode,  TArray<String> *pSearchPaths ) {
@@ -145,6 +185,14 @@ const String &LocaleFileSystem::getSchema() const {
     return BaseFileSchema;
 }
 
+bool LocaleFileSystem::isThreadSafe() const {
+    return true;
+}
+
+void LocaleFileSystem::setMetadataCache( FileMetadataCache *cache ) {
+    m_metadataCache = cache;
+}
+
 String LocaleFileSystem::getWorkingDirectory() {
     String workingDir;
     static const ui32 Size = 256;
@@ -24,9 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <osre/IO/AbstractFileSystem.h>
 
+#include <mutex>
+
 namespace OSRE {
 namespace IO {
 
+class FileMetadataCache;
+
 //-------------------------------------------------------------------------------------------------
 ///	@class		::OSRE::IO::BaseFileSystem
 ///	@ingroup	Infrastructure
@@ -51,9 +55,15 @@ public:
 	virtual const String &getSchema() const;
 	///	Returns the working directory.
 	virtual String getWorkingDirectory();
+	///	Returns true, the stream map is guarded by a mutex.
+	virtual bool isThreadSafe() const;
+	///	Assigns the metadata cache used for existence checks, may be nullptr.
+	void setMetadataCache( FileMetadataCache *cache );
 
 private:
 	StreamMap m_FileMap;
+	FileMetadataCache *m_metadataCache;
+	std::mutex m_mutex; // Streams may be opened and closed by several threads, e.g. the asset cooker
 };
 
 } // Namespace IO
@@ -0,0 +1,212 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "Lz4Codec.h"
+
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+static const ui32 MinMatch = 4;
+static const ui32 LastLiterals = 5;
+static const ui32 MatchFindLimit = 12;
+static const ui32 MaxOffset = 65535;
+static const ui32 HashLog = 12;
+static const ui32 RunMask = 15;
+
+static inline ui32 read32( const uc8 *ptr ) {
+    ui32 value( 0 );
+    ::memcpy( &value, ptr, sizeof( ui32 ) );
+    return value;
+}
+
+static inline ui32 hash32( ui32 sequence ) {
+    return ( sequence * 2654435761u ) >> ( 32 - HashLog );
+}
+
+static inline uc8 *writeLength( uc8 *op, ui32 length ) {
+    length -= RunMask;
+    while ( length >= 255 ) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uc8>( length );
+
+    return op;
+}
+
+static inline uc8 *writeLiterals( uc8 *op, const uc8 *literals, ui32 numLiterals, uc8 *&token ) {
+    token = op++;
+    if ( numLiterals >= RunMask ) {
+        *token = static_cast<uc8>( RunMask << 4 );
+        op = writeLength( op, numLiterals );
+    } else {
+        *token = static_cast<uc8>( numLiterals << 4 );
+    }
+    ::memcpy( op, literals, numLiterals );
+
+    return op + numLiterals;
+}
+
+static inline bool readLength( const uc8 *&ip, const uc8 *iend, ui32 &length ) {
+    uc8 value( 0 );
+    do {
+        if ( ip >= iend ) {
+            return false;
+        }
+        value = *ip++;
+        length += value;
+    } while ( 255 == value );
+
+    return true;
+}
+
+ui32 Lz4Codec::getMaxCompressedSize( ui32 size ) {
+    return size + size / 255 + 16;
+}
+
+ui32 Lz4Codec::compress( const uc8 *src, ui32 srcSize, uc8 *dst, ui32 dstCapacity ) {
+    if ( nullptr == src || nullptr == dst || dstCapacity < getMaxCompressedSize( srcSize ) ) {
+        return 0;
+    }
+
+    const uc8 *ip( src );
+    const uc8 *anchor( src );
+    const uc8 *iend( src + srcSize );
+    uc8 *op( dst );
+    uc8 *token( nullptr );
+
+    // The format needs the last bytes as literals, so short blocks have no matches at all
+    if ( srcSize > MatchFindLimit ) {
+        const uc8 *mfLimit( iend - MatchFindLimit );
+        const uc8 *matchLimit( iend - LastLiterals );
+        ui32 table[ 1 << HashLog ];
+        ::memset( table, 0, sizeof( table ) );
+
+        while ( ip <= mfLimit ) {
+            const ui32 sequence( read32( ip ) );
+            const ui32 h( hash32( sequence ) );
+            const uc8 *ref( src + table[ h ] );
+            table[ h ] = static_cast<ui32>( ip - src );
+            if ( ref >= ip || static_cast<ui32>( ip - ref ) > MaxOffset || read32( ref ) != sequence ) {
+                ++ip;
+                continue;
+            }
+
+            while ( ip > anchor && ref > src && ip[ -1 ] == ref[ -1 ] ) {
+                --ip;
+                --ref;
+            }
+            const uc8 *matchEnd( ip + MinMatch );
+            const uc8 *refEnd( ref + MinMatch );
+            while ( matchEnd < matchLimit && *matchEnd == *refEnd ) {
+                ++matchEnd;
+                ++refEnd;
+            }
+
+            op = writeLiterals( op, anchor, static_cast<ui32>( ip - anchor ), token );
+            const ui32 offset( static_cast<ui32>( ip - ref ) );
+            *op++ = static_cast<uc8>( offset & 0xFF );
+            *op++ = static_cast<uc8>( offset >> 8 );
+            const ui32 matchLength( static_cast<ui32>( matchEnd - ip ) - MinMatch );
+            if ( matchLength >= RunMask ) {
+                *token |= RunMask;
+                op = writeLength( op, matchLength );
+            } else {
+                *token |= static_cast<uc8>( matchLength );
+            }
+
+            ip = anchor = matchEnd;
+            if ( ip - 2 >= src ) {
+                table[ hash32( read32( ip - 2 ) ) ] = static_cast<ui32>( ip - 2 - src );
+            }
+        }
+    }
+
+    op = writeLiterals( op, anchor, static_cast<ui32>( iend - anchor ), token );
+
+    return static_cast<ui32>( op - dst );
+}
+
+bool Lz4Codec::decompress( const uc8 *src, ui32 srcSize, uc8 *dst, ui32 dstSize ) {
+    if ( nullptr == src || nullptr == dst ) {
+        return false;
+    }
+
+    const uc8 *ip( src );
+    const uc8 *iend( src + srcSize );
+    uc8 *op( dst );
+    uc8 *oend( dst + dstSize );
+    while ( ip < iend ) {
+        const uc8 token( *ip++ );
+        ui32 numLiterals( token >> 4 );
+        if ( RunMask == numLiterals && !readLength( ip, iend, numLiterals ) ) {
+            return false;
+        }
+        if ( numLiterals > static_cast<ui32>( iend - ip ) || numLiterals > static_cast<ui32>( oend - op ) ) {
+            return false;
+        }
+        ::memcpy( op, ip, numLiterals );
+        op += numLiterals;
+        ip += numLiterals;
+
+        // The last sequence has no match
+        if ( ip == iend ) {
+            break;
+        }
+
+        if ( iend - ip < 2 ) {
+            return false;
+        }
+        const ui32 offset( static_cast<ui32>( ip[ 0 ] ) | ( static_cast<ui32>( ip[ 1 ] ) << 8 ) );
+        ip += 2;
+        if ( 0 == offset || offset > static_cast<ui32>( op - dst ) ) {
+            return false;
+        }
+
+        ui32 matchLength( token & RunMask );
+        if ( RunMask == matchLength && !readLength( ip, iend, matchLength ) ) {
+            return false;
+        }
+        matchLength += MinMatch;
+        if ( matchLength > static_cast<ui32>( oend - op ) ) {
+            return false;
+        }
+
+        // Matches may overlap the output, short offsets repeat the pattern
+        const uc8 *match( op - offset );
+        if ( offset >= matchLength ) {
+            ::memcpy( op, match, matchLength );
+            op += matchLength;
+        } else {
+            for ( ui32 i = 0; i < matchLength; ++i ) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == oend;
+}
+
+} // Namespace IO
+} // Namespace OSRE
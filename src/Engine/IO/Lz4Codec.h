@@ -0,0 +1,49 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/Common/osre_common.h>
+
+namespace OSRE {
+namespace IO {
+
+//--------------------------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	This class implements a compressor and a decompressor for the LZ4 block format. 
+///
+/// The compressor uses a single hash table and a greedy match search, it is tuned for decompression speed and not 
+/// for the ratio. The output can be decompressed by any LZ4 block decoder and vice versa.
+//--------------------------------------------------------------------------------------------------------------------
+class Lz4Codec {
+public:
+    /// Returns the size of the compressed data in the worst case.
+    static ui32 getMaxCompressedSize( ui32 size );
+    /// Compresses the data, returns the compressed size or 0 if the capacity is less than getMaxCompressedSize.
+    static ui32 compress( const uc8 *src, ui32 srcSize, uc8 *dst, ui32 dstCapacity );
+    /// Decompresses the data, returns false if the data is corrupt or does not decode to exactly dstSize bytes.
+    static bool decompress( const uc8 *src, ui32 srcSize, uc8 *dst, ui32 dstSize );
+};
+
+} // Namespace IO
+} // Namespace OSRE
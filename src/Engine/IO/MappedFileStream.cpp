@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "MappedFileStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+MappedFileStream::MappedFileStream() noexcept
+: Stream()
+, m_file()
+, m_pos( 0 ) {
+    // empty
+}
+
+MappedFileStream::MappedFileStream( const Uri &uri, AccessMode requestedAccess )
+: Stream( uri, requestedAccess )
+, m_file()
+, m_pos( 0 ) {
+    // empty
+}
+
+MappedFileStream::~MappedFileStream() {
+    if ( isOpen() ) {
+        MappedFileStream::close();
+    }
+}
+
+bool MappedFileStream::canRead() const {
+    return true;
+}
+
+bool MappedFileStream::canWrite() const {
+    return false;
+}
+
+bool MappedFileStream::canSeek() const {
+    return true;
+}
+
+bool MappedFileStream::canBeMapped() const {
+    return true;
+}
+
+bool MappedFileStream::open() {
+    if ( isOpen() ) {
+        return false;
+    }
+
+    const AccessMode mode( getAccessMode() );
+    if ( AccessMode::ReadAccess != mode && AccessMode::ReadAccessBinary != mode ) {
+        return false;
+    }
+
+    if ( !m_file.open( m_Uri.getAbsPath() ) ) {
+        m_file.close();
+        return false;
+    }
+    m_file.advise( MemoryMappedFile::AccessHint::Sequential );
+    m_pos = 0;
+
+    return true;
+}
+
+bool MappedFileStream::close() {
+    if ( !isOpen() ) {
+        return false;
+    }
+
+    m_file.close();
+    m_pos = 0;
+
+    return true;
+}
+
+ui64 MappedFileStream::getSize() const {
+    return m_file.getSize();
+}
+
+ui32 MappedFileStream::read( void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !isOpen() ) {
+        return 0;
+    }
+
+    const ui64 available( getSize() - m_pos );
+    if ( size > available ) {
+        size = static_cast<ui32>( available );
+    }
+    ::memcpy( buffer, m_file.getData() + m_pos, size );
+    m_pos += size;
+
+    return size;
+}
+
+ui32 MappedFileStream::readI32( i32 &value ) {
+    return read( &value, sizeof( i32 ) );
+}
+
+ui32 MappedFileStream::readUI32( ui32 &value ) {
+    return read( &value, sizeof( ui32 ) );
+}
+
+ui32 MappedFileStream::readF32( f32 &value ) {
+    return read( &value, sizeof( f32 ) );
+}
+
+ui32 MappedFileStream::readD32( d32 &value ) {
+    return read( &value, sizeof( d32 ) );
+}
+
+MappedFileStream::Position MappedFileStream::seek( Offset offset, Origin origin ) {
+    const i64 size( static_cast<i64>( getSize() ) );
+    i64 base( 0 );
+    if ( Origin::Current == origin ) {
+        base = static_cast<i64>( m_pos );
+    } else if ( Origin::End == origin ) {
+        base = size;
+    }
+    const i64 pos( base + offset );
+    m_pos = static_cast<Position>( pos < 0 ? 0 : std::min( pos, size ) );
+
+    return m_pos;
+}
+
+MappedFileStream::Position MappedFileStream::tell() {
+    return m_pos;
+}
+
+bool MappedFileStream::isOpen() const {
+    return m_file.isOpen();
+}
+
+ui32 MappedFileStream::readAt( Position offset, void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !isOpen() || offset >= getSize() ) {
+        return 0;
+    }
+
+    const ui64 available( getSize() - offset );
+    if ( size > available ) {
+        size = static_cast<ui32>( available );
+    }
+    ::memcpy( buffer, m_file.getData() + offset, size );
+
+    return size;
+}
+
+const uc8 *MappedFileStream::map( ui64 &size ) {
+    size = getSize();
+    return m_file.getData();
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,86 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/IO/Stream.h>
+#include <osre/IO/MemoryMappedFile.h>
+
+namespace OSRE {
+namespace IO {
+
+//--------------------------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	This class implements a read-only file stream onto a memory mapped file. Reads copy out of the 
+/// mapping without any system call, map returns the file content without a copy at all.
+//--------------------------------------------------------------------------------------------------------------------
+class MappedFileStream : public Stream {
+public:
+    /// The default class constructor.
+    MappedFileStream() noexcept;
+    /// The class constructor with URI and access mode.
+    MappedFileStream( const Uri &uri, AccessMode requestedAccess );
+    /// The class destructor.
+    ~MappedFileStream();
+    /// true, the file is readable.
+    bool canRead() const;
+    /// false, the mapping is read-only.
+    bool canWrite() const;
+    /// true, any position can be reached.
+    bool canSeek() const;
+    /// true, the file is mapped.
+    bool canBeMapped() const;
+    /// Maps the file, only read access is supported.
+    bool open();
+    /// Unmaps the file.
+    bool close();
+    /// Returns file size.
+    ui64 getSize() const;
+    /// Reads from the mapping.
+    ui32 read( void *buffer, ui32 size );
+    /// Reads from the mapping without moving the position, can be used by several threads at once.
+    ui32 readAt( Position offset, void *buffer, ui32 size );
+    /// Reads a single integer value.
+    ui32 readI32( i32 &value );
+    /// Reads a single unsigned integer value.
+    ui32 readUI32( ui32 &value );
+    /// Reads a single float value.
+    ui32 readF32( f32 &value );
+    /// Reads a single double value.
+    ui32 readD32( d32 &value );
+    /// Moves to given position.
+    Position seek( Offset offset, Origin origin );
+    /// Position in the file.
+    Position tell();
+    /// Returns true, when the file is mapped.
+    bool isOpen() const;
+    /// Returns the mapped file content.
+    const uc8 *map( ui64 &size );
+
+private:
+    MemoryMappedFile m_file;
+    Position m_pos;
+};
+
+} // Namespace IO
+} // Namespace OSRE
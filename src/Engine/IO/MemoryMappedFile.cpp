@@ -0,0 +1,170 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/IO/MemoryMappedFile.h>
+#include <osre/Common/Logger.h>
+
+#ifdef OSRE_WINDOWS
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "MemoryMappedFile";
+
+MemoryMappedFile::MemoryMappedFile()
+: m_data( nullptr )
+, m_size( 0 )
+#ifdef OSRE_WINDOWS
+, m_file( nullptr )
+, m_mapping( nullptr )
+#endif
+{
+    // empty
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    close();
+}
+
+bool MemoryMappedFile::open( const String &filename ) {
+    close();
+    if ( filename.empty() ) {
+        return false;
+    }
+
+#ifdef OSRE_WINDOWS
+    HANDLE file( ::CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 
+            FILE_ATTRIBUTE_NORMAL, nullptr ) );
+    if ( INVALID_HANDLE_VALUE == file ) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if ( !::GetFileSizeEx( file, &size ) || 0 == size.QuadPart ) {
+        ::CloseHandle( file );
+        return false;
+    }
+
+    HANDLE mapping( ::CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr ) );
+    if ( nullptr == mapping ) {
+        ::CloseHandle( file );
+        osre_error( Tag, "Cannot map file " + filename );
+        return false;
+    }
+
+    m_data = static_cast<uc8*>( ::MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 ) );
+    if ( nullptr == m_data ) {
+        ::CloseHandle( mapping );
+        ::CloseHandle( file );
+        osre_error( Tag, "Cannot map file " + filename );
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_size = static_cast<ui64>( size.QuadPart );
+#else
+    const int fd( ::open( filename.c_str(), O_RDONLY ) );
+    if ( -1 == fd ) {
+        return false;
+    }
+
+    struct stat info;
+    if ( 0 != ::fstat( fd, &info ) || 0 == info.st_size ) {
+        ::close( fd );
+        return false;
+    }
+
+    void *data( ::mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 ) );
+
+    // The mapping stays valid after closing the descriptor
+    ::close( fd );
+    if ( MAP_FAILED == data ) {
+        osre_error( Tag, "Cannot map file " + filename );
+        return false;
+    }
+    m_data = static_cast<uc8*>( data );
+    m_size = static_cast<ui64>( info.st_size );
+#endif
+
+    return true;
+}
+
+void MemoryMappedFile::advise( AccessHint hint, ui64 offset, ui64 size ) {
+    if ( nullptr == m_data || offset >= m_size ) {
+        return;
+    }
+    if ( 0 == size || size > m_size - offset ) {
+        size = m_size - offset;
+    }
+
+#ifdef OSRE_WINDOWS
+    // Windows reads ahead by itself, prefetching is not available on all supported versions
+    ( void ) hint;
+#else
+    // madvise needs a page aligned address
+    const ui64 pageSize( static_cast<ui64>( ::sysconf( _SC_PAGESIZE ) ) );
+    const ui64 begin( offset - offset % pageSize );
+    int advice( MADV_NORMAL );
+    switch ( hint ) {
+        case AccessHint::Sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case AccessHint::Random:
+            advice = MADV_RANDOM;
+            break;
+        case AccessHint::WillNeed:
+            advice = MADV_WILLNEED;
+            break;
+        default:
+            break;
+    }
+    ::madvise( m_data + begin, static_cast<size_t>( offset + size - begin ), advice );
+#endif
+}
+
+void MemoryMappedFile::close() {
+    if ( nullptr == m_data ) {
+        return;
+    }
+
+#ifdef OSRE_WINDOWS
+    ::UnmapViewOfFile( m_data );
+    ::CloseHandle( m_mapping );
+    ::CloseHandle( m_file );
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    ::munmap( m_data, static_cast<size_t>( m_size ) );
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,221 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/IO/MemoryStream.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+MemoryStream::MemoryStream()
+: Stream( Uri(), AccessMode::ReadWriteAccess )
+, m_buffer()
+, m_view( nullptr )
+, m_viewSize( 0 )
+, m_pos( 0 )
+, m_isOpen( true ) {
+    // empty
+}
+
+MemoryStream::MemoryStream( const void *data, ui64 size )
+: Stream( Uri(), AccessMode::ReadAccessBinary )
+, m_buffer()
+, m_view( static_cast<const uc8*>( data ) )
+, m_viewSize( nullptr != data ? size : 0 )
+, m_pos( 0 )
+, m_isOpen( true ) {
+    // empty
+}
+
+MemoryStream::MemoryStream( std::vector<uc8> &&buffer )
+: Stream( Uri(), AccessMode::ReadWriteAccess )
+, m_buffer( std::move( buffer ) )
+, m_view( nullptr )
+, m_viewSize( 0 )
+, m_pos( 0 )
+, m_isOpen( true ) {
+    // empty
+}
+
+MemoryStream::~MemoryStream() {
+    // empty
+}
+
+bool MemoryStream::canRead() const {
+    return true;
+}
+
+bool MemoryStream::canWrite() const {
+    return isOwner();
+}
+
+bool MemoryStream::canSeek() const {
+    return true;
+}
+
+bool MemoryStream::canBeMapped() const {
+    return true;
+}
+
+bool MemoryStream::open() {
+    if ( m_isOpen ) {
+        return false;
+    }
+
+    m_isOpen = true;
+    m_pos = 0;
+
+    return true;
+}
+
+bool MemoryStream::close() {
+    if ( !m_isOpen ) {
+        return false;
+    }
+
+    // The content stays, the stream can be opened again to read it
+    m_isOpen = false;
+    m_pos = 0;
+
+    return true;
+}
+
+ui64 MemoryStream::getSize() const {
+    return isOwner() ? static_cast<ui64>( m_buffer.size() ) : m_viewSize;
+}
+
+ui32 MemoryStream::read( void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !m_isOpen ) {
+        return 0;
+    }
+
+    const ui64 available( getSize() - m_pos );
+    if ( size > available ) {
+        size = static_cast<ui32>( available );
+    }
+    if ( 0 != size ) {
+        ::memcpy( buffer, getData() + m_pos, size );
+        m_pos += size;
+    }
+
+    return size;
+}
+
+ui32 MemoryStream::write( const void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !m_isOpen || !isOwner() ) {
+        return 0;
+    }
+
+    if ( m_pos + size > m_buffer.size() ) {
+        m_buffer.resize( m_pos + size );
+    }
+    ::memcpy( &m_buffer[ m_pos ], buffer, size );
+    m_pos += size;
+
+    return size;
+}
+
+ui32 MemoryStream::readI32( i32 &value ) {
+    return read( &value, sizeof( i32 ) );
+}
+
+ui32 MemoryStream::writeI32( i32 value ) {
+    return write( &value, sizeof( i32 ) );
+}
+
+ui32 MemoryStream::readUI32( ui32 &value ) {
+    return read( &value, sizeof( ui32 ) );
+}
+
+ui32 MemoryStream::writeUI32( ui32 value ) {
+    return write( &value, sizeof( ui32 ) );
+}
+
+ui32 MemoryStream::readF32( f32 &value ) {
+    return read( &value, sizeof( f32 ) );
+}
+
+ui32 MemoryStream::writeF32( f32 value ) {
+    return write( &value, sizeof( f32 ) );
+}
+
+ui32 MemoryStream::readD32( d32 &value ) {
+    return read( &value, sizeof( d32 ) );
+}
+
+ui32 MemoryStream::writeD32( d32 value ) {
+    return write( &value, sizeof( d32 ) );
+}
+
+MemoryStream::Position MemoryStream::seek( Offset offset, Origin origin ) {
+    const i64 size( static_cast<i64>( getSize() ) );
+    i64 base( 0 );
+    if ( Origin::Current == origin ) {
+        base = static_cast<i64>( m_pos );
+    } else if ( Origin::End == origin ) {
+        base = size;
+    }
+    const i64 pos( base + offset );
+    m_pos = static_cast<Position>( pos < 0 ? 0 : std::min( pos, size ) );
+
+    return m_pos;
+}
+
+MemoryStream::Position MemoryStream::tell() {
+    return m_pos;
+}
+
+bool MemoryStream::isOpen() const {
+    return m_isOpen;
+}
+
+ui32 MemoryStream::readAt( Position offset, void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !isOpen() || offset >= getSize() ) {
+        return 0;
+    }
+
+    const ui64 available( getSize() - offset );
+    if ( size > available ) {
+        size = static_cast<ui32>( available );
+    }
+    ::memcpy( buffer, getData() + offset, size );
+
+    return size;
+}
+
+const uc8 *MemoryStream::map( ui64 &size ) {
+    size = getSize();
+    return getData();
+}
+
+const uc8 *MemoryStream::getData() const {
+    if ( !isOwner() ) {
+        return m_view;
+    }
+
+    return m_buffer.empty() ? nullptr : &m_buffer[ 0 ];
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -1,5 +0,0 @@
-#pragma once
-
-namespace OSRE {
-
-}
\ No newline at end of file
@@ -0,0 +1,265 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/IO/PakArchive.h>
+#include <osre/IO/MemoryMappedFile.h>
+#include <osre/Common/Logger.h>
+#include <osre/Threading/ThreadPool.h>
+#include "Lz4Codec.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "PakArchive";
+
+const c8 PakArchive::Magic[ 4 ] = { 'O', 'P', 'A', 'K' };
+const ui32 PakArchive::Version = 1;
+const ui32 PakArchive::DefaultChunkSize = 64 * 1024;
+const ui32 PakArchive::Alignment = 4096;
+
+// Compressed entries only need an aligned chunk table
+static const ui32 TableAlignment = 8;
+
+String PakArchive::normalizeName( const String &name ) {
+    String normalized( name );
+    std::replace( normalized.begin(), normalized.end(), '\\', '/' );
+    while ( 0 == normalized.find( "./" ) ) {
+        normalized.erase( 0, 2 );
+    }
+    while ( !normalized.empty() && '/' == normalized[ 0 ] ) {
+        normalized.erase( 0, 1 );
+    }
+
+    return normalized;
+}
+
+ui64 PakArchive::hashName( const String &name ) {
+    // FNV-1a
+    ui64 hash( 14695981039346656037ull );
+    for ( const c8 c : name ) {
+        hash ^= static_cast<uc8>( c );
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+ui64 PakArchive::getNumChunks( ui64 size, ui32 chunkSize ) {
+    return ( size + chunkSize - 1 ) / chunkSize;
+}
+
+static void compressChunk( PakArchive::Codec codec, const uc8 *src, ui32 size, std::vector<uc8> &chunk ) {
+    ui32 packedSize( 0 );
+    if ( PakArchive::Codec::LZ4 == codec ) {
+        chunk.resize( Lz4Codec::getMaxCompressedSize( size ) );
+        packedSize = Lz4Codec::compress( src, size, &chunk[ 0 ], static_cast<ui32>( chunk.size() ) );
+    } else if ( PakArchive::Codec::Deflate == codec ) {
+        uLongf destSize( compressBound( size ) );
+        chunk.resize( destSize );
+        if ( Z_OK == compress2( &chunk[ 0 ], &destSize, src, size, Z_BEST_COMPRESSION ) ) {
+            packedSize = static_cast<ui32>( destSize );
+        }
+    }
+
+    // A chunk of the uncompressed size is stored as it is
+    if ( 0 == packedSize || packedSize >= size ) {
+        chunk.assign( src, src + size );
+    } else {
+        chunk.resize( packedSize );
+    }
+}
+
+static ui64 alignOffset( ui64 offset, ui32 alignment ) {
+    return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+static bool writePadding( FILE *file, ui64 &pos, ui64 target ) {
+    static const uc8 Zeros[ 256 ] = { 0 };
+    while ( pos < target ) {
+        const size_t num( static_cast<size_t>( std::min<ui64>( sizeof( Zeros ), target - pos ) ) );
+        if ( num != ::fwrite( Zeros, 1, num, file ) ) {
+            return false;
+        }
+        pos += num;
+    }
+
+    return true;
+}
+
+PakWriter::PakWriter( ui32 chunkSize )
+: m_chunkSize( 0 == chunkSize ? PakArchive::DefaultChunkSize : chunkSize )
+, m_items()
+, m_pool( new Threading::ThreadPool ) {
+    // empty
+}
+
+PakWriter::~PakWriter() {
+    delete m_pool;
+    m_pool = nullptr;
+}
+
+bool PakWriter::addData( const String &name, const void *data, ui64 size, PakArchive::Codec codec ) {
+    const String normalized( PakArchive::normalizeName( name ) );
+    if ( normalized.empty() || ( nullptr == data && 0 != size ) ) {
+        return false;
+    }
+    for ( const Item &item : m_items ) {
+        if ( item.m_name == normalized ) {
+            osre_debug( Tag, "Entry " + normalized + " exists already." );
+            return false;
+        }
+    }
+
+    Item item;
+    item.m_name = normalized;
+    item.m_size = size;
+    item.m_codec = PakArchive::Codec::Stored;
+    const uc8 *src( static_cast<const uc8*>( data ) );
+    const ui64 numChunks( PakArchive::getNumChunks( size, m_chunkSize ) );
+    if ( PakArchive::Codec::Stored != codec && numChunks > 0 && numChunks <= 0xFFFFFFFFu ) {
+        std::vector<std::vector<uc8>> chunks( static_cast<size_t>( numChunks ) );
+        m_pool->parallelFor( static_cast<ui32>( numChunks ), 1, [ & ]( ui32 begin, ui32 end ) {
+            for ( ui32 i = begin; i < end; ++i ) {
+                const ui64 offset( static_cast<ui64>( i ) * m_chunkSize );
+                compressChunk( codec, src + offset, static_cast<ui32>( std::min<ui64>( m_chunkSize, size - offset ) ), chunks[ i ] );
+            }
+        } );
+
+        ui64 packedSize( numChunks * sizeof( ui32 ) );
+        for ( const std::vector<uc8> &chunk : chunks ) {
+            packedSize += chunk.size();
+        }
+
+        // Data which does not compress is stored, so it can be mapped
+        if ( packedSize < size ) {
+            item.m_codec = codec;
+            item.m_data.resize( static_cast<size_t>( packedSize ) );
+            uc8 *dst( &item.m_data[ 0 ] );
+            for ( const std::vector<uc8> &chunk : chunks ) {
+                const ui32 chunkSize( static_cast<ui32>( chunk.size() ) );
+                ::memcpy( dst, &chunkSize, sizeof( ui32 ) );
+                dst += sizeof( ui32 );
+            }
+            for ( const std::vector<uc8> &chunk : chunks ) {
+                ::memcpy( dst, &chunk[ 0 ], chunk.size() );
+                dst += chunk.size();
+            }
+        }
+    }
+    if ( PakArchive::Codec::Stored == item.m_codec && 0 != size ) {
+        item.m_data.assign( src, src + size );
+    }
+    m_items.push_back( std::move( item ) );
+
+    return true;
+}
+
+bool PakWriter::addFile( const String &name, const String &filename, PakArchive::Codec codec ) {
+    MemoryMappedFile file;
+    if ( file.open( filename ) ) {
+        return addData( name, file.getData(), file.getSize(), codec );
+    }
+
+    // Empty files cannot be mapped
+    FILE *f( ::fopen( filename.c_str(), "rb" ) );
+    if ( nullptr == f ) {
+        osre_debug( Tag, "Cannot open " + filename );
+        return false;
+    }
+    const bool empty( EOF == ::fgetc( f ) );
+    ::fclose( f );
+
+    return empty && addData( name, nullptr, 0, codec );
+}
+
+bool PakWriter::write( const String &filename ) const {
+    // The data is written in the order the entries were added, the index is sorted by the hashes
+    std::vector<PakArchive::Entry> entries( m_items.size() );
+    String names;
+    ui64 offset( sizeof( PakArchive::Header ) );
+    for ( size_t i = 0; i < m_items.size(); ++i ) {
+        const Item &item( m_items[ i ] );
+        PakArchive::Entry &entry( entries[ i ] );
+        ::memset( &entry, 0, sizeof( PakArchive::Entry ) );
+        offset = alignOffset( offset, PakArchive::Codec::Stored == item.m_codec ? PakArchive::Alignment : TableAlignment );
+        entry.m_hash = PakArchive::hashName( item.m_name );
+        entry.m_offset = offset;
+        entry.m_size = item.m_size;
+        entry.m_packedSize = item.m_data.size();
+        entry.m_nameOffset = static_cast<ui32>( names.size() );
+        entry.m_nameLength = static_cast<ui32>( item.m_name.size() );
+        entry.m_codec = static_cast<uc8>( item.m_codec );
+        names += item.m_name;
+        offset += entry.m_packedSize;
+    }
+
+    std::vector<PakArchive::Entry> index( entries );
+    std::sort( index.begin(), index.end(), [ & ]( const PakArchive::Entry &a, const PakArchive::Entry &b ) {
+        if ( a.m_hash != b.m_hash ) {
+            return a.m_hash < b.m_hash;
+        }
+        return names.compare( a.m_nameOffset, a.m_nameLength, names, b.m_nameOffset, b.m_nameLength ) < 0;
+    } );
+
+    PakArchive::Header header;
+    ::memset( &header, 0, sizeof( PakArchive::Header ) );
+    ::memcpy( header.m_magic, PakArchive::Magic, sizeof( header.m_magic ) );
+    header.m_version = PakArchive::Version;
+    header.m_numEntries = static_cast<ui32>( index.size() );
+    header.m_chunkSize = m_chunkSize;
+    header.m_indexOffset = alignOffset( offset, TableAlignment );
+    header.m_namesOffset = header.m_indexOffset + index.size() * sizeof( PakArchive::Entry );
+    header.m_namesSize = names.size();
+
+    FILE *file( ::fopen( filename.c_str(), "wb" ) );
+    if ( nullptr == file ) {
+        osre_error( Tag, "Cannot write " + filename );
+        return false;
+    }
+
+    ui64 pos( sizeof( PakArchive::Header ) );
+    bool ok( 1 == ::fwrite( &header, sizeof( PakArchive::Header ), 1, file ) );
+    for ( size_t i = 0; ok && i < m_items.size(); ++i ) {
+        const std::vector<uc8> &data( m_items[ i ].m_data );
+        ok = writePadding( file, pos, entries[ i ].m_offset ) && ( data.empty() || data.size() == ::fwrite( &data[ 0 ], 1, data.size(), file ) );
+        pos += data.size();
+    }
+    ok = ok && writePadding( file, pos, header.m_indexOffset );
+    ok = ok && ( index.empty() || index.size() == ::fwrite( &index[ 0 ], sizeof( PakArchive::Entry ), index.size(), file ) );
+    ok = ok && ( names.empty() || names.size() == ::fwrite( names.c_str(), 1, names.size(), file ) );
+    ok = ( 0 == ::fclose( file ) ) && ok;
+    if ( !ok ) {
+        osre_error( Tag, "Cannot write " + filename );
+        ::remove( filename.c_str() );
+    }
+
+    return ok;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,298 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "PakFileStream.h"
+#include "Lz4Codec.h"
+
+#include <osre/Common/Logger.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+static const String Tag = "PakFileStream";
+static const ui64 NoChunk = ~0ull;
+
+PakFileStream::PakFileStream( const Uri &uri, const PakArchive::Entry &entry, const uc8 *archiveData, ui32 chunkSize, 
+        Threading::ThreadPool *pool )
+: Stream( uri, AccessMode::ReadAccessBinary )
+, m_entry( entry )
+, m_data( archiveData + entry.m_offset )
+, m_chunkSize( chunkSize )
+, m_pool( pool )
+, m_chunkOffsets()
+, m_chunk()
+, m_cachedChunk( NoChunk )
+, m_pos( 0 )
+, m_isOpen( false ) {
+    // empty
+}
+
+PakFileStream::~PakFileStream() {
+    // empty
+}
+
+bool PakFileStream::canRead() const {
+    return true;
+}
+
+bool PakFileStream::canSeek() const {
+    return true;
+}
+
+bool PakFileStream::canBeMapped() const {
+    return PakArchive::Codec::Stored == static_cast<PakArchive::Codec>( m_entry.m_codec );
+}
+
+bool PakFileStream::open() {
+    if ( m_isOpen ) {
+        return false;
+    }
+
+    m_pos = 0;
+    if ( canBeMapped() ) {
+        m_isOpen = true;
+        return true;
+    }
+
+    // The chunk table is turned into the offsets of the chunks
+    const ui64 numChunks( PakArchive::getNumChunks( m_entry.m_size, m_chunkSize ) );
+    if ( numChunks * sizeof( ui32 ) > m_entry.m_packedSize ) {
+        osre_error( Tag, "Invalid chunk table of " + getUri().getAbsPath() );
+        return false;
+    }
+    m_chunkOffsets.resize( static_cast<size_t>( numChunks + 1 ) );
+    m_chunkOffsets[ 0 ] = numChunks * sizeof( ui32 );
+    for ( ui64 i = 0; i < numChunks; ++i ) {
+        ui32 packedSize( 0 );
+        ::memcpy( &packedSize, m_data + i * sizeof( ui32 ), sizeof( ui32 ) );
+        if ( packedSize > getChunkSize( i ) ) {
+            osre_error( Tag, "Invalid chunk table of " + getUri().getAbsPath() );
+            m_chunkOffsets.clear();
+            return false;
+        }
+        m_chunkOffsets[ i + 1 ] = m_chunkOffsets[ i ] + packedSize;
+    }
+    if ( m_chunkOffsets[ numChunks ] > m_entry.m_packedSize ) {
+        osre_error( Tag, "Invalid chunk table of " + getUri().getAbsPath() );
+        m_chunkOffsets.clear();
+        return false;
+    }
+    m_isOpen = true;
+
+    return true;
+}
+
+bool PakFileStream::close() {
+    if ( !m_isOpen ) {
+        return false;
+    }
+
+    m_chunkOffsets.clear();
+    m_chunk.clear();
+    m_cachedChunk = NoChunk;
+    m_pos = 0;
+    m_isOpen = false;
+
+    return true;
+}
+
+ui64 PakFileStream::getSize() const {
+    return m_entry.m_size;
+}
+
+ui32 PakFileStream::read( void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !m_isOpen ) {
+        return 0;
+    }
+
+    const ui32 bytesRead( readRange( m_pos, static_cast<uc8*>( buffer ), size, true ) );
+    m_pos += bytesRead;
+
+    return bytesRead;
+}
+
+ui32 PakFileStream::readAt( Position offset, void *buffer, ui32 size ) {
+    if ( nullptr == buffer || 0 == size || !m_isOpen ) {
+        return 0;
+    }
+
+    return readRange( offset, static_cast<uc8*>( buffer ), size, false );
+}
+
+ui32 PakFileStream::readI32( i32 &value ) {
+    return read( &value, sizeof( i32 ) );
+}
+
+ui32 PakFileStream::readUI32( ui32 &value ) {
+    return read( &value, sizeof( ui32 ) );
+}
+
+ui32 PakFileStream::readF32( f32 &value ) {
+    return read( &value, sizeof( f32 ) );
+}
+
+ui32 PakFileStream::readD32( d32 &value ) {
+    return read( &value, sizeof( d32 ) );
+}
+
+PakFileStream::Position PakFileStream::seek( Offset offset, Origin origin ) {
+    const i64 size( static_cast<i64>( getSize() ) );
+    i64 base( 0 );
+    if ( Origin::Current == origin ) {
+        base = static_cast<i64>( m_pos );
+    } else if ( Origin::End == origin ) {
+        base = size;
+    }
+    const i64 pos( base + offset );
+    m_pos = static_cast<Position>( pos < 0 ? 0 : std::min( pos, size ) );
+
+    return m_pos;
+}
+
+PakFileStream::Position PakFileStream::tell() {
+    return m_pos;
+}
+
+bool PakFileStream::isOpen() const {
+    return m_isOpen;
+}
+
+const uc8 *PakFileStream::map( ui64 &size ) {
+    if ( !m_isOpen || !canBeMapped() ) {
+        size = 0;
+        return nullptr;
+    }
+
+    size = m_entry.m_size;
+    return m_data;
+}
+
+ui32 PakFileStream::getChunkSize( ui64 chunk ) const {
+    return static_cast<ui32>( std::min<ui64>( m_chunkSize, m_entry.m_size - chunk * m_chunkSize ) );
+}
+
+bool PakFileStream::decodeChunk( ui64 chunk, uc8 *dst ) const {
+    const ui32 size( getChunkSize( chunk ) );
+    const uc8 *src( m_data + m_chunkOffsets[ chunk ] );
+    const ui32 packedSize( static_cast<ui32>( m_chunkOffsets[ chunk + 1 ] - m_chunkOffsets[ chunk ] ) );
+    if ( packedSize == size ) {
+        ::memcpy( dst, src, size );
+        return true;
+    }
+
+    bool ok( false );
+    const PakArchive::Codec codec( static_cast<PakArchive::Codec>( m_entry.m_codec ) );
+    if ( PakArchive::Codec::LZ4 == codec ) {
+        ok = Lz4Codec::decompress( src, packedSize, dst, size );
+    } else if ( PakArchive::Codec::Deflate == codec ) {
+        uLongf destSize( size );
+        ok = Z_OK == uncompress( dst, &destSize, src, packedSize ) && size == destSize;
+    }
+    if ( !ok ) {
+        osre_error( Tag, "Corrupt chunk in " + getUri().getAbsPath() );
+    }
+
+    return ok;
+}
+
+ui32 PakFileStream::readRange( Position offset, uc8 *dst, ui32 size, bool useCache ) {
+    if ( offset >= m_entry.m_size ) {
+        return 0;
+    }
+    if ( size > m_entry.m_size - offset ) {
+        size = static_cast<ui32>( m_entry.m_size - offset );
+    }
+    if ( canBeMapped() ) {
+        ::memcpy( dst, m_data + offset, size );
+        return size;
+    }
+
+    const ui64 numChunks( m_chunkOffsets.size() - 1 );
+    std::vector<uc8> temp;
+    ui32 done( 0 );
+    while ( done < size ) {
+        const ui64 pos( offset + done );
+        const ui64 chunk( pos / m_chunkSize );
+        const ui32 inChunk( static_cast<ui32>( pos % m_chunkSize ) );
+        const ui32 chunkSize( getChunkSize( chunk ) );
+        const ui32 num( std::min( chunkSize - inChunk, size - done ) );
+        if ( 0 == inChunk && num == chunkSize ) {
+            // Whole chunks go directly into the buffer
+            ui32 count( 0 );
+            ui32 bytes( 0 );
+            while ( chunk + count < numChunks && getChunkSize( chunk + count ) <= size - done - bytes ) {
+                bytes += getChunkSize( chunk + count );
+                ++count;
+            }
+
+            std::atomic<bool> ok( true );
+            uc8 *base( dst + done );
+            auto decode = [ this, chunk, base, &ok ]( ui32 begin, ui32 end ) {
+                for ( ui32 i = begin; i < end; ++i ) {
+                    if ( !decodeChunk( chunk + i, base + static_cast<ui64>( i ) * m_chunkSize ) ) {
+                        ok = false;
+                    }
+                }
+            };
+            if ( nullptr != m_pool && count > 1 ) {
+                m_pool->parallelFor( count, 1, decode );
+            } else {
+                decode( 0, count );
+            }
+            if ( !ok ) {
+                return done;
+            }
+            done += bytes;
+            continue;
+        }
+
+        // Parts of a chunk are copied out of a decompressed chunk
+        const uc8 *src( nullptr );
+        if ( useCache ) {
+            if ( m_cachedChunk != chunk ) {
+                m_chunk.resize( m_chunkSize );
+                m_cachedChunk = decodeChunk( chunk, &m_chunk[ 0 ] ) ? chunk : NoChunk;
+            }
+            src = NoChunk == m_cachedChunk ? nullptr : &m_chunk[ 0 ];
+        } else {
+            temp.resize( m_chunkSize );
+            src = decodeChunk( chunk, &temp[ 0 ] ) ? &temp[ 0 ] : nullptr;
+        }
+        if ( nullptr == src ) {
+            return done;
+        }
+        ::memcpy( dst + done, src + inChunk, num );
+        done += num;
+    }
+
+    return done;
+}
+
+} // Namespace IO
+} // Namespace OSRE
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/IO/Stream.h>
+#include <osre/IO/PakArchive.h>
+
+#include <vector>
+
+namespace OSRE {
+namespace IO {
+
+//--------------------------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	File instance for an entry of a pak archive. 
+///
+/// Stored entries are read from the mapping of the archive and can be mapped. Compressed entries are decompressed 
+/// chunk by chunk, the last partly read chunk is kept for following reads. Whole chunks are decompressed directly 
+/// into the buffer and in parallel. readAt does not use the kept chunk and can be used by several threads at once.
+//--------------------------------------------------------------------------------------------------------------------
+class PakFileStream : public Stream {
+public:
+    /// The class constructor with the entry, the data of the archive and a pool for parallel decompression.
+    PakFileStream( const Uri &uri, const PakArchive::Entry &entry, const uc8 *archiveData, ui32 chunkSize, 
+            Threading::ThreadPool *pool );
+    /// The class destructor.
+    ~PakFileStream();
+    /// Read operations are supported.
+    bool canRead() const;
+    /// Seek operations are supported.
+    bool canSeek() const;
+    /// Stored entries can be mapped.
+    bool canBeMapped() const;
+    /// Reads the chunk table.
+    bool open();
+    /// Releases the kept chunk.
+    bool close();
+    /// Returns the uncompressed size of the entry.
+    ui64 getSize() const;
+    /// Reads from the entry.
+    ui32 read( void *buffer, ui32 size );
+    /// Reads without moving the position.
+    ui32 readAt( Position offset, void *buffer, ui32 size );
+    /// Reads a single integer value.
+    ui32 readI32( i32 &value );
+    /// Reads a single unsigned integer value.
+    ui32 readUI32( ui32 &value );
+    /// Reads a single float value.
+    ui32 readF32( f32 &value );
+    /// Reads a single double value.
+    ui32 readD32( d32 &value );
+    /// Moves to given position.
+    Position seek( Offset offset, Origin origin );
+    /// Position in the entry.
+    Position tell();
+    /// Returns true, when the chunk table was read.
+    bool isOpen() const;
+    /// Returns the data of a stored entry, nullptr for compressed entries.
+    const uc8 *map( ui64 &size );
+
+private:
+    ui32 getChunkSize( ui64 chunk ) const;
+    bool decodeChunk( ui64 chunk, uc8 *dst ) const;
+    ui32 readRange( Position offset, uc8 *dst, ui32 size, bool useCache );
+
+private:
+    PakArchive::Entry m_entry;
+    const uc8 *m_data;
+    ui32 m_chunkSize;
+    Threading::ThreadPool *m_pool;
+    std::vector<ui64> m_chunkOffsets;
+    std::vector<uc8> m_chunk;
+    ui64 m_cachedChunk;
+    Position m_pos;
+    bool m_isOpen;
+};
+
+} // Namespace IO
+} // Namespace OSRE
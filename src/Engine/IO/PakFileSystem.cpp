@@ -0,0 +1,199 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "PakFileSystem.h"
+#include "PakFileStream.h"
+
+#include <osre/Common/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace OSRE {
+namespace IO {
+
+static const String PakSchema = "pak";
+static const String Tag = "PakFileSystem";
+
+PakFileSystem::PakFileSystem( const Uri &archive )
+: AbstractFileSystem()
+, m_file()
+, m_header( nullptr )
+, m_entries( nullptr )
+, m_names( nullptr )
+, m_pool()
+, m_mutex()
+, m_streams() {
+    if ( !openArchive( archive.getAbsPath() ) ) {
+        m_file.close();
+    }
+}
+
+PakFileSystem::~PakFileSystem() {
+    for ( Stream *stream : m_streams ) {
+        delete stream;
+    }
+    m_streams.clear();
+    m_file.close();
+}
+
+Stream *PakFileSystem::open( const Uri &file, Stream::AccessMode mode ) {
+    if ( !isOpen() || ( Stream::AccessMode::ReadAccess != mode && Stream::AccessMode::ReadAccessBinary != mode ) ) {
+        return nullptr;
+    }
+
+    const PakArchive::Entry *entry( findEntry( PakArchive::normalizeName( file.getAbsPath() ) ) );
+    if ( nullptr == entry ) {
+        return nullptr;
+    }
+
+    Stream *stream( new PakFileStream( file, *entry, m_file.getData(), m_header->m_chunkSize, &m_pool ) );
+    if ( !stream->open() ) {
+        delete stream;
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_streams.insert( stream );
+
+    return stream;
+}
+
+void PakFileSystem::close( Stream **file ) {
+    if ( nullptr == file || nullptr == *file ) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        std::set<Stream*>::iterator it( m_streams.find( *file ) );
+        if ( m_streams.end() == it ) {
+            return;
+        }
+        m_streams.erase( it );
+    }
+    delete *file;
+    *file = nullptr;
+}
+
+bool PakFileSystem::fileExist( const Uri &file ) {
+    return nullptr != findEntry( PakArchive::normalizeName( file.getAbsPath() ) );
+}
+
+Stream *PakFileSystem::find( const Uri &file, Stream::AccessMode mode, CPPCore::TArray<String> *searchPaths ) {
+    return open( file, mode );
+}
+
+const String &PakFileSystem::getSchema() const {
+    return PakSchema;
+}
+
+String PakFileSystem::getWorkingDirectory() {
+    return String( "" );
+}
+
+bool PakFileSystem::isThreadSafe() const {
+    return true;
+}
+
+bool PakFileSystem::isOpen() const {
+    return nullptr != m_header;
+}
+
+void PakFileSystem::getFileList( std::vector<String> &fileList ) const {
+    fileList.clear();
+    if ( !isOpen() ) {
+        return;
+    }
+
+    fileList.reserve( m_header->m_numEntries );
+    for ( ui32 i = 0; i < m_header->m_numEntries; ++i ) {
+        fileList.push_back( String( m_names + m_entries[ i ].m_nameOffset, m_entries[ i ].m_nameLength ) );
+    }
+}
+
+bool PakFileSystem::openArchive( const String &filename ) {
+    if ( !m_file.open( filename ) ) {
+        osre_debug( Tag, "Cannot open " + filename );
+        return false;
+    }
+
+    // Everything is validated once, streams rely on the offsets afterwards
+    const ui64 size( m_file.getSize() );
+    const uc8 *data( m_file.getData() );
+    if ( size < sizeof( PakArchive::Header ) ) {
+        osre_error( Tag, filename + " is not a pak archive." );
+        return false;
+    }
+    const PakArchive::Header *header( reinterpret_cast<const PakArchive::Header*>( data ) );
+    if ( 0 != ::memcmp( header->m_magic, PakArchive::Magic, sizeof( header->m_magic ) ) || PakArchive::Version != header->m_version ) {
+        osre_error( Tag, filename + " is not a pak archive." );
+        return false;
+    }
+    const ui64 indexSize( static_cast<ui64>( header->m_numEntries ) * sizeof( PakArchive::Entry ) );
+    if ( 0 == header->m_chunkSize || header->m_indexOffset > size || indexSize > size - header->m_indexOffset 
+            || header->m_namesOffset > size || header->m_namesSize > size - header->m_namesOffset ) {
+        osre_error( Tag, "Invalid index in " + filename );
+        return false;
+    }
+
+    const PakArchive::Entry *entries( reinterpret_cast<const PakArchive::Entry*>( data + header->m_indexOffset ) );
+    for ( ui32 i = 0; i < header->m_numEntries; ++i ) {
+        const PakArchive::Entry &entry( entries[ i ] );
+        const bool stored( static_cast<uc8>( PakArchive::Codec::Stored ) == entry.m_codec );
+        if ( entry.m_offset > size || entry.m_packedSize > size - entry.m_offset 
+                || static_cast<ui64>( entry.m_nameOffset ) + entry.m_nameLength > header->m_namesSize
+                || entry.m_codec > static_cast<uc8>( PakArchive::Codec::Deflate ) || ( stored && entry.m_size != entry.m_packedSize ) ) {
+            osre_error( Tag, "Invalid index in " + filename );
+            return false;
+        }
+    }
+
+    m_header = header;
+    m_entries = entries;
+    m_names = reinterpret_cast<const c8*>( data + header->m_namesOffset );
+    m_file.advise( MemoryMappedFile::AccessHint::Random );
+
+    return true;
+}
+
+const PakArchive::Entry *PakFileSystem::findEntry( const String &name ) const {
+    if ( !isOpen() || name.empty() ) {
+        return nullptr;
+    }
+
+    const ui64 hash( PakArchive::hashName( name ) );
+    const PakArchive::Entry *end( m_entries + m_header->m_numEntries );
+    const PakArchive::Entry *it( std::lower_bound( m_entries, end, hash, []( const PakArchive::Entry &entry, ui64 value ) {
+        return entry.m_hash < value;
+    } ) );
+    for ( ; end != it && hash == it->m_hash; ++it ) {
+        if ( name.size() == it->m_nameLength && 0 == ::memcmp( m_names + it->m_nameOffset, name.c_str(), name.size() ) ) {
+            return it;
+        }
+    }
+
+    return nullptr;
+}
+
+} // Namespace IO
+} // Namespace OSRE
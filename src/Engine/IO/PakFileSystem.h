@@ -0,0 +1,85 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <osre/IO/AbstractFileSystem.h>
+#include <osre/IO/MemoryMappedFile.h>
+#include <osre/IO/PakArchive.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace OSRE {
+namespace IO {
+
+//-------------------------------------------------------------------------------------------------
+///	@ingroup	Infrastructure
+///
+///	@brief	Class which implements the read access to pak archives. 
+///
+/// The archive is mapped into memory, the index and the entry data are used from the mapping. 
+/// Entries are looked up by a binary search on the hashes of their names.
+//-------------------------------------------------------------------------------------------------
+class PakFileSystem : public AbstractFileSystem {
+public:
+    ///	The class constructor with archive name.
+    explicit PakFileSystem( const Uri &archive );
+    ///	The class destructor.
+    virtual ~PakFileSystem();
+    ///	Opens an entry of the archive, only read access is supported.
+    virtual Stream *open( const Uri &filename, Stream::AccessMode mode );
+    ///	Closes an opened entry.
+    virtual void close( Stream **file );
+    ///	Returns true, if the entry exists in this archive.
+    virtual bool fileExist( const Uri &filename );
+    /// Search for a given entry.
+    virtual Stream *find( const Uri &file, Stream::AccessMode mode, CPPCore::TArray<String> *searchPaths );
+    ///	Returns the pak schema description.
+    virtual const String &getSchema() const;
+    ///	Returns the working directory.
+    virtual String getWorkingDirectory();
+    ///	Returns true, the index is read-only and the open streams are guarded by a mutex.
+    virtual bool isThreadSafe() const;
+    /// Returns true, if the archive is valid and open.
+    bool isOpen() const;
+    ///	Returns the names of all entries.
+    void getFileList( std::vector<String> &fileList ) const;
+
+private:
+    bool openArchive( const String &filename );
+    const PakArchive::Entry *findEntry( const String &name ) const;
+
+private:
+    MemoryMappedFile m_file;
+    const PakArchive::Header *m_header;
+    const PakArchive::Entry *m_entries;
+    const c8 *m_names;
+    Threading::ThreadPool m_pool;
+    std::mutex m_mutex;
+    std::set<Stream*> m_streams;
+};
+
+} // Namespace IO
+} // Namespace OSRE
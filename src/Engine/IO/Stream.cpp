@@ -73,7 +73,7 @@ Stream::AccessMode Stream::getAccessMode() const {
 	return m_AccessMode;
 }
 
-ui32 Stream::getSize() const {
+ui64 Stream::getSize() const {
 	return 0;
 }
 
@@ -81,6 +81,18 @@ ui32 Stream::read( void *buffer, ui32 size ) {
 	return 0;
 }
 
+ui32 Stream::readAt( Position offset, void *buffer, ui32 size ) {
+    const Position pos( tell() );
+    if ( offset != seek( static_cast<Offset>( offset ), Origin::Begin ) ) {
+        seek( static_cast<Offset>( pos ), Origin::Begin );
+        return 0;
+    }
+    const ui32 bytesRead( read( buffer, size ) );
+    seek( static_cast<Offset>( pos ), Origin::Begin );
+
+    return bytesRead;
+}
+
 ui32 Stream::write( const void *buffer, ui32 size ) {
 	return 0;
 }
@@ -129,6 +141,11 @@ bool Stream::isOpen() const {
 	return false;
 }
 
+const uc8 *Stream::map( ui64 &size ) {
+	size = 0;
+	return nullptr;
+}
+
 bool Stream::open() {
 	return false;
 }
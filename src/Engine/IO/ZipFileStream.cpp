@@ -21,87 +21,18 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include "ZipFileStream.h"
-#include <cassert>
-
-#include "unzip.h"
-
-#include <algorithm>
-#include <iostream>
 
 namespace OSRE {
 namespace IO {
 
-ZipFileStream::ZipFileStream( const Uri &uri, unzFile zipFile ) 
-: Stream( uri , AccessMode::ReadAccess )
-, m_zipFile( zipFile )
-, m_bDirty( true ) {
-	assert( NULL != zipFile );
+ZipFileStream::ZipFileStream( const Uri &uri, const String &entryName, const std::vector<uc8> &data ) 
+: MemoryStream( data.empty() ? nullptr : &data[ 0 ], static_cast<ui64>( data.size() ) )
+, m_entryName( entryName ) {
+	setUri( uri );
 }
 
 ZipFileStream::~ZipFileStream() {
-	if ( NULL != m_zipFile ) {
-		unzClose( m_zipFile );
-		m_zipFile = NULL;
-	}
-}
-
-bool ZipFileStream::canRead() const {
-	return true;
-}
-
-ui32 ZipFileStream::read( void *buffer, size_t size ) {
-	assert( NULL != buffer );
-	assert( NULL != m_zipFile );
-	
-	ui32 filesize = 0;
-    if ( 0 == size ) {
-        return filesize;
-    }
-
-	if ( NULL != m_zipFile ) {
-		// get the filename
-		const String &abspath = getUri().getAbsPath();
-
-		// search file and place file pointer there
-		if ( unzLocateFile( m_zipFile, abspath.c_str(), 0 ) == UNZ_OK ) {
-			// get file size, etc.
-			unz_file_info fileInfo;
-			unzGetCurrentFileInfo( m_zipFile, &fileInfo, 0, 0, 0, 0, 0, 0 );
-			assert( size <= fileInfo.uncompressed_size );
-			
-			// The file has EXACTLY the size of uncompressed_size. In C
-			// you need to mark the last character with '\0', so add 
-			// another character
-			unzOpenCurrentFile( m_zipFile );
-			i32 bytesRead = unzReadCurrentFile( m_zipFile, buffer, fileInfo.uncompressed_size);
-			if ( bytesRead < 0 || bytesRead != (i32) fileInfo.uncompressed_size ) {
-				return filesize;
-			}
-
-			filesize = fileInfo.uncompressed_size;
-			unzCloseCurrentFile( m_zipFile );
-		}
-	}
-
-	return filesize;
-}
-
-ui32 ZipFileStream::getSize() const {
-	// get the filename
-	const String &abspath = getUri().getAbsPath();
-
-	// look for the file and return its size
-	if ( unzLocateFile( m_zipFile, abspath.c_str(), 0) == UNZ_OK )  {
-		unz_file_info fileInfo;
-		unzGetCurrentFileInfo(m_zipFile, &fileInfo, 0, 0, 0, 0, 0, 0);
-		return fileInfo.uncompressed_size;
-	}
-
-	return 0;
-}
-
-bool ZipFileStream::isOpen() const {
-	return ( NULL != m_zipFile );
+	// empty
 }
 
 } // Namespace IO
@@ -22,9 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #pragma once
 
-#include <osre/IO/Stream.h>
-
-#include "unzip.h"
+#include <osre/IO/MemoryStream.h>
 
 namespace OSRE {
 namespace IO {
@@ -35,31 +33,27 @@ namespace IO {
 ///
 ///	@brief	File instance for files stored in a zip archive. 
 ///
-/// If you requests access to data in a zip archive the zip file-system will return you a pointer to a zip file. 
+/// The zip file system decompresses the entry into its cache, the stream reads from the cached data. The data stays 
+/// cached until the stream gets closed by the file system.
 //--------------------------------------------------------------------------------------------------------------------
-class ZipFileStream : public Stream {
+class ZipFileStream : public MemoryStream {
 public:
-	///	The class constructor.
-	ZipFileStream( const Uri &rURI, unzFile zipFile );
+	///	The class constructor with the entry name and the decompressed entry data.
+	ZipFileStream( const Uri &uri, const String &entryName, const std::vector<uc8> &data );
 	///	The class destructor.
 	~ZipFileStream();
-	///	Read operations are supported.
-	bool canRead() const;
-	///	Reads data from a file in a zip archive.
-	ui32 read( void *pBuffer, size_t size );
-	///	Returns the file size for a file stored in a zip archive.
-	ui32 getSize() const;
-	///	Returns true, if the file is currently open.
-	bool isOpen() const;
-
-private:
-	void sortFiles();
+	///	Returns the name of the entry in the archive.
+	const String &getEntryName() const;
 
 private:
-	unzFile m_zipFile;
-	bool m_bDirty;
+	String m_entryName;
 };
 
+inline
+const String &ZipFileStream::getEntryName() const {
+	return m_entryName;
+}
+
 //--------------------------------------------------------------------------------------------------------------------
 
 } // Namespace IO
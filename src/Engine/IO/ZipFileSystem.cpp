@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "unzip.h"
 #include <algorithm>
 #include <cassert>
+#include <memory>
 
 namespace OSRE {
 namespace IO {
@@ -37,13 +38,18 @@ using namespace ::CPPCore;
 static const String ZipSchema = "zip";
 static const String Tag = "ZipFileSystem";
 
+const ui64 ZipFileSystem::DefaultCacheBudget = 64 * 1024 * 1024;
+
 //-------------------------------------------------------------------------------------------------
 ZipFileSystem::ZipFileSystem( const Uri &archive ) 
-: m_FileMap()
+: m_index()
 , m_FileList()
 , m_ArchiveName( archive.getAbsPath() )
 , m_ZipFileHandle( nullptr )
-, m_Dirty( true ) {
+, m_freeHandles()
+, m_streams()
+, m_cache( DefaultCacheBudget )
+, m_mutex() {
     if ( openArchive() ) {
         mapArchive();
     }
@@ -52,6 +58,10 @@ ZipFileSystem::ZipFileSystem( const Uri &archive )
 //-------------------------------------------------------------------------------------------------
 ZipFileSystem::~ZipFileSystem() {
     closeAllFiles();
+    for ( unzFile handle : m_freeHandles ) {
+        unzClose( handle );
+    }
+    m_freeHandles.clear();
     if ( NULL != m_ZipFileHandle ) {
         unzClose( m_ZipFileHandle );
         m_ZipFileHandle = nullptr;
@@ -60,45 +70,68 @@ ZipFileSystem::~ZipFileSystem() {
 
 //-------------------------------------------------------------------------------------------------
 Stream *ZipFileSystem::open( const Uri &file, Stream::AccessMode mode ) {
-    if ( !isOpened() || mode != Stream::AccessMode::ReadAccess ) {
+    if ( !isOpened() || ( mode != Stream::AccessMode::ReadAccess && mode != Stream::AccessMode::ReadAccessBinary ) ) {
         return nullptr;
     }
     
-    // ensure mapped archive
-    if ( m_Dirty ) {
-        mapArchive();
+    const String &name( file.getAbsPath() );
+    std::unordered_map<String, Entry>::const_iterator it( m_index.find( name ) );
+    if ( m_index.end() == it ) {
+        return nullptr;
     }
 
-    // look if file is already open
-    StreamMap::const_iterator it( m_FileMap.find( file.getResource() ) );
-    if( m_FileMap.end() != it ) {
-        return it->second;
+    // Look for the decompressed entry in the cache first
+    std::vector<uc8> *data( nullptr );
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        data = m_cache.find( name );
+        if ( nullptr != data ) {
+            m_cache.addRef( name );
+        }
     }
 
-    Stream *pZipStream( nullptr );
-    const String tmpName = file.getResource();
-    Uri uri( tmpName );
-    if ( fileExist( Uri( uri ) ) ) {
-        pZipStream = new ZipFileStream( uri, m_ZipFileHandle );
-        m_FileMap[ tmpName ] = pZipStream;
+    if ( nullptr == data ) {
+        // Decompress without holding the lock, so other threads can read at the same time
+        std::unique_ptr<std::vector<uc8>> buffer( new std::vector<uc8> );
+        if ( !readEntry( it->second, *buffer ) ) {
+            osre_debug( Tag, "Cannot read " + name + " from " + m_ArchiveName );
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock( m_mutex );
+        data = m_cache.find( name );
+        if ( nullptr == data ) {
+            data = buffer.get();
+            const ui64 size( data->size() );
+            m_cache.insert( name, std::move( buffer ), size );
+        }
+        m_cache.addRef( name );
     }
 
-    return pZipStream;
+    ZipFileStream *stream( new ZipFileStream( file, name, *data ) );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_streams.insert( stream );
+
+    return stream;
 }
 
 //-------------------------------------------------------------------------------------------------
 void ZipFileSystem::close( Stream **ppZipFileStream ) {
-    assert( NULL != *ppZipFileStream );
-    
-    const String &name = ( *ppZipFileStream )->getUri().getResource();
-    StreamMap::iterator it = m_FileMap.find( name );
-    if ( m_FileMap.end() == it ) {
+    if ( nullptr == ppZipFileStream || nullptr == *ppZipFileStream ) {
         return;
     }
 
-    Stream *zipFilestream = (*it).second;
+    std::lock_guard<std::mutex> lock( m_mutex );
+    std::set<Stream*>::iterator it( m_streams.find( *ppZipFileStream ) );
+    if ( m_streams.end() == it ) {
+        return;
+    }
+
+    // The entry stays cached until it gets evicted
+    ZipFileStream *zipFilestream( static_cast<ZipFileStream*>( *it ) );
+    m_cache.release( zipFilestream->getEntryName() );
+    m_streams.erase( it );
     delete zipFilestream;
-    m_FileMap.erase( it );
     (*ppZipFileStream) = nullptr;
 }
 
@@ -109,12 +142,7 @@ bool ZipFileSystem::fileExist( const Uri &file ) {
         return false;
     }
     
-    std::vector<String>::iterator it = std::find( m_FileList.begin(), m_FileList.end(), file.getResource() );
-    if ( m_FileList.end() == it ) {
-        return false;
-    }
-    
-    return true;
+    return m_index.end() != m_index.find( file.getAbsPath() );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -142,6 +170,11 @@ String ZipFileSystem::getWorkingDirectory() {
 
 }
 
+//-------------------------------------------------------------------------------------------------
+bool ZipFileSystem::isThreadSafe() const {
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 void ZipFileSystem::getFileList( std::vector<String> &rFileList ) {
     if ( NULL == m_ZipFileHandle ) {
@@ -151,6 +184,24 @@ void ZipFileSystem::getFileList( std::vector<String> &rFileList ) {
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+void ZipFileSystem::setCacheBudget( ui64 budget ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_cache.setBudget( budget );
+}
+
+//-------------------------------------------------------------------------------------------------
+ui64 ZipFileSystem::getCacheBudget() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_cache.getBudget();
+}
+
+//-------------------------------------------------------------------------------------------------
+ui64 ZipFileSystem::getCacheMemoryUsage() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_cache.getMemoryUsage();
+}
+
 //-------------------------------------------------------------------------------------------------
 bool ZipFileSystem::openArchive() {
     assert( NULL == m_ZipFileHandle );
@@ -174,31 +225,87 @@ bool ZipFileSystem::isOpened() const {
 void ZipFileSystem::mapArchive() {
     assert( NULL != m_ZipFileHandle );
 
-    if ( !m_FileList.empty() )
-        m_FileList.resize( 0 );
+    m_index.clear();
+    m_FileList.resize( 0 );
 
-    //	at first ensure file is already open
-    if ( UNZ_OK == unzGoToFirstFile( m_ZipFileHandle ) )  {
+    // Remember the position of every entry, so it can be opened without a search
+    for ( i32 res = unzGoToFirstFile( m_ZipFileHandle ); UNZ_OK == res; res = unzGoToNextFile( m_ZipFileHandle ) ) {
         c8 filename[ FileNameSize ];
-        unzGetCurrentFileInfo( m_ZipFileHandle, NULL, filename, FileNameSize, NULL, 0, NULL, 0 );
-        m_FileList.push_back( filename );
-        unzCloseCurrentFile( m_ZipFileHandle );
-            
-        // loop over all files
-        while ( unzGoToNextFile( m_ZipFileHandle ) != UNZ_END_OF_LIST_OF_FILE )  {
-            unzGetCurrentFileInfo( m_ZipFileHandle, NULL, filename, FileNameSize, NULL, 0, NULL, 0);
-            m_FileList.push_back( filename );
-            unzCloseCurrentFile( m_ZipFileHandle );
+        unz_file_info fileInfo;
+        Entry entry;
+        if ( UNZ_OK != unzGetCurrentFileInfo( m_ZipFileHandle, &fileInfo, filename, FileNameSize, NULL, 0, NULL, 0 ) 
+                || UNZ_OK != unzGetFilePos( m_ZipFileHandle, &entry.m_pos ) ) {
+            continue;
         }
+        entry.m_size = fileInfo.uncompressed_size;
+        m_index[ filename ] = entry;
+        m_FileList.push_back( filename );
     }
     
     std::sort( m_FileList.begin(), m_FileList.end() );
-    m_Dirty = false;
 }
 
 //-------------------------------------------------------------------------------------------------
 void ZipFileSystem::closeAllFiles() {
-    /// TODO: implement me
+    std::lock_guard<std::mutex> lock( m_mutex );
+    for ( Stream *stream : m_streams ) {
+        delete stream;
+    }
+    m_streams.clear();
+    m_cache.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+unzFile ZipFileSystem::acquireHandle() {
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if ( !m_freeHandles.empty() ) {
+            unzFile handle( m_freeHandles.back() );
+            m_freeHandles.pop_back();
+            return handle;
+        }
+    }
+
+    return unzOpen( m_ArchiveName.c_str() );
+}
+
+//-------------------------------------------------------------------------------------------------
+void ZipFileSystem::releaseHandle( unzFile handle ) {
+    if ( NULL == handle ) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_freeHandles.push_back( handle );
+}
+
+//-------------------------------------------------------------------------------------------------
+bool ZipFileSystem::readEntry( const Entry &entry, std::vector<uc8> &data ) {
+    unzFile handle( acquireHandle() );
+    if ( NULL == handle ) {
+        return false;
+    }
+
+    unz_file_pos pos( entry.m_pos );
+    bool ok( UNZ_OK == unzGoToFilePos( handle, &pos ) && UNZ_OK == unzOpenCurrentFile( handle ) );
+    if ( ok ) {
+        data.resize( static_cast<size_t>( entry.m_size ) );
+        ui64 bytesRead( 0 );
+        while ( bytesRead < entry.m_size ) {
+            const ui32 size( static_cast<ui32>( std::min<ui64>( entry.m_size - bytesRead, 0x40000000 ) ) );
+            const i32 res( unzReadCurrentFile( handle, &data[ static_cast<size_t>( bytesRead ) ], size ) );
+            if ( res <= 0 ) {
+                break;
+            }
+            bytesRead += static_cast<ui64>( res );
+        }
+
+        // Closing checks the CRC
+        ok = UNZ_OK == unzCloseCurrentFile( handle ) && entry.m_size == bytesRead;
+    }
+    releaseHandle( handle );
+
+    return ok;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -23,8 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <osre/IO/AbstractFileSystem.h>
+#include <osre/Common/TResourceCache.h>
 #include "unzip.h"
-#include <map>
+
+#include <mutex>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace OSRE {
@@ -36,12 +40,17 @@ namespace IO {
 ///
 ///	@brief	Class which implements access for Zip-archives. 
 ///    
-/// Currently only the read access is supported.
+/// Currently only the read access is supported. The central directory is indexed by the entry 
+/// names when the archive is opened. Opened entries are decompressed into a cache with a memory 
+/// budget, entries not used by a stream are evicted least recently used first. Every reading 
+/// thread gets an unzip handle of its own, so entries can be decompressed in parallel.
 //-------------------------------------------------------------------------------------------------
 class ZipFileSystem : public AbstractFileSystem {
 public:
     ///	Upper length for filenames.
     static const ui32 FileNameSize = 256;
+    /// The default budget of the entry cache in bytes.
+    static const ui64 DefaultCacheBudget;
 
 public:
     ///	The class constructor with archive name.
@@ -60,24 +69,44 @@ public:
     virtual const String &getSchema() const;
     ///	Returns the working directory.
     virtual String getWorkingDirectory();
+    ///	Returns true, every read takes its own archive handle.
+    virtual bool isThreadSafe() const;
 
 public:
     ///	Returns the file list in the archive.
     void getFileList( std::vector<String> &fileList );
+    /// Sets the memory budget of the entry cache in bytes, 0 for no limit.
+    void setCacheBudget( ui64 budget );
+    /// Returns the memory budget of the entry cache.
+    ui64 getCacheBudget() const;
+    /// Returns the memory used by cached entries.
+    ui64 getCacheMemoryUsage() const;
 
 private:
+    struct Entry {
+        unz_file_pos m_pos;
+        ui64 m_size;
+    };
+
     bool openArchive();	
     bool isOpened() const;
     void mapArchive();
     void closeAllFiles();
+    unzFile acquireHandle();
+    void releaseHandle( unzFile handle );
+    bool readEntry( const Entry &entry, std::vector<uc8> &data );
 
 private:
-    StreamMap m_FileMap;
+    using EntryCache = Common::TResourceCache<String, std::vector<uc8>>;
+
+    std::unordered_map<String, Entry> m_index;
     std::vector<String> m_FileList;
     String m_ArchiveName;
     unzFile m_ZipFileHandle;
-    ui32 m_numberOfRefs;
-    bool m_Dirty;
+    std::vector<unzFile> m_freeHandles;
+    std::set<Stream*> m_streams;
+    EntryCache m_cache;
+    mutable std::mutex m_mutex;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -56,7 +56,8 @@ static const String           ConfigKeyStringTable[ Settings::MaxKonfigKey ] = {
     "ChildWindow",
     "PollingMode",
     "DefaultFont",
-    "RenderMode"
+    "RenderMode",
+    "AccessTraceFile"
 };
 
 Settings::Settings() 
@@ -229,6 +230,9 @@ void Settings::initDefaults() {
 
     value.setInt( 1 );
     m_propertyMap->setProperty( RenderMode, ConfigKeyStringTable[ RenderMode], value );
+
+    value.setString( "" );
+    m_propertyMap->setProperty( AccessTraceFile, ConfigKeyStringTable[ AccessTraceFile ], value );
 }
 
 } // Namespace Properties
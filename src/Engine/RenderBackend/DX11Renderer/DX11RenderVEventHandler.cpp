@@ -206,6 +206,18 @@ bool DX11RenderEventHandler::onCommitNexFrame(const Common::EventData *eventData
     frame->m_geoUpdates = nullptr;
     frame->m_numGeoUpdates = 0;
 
+    delete[] frame->m_primGroupUpdates;
+    frame->m_primGroupUpdates = nullptr;
+    frame->m_numPrimGroupUpdates = 0;
+
+    delete[] frame->m_geoDetaches;
+    frame->m_geoDetaches = nullptr;
+    frame->m_numGeoDetaches = 0;
+
+    delete[] frame->m_hiddenGeos;
+    frame->m_hiddenGeos = nullptr;
+    frame->m_numHiddenGeos = 0;
+
     return true;
 }
 
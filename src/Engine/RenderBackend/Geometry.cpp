@@ -24,13 +24,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/Logger.h>
 #include <osre/Common/Ids.h>
 
+#include <mutex>
+
 namespace OSRE {
 namespace RenderBackend {
 
 using namespace ::OSRE::Common;
 
-// Id container used for geometries
+// Id container used for geometries, importers create and destroy them from worker threads
 static Ids s_Ids;
+static std::mutex s_IdsMutex;
+static ui64 s_nextSerial = 0;
 
 // The log tag for messages
 static const String Tag = "Geometry";
@@ -45,6 +49,7 @@ Geometry::Geometry()
 , m_numPrimGroups( 0 )
 , m_pPrimGroups( nullptr )
 , m_id( 99999999 )
+, m_serial( 0 )
 , m_vertexData()
 , m_indexData()
 , m_lastIndex( 0 ) {
@@ -64,6 +69,7 @@ Geometry::~Geometry() {
     delete[] m_pPrimGroups;
     m_pPrimGroups = nullptr;
 
+    std::lock_guard<std::mutex> lock( s_IdsMutex );
     s_Ids.releaseId( m_id );
 }
 
@@ -73,8 +79,10 @@ Geometry *Geometry::create( ui32 numGeo ) {
         return nullptr;
     }
     Geometry *geoArray( new Geometry[ numGeo ] );
+    std::lock_guard<std::mutex> lock( s_IdsMutex );
     for ( ui32 i = 0; i < numGeo; i++ ) {
         geoArray[ i ].m_id = s_Ids.getUniqueId();
+        geoArray[ i ].m_serial = ++s_nextSerial;
     }
     return geoArray;
 }
@@ -95,6 +103,14 @@ ui32 Geometry::getVertexSize( VertexType vertextype ) {
             vertexSize = sizeof( RenderVert );
             break;
 
+        case VertexType::CompactRenderVertex:
+            vertexSize = sizeof( CompactRenderVert );
+            break;
+
+        case VertexType::QuantizedRenderVertex:
+            vertexSize = sizeof( QuantizedRenderVert );
+            break;
+
         default:
             break;
     }
@@ -66,7 +66,18 @@ struct OGLVertexAttribute {
     const c8     *m_pAttributeName;
     ui32          m_size;
     GLenum        m_type;
+    GLboolean     m_normalized;
     const GLvoid *m_ptr;
+
+    OGLVertexAttribute()
+    : m_index( 0 )
+    , m_pAttributeName( nullptr )
+    , m_size( 0 )
+    , m_type( GL_FLOAT )
+    , m_normalized( GL_FALSE )
+    , m_ptr( nullptr ) {
+        // empty
+    }
 };
 
 ///	@brief
@@ -116,6 +127,7 @@ struct OGLRenderCmd {
     OGLRenderCmdType m_type;
 	ui32             m_id;
     void            *m_data;
+    bool             m_hidden;  ///< Draw commands of hidden geometries are skipped.
 
 private:
     OGLRenderCmd();
@@ -125,7 +137,8 @@ inline
 OGLRenderCmd::OGLRenderCmd() 
 : m_type( OGLRenderCmdType::None )
 , m_id( 999999 )
-, m_data( nullptr ) {
+, m_data( nullptr )
+, m_hidden( false ) {
     // empty
 }
 
@@ -225,6 +238,25 @@ struct DrawPrimitivesCmdData {
     }
 };
 
+///	@brief  Describes the backend data of one attached geometry. Shared geometries use one set of 
+/// buffers and primitive groups, each attachment adds its own material and draw command.
+struct OGLGeoRenderData {
+    ui32                          m_firstPrimGroup;
+    ui32                          m_numPrimGroups;
+    OGLVertexArray               *m_vertexArray;
+    CPPCore::TArray<OGLRenderCmd*> m_matCmds;
+    CPPCore::TArray<OGLRenderCmd*> m_drawCmds;
+
+    OGLGeoRenderData()
+    : m_firstPrimGroup( 0 )
+    , m_numPrimGroups( 0 )
+    , m_vertexArray( nullptr )
+    , m_matCmds()
+    , m_drawCmds() {
+        // empty
+    }
+};
+
 struct OGLCapabilities {
     GLfloat m_maxAniso;
 
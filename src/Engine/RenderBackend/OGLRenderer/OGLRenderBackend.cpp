@@ -25,6 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "OGLCommon.h"
 #include "OGLEnum.h"
 
+#include <osre/Assets/AssetRegistry.h>
+#include <osre/Assets/CookedModel.h>
+#include <osre/Assets/CookedTexture.h>
+#include <osre/Assets/DerivedDataCache.h>
 #include <osre/Platform/AbstractRenderContext.h>
 #include <osre/Profiling/PerformanceCounterRegistry.h>
 #include <osre/Common/Logger.h>
@@ -193,6 +197,7 @@ OGLBuffer *OGLRenderBackend::createBuffer( BufferType type ) {
     buffer->m_handle  = handle;
     buffer->m_type    = type;
     buffer->m_oglId   = bufferId;
+    buffer->m_geoId   = OGLNotSetId;
     buffer->m_size    = 0;
 
     return buffer;
@@ -262,6 +267,7 @@ void OGLRenderBackend::releaseBuffer( OGLBuffer *buffer ) {
     buffer->m_handle = OGLNotSetId;
     buffer->m_type   = BufferType::EmptyBuffer;
     buffer->m_oglId  = OGLNotSetId;
+    buffer->m_geoId  = OGLNotSetId;
     m_freeBufferSlots.add( slot );
 }
 
@@ -298,9 +304,10 @@ bool OGLRenderBackend::createVertexCompArray( const VertexLayout *layout, OGLSha
         attribute->m_index = ( ( *shader )[ attribute->m_pAttributeName ] );
         attribute->m_size = OGLEnum::getOGLSizeForFormat( comp.m_format );
         attribute->m_type = OGLEnum::getOGLTypeForFormat( comp.m_format );
+        attribute->m_normalized = isVertexFormatNormalized( comp.m_format ) ? GL_TRUE : GL_FALSE;
         attribute->m_ptr = (GLvoid*) index;
         attributes.add( attribute );
-        index += attribute->m_size;
+        index += getVertexFormatSize( comp.m_format );
     }
 
     return true;
@@ -374,6 +381,19 @@ bool OGLRenderBackend::createVertexCompArray( VertexType type, OGLShader *shader
             attributes.add( attribute );
             break;
 
+        case VertexType::CompactRenderVertex:
+        case VertexType::QuantizedRenderVertex: {
+                VertexLayout layout;
+                if ( VertexType::CompactRenderVertex == type ) {
+                    CompactRenderVert::getLayout( layout );
+                } else {
+                    QuantizedRenderVert::getLayout( layout );
+                }
+                createVertexCompArray( &layout, shader, attributes );
+                layout.clear();
+            }
+            break;
+
         default:
             break;
     }
@@ -411,7 +431,7 @@ bool OGLRenderBackend::bindVertexLayout( OGLVertexArray *va, OGLShader *shader,
     glEnableVertexAttribArray( loc );
     glVertexAttribPointer( loc, attrib->m_size,
                            attrib->m_type,
-                           GL_FALSE,
+                           attrib->m_normalized,
                            stride,
                            attrib->m_ptr );
 
@@ -432,7 +452,7 @@ bool OGLRenderBackend::bindVertexLayout( OGLVertexArray *va, OGLShader *shader,
             glEnableVertexAttribArray( loc );
             glVertexAttribPointer( loc, attributes[ i ]->m_size,
                                    attributes[ i ]->m_type,
-                                   GL_FALSE,
+                                   attributes[ i ]->m_normalized,
                                    stride,
                                    attributes[ i ]->m_ptr );
         } else {
@@ -680,8 +700,14 @@ OGLTexture *OGLRenderBackend::createTextureFromFile( const String &name, const I
         return tex;
     }
 
-    // import the texture
+    // prefer the cooked texture with its precomputed mip chain
     const String filename = fileloc.getAbsPath();
+    tex = createTextureFromCooked( name, filename );
+    if ( nullptr != tex ) {
+        return tex;
+    }
+
+    // import the texture
     i32 width( 0 ), height( 0 ), channels( 0 );
     GLubyte *data = SOIL_load_image( filename.c_str(), &width, &height, &channels, SOIL_LOAD_AUTO );
     if( !data ) {
@@ -713,6 +739,81 @@ OGLTexture *OGLRenderBackend::createTextureFromFile( const String &name, const I
     return tex;
 }
 
+// Returns the compressed GL format of a cooked texture, 0 when it must be uploaded uncompressed
+static GLenum getCompressedFormat( Assets::CookedTextureFormat format ) {
+    switch ( format ) {
+        case Assets::CookedTextureFormat::BC1:
+            return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+        case Assets::CookedTextureFormat::BC3:
+            return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+        case Assets::CookedTextureFormat::BC5:
+            return GLEW_VERSION_3_0 ? GL_COMPRESSED_RG_RGTC2 : 0;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+OGLTexture *OGLRenderBackend::createTextureFromCooked( const String &name, const String &filename ) {
+    // The derived data cache is content addressed, its files never need a time stamp check
+    Assets::CookedTexture cooked;
+    Assets::DerivedDataCache *cache( Assets::AssetRegistry::getDerivedDataCache() );
+    if ( nullptr != cache ) {
+        const String derivedName( cache->getDerivedFilename( filename, 
+                Assets::CookedTexture::getSettings( Assets::CookedTexture::Options() ), Assets::CookedTexture::Version,
+                Assets::CookedTexture::getCookedName( "" ) ) );
+        if ( !derivedName.empty() ) {
+            cooked.open( derivedName );
+        }
+    }
+
+    if ( !cooked.isOpen() ) {
+        if ( !cooked.open( Assets::CookedTexture::getCookedName( filename ) ) ) {
+            return nullptr;
+        }
+
+        // A missing source is fine, only the cooked texture may be shipped
+        ui64 sourceSize( 0 ), sourceTime( 0 );
+        if ( Assets::CookedModel::getSourceInfo( filename, sourceSize, sourceTime ) && !cooked.isUpToDate( sourceSize, sourceTime ) ) {
+            osre_debug( Tag, "Cooked texture is outdated, loading " + filename );
+            return nullptr;
+        }
+    }
+
+    const Assets::CookedTextureHeader &header( cooked.getHeader() );
+    OGLTexture *tex( createEmptyTexture( name, TextureTargetType::Texture2D, header.m_width, header.m_height, 4 ) );
+    if ( nullptr == tex ) {
+        return nullptr;
+    }
+    tex->m_format = GL_RGBA;
+
+    const ui32 numLevels( cooked.getNumLevels() );
+    glTexParameteri( tex->m_target, GL_TEXTURE_MAX_LEVEL, numLevels - 1 );
+    glTexParameteri( tex->m_target, OGLEnum::getGLTextureParameterName( TextureParameterName::TextureParamMinFilter ),
+            numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR );
+
+    // Without driver support the blocks are decoded on the CPU
+    const GLenum compressedFormat( getCompressedFormat( cooked.getFormat() ) );
+    Assets::CookedTexture::Image image;
+    for ( ui32 i = 0; i < numLevels; ++i ) {
+        const Assets::CookedTextureLevel &level( cooked.getLevel( i ) );
+        const uc8 *data( cooked.getLevelData( i ) );
+        if ( 0 != compressedFormat ) {
+            glCompressedTexImage2D( tex->m_target, i, compressedFormat, level.m_width, level.m_height, 0, level.m_size, data );
+        } else {
+            if ( Assets::CookedTextureFormat::RGBA8 != cooked.getFormat() ) {
+                Assets::CookedTexture::decode( data, cooked.getFormat(), level.m_width, level.m_height, image );
+                data = &image.m_data[ 0 ];
+            }
+            glTexImage2D( tex->m_target, i, GL_RGBA, level.m_width, level.m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data );
+        }
+    }
+    glBindTexture( tex->m_target, 0 );
+
+    return tex;
+}
+
 OGLTexture *OGLRenderBackend::createTextureFromStream( const String &name, IO::Stream &stream, 
                                                        ui32 width, ui32 height, ui32 channels ) {
     OGLTexture *tex( findTexture( name ) );
@@ -720,7 +821,11 @@ OGLTexture *OGLRenderBackend::createTextureFromStream( const String &name, IO::S
         return tex;
     }
 
-    const ui32 size = stream.getSize();
+    if ( stream.getSize() > 0xFFFFFFFFull ) {
+        osre_debug( Tag, "Texture " + name + " is too big." );
+        return nullptr;
+    }
+    const ui32 size = static_cast<ui32>( stream.getSize() );
     uc8 *data = new uc8[ size ];
     stream.read( data, size );
 
@@ -947,6 +1052,19 @@ void OGLRenderBackend::setParameter( OGLParameter **param, ui32 numParam ) {
     }
 }
 
+static size_t getGLIndexSize( GLenum indexType ) {
+    switch ( indexType ) {
+        case GL_UNSIGNED_BYTE:
+            return sizeof( GLubyte );
+        case GL_UNSIGNED_SHORT:
+            return sizeof( GLushort );
+        default:
+            break;
+    }
+
+    return sizeof( GLuint );
+}
+
 ui32 OGLRenderBackend::addPrimitiveGroup( PrimitiveGroup *grp ) {
     if ( nullptr == grp ) {
         osre_error( Tag, "Group pointer is nullptr" );
@@ -965,6 +1083,35 @@ ui32 OGLRenderBackend::addPrimitiveGroup( PrimitiveGroup *grp ) {
     return idx;
 }
 
+bool OGLRenderBackend::updatePrimitiveGroup( ui32 primpGrpIdx, PrimitiveGroup *grp ) {
+    if ( nullptr == grp || primpGrpIdx >= m_primitives.size() ) {
+        osre_error( Tag, "Invalid primitive group to update." );
+        return false;
+    }
+
+    OGLPrimGroup *oglGrp( m_primitives[ primpGrpIdx ] );
+    if ( nullptr == oglGrp ) {
+        return false;
+    }
+
+    oglGrp->m_primitive  = OGLEnum::getGLPrimitiveType( grp->m_primitive );
+    oglGrp->m_indexType  = OGLEnum::getGLIndexType( grp->m_indexType );
+    oglGrp->m_startIndex = grp->m_startIndex;
+    oglGrp->m_numIndices = grp->m_numIndices;
+
+    return true;
+}
+
+void OGLRenderBackend::releasePrimitiveGroup( ui32 primpGrpIdx ) {
+    if ( primpGrpIdx >= m_primitives.size() ) {
+        return;
+    }
+
+    // The slot stays, the indices of all other groups are in use by draw commands
+    delete m_primitives[ primpGrpIdx ];
+    m_primitives[ primpGrpIdx ] = nullptr;
+}
+
 void OGLRenderBackend::releaseAllPrimitiveGroups() {
     ContainerClear( m_primitives );
 }
@@ -972,10 +1119,12 @@ void OGLRenderBackend::releaseAllPrimitiveGroups() {
 void OGLRenderBackend::render( ui32 primpGrpIdx ) {
     OGLPrimGroup *grp( m_primitives[ primpGrpIdx ] );
     if( nullptr != grp ) {
+        // The start index is stored in indices, the draw call expects a byte offset
+        const size_t offset( grp->m_startIndex * getGLIndexSize( grp->m_indexType ) );
         glDrawElements( grp->m_primitive, 
                         grp->m_numIndices, 
                         grp->m_indexType, 
-                        ( const GLvoid* ) grp->m_startIndex );
+                        ( const GLvoid* ) offset );
     }
 }
 
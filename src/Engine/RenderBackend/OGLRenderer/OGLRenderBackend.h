@@ -119,6 +119,7 @@ public:
     OGLTexture *createEmptyTexture( const String &name, TextureTargetType target, ui32 width, ui32 height, ui32 channels );
     void updateTexture( OGLTexture *pOGLTextue, ui32 offsetX, ui32 offsetY, c8 *data, ui32 size );
     OGLTexture *createTextureFromFile( const String &name, const IO::Uri &fileloc );
+    OGLTexture *createTextureFromCooked( const String &name, const String &filename );
     OGLTexture *createTextureFromStream( const String &name, IO::Stream &stream, ui32 width, ui32 height, ui32 channels );
     OGLTexture *findTexture( const String &name ) const;
     bool bindTexture( OGLTexture *pOGLTextue, TextureStageType stageType );
@@ -130,6 +131,8 @@ public:
     void setParameter( OGLParameter **param, ui32 numParam );
     void releaseAllParameters();
     ui32 addPrimitiveGroup( PrimitiveGroup *grp );
+    bool updatePrimitiveGroup( ui32 primpGrpIdx, PrimitiveGroup *grp );
+    void releasePrimitiveGroup( ui32 primpGrpIdx );
     void releaseAllPrimitiveGroups();
     void render( ui32 grimpGrpIdx );
     void render( ui32 primpGrpIdx, ui32 numInstances );
@@ -71,8 +71,7 @@ static bool setupTextures( Material *mat, OGLRenderBackend *rb, TArray<OGLTextur
     for( ui32 i = 0; i < numTextures; ++i ) {
         Texture *tex( mat->m_textures[ i ] );
         if( !tex->m_textureName.empty() ) {
-            String root = Assets::AssetRegistry::getPath( "media" );
-            String path = Assets::AssetRegistry::resolvePathFromUri( tex->m_loc );
+            const String &path = Assets::AssetRegistry::resolvePathFromUri( tex->m_loc );
             
             IO::Uri loc( tex->m_loc );
             loc.setPath( path );
@@ -105,7 +104,8 @@ static void setConstantBuffers(const glm::mat4 &model, const glm::mat4 &view, co
     eh->getRenderCmdBuffer()->setMatrixes(model, view, proj);
 }
 
-static SetMaterialStageCmdData *setupMaterial( Material *material, OGLRenderBackend *rb, OGLRenderEventHandler *eh ) {
+static SetMaterialStageCmdData *setupMaterial( Material *material, OGLRenderBackend *rb, OGLRenderEventHandler *eh, 
+        OGLRenderCmd **matCmd = nullptr ) {
 	OSRE_ASSERT( nullptr != eh );
 	OSRE_ASSERT( nullptr != material );
 	OSRE_ASSERT( nullptr != rb );
@@ -139,6 +139,9 @@ static SetMaterialStageCmdData *setupMaterial( Material *material, OGLRenderBack
                 }
                 renderMatCmd->m_data = matData;
                 eh->enqueueRenderCmd( renderMatCmd );
+                if ( nullptr != matCmd ) {
+                    *matCmd = renderMatCmd;
+                }
             }
             break;
 
@@ -281,13 +284,13 @@ static OGLVertexArray *setupBuffers( Geometry *geo, OGLRenderBackend *rb, OGLSha
     return vertexArray;
 }
 
-static void setupPrimDrawCmd( bool useLocalMatrix, const glm::mat4 &model, const TArray<ui32> &primGroups, OGLRenderBackend *rb, 
+static OGLRenderCmd *setupPrimDrawCmd( bool useLocalMatrix, const glm::mat4 &model, const TArray<ui32> &primGroups, OGLRenderBackend *rb, 
         OGLRenderEventHandler *eh, OGLVertexArray *va ) {
 	OSRE_ASSERT( nullptr != rb );
 	OSRE_ASSERT( nullptr != eh );
 
     if( primGroups.isEmpty() ) {
-        return;
+        return nullptr;
     }
 
 	OGLRenderCmd *renderCmd = OGLRenderCmdAllocator::alloc( OGLRenderCmdType::DrawPrimitivesCmd, nullptr );
@@ -304,16 +307,18 @@ static void setupPrimDrawCmd( bool useLocalMatrix, const glm::mat4 &model, const
     renderCmd->m_data = static_cast<void*>( data );
     
     eh->enqueueRenderCmd( renderCmd );
+
+    return renderCmd;
 }
 
-static void setupInstancedDrawCmd( const TArray<ui32> &ids, Frame *currentFrame, 
+static OGLRenderCmd *setupInstancedDrawCmd( const TArray<ui32> &ids, Frame *currentFrame, 
         OGLRenderBackend *rb, OGLRenderEventHandler *eh, OGLVertexArray *va ) {
 	OSRE_ASSERT( nullptr != currentFrame );
 	OSRE_ASSERT( nullptr != rb );
 	OSRE_ASSERT( nullptr != eh );
 
     if( ids.isEmpty() ) {
-        return;
+        return nullptr;
     }
 
     GeoInstanceData *instData( currentFrame->m_geoInstanceData );
@@ -341,6 +346,8 @@ static void setupInstancedDrawCmd( const TArray<ui32> &ids, Frame *currentFrame,
         renderCmd->m_data = static_cast< void* >( data );
         eh->enqueueRenderCmd( renderCmd );
     }
+
+    return renderCmd;
 }
 
 OGLRenderEventHandler::OGLRenderEventHandler( )
@@ -350,13 +357,17 @@ OGLRenderEventHandler::OGLRenderEventHandler( )
 , m_renderCmdBuffer( nullptr )
 , m_renderCtx( nullptr )
 , m_vertexArray( nullptr )
-, m_hwBufferManager( nullptr ) {
+, m_hwBufferManager( nullptr )
+, m_geoRenderData()
+, m_hiddenGeos() {
     // empty
 }
         
 OGLRenderEventHandler::~OGLRenderEventHandler( ) {
     delete m_hwBufferManager;
     m_hwBufferManager = nullptr;
+
+    releaseGeoRenderData();
 }
 
 bool OGLRenderEventHandler::onEvent( const Event &ev, const EventData *data ) {
@@ -466,8 +477,7 @@ bool OGLRenderEventHandler::onCreateRenderer( const EventData *eventData ) {
 
     const String defaultFont( PlatformInterface::getInstance()->getDefaultFontName() );
     IO::Uri fontUri( "file://assets/Textures/Fonts/" + defaultFont );
-    String root = Assets::AssetRegistry::getPath( "media" );
-    String path = Assets::AssetRegistry::resolvePathFromUri( fontUri );
+    const String &path = Assets::AssetRegistry::resolvePathFromUri( fontUri );
     fontUri.setPath( path );
     m_oglBackend->createFont( fontUri );
     m_renderCmdBuffer = new RenderCmdBuffer( m_oglBackend, m_renderCtx, createRendererEvData->m_pipeline );
@@ -525,6 +535,7 @@ bool OGLRenderEventHandler::onClearGeo( const EventData * ) {
     m_oglBackend->releaseAllTextures();
     m_oglBackend->releaseAllParameters();
     m_renderCmdBuffer->clear();
+    releaseGeoRenderData();
 
     return true;
 }
@@ -556,6 +567,17 @@ bool OGLRenderEventHandler::onCommitNexFrame( const Common::EventData *eventData
     Frame *frame = frameToCommitData->m_frame;
     setConstantBuffers( frame->m_model, frame->m_view, frame->m_proj, m_oglBackend, this );
 
+    // The visibility of the last frame is reset before its geometries may be detached
+    hideGeos( 0, nullptr );
+
+    // Detach first, the id of a released geometry may be in use by a new one already
+    for ( ui32 i = 0; i < frame->m_numGeoDetaches; ++i ) {
+        detachGeo( frame->m_geoDetaches[ i ] );
+    }
+    delete[] frame->m_geoDetaches;
+    frame->m_geoDetaches = nullptr;
+    frame->m_numGeoDetaches = 0;
+
     for ( ui32 geoPackageIdx = 0; geoPackageIdx<frame->m_numGeoPackages; geoPackageIdx++ ) {
         GeometryPackage *currentGeoPackage( frame->m_geoPackages[ geoPackageIdx ] );
         if ( nullptr == currentGeoPackage ) {
@@ -600,21 +622,48 @@ bool OGLRenderEventHandler::onCommitNexFrame( const Common::EventData *eventData
                 return false;
             }
 
-            // register primitive groups to render
-            for (ui32 i = 0; i < geo->m_numPrimGroups; ++i) {
-                const ui32 primIdx( m_oglBackend->addPrimitiveGroup( &geo->m_pPrimGroups[ i ]) );
-                primGroups.add( primIdx );
+            // register primitive groups to render, shared geometries reuse their groups
+            OGLGeoRenderData *renderData( nullptr );
+            std::map<ui32, OGLGeoRenderData*>::const_iterator it( m_geoRenderData.find( geo->m_id ) );
+            const bool isNewGeo( m_geoRenderData.end() == it );
+            if ( isNewGeo ) {
+                renderData = new OGLGeoRenderData;
+                renderData->m_numPrimGroups = geo->m_numPrimGroups;
+                for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+                    const ui32 primIdx( m_oglBackend->addPrimitiveGroup( &geo->m_pPrimGroups[ i ] ) );
+                    if ( 0 == i ) {
+                        renderData->m_firstPrimGroup = primIdx;
+                    }
+                }
+            } else {
+                renderData = it->second;
+            }
+            primGroups.resize( 0 );
+            for ( ui32 i = 0; i < renderData->m_numPrimGroups; ++i ) {
+                primGroups.add( renderData->m_firstPrimGroup + i );
             }
 
             // create the default material
-            SetMaterialStageCmdData *data = setupMaterial(geo->m_material, m_oglBackend, this);
-
-            // setup vertex array, vertex and index buffers
-            m_vertexArray = setupBuffers(geo, m_oglBackend, m_renderCmdBuffer->getActiveShader());
-            if (nullptr == m_vertexArray) {
-                osre_debug(Tag, "Vertex-Array-pointer is a nullptr.");
-                return false;
+            OGLRenderCmd *matCmd( nullptr );
+            SetMaterialStageCmdData *data = setupMaterial(geo->m_material, m_oglBackend, this, &matCmd);
+
+            // setup vertex array, vertex and index buffers, shared geometries reuse their buffers
+            if ( isNewGeo ) {
+                renderData->m_vertexArray = setupBuffers(geo, m_oglBackend, m_renderCmdBuffer->getActiveShader());
+                if ( nullptr == renderData->m_vertexArray ) {
+                    osre_debug(Tag, "Vertex-Array-pointer is a nullptr.");
+                    for ( ui32 i = 0; i < renderData->m_numPrimGroups; ++i ) {
+                        m_oglBackend->releasePrimitiveGroup( renderData->m_firstPrimGroup + i );
+                    }
+                    if ( nullptr != matCmd ) {
+                        m_renderCmdBuffer->removeRenderCmd( matCmd );
+                    }
+                    delete renderData;
+                    return false;
+                }
+                m_geoRenderData[ geo->m_id ] = renderData;
             }
+            m_vertexArray = renderData->m_vertexArray;
             data->m_vertexArray = m_vertexArray;
 
             if (frame->m_numLights > 0) {
@@ -622,13 +671,15 @@ bool OGLRenderEventHandler::onCommitNexFrame( const Common::EventData *eventData
             }
 
             // setup the draw calls
+            OGLRenderCmd *drawCmd( nullptr );
             if (0 == currentGeoPackage->m_numInstances) {
-                setupPrimDrawCmd( geo->m_localMatrix, geo->m_model, primGroups, m_oglBackend, this, m_vertexArray);
+                drawCmd = setupPrimDrawCmd( geo->m_localMatrix, geo->m_model, primGroups, m_oglBackend, this, m_vertexArray);
             } else {
-                setupInstancedDrawCmd(primGroups, frame, m_oglBackend, this, m_vertexArray);
+                drawCmd = setupInstancedDrawCmd(primGroups, frame, m_oglBackend, this, m_vertexArray);
             }
+            renderData->m_matCmds.add( matCmd );
+            renderData->m_drawCmds.add( drawCmd );
         }
-        primGroups.resize( 0 );
     }
 
     // setup global parameter
@@ -657,17 +708,123 @@ bool OGLRenderEventHandler::onCommitNexFrame( const Common::EventData *eventData
             m_oglBackend->copyDataToBuffer(buffer, geo->m_vb->m_data, geo->m_vb->m_size, geo->m_vb->m_access);
             m_oglBackend->unbindBuffer(buffer);
         }
+
+        // Primitive groups may have been changed together with the buffers
+        std::map<ui32, OGLGeoRenderData*>::const_iterator it( m_geoRenderData.find( geo->m_id ) );
+        if ( m_geoRenderData.end() != it ) {
+            const OGLGeoRenderData *renderData( it->second );
+            for ( ui32 j = 0; j < geo->m_numPrimGroups && j < renderData->m_numPrimGroups; ++j ) {
+                m_oglBackend->updatePrimitiveGroup( renderData->m_firstPrimGroup + j, &geo->m_pPrimGroups[ j ] );
+            }
+        }
     }
 
     delete[] frame->m_geoUpdates;
     frame->m_geoUpdates = nullptr;
     frame->m_numGeoUpdates = 0;
 
+    // Only the index ranges are changed, for instance by a LOD switch, the buffers are kept
+    for ( ui32 i = 0; i < frame->m_numPrimGroupUpdates; ++i ) {
+        const Geometry *geo( frame->m_primGroupUpdates[ i ] );
+        std::map<ui32, OGLGeoRenderData*>::const_iterator it( m_geoRenderData.find( geo->m_id ) );
+        if ( m_geoRenderData.end() == it ) {
+            continue;
+        }
+        const OGLGeoRenderData *renderData( it->second );
+        for ( ui32 j = 0; j < geo->m_numPrimGroups && j < renderData->m_numPrimGroups; ++j ) {
+            m_oglBackend->updatePrimitiveGroup( renderData->m_firstPrimGroup + j, &geo->m_pPrimGroups[ j ] );
+        }
+    }
+    delete[] frame->m_primGroupUpdates;
+    frame->m_primGroupUpdates = nullptr;
+    frame->m_numPrimGroupUpdates = 0;
+
+    // Hidden after the attachments, so new geometries can be hidden in their first frame
+    hideGeos( frame->m_numHiddenGeos, frame->m_hiddenGeos );
+    delete[] frame->m_hiddenGeos;
+    frame->m_hiddenGeos = nullptr;
+    frame->m_numHiddenGeos = 0;
+
     m_oglBackend->useShader( nullptr );
 
     return true;
 }
 
+void OGLRenderEventHandler::detachGeo( ui32 geoId ) {
+    std::map<ui32, OGLGeoRenderData*>::iterator it( m_geoRenderData.find( geoId ) );
+    if ( m_geoRenderData.end() == it ) {
+        osre_debug( Tag, "Geometry to detach is not attached." );
+        return;
+    }
+
+    // Every attachment owns its commands, the buffers go with the last one
+    OGLGeoRenderData *renderData( it->second );
+    if ( !renderData->m_drawCmds.isEmpty() ) {
+        if ( nullptr != renderData->m_drawCmds.back() ) {
+            m_renderCmdBuffer->removeRenderCmd( renderData->m_drawCmds.back() );
+        }
+        if ( nullptr != renderData->m_matCmds.back() ) {
+            m_renderCmdBuffer->removeRenderCmd( renderData->m_matCmds.back() );
+        }
+        renderData->m_drawCmds.removeBack();
+        renderData->m_matCmds.removeBack();
+    }
+    if ( !renderData->m_drawCmds.isEmpty() ) {
+        return;
+    }
+
+    OGLBuffer *buffer( m_oglBackend->getBufferById( geoId ) );
+    while ( nullptr != buffer ) {
+        m_oglBackend->releaseBuffer( buffer );
+        buffer = m_oglBackend->getBufferById( geoId );
+    }
+    m_oglBackend->destroyVertexArray( renderData->m_vertexArray );
+    for ( ui32 i = 0; i < renderData->m_numPrimGroups; ++i ) {
+        m_oglBackend->releasePrimitiveGroup( renderData->m_firstPrimGroup + i );
+    }
+    delete renderData;
+    m_geoRenderData.erase( it );
+}
+
+static void setHidden( OGLGeoRenderData *renderData, bool hidden ) {
+    for ( ui32 i = 0; i < renderData->m_drawCmds.size(); ++i ) {
+        if ( nullptr != renderData->m_drawCmds[ i ] ) {
+            renderData->m_drawCmds[ i ]->m_hidden = hidden;
+        }
+    }
+}
+
+void OGLRenderEventHandler::hideGeos( ui32 numHiddenGeos, const ui32 *hiddenGeos ) {
+    for ( ui32 i = 0; i < m_hiddenGeos.size(); ++i ) {
+        std::map<ui32, OGLGeoRenderData*>::iterator it( m_geoRenderData.find( m_hiddenGeos[ i ] ) );
+        if ( m_geoRenderData.end() != it ) {
+            setHidden( it->second, false );
+        }
+    }
+    m_hiddenGeos.resize( 0 );
+
+    // A shared geometry is only hidden, when all of its attachments were reported
+    std::map<ui32, ui32> numReports;
+    for ( ui32 i = 0; i < numHiddenGeos; ++i ) {
+        ++numReports[ hiddenGeos[ i ] ];
+    }
+    for ( std::map<ui32, ui32>::const_iterator report( numReports.begin() ); numReports.end() != report; ++report ) {
+        std::map<ui32, OGLGeoRenderData*>::iterator it( m_geoRenderData.find( report->first ) );
+        if ( m_geoRenderData.end() != it && report->second >= it->second->m_drawCmds.size() ) {
+            setHidden( it->second, true );
+            m_hiddenGeos.add( report->first );
+        }
+    }
+}
+
+void OGLRenderEventHandler::releaseGeoRenderData() {
+    m_hiddenGeos.resize( 0 );
+    for ( std::map<ui32, OGLGeoRenderData*>::iterator it( m_geoRenderData.begin() ); m_geoRenderData.end() != it; ++it ) {
+        delete it->second;
+    }
+    m_geoRenderData.clear();
+}
+
 bool OGLRenderEventHandler::onShutdownRequest( const Common::EventData *eventData ) {
     OSRE_ASSERT( nullptr != eventData );
 
@@ -25,10 +25,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Common/AbstractEventHandler.h>
 #include <osre/Common/Event.h>
 #include <osre/RenderBackend/RenderBackendService.h>
+#include <cppcore/Container/THashMap.h>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 
+#include <map>
+
 namespace OSRE {
 
 // Forward declarations
@@ -58,6 +61,7 @@ struct SetTextureStageCmdData;
 struct SetShaderStageCmdData;
 struct SetRenderTargetCmdData;
 struct OGLParameter;
+struct OGLGeoRenderData;
 
 //-------------------------------------------------------------------------------------------------
 ///	@ingroup	Engine
@@ -105,6 +109,11 @@ protected:
     /// @brief  Callback for dealing with resize events.
     virtual bool onResizeRenderTarget( const Common::EventData *eventData );
 
+private:
+    void detachGeo( ui32 geoId );
+    void hideGeos( ui32 numHiddenGeos, const ui32 *hiddenGeos );
+    void releaseGeoRenderData();
+
 private:
     bool m_isRunning;
     OGLRenderBackend *m_oglBackend;
@@ -112,6 +121,8 @@ private:
     Platform::AbstractRenderContext *m_renderCtx;
     OGLVertexArray *m_vertexArray;
     HWBufferManager *m_hwBufferManager;
+    std::map<ui32, OGLGeoRenderData*> m_geoRenderData;
+    CPPCore::TArray<ui32> m_hiddenGeos;
 };
 
 } // Namespace RenderBackend
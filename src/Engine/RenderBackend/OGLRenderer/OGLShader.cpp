@@ -83,7 +83,10 @@ bool OGLShader::loadFromStream( ShaderType type, IO::Stream &stream ) {
         return false;
     }
 
-    const ui32 filesize( stream.getSize() );
+    if ( stream.getSize() > 0xFFFFFFFFull ) {
+        return false;
+    }
+    const ui32 filesize( static_cast<ui32>( stream.getSize() ) );
     if ( 0 == filesize ) {
         return true;
     }
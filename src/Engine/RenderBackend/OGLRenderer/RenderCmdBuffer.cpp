@@ -96,6 +96,39 @@ void RenderCmdBuffer::enqueueRenderCmdGroup( const String &groupName, CPPCore::T
     }
 }
 
+void RenderCmdBuffer::removeRenderCmd( OGLRenderCmd *renderCmd ) {
+    if ( nullptr == renderCmd ) {
+        osre_debug( Tag, "Nullptr to render-command detected." );
+        return;
+    }
+
+    for ( ui32 i = 0; i < m_cmdbuffer.size(); ) {
+        if ( renderCmd == m_cmdbuffer[ i ] ) {
+            m_cmdbuffer.remove( i );
+        } else {
+            ++i;
+        }
+    }
+
+    switch ( renderCmd->m_type ) {
+        case OGLRenderCmdType::DrawPrimitivesCmd:
+            delete static_cast<DrawPrimitivesCmdData*>( renderCmd->m_data );
+            break;
+        case OGLRenderCmdType::DrawPrimitivesInstancesCmd:
+            delete static_cast<DrawInstancePrimitivesCmdData*>( renderCmd->m_data );
+            break;
+        case OGLRenderCmdType::SetMaterialCmd:
+            delete static_cast<SetMaterialStageCmdData*>( renderCmd->m_data );
+            break;
+        case OGLRenderCmdType::SetRenderTargetCmd:
+            delete static_cast<SetRenderTargetCmdData*>( renderCmd->m_data );
+            break;
+        default:
+            break;
+    }
+    OGLRenderCmdAllocator::free( renderCmd );
+}
+
 void RenderCmdBuffer::onPreRenderFrame() {
     OSRE_ASSERT( nullptr!=m_renderbackend );
 
@@ -130,6 +163,9 @@ void RenderCmdBuffer::onRenderFrame( const EventData *eventData ) {
             // only valid pointers are allowed
             OGLRenderCmd *renderCmd = m_cmdbuffer[ i ];
             OSRE_ASSERT( nullptr != renderCmd );
+            if ( renderCmd->m_hidden ) {
+                continue;
+            }
             if ( renderCmd->m_type == OGLRenderCmdType::DrawPrimitivesCmd ) {
                 onDrawPrimitivesCmd( ( DrawPrimitivesCmdData* ) renderCmd->m_data );
             } else if ( renderCmd->m_type == OGLRenderCmdType::DrawPrimitivesInstancesCmd ) {
@@ -82,6 +82,8 @@ public:
     void enqueueRenderCmd( const String &groupName, OGLRenderCmd *renderCmd, EnqueueType type = EnqueueType::PushBack );
     /// Will enqueue a new render command group.
     void enqueueRenderCmdGroup( const String &groupName, CPPCore::TArray<OGLRenderCmd*>& cmdGroup, EnqueueType type = EnqueueType::PushBack );
+    /// Will remove a render command from the buffer and release it.
+    void removeRenderCmd( OGLRenderCmd *renderCmd );
     /// The callback before rendering.
     void onPreRenderFrame();
     /// The render callback.
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include <osre/RenderBackend/RenderBackendService.h>
 #include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
 #include <osre/Properties/Settings.h>
 #include <osre/Profiling/PerformanceCounterRegistry.h>
 #include <osre/Threading/SystemTask.h>
@@ -54,6 +55,9 @@ RenderBackendService::RenderBackendService()
 , m_screen( nullptr )
 , m_newGeo()
 , m_geoUpdates()
+, m_primGroupUpdates()
+, m_geoDetaches()
+, m_hiddenGeos()
 , m_newInstances()
 , m_variables()
 , m_uniformUpdates()
@@ -212,6 +216,35 @@ void RenderBackendService::commitNextFrame() {
         }
         m_geoUpdates.resize(0);
     }
+
+    if ( !m_primGroupUpdates.isEmpty() ) {
+        m_nextFrame.m_numPrimGroupUpdates = m_primGroupUpdates.size();
+        m_nextFrame.m_primGroupUpdates = new Geometry*[ m_nextFrame.m_numPrimGroupUpdates ];
+        for ( ui32 i = 0; i < m_nextFrame.m_numPrimGroupUpdates; i++ ) {
+            m_nextFrame.m_primGroupUpdates[ i ] = m_primGroupUpdates[ i ];
+        }
+        m_primGroupUpdates.resize( 0 );
+    }
+
+    // The ids are passed, the geometries may be gone when the frame is committed
+    if ( !m_geoDetaches.isEmpty() ) {
+        m_nextFrame.m_numGeoDetaches = m_geoDetaches.size();
+        m_nextFrame.m_geoDetaches = new ui32[ m_nextFrame.m_numGeoDetaches ];
+        for ( ui32 i = 0; i < m_nextFrame.m_numGeoDetaches; i++ ) {
+            m_nextFrame.m_geoDetaches[ i ] = m_geoDetaches[ i ];
+        }
+        m_geoDetaches.resize( 0 );
+    }
+
+    // The visibility is reported per frame
+    if ( !m_hiddenGeos.isEmpty() ) {
+        m_nextFrame.m_numHiddenGeos = m_hiddenGeos.size();
+        m_nextFrame.m_hiddenGeos = new ui32[ m_nextFrame.m_numHiddenGeos ];
+        for ( ui32 i = 0; i < m_nextFrame.m_numHiddenGeos; i++ ) {
+            m_nextFrame.m_hiddenGeos[ i ] = m_hiddenGeos[ i ];
+        }
+        m_hiddenGeos.resize( 0 );
+    }
     CommitFrameEventData *data = new CommitFrameEventData;
     data->m_frame = &m_nextFrame;
     m_renderTaskPtr->sendEvent( &OnCommitFrameEvent, data );
@@ -316,6 +349,75 @@ void RenderBackendService::attachGeoUpdate( const CPPCore::TArray<Geometry*> &ge
     m_geoUpdates.add( &geoArray[ 0 ], geoArray.size() );
 }
 
+void RenderBackendService::attachPrimGroupUpdate( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        osre_debug( Tag, "Pointer to geometry is nullptr." );
+        return;
+    }
+
+    for ( ui32 i = 0; i < m_primGroupUpdates.size(); i++ ) {
+        if ( geo == m_primGroupUpdates[ i ] ) {
+            return;
+        }
+    }
+    m_primGroupUpdates.add( geo );
+}
+
+void RenderBackendService::detachGeo( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        osre_debug( Tag, "Pointer to geometry is nullptr." );
+        return;
+    }
+
+    // A geometry, which was not committed yet, will not reach the backend at all
+    for ( ui32 i = 0; i < m_newGeo.size(); i++ ) {
+        NewGeoEntry *entry( m_newGeo[ i ] );
+        for ( ui32 j = 0; j < entry->m_geo.size(); j++ ) {
+            if ( geo == entry->m_geo[ j ] ) {
+                entry->m_geo.remove( j );
+                if ( entry->m_geo.isEmpty() ) {
+                    delete entry;
+                    m_newGeo.remove( i );
+                }
+                return;
+            }
+        }
+    }
+
+    for ( ui32 i = 0; i < m_geoUpdates.size(); ) {
+        if ( geo == m_geoUpdates[ i ] ) {
+            m_geoUpdates.remove( i );
+        } else {
+            ++i;
+        }
+    }
+    for ( ui32 i = 0; i < m_primGroupUpdates.size(); ) {
+        if ( geo == m_primGroupUpdates[ i ] ) {
+            m_primGroupUpdates.remove( i );
+        } else {
+            ++i;
+        }
+    }
+    // The id may be reused by a new geometry in the same frame
+    for ( ui32 i = 0; i < m_hiddenGeos.size(); ) {
+        if ( geo->m_id == m_hiddenGeos[ i ] ) {
+            m_hiddenGeos.remove( i );
+        } else {
+            ++i;
+        }
+    }
+    m_geoDetaches.add( geo->m_id );
+}
+
+void RenderBackendService::hideGeo( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        osre_debug( Tag, "Pointer to geometry is nullptr." );
+        return;
+    }
+
+    m_hiddenGeos.add( geo->m_id );
+}
+
 void RenderBackendService::attachGeoInstance( GeoInstanceData *instanceData ) {
     if ( nullptr == instanceData ) {
         osre_debug( Tag, "Pointer to geometry is nullptr." );
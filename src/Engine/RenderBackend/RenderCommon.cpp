@@ -118,6 +118,51 @@ const String *RenderVert::getAttributes() {
     return RenderVertAttributes;
 }
 
+// Compact and quantized vertices share the attribute names of the render vertex
+CompactRenderVert::CompactRenderVert()
+: position() {
+    normal[ 0 ] = normal[ 1 ] = 0;
+    color0[ 0 ] = color0[ 1 ] = color0[ 2 ] = color0[ 3 ] = 255;
+    tex0[ 0 ] = tex0[ 1 ] = 0;
+}
+
+ui32 CompactRenderVert::getNumAttributes() {
+    return NumRenderVertAttributes;
+}
+
+const String *CompactRenderVert::getAttributes() {
+    return RenderVertAttributes;
+}
+
+void CompactRenderVert::getLayout( VertexLayout &layout ) {
+    layout.add( new VertComponent( VertexAttribute::Position, VertexFormat::Float3 ) )
+        .add( new VertComponent( VertexAttribute::Normal, VertexFormat::Short2N ) )
+        .add( new VertComponent( VertexAttribute::Color0, VertexFormat::UByte4N ) )
+        .add( new VertComponent( VertexAttribute::TexCoord0, VertexFormat::Half2 ) );
+}
+
+QuantizedRenderVert::QuantizedRenderVert() {
+    position[ 0 ] = position[ 1 ] = position[ 2 ] = position[ 3 ] = 0;
+    normal[ 0 ] = normal[ 1 ] = 0;
+    color0[ 0 ] = color0[ 1 ] = color0[ 2 ] = color0[ 3 ] = 255;
+    tex0[ 0 ] = tex0[ 1 ] = 0;
+}
+
+ui32 QuantizedRenderVert::getNumAttributes() {
+    return NumRenderVertAttributes;
+}
+
+const String *QuantizedRenderVert::getAttributes() {
+    return RenderVertAttributes;
+}
+
+void QuantizedRenderVert::getLayout( VertexLayout &layout ) {
+    layout.add( new VertComponent( VertexAttribute::Position, VertexFormat::UShort4N ) )
+        .add( new VertComponent( VertexAttribute::Normal, VertexFormat::Short2N ) )
+        .add( new VertComponent( VertexAttribute::Color0, VertexFormat::UByte4N ) )
+        .add( new VertComponent( VertexAttribute::TexCoord0, VertexFormat::Half2 ) );
+}
+
 const String &getVertCompName( VertexAttribute attrib ) {
     if( attrib > VertexAttribute::Instance3 ) {
         return ErrorCmpName;
@@ -223,12 +268,16 @@ BufferData::BufferData()
 , m_data( nullptr )
 , m_size( 0 )
 , m_cap( 0 )
-, m_access( BufferAccessType::ReadOnly ) {
+, m_access( BufferAccessType::ReadOnly )
+, m_owned( true )
+, m_storage() {
     // empty
 }
 
 BufferData::~BufferData() {
-    delete[] m_data;
+    if ( m_owned ) {
+        delete[] m_data;
+    }
     m_data = nullptr;
     m_size = 0;
     m_cap = 0;
@@ -245,6 +294,20 @@ BufferData* BufferData::alloc( BufferType type, ui32 sizeInBytes, BufferAccessTy
     return buffer;
 }
 
+BufferData *BufferData::wrap( BufferType type, void *data, ui32 sizeInBytes, BufferAccessType access,
+        const std::shared_ptr<void> &storage ) {
+    BufferData *buffer( new BufferData );
+    buffer->m_size   = sizeInBytes;
+    buffer->m_cap    = sizeInBytes;
+    buffer->m_access = access;
+    buffer->m_type   = type;
+    buffer->m_data   = data;
+    buffer->m_owned  = false;
+    buffer->m_storage = storage;
+
+    return buffer;
+}
+
 void BufferData::free( BufferData *data ) {
     if ( nullptr == data ) {
 		return;
@@ -279,8 +342,12 @@ void BufferData::attach( void *data, ui32 size ) {
     uc8 *newData = new uc8[ newSize ];
     ::memcpy( newData, m_data, m_size );
     ::memcpy( &newData[ m_size ], data, size );
-    delete[] m_data;
+    if ( m_owned ) {
+        delete[] m_data;
+    }
     m_data = newData;
+    m_owned = true;
+    m_storage.reset();
     m_size += size;
 }
 
@@ -1226,12 +1226,12 @@ const CPPCore::TArray<VkExtensionProperties> &VlkRenderBackend::getExtensions()
 }
 
 VlkShaderModule *VlkRenderBackend::createShaderModule( IO::Stream &stream ) {
-    const ui32 size( stream.getSize() );
-    if ( 0 == size ) {
+    if ( 0 == stream.getSize() || stream.getSize() > 0xFFFFFFFFull ) {
         return nullptr;
     }
 
-    uc8 *buffer = new uc8[ stream.getSize() ];
+    const ui32 size( static_cast<ui32>( stream.getSize() ) );
+    uc8 *buffer = new uc8[ size ];
     stream.read( buffer, size );
     VkShaderModuleCreateInfo shader_module_create_info = {
         VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,     // VkStructureType                sType
@@ -22,8 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include <osre/Scene/Component.h>
 #include <osre/Scene/Node.h>
+#include <osre/Scene/LodSet.h>
 #include <osre/RenderBackend/RenderBackendService.h>
 #include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
 
 namespace OSRE {
 namespace Scene {
@@ -45,12 +47,29 @@ Component::~Component() {
 
 RenderComponent::RenderComponent(Node *node, ui32 id )
 : Component(node, id )
-, m_newGeo() {
+, m_newGeo()
+, m_attachedGeo()
+, m_lodSets()
+, m_numAttachedLodSets( 0 )
+, m_renderBackendSrv( nullptr ) {
     // empty
 }
 
 RenderComponent::~RenderComponent() {
-    // empty
+    // The backend keeps render data per geometry id, ids will be reused by new geometries
+    if ( nullptr != m_renderBackendSrv ) {
+        for ( ui32 i = 0; i < m_attachedGeo.size(); i++ ) {
+            m_renderBackendSrv->detachGeo( m_attachedGeo[ i ] );
+        }
+        for ( ui32 i = 0; i < m_numAttachedLodSets; i++ ) {
+            m_renderBackendSrv->detachGeo( m_lodSets[ i ]->getGeometry() );
+        }
+    }
+
+    for ( ui32 i = 0; i < m_lodSets.size(); i++ ) {
+        delete m_lodSets[ i ];
+    }
+    m_lodSets.clear();
 }
 
 void RenderComponent::update( Time ) {
@@ -58,12 +77,27 @@ void RenderComponent::update( Time ) {
 }
 
 void RenderComponent::draw( RenderBackendService *renderBackendSrv ) {
+    m_renderBackendSrv = renderBackendSrv;
     if( !m_newGeo.isEmpty() ) {
         for ( ui32 i = 0; i < m_newGeo.size(); i++ ) {
             renderBackendSrv->attachGeo( m_newGeo[ i ], 0 );
+            m_attachedGeo.add( m_newGeo[ i ] );
         }
         m_newGeo.resize( 0 );
     }
+
+    // New LOD sets will be attached once, a level switch only updates the primitive group, 
+    // the buffers hold all levels already
+    for ( ui32 i = 0; i < m_lodSets.size(); i++ ) {
+        LodSet *lodSet( m_lodSets[ i ] );
+        if ( i >= m_numAttachedLodSets ) {
+            renderBackendSrv->attachGeo( lodSet->getGeometry(), 0 );
+        } else if ( lodSet->isChanged() ) {
+            renderBackendSrv->attachPrimGroupUpdate( lodSet->getGeometry() );
+        }
+        lodSet->resetChanged();
+    }
+    m_numAttachedLodSets = m_lodSets.size();
 }
 
 void RenderComponent::addStaticGeometry( Geometry *geo ) {
@@ -72,6 +106,79 @@ void RenderComponent::addStaticGeometry( Geometry *geo ) {
     }
 
     m_newGeo.add( geo );
+    Node::notifyChanged();
+}
+
+bool RenderComponent::removeGeometry( Geometry *geo ) {
+    if ( nullptr == geo ) {
+        return false;
+    }
+
+    for ( ui32 i = 0; i < m_newGeo.size(); i++ ) {
+        if ( geo == m_newGeo[ i ] ) {
+            m_newGeo.remove( i );
+            Node::notifyChanged();
+            return true;
+        }
+    }
+
+    for ( ui32 i = 0; i < m_attachedGeo.size(); i++ ) {
+        if ( geo == m_attachedGeo[ i ] ) {
+            if ( nullptr != m_renderBackendSrv ) {
+                m_renderBackendSrv->detachGeo( geo );
+            }
+            m_attachedGeo.remove( i );
+            Node::notifyChanged();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void RenderComponent::addLodSet( LodSet *lodSet ) {
+    if ( nullptr == lodSet || nullptr == lodSet->getGeometry() ) {
+        return;
+    }
+
+    m_lodSets.add( lodSet );
+    Node::notifyChanged();
+}
+
+ui32 RenderComponent::getNumLodSets() const {
+    return m_lodSets.size();
+}
+
+LodSet *RenderComponent::getLodSetAt( ui32 idx ) const {
+    return m_lodSets[ idx ];
+}
+
+void RenderComponent::updateLod( const glm::mat4 &view, const glm::mat4 &projection ) {
+    if ( m_lodSets.isEmpty() ) {
+        return;
+    }
+
+    glm::mat4 world( 1.0f );
+    TransformComponent *transformComp( ( TransformComponent* ) getOwnerNode()->getComponent( Node::ComponentType::TransformComponentType ) );
+    if ( nullptr != transformComp ) {
+        world = transformComp->getWorlTransformMatrix();
+    }
+
+    for ( ui32 i = 0; i < m_lodSets.size(); i++ ) {
+        LodSet *lodSet( m_lodSets[ i ] );
+        const Geometry *geo( lodSet->getGeometry() );
+        const glm::mat4 model( geo->m_localMatrix ? world * geo->m_model : world );
+        lodSet->select( LodSet::computeScreenSize( lodSet->getAABB(), model, view, projection ) );
+    }
+}
+
+void RenderComponent::hide( RenderBackendService *renderBackendSrv ) {
+    for ( ui32 i = 0; i < m_attachedGeo.size(); i++ ) {
+        renderBackendSrv->hideGeo( m_attachedGeo[ i ] );
+    }
+    for ( ui32 i = 0; i < m_numAttachedLodSets; i++ ) {
+        renderBackendSrv->hideGeo( m_lodSets[ i ]->getGeometry() );
+    }
 }
 
 ui32 RenderComponent::getNumGeometry() const {
@@ -82,6 +189,14 @@ Geometry *RenderComponent::getGeoAt(ui32 idx) const {
     return m_newGeo[idx];
 }
 
+ui32 RenderComponent::getNumAttachedGeometry() const {
+    return m_attachedGeo.size();
+}
+
+Geometry *RenderComponent::getAttachedGeoAt( ui32 idx ) const {
+    return m_attachedGeo[ idx ];
+}
+
 TransformComponent::TransformComponent(Node *node, ui32 id)
 : Component(node, id)
 , m_dirty(NotDirty)
@@ -98,6 +213,7 @@ void TransformComponent::update( Time ) {
     if (m_dirty == NeedsTransform) {
         m_localTransformState.toMatrix(m_transform);
         m_dirty = NotDirty;
+        Node::notifyChanged();
     }
 }
 
@@ -125,6 +241,7 @@ const glm::vec3 &TransformComponent::getScale() const {
 
 void TransformComponent::setTransformationMatrix(const glm::mat4 &m) {
     m_transform = m;
+    Node::notifyChanged();
 }
 
 const glm::mat4 &TransformComponent::getTransformationMatrix() const {
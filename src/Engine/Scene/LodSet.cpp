@@ -0,0 +1,274 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Scene/LodSet.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Logger.h>
+
+#include <string.h>
+
+namespace OSRE {
+namespace Scene {
+
+using namespace ::OSRE::RenderBackend;
+
+static const String Tag = "LodSet";
+
+// Default hysteresis band around the thresholds, 10 percent
+static const f32 DefaultHysteresis = 0.1f;
+
+LodLevel::LodLevel()
+: m_startIndex( 0 )
+, m_numIndices( 0 )
+, m_minScreenSize( 0.0f ) {
+    // empty
+}
+
+LodSet::LodSet()
+: m_levels()
+, m_geo( nullptr )
+, m_aabb()
+, m_hysteresis( DefaultHysteresis )
+, m_activeLevel( 0 )
+, m_changed( false ) {
+    // empty
+}
+
+LodSet::~LodSet() {
+    if ( nullptr != m_geo ) {
+        // The material is owned by the source geometry
+        m_geo->m_material = nullptr;
+        Geometry::destroy( &m_geo );
+    }
+}
+
+static ui32 getIndexSize( IndexType type ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return sizeof( uc8 );
+        case IndexType::UnsignedShort:
+            return sizeof( ui16 );
+        case IndexType::UnsignedInt:
+            return sizeof( ui32 );
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static ui32 readIndex( const BufferData *ib, IndexType type, ui32 idx ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return static_cast<const uc8*>( ib->m_data )[ idx ];
+        case IndexType::UnsignedShort:
+            return static_cast<const ui16*>( ib->m_data )[ idx ];
+        case IndexType::UnsignedInt:
+            return static_cast<const ui32*>( ib->m_data )[ idx ];
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+// The primitive groups have to fit into the index buffer and refer to existing vertices only
+static bool hasValidIndices( const Geometry *geo, ui32 numVertices ) {
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        const ui32 indexSize( getIndexSize( grp.m_indexType ) );
+        if ( 0 == indexSize ) {
+            return false;
+        }
+        const ui32 bufferIndices( geo->m_ib->m_size / indexSize );
+        if ( grp.m_startIndex > bufferIndices || grp.m_numIndices > bufferIndices - grp.m_startIndex ) {
+            return false;
+        }
+        for ( ui32 j = 0; j < grp.m_numIndices; ++j ) {
+            if ( readIndex( geo->m_ib, grp.m_indexType, grp.m_startIndex + j ) >= numVertices ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static glm::vec3 getPosition( const uc8 *vertices, ui32 vertexSize, ui32 idx ) {
+    glm::vec3 pos;
+    ::memcpy( &pos.x, &vertices[ idx * vertexSize ], sizeof( glm::vec3 ) );
+
+    return pos;
+}
+
+bool LodSet::addLevel( const Geometry *geo, f32 minScreenSize ) {
+    if ( nullptr == geo || nullptr == geo->m_vb || nullptr == geo->m_ib || 0 == geo->m_numPrimGroups 
+            || nullptr == geo->m_pPrimGroups ) {
+        osre_debug( Tag, "Invalid geometry for LOD level." );
+        return false;
+    }
+
+    // Only layouts with float positions at the start of the vertex
+    if ( VertexType::RenderVertex != geo->m_vertextype && VertexType::ColorVertex != geo->m_vertextype 
+            && VertexType::CompactRenderVertex != geo->m_vertextype ) {
+        osre_debug( Tag, "Vertex type not supported for LOD levels." );
+        return false;
+    }
+
+    if ( nullptr != m_geo ) {
+        if ( m_geo->m_vertextype != geo->m_vertextype ) {
+            osre_debug( Tag, "All LOD levels must use the same vertex type." );
+            return false;
+        }
+        if ( minScreenSize >= m_levels[ m_levels.size() - 1 ].m_minScreenSize ) {
+            osre_debug( Tag, "LOD levels must be added from the finest to the coarsest one." );
+            return false;
+        }
+    }
+
+    ui32 numIndices( 0 );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        if ( PrimitiveType::TriangleList != geo->m_pPrimGroups[ i ].m_primitive ) {
+            osre_debug( Tag, "Only triangle lists are supported for LOD levels." );
+            return false;
+        }
+        numIndices += geo->m_pPrimGroups[ i ].m_numIndices;
+    }
+
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    const ui32 numVertices( geo->m_vb->m_size / vertexSize );
+    if ( !hasValidIndices( geo, numVertices ) ) {
+        osre_debug( Tag, "Invalid index range for LOD level." );
+        return false;
+    }
+
+    ui32 oldVbSize( 0 ), oldIbSize( 0 );
+    if ( nullptr == m_geo ) {
+        m_geo = Geometry::create( 1 );
+        m_geo->m_vertextype = geo->m_vertextype;
+        m_geo->m_indextype = IndexType::UnsignedInt;
+        m_geo->m_material = geo->m_material;
+        m_geo->m_localMatrix = geo->m_localMatrix;
+        m_geo->m_model = geo->m_model;
+        m_geo->m_numPrimGroups = 1;
+        m_geo->m_pPrimGroups = new PrimitiveGroup[ m_geo->m_numPrimGroups ];
+    } else {
+        oldVbSize = m_geo->m_vb->m_size;
+        oldIbSize = m_geo->m_ib->m_size;
+    }
+
+    // Append the vertices and the rebased indices of the new level to the shared buffers
+    BufferData *vb( BufferData::alloc( BufferType::VertexBuffer, oldVbSize + geo->m_vb->m_size, BufferAccessType::ReadOnly ) );
+    BufferData *ib( BufferData::alloc( BufferType::IndexBuffer, oldIbSize + numIndices * sizeof( ui32 ), BufferAccessType::ReadOnly ) );
+    uc8 *vertices( static_cast<uc8*>( vb->m_data ) );
+    if ( 0 != oldVbSize ) {
+        ::memcpy( vertices, m_geo->m_vb->m_data, oldVbSize );
+        ::memcpy( ib->m_data, m_geo->m_ib->m_data, oldIbSize );
+    }
+    ::memcpy( &vertices[ oldVbSize ], geo->m_vb->m_data, geo->m_vb->m_size );
+    BufferData::free( m_geo->m_vb );
+    BufferData::free( m_geo->m_ib );
+    m_geo->m_vb = vb;
+    m_geo->m_ib = ib;
+
+    LodLevel level;
+    level.m_startIndex = oldIbSize / sizeof( ui32 );
+    level.m_minScreenSize = minScreenSize;
+    const ui32 baseVertex( oldVbSize / vertexSize );
+    ui32 *indices( static_cast<ui32*>( ib->m_data ) );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        for ( ui32 j = 0; j < grp.m_numIndices; ++j ) {
+            indices[ level.m_startIndex + level.m_numIndices ] = baseVertex + readIndex( geo->m_ib, grp.m_indexType, grp.m_startIndex + j );
+            ++level.m_numIndices;
+        }
+    }
+
+    for ( ui32 i = 0; i < numVertices; ++i ) {
+        const glm::vec3 pos( getPosition( static_cast<const uc8*>( geo->m_vb->m_data ), vertexSize, i ) );
+        m_aabb.merge( pos.x, pos.y, pos.z );
+    }
+
+    m_levels.add( level );
+    setActiveLevel( m_activeLevel );
+
+    return true;
+}
+
+ui32 LodSet::select( f32 screenSize ) {
+    if ( m_levels.isEmpty() ) {
+        return 0;
+    }
+
+    // Switch to a finer level only when the threshold is exceeded by the hysteresis band, 
+    // to a coarser one only when the size dropped below it.
+    ui32 level( m_activeLevel );
+    while ( level > 0 && screenSize >= m_levels[ level - 1 ].m_minScreenSize * ( 1.0f + m_hysteresis ) ) {
+        --level;
+    }
+    while ( level + 1 < m_levels.size() && screenSize < m_levels[ level ].m_minScreenSize * ( 1.0f - m_hysteresis ) ) {
+        ++level;
+    }
+
+    if ( level != m_activeLevel ) {
+        setActiveLevel( level );
+        m_changed = true;
+    }
+
+    return m_activeLevel;
+}
+
+void LodSet::setActiveLevel( ui32 level ) {
+    m_activeLevel = level;
+    const LodLevel &current( m_levels[ m_activeLevel ] );
+    m_geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, current.m_numIndices, PrimitiveType::TriangleList, 
+            current.m_startIndex );
+}
+
+f32 LodSet::computeScreenSize( const AABB &box, const glm::mat4 &world, const glm::mat4 &view, 
+        const glm::mat4 &projection ) {
+    const Vec3f center( box.getCenter() );
+    const glm::mat4 modelView( view * world );
+    const glm::vec4 viewPos( modelView * glm::vec4( center[ 0 ], center[ 1 ], center[ 2 ], 1.0f ) );
+
+    // Scale the bounding sphere radius by the largest axis scaling
+    const f32 scale( glm::max( glm::length( glm::vec3( world[ 0 ] ) ), 
+            glm::max( glm::length( glm::vec3( world[ 1 ] ) ), glm::length( glm::vec3( world[ 2 ] ) ) ) ) );
+    const f32 radius( 0.5f * box.getDiameter() * scale );
+
+    // Orthographic projection, size does not depend on the distance
+    if ( 1.0f == projection[ 3 ][ 3 ] ) {
+        return radius * projection[ 1 ][ 1 ];
+    }
+
+    const f32 dist( -viewPos.z );
+    if ( dist <= radius ) {
+        // The viewer is inside of the bounding sphere
+        return 1.0f + radius;
+    }
+
+    return radius * projection[ 1 ][ 1 ] / dist;
+}
+
+} // Namespace Scene
+} // Namespace OSRE
@@ -41,6 +41,23 @@ static const String GLSLRenderVertexLayout =
 	"layout(location = 3) in vec2 texcoord0;  // per-vertex tex coord, stage 0\n"
 	"\n";
 
+static const String GLSLCompactRenderVertexLayout =
+    "// CompactRenderVertex and QuantizedRenderVertex layout, normalized attributes are expanded\n"
+    "// by the vertex fetch, quantized positions are decoded by the model matrix\n"
+    "layout(location = 0) in vec3 position;   // object space vertex position\n"
+    "layout(location = 1) in vec2 normal;     // octahedral encoded object space vertex normal\n"
+    "layout(location = 2) in vec4 color0;     // per-vertex diffuse colour\n"
+    "layout(location = 3) in vec2 texcoord0;  // per-vertex tex coord, stage 0\n"
+    "\n"
+    "vec3 decodeNormal( vec2 e ) {\n"
+    "    vec3 n = vec3( e.xy, 1.0 - abs( e.x ) - abs( e.y ) );\n"
+    "    if ( n.z < 0.0 ) {\n"
+    "        n.xy = ( 1.0 - abs( n.yx ) ) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );\n"
+    "    }\n"
+    "    return normalize( n );\n"
+    "}\n"
+    "\n";
+
 static const String GLSLCombinedMVPUniformSrc =
     "// uniform\n"
     "uniform mat4 MVP;	//combined modelview projection matrix\n";
@@ -112,6 +129,27 @@ const String GLSLVsSrcRV =
     "    vUV = texcoord0;\n"
     "}\n";
 
+const String GLSLVsSrcCRV =
+    GLSLVersionString_400 +
+    "\n"
+    + GLSLCompactRenderVertexLayout +
+    "// output from the vertex shader\n"
+    "smooth out vec4 vSmoothColor;		//smooth colour to fragment shader\n"
+    "smooth out vec3 vNormal;\n"
+    "smooth out vec2 vUV;\n"
+    "\n"
+    + GLSLCombinedMVPUniformSrc +
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    //get the clip space position by multiplying the combined MVP matrix with the object space\n"
+    "    //vertex position\n"
+    "    gl_Position = MVP*vec4(position,1);\n"
+    "    vSmoothColor = color0;\n"
+    "    vNormal = decodeNormal( normal );\n"
+    "    vUV = texcoord0;\n"
+    "}\n";
+
 const String GLSLFsSrcRV =
     GLSLVersionString_400 +
     "\n"
@@ -212,6 +250,9 @@ MaterialBuilder::~MaterialBuilder() {
     } else if ( type == VertexType::RenderVertex ) {
         vs = GLSLVsSrcRV;
         fs = GLSLFsSrcRV;
+    } else if ( type == VertexType::CompactRenderVertex || type == VertexType::QuantizedRenderVertex ) {
+        vs = GLSLVsSrcCRV;
+        fs = GLSLFsSrcRV;
     }
     
     if ( vs.empty() || fs.empty() ) {
@@ -233,6 +274,10 @@ MaterialBuilder::~MaterialBuilder() {
             ui32 numAttribs( RenderVert::getNumAttributes() );
             const String *attribs( RenderVert::getAttributes() );
             mat->m_shader->m_attributes.add( attribs, numAttribs );
+        } else {
+            ui32 numAttribs( CompactRenderVert::getNumAttributes() );
+            const String *attribs( CompactRenderVert::getAttributes() );
+            mat->m_shader->m_attributes.add( attribs, numAttribs );
         }
 
         mat->m_shader->m_parameters.add( "MVP" );
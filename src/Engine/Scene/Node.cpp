@@ -31,6 +31,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <atomic>
+
 namespace OSRE {
 namespace Scene {
 
@@ -38,12 +40,16 @@ using namespace ::OSRE::RenderBackend;
 using namespace ::OSRE::Common;
 using namespace ::OSRE::Assets;
 
+// Components are updated in parallel, so the counter is atomic
+static std::atomic<ui32> s_changeCount( 0 );
+
 Node::Node( const String &name, Ids &ids, RenderCompRequest renderEnabled, TransformCompRequest transformEnabled, 
         Node *parent )
 : Object( name )
 , m_children()
 , m_parent( parent )
 , m_isActive( true )
+, m_isStatic( false )
 , m_renderComp( nullptr )
 , m_transformComp( nullptr )
 , m_ids( &ids )
@@ -65,6 +71,7 @@ Node::Node( const String &name, Ids &ids, RenderCompRequest renderEnabled, Trans
 }
 
 Node::~Node() {
+    notifyChanged();
     for ( ui32 i = 0; i < m_components.size(); i++ ) {
         delete m_components[ i ];
     }
@@ -95,6 +102,7 @@ void Node::addChild( Node *child ) {
 
     m_children.add( child );
     child->get();
+    notifyChanged();
 }
 
 bool Node::removeChild( const String &name, TraverseMode mode ) {
@@ -111,6 +119,7 @@ bool Node::removeChild( const String &name, TraverseMode mode ) {
                 found = true;
                 m_children.remove( i );
                 currentNode->release();
+                notifyChanged();
                 break;
             }
         }
@@ -167,6 +176,7 @@ void Node::releaseChildren() {
             m_children[ i ]->release();
         }
     }
+    notifyChanged();
 }
 
 void Node::addModel( Model *model ) {
@@ -249,6 +259,14 @@ Properties::Property *Node::getProperty(const String name) const {
     return nullptr;
 }
 
+ui32 Node::getChangeCount() {
+    return s_changeCount.load();
+}
+
+void Node::notifyChanged() {
+    ++s_changeCount;
+}
+
 void Node::onUpdate(Time dt) {
     TransformComponent *comp((TransformComponent*)getComponent(Node::ComponentType::TransformComponentType));
     if (nullptr != comp) {
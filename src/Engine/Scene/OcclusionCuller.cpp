@@ -0,0 +1,408 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Scene/OcclusionCuller.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/Component.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#   define OSRE_OCCLUSION_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace OSRE {
+namespace Scene {
+
+using namespace ::OSRE::RenderBackend;
+
+// Size of the rasterization tiles in pixels, must be a multiple of 4
+static const ui32 TileSize = 32;
+
+// Vertices closer to the eye will not be projected
+static const f32 MinW = 1e-5f;
+
+OcclusionCuller::OcclusionCuller( ui32 width, ui32 height )
+: m_width( ( ( width > 0 ? width : 1 ) + TileSize - 1 ) / TileSize * TileSize )
+, m_height( ( ( height > 0 ? height : 1 ) + TileSize - 1 ) / TileSize * TileSize )
+, m_numTilesX( 0 )
+, m_numTilesY( 0 )
+, m_viewProjection( 1.0f )
+, m_depth()
+, m_hiZ()
+, m_triangles()
+, m_tileBins()
+, m_occluders()
+, m_threadPool( nullptr ) {
+    m_numTilesX = m_width / TileSize;
+    m_numTilesY = m_height / TileSize;
+    m_depth.resize( m_width * m_height, 1.0f );
+    m_tileBins.resize( m_numTilesX * m_numTilesY );
+    buildHiZ();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    // empty
+}
+
+void OcclusionCuller::addOccluder( const Geometry *geo, Node *node ) {
+    if ( nullptr == geo ) {
+        return;
+    }
+
+    Occluder occluder;
+    occluder.m_geo = geo;
+    occluder.m_node = node;
+    m_occluders.add( occluder );
+}
+
+bool OcclusionCuller::removeOccluder( const Geometry *geo ) {
+    for ( ui32 i = 0; i < m_occluders.size(); ++i ) {
+        if ( geo == m_occluders[ i ].m_geo ) {
+            m_occluders.remove( i );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::beginFrame( const glm::mat4 &viewProjection ) {
+    m_viewProjection = viewProjection;
+    std::fill( m_depth.begin(), m_depth.end(), 1.0f );
+    m_triangles.resize( 0 );
+    for ( std::vector<ui32> &bin : m_tileBins ) {
+        bin.resize( 0 );
+    }
+}
+
+static ui32 readIndex( const Geometry *geo, IndexType type, ui32 idx ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return static_cast<const uc8*>( geo->m_ib->m_data )[ idx ];
+        case IndexType::UnsignedShort:
+            return static_cast<const ui16*>( geo->m_ib->m_data )[ idx ];
+        case IndexType::UnsignedInt:
+            return static_cast<const ui32*>( geo->m_ib->m_data )[ idx ];
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+void OcclusionCuller::submitOccluder( const Geometry *geo, const glm::mat4 &world ) {
+    if ( nullptr == geo || nullptr == geo->m_vb || nullptr == geo->m_ib ) {
+        return;
+    }
+
+    // Only layouts with float positions at the start of the vertex
+    if ( VertexType::RenderVertex != geo->m_vertextype && VertexType::ColorVertex != geo->m_vertextype 
+            && VertexType::CompactRenderVertex != geo->m_vertextype ) {
+        return;
+    }
+
+    const glm::mat4 mvp( m_viewProjection * world );
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    const ui32 numVertices( geo->m_vb->m_size / vertexSize );
+    const uc8 *vertices( static_cast<const uc8*>( geo->m_vb->m_data ) );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        if ( PrimitiveType::TriangleList != grp.m_primitive ) {
+            continue;
+        }
+
+        for ( ui32 j = 0; j + 2 < grp.m_numIndices; j += 3 ) {
+            ScreenTriangle tri;
+            bool valid( true );
+            for ( ui32 k = 0; k < 3 && valid; ++k ) {
+                const ui32 idx( readIndex( geo, grp.m_indexType, grp.m_startIndex + j + k ) );
+                if ( idx >= numVertices ) {
+                    valid = false;
+                    break;
+                }
+                // Position is the first attribute of all supported vertex types
+                const glm::vec3 &pos( *reinterpret_cast<const glm::vec3*>( &vertices[ idx * vertexSize ] ) );
+                const glm::vec4 clip( mvp * glm::vec4( pos, 1.0f ) );
+
+                // Occluders crossing the near plane are skipped, this keeps the culling conservative
+                if ( clip.w < MinW ) {
+                    valid = false;
+                    break;
+                }
+                const f32 invW( 1.0f / clip.w );
+                tri.m_x[ k ] = ( clip.x * invW * 0.5f + 0.5f ) * m_width;
+                tri.m_y[ k ] = ( clip.y * invW * 0.5f + 0.5f ) * m_height;
+                tri.m_z[ k ] = clip.z * invW * 0.5f + 0.5f;
+                valid = tri.m_z[ k ] >= 0.0f;
+            }
+            if ( !valid ) {
+                continue;
+            }
+
+            // Bin the triangle into all tiles touched by its bounding box
+            const f32 minX( std::min( tri.m_x[ 0 ], std::min( tri.m_x[ 1 ], tri.m_x[ 2 ] ) ) );
+            const f32 maxX( std::max( tri.m_x[ 0 ], std::max( tri.m_x[ 1 ], tri.m_x[ 2 ] ) ) );
+            const f32 minY( std::min( tri.m_y[ 0 ], std::min( tri.m_y[ 1 ], tri.m_y[ 2 ] ) ) );
+            const f32 maxY( std::max( tri.m_y[ 0 ], std::max( tri.m_y[ 1 ], tri.m_y[ 2 ] ) ) );
+            if ( maxX < 0.0f || maxY < 0.0f || minX >= m_width || minY >= m_height ) {
+                continue;
+            }
+
+            const ui32 triIdx( static_cast<ui32>( m_triangles.size() ) );
+            m_triangles.push_back( tri );
+            const ui32 tileX0( static_cast<ui32>( std::max( minX, 0.0f ) ) / TileSize );
+            const ui32 tileY0( static_cast<ui32>( std::max( minY, 0.0f ) ) / TileSize );
+            const ui32 tileX1( std::min( static_cast<ui32>( maxX ) / TileSize, m_numTilesX - 1 ) );
+            const ui32 tileY1( std::min( static_cast<ui32>( maxY ) / TileSize, m_numTilesY - 1 ) );
+            for ( ui32 ty = tileY0; ty <= tileY1; ++ty ) {
+                for ( ui32 tx = tileX0; tx <= tileX1; ++tx ) {
+                    m_tileBins[ ty * m_numTilesX + tx ].push_back( triIdx );
+                }
+            }
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTile( ui32 tileIdx ) {
+    const i32 tileX0( static_cast<i32>( ( tileIdx % m_numTilesX ) * TileSize ) );
+    const i32 tileY0( static_cast<i32>( ( tileIdx / m_numTilesX ) * TileSize ) );
+    const i32 tileX1( tileX0 + static_cast<i32>( TileSize ) - 1 );
+    const i32 tileY1( tileY0 + static_cast<i32>( TileSize ) - 1 );
+
+    for ( ui32 triIdx : m_tileBins[ tileIdx ] ) {
+        const ScreenTriangle &tri( m_triangles[ triIdx ] );
+        f32 x0( tri.m_x[ 0 ] ), y0( tri.m_y[ 0 ] ), z0( tri.m_z[ 0 ] );
+        f32 x1( tri.m_x[ 1 ] ), y1( tri.m_y[ 1 ] ), z1( tri.m_z[ 1 ] );
+        f32 x2( tri.m_x[ 2 ] ), y2( tri.m_y[ 2 ] ), z2( tri.m_z[ 2 ] );
+        f32 area( ( x1 - x0 ) * ( y2 - y0 ) - ( x2 - x0 ) * ( y1 - y0 ) );
+        if ( std::fabs( area ) < 1e-8f ) {
+            continue;
+        }
+
+        // Both windings are rasterized, make it counter-clockwise
+        if ( area < 0.0f ) {
+            std::swap( x1, x2 );
+            std::swap( y1, y2 );
+            std::swap( z1, z2 );
+            area = -area;
+        }
+
+        const i32 minX( std::max( tileX0, static_cast<i32>( std::floor( std::min( x0, std::min( x1, x2 ) ) ) ) ) & ~3 );
+        const i32 maxX( std::min( tileX1, static_cast<i32>( std::ceil( std::max( x0, std::max( x1, x2 ) ) ) ) ) );
+        const i32 minY( std::max( tileY0, static_cast<i32>( std::floor( std::min( y0, std::min( y1, y2 ) ) ) ) ) );
+        const i32 maxY( std::min( tileY1, static_cast<i32>( std::ceil( std::max( y0, std::max( y1, y2 ) ) ) ) ) );
+        if ( minX > maxX || minY > maxY ) {
+            continue;
+        }
+
+        // Edge functions and depth plane, evaluated at the pixel centers
+        const f32 ex[ 3 ] = { x1 - x0, x2 - x1, x0 - x2 };
+        const f32 ey[ 3 ] = { y1 - y0, y2 - y1, y0 - y2 };
+        const f32 ox[ 3 ] = { x0, x1, x2 };
+        const f32 oy[ 3 ] = { y0, y1, y2 };
+        const f32 dzdx( ( ( z1 - z0 ) * ( y2 - y0 ) - ( z2 - z0 ) * ( y1 - y0 ) ) / area );
+        const f32 dzdy( ( ( z2 - z0 ) * ( x1 - x0 ) - ( z1 - z0 ) * ( x2 - x0 ) ) / area );
+        const f32 px( minX + 0.5f );
+        for ( i32 y = minY; y <= maxY; ++y ) {
+            const f32 py( y + 0.5f );
+            f32 e[ 3 ];
+            for ( ui32 k = 0; k < 3; ++k ) {
+                e[ k ] = ex[ k ] * ( py - oy[ k ] ) - ey[ k ] * ( px - ox[ k ] );
+            }
+            f32 z( z0 + dzdx * ( px - x0 ) + dzdy * ( py - y0 ) );
+            f32 *row( &m_depth[ y * m_width ] );
+
+#ifdef OSRE_OCCLUSION_SSE2
+            const __m128 lane( _mm_setr_ps( 0.0f, 1.0f, 2.0f, 3.0f ) );
+            const __m128 zero( _mm_setzero_ps() );
+            __m128 e0( _mm_sub_ps( _mm_set1_ps( e[ 0 ] ), _mm_mul_ps( lane, _mm_set1_ps( ey[ 0 ] ) ) ) );
+            __m128 e1( _mm_sub_ps( _mm_set1_ps( e[ 1 ] ), _mm_mul_ps( lane, _mm_set1_ps( ey[ 1 ] ) ) ) );
+            __m128 e2( _mm_sub_ps( _mm_set1_ps( e[ 2 ] ), _mm_mul_ps( lane, _mm_set1_ps( ey[ 2 ] ) ) ) );
+            __m128 zv( _mm_add_ps( _mm_set1_ps( z ), _mm_mul_ps( lane, _mm_set1_ps( dzdx ) ) ) );
+            const __m128 e0Step( _mm_set1_ps( -4.0f * ey[ 0 ] ) );
+            const __m128 e1Step( _mm_set1_ps( -4.0f * ey[ 1 ] ) );
+            const __m128 e2Step( _mm_set1_ps( -4.0f * ey[ 2 ] ) );
+            const __m128 zStep( _mm_set1_ps( 4.0f * dzdx ) );
+            for ( i32 x = minX; x <= maxX; x += 4 ) {
+                const __m128 inside( _mm_and_ps( _mm_cmpge_ps( e0, zero ), 
+                        _mm_and_ps( _mm_cmpge_ps( e1, zero ), _mm_cmpge_ps( e2, zero ) ) ) );
+                if ( 0 != _mm_movemask_ps( inside ) ) {
+                    const __m128 old( _mm_loadu_ps( &row[ x ] ) );
+                    const __m128 nearest( _mm_min_ps( old, zv ) );
+                    _mm_storeu_ps( &row[ x ], _mm_or_ps( _mm_and_ps( inside, nearest ), _mm_andnot_ps( inside, old ) ) );
+                }
+                e0 = _mm_add_ps( e0, e0Step );
+                e1 = _mm_add_ps( e1, e1Step );
+                e2 = _mm_add_ps( e2, e2Step );
+                zv = _mm_add_ps( zv, zStep );
+            }
+#else
+            for ( i32 x = minX; x <= maxX; ++x ) {
+                if ( e[ 0 ] >= 0.0f && e[ 1 ] >= 0.0f && e[ 2 ] >= 0.0f && z < row[ x ] ) {
+                    row[ x ] = z;
+                }
+                e[ 0 ] -= ey[ 0 ];
+                e[ 1 ] -= ey[ 1 ];
+                e[ 2 ] -= ey[ 2 ];
+                z += dzdx;
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::endFrame() {
+    const ui32 numTiles( m_numTilesX * m_numTilesY );
+    if ( nullptr != m_threadPool ) {
+        m_threadPool->parallelFor( numTiles, 1, [ this ]( ui32 begin, ui32 end ) {
+            for ( ui32 i = begin; i < end; ++i ) {
+                rasterizeTile( i );
+            }
+        } );
+    } else {
+        for ( ui32 i = 0; i < numTiles; ++i ) {
+            rasterizeTile( i );
+        }
+    }
+
+    buildHiZ();
+}
+
+void OcclusionCuller::update( const glm::mat4 &viewProjection ) {
+    beginFrame( viewProjection );
+    for ( ui32 i = 0; i < m_occluders.size(); ++i ) {
+        const Occluder &occluder( m_occluders[ i ] );
+        glm::mat4 world( 1.0f );
+        if ( nullptr != occluder.m_node ) {
+            TransformComponent *comp( ( TransformComponent* ) occluder.m_node->getComponent( Node::ComponentType::TransformComponentType ) );
+            if ( nullptr != comp ) {
+                world = comp->getWorlTransformMatrix();
+            }
+        }
+        if ( occluder.m_geo->m_localMatrix ) {
+            world = world * occluder.m_geo->m_model;
+        }
+        submitOccluder( occluder.m_geo, world );
+    }
+    endFrame();
+}
+
+void OcclusionCuller::buildHiZ() {
+    // Each level stores the farthest depth of the 2x2 texels below
+    m_hiZ.resize( 1 );
+    m_hiZ[ 0 ].m_width = m_width;
+    m_hiZ[ 0 ].m_height = m_height;
+    m_hiZ[ 0 ].m_depth = m_depth;
+    while ( m_hiZ.back().m_width > 1 || m_hiZ.back().m_height > 1 ) {
+        const HiZLevel &src( m_hiZ.back() );
+        HiZLevel dst;
+        dst.m_width = std::max( 1u, ( src.m_width + 1 ) / 2 );
+        dst.m_height = std::max( 1u, ( src.m_height + 1 ) / 2 );
+        dst.m_depth.resize( dst.m_width * dst.m_height );
+        for ( ui32 y = 0; y < dst.m_height; ++y ) {
+            const ui32 sy0( std::min( y * 2, src.m_height - 1 ) ), sy1( std::min( y * 2 + 1, src.m_height - 1 ) );
+            for ( ui32 x = 0; x < dst.m_width; ++x ) {
+                const ui32 sx0( std::min( x * 2, src.m_width - 1 ) ), sx1( std::min( x * 2 + 1, src.m_width - 1 ) );
+                dst.m_depth[ y * dst.m_width + x ] = std::max( 
+                        std::max( src.m_depth[ sy0 * src.m_width + sx0 ], src.m_depth[ sy0 * src.m_width + sx1 ] ),
+                        std::max( src.m_depth[ sy1 * src.m_width + sx0 ], src.m_depth[ sy1 * src.m_width + sx1 ] ) );
+            }
+        }
+        m_hiZ.push_back( dst );
+    }
+}
+
+bool OcclusionCuller::isVisible( const AABB &box, const glm::mat4 &world ) const {
+    const Vec3f &bmin( box.getMin() ), &bmax( box.getMax() );
+    if ( bmin[ 0 ] > bmax[ 0 ] || bmin[ 1 ] > bmax[ 1 ] || bmin[ 2 ] > bmax[ 2 ] ) {
+        // No valid bounds, cannot be culled
+        return true;
+    }
+
+    const glm::mat4 mvp( m_viewProjection * world );
+    f32 minX( 1e30f ), minY( 1e30f ), maxX( -1e30f ), maxY( -1e30f ), minZ( 1e30f );
+    for ( ui32 i = 0; i < 8; ++i ) {
+        const glm::vec4 corner( ( i & 1 ) ? bmax[ 0 ] : bmin[ 0 ], ( i & 2 ) ? bmax[ 1 ] : bmin[ 1 ], 
+                ( i & 4 ) ? bmax[ 2 ] : bmin[ 2 ], 1.0f );
+        const glm::vec4 clip( mvp * corner );
+        if ( clip.w < MinW ) {
+            // The box touches the eye plane
+            return true;
+        }
+        const f32 invW( 1.0f / clip.w );
+        const f32 x( ( clip.x * invW * 0.5f + 0.5f ) * m_width );
+        const f32 y( ( clip.y * invW * 0.5f + 0.5f ) * m_height );
+        minX = std::min( minX, x );
+        maxX = std::max( maxX, x );
+        minY = std::min( minY, y );
+        maxY = std::max( maxY, y );
+        minZ = std::min( minZ, clip.z * invW * 0.5f + 0.5f );
+    }
+
+    if ( minZ < 0.0f ) {
+        return true;
+    }
+
+    // Outside of the screen
+    if ( maxX < 0.0f || maxY < 0.0f || minX >= m_width || minY >= m_height ) {
+        return false;
+    }
+
+    ui32 x0( static_cast<ui32>( std::max( minX, 0.0f ) ) );
+    ui32 y0( static_cast<ui32>( std::max( minY, 0.0f ) ) );
+    ui32 x1( std::min( static_cast<ui32>( maxX ), m_width - 1 ) );
+    ui32 y1( std::min( static_cast<ui32>( maxY ), m_height - 1 ) );
+
+    // Select the level where the rectangle covers only a few texels
+    ui32 level( 0 );
+    while ( level + 1 < m_hiZ.size() && ( ( x1 >> level ) - ( x0 >> level ) > 2 || ( y1 >> level ) - ( y0 >> level ) > 2 ) ) {
+        ++level;
+    }
+
+    const HiZLevel &hiZ( m_hiZ[ level ] );
+    for ( ui32 y = y0 >> level; y <= ( y1 >> level ); ++y ) {
+        for ( ui32 x = x0 >> level; x <= ( x1 >> level ); ++x ) {
+            if ( minZ <= hiZ.m_depth[ y * hiZ.m_width + x ] ) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+f32 OcclusionCuller::getDepth( ui32 x, ui32 y ) const {
+    if ( x >= m_width || y >= m_height ) {
+        return 1.0f;
+    }
+
+    return m_depth[ y * m_width + x ];
+}
+
+} // Namespace Scene
+} // Namespace OSRE
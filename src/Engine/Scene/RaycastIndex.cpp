@@ -0,0 +1,290 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Scene/RaycastIndex.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/Component.h>
+#include <osre/Scene/LodSet.h>
+#include <osre/Collision/TriangleBvh.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <algorithm>
+
+namespace OSRE {
+namespace Scene {
+
+using namespace ::OSRE::Collision;
+using namespace ::OSRE::RenderBackend;
+
+RaycastHit::RaycastHit()
+: m_node( nullptr )
+, m_geo( nullptr )
+, m_triangle( TriangleBvh::InvalidTriangle )
+, m_distance( 0.0f )
+, m_position( 0.0f ) {
+    // empty
+}
+
+RaycastIndex::RaycastIndex()
+: m_instances()
+, m_meshes()
+, m_bvh() {
+    // empty
+}
+
+RaycastIndex::~RaycastIndex() {
+    clear();
+}
+
+ui32 RaycastIndex::build( Node *root ) {
+    m_instances.resize( 0 );
+    m_bvh.clear();
+    for ( std::map<const Geometry*, MeshEntry>::iterator it = m_meshes.begin(); it != m_meshes.end(); ++it ) {
+        it->second.m_used = false;
+    }
+
+    collectInstances( root );
+
+    // Drop the triangle BVHs of geometries which are not part of the tree anymore
+    for ( std::map<const Geometry*, MeshEntry>::iterator it = m_meshes.begin(); it != m_meshes.end(); ) {
+        if ( it->second.m_used ) {
+            ++it;
+        } else {
+            delete it->second.m_bvh;
+            it = m_meshes.erase( it );
+        }
+    }
+
+    std::vector<Bvh4::AABB> boxes( m_instances.size() );
+    for ( size_t i = 0; i < m_instances.size(); ++i ) {
+        const Instance &instance( m_instances[ i ] );
+        const Bvh4::AABB &bounds( instance.m_mesh->getBvh().getBounds() );
+        for ( ui32 corner = 0; corner < 8; ++corner ) {
+            const glm::vec4 pos( ( corner & 1 ) ? bounds.getMax()[ 0 ] : bounds.getMin()[ 0 ],
+                                 ( corner & 2 ) ? bounds.getMax()[ 1 ] : bounds.getMin()[ 1 ],
+                                 ( corner & 4 ) ? bounds.getMax()[ 2 ] : bounds.getMin()[ 2 ], 1.0f );
+            const glm::vec4 worldPos( instance.m_world * pos );
+            boxes[ i ].merge( worldPos.x, worldPos.y, worldPos.z );
+        }
+    }
+    m_bvh.build( boxes.empty() ? nullptr : &boxes[ 0 ], static_cast<ui32>( boxes.size() ), 1 );
+
+    return static_cast<ui32>( m_instances.size() );
+}
+
+void RaycastIndex::clear() {
+    m_instances.resize( 0 );
+    m_bvh.clear();
+    for ( std::map<const Geometry*, MeshEntry>::iterator it = m_meshes.begin(); it != m_meshes.end(); ++it ) {
+        delete it->second.m_bvh;
+    }
+    m_meshes.clear();
+}
+
+void RaycastIndex::collectInstances( Node *node ) {
+    if ( nullptr == node || !node->isActive() ) {
+        return;
+    }
+
+    RenderComponent *renderComp( ( RenderComponent* ) node->getComponent( Node::ComponentType::RenderComponentType ) );
+    if ( nullptr != renderComp ) {
+        glm::mat4 world( 1.0f );
+        TransformComponent *transformComp( ( TransformComponent* ) node->getComponent( Node::ComponentType::TransformComponentType ) );
+        if ( nullptr != transformComp ) {
+            world = transformComp->getWorlTransformMatrix();
+        }
+
+        for ( ui32 i = 0; i < renderComp->getNumGeometry(); ++i ) {
+            addInstance( node, renderComp->getGeoAt( i ), world, 0, 0 );
+        }
+        for ( ui32 i = 0; i < renderComp->getNumAttachedGeometry(); ++i ) {
+            addInstance( node, renderComp->getAttachedGeoAt( i ), world, 0, 0 );
+        }
+
+        // Detail levels are picked against the finest level
+        for ( ui32 i = 0; i < renderComp->getNumLodSets(); ++i ) {
+            const LodSet *lodSet( renderComp->getLodSetAt( i ) );
+            if ( 0 != lodSet->getNumLevels() ) {
+                const LodLevel &level( lodSet->getLevelAt( 0 ) );
+                addInstance( node, lodSet->getGeometry(), world, level.m_startIndex, level.m_numIndices );
+            }
+        }
+    }
+
+    for ( ui32 i = 0; i < node->getNumChildren(); ++i ) {
+        collectInstances( node->getChildAt( i ) );
+    }
+}
+
+void RaycastIndex::addInstance( Node *node, Geometry *geo, const glm::mat4 &world, ui32 startIndex, ui32 numIndices ) {
+    if ( nullptr == geo ) {
+        return;
+    }
+
+    // A geometry created at the address of a released one has another serial
+    std::map<const Geometry*, MeshEntry>::iterator it( m_meshes.find( geo ) );
+    if ( m_meshes.end() == it ) {
+        MeshEntry entry = { new TriangleBvh, 0, false };
+        it = m_meshes.insert( std::make_pair( geo, entry ) ).first;
+    }
+    if ( it->second.m_serial != geo->m_serial ) {
+        if ( 0 == numIndices || nullptr == geo->m_pPrimGroups ) {
+            it->second.m_bvh->build( geo );
+        } else {
+            it->second.m_bvh->build( geo, geo->m_pPrimGroups[ 0 ].m_indexType, startIndex, numIndices );
+        }
+        it->second.m_serial = geo->m_serial;
+    }
+    it->second.m_used = true;
+    if ( 0 == it->second.m_bvh->getNumTriangles() ) {
+        return;
+    }
+
+    Instance instance;
+    instance.m_node = node;
+    instance.m_geo = geo;
+    instance.m_mesh = it->second.m_bvh;
+    instance.m_world = geo->m_localMatrix ? world * geo->m_model : world;
+    instance.m_invWorld = glm::inverse( instance.m_world );
+    m_instances.push_back( instance );
+}
+
+Bvh4::Ray RaycastIndex::toObjectSpace( const Instance &instance, const Bvh4::Ray &ray ) const {
+    // The direction will not be normalized, so the distances stay the same in both spaces
+    const glm::vec4 origin( instance.m_invWorld * glm::vec4( ray.m_origin, 1.0f ) );
+    const glm::vec4 direction( instance.m_invWorld * glm::vec4( ray.m_direction, 0.0f ) );
+
+    return Bvh4::Ray( glm::vec3( origin ), glm::vec3( direction ) );
+}
+
+bool RaycastIndex::raycast( const Ray &ray, RaycastHit &hit, f32 maxDist ) const {
+    const Bvh4::Ray worldRay( ray );
+    bool found( false );
+    m_bvh.traverse( worldRay, maxDist, [ this, &worldRay, &hit, &found ]( ui32 instanceIdx, f32 &maxDist ) {
+        const Instance &instance( m_instances[ instanceIdx ] );
+        TriangleBvh::Hit meshHit;
+        if ( !instance.m_mesh->intersect( toObjectSpace( instance, worldRay ), maxDist, meshHit ) ) {
+            return false;
+        }
+        maxDist = meshHit.m_distance;
+        hit.m_node = instance.m_node;
+        hit.m_geo = instance.m_geo;
+        hit.m_triangle = meshHit.m_triangle;
+        hit.m_distance = meshHit.m_distance;
+        hit.m_position = worldRay.m_origin + worldRay.m_direction * meshHit.m_distance;
+        found = true;
+        return true;
+    } );
+
+    return found;
+}
+
+ui32 RaycastIndex::raycastAll( const Ray &ray, CPPCore::TArray<RaycastHit> &hits, f32 maxDist ) const {
+    const Bvh4::Ray worldRay( ray );
+    std::vector<RaycastHit> found;
+    CPPCore::TArray<TriangleBvh::Hit> meshHits;
+    m_bvh.traverse( worldRay, maxDist, [ this, &worldRay, &found, &meshHits ]( ui32 instanceIdx, f32 &maxDist ) {
+        const Instance &instance( m_instances[ instanceIdx ] );
+        meshHits.resize( 0 );
+        instance.m_mesh->intersectAll( toObjectSpace( instance, worldRay ), maxDist, meshHits );
+        for ( ui32 i = 0; i < meshHits.size(); ++i ) {
+            RaycastHit hit;
+            hit.m_node = instance.m_node;
+            hit.m_geo = instance.m_geo;
+            hit.m_triangle = meshHits[ i ].m_triangle;
+            hit.m_distance = meshHits[ i ].m_distance;
+            hit.m_position = worldRay.m_origin + worldRay.m_direction * hit.m_distance;
+            found.push_back( hit );
+        }
+        return false;
+    } );
+
+    std::sort( found.begin(), found.end(), []( const RaycastHit &lhs, const RaycastHit &rhs ) {
+        return lhs.m_distance < rhs.m_distance;
+    } );
+    for ( size_t i = 0; i < found.size(); ++i ) {
+        hits.add( found[ i ] );
+    }
+
+    return static_cast<ui32>( found.size() );
+}
+
+ui32 RaycastIndex::raycastPacket( const Ray *rays, ui32 numRays, RaycastHit *hits, f32 maxDist ) const {
+    if ( nullptr == rays || nullptr == hits ) {
+        return 0;
+    }
+
+    ui32 numFound( 0 );
+    for ( ui32 first = 0; first < numRays; first += Bvh4::PacketSize ) {
+        Bvh4::RayPacket packet;
+        f32 packetMaxDist[ Bvh4::PacketSize ];
+        for ( ui32 i = first; i < numRays && packet.add( Bvh4::Ray( rays[ i ] ) ); ++i ) {
+            packetMaxDist[ i - first ] = maxDist;
+            hits[ i ] = RaycastHit();
+        }
+
+        m_bvh.traversePacket( packet, packetMaxDist, [ this, &packet, hits, first ]( ui32 instanceIdx, ui32 rayMask, f32 *maxDist ) {
+            const Instance &instance( m_instances[ instanceIdx ] );
+
+            // Only the rays hitting the instance bounds will be tested against its triangles
+            Bvh4::RayPacket objectPacket;
+            ui32 rayIdx[ Bvh4::PacketSize ];
+            f32 objectMaxDist[ Bvh4::PacketSize ];
+            for ( ui32 i = 0; i < packet.m_numRays; ++i ) {
+                if ( 0 != ( rayMask & ( 1 << i ) ) ) {
+                    rayIdx[ objectPacket.m_numRays ] = i;
+                    objectMaxDist[ objectPacket.m_numRays ] = maxDist[ i ];
+                    objectPacket.add( toObjectSpace( instance, packet.getRay( i ) ) );
+                }
+            }
+
+            TriangleBvh::Hit meshHits[ Bvh4::PacketSize ];
+            instance.m_mesh->intersectPacket( objectPacket, objectMaxDist, meshHits );
+            for ( ui32 i = 0; i < objectPacket.m_numRays; ++i ) {
+                if ( TriangleBvh::InvalidTriangle == meshHits[ i ].m_triangle ) {
+                    continue;
+                }
+                const ui32 idx( rayIdx[ i ] );
+                const Bvh4::Ray worldRay( packet.getRay( idx ) );
+                RaycastHit &hit( hits[ first + idx ] );
+                maxDist[ idx ] = meshHits[ i ].m_distance;
+                hit.m_node = instance.m_node;
+                hit.m_geo = instance.m_geo;
+                hit.m_triangle = meshHits[ i ].m_triangle;
+                hit.m_distance = meshHits[ i ].m_distance;
+                hit.m_position = worldRay.m_origin + worldRay.m_direction * hit.m_distance;
+            }
+        } );
+
+        for ( ui32 i = 0; i < packet.m_numRays; ++i ) {
+            if ( nullptr != hits[ first + i ].m_node ) {
+                ++numFound;
+            }
+        }
+    }
+
+    return numFound;
+}
+
+} // Namespace Scene
+} // Namespace OSRE
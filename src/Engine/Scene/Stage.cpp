@@ -23,10 +23,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/Scene/Stage.h>
 #include <osre/Scene/Node.h>
 #include <osre/Scene/View.h>
+#include <osre/Scene/Component.h>
+#include <osre/Scene/StaticBatcher.h>
+#include <osre/Scene/OcclusionCuller.h>
+#include <osre/Scene/RaycastIndex.h>
 #include <osre/RenderBackend/RenderCommon.h>
 #include <osre/RenderBackend/RenderBackendService.h>
 #include <osre/Common/StringUtils.h>
 #include <osre/Common/Ids.h>
+#include <osre/Threading/ThreadPool.h>
 
 namespace OSRE {
 namespace Scene {
@@ -34,6 +39,9 @@ namespace Scene {
 using namespace ::OSRE::Common;
 using namespace ::OSRE::RenderBackend;
 
+// Minimal number of active nodes to split the update into parallel tasks
+static const ui32 DefaultParallelUpdateThreshold = 1024;
+
 static ui32 calcHash( const String &name ) {
     const ui32 hash( StringUtils::hashName( name.c_str() ) );
     return hash;
@@ -67,7 +75,18 @@ Stage::Stage( const String &name, RenderBackendService *rbService )
 , m_registeredFactories()
 , m_transformBlocks( 5 )
 , m_rbService( rbService )
-, m_ids( nullptr ) {
+, m_ids( nullptr )
+, m_staticBatcher( nullptr )
+, m_staticBatchNode( nullptr )
+, m_occlusionCuller( nullptr )
+, m_nodeUpdateEnabled( false )
+, m_threadPool( nullptr )
+, m_parallelUpdateThreshold( DefaultParallelUpdateThreshold )
+, m_updateOrder()
+, m_subtreeSizes()
+, m_raycastIndex( nullptr )
+, m_raycastIndexDirty( true )
+, m_raycastChangeCount( 0 ) {
     m_ids = new Ids;
     m_root = new Node( "name" + String( ".root" ), *m_ids, 
         Node::RenderCompRequest::RenderCompRequested, 
@@ -77,6 +96,11 @@ Stage::Stage( const String &name, RenderBackendService *rbService )
 }
 
 Stage::~Stage() {
+    releaseStaticBatchNode();
+    delete m_staticBatcher;
+    m_staticBatcher = nullptr;
+    delete m_raycastIndex;
+    m_raycastIndex = nullptr;
     releaseChildNodes( m_root );
     m_ids = nullptr;
 }
@@ -154,14 +178,86 @@ View *Stage::addView( const String &name, Node *parent ) {
 }
 
 void Stage::clear() {
+    // The batches refer to the nodes, which will be released
+    releaseStaticBatchNode();
+    if ( nullptr != m_staticBatcher ) {
+        m_staticBatcher->clear();
+    }
     releaseChildNodes( m_root );
+    if ( nullptr != m_raycastIndex ) {
+        m_raycastIndex->clear();
+    }
+    m_raycastIndexDirty = true;
+}
+
+// Stores the active nodes in pre-order, so each subtree is a consecutive range
+static ui32 collectActiveNodes( Node *node, std::vector<Node*> &order, std::vector<ui32> &subtreeSizes ) {
+    if ( nullptr == node || !node->isActive() ) {
+        return 0;
+    }
+
+    const size_t idx( order.size() );
+    order.push_back( node );
+    subtreeSizes.push_back( 1 );
+    ui32 size( 1 );
+    for ( ui32 i = 0; i < node->getNumChildren(); ++i ) {
+        size += collectActiveNodes( node->getChildAt( i ), order, subtreeSizes );
+    }
+    subtreeSizes[ idx ] = size;
+
+    return size;
+}
+
+void Stage::updateSubtree( ui32 idx, Time dt ) {
+    const ui32 size( m_subtreeSizes[ idx ] );
+    if ( nullptr == m_threadPool || size < m_parallelUpdateThreshold ) {
+        for ( ui32 i = idx; i < idx + size; ++i ) {
+            m_updateOrder[ i ]->update( dt );
+        }
+        return;
+    }
+
+    // Update the parent first, then split the child subtrees into tasks
+    m_updateOrder[ idx ]->update( dt );
+    std::vector<ui32> children;
+    for ( ui32 child = idx + 1; child < idx + size; child += m_subtreeSizes[ child ] ) {
+        children.push_back( child );
+    }
+    m_threadPool->parallelFor( static_cast<ui32>( children.size() ), 1, [ this, &children, dt ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            updateSubtree( children[ i ], dt );
+        }
+    } );
 }
 
 void Stage::update( Time dt ) {
+    if ( m_nodeUpdateEnabled ) {
+        m_updateOrder.resize( 0 );
+        m_subtreeSizes.resize( 0 );
+        if ( 0 != collectActiveNodes( m_root, m_updateOrder, m_subtreeSizes ) ) {
+            updateSubtree( 0, dt );
+        }
+    }
+
     onUpdate( dt );
 }
 
-static void drawNode( Node *current, bool traverse, RenderBackendService *rb ) {
+static bool isOccluded( Node *node, const OcclusionCuller *culler ) {
+    if ( nullptr == culler ) {
+        return false;
+    }
+
+    glm::mat4 world( 1.0f );
+    TransformComponent *transformComp( ( TransformComponent* ) node->getComponent( Node::ComponentType::TransformComponentType ) );
+    if ( nullptr != transformComp ) {
+        world = transformComp->getWorlTransformMatrix();
+    }
+
+    return !culler->isVisible( node->getAABB(), world );
+}
+
+static void drawNode( Node *current, bool traverse, RenderBackendService *rb, const View *view, 
+        const OcclusionCuller *culler ) {
     if (nullptr == current) {
         return;
     }
@@ -171,14 +267,31 @@ static void drawNode( Node *current, bool traverse, RenderBackendService *rb ) {
         return;
     }
 
-    current->draw( rb );
+    // occluded nodes will not be submitted and their attached geometries will not be drawn, 
+    // their children have their own bounds
+    if ( isOccluded( current, culler ) ) {
+        RenderComponent *renderComp( ( RenderComponent* ) current->getComponent( Node::ComponentType::RenderComponentType ) );
+        if ( nullptr != renderComp ) {
+            renderComp->hide( rb );
+        }
+    } else {
+        // select the detail levels for the active view before submitting
+        if ( nullptr != view ) {
+            RenderComponent *renderComp( ( RenderComponent* ) current->getComponent( Node::ComponentType::RenderComponentType ) );
+            if ( nullptr != renderComp ) {
+                renderComp->updateLod( view->getView(), view->getProjection() );
+            }
+        }
+
+        current->draw( rb );
+    }
 
     // traverse all children, if requested
     if (traverse) {
         const ui32 numChilds( current->getNumChildren() );
         for (ui32 i = 0; i < numChilds; ++i) {
             Node *child( current->getChildAt( i ) );
-            drawNode( child, traverse, rb );
+            drawNode( child, traverse, rb, view, culler );
         }
     }
 }
@@ -188,7 +301,22 @@ void Stage::draw( RenderBackendService *renderBackendSrv ) {
         return;
     }
 
-    drawNode( m_root, true, m_rbService );
+    const View *activeView( m_views.isEmpty() ? nullptr : m_views[ 0 ] );
+    const OcclusionCuller *culler( nullptr );
+    if ( nullptr != activeView && nullptr != m_occlusionCuller ) {
+        m_occlusionCuller->update( activeView->getProjection() * activeView->getView() );
+        culler = m_occlusionCuller;
+    }
+
+    // The batches draw only the visible sub-meshes
+    if ( nullptr != m_staticBatcher ) {
+        if ( nullptr != culler ) {
+            m_staticBatcher->cull( *culler, m_rbService );
+        } else {
+            m_staticBatcher->resetCulling( m_rbService );
+        }
+    }
+    drawNode( m_root, true, m_rbService, activeView, culler );
 
     onDraw( renderBackendSrv );
 }
@@ -201,6 +329,121 @@ Common::Ids *Stage::getIdContainer() const {
     return m_ids;
 }
 
+ui32 Stage::buildStaticBatches() {
+    if ( nullptr == m_root ) {
+        return 0;
+    }
+
+    if ( nullptr == m_staticBatcher ) {
+        m_staticBatcher = new StaticBatcher;
+    }
+
+    // The former batch geometries will be destroyed by the build
+    releaseStaticBatchNode();
+    const ui32 numBatches( m_staticBatcher->build( m_root ) );
+    if ( 0 != numBatches ) {
+        m_staticBatchNode = m_staticBatcher->createBatchNode( getName() + ".static_batches", *m_ids, m_root );
+    }
+    m_raycastIndexDirty = true;
+
+    return numBatches;
+}
+
+StaticBatcher *Stage::getStaticBatcher() const {
+    return m_staticBatcher;
+}
+
+void Stage::releaseStaticBatchNode() {
+    if ( nullptr == m_staticBatchNode ) {
+        return;
+    }
+
+    // Attached batches will be detached from the render backend
+    RenderComponent *renderComp( ( RenderComponent* ) m_staticBatchNode->getComponent( Node::ComponentType::RenderComponentType ) );
+    while ( 0 != renderComp->getNumAttachedGeometry() ) {
+        renderComp->removeGeometry( renderComp->getAttachedGeoAt( 0 ) );
+    }
+    while ( 0 != renderComp->getNumGeometry() ) {
+        renderComp->removeGeometry( renderComp->getGeoAt( 0 ) );
+    }
+
+    Node *parent( m_staticBatchNode->getParent() );
+    if ( nullptr != parent ) {
+        parent->removeChild( m_staticBatchNode->getName(), Node::TraverseMode::FlatMode );
+    }
+    m_staticBatchNode->release();
+    m_staticBatchNode = nullptr;
+}
+
+void Stage::setOcclusionCuller( OcclusionCuller *culler ) {
+    m_occlusionCuller = culler;
+}
+
+OcclusionCuller *Stage::getOcclusionCuller() const {
+    return m_occlusionCuller;
+}
+
+void Stage::setNodeUpdateEnabled( bool enabled ) {
+    m_nodeUpdateEnabled = enabled;
+}
+
+bool Stage::isNodeUpdateEnabled() const {
+    return m_nodeUpdateEnabled;
+}
+
+void Stage::setThreadPool( Threading::ThreadPool *threadPool ) {
+    m_threadPool = threadPool;
+}
+
+Threading::ThreadPool *Stage::getThreadPool() const {
+    return m_threadPool;
+}
+
+void Stage::setParallelUpdateThreshold( ui32 numNodes ) {
+    m_parallelUpdateThreshold = numNodes > 0 ? numNodes : 1;
+}
+
+ui32 Stage::getParallelUpdateThreshold() const {
+    return m_parallelUpdateThreshold;
+}
+
+bool Stage::raycast( const Collision::TRay<f32> &ray, RaycastHit &hit, f32 maxDist ) {
+    return getRaycastIndex()->raycast( ray, hit, maxDist );
+}
+
+ui32 Stage::raycastAll( const Collision::TRay<f32> &ray, CPPCore::TArray<RaycastHit> &hits, f32 maxDist ) {
+    return getRaycastIndex()->raycastAll( ray, hits, maxDist );
+}
+
+ui32 Stage::raycastPacket( const Collision::TRay<f32> *rays, ui32 numRays, RaycastHit *hits, f32 maxDist ) {
+    return getRaycastIndex()->raycastPacket( rays, numRays, hits, maxDist );
+}
+
+void Stage::invalidateRaycastIndex() {
+    m_raycastIndexDirty = true;
+}
+
+RaycastIndex *Stage::getRaycastIndex() {
+    if ( nullptr == m_raycastIndex ) {
+        m_raycastIndex = new RaycastIndex;
+    }
+
+    // The triangle BVHs are cached, a rebuild only collects the instances again
+    // The change count is read before the build, changes during the build lead to the next one
+    const ui32 changeCount( Node::getChangeCount() );
+    if ( m_raycastIndexDirty || changeCount != m_raycastChangeCount ) {
+        // Culled batches would miss the triangles of the hidden sub-meshes
+        if ( nullptr != m_staticBatcher ) {
+            m_staticBatcher->resetCulling( m_rbService );
+        }
+        m_raycastIndex->build( m_root );
+        m_raycastIndexDirty = false;
+        m_raycastChangeCount = changeCount;
+    }
+
+    return m_raycastIndex;
+}
+
 void Stage::onUpdate( Time dt ) {
     // empty
 }
@@ -0,0 +1,694 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Scene/StaticBatcher.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/Component.h>
+#include <osre/Scene/OcclusionCuller.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/RenderBackendService.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/IO/Stream.h>
+#include <osre/Common/Logger.h>
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace OSRE {
+namespace Scene {
+
+using namespace ::OSRE::RenderBackend;
+using namespace ::OSRE::Collision;
+using namespace ::CPPCore;
+
+static const String Tag = "StaticBatcher";
+
+// The magic and the version for cooked batch streams
+static const ui32 BatchMagic   = 0x3142534f; // "OSB1"
+static const ui32 BatchVersion = 1;
+
+// The maximum number of primitive groups, i.e. draw calls, per batch after culling
+static const ui32 MaxCullGroups = 8;
+
+StaticBatchRange::StaticBatchRange()
+: m_startIndex( 0 )
+, m_numIndices( 0 )
+, m_baseVertex( 0 )
+, m_numVertices( 0 )
+, m_aabb()
+, m_sourceNode( nullptr )
+, m_sourceGeo( nullptr ) {
+    // empty
+}
+
+StaticBatch::StaticBatch()
+: m_material( nullptr )
+, m_vertexType( VertexType::ColorVertex )
+, m_geo( nullptr )
+, m_ranges()
+, m_aabb() {
+    // empty
+}
+
+StaticBatch::~StaticBatch() {
+    if ( nullptr != m_geo ) {
+        // The material is shared with the source geometry
+        m_geo->m_material = nullptr;
+        Geometry::destroy( &m_geo );
+    }
+}
+
+namespace {
+
+struct PendingMesh {
+    Geometry *m_geo;
+    Node *m_node;
+    glm::mat4 m_world;
+};
+
+using PendingMeshArray = TArray<PendingMesh>;
+
+}
+
+static void collectStaticNodes( Node *node, TArray<Node*> &nodes ) {
+    if ( nullptr == node ) {
+        return;
+    }
+
+    if ( node->isStatic() && nullptr != node->getComponent( Node::ComponentType::RenderComponentType ) ) {
+        nodes.add( node );
+    }
+
+    for ( ui32 i = 0; i < node->getNumChildren(); ++i ) {
+        collectStaticNodes( node->getChildAt( i ), nodes );
+    }
+}
+
+static void collectGeometries( Node *node, TArray<Geometry*> &geos ) {
+    // Geometries, which were drawn already, are attached to the render backend
+    RenderComponent *renderComp( ( RenderComponent* ) node->getComponent( Node::ComponentType::RenderComponentType ) );
+    for ( ui32 i = 0; i < renderComp->getNumGeometry(); ++i ) {
+        geos.add( renderComp->getGeoAt( i ) );
+    }
+    for ( ui32 i = 0; i < renderComp->getNumAttachedGeometry(); ++i ) {
+        geos.add( renderComp->getAttachedGeoAt( i ) );
+    }
+}
+
+static ui32 getIndexSize( IndexType type ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return sizeof( uc8 );
+        case IndexType::UnsignedShort:
+            return sizeof( ui16 );
+        case IndexType::UnsignedInt:
+            return sizeof( ui32 );
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static bool isBatchable( const Geometry *geo ) {
+    if ( nullptr == geo || nullptr == geo->m_material || nullptr == geo->m_vb || nullptr == geo->m_ib ) {
+        return false;
+    }
+
+    if ( VertexType::ColorVertex != geo->m_vertextype && VertexType::RenderVertex != geo->m_vertextype ) {
+        return false;
+    }
+
+    if ( 0 == geo->m_numPrimGroups || nullptr == geo->m_pPrimGroups ) {
+        return false;
+    }
+
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        const PrimitiveGroup &grp( geo->m_pPrimGroups[ i ] );
+        if ( PrimitiveType::TriangleList != grp.m_primitive || 0 == getIndexSize( grp.m_indexType ) ) {
+            return false;
+        }
+        const ui32 end( ( grp.m_startIndex + grp.m_numIndices ) * getIndexSize( grp.m_indexType ) );
+        if ( end > geo->m_ib->m_size ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static ui32 getNumVertices( const Geometry *geo ) {
+    const ui32 vertexSize( Geometry::getVertexSize( geo->m_vertextype ) );
+    if ( 0 == vertexSize ) {
+        return 0;
+    }
+
+    return geo->m_vb->m_size / vertexSize;
+}
+
+static ui32 getNumIndices( const Geometry *geo ) {
+    ui32 numIndices( 0 );
+    for ( ui32 i = 0; i < geo->m_numPrimGroups; ++i ) {
+        numIndices += geo->m_pPrimGroups[ i ].m_numIndices;
+    }
+
+    return numIndices;
+}
+
+// The culled batches draw the visible runs of ranges, one group each. Unused groups are empty.
+static void initPrimGroups( StaticBatch *batch ) {
+    Geometry *geo( batch->m_geo );
+    geo->m_numPrimGroups = std::max<ui32>( 1, std::min( static_cast<ui32>( batch->m_ranges.size() ), MaxCullGroups ) );
+    geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
+    geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, geo->m_ib->m_size / sizeof( ui32 ), PrimitiveType::TriangleList, 0 );
+    for ( ui32 i = 1; i < geo->m_numPrimGroups; ++i ) {
+        geo->m_pPrimGroups[ i ].init( IndexType::UnsignedInt, 0, PrimitiveType::TriangleList, 0 );
+    }
+}
+
+static bool setPrimGroup( PrimitiveGroup &grp, ui32 startIndex, ui32 numIndices ) {
+    if ( startIndex == grp.m_startIndex && numIndices == grp.m_numIndices ) {
+        return false;
+    }
+    grp.m_startIndex = startIndex;
+    grp.m_numIndices = numIndices;
+
+    return true;
+}
+
+// Returns true, when the primitive groups of the batch have been changed
+static bool setVisibleRanges( StaticBatch *batch, const std::vector<bool> &visible ) {
+    Geometry *geo( batch->m_geo );
+    ui32 numGroups( 0 ), startIndex( 0 ), endIndex( 0 );
+    bool changed( false );
+    for ( ui32 i = 0; i < batch->m_ranges.size(); ++i ) {
+        if ( !visible[ i ] ) {
+            continue;
+        }
+
+        // The last group spans over the culled ranges between the remaining runs
+        const StaticBatchRange &range( batch->m_ranges[ i ] );
+        if ( 0 != numGroups && ( range.m_startIndex == endIndex || numGroups == geo->m_numPrimGroups ) ) {
+            endIndex = range.m_startIndex + range.m_numIndices;
+            continue;
+        }
+        if ( 0 != numGroups ) {
+            changed = setPrimGroup( geo->m_pPrimGroups[ numGroups - 1 ], startIndex, endIndex - startIndex ) || changed;
+        }
+        ++numGroups;
+        startIndex = range.m_startIndex;
+        endIndex = range.m_startIndex + range.m_numIndices;
+    }
+    if ( 0 != numGroups ) {
+        changed = setPrimGroup( geo->m_pPrimGroups[ numGroups - 1 ], startIndex, endIndex - startIndex ) || changed;
+    }
+    for ( ui32 i = numGroups; i < geo->m_numPrimGroups; ++i ) {
+        changed = setPrimGroup( geo->m_pPrimGroups[ i ], 0, 0 ) || changed;
+    }
+
+    return changed;
+}
+
+static ui32 readIndex( const uc8 *data, IndexType type, ui32 idx ) {
+    switch ( type ) {
+        case IndexType::UnsignedByte:
+            return data[ idx ];
+        case IndexType::UnsignedShort:
+            return reinterpret_cast<const ui16*>( data )[ idx ];
+        case IndexType::UnsignedInt:
+            return reinterpret_cast<const ui32*>( data )[ idx ];
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+template<class TVertex>
+static void transformVertices( const TVertex *src, ui32 numVertices, const glm::mat4 &world, 
+        TVertex *dst, TAABB<f32> &aabb ) {
+    const glm::mat3 normalMat( glm::inverseTranspose( glm::mat3( world ) ) );
+    for ( ui32 i = 0; i < numVertices; ++i ) {
+        dst[ i ] = src[ i ];
+        const glm::vec4 pos( world * glm::vec4( src[ i ].position, 1.0f ) );
+        dst[ i ].position = glm::vec3( pos );
+        const glm::vec3 n( normalMat * src[ i ].normal );
+        const f32 len( glm::length( n ) );
+        dst[ i ].normal = len > 0.0f ? n / len : n;
+        aabb.merge( pos.x, pos.y, pos.z );
+    }
+}
+
+StaticBatcher::StaticBatcher()
+: m_batches()
+, m_materials()
+, m_numMergedMeshes( 0 ) {
+    // empty
+}
+
+StaticBatcher::~StaticBatcher() {
+    clear();
+}
+
+StaticBatch *StaticBatcher::getBatch( Material *material, VertexType vertexType ) {
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        if ( material == m_batches[ i ]->m_material && vertexType == m_batches[ i ]->m_vertexType ) {
+            return m_batches[ i ];
+        }
+    }
+
+    StaticBatch *batch( new StaticBatch );
+    batch->m_material = material;
+    batch->m_vertexType = vertexType;
+    m_batches.add( batch );
+    m_materials.add( material );
+
+    return batch;
+}
+
+void StaticBatcher::restoreSources() {
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        const StaticBatch *batch( m_batches[ i ] );
+        for ( ui32 j = 0; j < batch->m_ranges.size(); ++j ) {
+            const StaticBatchRange &range( batch->m_ranges[ j ] );
+            if ( nullptr != range.m_sourceNode && nullptr != range.m_sourceGeo ) {
+                range.m_sourceNode->addGeometry( range.m_sourceGeo );
+            }
+        }
+    }
+}
+
+ui32 StaticBatcher::build( Node *root ) {
+    restoreSources();
+    clear();
+    if ( nullptr == root ) {
+        return 0;
+    }
+
+    TArray<Node*> staticNodes;
+    collectStaticNodes( root, staticNodes );
+    if ( staticNodes.isEmpty() ) {
+        return 0;
+    }
+
+    // Group all batchable geometries by their material and vertex type
+    TArray<PendingMeshArray*> pendingMeshes;
+    TArray<Geometry*> geos;
+    for ( ui32 i = 0; i < staticNodes.size(); ++i ) {
+        Node *node( staticNodes[ i ] );
+        glm::mat4 world( 1.0f );
+        TransformComponent *transformComp( ( TransformComponent* ) node->getComponent( Node::ComponentType::TransformComponentType ) );
+        if ( nullptr != transformComp ) {
+            world = transformComp->getWorlTransformMatrix();
+        }
+
+        geos.resize( 0 );
+        collectGeometries( node, geos );
+        for ( ui32 j = 0; j < geos.size(); ++j ) {
+            Geometry *geo( geos[ j ] );
+            if ( !isBatchable( geo ) ) {
+                continue;
+            }
+
+            PendingMesh mesh;
+            mesh.m_geo = geo;
+            mesh.m_node = node;
+            mesh.m_world = geo->m_localMatrix ? world * geo->m_model : world;
+
+            const ui32 numBatches( m_batches.size() );
+            StaticBatch *batch( getBatch( geo->m_material, geo->m_vertextype ) );
+            if ( numBatches != m_batches.size() ) {
+                pendingMeshes.add( new PendingMeshArray );
+            }
+            for ( ui32 k = 0; k < m_batches.size(); ++k ) {
+                if ( batch == m_batches[ k ] ) {
+                    pendingMeshes[ k ]->add( mesh );
+                    break;
+                }
+            }
+        }
+    }
+
+    // Merge the meshes of each batch into one vertex- and one index buffer
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        StaticBatch *batch( m_batches[ i ] );
+        PendingMeshArray &meshes( *pendingMeshes[ i ] );
+        const VertexType vertexType( batch->m_vertexType );
+        const ui32 vertexSize( Geometry::getVertexSize( vertexType ) );
+
+        ui32 numVertices( 0 ), numIndices( 0 );
+        for ( ui32 j = 0; j < meshes.size(); ++j ) {
+            numVertices += getNumVertices( meshes[ j ].m_geo );
+            numIndices += getNumIndices( meshes[ j ].m_geo );
+        }
+
+        Geometry *batchGeo( Geometry::create( 1 ) );
+        batchGeo->m_vertextype = vertexType;
+        batchGeo->m_indextype = IndexType::UnsignedInt;
+        batchGeo->m_material = batch->m_material;
+        batchGeo->m_vb = BufferData::alloc( BufferType::VertexBuffer, numVertices * vertexSize, BufferAccessType::ReadOnly );
+        batchGeo->m_ib = BufferData::alloc( BufferType::IndexBuffer, numIndices * sizeof( ui32 ), BufferAccessType::ReadOnly );
+
+        uc8 *vertices( static_cast<uc8*>( batchGeo->m_vb->m_data ) );
+        ui32 *indices( static_cast<ui32*>( batchGeo->m_ib->m_data ) );
+        ui32 baseVertex( 0 ), startIndex( 0 );
+        for ( ui32 j = 0; j < meshes.size(); ++j ) {
+            const PendingMesh &mesh( meshes[ j ] );
+            const Geometry *geo( mesh.m_geo );
+
+            StaticBatchRange range;
+            range.m_baseVertex = baseVertex;
+            range.m_startIndex = startIndex;
+            range.m_numVertices = getNumVertices( geo );
+            range.m_sourceNode = mesh.m_node;
+            range.m_sourceNode->get();
+            range.m_sourceGeo = mesh.m_geo;
+
+            if ( VertexType::RenderVertex == vertexType ) {
+                transformVertices( static_cast<const RenderVert*>( geo->m_vb->m_data ), range.m_numVertices, mesh.m_world,
+                    reinterpret_cast<RenderVert*>( &vertices[ baseVertex * vertexSize ] ), range.m_aabb );
+            } else {
+                transformVertices( static_cast<const ColorVert*>( geo->m_vb->m_data ), range.m_numVertices, mesh.m_world,
+                    reinterpret_cast<ColorVert*>( &vertices[ baseVertex * vertexSize ] ), range.m_aabb );
+            }
+
+            const uc8 *srcIndices( static_cast<const uc8*>( geo->m_ib->m_data ) );
+            for ( ui32 k = 0; k < geo->m_numPrimGroups; ++k ) {
+                const PrimitiveGroup &grp( geo->m_pPrimGroups[ k ] );
+                for ( ui32 idx = 0; idx < grp.m_numIndices; ++idx ) {
+                    indices[ startIndex + range.m_numIndices ] = baseVertex + readIndex( srcIndices, grp.m_indexType, grp.m_startIndex + idx );
+                    ++range.m_numIndices;
+                }
+            }
+
+            baseVertex += range.m_numVertices;
+            startIndex += range.m_numIndices;
+            batch->m_aabb.merge( range.m_aabb.getMin() );
+            batch->m_aabb.merge( range.m_aabb.getMax() );
+            batch->m_ranges.add( range );
+
+            // The merged geometry replaces the source geometry
+            RenderComponent *renderComp( ( RenderComponent* ) mesh.m_node->getComponent( Node::ComponentType::RenderComponentType ) );
+            renderComp->removeGeometry( mesh.m_geo );
+            ++m_numMergedMeshes;
+        }
+
+        batch->m_geo = batchGeo;
+        initPrimGroups( batch );
+
+        delete pendingMeshes[ i ];
+    }
+
+    osre_debug( Tag, "Merged " + std::to_string( m_numMergedMeshes ) + " meshes into " + std::to_string( m_batches.size() ) + " batches." );
+
+    return m_batches.size();
+}
+
+Node *StaticBatcher::createBatchNode( const String &name, Common::Ids &ids, Node *parent ) {
+    if ( m_batches.isEmpty() ) {
+        return nullptr;
+    }
+
+    Node *batchNode( new Node( name, ids, Node::RenderCompRequest::RenderCompRequested,
+            Node::TransformCompRequest::TransformCompRequested, parent ) );
+    batchNode->setStatic( true );
+    Node::AABB aabb;
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        batchNode->addGeometry( m_batches[ i ]->m_geo );
+        aabb.merge( m_batches[ i ]->m_aabb.getMin() );
+        aabb.merge( m_batches[ i ]->m_aabb.getMax() );
+    }
+    batchNode->setAABB( aabb );
+
+    return batchNode;
+}
+
+ui32 StaticBatcher::getNumBatches() const {
+    return m_batches.size();
+}
+
+const StaticBatch *StaticBatcher::getBatchAt( ui32 idx ) const {
+    if ( idx >= m_batches.size() ) {
+        return nullptr;
+    }
+
+    return m_batches[ idx ];
+}
+
+ui32 StaticBatcher::getNumMergedMeshes() const {
+    return m_numMergedMeshes;
+}
+
+// The ranges of a batch follow each other and cover all indices, every index refers to a vertex 
+// of its own range
+static bool hasValidRanges( const StaticBatch *batch, ui32 numVertices, const ui32 *indices, ui32 numIndices ) {
+    ui32 startIndex( 0 ), baseVertex( 0 );
+    for ( ui32 i = 0; i < batch->m_ranges.size(); ++i ) {
+        const StaticBatchRange &range( batch->m_ranges[ i ] );
+        if ( startIndex != range.m_startIndex || range.m_numIndices > numIndices - startIndex ) {
+            return false;
+        }
+        if ( baseVertex != range.m_baseVertex || range.m_numVertices > numVertices - baseVertex ) {
+            return false;
+        }
+        for ( ui32 j = 0; j < range.m_numIndices; ++j ) {
+            const ui32 idx( indices[ startIndex + j ] );
+            if ( idx < baseVertex || idx - baseVertex >= range.m_numVertices ) {
+                return false;
+            }
+        }
+        startIndex += range.m_numIndices;
+        baseVertex += range.m_numVertices;
+    }
+
+    return numIndices == startIndex && numVertices == baseVertex;
+}
+
+static void writeAABB( IO::Stream &stream, const TAABB<f32> &aabb ) {
+    stream.write( aabb.getMin().v, sizeof( f32 ) * 3 );
+    stream.write( aabb.getMax().v, sizeof( f32 ) * 3 );
+}
+
+static bool readUI32( IO::Stream &stream, ui32 &value ) {
+    return sizeof( ui32 ) == stream.readUI32( value );
+}
+
+static bool readAABB( IO::Stream &stream, TAABB<f32> &aabb ) {
+    Vec3f min, max;
+    if ( sizeof( f32 ) * 3 != stream.read( min.v, sizeof( f32 ) * 3 ) ) {
+        return false;
+    }
+    if ( sizeof( f32 ) * 3 != stream.read( max.v, sizeof( f32 ) * 3 ) ) {
+        return false;
+    }
+    aabb.set( min, max );
+
+    return true;
+}
+
+bool StaticBatcher::save( IO::Stream &stream ) const {
+    if ( !stream.isOpen() || !stream.canWrite() ) {
+        osre_error( Tag, "Cannot write batches, stream is not writable." );
+        return false;
+    }
+
+    stream.writeUI32( BatchMagic );
+    stream.writeUI32( BatchVersion );
+    stream.writeUI32( m_batches.size() );
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        const StaticBatch *batch( m_batches[ i ] );
+        const Geometry *geo( batch->m_geo );
+        stream.writeUI32( i );
+        stream.writeUI32( static_cast<ui32>( geo->m_vertextype ) );
+        stream.writeUI32( geo->m_vb->m_size );
+        stream.writeUI32( geo->m_ib->m_size );
+        stream.writeUI32( batch->m_ranges.size() );
+        writeAABB( stream, batch->m_aabb );
+        for ( ui32 j = 0; j < batch->m_ranges.size(); ++j ) {
+            const StaticBatchRange &range( batch->m_ranges[ j ] );
+            stream.writeUI32( range.m_startIndex );
+            stream.writeUI32( range.m_numIndices );
+            stream.writeUI32( range.m_baseVertex );
+            stream.writeUI32( range.m_numVertices );
+            writeAABB( stream, range.m_aabb );
+        }
+        stream.write( geo->m_vb->m_data, geo->m_vb->m_size );
+        stream.write( geo->m_ib->m_data, geo->m_ib->m_size );
+    }
+
+    return true;
+}
+
+bool StaticBatcher::load( IO::Stream &stream, const MaterialArray &materials ) {
+    clear();
+    if ( !stream.isOpen() || !stream.canRead() ) {
+        osre_error( Tag, "Cannot read batches, stream is not readable." );
+        return false;
+    }
+
+    ui32 magic( 0 ), version( 0 ), numBatches( 0 );
+    if ( !readUI32( stream, magic ) || !readUI32( stream, version ) || BatchMagic != magic || BatchVersion != version ) {
+        osre_error( Tag, "Invalid or outdated batch stream." );
+        return false;
+    }
+
+    if ( !readUI32( stream, numBatches ) ) {
+        osre_error( Tag, "Batch stream is truncated." );
+        return false;
+    }
+    for ( ui32 i = 0; i < numBatches; ++i ) {
+        ui32 matIdx( 0 ), vertexType( 0 ), vbSize( 0 ), ibSize( 0 ), numRanges( 0 );
+        bool ok( readUI32( stream, matIdx ) && readUI32( stream, vertexType ) && readUI32( stream, vbSize ) 
+                && readUI32( stream, ibSize ) && readUI32( stream, numRanges ) );
+        if ( !ok ) {
+            osre_error( Tag, "Batch stream is truncated." );
+            clear();
+            return false;
+        }
+        if ( matIdx >= materials.size() ) {
+            osre_error( Tag, "Invalid material index in batch stream." );
+            clear();
+            return false;
+        }
+        if ( static_cast<ui32>( VertexType::ColorVertex ) != vertexType && static_cast<ui32>( VertexType::RenderVertex ) != vertexType ) {
+            osre_error( Tag, "Invalid vertex type in batch stream." );
+            clear();
+            return false;
+        }
+
+        // Reject sizes the stream cannot hold before the buffers get allocated
+        if ( vbSize > stream.getSize() || ibSize > stream.getSize() || 0 != ibSize % sizeof( ui32 ) 
+                || 0 != vbSize % Geometry::getVertexSize( static_cast<VertexType>( vertexType ) ) ) {
+            osre_error( Tag, "Invalid buffer size in batch stream." );
+            clear();
+            return false;
+        }
+
+        StaticBatch *batch( new StaticBatch );
+        batch->m_material = materials[ matIdx ];
+        batch->m_vertexType = static_cast<VertexType>( vertexType );
+        m_batches.add( batch );
+        m_materials.add( batch->m_material );
+        ok = readAABB( stream, batch->m_aabb );
+        for ( ui32 j = 0; ok && j < numRanges; ++j ) {
+            StaticBatchRange range;
+            ok = readUI32( stream, range.m_startIndex ) && readUI32( stream, range.m_numIndices ) 
+                    && readUI32( stream, range.m_baseVertex ) && readUI32( stream, range.m_numVertices ) 
+                    && readAABB( stream, range.m_aabb );
+            batch->m_ranges.add( range );
+        }
+        if ( !ok ) {
+            osre_error( Tag, "Batch stream is truncated." );
+            clear();
+            return false;
+        }
+
+        BufferData *vb( BufferData::alloc( BufferType::VertexBuffer, vbSize, BufferAccessType::ReadOnly ) );
+        BufferData *ib( BufferData::alloc( BufferType::IndexBuffer, ibSize, BufferAccessType::ReadOnly ) );
+        ok = ( vbSize == stream.read( vb->m_data, vbSize ) );
+        ok = ok && ( ibSize == stream.read( ib->m_data, ibSize ) );
+        if ( !ok ) {
+            osre_error( Tag, "Batch stream is truncated." );
+            BufferData::free( vb );
+            BufferData::free( ib );
+            clear();
+            return false;
+        }
+        if ( !hasValidRanges( batch, vbSize / Geometry::getVertexSize( batch->m_vertexType ), 
+                static_cast<const ui32*>( ib->m_data ), ibSize / sizeof( ui32 ) ) ) {
+            osre_error( Tag, "Invalid index range in batch stream." );
+            BufferData::free( vb );
+            BufferData::free( ib );
+            clear();
+            return false;
+        }
+
+        Geometry *geo( Geometry::create( 1 ) );
+        batch->m_geo = geo;
+        geo->m_vertextype = batch->m_vertexType;
+        geo->m_indextype = IndexType::UnsignedInt;
+        geo->m_material = batch->m_material;
+        geo->m_vb = vb;
+        geo->m_ib = ib;
+        initPrimGroups( batch );
+        m_numMergedMeshes += numRanges;
+    }
+
+    return true;
+}
+
+const StaticBatcher::MaterialArray &StaticBatcher::getMaterials() const {
+    return m_materials;
+}
+
+ui32 StaticBatcher::cull( const OcclusionCuller &culler, RenderBackendService *rbService ) {
+    // The ranges are stored in world space
+    static const glm::mat4 Identity( 1.0f );
+    ui32 numCulled( 0 );
+    std::vector<bool> visible;
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        StaticBatch *batch( m_batches[ i ] );
+        visible.assign( batch->m_ranges.size(), true );
+        for ( ui32 j = 0; j < batch->m_ranges.size(); ++j ) {
+            visible[ j ] = culler.isVisible( batch->m_ranges[ j ].m_aabb, Identity );
+            if ( !visible[ j ] ) {
+                ++numCulled;
+            }
+        }
+        if ( setVisibleRanges( batch, visible ) && nullptr != rbService ) {
+            rbService->attachPrimGroupUpdate( batch->m_geo );
+        }
+    }
+
+    return numCulled;
+}
+
+void StaticBatcher::resetCulling( RenderBackendService *rbService ) {
+    std::vector<bool> visible;
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        StaticBatch *batch( m_batches[ i ] );
+        visible.assign( batch->m_ranges.size(), true );
+        if ( setVisibleRanges( batch, visible ) && nullptr != rbService ) {
+            rbService->attachPrimGroupUpdate( batch->m_geo );
+        }
+    }
+}
+
+void StaticBatcher::clear() {
+    for ( ui32 i = 0; i < m_batches.size(); ++i ) {
+        const StaticBatch *batch( m_batches[ i ] );
+        for ( ui32 j = 0; j < batch->m_ranges.size(); ++j ) {
+            if ( nullptr != batch->m_ranges[ j ].m_sourceNode ) {
+                batch->m_ranges[ j ].m_sourceNode->release();
+            }
+        }
+        delete m_batches[ i ];
+    }
+    m_batches.clear();
+    m_materials.clear();
+    m_numMergedMeshes = 0;
+}
+
+} // Namespace Scene
+} // namespace OSRE
@@ -0,0 +1,195 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Threading/ThreadPool.h>
+
+namespace OSRE {
+namespace Threading {
+
+// The jobs the current thread executes, the innermost one at the back. A thread waiting inside 
+// of a pool blocks all jobs of the pool, which are not blocked by an outer wait already.
+struct RunningJob {
+    const ThreadPool *m_pool;
+    bool m_blocked;
+};
+static thread_local std::vector<RunningJob> s_runningJobs;
+
+ThreadPool::ThreadPool( i32 numThreads )
+: m_workers()
+, m_jobs()
+, m_mutex()
+, m_jobCondition()
+, m_doneCondition()
+, m_numActiveJobs( 0 )
+, m_numBlockedJobs( 0 )
+, m_shutdown( false ) {
+    if ( numThreads < 0 ) {
+        const i32 numCores( static_cast<i32>( std::thread::hardware_concurrency() ) );
+        numThreads = numCores > 1 ? numCores - 1 : 0;
+    }
+
+    for ( i32 i = 0; i < numThreads; ++i ) {
+        m_workers.push_back( std::thread( &ThreadPool::workerMain, this ) );
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    waitForAll();
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_shutdown = true;
+    }
+    m_jobCondition.notify_all();
+    for ( std::thread &worker : m_workers ) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue( const Job &job ) {
+    if ( m_workers.empty() ) {
+        job();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_jobs.push_back( job );
+    }
+    m_jobCondition.notify_one();
+
+    // Waiting threads help with new jobs
+    m_doneCondition.notify_all();
+}
+
+void ThreadPool::waitForAll() {
+    waitUntil( [ this ] { return m_jobs.empty() && m_numActiveJobs == m_numBlockedJobs; } );
+}
+
+void ThreadPool::parallelFor( ui32 count, ui32 grainSize, const RangeJob &job ) {
+    if ( 0 == count ) {
+        return;
+    }
+
+    if ( 0 == grainSize ) {
+        grainSize = 1;
+    }
+
+    if ( m_workers.empty() || count <= grainSize ) {
+        job( 0, count );
+        return;
+    }
+
+    // Use some more chunks than threads to balance uneven work
+    const ui32 maxChunks( ( getNumThreads() + 1 ) * 4 );
+    ui32 chunkSize( ( count + maxChunks - 1 ) / maxChunks );
+    if ( chunkSize < grainSize ) {
+        chunkSize = grainSize;
+    }
+    const ui32 numChunks( ( count + chunkSize - 1 ) / chunkSize );
+
+    // Guarded by the pool mutex
+    ui32 remaining( numChunks - 1 );
+    for ( ui32 i = 1; i < numChunks; ++i ) {
+        const ui32 begin( i * chunkSize );
+        const ui32 end( begin + chunkSize < count ? begin + chunkSize : count );
+        enqueue( [ this, &job, &remaining, begin, end ] {
+            job( begin, end );
+            std::unique_lock<std::mutex> lock( m_mutex );
+            --remaining;
+        } );
+    }
+
+    // The calling thread works on the first chunk and helps with the others afterwards
+    job( 0, chunkSize < count ? chunkSize : count );
+    waitUntil( [ &remaining ] { return 0 == remaining; } );
+}
+
+void ThreadPool::waitUntil( const std::function<bool()> &isDone ) {
+    std::vector<size_t> blockedJobs;
+    for ( size_t i = 0; i < s_runningJobs.size(); ++i ) {
+        if ( this == s_runningJobs[ i ].m_pool && !s_runningJobs[ i ].m_blocked ) {
+            s_runningJobs[ i ].m_blocked = true;
+            blockedJobs.push_back( i );
+        }
+    }
+
+    const ui32 numBlocked( static_cast<ui32>( blockedJobs.size() ) );
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if ( 0 != numBlocked ) {
+        m_numBlockedJobs += numBlocked;
+        m_doneCondition.notify_all();
+    }
+
+    while ( !isDone() ) {
+        if ( m_jobs.empty() ) {
+            m_doneCondition.wait( lock );
+            continue;
+        }
+
+        const Job job( m_jobs.front() );
+        m_jobs.pop_front();
+        ++m_numActiveJobs;
+        lock.unlock();
+        runJob( job );
+        lock.lock();
+    }
+    m_numBlockedJobs -= numBlocked;
+    lock.unlock();
+
+    for ( size_t i : blockedJobs ) {
+        s_runningJobs[ i ].m_blocked = false;
+    }
+}
+
+void ThreadPool::runJob( const Job &job ) {
+    const RunningJob runningJob = { this, false };
+    s_runningJobs.push_back( runningJob );
+    job();
+    s_runningJobs.pop_back();
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        --m_numActiveJobs;
+    }
+    m_doneCondition.notify_all();
+}
+
+void ThreadPool::workerMain() {
+    for ( ;; ) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_jobCondition.wait( lock, [ this ] { return m_shutdown || !m_jobs.empty(); } );
+            if ( m_jobs.empty() ) {
+                return;
+            }
+            job = m_jobs.front();
+            m_jobs.pop_front();
+            ++m_numActiveJobs;
+        }
+
+        runJob( job );
+    }
+}
+
+} // Namespace Threading
+} // Namespace OSRE
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <osre/Assets/AssetCooker.h>
+#include <osre/Assets/AssetRegistry.h>
+#include <osre/Assets/DerivedDataCache.h>
+#include <osre/Common/ArgumentParser.h>
+#include <osre/Common/Logger.h>
+#include <osre/IO/IOService.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace ::OSRE;
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::Common;
+
+// To identify local log entries 
+static const String Tag = "osre_cook";
+
+static const String SupportedArgs = "help:src:cache:manifest:threads:force";
+static const String Descs = "Shows the help:The source tree to cook:The derived data cache directory, "
+        "without one cooked files are written next to their sources:The manifest file, default is "
+        "osre_cook.manifest in the source tree:The number of worker threads:1 cooks all assets again";
+
+/// Cooks the models and textures of a source tree into their runtime formats, without any window 
+/// or render context. Only assets whose sources changed since the last run are cooked again.
+int main( int argc, char *argv[] ) {
+    ArgumentParser argParser( argc, argv, SupportedArgs, Descs );
+    if ( !argParser.hasValidArgs() || argParser.hasArgument( "help" ) || !argParser.hasArgument( "src" ) ) {
+        std::cout << "osre_cook --src <dir> [--cache <dir>] [--manifest <file>] [--threads <num>] [--force 1]\n";
+        std::cout << argParser.showHelp() << std::endl;
+        return 1;
+    }
+
+    const String src( argParser.getArgument( "src" ) );
+    const String manifest( argParser.hasArgument( "manifest" ) ? argParser.getArgument( "manifest" ) : src + "/osre_cook.manifest" );
+    const i32 numThreads( argParser.hasArgument( "threads" ) ? ::atoi( argParser.getArgument( "threads" ).c_str() ) : -1 );
+
+    IO::IOService *ioSrv( IO::IOService::create() );
+    ioSrv->open();
+    AssetRegistry::create();
+
+    DerivedDataCache cache;
+    if ( argParser.hasArgument( "cache" ) ) {
+        if ( !cache.open( argParser.getArgument( "cache" ) ) ) {
+            osre_error( Tag, "Cannot open the derived data cache " + argParser.getArgument( "cache" ) );
+            return 1;
+        }
+        AssetRegistry::setDerivedDataCache( &cache );
+    }
+
+    bool ok( false );
+    {
+        Threading::ThreadPool threadPool( numThreads );
+        AssetCooker cooker;
+        cooker.setThreadPool( &threadPool );
+        cooker.setForceRebuild( "1" == argParser.getArgument( "force" ) );
+        if ( cooker.loadManifest( manifest ) ) {
+            ok = cooker.cookDirectory( src );
+            ok = cooker.saveManifest( manifest ) && ok;
+        }
+    }
+
+    AssetRegistry::setDerivedDataCache( nullptr );
+    cache.close();
+    AssetRegistry::destroy();
+    ioSrv->close();
+    delete ioSrv;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/AssetCooker.h>
+#include <osre/Assets/CookedModel.h>
+#include <osre/Assets/CookedTexture.h>
+#include <osre/IO/Directory.h>
+#include <osre/IO/IOService.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+
+class AssetCookerTest : public ::testing::Test {
+protected:
+    IO::IOService *m_ioSrv;
+    String m_directory;
+    String m_texture;
+    String m_manifest;
+
+    virtual void SetUp() {
+        m_ioSrv = IO::IOService::create();
+        m_ioSrv->open();
+        m_directory = "asset_cooker_test";
+        m_texture = m_directory + "/texture.tga";
+        m_manifest = m_directory + ".manifest";
+        IO::Directory::create( m_directory );
+        writeTexture( 4, 4 );
+    }
+
+    virtual void TearDown() {
+        ::remove( CookedTexture::getCookedName( m_texture ).c_str() );
+        ::remove( m_texture.c_str() );
+        ::remove( m_manifest.c_str() );
+        ::rmdir( m_directory.c_str() );
+        m_ioSrv->close();
+        delete m_ioSrv;
+    }
+
+    // Writes an uncompressed true color TGA
+    void writeTexture( ui32 width, ui32 height ) {
+        uc8 header[ 18 ] = { 0 };
+        header[ 2 ] = 2;
+        header[ 12 ] = static_cast<uc8>( width );
+        header[ 14 ] = static_cast<uc8>( height );
+        header[ 16 ] = 32;
+        FILE *file( ::fopen( m_texture.c_str(), "wb" ) );
+        ::fwrite( header, 1, sizeof( header ), file );
+        for ( ui32 i = 0; i < width * height; ++i ) {
+            const uc8 texel[ 4 ] = { static_cast<uc8>( i * 16 ), 128, 64, 255 };
+            ::fwrite( texel, 1, sizeof( texel ), file );
+        }
+        ::fclose( file );
+    }
+};
+
+TEST_F( AssetCookerTest, getAssetTypeTest ) {
+    EXPECT_EQ( AssetCooker::AssetType::Texture, AssetCooker::getAssetType( "test.png" ) );
+    EXPECT_EQ( AssetCooker::AssetType::Texture, AssetCooker::getAssetType( "test.TGA" ) );
+    EXPECT_EQ( AssetCooker::AssetType::Model, AssetCooker::getAssetType( "test.obj" ) );
+    EXPECT_EQ( AssetCooker::AssetType::Unknown, AssetCooker::getAssetType( CookedModel::getCookedName( "test.obj" ) ) );
+    EXPECT_EQ( AssetCooker::AssetType::Unknown, AssetCooker::getAssetType( CookedTexture::getCookedName( "test.png" ) ) );
+    EXPECT_EQ( AssetCooker::AssetType::Unknown, AssetCooker::getAssetType( "test" ) );
+}
+
+TEST_F( AssetCookerTest, incrementalCookTest ) {
+    {
+        AssetCooker cooker;
+        EXPECT_TRUE( cooker.loadManifest( m_manifest ) );
+        EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+        EXPECT_EQ( 1u, cooker.getStatistics().m_numCooked );
+        EXPECT_TRUE( cooker.saveManifest( m_manifest ) );
+    }
+
+    CookedTexture cooked;
+    ASSERT_TRUE( cooked.open( CookedTexture::getCookedName( m_texture ) ) );
+    cooked.close();
+
+    // The manifest of the former run knows the texture is up to date
+    AssetCooker cooker;
+    EXPECT_TRUE( cooker.loadManifest( m_manifest ) );
+    EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+    EXPECT_EQ( 0u, cooker.getStatistics().m_numCooked );
+    EXPECT_EQ( 1u, cooker.getStatistics().m_numUpToDate );
+
+    writeTexture( 8, 8 );
+    EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+    EXPECT_EQ( 1u, cooker.getStatistics().m_numCooked );
+
+    cooker.setForceRebuild( true );
+    EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+    EXPECT_EQ( 1u, cooker.getStatistics().m_numCooked );
+
+    // A deleted output is cooked again
+    cooker.setForceRebuild( false );
+    ::remove( CookedTexture::getCookedName( m_texture ).c_str() );
+    EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+    EXPECT_EQ( 1u, cooker.getStatistics().m_numCooked );
+}
+
+// Reads the whole content of a text file
+static String readText( const String &filename ) {
+    std::ifstream file( filename.c_str() );
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST_F( AssetCookerTest, manifestSettingsWithSpacesTest ) {
+    const String manifest( "manifest 2\n"
+                           "asset asset_cooker_test/my texture.tga\n"
+                           "settings flip y;mips 4\n"
+                           "output asset_cooker_test/my texture.osre_tex\n"
+                           "dep 12 34 asset_cooker_test/my texture.tga\n" );
+    {
+        std::ofstream file( m_manifest.c_str() );
+        file << manifest;
+    }
+
+    AssetCooker cooker;
+    EXPECT_TRUE( cooker.loadManifest( m_manifest ) );
+    EXPECT_TRUE( cooker.saveManifest( m_manifest ) );
+    EXPECT_EQ( manifest, readText( m_manifest ) );
+}
+
+TEST_F( AssetCookerTest, outdatedManifestTest ) {
+    {
+        std::ofstream file( m_manifest.c_str() );
+        file << "asset 0;010 " << m_texture << "\n";
+    }
+
+    AssetCooker cooker;
+    EXPECT_TRUE( cooker.loadManifest( m_manifest ) );
+    EXPECT_TRUE( cooker.cookDirectory( m_directory ) );
+    EXPECT_EQ( 1u, cooker.getStatistics().m_numCooked );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -22,8 +22,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include <gtest/gtest.h>
 #include <osre/Assets/AssetRegistry.h>
+#include <osre/IO/Directory.h>
+#include <osre/IO/FileMetadataCache.h>
+#include <osre/IO/IOService.h>
 #include <osre/IO/Uri.h>
 
+#ifdef OSRE_WINDOWS
+#   include <direct.h>
+#else
+#   include <unistd.h>
+#endif
+
 namespace OSRE {
 namespace UnitTest {
 
@@ -71,5 +80,43 @@ TEST_F( AssetRegistryTest, resolve_uri_from_mount_Test ) {
     EXPECT_EQ( expRes, loc );
 }
 
+TEST_F( AssetRegistryTest, resolve_uri_memoized_Test ) {
+    IO::Uri fileUri( "file://assets/Textures/stone.png" );
+    const String &loc1 = AssetRegistry::resolvePathFromUri( fileUri );
+    const String &loc2 = AssetRegistry::resolvePathFromUri( IO::Uri( "file://assets/Textures/stone.png" ) );
+    EXPECT_EQ( &loc1, &loc2 );
+
+    // Other paths do not move the memoized ones
+    for ( ui32 i = 0; i < 3000; ++i ) {
+        AssetRegistry::resolvePathFromUri( IO::Uri( "file://assets/tex" + std::to_string( i ) + ".png" ) );
+    }
+    EXPECT_EQ( &loc1, &AssetRegistry::resolvePathFromUri( fileUri ) );
+    EXPECT_EQ( "Textures/stone.png", loc1.substr( loc1.size() - 18 ) );
+
+    // A new mount point invalidates the resolved paths
+    AssetRegistry::registerAssetPath( "textures", "/data/tex/" );
+    EXPECT_EQ( "/data/tex/stone.png", AssetRegistry::resolvePathFromUri( IO::Uri( "file://textures/stone.png" ) ) );
+    EXPECT_EQ( "unknown/stone.png", AssetRegistry::resolvePathFromUri( IO::Uri( "file://unknown/stone.png" ) ) );
+}
+
+TEST_F( AssetRegistryTest, register_path_adds_metadata_root_Test ) {
+    IO::IOService *ioSrv( IO::IOService::create() );
+    IO::Directory::create( "asset_registry_test" );
+    EXPECT_EQ( IO::FileMetadataCache::Lookup::NotCovered, ioSrv->getMetadataCache().stat( "asset_registry_test/new.txt" ) );
+
+    // Lookups below a mount point are answered by the metadata cache, once it was scanned
+    EXPECT_TRUE( AssetRegistry::registerAssetPath( "registry", "asset_registry_test" ) );
+    ioSrv->getMetadataCache().waitForScans();
+    EXPECT_EQ( IO::FileMetadataCache::Lookup::Found, ioSrv->getMetadataCache().stat( "asset_registry_test" ) );
+    EXPECT_EQ( IO::FileMetadataCache::Lookup::Missing, ioSrv->getMetadataCache().stat( "asset_registry_test/new.txt" ) );
+
+#ifdef OSRE_WINDOWS
+    ::_rmdir( "asset_registry_test" );
+#else
+    ::rmdir( "asset_registry_test" );
+#endif
+    delete ioSrv;
+}
+
 }
 }
@@ -0,0 +1,291 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/AssetStreamingService.h>
+#include <osre/Assets/ModelStreamHandler.h>
+#include <osre/Assets/TextureStreamHandler.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/IO/IOService.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+
+class AssetStreamingServiceTest : public ::testing::Test {
+protected:
+    IO::IOService *m_ioSrv;
+    Threading::ThreadPool *m_threadPool;
+    AssetStreamingService *m_service;
+    std::vector<String> m_files;
+
+    virtual void SetUp() {
+        m_ioSrv = IO::IOService::create();
+        m_ioSrv->open();
+
+        // No workers, all jobs run inline and the test is deterministic
+        m_threadPool = new Threading::ThreadPool( 0 );
+        m_service = new AssetStreamingService( m_threadPool );
+        m_service->open();
+    }
+
+    virtual void TearDown() {
+        m_service->close();
+        delete m_service;
+        delete m_threadPool;
+        m_ioSrv->close();
+        delete m_ioSrv;
+        for ( const String &file : m_files ) {
+            ::remove( file.c_str() );
+        }
+    }
+
+    IO::Uri createFile( const String &name, const String &content ) {
+        const String filename( "asset_streaming_test_" + name );
+        FILE *file( ::fopen( filename.c_str(), "wb" ) );
+        ::fwrite( content.c_str(), 1, content.size(), file );
+        ::fclose( file );
+        m_files.push_back( filename );
+
+        return IO::Uri( "file://" + filename );
+    }
+};
+
+TEST_F( AssetStreamingServiceTest, loadRawDataTest ) {
+    String content;
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    const AssetStreamingService::Handle handle( m_service->request( createFile( "raw", "hello" ), 1.0f, 
+            [ &content, &state ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload *payload ) {
+        state = s;
+        RawStreamPayload *raw( static_cast<RawStreamPayload*>( payload ) );
+        content.assign( raw->m_data.begin(), raw->m_data.end() );
+    } ) );
+    EXPECT_NE( AssetStreamingService::InvalidHandle, handle );
+    EXPECT_EQ( AssetStreamingService::State::Queued, m_service->getState( handle ) );
+
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Done, state );
+    EXPECT_EQ( "hello", content );
+    EXPECT_EQ( 0u, m_service->getNumPending() );
+    EXPECT_EQ( AssetStreamingService::State::Invalid, m_service->getState( handle ) );
+}
+
+TEST_F( AssetStreamingServiceTest, priorityOrderTest ) {
+    AssetStreamingService::Budget budget;
+    budget.m_readBytes = 1;
+    budget.m_uploadBytes = 1;
+    m_service->setBudget( budget );
+
+    std::vector<f32> order;
+    const f32 priorities[ 3 ] = { 1.0f, 5.0f, 3.0f };
+    for ( ui32 i = 0; i < 3; ++i ) {
+        const f32 priority( priorities[ i ] );
+        m_service->request( createFile( std::to_string( i ), "data" ), priority, 
+                [ &order, priority ]( AssetStreamingService::Handle, AssetStreamingService::State, StreamPayload* ) {
+            order.push_back( priority );
+        } );
+    }
+
+    for ( ui32 i = 0; i < 3; ++i ) {
+        m_service->update();
+        EXPECT_EQ( i + 1, order.size() );
+    }
+    ASSERT_EQ( 3u, order.size() );
+    EXPECT_EQ( 5.0f, order[ 0 ] );
+    EXPECT_EQ( 3.0f, order[ 1 ] );
+    EXPECT_EQ( 1.0f, order[ 2 ] );
+}
+
+TEST_F( AssetStreamingServiceTest, prioritizerTest ) {
+    AssetStreamingService::Budget budget;
+    budget.m_readBytes = 1;
+    m_service->setBudget( budget );
+
+    const IO::Uri near( createFile( "near", "near" ) ), far( createFile( "far", "far" ) );
+    std::vector<String> order;
+    m_service->request( far, 10.0f, [ &order ]( AssetStreamingService::Handle, AssetStreamingService::State, StreamPayload* ) {
+        order.push_back( "far" );
+    } );
+    m_service->request( near, 1.0f, [ &order ]( AssetStreamingService::Handle, AssetStreamingService::State, StreamPayload* ) {
+        order.push_back( "near" );
+    } );
+    m_service->setPrioritizer( [ &near ]( AssetStreamingService::Handle, const IO::Uri &uri, f32 ) {
+        return uri.getResource() == near.getResource() ? 100.0f : 0.0f;
+    } );
+
+    m_service->update();
+    m_service->update();
+    ASSERT_EQ( 2u, order.size() );
+    EXPECT_EQ( "near", order[ 0 ] );
+    EXPECT_EQ( "far", order[ 1 ] );
+}
+
+TEST_F( AssetStreamingServiceTest, cancelTest ) {
+    bool called( false );
+    const AssetStreamingService::Handle handle( m_service->request( createFile( "cancel", "data" ), 1.0f, 
+            [ &called ]( AssetStreamingService::Handle, AssetStreamingService::State, StreamPayload* ) {
+        called = true;
+    } ) );
+    EXPECT_TRUE( m_service->cancel( handle ) );
+    EXPECT_EQ( AssetStreamingService::State::Cancelled, m_service->getState( handle ) );
+
+    m_service->update();
+    m_service->update();
+    EXPECT_FALSE( called );
+    EXPECT_EQ( 0u, m_service->getNumPending() );
+    EXPECT_FALSE( m_service->cancel( handle ) );
+}
+
+TEST_F( AssetStreamingServiceTest, missingFileTest ) {
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    bool hasPayload( true );
+    m_service->request( IO::Uri( "file://asset_streaming_test_missing" ), 1.0f, 
+            [ &state, &hasPayload ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload *payload ) {
+        state = s;
+        hasPayload = nullptr != payload;
+    } );
+
+    m_service->update();
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Failed, state );
+    EXPECT_FALSE( hasPayload );
+}
+
+TEST_F( AssetStreamingServiceTest, callbackThreadTest ) {
+    const IO::Uri uri( createFile( "thread", "data" ) );
+    std::thread::id callbackThread, requesterThread;
+    std::atomic<bool> requested( false ), updated( false );
+    ui32 numCallbacks( 0 );
+    std::thread requester( [ & ]() {
+        requesterThread = std::this_thread::get_id();
+        m_service->request( uri, 1.0f, [ &callbackThread ]( AssetStreamingService::Handle, AssetStreamingService::State, StreamPayload* ) {
+            callbackThread = std::this_thread::get_id();
+        } );
+        requested = true;
+        while ( !updated ) {
+            std::this_thread::yield();
+        }
+        numCallbacks = m_service->dispatchCallbacks();
+    } );
+
+    while ( !requested ) {
+        std::this_thread::yield();
+    }
+    m_service->update();
+    EXPECT_EQ( std::thread::id(), callbackThread );
+    updated = true;
+    requester.join();
+
+    EXPECT_EQ( 1u, numCallbacks );
+    EXPECT_EQ( requesterThread, callbackThread );
+}
+
+TEST_F( AssetStreamingServiceTest, streamTextureTest ) {
+    // A 2 x 2 TGA, BGRA and the top row first
+    const uc8 tga[ 18 + 16 ] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 2, 0, 32, 0x28,
+        0, 0, 255, 255,   0, 255, 0, 255,
+        255, 0, 0, 255,   255, 255, 255, 128 };
+    const IO::Uri uri( createFile( "texture.tga", String( reinterpret_cast<const c8*>( tga ), sizeof( tga ) ) ) );
+
+    RenderBackend::Texture *uploaded( nullptr );
+    TextureStreamHandler handler( [ &uploaded ]( RenderBackend::Texture *texture ) {
+        uploaded = texture;
+        return true;
+    } );
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    m_service->request( uri, 1.0f, [ &state ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload* ) {
+        state = s;
+    }, &handler );
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Done, state );
+
+    // The upload function owns the texture, the bottom row comes first
+    ASSERT_NE( nullptr, uploaded );
+    EXPECT_EQ( 2u, uploaded->m_width );
+    EXPECT_EQ( 2u, uploaded->m_height );
+    EXPECT_EQ( 4u, uploaded->m_channels );
+    ASSERT_EQ( 16u, uploaded->m_size );
+    EXPECT_EQ( 0, uploaded->m_data[ 0 ] );
+    EXPECT_EQ( 0, uploaded->m_data[ 1 ] );
+    EXPECT_EQ( 255, uploaded->m_data[ 2 ] );
+    EXPECT_EQ( 255, uploaded->m_data[ 8 ] );
+    EXPECT_EQ( 0, uploaded->m_data[ 9 ] );
+    delete uploaded;
+}
+
+TEST_F( AssetStreamingServiceTest, streamInvalidTextureTest ) {
+    TextureStreamHandler handler;
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    m_service->request( createFile( "invalid.png", "no image" ), 1.0f, 
+            [ &state ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload *payload ) {
+        state = s;
+        EXPECT_EQ( nullptr, payload );
+    }, &handler );
+
+    // Failed requests are finished by the next update
+    m_service->update();
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Failed, state );
+}
+
+TEST_F( AssetStreamingServiceTest, failedUploadTest ) {
+    const uc8 tga[ 18 + 4 ] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 32, 0x28, 0, 0, 255, 255 };
+    TextureStreamHandler handler( []( RenderBackend::Texture* ) {
+        return false;
+    } );
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    bool hasPayload( true );
+    m_service->request( createFile( "upload.tga", String( reinterpret_cast<const c8*>( tga ), sizeof( tga ) ) ), 1.0f, 
+            [ &state, &hasPayload ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload *payload ) {
+        state = s;
+        hasPayload = nullptr != payload;
+    }, &handler );
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Failed, state );
+    EXPECT_FALSE( hasPayload );
+}
+
+TEST_F( AssetStreamingServiceTest, streamMissingModelTest ) {
+    // The import reads the model itself, the read stage does not fail for it
+    ModelStreamHandler handler;
+    AssetStreamingService::State state( AssetStreamingService::State::Invalid );
+    bool hasPayload( true );
+    m_service->request( IO::Uri( "file://asset_streaming_test_missing.obj" ), 1.0f, 
+            [ &state, &hasPayload ]( AssetStreamingService::Handle, AssetStreamingService::State s, StreamPayload *payload ) {
+        state = s;
+        hasPayload = nullptr != payload;
+    }, &handler );
+    m_service->update();
+    m_service->update();
+    EXPECT_EQ( AssetStreamingService::State::Failed, state );
+    EXPECT_FALSE( hasPayload );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
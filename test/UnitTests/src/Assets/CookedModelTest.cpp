@@ -0,0 +1,256 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/CookedModel.h>
+#include <osre/IO/Stream.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::RenderBackend;
+
+class CookedModelTest : public ::testing::Test {
+protected:
+    // Writes into a plain file
+    class TestFileStream : public IO::Stream {
+    public:
+        FILE *m_file;
+
+        TestFileStream( const String &filename )
+        : Stream()
+        , m_file( ::fopen( filename.c_str(), "wb" ) ) {
+            // empty
+        }
+
+        ~TestFileStream() {
+            if ( nullptr != m_file ) {
+                ::fclose( m_file );
+            }
+        }
+
+        bool isOpen() const override {
+            return nullptr != m_file;
+        }
+
+        bool canWrite() const override {
+            return true;
+        }
+
+        ui32 write( const void *buffer, ui32 size ) override {
+            return static_cast<ui32>( ::fwrite( buffer, 1, size, m_file ) );
+        }
+    };
+
+    String m_filename;
+    Geometry *m_geo;
+    Material *m_material;
+
+    virtual void SetUp() {
+        m_filename = "cooked_model_test" + CookedModel::getCookedName( ".obj" );
+
+        RenderVert vertices[ 3 ];
+        vertices[ 0 ].position = glm::vec3( 0, 0, 0 );
+        vertices[ 1 ].position = glm::vec3( 1, 0, 0 );
+        vertices[ 2 ].position = glm::vec3( 0, 1, 0 );
+        vertices[ 1 ].tex0 = glm::vec2( 1, 0 );
+        const ui32 indices[ 3 ] = { 0, 1, 2 };
+
+        m_geo = Geometry::create( 1 );
+        m_geo->m_vertextype = VertexType::RenderVertex;
+        m_geo->m_indextype = IndexType::UnsignedInt;
+        m_geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( vertices ), BufferAccessType::ReadOnly );
+        m_geo->m_vb->copyFrom( vertices, sizeof( vertices ) );
+        m_geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( indices ), BufferAccessType::ReadOnly );
+        m_geo->m_ib->copyFrom( ( void* ) indices, sizeof( indices ) );
+        m_geo->m_numPrimGroups = 1;
+        m_geo->m_pPrimGroups = new PrimitiveGroup[ m_geo->m_numPrimGroups ];
+        m_geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, 3, PrimitiveType::TriangleList, 0 );
+
+        m_material = new Material( "test" );
+        m_material->m_color[ 0 ].m_r = 0.25f;
+        m_geo->m_material = m_material;
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+        Geometry::destroy( &m_geo );
+    }
+
+    bool writeModel( ui64 sourceSize, ui64 sourceTime, ui64 settingsHash = 0 ) {
+        CookedModel::GeoArray meshes;
+        meshes.add( m_geo );
+        CookedModel::NodeDescArray nodes;
+        CookedModel::NodeDesc root;
+        root.m_name = "root";
+        nodes.add( root );
+        CookedModel::NodeDesc child;
+        child.m_name = "child";
+        child.m_parent = 0;
+        child.m_transform = glm::translate( glm::mat4( 1.0f ), glm::vec3( 1, 2, 3 ) );
+        child.m_meshes.add( 0 );
+        nodes.add( child );
+        CookedModel::AABB aabb( Vec3f( 0, 0, 0 ), Vec3f( 1, 1, 0 ) );
+
+        TestFileStream stream( m_filename );
+        return CookedModel::save( stream, meshes, nodes, aabb, sourceSize, sourceTime, settingsHash );
+    }
+
+    template<class T>
+    void patchModel( ui64 offset, T value ) {
+        FILE *file( ::fopen( m_filename.c_str(), "r+b" ) );
+        ASSERT_NE( nullptr, file );
+        ::fseek( file, static_cast<long>( offset ), SEEK_SET );
+        ::fwrite( &value, sizeof( T ), 1, file );
+        ::fclose( file );
+    }
+};
+
+TEST_F( CookedModelTest, saveAndOpenTest ) {
+    ASSERT_TRUE( writeModel( 100, 200 ) );
+
+    CookedModel cooked;
+    ASSERT_TRUE( cooked.open( m_filename ) );
+    EXPECT_TRUE( cooked.isUpToDate( 100, 200 ) );
+    EXPECT_FALSE( cooked.isUpToDate( 100, 201 ) );
+    EXPECT_EQ( 1u, cooked.getNumMeshes() );
+    EXPECT_EQ( 1u, cooked.getNumMaterials() );
+    EXPECT_EQ( 0u, cooked.getMeshMaterial( 0 ) );
+    EXPECT_EQ( 0u, cooked.getHeader().m_blobOffset % CookedModel::BlobAlignment );
+    EXPECT_FLOAT_EQ( 1.0f, cooked.getAABB().getMax()[ 0 ] );
+
+    ASSERT_EQ( 2u, cooked.getNumNodes() );
+    EXPECT_EQ( "root", cooked.getNodeName( 0 ) );
+    EXPECT_EQ( -1, cooked.getNodeParent( 0 ) );
+    EXPECT_EQ( 0u, cooked.getNumNodeMeshes( 0 ) );
+    EXPECT_EQ( "child", cooked.getNodeName( 1 ) );
+    EXPECT_EQ( 0, cooked.getNodeParent( 1 ) );
+    ASSERT_EQ( 1u, cooked.getNumNodeMeshes( 1 ) );
+    EXPECT_EQ( 0u, cooked.getNodeMeshAt( 1, 0 ) );
+    EXPECT_FLOAT_EQ( 2.0f, cooked.getNodeTransform( 1 )[ 3 ][ 1 ] );
+}
+
+TEST_F( CookedModelTest, createGeometryTest ) {
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+
+    CookedModel cooked;
+    ASSERT_TRUE( cooked.open( m_filename ) );
+    Geometry *geo( cooked.createGeometry( 0 ) );
+    ASSERT_NE( nullptr, geo );
+    EXPECT_EQ( VertexType::RenderVertex, geo->m_vertextype );
+    EXPECT_EQ( m_geo->m_vb->m_size, geo->m_vb->m_size );
+    EXPECT_EQ( 0, ::memcmp( m_geo->m_vb->m_data, geo->m_vb->m_data, geo->m_vb->m_size ) );
+    EXPECT_EQ( 0, ::memcmp( m_geo->m_ib->m_data, geo->m_ib->m_data, geo->m_ib->m_size ) );
+    EXPECT_EQ( 3u, geo->m_pPrimGroups[ 0 ].m_numIndices );
+    EXPECT_EQ( IndexType::UnsignedInt, geo->m_pPrimGroups[ 0 ].m_indexType );
+
+    // The buffers view the mapping
+    EXPECT_FALSE( geo->m_vb->m_owned );
+    const uc8 *begin( static_cast<const uc8*>( static_cast<const void*>( &cooked.getHeader() ) ) );
+    EXPECT_EQ( begin + cooked.getHeader().m_blobOffset, geo->m_vb->m_data );
+    EXPECT_EQ( 0u, reinterpret_cast<size_t>( geo->m_ib->m_data ) % CookedModel::BlobAlignment );
+    Geometry::destroy( &geo );
+    EXPECT_EQ( nullptr, cooked.createGeometry( 1 ) );
+}
+
+TEST_F( CookedModelTest, settingsHashTest ) {
+    ASSERT_TRUE( writeModel( 100, 200, 42 ) );
+
+    CookedModel cooked;
+    ASSERT_TRUE( cooked.open( m_filename ) );
+    EXPECT_TRUE( cooked.isUpToDate( 100, 200, 42 ) );
+    EXPECT_FALSE( cooked.isUpToDate( 100, 200, 43 ) );
+    EXPECT_FALSE( cooked.isUpToDate( 100, 200 ) );
+}
+
+TEST_F( CookedModelTest, geometryOutlivesModelTest ) {
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+
+    CookedModel *cooked( new CookedModel );
+    ASSERT_TRUE( cooked->open( m_filename ) );
+    Geometry *geo( cooked->createGeometry( 0 ) );
+    ASSERT_NE( nullptr, geo );
+    delete cooked;
+
+    // The geometry still holds the mapping
+    EXPECT_EQ( 0, ::memcmp( m_geo->m_vb->m_data, geo->m_vb->m_data, geo->m_vb->m_size ) );
+    EXPECT_EQ( 0, ::memcmp( m_geo->m_ib->m_data, geo->m_ib->m_data, geo->m_ib->m_size ) );
+    Geometry::destroy( &geo );
+}
+
+TEST_F( CookedModelTest, invalidFileTest ) {
+    CookedModel cooked;
+    EXPECT_FALSE( cooked.open( "does_not_exist.osm" ) );
+    EXPECT_FALSE( cooked.isOpen() );
+
+    FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+    ASSERT_NE( nullptr, file );
+    const c8 garbage[ 256 ] = "not a cooked model";
+    ::fwrite( garbage, 1, sizeof( garbage ), file );
+    ::fclose( file );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+    EXPECT_EQ( 0u, cooked.getNumMeshes() );
+}
+
+TEST_F( CookedModelTest, corruptedFileTest ) {
+    const ui64 meshOffset( sizeof( CookedModelHeader ) );
+
+    // Index value beyond the vertex buffer
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+    CookedModel cooked;
+    ASSERT_TRUE( cooked.open( m_filename ) );
+    const uc8 *begin( static_cast<const uc8*>( static_cast<const void*>( &cooked.getHeader() ) ) );
+    const ui64 ibOffset( reinterpret_cast<const CookedMesh*>( begin + meshOffset )->m_ibOffset );
+    cooked.close();
+    patchModel<ui32>( ibOffset + sizeof( ui32 ), 3 );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+
+    // More indices than the index buffer holds
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+    patchModel<ui32>( meshOffset + offsetof( CookedMesh, m_numIndices ), 4 );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+
+    // Offsets wrapping around
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+    patchModel<ui64>( meshOffset + offsetof( CookedMesh, m_vbOffset ), ~0ull - 8 );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+
+    // Enum out of range
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+    patchModel<ui32>( meshOffset + offsetof( CookedMesh, m_indexType ), 7 );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+
+    ASSERT_TRUE( writeModel( 0, 0 ) );
+    EXPECT_TRUE( cooked.open( m_filename ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,202 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/CookedTexture.h>
+#include <osre/IO/Stream.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+
+class CookedTextureTest : public ::testing::Test {
+protected:
+    // Writes into a plain file
+    class TestFileStream : public IO::Stream {
+    public:
+        FILE *m_file;
+
+        TestFileStream( const String &filename )
+        : Stream()
+        , m_file( ::fopen( filename.c_str(), "wb" ) ) {
+            // empty
+        }
+
+        ~TestFileStream() {
+            if ( nullptr != m_file ) {
+                ::fclose( m_file );
+            }
+        }
+
+        bool isOpen() const override {
+            return nullptr != m_file;
+        }
+
+        bool canWrite() const override {
+            return true;
+        }
+
+        ui32 write( const void *buffer, ui32 size ) override {
+            return static_cast<ui32>( ::fwrite( buffer, 1, size, m_file ) );
+        }
+    };
+
+    String m_filename;
+
+    virtual void SetUp() {
+        m_filename = CookedTexture::getCookedName( "cooked_texture_test.png" );
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+    }
+
+    // Creates a horizontal color ramp, the alpha channel is a vertical ramp when requested
+    static void createGradient( ui32 width, ui32 height, bool alpha, CookedTexture::Image &image ) {
+        image.resize( width, height );
+        for ( ui32 y = 0; y < height; ++y ) {
+            for ( ui32 x = 0; x < width; ++x ) {
+                uc8 *texel( &image.m_data[ ( y * width + x ) * 4 ] );
+                texel[ 0 ] = static_cast<uc8>( x * 255 / ( width - 1 ) );
+                texel[ 1 ] = static_cast<uc8>( 255 - texel[ 0 ] );
+                texel[ 2 ] = 128;
+                texel[ 3 ] = alpha ? static_cast<uc8>( y * 255 / ( height - 1 ) ) : 255;
+            }
+        }
+    }
+
+    static i32 getMaxError( const CookedTexture::Image &a, const CookedTexture::Image &b, ui32 channel ) {
+        i32 maxError( 0 );
+        for ( size_t i = channel; i < a.m_data.size(); i += 4 ) {
+            maxError = std::max( maxError, std::abs( static_cast<i32>( a.m_data[ i ] ) - static_cast<i32>( b.m_data[ i ] ) ) );
+        }
+
+        return maxError;
+    }
+};
+
+TEST_F( CookedTextureTest, bc1RoundTripTest ) {
+    CookedTexture::Image image, decoded;
+    createGradient( 32, 32, false, image );
+    EXPECT_EQ( CookedTextureFormat::BC1, CookedTexture::selectFormat( image ) );
+
+    std::vector<uc8> data;
+    CookedTexture::encode( image, CookedTextureFormat::BC1, data );
+    EXPECT_EQ( 8u * 8u * 8u, data.size() );
+    ASSERT_TRUE( CookedTexture::decode( &data[ 0 ], CookedTextureFormat::BC1, 32, 32, decoded ) );
+    EXPECT_LE( getMaxError( image, decoded, 0 ), 12 );
+    EXPECT_LE( getMaxError( image, decoded, 1 ), 12 );
+    EXPECT_LE( getMaxError( image, decoded, 2 ), 8 );
+    EXPECT_EQ( 0, getMaxError( image, decoded, 3 ) );
+}
+
+TEST_F( CookedTextureTest, bc3AndBc5RoundTripTest ) {
+    CookedTexture::Image image, decoded;
+    createGradient( 6, 5, true, image );
+    EXPECT_EQ( CookedTextureFormat::BC3, CookedTexture::selectFormat( image ) );
+
+    // The partial blocks at the border are padded
+    std::vector<uc8> data;
+    CookedTexture::encode( image, CookedTextureFormat::BC3, data );
+    EXPECT_EQ( 2u * 2u * 16u, data.size() );
+    ASSERT_TRUE( CookedTexture::decode( &data[ 0 ], CookedTextureFormat::BC3, 6, 5, decoded ) );
+    EXPECT_LE( getMaxError( image, decoded, 3 ), 10 );
+    EXPECT_LE( getMaxError( image, decoded, 0 ), 24 );
+
+    CookedTexture::encode( image, CookedTextureFormat::BC5, data );
+    ASSERT_TRUE( CookedTexture::decode( &data[ 0 ], CookedTextureFormat::BC5, 6, 5, decoded ) );
+    EXPECT_LE( getMaxError( image, decoded, 0 ), 10 );
+    EXPECT_LE( getMaxError( image, decoded, 1 ), 10 );
+}
+
+TEST_F( CookedTextureTest, mipChainTest ) {
+    CookedTexture::Image image;
+    image.resize( 8, 2 );
+    for ( ui32 i = 0; i < 16; ++i ) {
+        const uc8 value( 0 == i % 2 ? 0 : 255 );
+        image.m_data[ i * 4 ] = image.m_data[ i * 4 + 1 ] = image.m_data[ i * 4 + 2 ] = value;
+        image.m_data[ i * 4 + 3 ] = value;
+    }
+
+    std::vector<CookedTexture::Image> levels;
+    CookedTexture::generateMipChain( image, true, false, levels );
+    ASSERT_EQ( 4u, levels.size() );
+    EXPECT_EQ( 4u, levels[ 1 ].m_width );
+    EXPECT_EQ( 1u, levels[ 1 ].m_height );
+    EXPECT_EQ( 1u, levels[ 3 ].m_width );
+
+    // Black and white average to 50% linear intensity, alpha is filtered linearly
+    EXPECT_NEAR( 188, levels[ 1 ].m_data[ 0 ], 1 );
+    EXPECT_NEAR( 128, levels[ 1 ].m_data[ 3 ], 1 );
+
+    CookedTexture::generateMipChain( image, false, false, levels );
+    EXPECT_NEAR( 128, levels[ 1 ].m_data[ 0 ], 1 );
+}
+
+TEST_F( CookedTextureTest, saveAndOpenTest ) {
+    CookedTexture::Image image;
+    createGradient( 16, 8, false, image );
+    {
+        TestFileStream stream( m_filename );
+        CookedTexture::Options options;
+        ASSERT_TRUE( CookedTexture::save( stream, image, options, 100, 200 ) );
+    }
+
+    CookedTexture cooked;
+    ASSERT_TRUE( cooked.open( m_filename ) );
+    EXPECT_TRUE( cooked.isUpToDate( 100, 200 ) );
+    EXPECT_FALSE( cooked.isUpToDate( 101, 200 ) );
+    EXPECT_EQ( CookedTextureFormat::BC1, cooked.getFormat() );
+    ASSERT_EQ( 5u, cooked.getNumLevels() );
+    for ( ui32 i = 0; i < cooked.getNumLevels(); ++i ) {
+        const CookedTextureLevel &level( cooked.getLevel( i ) );
+        EXPECT_EQ( std::max( 16u >> i, 1u ), level.m_width );
+        EXPECT_EQ( std::max( 8u >> i, 1u ), level.m_height );
+        EXPECT_EQ( 0u, level.m_offset % CookedTexture::BlobAlignment );
+    }
+
+    std::vector<uc8> data;
+    CookedTexture::encode( image, CookedTextureFormat::BC1, data );
+    EXPECT_EQ( data.size(), cooked.getLevel( 0 ).m_size );
+    EXPECT_EQ( 0, ::memcmp( &data[ 0 ], cooked.getLevelData( 0 ), data.size() ) );
+}
+
+TEST_F( CookedTextureTest, invalidFileTest ) {
+    CookedTexture cooked;
+    EXPECT_FALSE( cooked.open( "does_not_exist.ost" ) );
+    EXPECT_FALSE( cooked.isOpen() );
+
+    FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+    ASSERT_NE( nullptr, file );
+    const c8 garbage[ 256 ] = "not a cooked texture";
+    ::fwrite( garbage, 1, sizeof( garbage ), file );
+    ::fclose( file );
+    EXPECT_FALSE( cooked.open( m_filename ) );
+    EXPECT_EQ( 0u, cooked.getNumLevels() );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/DedupCache.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::RenderBackend;
+
+class DedupCacheTest : public ::testing::Test {
+protected:
+    Geometry *createTriangle( f32 offset, Material *mat ) {
+        ColorVert vertices[ 3 ];
+        vertices[ 0 ].position = glm::vec3( offset, 0, 0 );
+        vertices[ 1 ].position = glm::vec3( offset + 1, 0, 0 );
+        vertices[ 2 ].position = glm::vec3( offset, 1, 0 );
+        ui16 indices[ 3 ] = { 0, 1, 2 };
+
+        Geometry *geo( Geometry::create( 1 ) );
+        geo->m_vertextype = VertexType::ColorVertex;
+        geo->m_indextype = IndexType::UnsignedShort;
+        geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( vertices ), BufferAccessType::ReadOnly );
+        geo->m_vb->copyFrom( &vertices[ 0 ], geo->m_vb->m_size );
+        geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( indices ), BufferAccessType::ReadOnly );
+        geo->m_ib->copyFrom( indices, geo->m_ib->m_size );
+        geo->m_numPrimGroups = 1;
+        geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
+        geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedShort, 3, PrimitiveType::TriangleList, 0 );
+        geo->m_material = mat;
+
+        return geo;
+    }
+
+    void release( Geometry *geo ) {
+        geo->m_material = nullptr;
+        Geometry::destroy( &geo );
+    }
+};
+
+TEST_F( DedupCacheTest, dedupGeometryTest ) {
+    Material *mat( new Material( "mat", MaterialType::ShaderMaterial ) );
+    DedupCache cache;
+    Geometry *geo1( cache.addGeometry( createTriangle( 0.0f, mat ) ) );
+    Geometry *dup( createTriangle( 0.0f, mat ) );
+    Geometry *geo2( cache.addGeometry( dup ) );
+    EXPECT_EQ( geo1, geo2 );
+    EXPECT_EQ( 1u, cache.getNumGeometries() );
+    EXPECT_EQ( 1u, cache.getNumDuplicates() );
+    release( dup );
+
+    Geometry *geo3( cache.addGeometry( createTriangle( 2.0f, mat ) ) );
+    EXPECT_NE( geo1, geo3 );
+    EXPECT_EQ( 2u, cache.getNumGeometries() );
+
+    Material *other( new Material( "mat", MaterialType::ShaderMaterial ) );
+    Geometry *geo4( cache.addGeometry( createTriangle( 0.0f, other ) ) );
+    EXPECT_NE( geo1, geo4 );
+    EXPECT_EQ( 3u, cache.getNumGeometries() );
+    EXPECT_EQ( 1u, cache.getNumDuplicates() );
+
+    cache.clear();
+    release( geo1 );
+    release( geo3 );
+    release( geo4 );
+    delete mat;
+    delete other;
+}
+
+TEST_F( DedupCacheTest, releaseGeometryTest ) {
+    Material *mat( new Material( "mat", MaterialType::ShaderMaterial ) );
+    DedupCache cache;
+    Geometry *geo1( cache.addGeometry( createTriangle( 0.0f, mat ) ) );
+    Geometry *dup( createTriangle( 0.0f, mat ) );
+    EXPECT_EQ( geo1, cache.addGeometry( dup ) );
+    release( dup );
+
+    // The first release leaves the geometry to the second user
+    EXPECT_FALSE( cache.releaseGeometry( geo1 ) );
+    EXPECT_EQ( 1u, cache.getNumGeometries() );
+    EXPECT_TRUE( cache.releaseGeometry( geo1 ) );
+    EXPECT_EQ( 0u, cache.getNumGeometries() );
+    release( geo1 );
+
+    // A released entry will not be returned for new geometries
+    Geometry *geo2( createTriangle( 0.0f, mat ) );
+    EXPECT_EQ( geo2, cache.addGeometry( geo2 ) );
+    EXPECT_TRUE( cache.releaseGeometry( geo2 ) );
+    release( geo2 );
+
+    // Unknown geometries are owned by the caller only
+    Geometry *geo3( createTriangle( 1.0f, mat ) );
+    EXPECT_TRUE( cache.releaseGeometry( geo3 ) );
+    release( geo3 );
+    delete mat;
+}
+
+TEST_F( DedupCacheTest, dedupMaterialTest ) {
+    DedupCache cache;
+    Material *mat1( cache.addMaterial( new Material( "mat", MaterialType::ShaderMaterial ) ) );
+    Material *dup( new Material( "mat", MaterialType::ShaderMaterial ) );
+    Material *mat2( cache.addMaterial( dup ) );
+    EXPECT_EQ( mat1, mat2 );
+    EXPECT_EQ( 1u, cache.getNumMaterials() );
+    EXPECT_EQ( 1u, cache.getNumDuplicates() );
+    delete dup;
+
+    Material *colored( new Material( "mat", MaterialType::ShaderMaterial ) );
+    colored->m_color[ 0 ] = Color4( 1.0f, 0.0f, 0.0f, 1.0f );
+    Material *mat3( cache.addMaterial( colored ) );
+    EXPECT_EQ( colored, mat3 );
+    EXPECT_EQ( 2u, cache.getNumMaterials() );
+    EXPECT_EQ( 1u, cache.getNumDuplicates() );
+
+    EXPECT_FALSE( cache.releaseMaterial( mat1 ) );
+    EXPECT_TRUE( cache.releaseMaterial( mat1 ) );
+    EXPECT_TRUE( cache.releaseMaterial( mat3 ) );
+    EXPECT_EQ( 0u, cache.getNumMaterials() );
+    delete mat1;
+    delete mat3;
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,155 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/DerivedDataCache.h>
+
+#include <cstdio>
+#include <set>
+#include <unistd.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+
+class DerivedDataCacheTest : public ::testing::Test {
+protected:
+    String m_directory;
+    String m_source;
+
+    virtual void SetUp() {
+        m_directory = "derived_data_cache_test";
+        m_source = "derived_data_cache_test.src";
+        writeSource( "source data" );
+    }
+
+    virtual void TearDown() {
+        ::remove( m_source.c_str() );
+        ::remove( ( m_directory + "/index.txt" ).c_str() );
+        ::rmdir( m_directory.c_str() );
+    }
+
+    void writeSource( const String &content ) {
+        FILE *file( ::fopen( m_source.c_str(), "wb" ) );
+        ::fwrite( content.c_str(), 1, content.size(), file );
+        ::fclose( file );
+    }
+};
+
+TEST_F( DerivedDataCacheTest, hashTest ) {
+    const c8 data[] = "0123456789abcdef";
+    EXPECT_EQ( DerivedDataCache::hash( data, 16 ), DerivedDataCache::hash( data, 16 ) );
+    EXPECT_NE( DerivedDataCache::hash( data, 16 ), DerivedDataCache::hash( data, 15 ) );
+    EXPECT_NE( DerivedDataCache::hash( data, 16 ), DerivedDataCache::hash( data, 16, 1 ) );
+    EXPECT_NE( DerivedDataCache::hash( data, 8 ), DerivedDataCache::hash( data + 8, 8 ) );
+}
+
+TEST_F( DerivedDataCacheTest, computeKeyTest ) {
+    DerivedDataCache cache;
+    ASSERT_TRUE( cache.open( m_directory ) );
+    EXPECT_TRUE( cache.isOpen() );
+
+    DerivedDataCache::Key key( 0 ), other( 0 );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, key ) );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, other ) );
+    EXPECT_EQ( key, other );
+    EXPECT_EQ( 1u, cache.getNumHashedFiles() );
+
+    // Each input changes the key
+    ASSERT_TRUE( cache.computeKey( m_source, "other settings", 1, other ) );
+    EXPECT_NE( key, other );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 2, other ) );
+    EXPECT_NE( key, other );
+    writeSource( "changed source data" );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, other ) );
+    EXPECT_NE( key, other );
+    EXPECT_EQ( 2u, cache.getNumHashedFiles() );
+
+    EXPECT_FALSE( cache.computeKey( "does_not_exist.src", "settings", 1, other ) );
+
+    EXPECT_EQ( 0u, cache.getFilename( key, ".osm" ).find( m_directory + "/" ) );
+}
+
+TEST_F( DerivedDataCacheTest, indexTest ) {
+    DerivedDataCache::Key key( 0 ), other( 0 );
+    {
+        DerivedDataCache cache;
+        ASSERT_TRUE( cache.open( m_directory ) );
+        ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, key ) );
+    }
+
+    // The unchanged source is not hashed again after reopening
+    DerivedDataCache cache;
+    ASSERT_TRUE( cache.open( m_directory ) );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, other ) );
+    EXPECT_EQ( key, other );
+    EXPECT_EQ( 0u, cache.getNumHashedFiles() );
+}
+
+TEST_F( DerivedDataCacheTest, derivedFilenameTest ) {
+    DerivedDataCache cache;
+    EXPECT_TRUE( cache.getDerivedFilename( m_source, "settings", 1, ".osm" ).empty() );
+
+    ASSERT_TRUE( cache.open( m_directory ) );
+    const String filename( cache.getDerivedFilename( m_source, "settings", 1, ".osm" ) );
+    ASSERT_FALSE( filename.empty() );
+
+    DerivedDataCache::Key key( 0 );
+    ASSERT_TRUE( cache.computeKey( m_source, "settings", 1, key ) );
+    EXPECT_EQ( cache.getFilename( key, ".osm" ), filename );
+    EXPECT_FALSE( cache.contains( key, ".osm" ) );
+
+    FILE *file( ::fopen( filename.c_str(), "wb" ) );
+    ASSERT_NE( nullptr, file );
+    ::fclose( file );
+    EXPECT_TRUE( cache.contains( key, ".osm" ) );
+    ::remove( filename.c_str() );
+}
+
+TEST_F( DerivedDataCacheTest, dependenciesTest ) {
+    const String derivedFile( m_directory + "/0123456789abcdef.osm" );
+    std::set<String> dependencies;
+    dependencies.insert( m_source );
+    {
+        DerivedDataCache cache;
+        ASSERT_TRUE( cache.open( m_directory ) );
+        EXPECT_TRUE( cache.checkDependencies( derivedFile ) );
+        ASSERT_TRUE( cache.setDependencies( derivedFile, dependencies ) );
+        EXPECT_TRUE( cache.checkDependencies( derivedFile ) );
+
+        std::set<String> missing;
+        missing.insert( "does_not_exist.mtl" );
+        EXPECT_FALSE( cache.setDependencies( derivedFile, missing ) );
+        EXPECT_TRUE( cache.checkDependencies( derivedFile ) );
+    }
+
+    // The dependencies are kept in the index
+    DerivedDataCache cache;
+    ASSERT_TRUE( cache.open( m_directory ) );
+    EXPECT_TRUE( cache.checkDependencies( derivedFile ) );
+    writeSource( "changed dependency data" );
+    EXPECT_FALSE( cache.checkDependencies( derivedFile ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/MeshOptimizer.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::RenderBackend;
+
+class MeshOptimizerTest : public ::testing::Test {
+protected:
+    // Creates a grid with numCells x numCells quads, the triangles are shuffled
+    Geometry *createGrid( ui32 numCells, ui32 numUnused ) {
+        const ui32 numRowVerts( numCells + 1 );
+        std::vector<ColorVert> vertices;
+        for ( ui32 y = 0; y < numRowVerts; ++y ) {
+            for ( ui32 x = 0; x < numRowVerts; ++x ) {
+                ColorVert v;
+                v.position = glm::vec3( x, y, 0 );
+                vertices.push_back( v );
+            }
+        }
+        for ( ui32 i = 0; i < numUnused; ++i ) {
+            ColorVert v;
+            v.position = glm::vec3( -1.0f, -1.0f, static_cast<f32>( i ) );
+            vertices.push_back( v );
+        }
+
+        std::vector<ui32> triangles;
+        for ( ui32 y = 0; y < numCells; ++y ) {
+            for ( ui32 x = 0; x < numCells; ++x ) {
+                triangles.push_back( y * numCells + x );
+            }
+        }
+        ui32 seed( 12345 );
+        for ( ui32 i = static_cast<ui32>( triangles.size() ) - 1; i > 0; --i ) {
+            seed = seed * 1103515245 + 12345;
+            std::swap( triangles[ i ], triangles[ ( seed >> 8 ) % ( i + 1 ) ] );
+        }
+
+        std::vector<ui32> indices;
+        for ( ui32 cell : triangles ) {
+            const ui32 x( cell % numCells ), y( cell / numCells );
+            const ui32 i0( y * numRowVerts + x ), i1( i0 + 1 ), i2( i0 + numRowVerts ), i3( i2 + 1 );
+            indices.push_back( i0 ); indices.push_back( i1 ); indices.push_back( i3 );
+            indices.push_back( i0 ); indices.push_back( i3 ); indices.push_back( i2 );
+        }
+
+        Geometry *geo( Geometry::create( 1 ) );
+        geo->m_vertextype = VertexType::ColorVertex;
+        geo->m_indextype = IndexType::UnsignedInt;
+        geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( ColorVert ) * vertices.size(), BufferAccessType::ReadOnly );
+        geo->m_vb->copyFrom( &vertices[ 0 ], geo->m_vb->m_size );
+        geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( ui32 ) * indices.size(), BufferAccessType::ReadOnly );
+        geo->m_ib->copyFrom( &indices[ 0 ], geo->m_ib->m_size );
+        geo->m_numPrimGroups = 1;
+        geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
+        geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, indices.size(), PrimitiveType::TriangleList, 0 );
+
+        return geo;
+    }
+
+    // Returns the triangles as sorted position sums, independent of the vertex order
+    std::vector<f32> getTriangleKeys( const Geometry *geo ) {
+        const ColorVert *vertices( static_cast<const ColorVert*>( geo->m_vb->m_data ) );
+        std::vector<f32> keys;
+        for ( ui32 i = 0; i < geo->m_pPrimGroups[ 0 ].m_numIndices; i += 3 ) {
+            glm::vec3 sum( 0.0f );
+            for ( ui32 k = 0; k < 3; ++k ) {
+                ui32 idx( 0 );
+                if ( IndexType::UnsignedShort == geo->m_indextype ) {
+                    idx = static_cast<const ui16*>( geo->m_ib->m_data )[ i + k ];
+                } else {
+                    idx = static_cast<const ui32*>( geo->m_ib->m_data )[ i + k ];
+                }
+                sum += vertices[ idx ].position;
+            }
+            keys.push_back( sum.x * 10000.0f + sum.y );
+        }
+        std::sort( keys.begin(), keys.end() );
+
+        return keys;
+    }
+};
+
+TEST_F( MeshOptimizerTest, computeACMRTest ) {
+    // Two triangles sharing an edge need four vertex loads
+    const ui32 indices[] = { 0, 1, 2, 2, 1, 3 };
+    EXPECT_FLOAT_EQ( 2.0f, MeshOptimizer::computeACMR( indices, 6, 4 ) );
+
+    // A cache of three vertices has forgotten vertex 0 again
+    const ui32 repeated[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    EXPECT_FLOAT_EQ( 3.0f, MeshOptimizer::computeACMR( repeated, 9, 6, 3 ) );
+    EXPECT_FLOAT_EQ( 2.0f, MeshOptimizer::computeACMR( repeated, 9, 6, 16 ) );
+
+    EXPECT_FLOAT_EQ( 0.0f, MeshOptimizer::computeACMR( nullptr, 0, 0 ) );
+}
+
+TEST_F( MeshOptimizerTest, vertexFetchTest ) {
+    ui32 vertices[] = { 10, 11, 12, 13 };
+    ui32 indices[] = { 2, 0, 3, 3, 0, 2 };
+    EXPECT_EQ( 3u, MeshOptimizer::optimizeVertexFetch( reinterpret_cast<uc8*>( vertices ), 4, sizeof( ui32 ), indices, 6 ) );
+
+    const ui32 expectedIndices[] = { 0, 1, 2, 2, 1, 0 };
+    const ui32 expectedVertices[] = { 12, 10, 13, 11 };
+    for ( ui32 i = 0; i < 6; ++i ) {
+        EXPECT_EQ( expectedIndices[ i ], indices[ i ] );
+    }
+    for ( ui32 i = 0; i < 4; ++i ) {
+        EXPECT_EQ( expectedVertices[ i ], vertices[ i ] );
+    }
+}
+
+TEST_F( MeshOptimizerTest, optimizeGridTest ) {
+    Geometry *grid( createGrid( 32, 5 ) );
+    const std::vector<f32> keys( getTriangleKeys( grid ) );
+
+    MeshOptimizer::Statistics stats;
+    EXPECT_TRUE( MeshOptimizer::optimize( grid, &stats ) );
+    EXPECT_EQ( 32u * 32u * 2u, stats.m_numTriangles );
+    EXPECT_LT( stats.m_acmrAfter, stats.m_acmrBefore );
+    EXPECT_LT( stats.m_acmrAfter, 1.0f );
+    EXPECT_GE( stats.m_numClusters, 1u );
+
+    // Same triangles, 16-bit indices and no unused vertices
+    EXPECT_EQ( IndexType::UnsignedShort, grid->m_indextype );
+    EXPECT_EQ( IndexType::UnsignedShort, grid->m_pPrimGroups[ 0 ].m_indexType );
+    EXPECT_EQ( 33u * 33u * sizeof( ColorVert ), grid->m_vb->m_size );
+    EXPECT_EQ( 32u * 32u * 6u * sizeof( ui16 ), grid->m_ib->m_size );
+    EXPECT_EQ( keys, getTriangleKeys( grid ) );
+
+    Geometry::destroy( &grid );
+}
+
+TEST_F( MeshOptimizerTest, invalidGeometryTest ) {
+    EXPECT_FALSE( MeshOptimizer::optimize( nullptr ) );
+
+    Geometry *grid( createGrid( 2, 0 ) );
+    static_cast<ui32*>( grid->m_ib->m_data )[ 0 ] = 1000;
+    EXPECT_FALSE( MeshOptimizer::optimize( grid ) );
+    Geometry::destroy( &grid );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,102 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/MeshSimplifier.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::RenderBackend;
+
+class MeshSimplifierTest : public ::testing::Test {
+protected:
+    // Creates a flat grid with numCells x numCells quads
+    Geometry *createGrid( ui32 numCells ) {
+        const ui32 numRowVerts( numCells + 1 );
+        CPPCore::TArray<ColorVert> vertices;
+        for ( ui32 y = 0; y < numRowVerts; ++y ) {
+            for ( ui32 x = 0; x < numRowVerts; ++x ) {
+                ColorVert v;
+                v.position = glm::vec3( x, y, 0 );
+                v.normal = glm::vec3( 0, 0, 1 );
+                v.color0 = glm::vec3( 1, 1, 1 );
+                vertices.add( v );
+            }
+        }
+
+        CPPCore::TArray<ui32> indices;
+        for ( ui32 y = 0; y < numCells; ++y ) {
+            for ( ui32 x = 0; x < numCells; ++x ) {
+                const ui32 i0( y * numRowVerts + x ), i1( i0 + 1 ), i2( i0 + numRowVerts ), i3( i2 + 1 );
+                indices.add( i0 ); indices.add( i1 ); indices.add( i3 );
+                indices.add( i0 ); indices.add( i3 ); indices.add( i2 );
+            }
+        }
+
+        Geometry *geo( Geometry::create( 1 ) );
+        geo->m_vertextype = VertexType::ColorVertex;
+        geo->m_indextype = IndexType::UnsignedInt;
+        geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( ColorVert ) * vertices.size(), BufferAccessType::ReadOnly );
+        geo->m_vb->copyFrom( &vertices[ 0 ], geo->m_vb->m_size );
+        geo->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( ui32 ) * indices.size(), BufferAccessType::ReadOnly );
+        geo->m_ib->copyFrom( &indices[ 0 ], geo->m_ib->m_size );
+        geo->m_numPrimGroups = 1;
+        geo->m_pPrimGroups = new PrimitiveGroup[ geo->m_numPrimGroups ];
+        geo->m_pPrimGroups[ 0 ].init( IndexType::UnsignedInt, indices.size(), PrimitiveType::TriangleList, 0 );
+
+        return geo;
+    }
+};
+
+TEST_F( MeshSimplifierTest, invalidGeometryTest ) {
+    EXPECT_EQ( nullptr, MeshSimplifier::simplify( nullptr, 0.5f ) );
+    EXPECT_EQ( 0u, MeshSimplifier::getNumTriangles( nullptr ) );
+}
+
+TEST_F( MeshSimplifierTest, simplifyGridTest ) {
+    Geometry *grid( createGrid( 8 ) );
+    EXPECT_EQ( 128u, MeshSimplifier::getNumTriangles( grid ) );
+
+    Geometry *simplified( MeshSimplifier::simplify( grid, 0.25f ) );
+    ASSERT_NE( nullptr, simplified );
+    const ui32 numTriangles( MeshSimplifier::getNumTriangles( simplified ) );
+    EXPECT_LE( numTriangles, 32u );
+    EXPECT_GT( numTriangles, 0u );
+
+    // All indices must reference the compacted vertices
+    const ui32 numVertices( simplified->m_vb->m_size / sizeof( ColorVert ) );
+    EXPECT_LT( numVertices, 81u );
+    const ui32 *indices( static_cast<const ui32*>( simplified->m_ib->m_data ) );
+    for ( ui32 i = 0; i < numTriangles * 3; ++i ) {
+        EXPECT_LT( indices[ i ], numVertices );
+    }
+
+    Geometry::destroy( &simplified );
+    Geometry::destroy( &grid );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
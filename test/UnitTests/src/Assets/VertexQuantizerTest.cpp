@@ -0,0 +1,142 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Assets/VertexQuantizer.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Assets;
+using namespace ::OSRE::RenderBackend;
+
+class VertexQuantizerTest : public ::testing::Test {
+protected:
+    Geometry *createGeometry() {
+        RenderVert vertices[ 3 ];
+        vertices[ 0 ].position = glm::vec3( -1, 2, 0.5f );
+        vertices[ 0 ].normal = glm::vec3( 0, 0, 1 );
+        vertices[ 0 ].tex0 = glm::vec2( 0, 0 );
+        vertices[ 1 ].position = glm::vec3( 3, 2, 0.5f );
+        vertices[ 1 ].normal = glm::normalize( glm::vec3( 1, -1, -1 ) );
+        vertices[ 1 ].color0 = glm::vec3( 0.5f, 0, 1 );
+        vertices[ 1 ].tex0 = glm::vec2( 1, 0.25f );
+        vertices[ 2 ].position = glm::vec3( 1, 6, 0.5f );
+        vertices[ 2 ].normal = glm::vec3( 0, -1, 0 );
+        vertices[ 2 ].tex0 = glm::vec2( 2.5f, -1 );
+
+        Geometry *geo( Geometry::create( 1 ) );
+        geo->m_vertextype = VertexType::RenderVertex;
+        geo->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( vertices ), BufferAccessType::ReadOnly );
+        geo->m_vb->copyFrom( vertices, geo->m_vb->m_size );
+
+        return geo;
+    }
+};
+
+TEST_F( VertexQuantizerTest, vertexSizeTest ) {
+    EXPECT_EQ( 24u, Geometry::getVertexSize( VertexType::CompactRenderVertex ) );
+    EXPECT_EQ( 20u, Geometry::getVertexSize( VertexType::QuantizedRenderVertex ) );
+
+    VertexLayout layout;
+    CompactRenderVert::getLayout( layout );
+    EXPECT_EQ( 4u, layout.numComponents() );
+    EXPECT_EQ( sizeof( CompactRenderVert ), layout.sizeInBytes() );
+    layout.clear();
+}
+
+TEST_F( VertexQuantizerTest, normalEncodingTest ) {
+    const glm::vec3 normals[] = {
+        glm::vec3( 0, 0, 1 ), glm::vec3( 0, 0, -1 ), glm::vec3( 1, 0, 0 ), glm::vec3( 0, -1, 0 ),
+        glm::normalize( glm::vec3( 1, 2, 3 ) ), glm::normalize( glm::vec3( -3, 1, -2 ) )
+    };
+    for ( const glm::vec3 &normal : normals ) {
+        i16 encoded[ 2 ];
+        VertexQuantizer::encodeNormal( normal, encoded );
+        const glm::vec3 decoded( VertexQuantizer::decodeNormal( encoded ) );
+        EXPECT_GT( glm::dot( normal, decoded ), 0.9999f );
+    }
+}
+
+TEST_F( VertexQuantizerTest, halfEncodingTest ) {
+    EXPECT_EQ( 0x0000, VertexQuantizer::encodeHalf( 0.0f ) );
+    EXPECT_EQ( 0x3c00, VertexQuantizer::encodeHalf( 1.0f ) );
+    EXPECT_EQ( 0xc000, VertexQuantizer::encodeHalf( -2.0f ) );
+    EXPECT_EQ( 0x7bff, VertexQuantizer::encodeHalf( 65504.0f ) );
+    EXPECT_EQ( 0x7c00, VertexQuantizer::encodeHalf( 1e6f ) );
+    EXPECT_EQ( 0x0001, VertexQuantizer::encodeHalf( 5.9604645e-8f ) );
+
+    const f32 values[] = { 0.25f, 0.333f, -1.5f, 7.125f, 1000.0f, 1e-5f };
+    for ( f32 value : values ) {
+        EXPECT_NEAR( value, VertexQuantizer::decodeHalf( VertexQuantizer::encodeHalf( value ) ), std::fabs( value ) * 0.001f + 6e-8f );
+    }
+}
+
+TEST_F( VertexQuantizerTest, compactTest ) {
+    Geometry *geo( createGeometry() );
+    EXPECT_TRUE( VertexQuantizer::quantize( geo, VertexType::CompactRenderVertex ) );
+    EXPECT_EQ( VertexType::CompactRenderVertex, geo->m_vertextype );
+    EXPECT_FALSE( geo->m_localMatrix );
+    ASSERT_EQ( 3 * sizeof( CompactRenderVert ), geo->m_vb->m_size );
+
+    const CompactRenderVert *vertices( static_cast<const CompactRenderVert*>( geo->m_vb->m_data ) );
+    EXPECT_EQ( glm::vec3( 3, 2, 0.5f ), vertices[ 1 ].position );
+    EXPECT_EQ( 128, vertices[ 1 ].color0[ 0 ] );
+    EXPECT_EQ( 0, vertices[ 1 ].color0[ 1 ] );
+    EXPECT_EQ( 255, vertices[ 1 ].color0[ 2 ] );
+    EXPECT_EQ( 255, vertices[ 1 ].color0[ 3 ] );
+    EXPECT_FLOAT_EQ( 0.25f, VertexQuantizer::decodeHalf( vertices[ 1 ].tex0[ 1 ] ) );
+    EXPECT_FLOAT_EQ( 2.5f, VertexQuantizer::decodeHalf( vertices[ 2 ].tex0[ 0 ] ) );
+    EXPECT_GT( glm::dot( glm::vec3( 0, -1, 0 ), VertexQuantizer::decodeNormal( vertices[ 2 ].normal ) ), 0.9999f );
+
+    // Only render vertices can be converted
+    EXPECT_FALSE( VertexQuantizer::quantize( geo, VertexType::QuantizedRenderVertex ) );
+    Geometry::destroy( &geo );
+}
+
+TEST_F( VertexQuantizerTest, quantizedPositionTest ) {
+    Geometry *geo( createGeometry() );
+    const RenderVert *src( static_cast<const RenderVert*>( geo->m_vb->m_data ) );
+    const glm::vec3 expected[ 3 ] = { src[ 0 ].position, src[ 1 ].position, src[ 2 ].position };
+
+    EXPECT_TRUE( VertexQuantizer::quantize( geo, VertexType::QuantizedRenderVertex ) );
+    EXPECT_EQ( VertexType::QuantizedRenderVertex, geo->m_vertextype );
+    EXPECT_TRUE( geo->m_localMatrix );
+    ASSERT_EQ( 3 * sizeof( QuantizedRenderVert ), geo->m_vb->m_size );
+
+    // Decode like the vertex fetch and the model matrix
+    const QuantizedRenderVert *vertices( static_cast<const QuantizedRenderVert*>( geo->m_vb->m_data ) );
+    for ( ui32 i = 0; i < 3; ++i ) {
+        const glm::vec4 q( vertices[ i ].position[ 0 ] / 65535.0f, vertices[ i ].position[ 1 ] / 65535.0f, 
+                vertices[ i ].position[ 2 ] / 65535.0f, 1.0f );
+        const glm::vec4 pos( geo->m_model * q );
+        EXPECT_NEAR( expected[ i ].x, pos.x, 1e-4f );
+        EXPECT_NEAR( expected[ i ].y, pos.y, 1e-4f );
+        EXPECT_NEAR( expected[ i ].z, pos.z, 1e-4f );
+    }
+    Geometry::destroy( &geo );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,226 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Collision/TriangleBvh.h>
+
+#include <cmath>
+#include <cstdlib>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Collision;
+
+class TriangleBvhTest : public ::testing::Test {
+protected:
+    std::vector<glm::vec3> m_positions;
+    std::vector<ui32> m_indices;
+
+    virtual void SetUp() {
+        // A bumpy grid of 32 x 32 quads in the xy-plane
+        const ui32 size( 33 );
+        for ( ui32 y = 0; y < size; ++y ) {
+            for ( ui32 x = 0; x < size; ++x ) {
+                m_positions.push_back( glm::vec3( x, y, std::sin( x * 0.5f ) * std::cos( y * 0.3f ) ) );
+            }
+        }
+        for ( ui32 y = 0; y + 1 < size; ++y ) {
+            for ( ui32 x = 0; x + 1 < size; ++x ) {
+                const ui32 i( y * size + x );
+                const ui32 quad[ 6 ] = { i, i + 1, i + size + 1, i, i + size + 1, i + size };
+                m_indices.insert( m_indices.end(), quad, quad + 6 );
+            }
+        }
+    }
+
+    bool bruteForce( const Bvh4::Ray &ray, f32 &nearest ) const {
+        bool found( false );
+        nearest = 1e30f;
+        for ( size_t i = 0; i < m_indices.size(); i += 3 ) {
+            const glm::vec3 &v0( m_positions[ m_indices[ i ] ] );
+            f32 t, u, v;
+            if ( TriangleBvh::intersectTriangle( ray.m_origin, ray.m_direction, v0, m_positions[ m_indices[ i + 1 ] ] - v0, 
+                    m_positions[ m_indices[ i + 2 ] ] - v0, t, u, v ) && t < nearest ) {
+                nearest = t;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    static f32 random( f32 minValue, f32 maxValue ) {
+        return minValue + ( maxValue - minValue ) * ( std::rand() / static_cast<f32>( RAND_MAX ) );
+    }
+};
+
+TEST_F( TriangleBvhTest, intersectTriangleTest ) {
+    const glm::vec3 v0( 0, 0, 0 ), e1( 1, 0, 0 ), e2( 0, 1, 0 );
+    f32 t, u, v;
+    EXPECT_TRUE( TriangleBvh::intersectTriangle( glm::vec3( 0.25f, 0.25f, 5 ), glm::vec3( 0, 0, -1 ), v0, e1, e2, t, u, v ) );
+    EXPECT_FLOAT_EQ( 5.0f, t );
+    EXPECT_FLOAT_EQ( 0.25f, u );
+    EXPECT_FLOAT_EQ( 0.25f, v );
+
+    // Back faces will be hit, triangles behind the origin not
+    EXPECT_TRUE( TriangleBvh::intersectTriangle( glm::vec3( 0.25f, 0.25f, -5 ), glm::vec3( 0, 0, 1 ), v0, e1, e2, t, u, v ) );
+    EXPECT_FALSE( TriangleBvh::intersectTriangle( glm::vec3( 0.25f, 0.25f, 5 ), glm::vec3( 0, 0, 1 ), v0, e1, e2, t, u, v ) );
+    EXPECT_FALSE( TriangleBvh::intersectTriangle( glm::vec3( 0.75f, 0.75f, 5 ), glm::vec3( 0, 0, -1 ), v0, e1, e2, t, u, v ) );
+}
+
+TEST_F( TriangleBvhTest, buildTest ) {
+    TriangleBvh bvh;
+    EXPECT_EQ( 0u, bvh.getNumTriangles() );
+    EXPECT_TRUE( bvh.getBvh().isEmpty() );
+
+    bvh.build( &m_positions[ 0 ], static_cast<ui32>( m_positions.size() ), &m_indices[ 0 ], static_cast<ui32>( m_indices.size() ) );
+    EXPECT_EQ( 32u * 32u * 2u, bvh.getNumTriangles() );
+    EXPECT_EQ( bvh.getNumTriangles(), bvh.getBvh().getNumPrimitives() );
+    EXPECT_FALSE( bvh.getBvh().isEmpty() );
+    EXPECT_FLOAT_EQ( 0.0f, bvh.getBvh().getBounds().getMin()[ 0 ] );
+    EXPECT_FLOAT_EQ( 32.0f, bvh.getBvh().getBounds().getMax()[ 1 ] );
+
+    bvh.clear();
+    EXPECT_EQ( 0u, bvh.getNumTriangles() );
+}
+
+TEST_F( TriangleBvhTest, intersectMatchesBruteForceTest ) {
+    TriangleBvh bvh;
+    bvh.build( &m_positions[ 0 ], static_cast<ui32>( m_positions.size() ), &m_indices[ 0 ], static_cast<ui32>( m_indices.size() ) );
+
+    std::srand( 42 );
+    for ( ui32 i = 0; i < 200; ++i ) {
+        const glm::vec3 origin( random( -5, 37 ), random( -5, 37 ), random( 2, 10 ) );
+        const glm::vec3 target( random( 0, 32 ), random( 0, 32 ), 0 );
+        const Bvh4::Ray ray( origin, target - origin );
+
+        f32 expected;
+        const bool expectedHit( bruteForce( ray, expected ) );
+        TriangleBvh::Hit hit;
+        ASSERT_EQ( expectedHit, bvh.intersect( ray, 1e30f, hit ) );
+        if ( expectedHit ) {
+            EXPECT_NEAR( expected, hit.m_distance, 1e-5f );
+            EXPECT_NE( TriangleBvh::InvalidTriangle, hit.m_triangle );
+        }
+    }
+}
+
+TEST_F( TriangleBvhTest, maxDistTest ) {
+    TriangleBvh bvh;
+    bvh.build( &m_positions[ 0 ], static_cast<ui32>( m_positions.size() ), &m_indices[ 0 ], static_cast<ui32>( m_indices.size() ) );
+
+    const Bvh4::Ray ray( glm::vec3( 10.5f, 10.5f, 10 ), glm::vec3( 0, 0, -1 ) );
+    TriangleBvh::Hit hit;
+    EXPECT_TRUE( bvh.intersect( ray, 20.0f, hit ) );
+    EXPECT_FALSE( bvh.intersect( ray, 5.0f, hit ) );
+
+    // Rays along an axis have zero direction components
+    const Bvh4::Ray missRay( glm::vec3( 10.5f, 10.5f, 10 ), glm::vec3( 1, 0, 0 ) );
+    EXPECT_FALSE( bvh.intersect( missRay, 1e30f, hit ) );
+}
+
+TEST_F( TriangleBvhTest, intersectAllTest ) {
+    // Three stacked quads
+    std::vector<glm::vec3> positions;
+    std::vector<ui32> indices;
+    for ( ui32 i = 0; i < 3; ++i ) {
+        const ui32 base( static_cast<ui32>( positions.size() ) );
+        const f32 z( static_cast<f32>( i ) );
+        positions.push_back( glm::vec3( 0, 0, z ) );
+        positions.push_back( glm::vec3( 1, 0, z ) );
+        positions.push_back( glm::vec3( 1, 1, z ) );
+        positions.push_back( glm::vec3( 0, 1, z ) );
+        const ui32 quad[ 6 ] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        indices.insert( indices.end(), quad, quad + 6 );
+    }
+    TriangleBvh bvh;
+    bvh.build( &positions[ 0 ], static_cast<ui32>( positions.size() ), &indices[ 0 ], static_cast<ui32>( indices.size() ) );
+
+    CPPCore::TArray<TriangleBvh::Hit> hits;
+    EXPECT_EQ( 3u, bvh.intersectAll( Bvh4::Ray( glm::vec3( 0.3f, 0.6f, 10 ), glm::vec3( 0, 0, -1 ) ), 1e30f, hits ) );
+    EXPECT_EQ( 2u, bvh.intersectAll( Bvh4::Ray( glm::vec3( 0.3f, 0.6f, 10 ), glm::vec3( 0, 0, -1 ) ), 9.5f, hits ) );
+    EXPECT_EQ( 5u, hits.size() );
+}
+
+TEST_F( TriangleBvhTest, intersectPacketTest ) {
+    TriangleBvh bvh;
+    bvh.build( &m_positions[ 0 ], static_cast<ui32>( m_positions.size() ), &m_indices[ 0 ], static_cast<ui32>( m_indices.size() ) );
+
+    std::srand( 7 );
+    for ( ui32 i = 0; i < 50; ++i ) {
+        Bvh4::RayPacket packet;
+        const ui32 numRays( 1 + i % Bvh4::PacketSize );
+        for ( ui32 j = 0; j < numRays; ++j ) {
+            const glm::vec3 origin( random( -5, 37 ), random( -5, 37 ), random( 2, 10 ) );
+            const glm::vec3 target( random( -2, 34 ), random( -2, 34 ), 0 );
+            EXPECT_TRUE( packet.add( Bvh4::Ray( origin, target - origin ) ) );
+        }
+
+        f32 maxDist[ Bvh4::PacketSize ] = { 1e30f, 1e30f, 1e30f, 1e30f };
+        TriangleBvh::Hit hits[ Bvh4::PacketSize ];
+        bvh.intersectPacket( packet, maxDist, hits );
+        for ( ui32 j = 0; j < numRays; ++j ) {
+            TriangleBvh::Hit hit;
+            const bool expectedHit( bvh.intersect( packet.getRay( j ), 1e30f, hit ) );
+            EXPECT_EQ( expectedHit, TriangleBvh::InvalidTriangle != hits[ j ].m_triangle );
+            if ( expectedHit ) {
+                EXPECT_NEAR( hit.m_distance, hits[ j ].m_distance, 1e-5f );
+            }
+        }
+    }
+}
+
+TEST_F( TriangleBvhTest, invalidTriangleKeepsIndexTest ) {
+    // The first triangle refers to a missing vertex and will be skipped
+    const ui32 indices[ 6 ] = { 0, 1, 99, 0, 1, 2 };
+    const glm::vec3 positions[ 3 ] = { glm::vec3( 0, 0, 0 ), glm::vec3( 1, 0, 0 ), glm::vec3( 0, 1, 0 ) };
+    TriangleBvh bvh;
+    bvh.build( positions, 3, indices, 6 );
+    EXPECT_EQ( 1u, bvh.getNumTriangles() );
+
+    TriangleBvh::Hit hit;
+    ASSERT_TRUE( bvh.intersect( Bvh4::Ray( glm::vec3( 0.25f, 0.25f, 5 ), glm::vec3( 0, 0, -1 ) ), 1e30f, hit ) );
+    EXPECT_EQ( 1u, hit.m_triangle );
+}
+
+TEST_F( TriangleBvhTest, traverseAllLeavesTest ) {
+    // Overlapping boxes, the ray passes all leaves
+    std::vector<Bvh4::AABB> boxes( 4096 );
+    for ( size_t i = 0; i < boxes.size(); ++i ) {
+        boxes[ i ].set( Bvh4::AABB::VecType( 0, 0, 0 ), Bvh4::AABB::VecType( 1, 1, 1 ) );
+    }
+    Bvh4 bvh;
+    bvh.build( &boxes[ 0 ], static_cast<ui32>( boxes.size() ), 1 );
+
+    std::vector<ui32> visits( boxes.size(), 0 );
+    f32 maxDist( 1e30f );
+    bvh.traverse( Bvh4::Ray( glm::vec3( 0.5f, 0.5f, 5 ), glm::vec3( 0, 0, -1 ) ), maxDist, [ &visits ]( ui32 primIdx, f32 & ) {
+        ++visits[ primIdx ];
+        return false;
+    } );
+    for ( size_t i = 0; i < visits.size(); ++i ) {
+        EXPECT_EQ( 1u, visits[ i ] );
+    }
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Common/TResourceCache.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Common;
+
+struct TestResource {
+    String mFilename;
+
+    bool loadFromFile( const String &filename ) {
+        mFilename = filename;
+        return "invalid" != filename;
+    }
+};
+
+class TResourceCacheTest : public ::testing::Test {
+protected:
+    using TestCache = TResourceCache<ui32, TestResource>;
+
+    void add( TestCache &cache, ui32 id, ui64 size ) {
+        std::unique_ptr<TestResource> res( new TestResource );
+        EXPECT_TRUE( cache.insert( id, std::move( res ), size ) );
+    }
+};
+
+TEST_F( TResourceCacheTest, loadTest ) {
+    TestCache cache;
+    EXPECT_TRUE( cache.load( 1, "test.txt" ) );
+    EXPECT_FALSE( cache.load( 2, "invalid" ) );
+    EXPECT_FALSE( cache.load( 1, "test.txt" ) );
+    EXPECT_TRUE( cache.has( 1 ) );
+    EXPECT_FALSE( cache.has( 2 ) );
+    EXPECT_EQ( "test.txt", cache.get( 1 ).mFilename );
+    EXPECT_EQ( sizeof( TestResource ), cache.getMemoryUsage() );
+
+    EXPECT_EQ( nullptr, cache.find( 2 ) );
+    EXPECT_EQ( 1u, cache.getStatistics().mHits );
+    EXPECT_EQ( 1u, cache.getStatistics().mMisses );
+
+    EXPECT_TRUE( cache.remove( 1 ) );
+    EXPECT_EQ( 0u, cache.getNumResources() );
+    EXPECT_EQ( 0u, cache.getMemoryUsage() );
+}
+
+TEST_F( TResourceCacheTest, evictLruTest ) {
+    TestCache cache( 300 );
+    add( cache, 1, 100 );
+    add( cache, 2, 100 );
+    add( cache, 3, 100 );
+    EXPECT_EQ( 300u, cache.getMemoryUsage() );
+
+    // 1 was used recently, so 2 is the least recently used one
+    EXPECT_NE( nullptr, cache.find( 1 ) );
+    add( cache, 4, 100 );
+    EXPECT_TRUE( cache.has( 1 ) );
+    EXPECT_FALSE( cache.has( 2 ) );
+    EXPECT_TRUE( cache.has( 3 ) );
+    EXPECT_TRUE( cache.has( 4 ) );
+    EXPECT_EQ( 1u, cache.getStatistics().mEvictions );
+    EXPECT_EQ( 300u, cache.getMemoryUsage() );
+
+    cache.setBudget( 100 );
+    EXPECT_EQ( 1u, cache.getNumResources() );
+    EXPECT_TRUE( cache.has( 4 ) );
+    EXPECT_EQ( 3u, cache.getStatistics().mEvictions );
+}
+
+TEST_F( TResourceCacheTest, referencedTest ) {
+    TestCache cache( 200 );
+    add( cache, 1, 100 );
+    add( cache, 2, 100 );
+    EXPECT_TRUE( cache.addRef( 1 ) );
+    EXPECT_FALSE( cache.addRef( 5 ) );
+
+    // 1 is the least recently used, but referenced
+    add( cache, 3, 100 );
+    EXPECT_TRUE( cache.has( 1 ) );
+    EXPECT_FALSE( cache.has( 2 ) );
+
+    // Nothing can be evicted, the cache exceeds the budget until a resource gets released
+    EXPECT_TRUE( cache.addRef( 3 ) );
+    add( cache, 4, 100 );
+    EXPECT_EQ( 300u, cache.getMemoryUsage() );
+    EXPECT_TRUE( cache.addRef( 4 ) );
+    EXPECT_TRUE( cache.release( 1 ) );
+    EXPECT_FALSE( cache.release( 1 ) );
+    EXPECT_EQ( 200u, cache.getMemoryUsage() );
+    EXPECT_FALSE( cache.has( 1 ) );
+    EXPECT_TRUE( cache.has( 3 ) );
+    EXPECT_TRUE( cache.has( 4 ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,159 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/IOService.h>
+#include <osre/IO/Uri.h>
+#include "src/Engine/IO/AccessTrace.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class AccessTraceTest : public ::testing::Test {
+protected:
+    String m_traceFile;
+    std::vector<String> m_files;
+
+    virtual void SetUp() {
+        m_traceFile = "access_trace_test.trace";
+        for ( ui32 i = 0; i < 3; ++i ) {
+            m_files.push_back( "access_trace_test" + std::to_string( i ) + ".bin" );
+            std::vector<uc8> content( 10000 * ( i + 1 ), static_cast<uc8>( i ) );
+            FILE *file( ::fopen( m_files.back().c_str(), "wb" ) );
+            ::fwrite( &content[ 0 ], 1, content.size(), file );
+            ::fclose( file );
+        }
+    }
+
+    virtual void TearDown() {
+        ::remove( m_traceFile.c_str() );
+        for ( const String &file : m_files ) {
+            ::remove( file.c_str() );
+        }
+    }
+
+    static AccessTrace::Entry makeEntry( const String &path, ui64 offset, ui64 size, ui32 time ) {
+        AccessTrace::Entry entry;
+        entry.m_path = path;
+        entry.m_offset = offset;
+        entry.m_size = size;
+        entry.m_time = time;
+        return entry;
+    }
+};
+
+TEST_F( AccessTraceTest, mergeTest ) {
+    std::vector<AccessTrace::Entry> entries;
+    entries.push_back( makeEntry( "b", 100, 50, 5 ) );
+    entries.push_back( makeEntry( "a", 0, 10, 3 ) );
+    entries.push_back( makeEntry( "b", 0, 100, 7 ) );
+    entries.push_back( makeEntry( "b", 1000, 10, 1 ) );
+    entries.push_back( makeEntry( "c", 50, 0, 9 ) );
+    entries.push_back( makeEntry( "c", 70, 10, 2 ) );
+    AccessTrace::merge( entries );
+
+    ASSERT_EQ( 4u, entries.size() );
+    EXPECT_EQ( "a", entries[ 0 ].m_path );
+    EXPECT_EQ( "b", entries[ 1 ].m_path );
+    EXPECT_EQ( 0u, entries[ 1 ].m_offset );
+    EXPECT_EQ( 150u, entries[ 1 ].m_size );
+    EXPECT_EQ( 5u, entries[ 1 ].m_time );
+    EXPECT_EQ( 1000u, entries[ 2 ].m_offset );
+    EXPECT_EQ( "c", entries[ 3 ].m_path );
+    EXPECT_EQ( 50u, entries[ 3 ].m_offset );
+    EXPECT_EQ( 0u, entries[ 3 ].m_size );
+    EXPECT_EQ( 2u, entries[ 3 ].m_time );
+}
+
+TEST_F( AccessTraceTest, saveLoadTest ) {
+    AccessTrace trace;
+    trace.record( m_files[ 0 ], 0, 0 );
+    EXPECT_FALSE( trace.isRecording() );
+
+    trace.startRecording();
+    trace.record( m_files[ 0 ], 0, 0 );
+    trace.record( m_files[ 1 ], 500, 1000 );
+    trace.record( m_files[ 0 ], 0, 0 );
+    EXPECT_TRUE( trace.save( m_traceFile ) );
+
+    std::vector<AccessTrace::Entry> entries;
+    EXPECT_TRUE( AccessTrace::load( m_traceFile, entries ) );
+    ASSERT_EQ( 2u, entries.size() );
+    EXPECT_EQ( m_files[ 0 ], entries[ 0 ].m_path );
+    EXPECT_EQ( 0u, entries[ 0 ].m_size );
+    EXPECT_EQ( m_files[ 1 ], entries[ 1 ].m_path );
+    EXPECT_EQ( 500u, entries[ 1 ].m_offset );
+    EXPECT_EQ( 1000u, entries[ 1 ].m_size );
+
+    EXPECT_FALSE( AccessTrace::load( m_files[ 0 ], entries ) );
+    EXPECT_TRUE( entries.empty() );
+}
+
+TEST_F( AccessTraceTest, prefetchTest ) {
+    std::vector<AccessTrace::Entry> entries;
+    entries.push_back( makeEntry( m_files[ 0 ], 0, 0, 0 ) );
+    entries.push_back( makeEntry( m_files[ 1 ], 5000, 1000, 1 ) );
+    entries.push_back( makeEntry( m_files[ 2 ], 29000, 5000, 2 ) );
+    entries.push_back( makeEntry( "access_trace_test_missing.bin", 0, 0, 3 ) );
+
+    AccessTrace trace;
+    trace.startPrefetch( entries, 1024 * 1024 );
+    trace.waitForPrefetch();
+    EXPECT_EQ( 10000u + 1000u + 1000u, trace.getNumPrefetchedBytes() );
+
+    // The budget limits the prefetch
+    trace.startPrefetch( entries, 5000 );
+    trace.waitForPrefetch();
+    EXPECT_EQ( 5000u, trace.getNumPrefetchedBytes() );
+}
+
+TEST_F( AccessTraceTest, ioServiceTest ) {
+    IOService *ioSrv( IOService::create() );
+    EXPECT_TRUE( ioSrv->open() );
+    EXPECT_FALSE( ioSrv->enableAccessTrace( m_traceFile ) );
+
+    Stream *stream( ioSrv->openStream( Uri( "file://" + m_files[ 2 ] ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, stream );
+    ioSrv->closeStream( &stream );
+    std::vector<uc8> buffer( 100 );
+    EXPECT_EQ( 100u, ioSrv->readAsync( Uri( "file://" + m_files[ 1 ] ), 200, 100, &buffer[ 0 ] ).get() );
+    EXPECT_TRUE( ioSrv->close() );
+    delete ioSrv;
+
+    // The next run finds the trace and prefetches it
+    ioSrv = IOService::create();
+    EXPECT_TRUE( ioSrv->open() );
+    EXPECT_TRUE( ioSrv->enableAccessTrace( m_traceFile ) );
+    EXPECT_TRUE( ioSrv->close() );
+    delete ioSrv;
+
+    std::vector<AccessTrace::Entry> entries;
+    EXPECT_TRUE( AccessTrace::load( m_traceFile, entries ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
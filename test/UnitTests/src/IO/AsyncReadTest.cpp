@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/IOService.h>
+#include <osre/IO/Uri.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class AsyncReadTest : public ::testing::Test {
+protected:
+    IOService *m_ioSrv;
+    String m_filename;
+
+    virtual void SetUp() {
+        m_ioSrv = IOService::create();
+        m_ioSrv->open();
+        m_filename = "async_read_test.bin";
+
+        std::vector<uc8> content( 64 * 1024 );
+        for ( size_t i = 0; i < content.size(); ++i ) {
+            content[ i ] = static_cast<uc8>( i % 251 );
+        }
+        FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+        ::fwrite( &content[ 0 ], 1, content.size(), file );
+        ::fclose( file );
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+        m_ioSrv->close();
+        delete m_ioSrv;
+    }
+
+    static bool checkRange( const uc8 *data, ui32 offset, ui32 size ) {
+        for ( ui32 i = 0; i < size; ++i ) {
+            if ( data[ i ] != static_cast<uc8>( ( offset + i ) % 251 ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+TEST_F( AsyncReadTest, readFutureTest ) {
+    std::vector<uc8> buffer( 1000 );
+    std::future<ui32> result( m_ioSrv->readAsync( Uri( "file://" + m_filename ), 5000, 1000, &buffer[ 0 ] ) );
+    EXPECT_EQ( 1000u, result.get() );
+    EXPECT_TRUE( checkRange( &buffer[ 0 ], 5000, 1000 ) );
+
+    // Reads at the end of the file are short
+    result = m_ioSrv->readAsync( Uri( "file://" + m_filename ), 64 * 1024 - 10, 1000, &buffer[ 0 ] );
+    EXPECT_EQ( 10u, result.get() );
+    EXPECT_TRUE( checkRange( &buffer[ 0 ], 64 * 1024 - 10, 10 ) );
+
+    result = m_ioSrv->readAsync( Uri( "file://async_read_missing.bin" ), 0, 1000, &buffer[ 0 ] );
+    EXPECT_EQ( 0u, result.get() );
+}
+
+TEST_F( AsyncReadTest, coalesceBatchTest ) {
+    static const ui32 NumReads = 16;
+    static const ui32 ReadSize = 1024;
+    std::vector<std::vector<uc8>> buffers( NumReads, std::vector<uc8>( ReadSize ) );
+    std::atomic<ui32> numOk( 0 );
+
+    m_ioSrv->beginReadBatch();
+    for ( ui32 i = 0; i < NumReads; ++i ) {
+        // Every second range is read, the gaps are small enough to read them all at once
+        m_ioSrv->readAsync( Uri( "file://" + m_filename ), i * 2 * ReadSize, ReadSize, &buffers[ i ][ 0 ], 
+                [ &numOk ]( bool ok, ui32 bytesRead ) {
+            if ( ok && ReadSize == bytesRead ) {
+                ++numOk;
+            }
+        } );
+    }
+    m_ioSrv->endReadBatch();
+    m_ioSrv->waitForReads();
+
+    EXPECT_EQ( NumReads, numOk.load() );
+    for ( ui32 i = 0; i < NumReads; ++i ) {
+        EXPECT_TRUE( checkRange( &buffers[ i ][ 0 ], i * 2 * ReadSize, ReadSize ) );
+    }
+
+    ui64 numRequests( 0 ), numReads( 0 );
+    m_ioSrv->getReadStatistics( numRequests, numReads );
+    EXPECT_EQ( NumReads, numRequests );
+    EXPECT_LT( numReads, numRequests );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,240 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/FileMetadataCache.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <sys/stat.h>
+#ifdef OSRE_WINDOWS
+#   include <direct.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class FileMetadataCacheTest : public ::testing::Test {
+protected:
+    String m_root;
+
+    virtual void SetUp() {
+        m_root = "metadata_cache_test";
+        makeDir( m_root );
+        makeDir( m_root + "/textures" );
+        makeDir( m_root + "/meshes" );
+        makeDir( m_root + "/meshes/lod" );
+        writeFile( m_root + "/config.txt", 10 );
+        writeFile( m_root + "/textures/stone.png", 100 );
+        writeFile( m_root + "/meshes/box.obj", 200 );
+        writeFile( m_root + "/meshes/lod/box1.obj", 50 );
+    }
+
+    virtual void TearDown() {
+        const char *files[] = { "/config.txt", "/textures/stone.png", "/meshes/box.obj", "/meshes/lod/box1.obj", 
+            "/new.txt" };
+        for ( const char *file : files ) {
+            ::remove( ( m_root + file ).c_str() );
+        }
+        removeDir( m_root + "/meshes/lod" );
+        removeDir( m_root + "/meshes" );
+        removeDir( m_root + "/textures" );
+        removeDir( m_root );
+    }
+
+    static void makeDir( const String &path ) {
+#ifdef OSRE_WINDOWS
+        ::_mkdir( path.c_str() );
+#else
+        ::mkdir( path.c_str(), 0755 );
+#endif
+    }
+
+    static void removeDir( const String &path ) {
+#ifdef OSRE_WINDOWS
+        ::_rmdir( path.c_str() );
+#else
+        ::rmdir( path.c_str() );
+#endif
+    }
+
+    static void writeFile( const String &path, size_t size ) {
+        FILE *file( ::fopen( path.c_str(), "wb" ) );
+        ASSERT_NE( nullptr, file );
+        for ( size_t i = 0; i < size; ++i ) {
+            ::fputc( 'x', file );
+        }
+        ::fclose( file );
+    }
+
+    // Waits for the watcher to add or remove entries
+    static bool waitForEntries( const FileMetadataCache &cache, size_t expected ) {
+        for ( ui32 i = 0; i < 200; ++i ) {
+            if ( expected == cache.getNumEntries() ) {
+                return true;
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+        return false;
+    }
+};
+
+TEST_F( FileMetadataCacheTest, normalizePathTest ) {
+    EXPECT_EQ( "a/b/c.txt", FileMetadataCache::normalizePath( "./a//b/./c.txt" ) );
+    EXPECT_EQ( "a/b", FileMetadataCache::normalizePath( "a\\b\\" ) );
+    EXPECT_EQ( "/usr/share", FileMetadataCache::normalizePath( "/usr//share/" ) );
+    EXPECT_EQ( "/", FileMetadataCache::normalizePath( "/" ) );
+    EXPECT_EQ( "", FileMetadataCache::normalizePath( "./" ) );
+}
+
+TEST_F( FileMetadataCacheTest, statTest ) {
+    FileMetadataCache cache;
+    EXPECT_FALSE( cache.addRoot( m_root + "/config.txt" ) );
+    EXPECT_TRUE( cache.addRoot( m_root ) );
+
+    // The root, 3 directories and 4 files
+    EXPECT_EQ( 8u, cache.getNumEntries() );
+
+    FileMetadataCache::FileInfo info;
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( m_root + "/meshes/lod/box1.obj", &info ) );
+    EXPECT_EQ( 50u, info.m_size );
+    EXPECT_FALSE( info.m_isDirectory );
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( "./" + m_root + "//textures/stone.png", &info ) );
+    EXPECT_EQ( 100u, info.m_size );
+    EXPECT_GT( info.m_modified, 0 );
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( m_root + "/meshes/", &info ) );
+    EXPECT_TRUE( info.m_isDirectory );
+
+    EXPECT_EQ( FileMetadataCache::Lookup::Missing, cache.stat( m_root + "/meshes/sphere.obj" ) );
+    EXPECT_EQ( FileMetadataCache::Lookup::NotCovered, cache.stat( m_root + "_other/file.txt" ) );
+    EXPECT_EQ( FileMetadataCache::Lookup::NotCovered, cache.stat( "config.txt" ) );
+
+    cache.removeRoot( m_root );
+    EXPECT_EQ( 0u, cache.getNumEntries() );
+    EXPECT_EQ( FileMetadataCache::Lookup::NotCovered, cache.stat( m_root + "/config.txt" ) );
+}
+
+TEST_F( FileMetadataCacheTest, updateTest ) {
+    FileMetadataCache cache;
+    EXPECT_TRUE( cache.addRoot( m_root ) );
+
+    const String newFile( m_root + "/new.txt" );
+    writeFile( newFile, 30 );
+    cache.update( newFile );
+    FileMetadataCache::FileInfo info;
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( newFile, &info ) );
+    EXPECT_EQ( 30u, info.m_size );
+
+    ::remove( newFile.c_str() );
+    cache.update( newFile );
+    EXPECT_EQ( FileMetadataCache::Lookup::Missing, cache.stat( newFile ) );
+
+    writeFile( newFile, 5 );
+    cache.refresh();
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( newFile ) );
+}
+
+TEST_F( FileMetadataCacheTest, watchTest ) {
+    FileMetadataCache cache;
+    std::vector<std::pair<String, FileMetadataCache::Change>> changes;
+    const ui32 id( cache.addListener( [ &changes ]( const String &path, FileMetadataCache::Change change ) {
+        changes.push_back( std::make_pair( path, change ) );
+    } ) );
+
+    // The watcher is started with the first root
+    EXPECT_FALSE( cache.isWatching() );
+    EXPECT_TRUE( cache.addRoot( m_root ) );
+    if ( !cache.isWatching() ) {
+        return;
+    }
+
+    const size_t numEntries( cache.getNumEntries() );
+    const String newFile( m_root + "/meshes/lod/new.txt" );
+    writeFile( newFile, 20 );
+    EXPECT_TRUE( waitForEntries( cache, numEntries + 1 ) );
+    ::remove( newFile.c_str() );
+    EXPECT_TRUE( waitForEntries( cache, numEntries ) );
+    EXPECT_EQ( FileMetadataCache::Lookup::Missing, cache.stat( newFile ) );
+
+    // Listeners are only called by dispatchChanges
+    EXPECT_TRUE( changes.empty() );
+    cache.dispatchChanges();
+    ASSERT_FALSE( changes.empty() );
+    EXPECT_EQ( newFile, changes.front().first );
+    EXPECT_EQ( FileMetadataCache::Change::Created, changes.front().second );
+    EXPECT_EQ( newFile, changes.back().first );
+    EXPECT_EQ( FileMetadataCache::Change::Removed, changes.back().second );
+
+    cache.removeListener( id );
+}
+
+TEST_F( FileMetadataCacheTest, refreshTest ) {
+    FileMetadataCache cache;
+    EXPECT_TRUE( cache.addRoot( m_root ) );
+    const size_t numEntries( cache.getNumEntries() );
+    cache.refresh();
+    EXPECT_EQ( numEntries, cache.getNumEntries() );
+    if ( !cache.isWatching() ) {
+        return;
+    }
+
+    // The directories are still watched after the rescan
+    const String newFile( m_root + "/meshes/lod/new.txt" );
+    writeFile( newFile, 20 );
+    EXPECT_TRUE( waitForEntries( cache, numEntries + 1 ) );
+    ::remove( newFile.c_str() );
+    EXPECT_TRUE( waitForEntries( cache, numEntries ) );
+}
+
+TEST_F( FileMetadataCacheTest, uncachedFileTest ) {
+    FileMetadataCache cache;
+    EXPECT_TRUE( cache.addRoot( m_root ) );
+
+    // Found before the watcher has reported it
+    const String newFile( m_root + "/new.txt" );
+    writeFile( newFile, 12 );
+    FileMetadataCache::FileInfo info;
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( newFile, &info ) );
+    EXPECT_EQ( 12u, info.m_size );
+    ::remove( newFile.c_str() );
+}
+
+TEST_F( FileMetadataCacheTest, deferredRootTest ) {
+    FileMetadataCache cache;
+    cache.addRootDeferred( m_root );
+    cache.addRootDeferred( m_root );
+    cache.addRootDeferred( m_root + "/config.txt" );
+    cache.waitForScans();
+
+    EXPECT_EQ( 8u, cache.getNumEntries() );
+    EXPECT_EQ( FileMetadataCache::Lookup::Found, cache.stat( m_root + "/meshes/lod/box1.obj" ) );
+    EXPECT_EQ( FileMetadataCache::Lookup::Missing, cache.stat( m_root + "/meshes/sphere.obj" ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
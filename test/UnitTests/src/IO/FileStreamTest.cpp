@@ -0,0 +1,148 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/IOService.h>
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+#include "src/Engine/IO/FileStream.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class FileStreamTest : public ::testing::Test {
+protected:
+    String m_filename;
+
+    virtual void SetUp() {
+        m_filename = "file_stream_test.bin";
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+    }
+};
+
+TEST_F( FileStreamTest, seekTellTest ) {
+    FileStream stream( Uri( "file://" + m_filename ), Stream::AccessMode::WriteAccessBinary );
+    ASSERT_TRUE( stream.open() );
+    EXPECT_EQ( 10u, stream.write( "0123456789", 10 ) );
+    EXPECT_EQ( 4u, stream.seek( 4, Stream::Origin::Begin ) );
+    EXPECT_EQ( 6u, stream.seek( 2, Stream::Origin::Current ) );
+    EXPECT_EQ( 7u, stream.seek( -3, Stream::Origin::End ) );
+    EXPECT_EQ( 7u, stream.tell() );
+
+    // Positional reads leave the position alone
+    c8 buffer[ 4 ] = { 0 };
+    EXPECT_EQ( 0u, stream.readAt( 1, buffer, 3 ) );
+    stream.close();
+
+    FileStream reader( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary );
+    ASSERT_TRUE( reader.open() );
+    EXPECT_EQ( 3u, reader.readAt( 1, buffer, 3 ) );
+    EXPECT_STREQ( "123", buffer );
+    EXPECT_EQ( 0u, reader.tell() );
+    EXPECT_EQ( 2u, reader.readAt( 8, buffer, 3 ) );
+}
+
+TEST_F( FileStreamTest, bufferedReadTest ) {
+    static const ui32 NumValues = 10000;
+    {
+        FileStream stream( Uri( "file://" + m_filename ), Stream::AccessMode::WriteAccessBinary );
+        ASSERT_TRUE( stream.open() );
+        for ( ui32 i = 0; i < NumValues; ++i ) {
+            EXPECT_EQ( sizeof( ui32 ), stream.writeUI32( i ) );
+        }
+        EXPECT_EQ( sizeof( f32 ), stream.writeF32( 1.5f ) );
+    }
+
+    // A small buffer, so reads and seeks cross its borders
+    FileStream stream( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary );
+    stream.setBufferSize( 1000 );
+    ASSERT_TRUE( stream.open() );
+    EXPECT_EQ( NumValues * sizeof( ui32 ) + sizeof( f32 ), stream.getSize() );
+
+    ui32 value( 0 );
+    bool ok( true );
+    for ( ui32 i = 0; i < 500; ++i ) {
+        ok = ok && sizeof( ui32 ) == stream.readUI32( value ) && i == value;
+    }
+    EXPECT_TRUE( ok );
+    EXPECT_EQ( 500u * sizeof( ui32 ), stream.tell() );
+
+    // Back inside the buffer and far beyond it
+    EXPECT_EQ( 499u * sizeof( ui32 ), stream.seek( -4, Stream::Origin::Current ) );
+    stream.readUI32( value );
+    EXPECT_EQ( 499u, value );
+    EXPECT_EQ( 9000u * sizeof( ui32 ), stream.seek( 9000 * sizeof( ui32 ), Stream::Origin::Begin ) );
+    stream.readUI32( value );
+    EXPECT_EQ( 9000u, value );
+
+    // Bulk reads larger than the buffer
+    std::vector<ui32> values( 998 );
+    EXPECT_EQ( 998u, stream.readArray( &values[ 0 ], 998 ) );
+    EXPECT_EQ( 9001u, values[ 0 ] );
+    EXPECT_EQ( 9998u, values[ 997 ] );
+    EXPECT_EQ( 1u, stream.readArray( &values[ 0 ], 1, true ) );
+    EXPECT_EQ( 0x0F270000u, values[ 0 ] );
+    f32 f( 0 );
+    EXPECT_EQ( sizeof( f32 ), stream.readF32( f ) );
+    EXPECT_EQ( 1.5f, f );
+    EXPECT_EQ( 0u, stream.readArray( &values[ 0 ], 10 ) );
+    EXPECT_EQ( stream.getSize(), stream.tell() );
+}
+
+#ifndef OSRE_WINDOWS
+// A sparse file is used, which costs no disk space on unix file systems
+TEST_F( FileStreamTest, largeFileTest ) {
+    const Stream::Position Pos( 5ull * 1024 * 1024 * 1024 );
+    {
+        FileStream stream( Uri( "file://" + m_filename ), Stream::AccessMode::WriteAccessBinary );
+        ASSERT_TRUE( stream.open() );
+        EXPECT_EQ( Pos, stream.seek( static_cast<Stream::Offset>( Pos ), Stream::Origin::Begin ) );
+        EXPECT_EQ( 4u, stream.write( "osre", 4 ) );
+        EXPECT_EQ( Pos + 4, stream.tell() );
+    }
+
+    FileStream stream( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary );
+    ASSERT_TRUE( stream.open() );
+    EXPECT_EQ( Pos + 4, stream.getSize() );
+
+    c8 buffer[ 5 ] = { 0 };
+    EXPECT_EQ( 4u, stream.readAt( Pos, buffer, 4 ) );
+    EXPECT_STREQ( "osre", buffer );
+
+    ::memset( buffer, 0, sizeof( buffer ) );
+    EXPECT_EQ( Pos, stream.seek( -4, Stream::Origin::End ) );
+    EXPECT_EQ( 4u, stream.read( buffer, 4 ) );
+    EXPECT_STREQ( "osre", buffer );
+}
+#endif
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/MemoryStream.h>
+#include <osre/Threading/ThreadPool.h>
+#include "src/Engine/IO/ImageCodec.h"
+
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class ImageCodecTest : public ::testing::Test {
+protected:
+    // An RGBA test image with odd sizes, so the vector loops leave a tail
+    static std::vector<uc8> createImage( ui32 width, ui32 height, ui32 seed ) {
+        std::vector<uc8> pixels( width * height * 4 );
+        for ( size_t i = 0; i < pixels.size(); ++i ) {
+            pixels[ i ] = static_cast<uc8>( ( i * 7 + seed * 13 + i / 5 ) & 0xFF );
+        }
+        return pixels;
+    }
+
+    static std::vector<uc8> encode( const std::vector<uc8> &pixels, ui32 width, ui32 height, 
+            ImageCodec::PixelFormat format ) {
+        MemoryStream stream;
+        EXPECT_TRUE( ImageCodec::encodeImage( &stream, &pixels[ 0 ], width, height, format ) );
+        ui64 size( 0 );
+        const uc8 *data( stream.map( size ) );
+        return std::vector<uc8>( data, data + size );
+    }
+};
+
+TEST_F( ImageCodecTest, convertTest ) {
+    // Every color and alpha value once
+    std::vector<uc8> src( 256 * 256 * 4 );
+    for ( ui32 a = 0; a < 256; ++a ) {
+        for ( ui32 c = 0; c < 256; ++c ) {
+            uc8 *pixel( &src[ ( a * 256 + c ) * 4 ] );
+            pixel[ 0 ] = static_cast<uc8>( c );
+            pixel[ 1 ] = static_cast<uc8>( 255 - c );
+            pixel[ 2 ] = static_cast<uc8>( c / 2 );
+            pixel[ 3 ] = static_cast<uc8>( a );
+        }
+    }
+    std::vector<uc8> dst( src.size() );
+    ImageCodec::convertPixels( &src[ 0 ], 4, &dst[ 0 ], ImageCodec::PixelFormat::BGRA, 256 * 256, true );
+    for ( size_t i = 0; i < src.size(); i += 4 ) {
+        const ui32 a( src[ i + 3 ] );
+        EXPECT_EQ( ( 2 * src[ i + 2 ] * a + 255 ) / 510, dst[ i + 0 ] );
+        EXPECT_EQ( ( 2 * src[ i + 1 ] * a + 255 ) / 510, dst[ i + 1 ] );
+        EXPECT_EQ( ( 2 * src[ i + 0 ] * a + 255 ) / 510, dst[ i + 2 ] );
+        EXPECT_EQ( a, dst[ i + 3 ] );
+    }
+
+    // RGB to RGBA and BGRA
+    static const ui32 NumPixels = 13;
+    uc8 rgb[ NumPixels * 3 ];
+    for ( ui32 i = 0; i < NumPixels * 3; ++i ) {
+        rgb[ i ] = static_cast<uc8>( i + 1 );
+    }
+    uc8 rgba[ NumPixels * 4 ], bgra[ NumPixels * 4 ];
+    ImageCodec::convertPixels( rgb, 3, rgba, ImageCodec::PixelFormat::RGBA, NumPixels, false );
+    ImageCodec::convertPixels( rgb, 3, bgra, ImageCodec::PixelFormat::BGRA, NumPixels, false );
+    for ( ui32 i = 0; i < NumPixels; ++i ) {
+        EXPECT_EQ( rgb[ i * 3 + 0 ], rgba[ i * 4 + 0 ] );
+        EXPECT_EQ( rgb[ i * 3 + 1 ], rgba[ i * 4 + 1 ] );
+        EXPECT_EQ( rgb[ i * 3 + 2 ], rgba[ i * 4 + 2 ] );
+        EXPECT_EQ( 255, rgba[ i * 4 + 3 ] );
+        EXPECT_EQ( rgb[ i * 3 + 2 ], bgra[ i * 4 + 0 ] );
+        EXPECT_EQ( rgb[ i * 3 + 0 ], bgra[ i * 4 + 2 ] );
+        EXPECT_EQ( 255, bgra[ i * 4 + 3 ] );
+    }
+}
+
+TEST_F( ImageCodecTest, encodeDecodeTest ) {
+    static const ui32 Width = 37, Height = 11;
+    const std::vector<uc8> pixels( createImage( Width, Height, 1 ) );
+    const std::vector<uc8> tga( encode( pixels, Width, Height, ImageCodec::PixelFormat::RGBA ) );
+
+    ImageCodec::ImageInfo info;
+    EXPECT_TRUE( ImageCodec::getInfo( &tga[ 0 ], static_cast<ui32>( tga.size() ), info ) );
+    EXPECT_EQ( Width, info.m_width );
+    EXPECT_EQ( Height, info.m_height );
+
+    std::vector<uc8> decoded;
+    EXPECT_TRUE( ImageCodec::decodeImage( &tga[ 0 ], static_cast<ui32>( tga.size() ), ImageCodec::PixelFormat::RGBA, 
+            0, decoded, info ) );
+    EXPECT_EQ( pixels, decoded );
+
+    // Flipped into a buffer of the caller
+    std::vector<uc8> flipped( pixels.size() );
+    EXPECT_TRUE( ImageCodec::decodeImage( &tga[ 0 ], static_cast<ui32>( tga.size() ), ImageCodec::PixelFormat::RGBA, 
+            ImageCodec::FlipVertical, &flipped[ 0 ], flipped.size(), info ) );
+    ImageCodec::flipVertical( &flipped[ 0 ], Width, Height, ImageCodec::PixelFormat::RGBA );
+    EXPECT_EQ( pixels, flipped );
+
+    // A too small buffer is refused
+    EXPECT_FALSE( ImageCodec::decodeImage( &tga[ 0 ], static_cast<ui32>( tga.size() ), ImageCodec::PixelFormat::RGBA, 
+            0, &flipped[ 0 ], flipped.size() - 1, info ) );
+
+    // 24 bit TGA, expanded from RGB
+    std::vector<uc8> rgb( Width * Height * 3 );
+    ImageCodec::convertPixels( &pixels[ 0 ], 4, &rgb[ 0 ], ImageCodec::PixelFormat::RGB, Width * Height, false );
+    const std::vector<uc8> tga24( encode( rgb, Width, Height, ImageCodec::PixelFormat::RGB ) );
+    MemoryStream stream( &tga24[ 0 ], tga24.size() );
+    EXPECT_TRUE( ImageCodec::decodeImage( &stream, ImageCodec::PixelFormat::BGRA, 0, decoded, info ) );
+    ASSERT_EQ( pixels.size(), decoded.size() );
+    for ( size_t i = 0; i < pixels.size(); i += 4 ) {
+        EXPECT_EQ( pixels[ i + 2 ], decoded[ i + 0 ] );
+        EXPECT_EQ( pixels[ i + 1 ], decoded[ i + 1 ] );
+        EXPECT_EQ( pixels[ i + 0 ], decoded[ i + 2 ] );
+        EXPECT_EQ( 255, decoded[ i + 3 ] );
+    }
+
+    EXPECT_FALSE( ImageCodec::decodeImage( &tga[ 0 ], 10, ImageCodec::PixelFormat::RGBA, 0, decoded, info ) );
+}
+
+TEST_F( ImageCodecTest, decodeBatchTest ) {
+    static const ui32 NumImages = 16;
+    std::vector<std::vector<uc8>> images, tgas, pixels( NumImages );
+    std::vector<ImageCodec::DecodeJob> jobs( NumImages );
+    for ( ui32 i = 0; i < NumImages; ++i ) {
+        const ui32 width( 20 + i ), height( 9 + i );
+        images.push_back( createImage( width, height, i ) );
+        tgas.push_back( encode( images.back(), width, height, ImageCodec::PixelFormat::RGBA ) );
+        pixels[ i ].resize( images.back().size() );
+        jobs[ i ].m_data = &tgas[ i ][ 0 ];
+        jobs[ i ].m_size = static_cast<ui32>( tgas[ i ].size() );
+        jobs[ i ].m_pixels = &pixels[ i ][ 0 ];
+        jobs[ i ].m_capacity = pixels[ i ].size();
+        jobs[ i ].m_ok = false;
+    }
+
+    Threading::ThreadPool pool( 4 );
+    ImageCodec::decodeBatch( &jobs[ 0 ], NumImages, ImageCodec::PixelFormat::RGBA, 0, pool );
+    for ( ui32 i = 0; i < NumImages; ++i ) {
+        EXPECT_TRUE( jobs[ i ].m_ok );
+        EXPECT_EQ( 20 + i, jobs[ i ].m_info.m_width );
+        EXPECT_EQ( images[ i ], pixels[ i ] );
+    }
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,130 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/IOService.h>
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class MappedFileStreamTest : public ::testing::Test {
+protected:
+    IOService *m_ioSrv;
+    String m_filename;
+
+    virtual void SetUp() {
+        m_ioSrv = IOService::create();
+        m_ioSrv->open();
+        m_filename = "mapped_file_stream_test.bin";
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+        m_ioSrv->close();
+        delete m_ioSrv;
+    }
+
+    void writeFile( const String &content ) {
+        FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+        ::fwrite( content.c_str(), 1, content.size(), file );
+        ::fclose( file );
+    }
+};
+
+TEST_F( MappedFileStreamTest, mapTest ) {
+    writeFile( "0123456789" );
+    Stream *stream( m_ioSrv->openStream( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, stream );
+    EXPECT_TRUE( stream->canBeMapped() );
+    EXPECT_FALSE( stream->canWrite() );
+    EXPECT_EQ( 10u, stream->getSize() );
+
+    ui64 size( 0 );
+    const uc8 *data( stream->map( size ) );
+    ASSERT_NE( nullptr, data );
+    EXPECT_EQ( 10u, size );
+    EXPECT_EQ( 0, ::memcmp( data, "0123456789", 10 ) );
+
+    c8 buffer[ 8 ] = { 0 };
+    EXPECT_EQ( 4u, stream->seek( 4, Stream::Origin::Begin ) );
+    EXPECT_EQ( 6u, stream->read( buffer, 7 ) );
+    EXPECT_STREQ( "456789", buffer );
+    EXPECT_EQ( 10u, stream->tell() );
+    m_ioSrv->closeStream( &stream );
+}
+
+TEST_F( MappedFileStreamTest, emptyFileTest ) {
+    // Empty files cannot be mapped, a plain file stream is used instead
+    writeFile( "" );
+    Stream *stream( m_ioSrv->openStream( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, stream );
+    EXPECT_FALSE( stream->canBeMapped() );
+    EXPECT_EQ( 0u, stream->getSize() );
+    m_ioSrv->closeStream( &stream );
+}
+
+#ifndef OSRE_WINDOWS
+// The locale file system serves binary reads from a mapping, a sparse file costs no disk space
+TEST_F( MappedFileStreamTest, largeFileTest ) {
+    if ( sizeof( void* ) < 8 ) {
+        return;
+    }
+
+    const Stream::Position Pos( 5ull * 1024 * 1024 * 1024 );
+    FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+    ASSERT_NE( nullptr, file );
+    ASSERT_EQ( 0, ::fseeko( file, static_cast<off_t>( Pos ), SEEK_SET ) );
+    ::fwrite( "osre", 1, 4, file );
+    ::fclose( file );
+
+    Stream *stream( m_ioSrv->openStream( Uri( "file://" + m_filename ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, stream );
+    EXPECT_TRUE( stream->canBeMapped() );
+    EXPECT_EQ( Pos + 4, stream->getSize() );
+
+    c8 buffer[ 5 ] = { 0 };
+    EXPECT_EQ( 4u, stream->readAt( Pos, buffer, 4 ) );
+    EXPECT_STREQ( "osre", buffer );
+
+    ::memset( buffer, 0, sizeof( buffer ) );
+    EXPECT_EQ( Pos, stream->seek( -4, Stream::Origin::End ) );
+    EXPECT_EQ( 4u, stream->read( buffer, 8 ) );
+    EXPECT_STREQ( "osre", buffer );
+
+    ui64 size( 0 );
+    const uc8 *data( stream->map( size ) );
+    ASSERT_NE( nullptr, data );
+    EXPECT_EQ( Pos + 4, size );
+    EXPECT_EQ( 0, ::memcmp( data + Pos, "osre", 4 ) );
+    m_ioSrv->closeStream( &stream );
+}
+#endif
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,114 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/MemoryStream.h>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class MemoryStreamTest : public ::testing::Test {
+    // empty
+};
+
+TEST_F( MemoryStreamTest, writeReadTest ) {
+    MemoryStream stream;
+    EXPECT_TRUE( stream.isOpen() );
+    EXPECT_TRUE( stream.canWrite() );
+    EXPECT_EQ( sizeof( ui32 ), stream.writeUI32( 42 ) );
+    EXPECT_EQ( sizeof( f32 ), stream.writeF32( 1.5f ) );
+    EXPECT_EQ( 3u, stream.write( "abc", 3 ) );
+    EXPECT_EQ( 11u, stream.getSize() );
+
+    EXPECT_EQ( 0u, stream.seek( 0, Stream::Origin::Begin ) );
+    ui32 value( 0 );
+    f32 fvalue( 0 );
+    c8 text[ 4 ] = { 0 };
+    EXPECT_EQ( sizeof( ui32 ), stream.readUI32( value ) );
+    EXPECT_EQ( sizeof( f32 ), stream.readF32( fvalue ) );
+    EXPECT_EQ( 3u, stream.read( text, 4 ) );
+    EXPECT_EQ( 42u, value );
+    EXPECT_EQ( 1.5f, fvalue );
+    EXPECT_STREQ( "abc", text );
+    EXPECT_EQ( 0u, stream.read( text, 1 ) );
+
+    // Writing after a seek overwrites the content
+    EXPECT_EQ( 4u, stream.seek( 4, Stream::Origin::Begin ) );
+    stream.writeUI32( 7 );
+    EXPECT_EQ( 11u, stream.getSize() );
+    EXPECT_EQ( 11u, stream.seek( 100, Stream::Origin::Current ) );
+}
+
+TEST_F( MemoryStreamTest, viewTest ) {
+    const uc8 data[ 8 ] = { 1, 0, 0, 0, 2, 0, 0, 0 };
+    MemoryStream stream( data, sizeof( data ) );
+    EXPECT_FALSE( stream.canWrite() );
+    EXPECT_EQ( 0u, stream.writeUI32( 3 ) );
+    EXPECT_EQ( 8u, stream.getSize() );
+
+    // The view maps the memory of the caller without a copy
+    ui64 size( 0 );
+    EXPECT_TRUE( stream.canBeMapped() );
+    EXPECT_EQ( data, stream.map( size ) );
+    EXPECT_EQ( 8u, size );
+
+    ui32 value( 0 );
+    stream.seek( 4, Stream::Origin::Begin );
+    stream.readUI32( value );
+    EXPECT_EQ( 2u, value );
+}
+
+TEST_F( MemoryStreamTest, largeViewTest ) {
+    // Views of more than 4 GB keep their size, only the positions are used here
+    const uc8 data[ 8 ] = { 1, 0, 0, 0, 2, 0, 0, 0 };
+    const ui64 viewSize( 0x100000000ull + sizeof( data ) );
+    MemoryStream stream( data, viewSize );
+    EXPECT_EQ( viewSize, stream.getSize() );
+    EXPECT_EQ( viewSize, stream.seek( 0, Stream::Origin::End ) );
+    EXPECT_EQ( 4u, stream.seek( 4, Stream::Origin::Begin ) );
+
+    ui32 value( 0 );
+    stream.readUI32( value );
+    EXPECT_EQ( 2u, value );
+}
+
+TEST_F( MemoryStreamTest, ownedBufferTest ) {
+    std::vector<uc8> buffer( 16, 5 );
+    MemoryStream stream( std::move( buffer ) );
+    EXPECT_TRUE( stream.isOwner() );
+    ui64 size( 0 );
+    const uc8 *data( stream.map( size ) );
+    ASSERT_NE( nullptr, data );
+    EXPECT_EQ( 16u, size );
+    EXPECT_EQ( 5, data[ 15 ] );
+
+    // Closing keeps the content
+    EXPECT_TRUE( stream.close() );
+    EXPECT_FALSE( stream.isOpen() );
+    EXPECT_TRUE( stream.open() );
+    EXPECT_EQ( 16u, stream.getSize() );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,155 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/PakArchive.h>
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+#include "src/Engine/IO/Lz4Codec.h"
+#include "src/Engine/IO/PakFileSystem.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class PakArchiveTest : public ::testing::Test {
+protected:
+    String m_filename;
+    std::vector<uc8> m_data;
+
+    virtual void SetUp() {
+        m_filename = "pak_archive_test.pak";
+
+        // Compressible data over several chunks, the size is not a multiple of the chunk size
+        m_data.resize( 3 * PakArchive::DefaultChunkSize + 1234 );
+        for ( size_t i = 0; i < m_data.size(); ++i ) {
+            m_data[ i ] = static_cast<uc8>( ( i / 7 ) % 13 + ( i % 3 ) );
+        }
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+    }
+
+    void checkEntry( PakFileSystem &fs, const String &name ) {
+        Stream *stream( fs.open( Uri( "pak://" + name ), Stream::AccessMode::ReadAccessBinary ) );
+        ASSERT_NE( nullptr, stream );
+        ASSERT_EQ( m_data.size(), stream->getSize() );
+
+        // Partial reads across chunks, then the whole rest
+        std::vector<uc8> buffer( m_data.size() );
+        EXPECT_EQ( 100u, stream->read( &buffer[ 0 ], 100 ) );
+        EXPECT_EQ( 100000u, stream->read( &buffer[ 100 ], 100000 ) );
+        const ui32 rest( static_cast<ui32>( m_data.size() ) - 100100 );
+        EXPECT_EQ( rest, stream->read( &buffer[ 100100 ], rest + 10 ) );
+        EXPECT_EQ( 0, ::memcmp( &m_data[ 0 ], &buffer[ 0 ], m_data.size() ) );
+
+        // Random access
+        uc8 part[ 300 ];
+        EXPECT_EQ( 300u, stream->readAt( PakArchive::DefaultChunkSize * 2 - 150, part, 300 ) );
+        EXPECT_EQ( 0, ::memcmp( &m_data[ PakArchive::DefaultChunkSize * 2 - 150 ], part, 300 ) );
+        EXPECT_EQ( 1000u, stream->seek( 1000, Stream::Origin::Begin ) );
+        EXPECT_EQ( 300u, stream->read( part, 300 ) );
+        EXPECT_EQ( 0, ::memcmp( &m_data[ 1000 ], part, 300 ) );
+
+        fs.close( &stream );
+        EXPECT_EQ( nullptr, stream );
+    }
+};
+
+TEST_F( PakArchiveTest, lz4Test ) {
+    std::vector<uc8> packed( Lz4Codec::getMaxCompressedSize( static_cast<ui32>( m_data.size() ) ) );
+    const ui32 packedSize( Lz4Codec::compress( &m_data[ 0 ], static_cast<ui32>( m_data.size() ), &packed[ 0 ], 
+            static_cast<ui32>( packed.size() ) ) );
+    EXPECT_GT( packedSize, 0u );
+    EXPECT_LT( packedSize, m_data.size() / 4 );
+
+    std::vector<uc8> unpacked( m_data.size() );
+    EXPECT_TRUE( Lz4Codec::decompress( &packed[ 0 ], packedSize, &unpacked[ 0 ], static_cast<ui32>( unpacked.size() ) ) );
+    EXPECT_EQ( m_data, unpacked );
+
+    // Corrupt data is detected
+    EXPECT_FALSE( Lz4Codec::decompress( &packed[ 0 ], packedSize / 2, &unpacked[ 0 ], static_cast<ui32>( unpacked.size() ) ) );
+
+    // Short and incompressible data
+    const uc8 text[] = "osre";
+    const ui32 shortSize( Lz4Codec::compress( text, 4, &packed[ 0 ], static_cast<ui32>( packed.size() ) ) );
+    EXPECT_TRUE( Lz4Codec::decompress( &packed[ 0 ], shortSize, &unpacked[ 0 ], 4 ) );
+    EXPECT_EQ( 0, ::memcmp( text, &unpacked[ 0 ], 4 ) );
+}
+
+TEST_F( PakArchiveTest, writeReadTest ) {
+    PakWriter writer;
+    EXPECT_TRUE( writer.addData( "data/lz4.bin", &m_data[ 0 ], m_data.size(), PakArchive::Codec::LZ4 ) );
+    EXPECT_TRUE( writer.addData( "data\\deflate.bin", &m_data[ 0 ], m_data.size(), PakArchive::Codec::Deflate ) );
+    EXPECT_TRUE( writer.addData( "/stored.bin", &m_data[ 0 ], m_data.size(), PakArchive::Codec::Stored ) );
+    EXPECT_TRUE( writer.addData( "empty.bin", nullptr, 0, PakArchive::Codec::LZ4 ) );
+    EXPECT_FALSE( writer.addData( "data/lz4.bin", &m_data[ 0 ], 10, PakArchive::Codec::LZ4 ) );
+    EXPECT_EQ( 4u, writer.getNumEntries() );
+    ASSERT_TRUE( writer.write( m_filename ) );
+
+    PakFileSystem fs( Uri( "pak://" + m_filename ) );
+    ASSERT_TRUE( fs.isOpen() );
+    std::vector<String> files;
+    fs.getFileList( files );
+    EXPECT_EQ( 4u, files.size() );
+    EXPECT_TRUE( fs.fileExist( Uri( "pak://data/deflate.bin" ) ) );
+    EXPECT_FALSE( fs.fileExist( Uri( "pak://data/missing.bin" ) ) );
+    EXPECT_EQ( nullptr, fs.open( Uri( "pak://data/lz4.bin" ), Stream::AccessMode::WriteAccessBinary ) );
+
+    checkEntry( fs, "data/lz4.bin" );
+    checkEntry( fs, "data/deflate.bin" );
+    checkEntry( fs, "stored.bin" );
+
+    // Stored entries are aligned in the archive and can be mapped
+    Stream *stream( fs.open( Uri( "pak://stored.bin" ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, stream );
+    ui64 size( 0 );
+    const uc8 *data( stream->map( size ) );
+    ASSERT_NE( nullptr, data );
+    EXPECT_EQ( m_data.size(), size );
+    EXPECT_EQ( 0u, reinterpret_cast<size_t>( data ) % PakArchive::Alignment );
+    fs.close( &stream );
+
+    stream = fs.open( Uri( "pak://empty.bin" ), Stream::AccessMode::ReadAccessBinary );
+    ASSERT_NE( nullptr, stream );
+    EXPECT_EQ( 0u, stream->getSize() );
+    fs.close( &stream );
+}
+
+TEST_F( PakArchiveTest, invalidArchiveTest ) {
+    FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+    ::fwrite( &m_data[ 0 ], 1, 1000, file );
+    ::fclose( file );
+
+    PakFileSystem fs( Uri( "pak://" + m_filename ) );
+    EXPECT_FALSE( fs.isOpen() );
+    EXPECT_EQ( nullptr, fs.open( Uri( "pak://data/lz4.bin" ), Stream::AccessMode::ReadAccessBinary ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
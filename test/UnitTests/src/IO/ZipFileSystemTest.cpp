@@ -0,0 +1,222 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/IO/Stream.h>
+#include <osre/IO/Uri.h>
+#include "src/Engine/IO/ZipFileSystem.h"
+
+#include "zlib.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::IO;
+
+class ZipFileSystemTest : public ::testing::Test {
+protected:
+    struct ZipEntry {
+        String m_name;
+        std::vector<uc8> m_data;
+    };
+
+    String m_filename;
+    std::vector<ZipEntry> m_entries;
+
+    virtual void SetUp() {
+        m_filename = "zip_file_system_test.zip";
+        for ( ui32 i = 0; i < 8; ++i ) {
+            ZipEntry entry;
+            entry.m_name = "assets/file" + std::to_string( i ) + ".bin";
+            entry.m_data.resize( 10000 + i * 1000 );
+            for ( size_t j = 0; j < entry.m_data.size(); ++j ) {
+                entry.m_data[ j ] = static_cast<uc8>( ( j / 5 + i ) % 17 );
+            }
+            m_entries.push_back( entry );
+        }
+        writeZip();
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+    }
+
+    static void put16( std::vector<uc8> &out, ui32 value ) {
+        out.push_back( static_cast<uc8>( value ) );
+        out.push_back( static_cast<uc8>( value >> 8 ) );
+    }
+
+    static void put32( std::vector<uc8> &out, ui32 value ) {
+        put16( out, value & 0xFFFF );
+        put16( out, value >> 16 );
+    }
+
+    // Writes the entries deflated, with the local headers, the central directory and its end record
+    void writeZip() {
+        std::vector<uc8> out, directory;
+        for ( const ZipEntry &entry : m_entries ) {
+            std::vector<uc8> packed( compressBound( static_cast<uLong>( entry.m_data.size() ) ) );
+            z_stream stream;
+            ::memset( &stream, 0, sizeof( stream ) );
+            deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY );
+            stream.next_in = const_cast<uc8*>( &entry.m_data[ 0 ] );
+            stream.avail_in = static_cast<uInt>( entry.m_data.size() );
+            stream.next_out = &packed[ 0 ];
+            stream.avail_out = static_cast<uInt>( packed.size() );
+            deflate( &stream, Z_FINISH );
+            packed.resize( stream.total_out );
+            deflateEnd( &stream );
+
+            const ui32 crc( static_cast<ui32>( crc32( 0, &entry.m_data[ 0 ], static_cast<uInt>( entry.m_data.size() ) ) ) );
+            const ui32 offset( static_cast<ui32>( out.size() ) );
+            for ( int central = 0; central < 2; ++central ) {
+                std::vector<uc8> &dst( central ? directory : out );
+                put32( dst, central ? 0x02014b50 : 0x04034b50 );
+                if ( central ) {
+                    put16( dst, 20 );
+                }
+                put16( dst, 20 );
+                put16( dst, 0 );
+                put16( dst, 8 );
+                put32( dst, 0 );
+                put32( dst, crc );
+                put32( dst, static_cast<ui32>( packed.size() ) );
+                put32( dst, static_cast<ui32>( entry.m_data.size() ) );
+                put16( dst, static_cast<ui32>( entry.m_name.size() ) );
+                put16( dst, 0 );
+                if ( central ) {
+                    put16( dst, 0 );
+                    put16( dst, 0 );
+                    put16( dst, 0 );
+                    put32( dst, 0 );
+                    put32( dst, offset );
+                }
+                dst.insert( dst.end(), entry.m_name.begin(), entry.m_name.end() );
+            }
+            out.insert( out.end(), packed.begin(), packed.end() );
+        }
+
+        const ui32 directoryOffset( static_cast<ui32>( out.size() ) );
+        out.insert( out.end(), directory.begin(), directory.end() );
+        put32( out, 0x06054b50 );
+        put16( out, 0 );
+        put16( out, 0 );
+        put16( out, static_cast<ui32>( m_entries.size() ) );
+        put16( out, static_cast<ui32>( m_entries.size() ) );
+        put32( out, static_cast<ui32>( directory.size() ) );
+        put32( out, directoryOffset );
+        put16( out, 0 );
+
+        FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+        ::fwrite( &out[ 0 ], 1, out.size(), file );
+        ::fclose( file );
+    }
+
+    bool checkEntry( ZipFileSystem &fs, const ZipEntry &entry ) {
+        Stream *stream( fs.open( Uri( "zip://" + entry.m_name ), Stream::AccessMode::ReadAccess ) );
+        if ( nullptr == stream ) {
+            return false;
+        }
+        std::vector<uc8> data( static_cast<size_t>( stream->getSize() ) );
+        const bool ok( data.size() == entry.m_data.size() && data.size() == stream->read( &data[ 0 ], static_cast<ui32>( data.size() ) ) 
+                && data == entry.m_data );
+        fs.close( &stream );
+
+        return ok;
+    }
+};
+
+TEST_F( ZipFileSystemTest, openTest ) {
+    ZipFileSystem fs( Uri( "zip://" + m_filename ) );
+    std::vector<String> files;
+    fs.getFileList( files );
+    EXPECT_EQ( m_entries.size(), files.size() );
+    EXPECT_TRUE( fs.fileExist( Uri( "zip://assets/file3.bin" ) ) );
+    EXPECT_FALSE( fs.fileExist( Uri( "zip://assets/missing.bin" ) ) );
+    EXPECT_EQ( nullptr, fs.open( Uri( "zip://assets/missing.bin" ), Stream::AccessMode::ReadAccess ) );
+    EXPECT_EQ( nullptr, fs.open( Uri( "zip://assets/file3.bin" ), Stream::AccessMode::WriteAccess ) );
+
+    for ( const ZipEntry &entry : m_entries ) {
+        EXPECT_TRUE( checkEntry( fs, entry ) );
+    }
+
+    // Streams of the same entry share the cached data
+    Stream *first( fs.open( Uri( "zip://assets/file1.bin" ), Stream::AccessMode::ReadAccess ) );
+    Stream *second( fs.open( Uri( "zip://assets/file1.bin" ), Stream::AccessMode::ReadAccessBinary ) );
+    ASSERT_NE( nullptr, first );
+    ASSERT_NE( nullptr, second );
+    EXPECT_NE( first, second );
+    ui64 size1( 0 ), size2( 0 );
+    EXPECT_EQ( first->map( size1 ), second->map( size2 ) );
+    fs.close( &first );
+    fs.close( &second );
+}
+
+TEST_F( ZipFileSystemTest, cacheBudgetTest ) {
+    ZipFileSystem fs( Uri( "zip://" + m_filename ) );
+    fs.setCacheBudget( 30000 );
+    for ( const ZipEntry &entry : m_entries ) {
+        EXPECT_TRUE( checkEntry( fs, entry ) );
+        EXPECT_LE( fs.getCacheMemoryUsage(), 30000u );
+    }
+
+    // Open entries are kept even beyond the budget
+    std::vector<Stream*> streams;
+    for ( const ZipEntry &entry : m_entries ) {
+        streams.push_back( fs.open( Uri( "zip://" + entry.m_name ), Stream::AccessMode::ReadAccess ) );
+        EXPECT_NE( nullptr, streams.back() );
+    }
+    EXPECT_GT( fs.getCacheMemoryUsage(), 30000u );
+    for ( Stream *stream : streams ) {
+        fs.close( &stream );
+    }
+    EXPECT_LE( fs.getCacheMemoryUsage(), 30000u );
+}
+
+TEST_F( ZipFileSystemTest, parallelReadTest ) {
+    ZipFileSystem fs( Uri( "zip://" + m_filename ) );
+    fs.setCacheBudget( 1 );
+    std::atomic<ui32> numOk( 0 );
+    std::vector<std::thread> threads;
+    for ( ui32 t = 0; t < 4; ++t ) {
+        threads.push_back( std::thread( [ this, &fs, &numOk, t ] {
+            for ( ui32 i = 0; i < 20; ++i ) {
+                if ( checkEntry( fs, m_entries[ ( i + t ) % m_entries.size() ] ) ) {
+                    ++numOk;
+                }
+            }
+        } ) );
+    }
+    for ( std::thread &thread : threads ) {
+        thread.join();
+    }
+    EXPECT_EQ( 80u, numOk.load() );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -25,6 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <osre/RenderBackend/Geometry.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 namespace OSRE {
 namespace UnitTest {
 
@@ -178,6 +182,49 @@ TEST_F( RenderCommonTest, geometryIdTest ) {
     Geometry::destroy( &geo );
 }
 
+TEST_F( RenderCommonTest, concurrentGeometryIdTest ) {
+    static const ui32 NumThreads = 4;
+    static const ui32 NumGeo = 200;
+    std::vector<Geometry*> geos[ NumThreads ];
+    std::vector<std::thread> threads;
+    for ( ui32 i = 0; i < NumThreads; ++i ) {
+        threads.push_back( std::thread( [ &geos, i ]() {
+            for ( ui32 j = 0; j < NumGeo; ++j ) {
+                geos[ i ].push_back( Geometry::create( 1 ) );
+                if ( 0 == j % 2 ) {
+                    Geometry::destroy( &geos[ i ].back() );
+                    geos[ i ].pop_back();
+                }
+            }
+        } ) );
+    }
+    for ( std::thread &thread : threads ) {
+        thread.join();
+    }
+
+    // Living geometries never share an id
+    std::set<ui32> ids;
+    for ( ui32 i = 0; i < NumThreads; ++i ) {
+        for ( Geometry *geo : geos[ i ] ) {
+            EXPECT_TRUE( ids.insert( geo->m_id ).second );
+            Geometry::destroy( &geo );
+        }
+    }
+    EXPECT_EQ( NumThreads * NumGeo / 2, ids.size() );
+}
+
+TEST_F( RenderCommonTest, geometrySerialTest ) {
+    // The id of a released geometry will be reused, the serial not
+    Geometry *geo( Geometry::create( 1 ) );
+    const ui32 id( geo->m_id );
+    const ui64 serial( geo->m_serial );
+    Geometry::destroy( &geo );
+    geo = Geometry::create( 1 );
+    EXPECT_EQ( id, geo->m_id );
+    EXPECT_NE( serial, geo->m_serial );
+    Geometry::destroy( &geo );
+}
+
 TEST_F( RenderCommonTest, accessTransformMatrixBlockTest ) {
     TransformMatrixBlock block;
     block.m_model = glm::translate( block.m_model, glm::vec3( 1, 2, 3 ) );
@@ -0,0 +1,121 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Scene/LodSet.h>
+#include <osre/Scene/GeometryBuilder.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Scene;
+using namespace ::OSRE::RenderBackend;
+
+class LodSetTest : public ::testing::Test {
+protected:
+    Geometry *m_geo;
+
+    virtual void SetUp() {
+        m_geo = GeometryBuilder::allocTriangles( VertexType::ColorVertex, BufferAccessType::ReadOnly );
+    }
+
+    virtual void TearDown() {
+        Geometry::destroy( &m_geo );
+    }
+};
+
+TEST_F( LodSetTest, addLevelTest ) {
+    LodSet lodSet;
+    EXPECT_FALSE( lodSet.addLevel( nullptr, 1.0f ) );
+    EXPECT_TRUE( lodSet.addLevel( m_geo, 0.5f ) );
+    EXPECT_FALSE( lodSet.addLevel( m_geo, 0.5f ) );
+    EXPECT_TRUE( lodSet.addLevel( m_geo, 0.0f ) );
+    EXPECT_EQ( 2u, lodSet.getNumLevels() );
+    EXPECT_EQ( 3u, lodSet.getLevelAt( 1 ).m_startIndex );
+
+    Geometry *proxy( lodSet.getGeometry() );
+    ASSERT_NE( nullptr, proxy );
+    EXPECT_EQ( m_geo->m_material, proxy->m_material );
+    EXPECT_EQ( 2 * m_geo->m_vb->m_size, proxy->m_vb->m_size );
+    EXPECT_EQ( 6 * sizeof( ui32 ), proxy->m_ib->m_size );
+    EXPECT_EQ( 0u, proxy->m_pPrimGroups[ 0 ].m_startIndex );
+}
+
+TEST_F( LodSetTest, addInvalidLevelTest ) {
+    LodSet lodSet;
+
+    // The primitive group exceeds the index buffer
+    PrimitiveGroup &grp( m_geo->m_pPrimGroups[ 0 ] );
+    grp.m_startIndex = 1;
+    EXPECT_FALSE( lodSet.addLevel( m_geo, 1.0f ) );
+    grp.m_startIndex = 0;
+
+    // The index refers to a vertex behind the vertex buffer
+    ui16 *indices( static_cast<ui16*>( m_geo->m_ib->m_data ) );
+    ASSERT_EQ( IndexType::UnsignedShort, grp.m_indexType );
+    const ui16 lastIndex( indices[ 2 ] );
+    indices[ 2 ] = 3;
+    EXPECT_FALSE( lodSet.addLevel( m_geo, 1.0f ) );
+    indices[ 2 ] = lastIndex;
+
+    EXPECT_EQ( nullptr, lodSet.getGeometry() );
+    EXPECT_TRUE( lodSet.addLevel( m_geo, 1.0f ) );
+}
+
+TEST_F( LodSetTest, selectWithHysteresisTest ) {
+    LodSet lodSet;
+    lodSet.addLevel( m_geo, 0.5f );
+    lodSet.addLevel( m_geo, 0.0f );
+    lodSet.setHysteresis( 0.1f );
+
+    EXPECT_EQ( 0u, lodSet.select( 1.0f ) );
+    EXPECT_FALSE( lodSet.isChanged() );
+
+    // Inside of the hysteresis band, keep the current level
+    EXPECT_EQ( 0u, lodSet.select( 0.47f ) );
+    EXPECT_EQ( 1u, lodSet.select( 0.4f ) );
+    EXPECT_TRUE( lodSet.isChanged() );
+    EXPECT_EQ( 3u, lodSet.getGeometry()->m_pPrimGroups[ 0 ].m_startIndex );
+    lodSet.resetChanged();
+
+    EXPECT_EQ( 1u, lodSet.select( 0.53f ) );
+    EXPECT_EQ( 0u, lodSet.select( 0.6f ) );
+    EXPECT_TRUE( lodSet.isChanged() );
+}
+
+TEST_F( LodSetTest, computeScreenSizeTest ) {
+    LodSet::AABB box( Vec3f( -1, -1, -1 ), Vec3f( 1, 1, 1 ) );
+    const glm::mat4 projection( glm::perspective( glm::radians( 60.0f ), 1.0f, 0.1f, 1000.0f ) );
+    const glm::mat4 nearView( glm::lookAt( glm::vec3( 0, 0, 10 ), glm::vec3( 0, 0, 0 ), glm::vec3( 0, 1, 0 ) ) );
+    const glm::mat4 farView( glm::lookAt( glm::vec3( 0, 0, 100 ), glm::vec3( 0, 0, 0 ), glm::vec3( 0, 1, 0 ) ) );
+    const f32 nearSize( LodSet::computeScreenSize( box, glm::mat4( 1.0f ), nearView, projection ) );
+    const f32 farSize( LodSet::computeScreenSize( box, glm::mat4( 1.0f ), farView, projection ) );
+    EXPECT_GT( nearSize, farSize );
+    EXPECT_GT( farSize, 0.0f );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
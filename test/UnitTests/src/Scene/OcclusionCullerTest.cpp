@@ -0,0 +1,127 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Scene/OcclusionCuller.h>
+#include <osre/Threading/ThreadPool.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Scene;
+using namespace ::OSRE::RenderBackend;
+
+class OcclusionCullerTest : public ::testing::Test {
+protected:
+    Geometry *m_quad;
+    glm::mat4 m_viewProjection;
+
+    virtual void SetUp() {
+        // A quad in the xy-plane, facing the viewer
+        ColorVert vertices[ 4 ];
+        const f32 size( 2.0f );
+        vertices[ 0 ].position = glm::vec3( -size, -size, 0 );
+        vertices[ 1 ].position = glm::vec3(  size, -size, 0 );
+        vertices[ 2 ].position = glm::vec3(  size,  size, 0 );
+        vertices[ 3 ].position = glm::vec3( -size,  size, 0 );
+        const ui16 indices[ 6 ] = { 0, 1, 2, 0, 2, 3 };
+
+        m_quad = Geometry::create( 1 );
+        m_quad->m_vertextype = VertexType::ColorVertex;
+        m_quad->m_indextype = IndexType::UnsignedShort;
+        m_quad->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( vertices ), BufferAccessType::ReadOnly );
+        m_quad->m_vb->copyFrom( vertices, sizeof( vertices ) );
+        m_quad->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( indices ), BufferAccessType::ReadOnly );
+        m_quad->m_ib->copyFrom( ( void* ) indices, sizeof( indices ) );
+        m_quad->m_numPrimGroups = 1;
+        m_quad->m_pPrimGroups = new PrimitiveGroup[ m_quad->m_numPrimGroups ];
+        m_quad->m_pPrimGroups[ 0 ].init( IndexType::UnsignedShort, 6, PrimitiveType::TriangleList, 0 );
+
+        const glm::mat4 projection( glm::perspective( glm::radians( 60.0f ), 2.0f, 1.0f, 100.0f ) );
+        const glm::mat4 view( glm::lookAt( glm::vec3( 0, 0, 10 ), glm::vec3( 0, 0, 0 ), glm::vec3( 0, 1, 0 ) ) );
+        m_viewProjection = projection * view;
+    }
+
+    virtual void TearDown() {
+        Geometry::destroy( &m_quad );
+    }
+
+    static OcclusionCuller::AABB createBox( f32 x, f32 y, f32 z, f32 halfSize ) {
+        return OcclusionCuller::AABB( Vec3f( x - halfSize, y - halfSize, z - halfSize ), 
+                Vec3f( x + halfSize, y + halfSize, z + halfSize ) );
+    }
+};
+
+TEST_F( OcclusionCullerTest, emptyDepthBufferTest ) {
+    OcclusionCuller culler( 64, 32 );
+    culler.update( m_viewProjection );
+    EXPECT_EQ( 64u, culler.getWidth() );
+    EXPECT_EQ( 32u, culler.getHeight() );
+    EXPECT_FLOAT_EQ( 1.0f, culler.getDepth( 10, 10 ) );
+    EXPECT_TRUE( culler.isVisible( createBox( 0, 0, -5, 0.5f ), glm::mat4( 1.0f ) ) );
+}
+
+TEST_F( OcclusionCullerTest, occludedBoxTest ) {
+    OcclusionCuller culler;
+    culler.addOccluder( m_quad, nullptr );
+    EXPECT_EQ( 1u, culler.getNumOccluders() );
+    culler.update( m_viewProjection );
+    EXPECT_LT( culler.getDepth( culler.getWidth() / 2, culler.getHeight() / 2 ), 1.0f );
+    EXPECT_GT( culler.getNumHiZLevels(), 1u );
+
+    // Behind the occluder
+    EXPECT_FALSE( culler.isVisible( createBox( 0, 0, -5, 0.5f ), glm::mat4( 1.0f ) ) );
+    EXPECT_FALSE( culler.isVisible( createBox( 0, 0, 0, 0.5f ), glm::translate( glm::mat4( 1.0f ), glm::vec3( 0, 0, -5 ) ) ) );
+
+    // In front of the occluder and beside it
+    EXPECT_TRUE( culler.isVisible( createBox( 0, 0, 5, 0.5f ), glm::mat4( 1.0f ) ) );
+    EXPECT_TRUE( culler.isVisible( createBox( 5, 0, -5, 0.5f ), glm::mat4( 1.0f ) ) );
+
+    // Enclosing the viewer
+    EXPECT_TRUE( culler.isVisible( createBox( 0, 0, 10, 2.0f ), glm::mat4( 1.0f ) ) );
+
+    EXPECT_TRUE( culler.removeOccluder( m_quad ) );
+    culler.update( m_viewProjection );
+    EXPECT_TRUE( culler.isVisible( createBox( 0, 0, -5, 0.5f ), glm::mat4( 1.0f ) ) );
+}
+
+TEST_F( OcclusionCullerTest, parallelRasterizationTest ) {
+    OcclusionCuller serial, parallel;
+    Threading::ThreadPool threadPool( 3 );
+    parallel.setThreadPool( &threadPool );
+    serial.addOccluder( m_quad, nullptr );
+    parallel.addOccluder( m_quad, nullptr );
+    serial.update( m_viewProjection );
+    parallel.update( m_viewProjection );
+    for ( ui32 y = 0; y < serial.getHeight(); ++y ) {
+        for ( ui32 x = 0; x < serial.getWidth(); ++x ) {
+            ASSERT_FLOAT_EQ( serial.getDepth( x, y ), parallel.getDepth( x, y ) );
+        }
+    }
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,185 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Scene/RaycastIndex.h>
+#include <osre/Scene/Stage.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/Component.h>
+#include <osre/Common/Ids.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Scene;
+using namespace ::OSRE::RenderBackend;
+
+class RaycastIndexTest : public ::testing::Test {
+protected:
+    Geometry *m_quad;
+
+    virtual void SetUp() {
+        // A unit quad in the xy-plane around the origin
+        ColorVert vertices[ 4 ];
+        vertices[ 0 ].position = glm::vec3( -0.5f, -0.5f, 0 );
+        vertices[ 1 ].position = glm::vec3(  0.5f, -0.5f, 0 );
+        vertices[ 2 ].position = glm::vec3(  0.5f,  0.5f, 0 );
+        vertices[ 3 ].position = glm::vec3( -0.5f,  0.5f, 0 );
+        const ui16 indices[ 6 ] = { 0, 1, 2, 0, 2, 3 };
+
+        m_quad = Geometry::create( 1 );
+        m_quad->m_vertextype = VertexType::ColorVertex;
+        m_quad->m_indextype = IndexType::UnsignedShort;
+        m_quad->m_vb = BufferData::alloc( BufferType::VertexBuffer, sizeof( vertices ), BufferAccessType::ReadOnly );
+        m_quad->m_vb->copyFrom( vertices, sizeof( vertices ) );
+        m_quad->m_ib = BufferData::alloc( BufferType::IndexBuffer, sizeof( indices ), BufferAccessType::ReadOnly );
+        m_quad->m_ib->copyFrom( ( void* ) indices, sizeof( indices ) );
+        m_quad->m_numPrimGroups = 1;
+        m_quad->m_pPrimGroups = new PrimitiveGroup[ m_quad->m_numPrimGroups ];
+        m_quad->m_pPrimGroups[ 0 ].init( IndexType::UnsignedShort, 6, PrimitiveType::TriangleList, 0 );
+    }
+
+    virtual void TearDown() {
+        Geometry::destroy( &m_quad );
+    }
+
+    Node *createQuadNode( Stage &stage, const String &name, const glm::vec3 &pos ) {
+        Node *node( stage.createNode( name, nullptr ) );
+        RenderComponent *renderComp( ( RenderComponent* ) node->getComponent( Node::ComponentType::RenderComponentType ) );
+        renderComp->addStaticGeometry( m_quad );
+        TransformComponent *transformComp( ( TransformComponent* ) node->getComponent( Node::ComponentType::TransformComponentType ) );
+        transformComp->setTransformationMatrix( glm::translate( glm::mat4( 1.0f ), pos ) );
+        return node;
+    }
+
+    static Collision::TRay<f32> createRay( f32 x, f32 y, f32 z ) {
+        return Collision::TRay<f32>( Vec3f( x, y, z ), Vec3f( 0, 0, -1 ) );
+    }
+};
+
+TEST_F( RaycastIndexTest, buildTest ) {
+    Stage stage( "test", nullptr );
+    createQuadNode( stage, "quad1", glm::vec3( 0, 0, 0 ) );
+    createQuadNode( stage, "quad2", glm::vec3( 2, 0, 0 ) );
+
+    RaycastIndex index;
+    EXPECT_EQ( 2u, index.build( stage.getRoot() ) );
+    EXPECT_EQ( 2u, index.getNumInstances() );
+
+    // Both nodes share the geometry
+    EXPECT_EQ( 1u, index.getNumMeshes() );
+
+    index.clear();
+    EXPECT_EQ( 0u, index.getNumInstances() );
+    EXPECT_EQ( 0u, index.getNumMeshes() );
+}
+
+TEST_F( RaycastIndexTest, raycastTest ) {
+    Stage stage( "test", nullptr );
+    Node *quad1( createQuadNode( stage, "quad1", glm::vec3( 0, 0, 0 ) ) );
+    Node *quad2( createQuadNode( stage, "quad2", glm::vec3( 2, 0, -1 ) ) );
+
+    RaycastHit hit;
+    EXPECT_TRUE( stage.raycast( createRay( 0.1f, 0.2f, 10 ), hit ) );
+    EXPECT_EQ( quad1, hit.m_node );
+    EXPECT_EQ( m_quad, hit.m_geo );
+    EXPECT_FLOAT_EQ( 10.0f, hit.m_distance );
+    EXPECT_FLOAT_EQ( 0.1f, hit.m_position.x );
+    EXPECT_FLOAT_EQ( 0.0f, hit.m_position.z );
+
+    EXPECT_TRUE( stage.raycast( createRay( 2.1f, 0.2f, 10 ), hit ) );
+    EXPECT_EQ( quad2, hit.m_node );
+    EXPECT_FLOAT_EQ( 11.0f, hit.m_distance );
+
+    EXPECT_FALSE( stage.raycast( createRay( 1.0f, 0.2f, 10 ), hit ) );
+    EXPECT_FALSE( stage.raycast( createRay( 0.1f, 0.2f, 10 ), hit, 5.0f ) );
+}
+
+TEST_F( RaycastIndexTest, raycastAllTest ) {
+    Stage stage( "test", nullptr );
+    Node *quad1( createQuadNode( stage, "quad1", glm::vec3( 0, 0, 0 ) ) );
+    Node *quad2( createQuadNode( stage, "quad2", glm::vec3( 0, 0, 2 ) ) );
+
+    CPPCore::TArray<RaycastHit> hits;
+    EXPECT_EQ( 2u, stage.raycastAll( createRay( 0.1f, 0.2f, 10 ), hits ) );
+    ASSERT_EQ( 2u, hits.size() );
+    EXPECT_EQ( quad2, hits[ 0 ].m_node );
+    EXPECT_EQ( quad1, hits[ 1 ].m_node );
+    EXPECT_FLOAT_EQ( 8.0f, hits[ 0 ].m_distance );
+    EXPECT_FLOAT_EQ( 10.0f, hits[ 1 ].m_distance );
+}
+
+TEST_F( RaycastIndexTest, raycastPacketTest ) {
+    Stage stage( "test", nullptr );
+    Node *quad1( createQuadNode( stage, "quad1", glm::vec3( 0, 0, 0 ) ) );
+    Node *quad2( createQuadNode( stage, "quad2", glm::vec3( 2, 0, 0 ) ) );
+
+    Collision::TRay<f32> rays[ 5 ] = { createRay( 0, 0, 5 ), createRay( 2, 0, 5 ), createRay( 1, 0, 5 ), 
+            createRay( 2.2f, 0.3f, 5 ), createRay( -0.2f, 0.1f, 5 ) };
+    RaycastHit hits[ 5 ];
+    EXPECT_EQ( 4u, stage.raycastPacket( rays, 5, hits ) );
+    EXPECT_EQ( quad1, hits[ 0 ].m_node );
+    EXPECT_EQ( quad2, hits[ 1 ].m_node );
+    EXPECT_EQ( nullptr, hits[ 2 ].m_node );
+    EXPECT_EQ( quad2, hits[ 3 ].m_node );
+    EXPECT_EQ( quad1, hits[ 4 ].m_node );
+    EXPECT_FLOAT_EQ( 5.0f, hits[ 4 ].m_distance );
+}
+
+TEST_F( RaycastIndexTest, rebuildAfterUpdateTest ) {
+    Stage stage( "test", nullptr );
+    Node *quad( createQuadNode( stage, "quad", glm::vec3( 0, 0, 0 ) ) );
+
+    RaycastHit hit;
+    EXPECT_TRUE( stage.raycast( createRay( 0, 0, 10 ), hit ) );
+
+    TransformComponent *transformComp( ( TransformComponent* ) quad->getComponent( Node::ComponentType::TransformComponentType ) );
+    transformComp->setTransformationMatrix( glm::translate( glm::mat4( 1.0f ), glm::vec3( 5, 0, 0 ) ) );
+    stage.invalidateRaycastIndex();
+    EXPECT_FALSE( stage.raycast( createRay( 0, 0, 10 ), hit ) );
+    EXPECT_TRUE( stage.raycast( createRay( 5, 0, 10 ), hit ) );
+    EXPECT_EQ( quad, hit.m_node );
+}
+
+TEST_F( RaycastIndexTest, rebuildAfterChangeTest ) {
+    Stage stage( "test", nullptr );
+    Node *quad( createQuadNode( stage, "quad", glm::vec3( 0, 0, 0 ) ) );
+
+    RaycastHit hit;
+    EXPECT_TRUE( stage.raycast( createRay( 0, 0, 10 ), hit ) );
+
+    // Moved and deactivated nodes are detected without invalidating the index
+    TransformComponent *transformComp( ( TransformComponent* ) quad->getComponent( Node::ComponentType::TransformComponentType ) );
+    transformComp->setTransformationMatrix( glm::translate( glm::mat4( 1.0f ), glm::vec3( 5, 0, 0 ) ) );
+    EXPECT_FALSE( stage.raycast( createRay( 0, 0, 10 ), hit ) );
+    EXPECT_TRUE( stage.raycast( createRay( 5, 0, 10 ), hit ) );
+
+    quad->setActive( false );
+    EXPECT_FALSE( stage.raycast( createRay( 5, 0, 10 ), hit ) );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
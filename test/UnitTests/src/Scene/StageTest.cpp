@@ -0,0 +1,155 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Scene/Stage.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/StaticBatcher.h>
+#include <osre/Scene/GeometryBuilder.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/Common/Ids.h>
+#include <osre/Threading/ThreadPool.h>
+
+#include <atomic>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Scene;
+
+class StageTest : public ::testing::Test {
+protected:
+    // Counts its updates and checks, that the parent was updated before
+    class CountingNode : public Node {
+    public:
+        std::atomic<ui32> m_numUpdates;
+        std::atomic<bool> m_parentFirst;
+
+        CountingNode( const String &name, Common::Ids &ids, Node *parent )
+        : Node( name, ids, RenderCompRequest::NoRenderComp, TransformCompRequest::TransformCompRequested, parent )
+        , m_numUpdates( 0 )
+        , m_parentFirst( true ) {
+            // empty
+        }
+
+    protected:
+        void onUpdate( Time dt ) override {
+            CountingNode *parent( dynamic_cast<CountingNode*>( getParent() ) );
+            if ( nullptr != parent && parent->m_numUpdates <= m_numUpdates ) {
+                m_parentFirst = false;
+            }
+            ++m_numUpdates;
+            Node::onUpdate( dt );
+        }
+    };
+
+    std::vector<CountingNode*> m_nodes;
+
+    void createTree( Stage &stage, Node *parent, ui32 depth, ui32 numChildren ) {
+        if ( 0 == depth ) {
+            return;
+        }
+        for ( ui32 i = 0; i < numChildren; ++i ) {
+            CountingNode *node( new CountingNode( "node", *stage.getIdContainer(), parent ) );
+            m_nodes.push_back( node );
+            createTree( stage, node, depth - 1, numChildren );
+        }
+    }
+
+    void checkUpdates( ui32 expected ) {
+        for ( CountingNode *node : m_nodes ) {
+            EXPECT_EQ( expected, node->m_numUpdates.load() );
+            EXPECT_TRUE( node->m_parentFirst.load() );
+        }
+    }
+};
+
+TEST_F( StageTest, nodeUpdateDisabledTest ) {
+    Stage stage( "stage", nullptr );
+    EXPECT_FALSE( stage.isNodeUpdateEnabled() );
+    createTree( stage, stage.getRoot(), 2, 2 );
+    stage.update( Time() );
+    checkUpdates( 0 );
+}
+
+TEST_F( StageTest, serialUpdateTest ) {
+    Stage stage( "stage", nullptr );
+    stage.setNodeUpdateEnabled( true );
+    createTree( stage, stage.getRoot(), 3, 4 );
+    stage.update( Time() );
+    checkUpdates( 1 );
+}
+
+TEST_F( StageTest, parallelUpdateTest ) {
+    Stage stage( "stage", nullptr );
+    Threading::ThreadPool threadPool( 3 );
+    stage.setNodeUpdateEnabled( true );
+    stage.setThreadPool( &threadPool );
+    stage.setParallelUpdateThreshold( 8 );
+    EXPECT_EQ( 8u, stage.getParallelUpdateThreshold() );
+
+    // One chain node on top, the work is below it
+    CountingNode *top( new CountingNode( "top", *stage.getIdContainer(), stage.getRoot() ) );
+    m_nodes.push_back( top );
+    createTree( stage, top, 4, 5 );
+    stage.update( Time() );
+    stage.update( Time() );
+    checkUpdates( 2 );
+}
+
+TEST_F( StageTest, skipInactiveSubtreesTest ) {
+    Stage stage( "stage", nullptr );
+    stage.setNodeUpdateEnabled( true );
+    createTree( stage, stage.getRoot(), 2, 2 );
+    m_nodes[ 0 ]->setActive( false );
+    stage.update( Time() );
+    EXPECT_EQ( 0u, m_nodes[ 0 ]->m_numUpdates.load() );
+    EXPECT_EQ( 0u, m_nodes[ 1 ]->m_numUpdates.load() );
+    EXPECT_EQ( 1u, m_nodes[ 3 ]->m_numUpdates.load() );
+}
+
+TEST_F( StageTest, rebuildStaticBatchesTest ) {
+    using namespace ::OSRE::RenderBackend;
+
+    Geometry *geo( GeometryBuilder::allocTriangles( VertexType::ColorVertex, BufferAccessType::ReadOnly ) );
+    {
+        Stage stage( "stage", nullptr );
+        Node *node( stage.createNode( "static", stage.getRoot() ) );
+        node->setStatic( true );
+        node->addGeometry( geo );
+        EXPECT_EQ( 1u, stage.buildStaticBatches() );
+        EXPECT_EQ( 2u, stage.getRoot()->getNumChildren() );
+
+        // The former batch node will be replaced, the mesh is merged again
+        EXPECT_EQ( 1u, stage.buildStaticBatches() );
+        EXPECT_EQ( 2u, stage.getRoot()->getNumChildren() );
+        EXPECT_EQ( 1u, stage.getStaticBatcher()->getNumMergedMeshes() );
+        Node *batchNode( stage.getRoot()->getChildAt( 1 ) );
+        ASSERT_EQ( 1u, batchNode->getNumGeometries() );
+        EXPECT_EQ( stage.getStaticBatcher()->getBatchAt( 0 )->m_geo, batchNode->getGeometryAt( 0 ) );
+    }
+    Geometry::destroy( &geo );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
@@ -0,0 +1,313 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Scene/StaticBatcher.h>
+#include <osre/Scene/GeometryBuilder.h>
+#include <osre/Scene/Node.h>
+#include <osre/Scene/Component.h>
+#include <osre/Scene/OcclusionCuller.h>
+#include <osre/Common/Ids.h>
+#include <osre/RenderBackend/RenderCommon.h>
+#include <osre/RenderBackend/Geometry.h>
+#include <osre/RenderBackend/RenderBackendService.h>
+#include <osre/IO/MemoryStream.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Scene;
+using namespace ::OSRE::RenderBackend;
+
+class StaticBatcherTest : public ::testing::Test {
+protected:
+    Common::Ids *m_ids;
+    Node *m_root;
+    Geometry *m_geos[ 2 ];
+
+    virtual void SetUp() {
+        m_ids = new Common::Ids( 0 );
+        m_root = new Node( "root", *m_ids, Node::RenderCompRequest::NoRenderComp,
+                Node::TransformCompRequest::TransformCompRequested, nullptr );
+        for ( ui32 i = 0; i < 2; ++i ) {
+            m_geos[ i ] = GeometryBuilder::allocTriangles( VertexType::ColorVertex, BufferAccessType::ReadOnly );
+        }
+
+        // Both triangles shall share one material
+        delete m_geos[ 1 ]->m_material;
+        m_geos[ 1 ]->m_material = m_geos[ 0 ]->m_material;
+    }
+
+    virtual void TearDown() {
+        m_root->releaseChildren();
+        m_root->release();
+        m_root = nullptr;
+
+        m_geos[ 1 ]->m_material = nullptr;
+        for ( ui32 i = 0; i < 2; ++i ) {
+            Geometry::destroy( &m_geos[ i ] );
+        }
+
+        delete m_ids;
+        m_ids = nullptr;
+    }
+
+    Node *createStaticNode( const String &name, Geometry *geo, const glm::vec3 &pos ) {
+        Node *node( new Node( name, *m_ids, Node::RenderCompRequest::RenderCompRequested,
+                Node::TransformCompRequest::TransformCompRequested, m_root ) );
+        TransformComponent *comp( ( TransformComponent* ) node->getComponent( Node::ComponentType::TransformComponentType ) );
+        comp->setTransformationMatrix( glm::translate( glm::mat4( 1.0f ), pos ) );
+        node->setStatic( true );
+        node->addGeometry( geo );
+
+        return node;
+    }
+};
+
+TEST_F( StaticBatcherTest, mergeStaticNodesTest ) {
+    Node *n1( createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) ) );
+    Node *n2( createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) ) );
+
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    EXPECT_EQ( 2u, batcher.getNumMergedMeshes() );
+    EXPECT_EQ( 0u, n1->getNumGeometries() );
+    EXPECT_EQ( 0u, n2->getNumGeometries() );
+
+    const StaticBatch *batch( batcher.getBatchAt( 0 ) );
+    ASSERT_NE( nullptr, batch );
+    EXPECT_EQ( m_geos[ 0 ]->m_material, batch->m_material );
+    EXPECT_EQ( 2u, batch->m_ranges.size() );
+    EXPECT_EQ( 3u, batch->m_ranges[ 1 ].m_baseVertex );
+    EXPECT_EQ( 3u, batch->m_ranges[ 1 ].m_startIndex );
+    EXPECT_EQ( IndexType::UnsignedInt, batch->m_geo->m_indextype );
+    EXPECT_EQ( 6u, batch->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+
+    // The second triangle is translated into world space
+    const ColorVert *vertices( static_cast<const ColorVert*>( batch->m_geo->m_vb->m_data ) );
+    const ColorVert *src( static_cast<const ColorVert*>( m_geos[ 1 ]->m_vb->m_data ) );
+    EXPECT_FLOAT_EQ( src[ 0 ].position.x + 10.0f, vertices[ 3 ].position.x );
+    const ui32 *indices( static_cast<const ui32*>( batch->m_geo->m_ib->m_data ) );
+    EXPECT_LE( 3u, indices[ 3 ] );
+
+    Node *batchNode( batcher.createBatchNode( "batches", *m_ids, m_root ) );
+    ASSERT_NE( nullptr, batchNode );
+    EXPECT_EQ( 1u, batchNode->getNumGeometries() );
+}
+
+TEST_F( StaticBatcherTest, ignoreDynamicNodesTest ) {
+    Node *n1( createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) ) );
+    n1->setStatic( false );
+
+    StaticBatcher batcher;
+    EXPECT_EQ( 0u, batcher.build( m_root ) );
+    EXPECT_EQ( 1u, n1->getNumGeometries() );
+    EXPECT_EQ( nullptr, batcher.createBatchNode( "batches", *m_ids, m_root ) );
+}
+
+TEST_F( StaticBatcherTest, splitByVertexTypeTest ) {
+    Geometry *renderGeo( GeometryBuilder::allocTriangles( VertexType::RenderVertex, BufferAccessType::ReadOnly ) );
+    delete renderGeo->m_material;
+    renderGeo->m_material = m_geos[ 0 ]->m_material;
+    createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) );
+    createStaticNode( "n2", renderGeo, glm::vec3( 10, 0, 0 ) );
+
+    // One material, but two vertex layouts
+    StaticBatcher batcher;
+    EXPECT_EQ( 2u, batcher.build( m_root ) );
+    for ( ui32 i = 0; i < batcher.getNumBatches(); ++i ) {
+        const StaticBatch *batch( batcher.getBatchAt( i ) );
+        EXPECT_EQ( batch->m_vertexType, batch->m_geo->m_vertextype );
+        EXPECT_EQ( 3u * Geometry::getVertexSize( batch->m_vertexType ), batch->m_geo->m_vb->m_size );
+    }
+    EXPECT_NE( batcher.getBatchAt( 0 )->m_vertexType, batcher.getBatchAt( 1 )->m_vertexType );
+
+    renderGeo->m_material = nullptr;
+    Geometry::destroy( &renderGeo );
+}
+
+TEST_F( StaticBatcherTest, rebuildTest ) {
+    Node *n1( createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) ) );
+    createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) );
+
+    // The meshes of the first build will be merged again
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    EXPECT_EQ( 2u, batcher.getNumMergedMeshes() );
+    EXPECT_EQ( 0u, n1->getNumGeometries() );
+
+    const StaticBatch *batch( batcher.getBatchAt( 0 ) );
+    ASSERT_EQ( 2u, batch->m_ranges.size() );
+    EXPECT_EQ( n1, batch->m_ranges[ 0 ].m_sourceNode );
+    EXPECT_EQ( m_geos[ 0 ], batch->m_ranges[ 0 ].m_sourceGeo );
+}
+
+TEST_F( StaticBatcherTest, mergeAttachedGeometryTest ) {
+    Node *n1( createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) ) );
+    Node *n2( createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) ) );
+    RenderBackendService rbSrv;
+    n1->draw( &rbSrv );
+    n2->draw( &rbSrv );
+    RenderComponent *renderComp( ( RenderComponent* ) n1->getComponent( Node::ComponentType::RenderComponentType ) );
+    EXPECT_EQ( 1u, renderComp->getNumAttachedGeometry() );
+
+    // Drawn geometries will be detached and replaced by the batch
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    EXPECT_EQ( 2u, batcher.getNumMergedMeshes() );
+    EXPECT_EQ( 0u, renderComp->getNumAttachedGeometry() );
+    EXPECT_EQ( 0u, n1->getNumGeometries() );
+}
+
+TEST_F( StaticBatcherTest, saveLoadTest ) {
+    createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) );
+    createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) );
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+
+    IO::MemoryStream stream;
+    EXPECT_TRUE( batcher.save( stream ) );
+    EXPECT_EQ( 0u, stream.seek( 0, IO::Stream::Origin::Begin ) );
+
+    StaticBatcher loaded;
+    EXPECT_TRUE( loaded.load( stream, batcher.getMaterials() ) );
+    ASSERT_EQ( 1u, loaded.getNumBatches() );
+    EXPECT_EQ( 2u, loaded.getNumMergedMeshes() );
+
+    const StaticBatch *src( batcher.getBatchAt( 0 ) );
+    const StaticBatch *dst( loaded.getBatchAt( 0 ) );
+    EXPECT_EQ( src->m_material, dst->m_material );
+    EXPECT_EQ( src->m_vertexType, dst->m_vertexType );
+    ASSERT_EQ( src->m_ranges.size(), dst->m_ranges.size() );
+    EXPECT_EQ( src->m_ranges[ 1 ].m_baseVertex, dst->m_ranges[ 1 ].m_baseVertex );
+    EXPECT_EQ( nullptr, dst->m_ranges[ 1 ].m_sourceGeo );
+    ASSERT_EQ( src->m_geo->m_vb->m_size, dst->m_geo->m_vb->m_size );
+    ASSERT_EQ( src->m_geo->m_ib->m_size, dst->m_geo->m_ib->m_size );
+    EXPECT_EQ( 0, ::memcmp( src->m_geo->m_vb->m_data, dst->m_geo->m_vb->m_data, src->m_geo->m_vb->m_size ) );
+    EXPECT_EQ( 0, ::memcmp( src->m_geo->m_ib->m_data, dst->m_geo->m_ib->m_data, src->m_geo->m_ib->m_size ) );
+    EXPECT_EQ( 6u, dst->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+}
+
+TEST_F( StaticBatcherTest, loadTruncatedTest ) {
+    createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) );
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    IO::MemoryStream stream;
+    EXPECT_TRUE( batcher.save( stream ) );
+
+    // Every cut through the stream shall be detected
+    ui64 size( 0 );
+    const uc8 *data( stream.map( size ) );
+    ASSERT_NE( nullptr, data );
+    for ( ui32 cut = 0; cut < size; cut += 4 ) {
+        IO::MemoryStream truncated( data, cut );
+        StaticBatcher loaded;
+        EXPECT_FALSE( loaded.load( truncated, batcher.getMaterials() ) );
+        EXPECT_EQ( 0u, loaded.getNumBatches() );
+    }
+
+    // An unknown material index is rejected
+    IO::MemoryStream complete( data, size );
+    StaticBatcher loaded;
+    EXPECT_FALSE( loaded.load( complete, StaticBatcher::MaterialArray() ) );
+}
+
+TEST_F( StaticBatcherTest, loadCorruptedTest ) {
+    createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) );
+    createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) );
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    IO::MemoryStream stream;
+    EXPECT_TRUE( batcher.save( stream ) );
+    ui64 size( 0 );
+    const uc8 *data( stream.map( size ) );
+    ASSERT_NE( nullptr, data );
+
+    // The header, the batch and the two ranges, the indices are stored at the end
+    const size_t secondRange( 3 * 4 + 5 * 4 + 24 + 40 );
+    const size_t lastIndex( static_cast<size_t>( size ) - sizeof( ui32 ) );
+    const ui32 values[ 4 ] = { 4, 2, 0, 100 };
+    const size_t offsets[ 4 ] = { secondRange, secondRange + 8, lastIndex, lastIndex };
+    for ( ui32 i = 0; i < 4; ++i ) {
+        std::vector<uc8> corrupted( data, data + size );
+        ::memcpy( &corrupted[ offsets[ i ] ], &values[ i ], sizeof( ui32 ) );
+        IO::MemoryStream corruptedStream( &corrupted[ 0 ], corrupted.size() );
+        StaticBatcher loaded;
+        EXPECT_FALSE( loaded.load( corruptedStream, batcher.getMaterials() ) );
+        EXPECT_EQ( 0u, loaded.getNumBatches() );
+    }
+}
+
+TEST_F( StaticBatcherTest, removedSourceNodeTest ) {
+    Node *n1( createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) ) );
+    createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) );
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+
+    // The batcher keeps the removed node alive until its batches are released
+    EXPECT_TRUE( m_root->removeChild( "n1", Node::TraverseMode::FlatMode ) );
+    n1->release();
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    EXPECT_EQ( 1u, batcher.getNumMergedMeshes() );
+}
+
+TEST_F( StaticBatcherTest, cullRangesTest ) {
+    createStaticNode( "n1", m_geos[ 0 ], glm::vec3( 0, 0, 0 ) );
+    createStaticNode( "n2", m_geos[ 1 ], glm::vec3( 10, 0, 0 ) );
+    StaticBatcher batcher;
+    EXPECT_EQ( 1u, batcher.build( m_root ) );
+    const StaticBatch *batch( batcher.getBatchAt( 0 ) );
+    ASSERT_EQ( 2u, batch->m_geo->m_numPrimGroups );
+
+    // Only the first triangle is on the screen
+    OcclusionCuller culler( 64, 64 );
+    culler.update( glm::ortho( -2.0f, 2.0f, -2.0f, 2.0f, -10.0f, 10.0f ) );
+    RenderBackendService rbSrv;
+    EXPECT_EQ( 1u, batcher.cull( culler, &rbSrv ) );
+    EXPECT_EQ( 0u, batch->m_geo->m_pPrimGroups[ 0 ].m_startIndex );
+    EXPECT_EQ( 3u, batch->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+    EXPECT_EQ( 0u, batch->m_geo->m_pPrimGroups[ 1 ].m_numIndices );
+
+    // Both triangles are visible, the neighboured ranges are drawn at once
+    culler.update( glm::ortho( -2.0f, 12.0f, -2.0f, 2.0f, -10.0f, 10.0f ) );
+    EXPECT_EQ( 0u, batcher.cull( culler, &rbSrv ) );
+    EXPECT_EQ( 6u, batch->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+    EXPECT_EQ( 0u, batch->m_geo->m_pPrimGroups[ 1 ].m_numIndices );
+
+    culler.update( glm::ortho( 8.0f, 12.0f, -2.0f, 2.0f, -10.0f, 10.0f ) );
+    EXPECT_EQ( 1u, batcher.cull( culler, &rbSrv ) );
+    EXPECT_EQ( 3u, batch->m_geo->m_pPrimGroups[ 0 ].m_startIndex );
+    EXPECT_EQ( 3u, batch->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+
+    batcher.resetCulling( &rbSrv );
+    EXPECT_EQ( 0u, batch->m_geo->m_pPrimGroups[ 0 ].m_startIndex );
+    EXPECT_EQ( 6u, batch->m_geo->m_pPrimGroups[ 0 ].m_numIndices );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE
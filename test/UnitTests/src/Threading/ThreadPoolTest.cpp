@@ -0,0 +1,102 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2018 OSRE ( Open Source Render Engine ) by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "osre_testcommon.h"
+#include <osre/Threading/ThreadPool.h>
+
+#include <atomic>
+#include <vector>
+
+namespace OSRE {
+namespace UnitTest {
+
+using namespace ::OSRE::Threading;
+
+class ThreadPoolTest : public ::testing::Test {
+    // empty
+};
+
+TEST_F( ThreadPoolTest, createTest ) {
+    ThreadPool serialPool( 0 );
+    EXPECT_EQ( 0u, serialPool.getNumThreads() );
+
+    ThreadPool pool( 2 );
+    EXPECT_EQ( 2u, pool.getNumThreads() );
+}
+
+TEST_F( ThreadPoolTest, enqueueTest ) {
+    ThreadPool pool( 2 );
+    std::atomic<ui32> counter( 0 );
+    for ( ui32 i = 0; i < 100; ++i ) {
+        pool.enqueue( [ &counter ] { ++counter; } );
+    }
+    pool.waitForAll();
+    EXPECT_EQ( 100u, counter.load() );
+}
+
+TEST_F( ThreadPoolTest, parallelForTest ) {
+    for ( i32 numThreads = 0; numThreads < 4; ++numThreads ) {
+        ThreadPool pool( numThreads );
+        std::vector<ui32> values( 1000, 0 );
+        pool.parallelFor( static_cast<ui32>( values.size() ), 16, [ &values ]( ui32 begin, ui32 end ) {
+            for ( ui32 i = begin; i < end; ++i ) {
+                values[ i ] += i;
+            }
+        } );
+        for ( ui32 i = 0; i < values.size(); ++i ) {
+            EXPECT_EQ( i, values[ i ] );
+        }
+    }
+}
+
+TEST_F( ThreadPoolTest, nestedParallelForTest ) {
+    ThreadPool pool( 2 );
+    std::atomic<ui32> counter( 0 );
+    pool.parallelFor( 8, 1, [ &pool, &counter ]( ui32 begin, ui32 end ) {
+        for ( ui32 i = begin; i < end; ++i ) {
+            pool.parallelFor( 8, 1, [ &counter ]( ui32 b, ui32 e ) {
+                counter += e - b;
+            } );
+        }
+    } );
+    EXPECT_EQ( 64u, counter.load() );
+}
+
+TEST_F( ThreadPoolTest, waitForAllInJobTest ) {
+    ThreadPool pool( 2 );
+    std::atomic<ui32> counter( 0 );
+    for ( ui32 i = 0; i < 4; ++i ) {
+        pool.enqueue( [ &pool, &counter ] {
+            for ( ui32 j = 0; j < 8; ++j ) {
+                pool.enqueue( [ &counter ] { ++counter; } );
+            }
+
+            // Does not wait for itself or the other waiting jobs
+            pool.waitForAll();
+        } );
+    }
+    pool.waitForAll();
+    EXPECT_EQ( 32u, counter.load() );
+}
+
+} // Namespace UnitTest
+} // Namespace OSRE